@@ -23,6 +23,8 @@
 #include "base.h"
 #include "exceptions.h"
 #include "mem_tracker.h"
+#include "arena.h"
+#include "pool.h"
 #include "list.h"
 #include "string_list.h"
 #include "readargs.h"
@@ -39,6 +41,10 @@
 #include "btree.h"
 #include "md5.h"
 #include "base64.h"
+#include "rope.h"
+#include "string_pool.h"
+#include "vec.h"
+#include "parallel_sort.h"
 
 #ifndef MINGW
 
@@ -51,6 +57,7 @@
 #include "dbi_manager.h"
 #include "pop3.h"
 #include "smtp.h"
+#include "line_reader.h"
 
 #endif
 
@@ -0,0 +1,584 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "arena.h"
+
+// {{{ docs
+/*
+@config
+	TITLE:     Arena
+	VERSION:   1.00
+	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
+@endnode
+
+@node quote
+	*Everything should be made as simple as possible, but not simpler.*
+
+		Albert Einstein
+@endnode
+
+@node history
+	- 1.00:		Initial Release
+@endnode
+
+@node intro
+Arena is a memory allocator for data that lives and dies all together, like all the data parsed during a single
+CGI request. Memory is taken from big chunks just moving a pointer forward (so an allocation costs almost nothing)
+and it is never freed one block at a time: afc_arena_reset() releases everything at once, and the Arena is ready
+to be used again.
+
+List, Array, Dictionary and StringList instances can be bound to an Arena (see afc_list_set_arena(),
+afc_array_set_arena(), afc_dictionary_set_arena() and afc_string_list_set_arena()): their internal memory
+is then allocated from the Arena and clearing them does not need to free it item by item.
+
+To inizialize a new instance, simply call afc_arena_new(), and to destroy it, call the afc_arena_delete().
+To get some memory call afc_arena_alloc(), and to free all the memory given away call afc_arena_reset().
+
+Please, remember that memory returned by afc_arena_alloc() is *not* cleared, and that it must *never* be passed
+to afc_free().
+@endnode
+*/
+// }}}
+
+static const char class_name[] = "Arena";
+
+static struct afc_arena_chunk *afc_arena_internal_chunk_new(Arena *arena, size_t size);
+static void afc_arena_internal_chunks_free(struct afc_arena_chunk *chunk);
+
+/* Chunk header size, so that the memory after it is aligned */
+#define AFC_ARENA_INTERNAL_HEADER ((sizeof(struct afc_arena_chunk) + AFC_ARENA_ALIGN - 1) & ~(size_t)(AFC_ARENA_ALIGN - 1))
+#define afc_arena_internal_align(size) (((size) + AFC_ARENA_ALIGN - 1) & ~(size_t)(AFC_ARENA_ALIGN - 1))
+#define afc_arena_internal_data(chunk) ((char *)(chunk) + AFC_ARENA_INTERNAL_HEADER)
+
+// {{{ afc_arena_new ()
+/*
+@node afc_arena_new
+
+			 NAME: afc_arena_new ()    - Initializes a new Arena instance.
+
+		 SYNOPSIS: Arena * afc_arena_new ()
+
+	  DESCRIPTION: This function initializes a new Arena instance. No memory is allocated for the Arena chunks
+				   until the first afc_arena_alloc() call.
+
+			INPUT: NONE
+
+		  RESULTS: a valid inizialized Arena structure. NULL in case of errors.
+
+		 SEE ALSO: - afc_arena_delete()
+
+@endnode
+*/
+Arena *afc_arena_new(void)
+{
+	TRY(Arena *)
+
+	Arena *arena = (Arena *)afc_malloc(sizeof(Arena));
+
+	if (arena == NULL)
+		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "arena", NULL);
+
+	arena->magic = AFC_ARENA_MAGIC;
+	arena->chunk_size = AFC_ARENA_DEFAULT_CHUNK_SIZE;
+
+	RETURN(arena);
+
+	EXCEPT
+	afc_arena_delete(arena);
+
+	FINALLY
+
+	ENDTRY
+}
+// }}}
+// {{{ afc_arena_delete ( arena )
+/*
+@node afc_arena_delete
+
+			 NAME: afc_arena_delete ( arena )  - Disposes a valid Arena instance.
+
+		 SYNOPSIS: int afc_arena_delete ( Arena * arena )
+
+	  DESCRIPTION: This function frees an already alloc'd Arena structure and all the memory it gave away.
+
+			INPUT: - arena  - Pointer to a valid Arena instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+			NOTES: - this method calls: afc_arena_clear()
+				   - Containers bound to this Arena must be deleted before.
+
+		 SEE ALSO: - afc_arena_new()
+				   - afc_arena_clear()
+@endnode
+*/
+int _afc_arena_delete(Arena *arena)
+{
+	int afc_res;
+
+	if ((afc_res = afc_arena_clear(arena)) != AFC_ERR_NO_ERROR)
+		return (afc_res);
+
+	afc_free(arena);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_arena_clear ( arena )
+/*
+@node afc_arena_clear
+
+			 NAME: afc_arena_clear ( arena )  - Frees all the Arena memory
+
+		 SYNOPSIS: int afc_arena_clear ( Arena * arena )
+
+	  DESCRIPTION: This function gives all the Arena memory back to the system. Unlike afc_arena_reset(), no chunk
+				   is kept for the next allocations.
+
+			INPUT: - arena  - Pointer to a valid Arena instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+		 SEE ALSO: - afc_arena_reset()
+@endnode
+*/
+int afc_arena_clear(Arena *arena)
+{
+	if (arena == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (arena->magic != AFC_ARENA_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	afc_arena_internal_chunks_free(arena->chunk);
+	afc_arena_internal_chunks_free(arena->big);
+
+	arena->chunk = NULL;
+	arena->big = NULL;
+	arena->last = NULL;
+	arena->used = 0;
+	arena->allocated = 0;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_arena_reset ( arena )
+/*
+@node afc_arena_reset
+
+			 NAME: afc_arena_reset ( arena )  - Frees all the memory given away by the Arena
+
+		 SYNOPSIS: int afc_arena_reset ( Arena * arena )
+
+	  DESCRIPTION: This function frees at once all the memory returned by afc_arena_alloc() and the other Arena
+				   functions. The current chunk is kept, so the next allocations will not need to ask the system
+				   for memory.
+
+			INPUT: - arena  - Pointer to a valid Arena instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+			NOTES: - Containers bound to this Arena must be cleared (with their afc_*_clear() function) before
+					 calling this function.
+
+		 SEE ALSO: - afc_arena_alloc()
+				   - afc_arena_clear()
+@endnode
+*/
+int afc_arena_reset(Arena *arena)
+{
+	if (arena == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (arena->magic != AFC_ARENA_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	afc_arena_internal_chunks_free(arena->big);
+	arena->big = NULL;
+	arena->allocated = 0;
+
+	if (arena->chunk)
+	{
+		afc_arena_internal_chunks_free(arena->chunk->next);
+
+		arena->chunk->next = NULL;
+		arena->chunk->used = 0;
+		arena->allocated = AFC_ARENA_INTERNAL_HEADER + arena->chunk->size;
+	}
+
+	arena->last = NULL;
+	arena->used = 0;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_arena_alloc ( arena, size )
+/*
+@node afc_arena_alloc
+
+			 NAME: afc_arena_alloc ( arena, size )  - Allocates memory from the Arena
+
+		 SYNOPSIS: void * afc_arena_alloc ( Arena * arena, size_t size )
+
+	  DESCRIPTION: This function returns /size/ bytes of memory taken from the Arena. The memory is aligned
+				   to AFC_ARENA_ALIGN bytes.
+
+			INPUT: - arena  - Pointer to a valid Arena instance.
+				   - size   - Number of bytes to allocate.
+
+		  RESULTS: a pointer to the memory, or NULL in case of errors.
+
+			NOTES: - The memory is *not* cleared.
+				   - Never afc_free() this memory: it is freed by afc_arena_reset() or afc_arena_delete().
+				   - Allocations bigger than a quarter of the chunk size get a chunk of their own.
+
+		 SEE ALSO: - afc_arena_realloc()
+				   - afc_arena_reset()
+@endnode
+*/
+void *afc_arena_alloc(Arena *arena, size_t size)
+{
+	struct afc_arena_chunk *chunk;
+	void *mem;
+
+	if (arena == NULL)
+	{
+		AFC_LOG_FAST(AFC_ERR_NULL_POINTER);
+		return (NULL);
+	}
+	if (arena->magic != AFC_ARENA_MAGIC)
+	{
+		AFC_LOG_FAST(AFC_ERR_INVALID_POINTER);
+		return (NULL);
+	}
+
+	size = afc_arena_internal_align(size ? size : 1);
+
+	if (size > arena->chunk_size / 4)
+	{
+		// Big allocations do not waste the space left in the current chunk
+		if ((chunk = afc_arena_internal_chunk_new(arena, size)) == NULL)
+			return (NULL);
+
+		chunk->used = size;
+		chunk->next = arena->big;
+		arena->big = chunk;
+
+		arena->used += size;
+
+		return (afc_arena_internal_data(chunk));
+	}
+
+	if ((arena->chunk == NULL) || (arena->chunk->used + size > arena->chunk->size))
+	{
+		if ((chunk = afc_arena_internal_chunk_new(arena, arena->chunk_size)) == NULL)
+			return (NULL);
+
+		chunk->next = arena->chunk;
+		arena->chunk = chunk;
+	}
+
+	mem = afc_arena_internal_data(arena->chunk) + arena->chunk->used;
+
+	arena->chunk->used += size;
+	arena->used += size;
+	arena->last = mem;
+
+	return (mem);
+}
+// }}}
+// {{{ afc_arena_realloc ( arena, mem, old_size, new_size )
+/*
+@node afc_arena_realloc
+
+			 NAME: afc_arena_realloc ( arena, mem, old_size, new_size )  - Changes the size of some Arena memory
+
+		 SYNOPSIS: void * afc_arena_realloc ( Arena * arena, void * mem, size_t old_size, size_t new_size )
+
+	  DESCRIPTION: This function changes the size of a block returned by afc_arena_alloc(). If /mem/ is the last
+				   block allocated and there is enough room in its chunk, it is resized in place; otherwise a new
+				   block is allocated and the first /old_size/ bytes (or /new_size/, if smaller) are copied into it.
+
+			INPUT: - arena    - Pointer to a valid Arena instance.
+				   - mem      - Memory to resize. It can be NULL.
+				   - old_size - The current size of /mem/.
+				   - new_size - The desired size.
+
+		  RESULTS: a pointer to the resized memory, or NULL in case of errors (/mem/ is left untouched).
+
+			NOTES: - Since the Arena keeps no information about the blocks it gives away, you have to pass
+					 the current size of /mem/.
+
+		 SEE ALSO: - afc_arena_alloc()
+@endnode
+*/
+void *afc_arena_realloc(Arena *arena, void *mem, size_t old_size, size_t new_size)
+{
+	struct afc_arena_chunk *chunk;
+	size_t start;
+	void *res;
+
+	if (mem == NULL)
+		return (afc_arena_alloc(arena, new_size));
+
+	if (arena == NULL)
+	{
+		AFC_LOG_FAST(AFC_ERR_NULL_POINTER);
+		return (NULL);
+	}
+	if (arena->magic != AFC_ARENA_MAGIC)
+	{
+		AFC_LOG_FAST(AFC_ERR_INVALID_POINTER);
+		return (NULL);
+	}
+
+	if ((mem == arena->last) && (new_size <= arena->chunk_size / 4))
+	{
+		chunk = arena->chunk;
+		start = (char *)mem - afc_arena_internal_data(chunk);
+
+		if (start + afc_arena_internal_align(new_size ? new_size : 1) <= chunk->size)
+		{
+			arena->used -= chunk->used - start;
+			chunk->used = start + afc_arena_internal_align(new_size ? new_size : 1);
+			arena->used += chunk->used - start;
+
+			return (mem);
+		}
+	}
+
+	if ((res = afc_arena_alloc(arena, new_size)) == NULL)
+		return (NULL);
+
+	memcpy(res, mem, (old_size < new_size) ? old_size : new_size);
+
+	return (res);
+}
+// }}}
+// {{{ afc_arena_string_new ( arena, numchars )
+/*
+@node afc_arena_string_new
+
+			 NAME: afc_arena_string_new ( arena, numchars )  - Creates an AFC String in the Arena
+
+		 SYNOPSIS: char * afc_arena_string_new ( Arena * arena, unsigned long numchars )
+
+	  DESCRIPTION: This function works like afc_string_new(), but the memory is taken from the Arena.
+				   The string can be used with all the afc_string_*() functions.
+
+			INPUT: - arena    - Pointer to a valid Arena instance.
+				   - numchars - Max number of chars the string can hold.
+
+		  RESULTS: a new empty AFC String, or NULL in case of errors.
+
+			NOTES: - Never afc_string_delete() a string created by this function.
+
+		 SEE ALSO: - afc_arena_string_dup()
+				   - afc_string_new()
+@endnode
+*/
+char *afc_arena_string_new(Arena *arena, unsigned long numchars)
+{
+	unsigned long *location;
+
+	if (numchars == 0)
+		numchars = 1;
+
+	if ((location = afc_arena_alloc(arena, (sizeof(unsigned long) * 2) + numchars + 1)) == NULL)
+		return (NULL);
+
+	location[0] = numchars + 1;
+	location[1] = 0L;
+
+	((char *)(location + 2))[0] = '\0';
+
+	return ((char *)(location + 2));
+}
+// }}}
+// {{{ afc_arena_string_dup ( arena, str )
+/*
+@node afc_arena_string_dup
+
+			 NAME: afc_arena_string_dup ( arena, str )  - Copies a string in the Arena
+
+		 SYNOPSIS: char * afc_arena_string_dup ( Arena * arena, const char * str )
+
+	  DESCRIPTION: This function works like afc_string_dup(), but the memory is taken from the Arena.
+
+			INPUT: - arena    - Pointer to a valid Arena instance.
+				   - str      - The string to copy.
+
+		  RESULTS: a new AFC String with the same contents of /str/, or NULL if /str/ is NULL or empty, or in
+				   case of errors.
+
+			NOTES: - Never afc_string_delete() a string created by this function.
+
+		 SEE ALSO: - afc_arena_string_new()
+				   - afc_string_dup()
+@endnode
+*/
+char *afc_arena_string_dup(Arena *arena, const char *str)
+{
+	unsigned long len;
+	char *s;
+
+	if ((str == NULL) || ((len = strlen(str)) == 0))
+		return (NULL);
+
+	if ((s = afc_arena_string_new(arena, len)) == NULL)
+		return (NULL);
+
+	memcpy(s, str, len + 1);
+	((unsigned long *)s)[-1] = len;
+
+	return (s);
+}
+// }}}
+// {{{ afc_arena_set_tags ( arena, first_tag, ... )
+/*
+@node afc_arena_set_tags
+
+			 NAME: afc_arena_set_tags ( arena, first_tag, ... )  - Sets Arena tags
+
+		 SYNOPSIS: int afc_arena_set_tags ( Arena * arena, int first_tag, ... )
+
+	  DESCRIPTION: This function sets a list of tags in the current Arena. For a list of valid tags, please
+				   see afc_arena_set_tag() function.
+
+			INPUT: - arena      - Pointer to a valid Arena instance.
+				   - first_tag  - First tag to be set
+				   - ...        - Tags and values to be set
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - An error code in case of error
+
+			NOTES: - Remember to end the tag list with AFC_TAG_END
+
+		 SEE ALSO: - afc_arena_set_tag()
+@endnode
+*/
+int _afc_arena_set_tags(Arena *arena, int first_tag, ...)
+{
+	va_list args;
+	unsigned int tag;
+	void *val;
+	int res;
+
+	va_start(args, first_tag);
+
+	tag = first_tag;
+
+	while (tag != AFC_TAG_END)
+	{
+		val = va_arg(args, void *);
+
+		if ((res = afc_arena_set_tag(arena, tag, val)) != AFC_ERR_NO_ERROR)
+		{
+			va_end(args);
+			return (res);
+		}
+
+		tag = va_arg(args, int);
+	}
+
+	va_end(args);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_arena_set_tag ( arena, tag, val )
+/*
+@node afc_arena_set_tag
+
+			 NAME: afc_arena_set_tag ( arena, tag, val )  - Sets an Arena tag
+
+		 SYNOPSIS: int afc_arena_set_tag ( Arena * arena, int tag, void * val )
+
+	  DESCRIPTION: This function sets a tag in the current Arena.
+
+			INPUT: - arena  - Pointer to a valid Arena instance.
+				   - tag    - Tag to be set. Valid tags are:
+						+ AFC_ARENA_TAG_CHUNK_SIZE - Size (in bytes) of the chunks allocated from now on.
+							Default is AFC_ARENA_DEFAULT_CHUNK_SIZE.
+
+				   - val    - Value to set to the tag
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_ERR_UNSUPPORTED_TAG if the tag is not known.
+
+		 SEE ALSO: - afc_arena_set_tags()
+@endnode
+*/
+int afc_arena_set_tag(Arena *arena, int tag, void *val)
+{
+	if (arena == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (arena->magic != AFC_ARENA_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	switch (tag)
+	{
+	case AFC_ARENA_TAG_CHUNK_SIZE:
+		arena->chunk_size = afc_arena_internal_align((size_t)(long)val);
+		if (arena->chunk_size < AFC_ARENA_ALIGN * 4)
+			arena->chunk_size = AFC_ARENA_ALIGN * 4;
+		break;
+
+	default:
+		return (AFC_LOG_FAST(AFC_ERR_UNSUPPORTED_TAG));
+	}
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+
+/* =====================================================================================
+	 INTERNAL FUNCTIONS
+===================================================================================== */
+// {{{ afc_arena_internal_chunk_new ( arena, size )
+static struct afc_arena_chunk *afc_arena_internal_chunk_new(Arena *arena, size_t size)
+{
+	struct afc_arena_chunk *chunk;
+
+	if ((chunk = afc_malloc_uninit(AFC_ARENA_INTERNAL_HEADER + size)) == NULL)
+	{
+		AFC_LOG_FAST_INFO(AFC_ERR_NO_MEMORY, "chunk");
+		return (NULL);
+	}
+
+	chunk->size = size;
+	chunk->used = 0;
+	chunk->next = NULL;
+
+	arena->allocated += AFC_ARENA_INTERNAL_HEADER + size;
+
+	return (chunk);
+}
+// }}}
+// {{{ afc_arena_internal_chunks_free ( chunk )
+static void afc_arena_internal_chunks_free(struct afc_arena_chunk *chunk)
+{
+	struct afc_arena_chunk *next;
+
+	while (chunk)
+	{
+		next = chunk->next;
+		afc_free(chunk);
+		chunk = next;
+	}
+}
+// }}}
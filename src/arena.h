@@ -0,0 +1,101 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef AFC_ARENA_H
+#define AFC_ARENA_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+
+#include "base.h"
+#include "exceptions.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* AFC Arena Magic Number: 'AREN' */
+#define AFC_ARENA_MAGIC ('A' << 24 | 'R' << 16 | 'E' << 8 | 'N')
+
+/* AFC Arena Base value for constants */
+#define AFC_ARENA_BASE 0xE000
+
+/* Default size (in bytes) of the chunks allocations are carved from */
+#define AFC_ARENA_DEFAULT_CHUNK_SIZE 8192
+
+/* Every allocation is aligned (and rounded) to AFC_ARENA_ALIGN bytes */
+#define AFC_ARENA_ALIGN 16
+
+	/* Tags for Arena */
+	enum
+	{
+		AFC_ARENA_TAG_CHUNK_SIZE = AFC_ARENA_BASE + 1 /* Size of new chunks (in bytes) */
+	};
+
+	struct afc_arena_chunk
+	{
+		struct afc_arena_chunk *next;
+		size_t size; // Usable bytes
+		size_t used; // Bytes already given away
+	};
+
+	struct afc_arena
+	{
+		unsigned long magic;
+
+		struct afc_arena_chunk *chunk; // Current chunk (older ones are chained after it)
+		struct afc_arena_chunk *big;   // Chunks holding a single big allocation
+
+		size_t chunk_size; // Size of new chunks
+
+		void *last;		  // Last allocation: afc_arena_realloc() can grow it in place
+		size_t used;	  // Bytes allocated since the last reset
+		size_t allocated; // Bytes of memory requested to the system
+	};
+
+	typedef struct afc_arena Arena;
+
+#define afc_arena_delete(arena)   \
+	if (arena)                    \
+	{                             \
+		_afc_arena_delete(arena); \
+		arena = NULL;             \
+	}
+
+	Arena *afc_arena_new(void);
+	int _afc_arena_delete(Arena *arena);
+	int afc_arena_clear(Arena *arena);
+	int afc_arena_reset(Arena *arena);
+	void *afc_arena_alloc(Arena *arena, size_t size);
+	void *afc_arena_realloc(Arena *arena, void *mem, size_t old_size, size_t new_size);
+	char *afc_arena_string_new(Arena *arena, unsigned long numchars);
+	char *afc_arena_string_dup(Arena *arena, const char *str);
+#define afc_arena_set_tags(arena, first, ...) _afc_arena_set_tags(arena, first, ##__VA_ARGS__, AFC_TAG_END)
+	int _afc_arena_set_tags(Arena *arena, int first_tag, ...);
+	int afc_arena_set_tag(Arena *arena, int tag, void *val);
+
+#define afc_arena_used(arena) (arena ? (arena)->used : 0)
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -23,7 +23,7 @@
 /*
 @config
 	TITLE:     Array
-	VERSION:   1.30
+	VERSION:   1.41
 	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
 @endnode
 */
@@ -56,6 +56,8 @@ and to delete just one of them there is afc_array_del() .
 @endnode
 
 @node history
+	- 1.41:		Big arrays are sorted with afc_parallel_sort()
+	- 1.40:		ADD: afc_array_set_arena() function
 	- 1.30:		ADD: afc_array_before_first()	function
 	- 1.20:	 	ADD: afc_array_set_custom_sort () function
 @endnode
@@ -65,6 +67,7 @@ and to delete just one of them there is afc_array_del() .
 static const char class_name[] = "Array Master";
 
 static int afc_array_internal_double_array(Array *);
+static int afc_array_internal_resize(Array *, unsigned long int);
 static int afc_array_internal_insert(Array *, void *);
 #ifdef MINGW
 static void quick_sort(void *base, size_t num_items, size_t width, int (*compare)(const void *, const void *));
@@ -108,14 +111,14 @@ Array *_afc_array_new(const char *file, const char *func, const unsigned int lin
 
 	array->magic = AFC_ARRAY_MAGIC;
 
-	if ((array->mem = _afc_malloc((sizeof(void *)) * AFC_ARRAY_DEFAULT_ITEMS, file, func, line)) == NULL)
+	if ((array->mem = _afc_malloc_uninit((sizeof(void *)) * AFC_ARRAY_DEFAULT_ITEMS, file, func, line)) == NULL)
 		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "mem", NULL);
 
 	array->current_pos = 0;
 	array->max_items = AFC_ARRAY_DEFAULT_ITEMS;
 
 #ifndef MINGW
-	array->custom_sort = qsort;
+	array->custom_sort = afc_parallel_sort;
 #else
 	array->custom_sort = quick_sort;
 #endif
@@ -163,7 +166,8 @@ int _afc_array_delete(Array *array)
 	if ((afc_res = afc_array_clear(array)) != AFC_ERR_NO_ERROR)
 		return afc_res;
 
-	afc_free(array->mem);
+	if ((array->arena == NULL) && (array->mem != NULL))
+		afc_free(array->mem);
 	afc_free(array);
 
 	return (AFC_ERR_NO_ERROR);
@@ -206,6 +210,13 @@ int afc_array_clear(Array *am)
 	am->num_items = 0;
 	am->current_pos = 0;
 
+	/* The table lives in the Arena: drop it, so it is not used after afc_arena_reset() */
+	if (am->arena)
+	{
+		am->mem = NULL;
+		am->max_items = 0;
+	}
+
 	/* Custom Clean-up code should go here */
 
 	return (AFC_ERR_NO_ERROR);
@@ -235,10 +246,9 @@ int afc_array_clear(Array *am)
 */
 int afc_array_init(Array *am, unsigned long int size)
 {
-	if ((am->mem = afc_realloc(am->mem, sizeof(void *) * size)) == NULL)
+	if (afc_array_internal_resize(am, size) != AFC_ERR_NO_ERROR)
 		return (AFC_ERR_NO_MEMORY);
 
-	am->max_items = size;
 	am->current_pos = 0;
 	am->num_items = 0;
 
@@ -640,6 +650,9 @@ void *afc_array_del(Array *am)
 				 greater than the second.  If two members compare as equal,
 				 their order in the sorted array is undefined.
 
+				 Arrays are sorted with afc_parallel_sort(), so big arrays are sorted by many threads at once,
+				 and the comparison function must not change any shared data.
+
 			INPUT: - array    - Pointer to a valid afc_array instance.
 		 - comp            - The comparison function.
 
@@ -650,6 +663,9 @@ void *afc_array_del(Array *am)
 */
 void *afc_array_sort(Array *am, int (*comp)(const void *, const void *))
 {
+	if (am->num_items == 0)
+		return (NULL);
+
 	am->custom_sort(am->mem, am->num_items, sizeof(void **), comp);
 	am->current_pos = 0;
 	am->is_sorted = TRUE;
@@ -783,8 +799,8 @@ int afc_array_for_each(Array *am, int (*func)(Array *am, int pos, void *v, void
 
 	  SINCE: 1.20
 
-DESCRIPTION: Use this command to set a sort routine different to glibc qsort. You should use this function only if you
-		 know what you are doing and your glibc implementation of qsort is buggy.
+DESCRIPTION: Use this command to set a sort routine different to afc_parallel_sort(). You should use this function only if you
+		 know what you are doing: for example, pass qsort to sort in the calling thread only.
 
 	  INPUT: - am	- Pointer to a valid Array class.
 		 - func	- Function to be called in sort operations.
@@ -807,6 +823,57 @@ int afc_array_before_first(Array *am)
 	return (AFC_ERR_NO_ERROR);
 }
 // }}}
+// {{{ afc_array_set_arena ( am, arena )
+/*
+@node afc_array_set_arena
+
+	   NAME: afc_array_set_arena(am, arena) - Binds the Array to an Arena
+
+   SYNOPSIS: int afc_array_set_arena ( Array * am, Arena * arena )
+
+	  SINCE: 1.40
+
+DESCRIPTION: Use this command to take the memory of the Array items table from an Arena instead of the system heap.
+		 The table is never freed one piece at a time: it goes away with afc_arena_reset().
+
+	  INPUT: - am	- Pointer to a valid Array class.
+		 - arena	- Pointer to a valid Arena instance, or NULL to go back to the system heap.
+
+	RESULTS: - AFC_ERR_NO_ERROR on success.
+		 - AFC_ARRAY_ERR_NOT_EMPTY if the Array contains some items.
+
+	  NOTES: - Items stored in the Array are not touched: the Arena only holds the Array internal table.
+		 - Clear (or delete) the Array before resetting the Arena: afc_array_clear() drops the table
+		   of a bound Array, so it can be used again after the reset.
+
+   SEE ALSO: - afc_arena_new()
+@endnode
+*/
+int afc_array_set_arena(Array *am, Arena *arena)
+{
+	if (am == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (am->magic != AFC_ARRAY_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (arena == am->arena)
+		return (AFC_ERR_NO_ERROR);
+
+	if (am->num_items != 0)
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_ARRAY_ERR_NOT_EMPTY, "Cannot change the Arena of a non empty Array", NULL));
+
+	/* The table is dropped: the next afc_array_add() will take a new one from the right place */
+	if ((am->arena == NULL) && (am->mem != NULL))
+		afc_free(am->mem);
+
+	am->mem = NULL;
+	am->max_items = 0;
+	am->arena = arena;
+	am->current_pos = 0;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
 
 /* ===============================================================================================================
 	INTERNAL FUNCTIONS
@@ -818,7 +885,7 @@ static int afc_array_internal_double_array(Array *am)
 	unsigned long int m;
 
 	/* Overflow protection: cap at AFC_MAX_BUFFER_SIZE items */
-	new_max = am->max_items * 2;
+	new_max = am->max_items ? am->max_items * 2 : AFC_ARRAY_DEFAULT_ITEMS;
 	if (new_max < am->max_items || new_max > AFC_MAX_BUFFER_SIZE)
 		new_max = AFC_MAX_BUFFER_SIZE;
 	if (new_max <= am->max_items)
@@ -828,10 +895,29 @@ static int afc_array_internal_double_array(Array *am)
 	if (m / sizeof(void *) != new_max)
 		return (AFC_LOG_FAST(AFC_ERR_NO_MEMORY));
 
-	if ((am->mem = afc_realloc(am->mem, m)) == NULL)
+	if (afc_array_internal_resize(am, new_max) != AFC_ERR_NO_ERROR)
 		return (AFC_LOG_FAST(AFC_ERR_NO_MEMORY));
 
-	am->max_items = new_max;
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ int afc_array_internal_resize ( Array * am, unsigned long int size )
+static int afc_array_internal_resize(Array *am, unsigned long int size)
+{
+	void **mem;
+
+	if (am->arena)
+		mem = afc_arena_realloc(am->arena, am->mem, sizeof(void *) * am->max_items, sizeof(void *) * size);
+	else if (am->mem == NULL)
+		mem = afc_malloc_uninit(sizeof(void *) * size);
+	else
+		mem = afc_realloc(am->mem, sizeof(void *) * size);
+
+	if (mem == NULL)
+		return (AFC_ERR_NO_MEMORY);
+
+	am->mem = mem;
+	am->max_items = size;
 
 	return (AFC_ERR_NO_ERROR);
 }
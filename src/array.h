@@ -28,6 +28,8 @@
 #include "base.h"
 #include "string.h"
 #include "exceptions.h"
+#include "arena.h"
+#include "parallel_sort.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -41,6 +43,10 @@ extern "C"
 #define AFC_ARRAY_BASE 0x8000
 
 	/* Errors for afc_array */
+	enum
+	{
+		AFC_ARRAY_ERR_NOT_EMPTY = AFC_ARRAY_BASE + 1 /* The Arena cannot be changed on a non empty Array */
+	};
 
 #define AFC_ARRAY_DEFAULT_ITEMS 100
 
@@ -68,6 +74,8 @@ extern "C"
 
 		int (*func_clear)(void *);
 		void (*custom_sort)(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *));
+
+		Arena *arena; // If set, mem is allocated from this Arena
 	};
 
 	typedef struct afc_array Array;
@@ -109,6 +117,7 @@ extern "C"
 	int afc_array_for_each(Array *am, int (*func)(Array *am, int pos, void *v, void *info), void *info);
 	int afc_array_set_custom_sort(Array *am, void (*func)(void *base, size_t nmemb, size_t size, int (*compar)(const void *, const void *)));
 	int afc_array_before_first(Array *am);
+	int afc_array_set_arena(Array *am, Arena *arena);
 
 #ifdef __cplusplus
 }
@@ -112,9 +112,11 @@ AVLNode *_afc_avl_tree_insert(AVLTree *tree, AVLNode *node, void *key, void *val
 	{
 		// Create and return one-node tree
 
-		if ((node = afc_malloc(sizeof(AVLNode))) == NULL)
+		if ((node = afc_pool_alloc(sizeof(AVLNode))) == NULL)
 			RAISE_FAST(AFC_ERR_NO_MEMORY, "node");
 
+		node->left = node->right = NULL;
+		node->height = 0;
 		node->key = key;
 		node->val = val;
 	}
@@ -191,7 +193,7 @@ static int afc_avl_tree_int_clear(AVLTree *t, AVLNode *node)
 		// Calls the clear function
 		if (t->clear)
 			t->clear(node->val);
-		afc_free(node);
+		afc_pool_free(node, sizeof(AVLNode));
 	}
 
 	return (AFC_ERR_NO_ERROR);
@@ -17,6 +17,20 @@
  *
  */
 /*
+	1.26	- JSON log records write the code in hex, like the other formats. afc_log_flush() waits on a
+		  condition variable instead of polling
+
+	1.25	- afc_delete() gives the Pool blocks back with afc_pool_clear()
+
+	1.24	- Added async logging (AFC_TAG_LOG_MODE), one line and JSON formats (AFC_TAG_LOG_FORMAT),
+		  rate limiting per error code (AFC_TAG_LOG_RATE_LIMIT) and afc_log_flush()
+
+	1.23	- Added afc_tmp_string() and afc_last_error(): scratch and error strings are per thread
+
+	1.22	- Added AFC_TAG_MEM_REPORT and AFC_TAG_MEM_REPORT_FORMAT tags
+
+	1.21	- Added afc_malloc_uninit(). afc_malloc() uses calloc()
+
 	1.20	- Added Logging on external files
 		  Added afc_dprintf function.
 
@@ -26,13 +40,19 @@
 #include "base.h"
 #include "string.h"
 #include "mem_tracker.h"
+#include "pool.h"
 #include <errno.h>
+#include <time.h>
+
+#ifndef MINGW
+#include <semaphore.h>
+#endif
 
 // {{{ docs
 /*
 @config
 	TITLE:     AFCBase
-	VERSION:   1.20
+	VERSION:   1.24
 	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
 @endnode
 
@@ -120,6 +140,17 @@ want to discuss here are two handy macros:
 - ``AFC_DEBUG(afc,level,str)``: Writes a debug message on the standard error. Debug message level is defined by level
 				and the message is stored in str.
 
+
+-------
+Threads
+-------
+
+AFC Base can be used by many threads at once. The description of the last error (see AFC_STR_ERROR() and
+afc_last_error()) and the scratch string returned by afc_tmp_string() are kept per thread: the thread that called
+afc_new() uses the /last_error/ and /tmp_string/ fields of the AFC Base, while every other thread gets strings of its
+own, created on first use and freed when the thread exits. The lines of a single afc_log() message are never mixed
+with the ones written by other threads.
+
 @endnode
 */
 // }}}
@@ -131,6 +162,80 @@ struct afc_base *__internal_afc_base = NULL;
 static int afc_internal_parse_tags(AFC *afc, int first_tag, va_list tags);
 static void afc_internal_on_exit(void);
 
+static void afc_internal_log_write(AFC *afc, int level, unsigned int error, const char *class_name, const char *funct_name, const char *descr, const char *info);
+static int afc_internal_log_format(AFC *afc, char *buf, int size, int level, unsigned int error, const char *class_name, const char *funct_name, const char *descr, const char *info);
+static void afc_internal_log_append(char *buf, int size, int *pos, const char *fmt, ...);
+static void afc_internal_log_append_json(char *buf, int size, int *pos, const char *key, const char *val);
+static BOOL afc_internal_log_rate_check(AFC *afc, unsigned int error);
+
+/* Counters of an error code for the rate limiter */
+struct afc_log_rate_slot
+{
+	unsigned int code; // error code + 1 (0 means the slot is free)
+	long window;	   // Second the counter refers to
+	unsigned int count;
+	unsigned long suppressed;
+};
+
+struct afc_log_rate
+{
+	struct afc_log_rate_slot slots[AFC_LOG_RATE_SLOTS];
+};
+
+#ifndef MINGW
+/* A formatted record waiting in the async queue */
+struct afc_log_record
+{
+	unsigned long seq; // Queue position the record can be written or read at
+	FILE *fout;
+	int len;
+	char text[AFC_LOG_RECORD_SIZE];
+};
+
+/* Bounded multi producer / single consumer queue written by the log writer thread */
+struct afc_log_queue
+{
+	struct afc_log_record *records;
+	unsigned long head;	   // Next record to write (used by the writer thread only)
+	unsigned long tail;	   // Next record to fill
+	unsigned long written; // Records written so far
+	unsigned long dropped; // Records lost because the queue was full
+	int sleeping;		   // The writer is waiting on /wakeup/
+	int quit;
+	sem_t wakeup;
+	pthread_t writer;
+
+	int flush_waiters;		// Threads waiting in afc_log_flush()
+	pthread_mutex_t flush_mutex;
+	pthread_cond_t flushed; // Signaled by the writer when /written/ grows and someone is waiting
+};
+
+static int afc_internal_log_start(AFC *afc);
+static void afc_internal_log_stop(AFC *afc);
+static void afc_internal_log_enqueue(AFC *afc, int level, unsigned int error, const char *class_name, const char *funct_name, const char *descr, const char *info);
+static void afc_internal_log_wakeup(struct afc_log_queue *q);
+static void *afc_internal_log_writer(void *data);
+#endif
+
+#ifndef MINGW
+/* Scratch and error strings of threads other than the one that called afc_new() */
+struct afc_thread_context
+{
+	char *tmp_string;
+	char *last_error;
+};
+
+static __thread struct afc_thread_context afc_thread_context;
+
+static pthread_once_t afc_thread_once = PTHREAD_ONCE_INIT;
+static pthread_key_t afc_thread_key;
+
+static struct afc_thread_context *afc_internal_thread_context(void);
+static char *afc_internal_thread_string_new(unsigned long numchars);
+static void afc_internal_thread_exit(void *data);
+static void afc_internal_thread_key_create(void);
+#endif
+
 // {{{ afc_new ()
 /*
 @node afc_new
@@ -162,6 +267,9 @@ AFC *afc_new()
 
 	afc->start_log_level = 0;
 	afc->fout = stderr;
+#ifndef MINGW
+	afc->thread = pthread_self();
+#endif
 
 	__internal_afc_base = afc;
 
@@ -198,10 +306,11 @@ AFC *afc_new()
 
 		  RESULTS: should be AFC_ERR_NO_ERROR
 
-			NOTES: - this method calls: afc_clear()
+			NOTES: - this method calls: afc_clear() and afc_pool_clear()
 
 		 SEE ALSO: - afc_new()
 				   - afc_clear()
+				   - afc_pool_clear()
 @endnode
 */
 int afc_delete(AFC *afc)
@@ -211,10 +320,26 @@ int afc_delete(AFC *afc)
 	if ((afc_res = afc_clear(afc)) != AFC_ERR_NO_ERROR)
 		return (afc_res);
 
+	// Before the MemTracker report: blocks still holding objects are leaks
+	afc_pool_clear();
+
 	if (afc->tracker)
+	{
+		if (afc->tracker->report_file)
+			afc_mem_tracker_report(afc->tracker, afc->tracker->report_file, afc->tracker->report_format, AFC_MEM_TRACKER_SORT_LIVE);
+
 		afc_mem_tracker_delete(afc->tracker);
+	}
 	afc->tracker = NULL;
 
+#ifndef MINGW
+	// Queued records must reach afc->fout before it is closed
+	afc_internal_log_stop(afc);
+#endif
+	if (afc->log_rate)
+		free(afc->log_rate);
+	afc->log_rate = NULL;
+
 	if (afc->tmp_string)
 		afc_string_delete(afc->tmp_string);
 	if (afc->last_error)
@@ -300,17 +425,23 @@ int afc_clear(AFC *afc)
 		  RESULTS: 	this function returns the same error passed in the 'error' parameter. This is useful in cases where you want to
 			write stuff like: return ( afc_log ( ... ) );
 
+			NOTES: 	- The record layout is set with the AFC_TAG_LOG_FORMAT tag. With AFC_TAG_LOG_MODE set to AFC_LOG_MODE_ASYNC
+			  the record is only queued, and a background thread writes it. See afc_set_tag().
+			- When AFC_TAG_LOG_RATE_LIMIT is set, records with the same error code exceeding the limit in the same second
+			  are not written (last_error is updated anyway), and their number is reported in the next second.
+
 		 SEE ALSO: 	- afc_log_fast ()
+			- afc_log_flush ()
 			- afc_debug ()
 
 @endnode
 */
 int afc_log(AFC *afc, int level, unsigned int error, const char *class_name, const char *funct_name, const char *descr, const char *info)
 {
-	static char *str_level[] = {"MESSAGE", "NOTICE", "WARNING", "ERROR", "CRITICAL", NULL};
+	char *last_error;
 
-	if ((descr != NULL) && (afc->last_error != NULL))
-		afc_string_copy(afc->last_error, descr, ALL);
+	if ((descr != NULL) && ((last_error = afc_last_error()) != NULL))
+		afc_string_copy(last_error, descr, ALL);
 
 	if (afc->fout == NULL)
 		return (error);
@@ -323,19 +454,12 @@ int afc_log(AFC *afc, int level, unsigned int error, const char *class_name, con
 	if (level < afc->start_log_level)
 		return (error);
 
-	fprintf(afc->fout, "------------------------ %s -------------------------\n", str_level[level]);
-
-	if (class_name)
-		fprintf(afc->fout, "Class: %s\n", class_name);
-	if (funct_name)
-		fprintf(afc->fout, "Funct: %s\n", funct_name);
-	if (descr)
-		fprintf(afc->fout, "Descr: %s\n", descr);
-	if (info)
-		fprintf(afc->fout, " Info: %s\n", info);
+	if ((afc->log_rate_limit > 0) && (afc->log_rate != NULL) && (!afc_internal_log_rate_check(afc, error)))
+		return (error);
 
-	fprintf(afc->fout, " Code: %x\n", error);
+	afc_internal_log_write(afc, level, error, class_name, funct_name, descr, info);
 
+	// exit() calls afc_delete(), that writes the records still queued
 	if ((level == AFC_LOG_CRITICAL) && (afc->log_exit_critical))
 		exit(1);
 
@@ -424,6 +548,63 @@ int afc_log_fast(AFC *afc, unsigned int error, const char *class_name, const cha
 	return (error);
 }
 // }}}
+// {{{ afc_log_flush ( afc )
+/*
+@node afc_log_flush
+
+			 NAME: afc_log_flush ( afc ) - Waits until all queued log records have been written
+
+		 SYNOPSIS: int afc_log_flush ( AFC * afc )
+
+			SINCE: 1.24
+
+	  DESCRIPTION: In AFC_LOG_MODE_ASYNC mode, this function waits until the background writer has written (and flushed)
+				   all the records queued before the call. In AFC_LOG_MODE_SYNC mode it just flushes the output file.
+
+			INPUT: 	- afc    	- Pointer to a valid afc instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+		 SEE ALSO: 	- afc_log ()
+			- afc_set_tag ()
+@endnode
+*/
+int afc_log_flush(AFC *afc)
+{
+#ifndef MINGW
+	struct afc_log_queue *q;
+	unsigned long target;
+#endif
+
+	if (afc == NULL)
+		return (AFC_ERR_NULL_POINTER);
+
+#ifndef MINGW
+	if ((q = afc->log_queue) != NULL)
+	{
+		target = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+
+		// Dropped records never get a position in the queue, so they are not waited for
+		pthread_mutex_lock(&q->flush_mutex);
+		__atomic_add_fetch(&q->flush_waiters, 1, __ATOMIC_SEQ_CST);
+		afc_internal_log_wakeup(q);
+
+		while (__atomic_load_n(&q->written, __ATOMIC_SEQ_CST) < target)
+			pthread_cond_wait(&q->flushed, &q->flush_mutex);
+
+		__atomic_sub_fetch(&q->flush_waiters, 1, __ATOMIC_SEQ_CST);
+		pthread_mutex_unlock(&q->flush_mutex);
+
+		return (AFC_ERR_NO_ERROR);
+	}
+#endif
+
+	if (afc->fout)
+		fflush(afc->fout);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
 // {{{ afc_debug ( afc, level, class_name, message )
 /*
 @node afc_debug
@@ -596,6 +777,37 @@ int _afc_set_tags(AFC *afc, int first_tag, ...)
 						* an already opened FILE pointer. You must handle file opening and closing.
 						* By passing a NULL value, you completely turn off debug messages.
 
+					+ AFC_TAG_MEM_REPORT	- File where afc_delete() writes the MemTracker allocation sites
+							  report (only when MemTracker is active). See afc_mem_tracker_report().
+
+						* an already opened FILE pointer. You must handle file opening and closing.
+						* NULL		- No report is written (default)
+
+					+ AFC_TAG_MEM_REPORT_FORMAT	- Format of the report written by afc_delete():
+
+						* AFC_MEM_TRACKER_REPORT_TEXT	- A table for humans (default)
+						* AFC_MEM_TRACKER_REPORT_CSV	- Comma separated values
+
+					+ AFC_TAG_LOG_MODE	- How afc_log() writes its records:
+
+						* AFC_LOG_MODE_SYNC	- Records are written by the calling thread (default)
+						* AFC_LOG_MODE_ASYNC	- Records are formatted in a queue of AFC_LOG_QUEUE_SIZE entries and a
+							  background thread writes them in batches. When the queue is full, records are dropped
+							  and their number is reported. Switching back to AFC_LOG_MODE_SYNC (or calling afc_delete())
+							  writes all the queued records and stops the thread. Not available under MINGW.
+
+					+ AFC_TAG_LOG_FORMAT	- Layout of the records written by afc_log():
+
+						* AFC_LOG_FORMAT_CLASSIC	- The usual multi line block (default)
+						* AFC_LOG_FORMAT_LINE	- One line per record, with a UTC timestamp
+						* AFC_LOG_FORMAT_JSON	- One JSON object per line, with "ts", "level", "class", "funct",
+							  "descr", "info" and "code" fields ("code" is an hex string like "0x10", as
+							  in the other formats)
+
+					+ AFC_TAG_LOG_RATE_LIMIT	- Max number of records per second written for every error code.
+							  Records exceeding the limit are counted and reported in the next second. 0 means no
+							  limit (default).
+
 			- val    - Value to set to the tag
 
 		  RESULTS: should be AFC_ERR_NO_ERROR
@@ -632,6 +844,40 @@ int afc_set_tag(AFC *afc, int tag, void *val)
 	case AFC_TAG_OUTPUT_FILE:
 		afc->fout = (FILE *)val;
 		break;
+
+	case AFC_TAG_MEM_REPORT:
+		if (afc->tracker)
+			afc->tracker->report_file = (FILE *)val;
+		break;
+
+	case AFC_TAG_MEM_REPORT_FORMAT:
+		if (afc->tracker)
+			afc->tracker->report_format = (int)(long)val;
+		break;
+
+	case AFC_TAG_LOG_MODE:
+#ifndef MINGW
+		if ((int)(long)val == AFC_LOG_MODE_ASYNC)
+			return (afc_internal_log_start(afc));
+
+		afc_internal_log_stop(afc);
+#endif
+		break;
+
+	case AFC_TAG_LOG_FORMAT:
+		afc->log_format = (int)(long)val;
+		break;
+
+	case AFC_TAG_LOG_RATE_LIMIT:
+		if ((afc->log_rate == NULL) && ((int)(long)val > 0))
+		{
+			if ((afc->log_rate = malloc(sizeof(struct afc_log_rate))) == NULL)
+				return (AFC_ERR_NO_MEMORY);
+
+			memset(afc->log_rate, 0, sizeof(struct afc_log_rate));
+		}
+		afc->log_rate_limit = (int)(long)val;
+		break;
 	}
 
 	return (AFC_ERR_NO_ERROR);
@@ -654,7 +900,12 @@ int afc_set_tag(AFC *afc, int tag, void *val)
 
 		  RESULTS: should be a valid pointer to the memory just alloc'd, or NULL in case of errors.
 
+		NOTES: - Memory is taken with calloc(3), so big blocks coming straight from the system
+				 are not cleared twice.
+			   - If you are going to overwrite the memory anyway, use afc_malloc_uninit().
+
 		 SEE ALSO: - afc_free()
+			   - afc_malloc_uninit()
 @endnode
 */
 void *_afc_malloc(size_t size, const char *file_name, const char *func_name, const unsigned int line)
@@ -663,12 +914,53 @@ void *_afc_malloc(size_t size, const char *file_name, const char *func_name, con
 
 	if (__internal_afc_base->tracker == NULL)
 	{
-		mem = malloc(size);
+		if ((mem = calloc(1, size)) == NULL)
+		{
+			AFC_LOG_FAST(AFC_ERR_NO_MEMORY);
+			return NULL;
+		}
+
+		return mem;
 	}
+
+	if ((mem = _afc_malloc_uninit(size, file_name, func_name, line)) == NULL)
+		return NULL;
+
+	memset(mem, 0, size);
+	return mem;
+}
+// }}}
+// {{{ afc_malloc_uninit ( size )
+/*
+@node afc_malloc_uninit
+
+			 NAME: afc_malloc_uninit ( size ) - Allocates memory without clearing it
+
+		 SYNOPSIS: void * afc_malloc_uninit ( size_t size )
+
+			SINCE: 1.21
+
+	  DESCRIPTION: 	This function works just like afc_malloc(), but the memory is *not* cleared.
+			Use it for buffers you are going to overwrite anyway.
+
+			INPUT: - size   - Size (in bytes) of the memory chunk you want to alloc.
+
+		  RESULTS: should be a valid pointer to the memory just alloc'd, or NULL in case of errors.
+
+		NOTES: - Memory must be freed with afc_free(), and it is seen by MemTracker.
+
+		 SEE ALSO: - afc_malloc()
+			   - afc_free()
+@endnode
+*/
+void *_afc_malloc_uninit(size_t size, const char *file_name, const char *func_name, const unsigned int line)
+{
+	void *mem;
+
+	if (__internal_afc_base->tracker == NULL)
+		mem = malloc(size);
 	else
-	{
 		mem = afc_mem_tracker_malloc(__internal_afc_base->tracker, size, file_name, func_name, line);
-	}
 
 	if (mem == NULL)
 	{
@@ -676,7 +968,6 @@ void *_afc_malloc(size_t size, const char *file_name, const char *func_name, con
 		return NULL;
 	}
 
-	memset(mem, 0, size);
 	return mem;
 }
 // }}}
@@ -812,6 +1103,102 @@ int _afc_dprintf(const char *fmt, ...)
 }
 // }}}
 
+// {{{ afc_tmp_string ()
+/*
+@node afc_tmp_string
+
+			 NAME: afc_tmp_string ()  - Returns the scratch string of the calling thread
+
+		 SYNOPSIS: char * afc_tmp_string ( void )
+
+			SINCE: 1.23
+
+	  DESCRIPTION: This function returns a 255 chars AFC String that can be used as a temporary buffer (for example,
+				   to format the /info/ field of an afc_log() call). Every thread gets its own string, so classes
+				   running in different threads never write in the same buffer.
+
+			INPUT: NONE
+
+		  RESULTS: a valid AFC String, or NULL if there is no memory for it.
+
+			NOTES: - In the thread that called afc_new() this is the /tmp_string/ field of the AFC Base.
+				   - Strings of the other threads are created on first use and freed when the thread exits.
+
+		 SEE ALSO: - afc_last_error()
+@endnode
+*/
+char *afc_tmp_string(void)
+{
+#ifndef MINGW
+	struct afc_thread_context *ctx;
+
+	if ((__internal_afc_base != NULL) && pthread_equal(__internal_afc_base->thread, pthread_self()))
+		return (__internal_afc_base->tmp_string);
+
+	if ((ctx = afc_internal_thread_context()) == NULL)
+		return (NULL);
+
+	if (ctx->tmp_string == NULL)
+		ctx->tmp_string = afc_internal_thread_string_new(255);
+
+	return (ctx->tmp_string);
+#else
+	if (__internal_afc_base == NULL)
+		return (NULL);
+
+	return (__internal_afc_base->tmp_string);
+#endif
+}
+// }}}
+// {{{ afc_last_error ()
+/*
+@node afc_last_error
+
+			 NAME: afc_last_error ()  - Returns the last error logged by the calling thread
+
+		 SYNOPSIS: char * afc_last_error ( void )
+
+			SINCE: 1.23
+
+	  DESCRIPTION: This function returns the description of the last error logged with afc_log() (or one of the
+				   AFC_LOG macros) by the calling thread. Errors logged by other threads are not reported.
+				   This is the function behind the AFC_STR_ERROR() macro.
+
+			INPUT: NONE
+
+		  RESULTS: a valid AFC String (empty if no error has been logged yet), or NULL if there is no memory for it.
+
+			NOTES: - In the thread that called afc_new() this is the /last_error/ field of the AFC Base.
+				   - Strings of the other threads are created on first use and freed when the thread exits.
+
+		 SEE ALSO: - afc_tmp_string()
+				   - afc_log()
+@endnode
+*/
+char *afc_last_error(void)
+{
+#ifndef MINGW
+	struct afc_thread_context *ctx;
+
+	if ((__internal_afc_base != NULL) && pthread_equal(__internal_afc_base->thread, pthread_self()))
+		return (__internal_afc_base->last_error);
+
+	if ((ctx = afc_internal_thread_context()) == NULL)
+		return (NULL);
+
+	if (ctx->last_error == NULL)
+		ctx->last_error = afc_internal_thread_string_new(255);
+
+	return (ctx->last_error);
+#else
+	if (__internal_afc_base == NULL)
+		return (NULL);
+
+	return (__internal_afc_base->last_error);
+#endif
+}
+// }}}
+
 /* =======================================================================================================
 	INTERNAL FUNCTIONS
 ======================================================================================================= */
@@ -842,6 +1229,493 @@ static void afc_internal_on_exit(void)
 }
 // }}}
 
+// {{{ afc_internal_log_write ( afc, level, error, class_name, funct_name, descr, info )
+static void afc_internal_log_write(AFC *afc, int level, unsigned int error, const char *class_name, const char *funct_name, const char *descr, const char *info)
+{
+	static char *str_level[] = {"MESSAGE", "NOTICE", "WARNING", "ERROR", "CRITICAL", NULL};
+	char buf[AFC_LOG_RECORD_SIZE];
+	int len;
+
+#ifndef MINGW
+	if (afc->log_queue)
+	{
+		afc_internal_log_enqueue(afc, level, error, class_name, funct_name, descr, info);
+		return;
+	}
+#endif
+
+	if (afc->log_format != AFC_LOG_FORMAT_CLASSIC)
+	{
+		len = afc_internal_log_format(afc, buf, sizeof(buf), level, error, class_name, funct_name, descr, info);
+		fwrite(buf, 1, len, afc->fout);
+		return;
+	}
+
+#ifndef MINGW
+	// Keep the lines of a message together when many threads are logging
+	flockfile(afc->fout);
+#endif
+	fprintf(afc->fout, "------------------------ %s -------------------------\n", str_level[level]);
+
+	if (class_name)
+		fprintf(afc->fout, "Class: %s\n", class_name);
+	if (funct_name)
+		fprintf(afc->fout, "Funct: %s\n", funct_name);
+	if (descr)
+		fprintf(afc->fout, "Descr: %s\n", descr);
+	if (info)
+		fprintf(afc->fout, " Info: %s\n", info);
+
+	fprintf(afc->fout, " Code: %x\n", error);
+#ifndef MINGW
+	funlockfile(afc->fout);
+#endif
+}
+// }}}
+// {{{ afc_internal_log_format ( afc, buf, size, level, error, class_name, funct_name, descr, info )
+/*
+   Formats a record in /buf/ and returns its length. The record always ends with a newline, even when truncated.
+*/
+static int afc_internal_log_format(AFC *afc, char *buf, int size, int level, unsigned int error, const char *class_name, const char *funct_name, const char *descr, const char *info)
+{
+	static char *str_level[] = {"MESSAGE", "NOTICE", "WARNING", "ERROR", "CRITICAL", NULL};
+	char ts[64];
+	struct tm tm;
+	time_t now;
+	long msec;
+	int pos = 0;
+
+#ifndef MINGW
+	struct timespec tspec;
+
+	clock_gettime(CLOCK_REALTIME, &tspec);
+	now = tspec.tv_sec;
+	msec = tspec.tv_nsec / 1000000;
+	gmtime_r(&now, &tm);
+#else
+	now = time(NULL);
+	msec = 0;
+	tm = *gmtime(&now);
+#endif
+	snprintf(ts, sizeof(ts), "%04d-%02d-%02dT%02d:%02d:%02d.%03ldZ", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, msec);
+
+	switch (afc->log_format)
+	{
+	case AFC_LOG_FORMAT_LINE:
+		afc_internal_log_append(buf, size, &pos, "%s %s [%s] %s: %s", ts, str_level[level], class_name ? class_name : "", funct_name ? funct_name : "", descr ? descr : "");
+		if (info)
+			afc_internal_log_append(buf, size, &pos, " (%s)", info);
+		afc_internal_log_append(buf, size, &pos, " code=0x%x\n", error);
+		break;
+
+	case AFC_LOG_FORMAT_JSON:
+		afc_internal_log_append(buf, size, &pos, "{\"ts\":\"%s\",\"level\":\"%s\"", ts, str_level[level]);
+		afc_internal_log_append_json(buf, size, &pos, "class", class_name);
+		afc_internal_log_append_json(buf, size, &pos, "funct", funct_name);
+		afc_internal_log_append_json(buf, size, &pos, "descr", descr);
+		afc_internal_log_append_json(buf, size, &pos, "info", info);
+		afc_internal_log_append(buf, size, &pos, ",\"code\":\"0x%x\"}\n", error);
+		break;
+
+	default:
+		afc_internal_log_append(buf, size, &pos, "------------------------ %s -------------------------\n", str_level[level]);
+		if (class_name)
+			afc_internal_log_append(buf, size, &pos, "Class: %s\n", class_name);
+		if (funct_name)
+			afc_internal_log_append(buf, size, &pos, "Funct: %s\n", funct_name);
+		if (descr)
+			afc_internal_log_append(buf, size, &pos, "Descr: %s\n", descr);
+		if (info)
+			afc_internal_log_append(buf, size, &pos, " Info: %s\n", info);
+		afc_internal_log_append(buf, size, &pos, " Code: %x\n", error);
+		break;
+	}
+
+	if (pos >= size - 1)
+	{
+		// Truncated: keep the record on its own line(s)
+		pos = size - 1;
+		buf[pos - 1] = '\n';
+		buf[pos] = '\0';
+	}
+
+	return (pos);
+}
+// }}}
+// {{{ afc_internal_log_append ( buf, size, pos, fmt, ... )
+static void afc_internal_log_append(char *buf, int size, int *pos, const char *fmt, ...)
+{
+	va_list args;
+	int len;
+
+	if (*pos >= size - 1)
+		return;
+
+	va_start(args, fmt);
+	len = vsnprintf(buf + *pos, size - *pos, fmt, args);
+	va_end(args);
+
+	if (len < 0)
+		return;
+
+	*pos += len;
+	if (*pos > size - 1)
+		*pos = size - 1;
+}
+// }}}
+// {{{ afc_internal_log_append_json ( buf, size, pos, key, val )
+static void afc_internal_log_append_json(char *buf, int size, int *pos, const char *key, const char *val)
+{
+	const unsigned char *s;
+
+	if (val == NULL)
+	{
+		afc_internal_log_append(buf, size, pos, ",\"%s\":null", key);
+		return;
+	}
+
+	afc_internal_log_append(buf, size, pos, ",\"%s\":\"", key);
+
+	for (s = (const unsigned char *)val; (*s) && (*pos < size - 1); s++)
+	{
+		switch (*s)
+		{
+		case '"':
+			afc_internal_log_append(buf, size, pos, "\\\"");
+			break;
+		case '\\':
+			afc_internal_log_append(buf, size, pos, "\\\\");
+			break;
+		case '\n':
+			afc_internal_log_append(buf, size, pos, "\\n");
+			break;
+		case '\r':
+			afc_internal_log_append(buf, size, pos, "\\r");
+			break;
+		case '\t':
+			afc_internal_log_append(buf, size, pos, "\\t");
+			break;
+		default:
+			if (*s < 0x20)
+				afc_internal_log_append(buf, size, pos, "\\u%04x", *s);
+			else
+			{
+				buf[(*pos)++] = *s;
+				buf[*pos] = '\0';
+			}
+			break;
+		}
+	}
+
+	afc_internal_log_append(buf, size, pos, "\"");
+}
+// }}}
+// {{{ afc_internal_log_rate_check ( afc, error )
+/*
+   Returns TRUE if a record with the /error/ code can be written in the current second.
+   Counters are updated with atomic operations, so the limit is approximate when many threads log at once.
+*/
+static BOOL afc_internal_log_rate_check(AFC *afc, unsigned int error)
+{
+	struct afc_log_rate_slot *slot = NULL;
+	unsigned int key = error + 1, code;
+	unsigned long suppressed;
+	long now = (long)time(NULL), window;
+	char info[64];
+	int t, pos;
+
+	pos = (int)((error * 2654435761U) >> 26) & (AFC_LOG_RATE_SLOTS - 1);
+
+	for (t = 0; t < AFC_LOG_RATE_SLOTS; t++, pos = (pos + 1) & (AFC_LOG_RATE_SLOTS - 1))
+	{
+		code = __atomic_load_n(&afc->log_rate->slots[pos].code, __ATOMIC_ACQUIRE);
+
+		if ((code == 0) && (__atomic_compare_exchange_n(&afc->log_rate->slots[pos].code, &code, key, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)))
+			code = key;
+
+		if (code == key)
+		{
+			slot = &afc->log_rate->slots[pos];
+			break;
+		}
+	}
+
+	// Too many different codes: they are not limited
+	if (slot == NULL)
+		return (TRUE);
+
+	window = __atomic_load_n(&slot->window, __ATOMIC_ACQUIRE);
+	if ((window != now) && (__atomic_compare_exchange_n(&slot->window, &window, now, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)))
+	{
+		__atomic_store_n(&slot->count, 0, __ATOMIC_RELEASE);
+
+		if ((suppressed = __atomic_exchange_n(&slot->suppressed, 0, __ATOMIC_ACQ_REL)) > 0)
+		{
+			snprintf(info, sizeof(info), "%lu records with code %x", suppressed, error);
+			afc_internal_log_write(afc, AFC_LOG_NOTICE, error, class_name, "afc_log", "Records suppressed by the rate limit", info);
+		}
+	}
+
+	if (__atomic_add_fetch(&slot->count, 1, __ATOMIC_ACQ_REL) > (unsigned int)afc->log_rate_limit)
+	{
+		__atomic_add_fetch(&slot->suppressed, 1, __ATOMIC_ACQ_REL);
+		return (FALSE);
+	}
+
+	return (TRUE);
+}
+// }}}
+
+#ifndef MINGW
+// {{{ afc_internal_log_start ( afc )
+static int afc_internal_log_start(AFC *afc)
+{
+	struct afc_log_queue *q;
+	unsigned long t;
+
+	if (afc->log_queue != NULL)
+		return (AFC_ERR_NO_ERROR);
+
+	if ((q = malloc(sizeof(struct afc_log_queue))) == NULL)
+		return (AFC_ERR_NO_MEMORY);
+
+	memset(q, 0, sizeof(struct afc_log_queue));
+
+	if ((q->records = malloc(sizeof(struct afc_log_record) * AFC_LOG_QUEUE_SIZE)) == NULL)
+	{
+		free(q);
+		return (AFC_ERR_NO_MEMORY);
+	}
+
+	for (t = 0; t < AFC_LOG_QUEUE_SIZE; t++)
+		q->records[t].seq = t;
+
+	sem_init(&q->wakeup, 0, 0);
+	pthread_mutex_init(&q->flush_mutex, NULL);
+	pthread_cond_init(&q->flushed, NULL);
+
+	if (pthread_create(&q->writer, NULL, afc_internal_log_writer, q) != 0)
+	{
+		pthread_cond_destroy(&q->flushed);
+		pthread_mutex_destroy(&q->flush_mutex);
+		sem_destroy(&q->wakeup);
+		free(q->records);
+		free(q);
+		return (AFC_ERR_NO_MEMORY);
+	}
+
+	__atomic_store_n(&afc->log_queue, q, __ATOMIC_RELEASE);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_internal_log_stop ( afc )
+/*
+   Writes all the queued records and stops the writer thread.
+   No other thread should call afc_log() while the mode is changing.
+*/
+static void afc_internal_log_stop(AFC *afc)
+{
+	struct afc_log_queue *q = afc->log_queue;
+
+	if (q == NULL)
+		return;
+
+	__atomic_store_n(&q->quit, 1, __ATOMIC_RELEASE);
+	sem_post(&q->wakeup);
+	pthread_join(q->writer, NULL);
+
+	afc->log_queue = NULL;
+
+	pthread_cond_destroy(&q->flushed);
+	pthread_mutex_destroy(&q->flush_mutex);
+	sem_destroy(&q->wakeup);
+	free(q->records);
+	free(q);
+}
+// }}}
+// {{{ afc_internal_log_enqueue ( afc, level, error, class_name, funct_name, descr, info )
+static void afc_internal_log_enqueue(AFC *afc, int level, unsigned int error, const char *class_name, const char *funct_name, const char *descr, const char *info)
+{
+	struct afc_log_queue *q = afc->log_queue;
+	struct afc_log_record *rec;
+	unsigned long pos, seq;
+	long diff;
+
+	pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+
+	for (;;)
+	{
+		rec = &q->records[pos & (AFC_LOG_QUEUE_SIZE - 1)];
+		seq = __atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE);
+		diff = (long)seq - (long)pos;
+
+		if (diff == 0)
+		{
+			// The record is free: try to take it (on failure /pos/ gets the new tail)
+			if (__atomic_compare_exchange_n(&q->tail, &pos, pos + 1, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+				break;
+		}
+		else if (diff < 0)
+		{
+			// Queue full: the record is lost, the writer will report how many
+			__atomic_add_fetch(&q->dropped, 1, __ATOMIC_ACQ_REL);
+			afc_internal_log_wakeup(q);
+			return;
+		}
+		else
+			pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+	}
+
+	rec->fout = afc->fout;
+	rec->len = afc_internal_log_format(afc, rec->text, sizeof(rec->text), level, error, class_name, funct_name, descr, info);
+
+	__atomic_store_n(&rec->seq, pos + 1, __ATOMIC_SEQ_CST);
+
+	afc_internal_log_wakeup(q);
+}
+// }}}
+// {{{ afc_internal_log_wakeup ( q )
+static void afc_internal_log_wakeup(struct afc_log_queue *q)
+{
+	// Pairs with the writer setting /sleeping/ and checking the queue again before sem_wait()
+	if (__atomic_exchange_n(&q->sleeping, 0, __ATOMIC_SEQ_CST))
+		sem_post(&q->wakeup);
+}
+// }}}
+// {{{ afc_internal_log_writer ( data )
+static void *afc_internal_log_writer(void *data)
+{
+	struct afc_log_queue *q = (struct afc_log_queue *)data;
+	struct afc_log_record *rec;
+	FILE *fout = NULL;
+	unsigned long count, dropped, reported = 0;
+
+	for (;;)
+	{
+		count = 0;
+
+		// Write all the records ready, flushing each file once per batch
+		for (;;)
+		{
+			rec = &q->records[q->head & (AFC_LOG_QUEUE_SIZE - 1)];
+			if (__atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE) != q->head + 1)
+				break;
+
+			if ((fout != NULL) && (rec->fout != fout))
+				fflush(fout);
+			fout = rec->fout;
+
+			if (fout)
+				fwrite(rec->text, 1, rec->len, fout);
+
+			__atomic_store_n(&rec->seq, q->head + AFC_LOG_QUEUE_SIZE, __ATOMIC_RELEASE);
+			q->head++;
+			count++;
+		}
+
+		dropped = __atomic_load_n(&q->dropped, __ATOMIC_ACQUIRE);
+		if ((dropped != reported) && (fout != NULL))
+		{
+			fprintf(fout, "afc_log: %lu records dropped (queue full)\n", dropped - reported);
+			reported = dropped;
+			count++;
+		}
+
+		if (count)
+		{
+			if (fout)
+				fflush(fout);
+
+			// Pairs with afc_log_flush() adding itself to /flush_waiters/ before checking /written/
+			__atomic_store_n(&q->written, q->head, __ATOMIC_SEQ_CST);
+			if (__atomic_load_n(&q->flush_waiters, __ATOMIC_SEQ_CST))
+			{
+				pthread_mutex_lock(&q->flush_mutex);
+				pthread_cond_broadcast(&q->flushed);
+				pthread_mutex_unlock(&q->flush_mutex);
+			}
+			continue;
+		}
+
+		if (__atomic_load_n(&q->quit, __ATOMIC_ACQUIRE))
+			break;
+
+		// Sleep, unless a record arrived while we were getting ready
+		__atomic_store_n(&q->sleeping, 1, __ATOMIC_SEQ_CST);
+		rec = &q->records[q->head & (AFC_LOG_QUEUE_SIZE - 1)];
+		if ((__atomic_load_n(&rec->seq, __ATOMIC_SEQ_CST) == q->head + 1) || __atomic_load_n(&q->quit, __ATOMIC_SEQ_CST))
+		{
+			__atomic_store_n(&q->sleeping, 0, __ATOMIC_SEQ_CST);
+			continue;
+		}
+
+		while ((sem_wait(&q->wakeup) != 0) && (errno == EINTR))
+			;
+	}
+
+	return (NULL);
+}
+// }}}
+#endif
+
+#ifndef MINGW
+// {{{ afc_internal_thread_context ()
+static struct afc_thread_context *afc_internal_thread_context(void)
+{
+	struct afc_thread_context *ctx = &afc_thread_context;
+
+	if (pthread_once(&afc_thread_once, afc_internal_thread_key_create) != 0)
+		return (NULL);
+
+	// The key value is only used to get afc_internal_thread_exit() called when the thread exits
+	if ((ctx->tmp_string == NULL) && (ctx->last_error == NULL))
+		pthread_setspecific(afc_thread_key, ctx);
+
+	return (ctx);
+}
+// }}}
+// {{{ afc_internal_thread_string_new ( numchars )
+/*
+   Thread strings are not allocated with afc_malloc(): they may outlive the AFC Base and its MemTracker.
+*/
+static char *afc_internal_thread_string_new(unsigned long numchars)
+{
+	unsigned long *location;
+
+	if ((location = malloc((sizeof(unsigned long) * 2) + numchars + 1)) == NULL)
+		return (NULL);
+
+	location[0] = numchars + 1;
+	location[1] = 0L;
+
+	((char *)(location + 2))[0] = '\0';
+
+	return ((char *)(location + 2));
+}
+// }}}
+// {{{ afc_internal_thread_exit ( data )
+static void afc_internal_thread_exit(void *data)
+{
+	struct afc_thread_context *ctx = (struct afc_thread_context *)data;
+
+	if (ctx->tmp_string)
+		free(((unsigned long *)ctx->tmp_string) - 2);
+	if (ctx->last_error)
+		free(((unsigned long *)ctx->last_error) - 2);
+
+	ctx->tmp_string = NULL;
+	ctx->last_error = NULL;
+}
+// }}}
+// {{{ afc_internal_thread_key_create ()
+static void afc_internal_thread_key_create(void)
+{
+	pthread_key_create(&afc_thread_key, afc_internal_thread_exit);
+}
+// }}}
+#endif
+
 #ifdef TEST_CLASS
 // {{{ TEST_CLASS
 int main(int argc, char *argv[])
@@ -25,6 +25,10 @@
 #include <string.h>
 #include <malloc.h>
 
+#ifndef MINGW
+#include <pthread.h>
+#endif
+
 #include "mem_tracker.h"
 
 #ifdef __cplusplus
@@ -104,9 +108,34 @@ extern "C"
 		AFC_TAG_DEBUG_LEVEL,
 		AFC_TAG_SHOW_MALLOCS,
 		AFC_TAG_SHOW_FREES,
-		AFC_TAG_OUTPUT_FILE
+		AFC_TAG_OUTPUT_FILE,
+		AFC_TAG_MEM_REPORT,		   /* FILE * where afc_delete() writes the MemTracker report */
+		AFC_TAG_MEM_REPORT_FORMAT, /* AFC_MEM_TRACKER_REPORT_TEXT or AFC_MEM_TRACKER_REPORT_CSV */
+		AFC_TAG_LOG_MODE,		   /* AFC_LOG_MODE_SYNC or AFC_LOG_MODE_ASYNC */
+		AFC_TAG_LOG_FORMAT,		   /* AFC_LOG_FORMAT_CLASSIC, AFC_LOG_FORMAT_LINE or AFC_LOG_FORMAT_JSON */
+		AFC_TAG_LOG_RATE_LIMIT	   /* Max records per second for every error code (0 = no limit) */
+	};
+
+	enum
+	{
+		AFC_LOG_MODE_SYNC = 0, // Records are written by the thread calling afc_log()
+		AFC_LOG_MODE_ASYNC	   // Records are queued and written by a background thread
 	};
 
+	enum
+	{
+		AFC_LOG_FORMAT_CLASSIC = 0, // The usual multi line block
+		AFC_LOG_FORMAT_LINE,		// One line per record
+		AFC_LOG_FORMAT_JSON			// One JSON object per line
+	};
+
+/* Number of records the async log queue can hold (must be a power of two) */
+#define AFC_LOG_QUEUE_SIZE 1024
+/* Max size of a formatted record in async mode (longer records are truncated) */
+#define AFC_LOG_RECORD_SIZE 512
+/* Number of different error codes tracked by the rate limiter */
+#define AFC_LOG_RATE_SLOTS 64
+
 #define AFC_LOG(level, error, descr, info) afc_log(__internal_afc_base, level, error, class_name, __FUNCTION__, descr, info)
 #define AFC_LOG_FAST(error) afc_log_fast(__internal_afc_base, error, class_name, __FUNCTION__, NULL)
 #define AFC_LOG_FAST_INFO(error, info) afc_log_fast(__internal_afc_base, error, class_name, __FUNCTION__, info)
@@ -122,7 +151,7 @@ extern "C"
 
 #define AFC_CLASS_NAME(buf, class) AFC_CLASS_TYPE(buf, AFC_CLASS_MAGIC(class))
 
-#define AFC_STR_ERROR() __internal_afc_base->last_error
+#define AFC_STR_ERROR() afc_last_error()
 
 	struct afc_base
 	{
@@ -132,12 +161,21 @@ extern "C"
 		short log_exit_critical; // Flag T/F. If T and the log level is CRITICAL, the program will exit ( default: FALSE )
 		int debug_level;		 // Debug level (to show some msg on stderr). See AFC_DEBUG_*
 
-		char *tmp_string; //
-		char *last_error; // Last error by afc_log()
+		char *tmp_string; // Scratch string of the thread that called afc_new() (use afc_tmp_string())
+		char *last_error; // Last error by afc_log() in the thread that called afc_new() (use afc_last_error())
 
 		struct _memtrack *tracker;
 
 		FILE *fout; // Output file handler (used for loggin functions)
+
+		int log_format;					 // One of AFC_LOG_FORMAT_*
+		int log_rate_limit;				 // Max records per second per error code (0 = no limit)
+		struct afc_log_rate *log_rate;	 // Rate limiter counters (NULL if never enabled)
+		struct afc_log_queue *log_queue; // Async queue (NULL in AFC_LOG_MODE_SYNC)
+
+#ifndef MINGW
+		pthread_t thread; // Thread that called afc_new()
+#endif
 	};
 
 	typedef struct afc_base AFC;
@@ -150,17 +188,23 @@ extern "C"
 
 	int afc_log(AFC *afc, int level, unsigned int error, const char *class_name, const char *funct_name, const char *descr, const char *info);
 	int afc_log_fast(AFC *afc, unsigned int error, const char *class_name, const char *funct_name, const char *info);
+	int afc_log_flush(AFC *afc);
 #define afc_set_tags(afc, first_tag, ...) _afc_set_tags(afc, first_tag, ##__VA_ARGS__, AFC_TAG_END)
 	int _afc_set_tags(AFC *afc, int first_tag, ...);
 	int afc_set_tag(AFC *afc, int tag, void *val);
 
+	char *afc_tmp_string(void);
+	char *afc_last_error(void);
+
 	int afc_debug(AFC *afc, int level, const char *class_name, const char *str);
 	int afc_debug_adv(AFC *afc, int level, const char *class_name, const char *fmt, ...);
 
 #define afc_malloc(size) _afc_malloc(size, __FILE__, __FUNCTION__, __LINE__)
+#define afc_malloc_uninit(size) _afc_malloc_uninit(size, __FILE__, __FUNCTION__, __LINE__)
 #define afc_realloc(mem, size) _afc_realloc(mem, size, __FILE__, __FUNCTION__, __LINE__)
 
 	void *_afc_malloc(size_t size, const char *file_name, const char *func_name, const unsigned int line);
+	void *_afc_malloc_uninit(size_t size, const char *file_name, const char *func_name, const unsigned int line);
 	void _afc_free(void *mem, const char *file, const char *func, const unsigned int line);
 	void *_afc_realloc(void *mem, size_t size, const char *file, const char *func, const unsigned int line);
 
@@ -60,6 +60,7 @@ static int afc_base64_internal_decode(Base64 *b64);
 static int afc_base64_internal_parse_tags(Base64 *b64, int first_tag, va_list tags);
 static int afc_base64_internal_write(Base64 *b64, const void *mem, int size);
 static int afc_base64_internal_write_char(Base64 *b64, int c);
+static void afc_base64_internal_terminate(Base64 *b64);
 
 Base64 *afc_base64_new(void)
 {
@@ -114,6 +115,7 @@ int afc_base64_encode(Base64 *b64, int first_tag, ...)
 			return (AFC_LOG(AFC_LOG_ERROR, AFC_BASE64_ERR_FILE_OUTPUT, "Cannot write output file", b64->file_out));
 
 	afc_base64_internal_encode(b64);
+	afc_base64_internal_terminate(b64);
 
 	if (b64->fout)
 		fclose(b64->fout);
@@ -148,6 +150,7 @@ int afc_base64_decode(Base64 *b64, int first_tag, ...)
 			return (AFC_LOG(AFC_LOG_ERROR, AFC_BASE64_ERR_FILE_OUTPUT, "Cannot write output file", b64->file_out));
 
 	afc_base64_internal_decode(b64);
+	afc_base64_internal_terminate(b64);
 
 	if (b64->fout)
 		fclose(b64->fout);
@@ -482,6 +485,13 @@ static int afc_base64_internal_write_char(Base64 *b64, int c)
 	return (AFC_ERR_NO_ERROR);
 }
 
+/* Memory output is not cleared by the caller (AFC strings are not): if there is room, it is terminated like a C string */
+static void afc_base64_internal_terminate(Base64 *b64)
+{
+	if (b64->mem_out && (b64->mem_out_pos < b64->mem_out + b64->mem_out_size))
+		*b64->mem_out_pos = '\0';
+}
+
 #ifdef TEST_CLASS
 int main()
 {
@@ -180,12 +180,13 @@ static BinTreeNode *afc_bin_tree_int_create_node(void *key, void *val)
 {
 	BinTreeNode *n;
 
-	if ((n = afc_malloc(sizeof(BinTreeNode))) == NULL)
+	if ((n = afc_pool_alloc(sizeof(BinTreeNode))) == NULL)
 	{
 		AFC_LOG_FAST(AFC_ERR_NO_MEMORY);
 		return (NULL);
 	}
 
+	n->left = n->right = NULL;
 	n->key = key;
 	n->val = val;
 
@@ -303,7 +304,7 @@ static int afc_bin_tree_int_node_delete(BinTree *bt, BinTreeNode *n)
 
 	if (bt->freenode)
 		bt->freenode(n->key, n->val);
-	afc_free(n);
+	afc_pool_free(n, sizeof(BinTreeNode));
 
 	return (AFC_ERR_NO_ERROR);
 }
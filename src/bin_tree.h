@@ -22,6 +22,7 @@
 
 #include "base.h"
 #include "exceptions.h"
+#include "pool.h"
 
 /* AFC BinTree Magic Number */
 #define AFC_BIN_TREE_MAGIC ('B' << 24 | 'I' << 16 | 'N' << 8 | 'T')
@@ -20,13 +20,17 @@
 /*
 @config
 	TITLE:     CGIManager
-	VERSION:   1.10
+	VERSION:   1.14
 	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
 
 	COMMAND:   add_emphasis cookie Cookie cookies Cookies form Form forms Forms GET POST FORM CGI
 @endnode
 
 @history
+	V1.14	- Cookie values are freed by the cookies dictionary (they used to leak)
+	V1.13	- Keys of headers and fields are interned in a StringPool shared by all the requests
+	V1.12	- AFC_CGI_MANAGER_TAG_UTF8: form fields sent as Latin-1 are converted to UTF-8
+	V1.11	- Form fields and cookies are parsed with string views: no copy of the input and of every field
 	V1.10	- Many changes to accomodate the WIN32 version
 @endhistory
 */
@@ -62,12 +66,14 @@ static int afc_cgi_manager_internal_get_headers(CGIManager *cgi);
 static int afc_cgi_manager_internal_method_get(CGIManager *cgi);
 static int afc_cgi_manager_internal_method_post(CGIManager *cgi);
 static int afc_cgi_manager_internal_parse_data(CGIManager *cgi, char *data);
-static int afc_cgi_manager_internal_add_key(CGIManager *cgi, char *keyval, int mode);
+static int afc_cgi_manager_internal_add_key(CGIManager *cgi, afc_strview keyval, int mode);
 static int afc_cgi_manager_internal_get_cookies(CGIManager *cgi);
 static char afc_cgi_manager_internal_decode(CGIManager *cgi, char *str);
 static int afc_cgi_manager_internal_unescape(CGIManager *cgi, char *str);
 static int afc_cgi_manager_internal_clear_dict(CGIManager *cgi, Dictionary *dict);
+static int afc_cgi_manager_internal_free_value(void *value);
 static int _afc_cgi_manager_get_charset(CGIManager *cgi);
+static char *afc_cgi_manager_internal_to_utf8(CGIManager *cgi, char *value);
 // }}}
 
 // {{{ afc_cgi_manager_new ()
@@ -108,6 +114,16 @@ CGIManager *_afc_cgi_manager_new(const char *file, const char *func, const unsig
 	if ((cgi_manager->cookies = afc_dictionary_new()) == NULL)
 		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "cookies", NULL);
 
+	// Cookies are kept across afc_cgi_manager_clear(): their values are freed when replaced or deleted
+	afc_dictionary_set_clear_func(cgi_manager->cookies, afc_cgi_manager_internal_free_value);
+
+	// The same header and field names come with every request: they are stored once
+	if ((cgi_manager->keys = afc_string_pool_new()) == NULL)
+		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "keys", NULL);
+
+	afc_dictionary_set_string_pool(cgi_manager->headers, cgi_manager->keys);
+	afc_dictionary_set_string_pool(cgi_manager->fields, cgi_manager->keys);
+
 	if ((cgi_manager->split = afc_string_list_new()) == NULL)
 		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "split", NULL);
 
@@ -168,6 +184,7 @@ int _afc_cgi_manager_delete(CGIManager *cgi_manager)
 	afc_dictionary_delete(cgi_manager->headers);
 	afc_dictionary_delete(cgi_manager->fields);
 	afc_dictionary_delete(cgi_manager->cookies);
+	afc_string_pool_delete(cgi_manager->keys);
 
 	afc_string_list_delete(cgi_manager->split);
 
@@ -217,6 +234,10 @@ int afc_cgi_manager_clear(CGIManager *cgi)
 	if (cgi->split)
 		afc_string_list_clear(cgi->split);
 
+	// Both dictionaries using the pool are empty now: a pool grown too much (many different field names) is emptied
+	if (afc_string_pool_len(cgi->keys) > AFC_CGI_MANAGER_MAX_POOLED_KEYS)
+		afc_string_pool_clear(cgi->keys);
+
 	cgi->is_post_read = FALSE;
 
 	cgi->are_headers_set = FALSE;
@@ -595,6 +616,13 @@ int afc_cgi_manager_set_cookie_expire(CGIManager *cgi, int days)
 							* TRUE - The CGIManager will handle cookies
 							* FALSE - The CGIManager will not handle cookies (default)
 
+						+ AFC_CGI_MANAGER_TAG_UTF8 - Defines whether form fields should always be stored
+										 as UTF-8. Valid values are:
+
+							* TRUE - Fields sent with a Latin-1 charset, or that are not valid UTF-8,
+									 are converted to UTF-8
+							* FALSE - Fields are stored as they are sent (default)
+
 		  RESULTS: should return AFC_ERR_NO_ERROR
 
 		 SEE ALSO: 	- afc_cgi_manager_set_cookie()
@@ -610,6 +638,10 @@ int afc_cgi_manager_set_tag(CGIManager *cgi, int tag, void *val)
 	case AFC_CGI_MANAGER_TAG_HANDLE_COOKIES:
 		cgi->handle_cookies = (short)(int)(long)val;
 		break;
+
+	case AFC_CGI_MANAGER_TAG_UTF8:
+		cgi->utf8 = (short)(int)(long)val;
+		break;
 	}
 
 	return (AFC_ERR_NO_ERROR);
@@ -967,7 +999,7 @@ static int afc_cgi_manager_internal_method_post(CGIManager *cgi)
 			content_length = (int)cl;
 		}
 
-		if ((data = afc_malloc(sizeof(char) * content_length + 1)) == NULL)
+		if ((data = afc_malloc_uninit(sizeof(char) * content_length + 1)) == NULL)
 			return (AFC_LOG_FAST(AFC_ERR_NO_MEMORY));
 
 		bytes = fread(data, sizeof(char), content_length, stdin);
@@ -996,6 +1028,7 @@ static int afc_cgi_manager_internal_method_post(CGIManager *cgi)
 
 static int afc_cgi_manager_internal_parse_data(CGIManager *cgi, char *data)
 {
+	afc_strview rest, token;
 	char *s;
 
 	AFC_DEBUG_FUNC();
@@ -1009,39 +1042,37 @@ static int afc_cgi_manager_internal_parse_data(CGIManager *cgi, char *data)
 		s++;
 	}
 
-	/* Split into tokens */
-	afc_string_list_split(cgi->split, data, "&");
+	/* Split into tokens: they are views of data, nothing is copied until the key is stored */
+	rest = afc_strview_make(data, ALL);
 
-	s = afc_string_list_first(cgi->split);
-	while (s)
+	while (afc_strview_token(&rest, "&", 0, &token))
 	{
-		afc_string_trim(s);
-		if (afc_string_len(s))
-			afc_cgi_manager_internal_add_key(cgi, s, AFC_CGI_MANAGER_MODE_FORM);
-
-		s = afc_string_list_next(cgi->split);
+		token = afc_strview_trim(token);
+		if (token.len)
+			afc_cgi_manager_internal_add_key(cgi, token, AFC_CGI_MANAGER_MODE_FORM);
 	}
 
 	return (AFC_ERR_NO_ERROR);
 }
 
-static int afc_cgi_manager_internal_add_key(CGIManager *cgi, char *keyval, int mode)
+static int afc_cgi_manager_internal_add_key(CGIManager *cgi, afc_strview keyval, int mode)
 {
-	char *str = strstr(keyval, "=");
+	long eq = afc_strview_index_of(keyval, '=');
 	char *key, *value;
 	Dictionary *dict = NULL;
 
 	AFC_DEBUG_FUNC();
 
-	afc_debug_adv(__internal_afc_base, AFC_DEBUG_VERBOSE, class_name, "Add key: %s", keyval);
+	afc_debug_adv(__internal_afc_base, AFC_DEBUG_VERBOSE, class_name, "Add key: %.*s", (int)keyval.len, keyval.str);
 
-	// FIXME: if str is null, the key is not valid (MS Internet Explorer Only)
-	if (str == NULL)
+	// FIXME: if there is no '=', the key is not valid (MS Internet Explorer Only)
+	if (eq < 0)
 		return (AFC_ERR_NO_ERROR);
 
-	if (strlen(keyval) == 0)
+	// Empty keys and empty values are skipped
+	if (eq == 0)
 		return (AFC_ERR_NO_ERROR);
-	if (strlen(str) == 1)
+	if ((unsigned long)eq == keyval.len - 1)
 		return (AFC_ERR_NO_ERROR);
 
 	if (mode == AFC_CGI_MANAGER_MODE_FORM)
@@ -1053,18 +1084,24 @@ static int afc_cgi_manager_internal_add_key(CGIManager *cgi, char *keyval, int m
 	if (dict == NULL)
 		return (AFC_ERR_NO_ERROR);
 
-	if (str != NULL)
-		str[0] = '\0';
+	if ((key = afc_string_dup_view(afc_strview_mid(keyval, 0, eq))) == NULL) // Copy the Key to make it uppercase
+		return (AFC_LOG_FAST_INFO(AFC_ERR_NO_MEMORY, "key"));
 
-	key = afc_string_dup(keyval); // Duplicate the Key to make it uppercase
 	afc_string_upper(key);
 	afc_cgi_manager_internal_unescape(cgi, key);
 
-	value = afc_string_dup(str + 1);
+	if ((value = afc_string_dup_view(afc_strview_mid(keyval, eq + 1, ALL))) == NULL)
+	{
+		afc_string_delete(key);
+		return (AFC_LOG_FAST_INFO(AFC_ERR_NO_MEMORY, "value"));
+	}
 
 	if (strcmp(key, "HTTP_COOKIE") != 0) // We do not unescape cookies... yet
 		afc_cgi_manager_internal_unescape(cgi, value);
 
+	if ((mode == AFC_CGI_MANAGER_MODE_FORM) && cgi->utf8)
+		value = afc_cgi_manager_internal_to_utf8(cgi, value);
+
 	afc_dictionary_set(dict, key, value);
 
 	afc_string_delete(key); // Since Dictionary creates a copy of the key itself, we can free this one
@@ -1072,27 +1109,44 @@ static int afc_cgi_manager_internal_add_key(CGIManager *cgi, char *keyval, int m
 	return (AFC_ERR_NO_ERROR);
 }
 
+/* Converts /value/ to UTF-8 if it has been sent as Latin-1: returns the string to be stored */
+static char *afc_cgi_manager_internal_to_utf8(CGIManager *cgi, char *value)
+{
+	unsigned long len = strlen(value); // unescape() does not update the string length
+	char *utf8;
+
+	if ((afc_string_casecomp(cgi->charset, "iso-8859-1", ALL) != 0) && (afc_string_casecomp(cgi->charset, "latin1", ALL) != 0))
+	{
+		// Any other (or no) charset: only fields that are not valid UTF-8 are supposed to be Latin-1
+		if (afc_utf8_validate(value, len, NULL))
+			return (value);
+	}
+
+	if ((utf8 = afc_string_latin1_to_utf8(value)) == NULL)
+		return (value);
+
+	afc_string_delete(value);
+
+	return (utf8);
+}
+
 /* Cookie Section */
 static int afc_cgi_manager_internal_get_cookies(CGIManager *cgi)
 {
 	char *cookie_string = afc_cgi_manager_get_val(cgi, "HTTP_COOKIE");
-	char *s;
+	afc_strview rest, token;
 
 	AFC_DEBUG_FUNC();
 
 	if (cookie_string == NULL)
 		return (AFC_ERR_NO_ERROR);
 
-	afc_string_list_split(cgi->split, cookie_string, "; ");
+	rest = afc_string_view(cookie_string);
 
-	if ((s = afc_string_list_first(cgi->split)) == NULL)
-		return (AFC_ERR_NO_ERROR);
-
-	while (s)
+	while (afc_strview_token(&rest, "; ", 0, &token))
 	{
-		if (afc_string_len(s))
-			afc_cgi_manager_internal_add_key(cgi, s, AFC_CGI_MANAGER_MODE_COOKIE);
-		s = afc_string_list_next(cgi->split);
+		if (token.len)
+			afc_cgi_manager_internal_add_key(cgi, token, AFC_CGI_MANAGER_MODE_COOKIE);
 	}
 
 	return (AFC_ERR_NO_ERROR);
@@ -1137,6 +1191,16 @@ static int afc_cgi_manager_internal_clear_dict(CGIManager *cgi, Dictionary *dict
 	return (AFC_ERR_NO_ERROR);
 }
 
+/* Clear func of the cookies dictionary */
+static int afc_cgi_manager_internal_free_value(void *value)
+{
+	char *str = (char *)value;
+
+	afc_string_delete(str);
+
+	return (AFC_ERR_NO_ERROR);
+}
+
 #ifdef TEST_CGI_MANAGER
 int main(int argc, char *argv[])
 {
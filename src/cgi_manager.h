@@ -42,6 +42,9 @@ extern "C"
 /* AFC afc_cgi_manager Base value for constants */
 #define AFC_CGI_MANAGER_BASE 0xb000
 
+/* afc_cgi_manager_clear() empties the pool of the keys when it holds more than this number of strings */
+#define AFC_CGI_MANAGER_MAX_POOLED_KEYS 1024
+
 	/* Errors for afc_cgi_manager */
 	enum
 	{
@@ -73,7 +76,8 @@ extern "C"
 	enum
 	{
 		AFC_CGI_MANAGER_TAG_DEBUG = 0,
-		AFC_CGI_MANAGER_TAG_HANDLE_COOKIES
+		AFC_CGI_MANAGER_TAG_HANDLE_COOKIES,
+		AFC_CGI_MANAGER_TAG_UTF8
 	};
 
 	struct afc_cgi_manager
@@ -84,6 +88,8 @@ extern "C"
 		struct afc_dictionary *fields;	/* Used to store FORM fields    */
 		struct afc_dictionary *cookies; /* Used to store Cookies        */
 
+		StringPool *keys; /* Keys of headers and fields, shared by all the requests */
+
 		StringList *split;
 
 		int method; /* Can be AFC_CGI_MANAGER_METHOD /GET/, /POST/ or /UNDEF/ */
@@ -104,6 +110,8 @@ extern "C"
 		BOOL is_post_read; /* Flag T/F. If TRUE, POST arguments have already been read */
 
 		char *charset; /* Incoming request charset */
+
+		short utf8; /* Flag T/F. If TRUE, Latin-1 form fields are converted to UTF-8 */
 	};
 
 	typedef struct afc_cgi_manager CGIManager;
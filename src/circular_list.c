@@ -3,7 +3,7 @@
 /*
 @config
 	TITLE:   CircularList
-	VERSION: 1.0
+	VERSION: 1.1
 	AUTHOR:  Fabrizio Pastore - pastorefabrizio@libero.it
 	AUTHOR:  Fabio Rotondo - fabio@rotondo.it
 @endnode
@@ -356,7 +356,7 @@ void * afc_circular_list_del ( CircularList * cl )
 	//handle single-element case to avoid use-after-free
 	if ( cl->count == 1 )
 	{
-		afc_free ( old );
+		afc_pool_free ( old, sizeof ( CircularListNode ) );
 		cl->pointer = NULL;
 		cl->count = 0;
 		return ( NULL );
@@ -369,7 +369,7 @@ void * afc_circular_list_del ( CircularList * cl )
 	n->prev = cl->pointer->prev;
 
 	//frees memory
-	afc_free ( old );
+	afc_pool_free ( old, sizeof ( CircularListNode ) );
 
 	cl->pointer = n;
 
@@ -392,7 +392,7 @@ static  CircularListNode * afc_circular_list_int_create_node( void )
 TRY ( CircularListNode * )
 	
 	CircularListNode * p;
-	if ( ( p = afc_malloc ( sizeof ( CircularListNode ) ) ) == NULL )
+	if ( ( p = afc_pool_alloc ( sizeof ( CircularListNode ) ) ) == NULL )
         	RAISE_FAST_RC ( AFC_ERR_NO_MEMORY, "cl", NULL );
 
 	RETURN ( p );
@@ -3,6 +3,7 @@
 
 #include "base.h"
 #include "exceptions.h"
+#include "pool.h"
 
 
 #define AFC_CIRCULAR_LIST_MAGIC	( 'C' << 24 | 'L' << 16 | 'I' << 8 | 'S' )
@@ -24,7 +24,7 @@
 /*
 @config
 	TITLE:     Dictionary
-	VERSION:   1.30
+	VERSION:   1.46
 	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
 @endnode
 
@@ -40,6 +40,14 @@ Agent Smith, *The Matrix*
 @endnode
 
 @node history
+	- 1.46	- Prehashed calls check the hash value when compiled with AFC_DICTIONARY_CHECK_HASH
+	- 1.45	- Added afc_dictionary_set_string_pool() function
+	- 1.44	- Added afc_dictionary_get_view() and afc_dictionary_set_view() functions
+	- 1.43	- Added afc_dictionary_set_arena() function
+	- 1.42	- Keys are hashed with afc_string_hash64() and a random seed for every dictionary
+	- 1.41	- Keys are compared on lookup (no more collisions between keys with the same hash value).
+			  Added afc_dictionary_hash_key(), afc_dictionary_get_prehashed() and afc_dictionary_set_prehashed()
+	- 1.40	- Entries and keys are allocated from slabs owned by the dictionary
 	- 1.30	- Added afc_dictionary_before_first() function
 @endnode
 
@@ -57,13 +65,35 @@ afc_dictionary_delete().
 To set new values in the dictionary, call afc_dictionary_set(), to delete a specified item, call afc_dictionary_del_item()
 and to get a key value, call afc_dictionary_get().
 
+Dictionary does not allocate memory for every key it stores: each entry is stored together with its key
+(an AFC String) in big memory slabs owned by the dictionary, and the entries are indexed by an open addressing Hash
+(see AFC_HASH_STORAGE_OPEN). Memory of deleted entries is reused by new ones and all slabs are released at once by
+afc_dictionary_clear(). Keys returned by afc_dictionary_get_key() belong to the dictionary: never free them.
+
+Every entry keeps the hash value and the length of its key, so a lookup compares the full hash value and
+the key length before touching the key chars. If you look up the same key many times, compute its hash once
+with afc_dictionary_hash_key() and then use afc_dictionary_get_prehashed() and afc_dictionary_set_prehashed().
+
+Keys are hashed with afc_string_hash64() using a random seed chosen by every dictionary when it is created,
+so hash values change from one dictionary (and one run) to another: never store them, and never pass the value
+returned by a dictionary to another one (only dictionaries sharing a StringPool share the seed). This way nobody can
+flood a dictionary filled with external data (like CGI form fields) with keys colliding on purpose.
+If AFC is compiled with *AFC_DICTIONARY_CHECK_HASH* defined, the prehashed functions hash the key again and
+fail with AFC_DICTIONARY_ERR_BAD_HASH when the value does not match.
 
 @endnode
 */
 // }}}
 
 static const char class_name[] = "Dictionary";
-static DictionaryData *afc_dictionary_internal_find(Dictionary *dict, const char *key);
+static DictionaryData *afc_dictionary_internal_find(Dictionary *dict, const char *key, unsigned long int len, unsigned long int hash_value);
+static DictionaryData *afc_dictionary_internal_entry_new(Dictionary *dict, const char *key, unsigned long int len, unsigned long int hash_value);
+static void afc_dictionary_internal_entry_free(Dictionary *dict, DictionaryData *ddata);
+static void afc_dictionary_internal_slabs_free(Dictionary *dict);
+static int afc_dictionary_internal_set(Dictionary *dict, const char *key, unsigned long int len, unsigned long int hash_value, void *data);
+#ifdef AFC_DICTIONARY_CHECK_HASH
+static int afc_dictionary_internal_check_hash(Dictionary *dict, const char *key, unsigned long int hash_value);
+#endif
 
 // {{{ afc_dictionary_key_new ()
 /*
@@ -93,10 +123,13 @@ struct afc_dictionary *afc_dictionary_new()
 		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "dictionary", NULL);
 
 	dictionary->magic = AFC_DICTIONARY_MAGIC;
+	dictionary->seed = afc_string_hash_seed();
 
 	if ((dictionary->hash = afc_hash_new()) == NULL)
 		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "hash", NULL);
 
+	afc_hash_set_tags(dictionary->hash, AFC_HASH_TAG_STORAGE, (void *)AFC_HASH_STORAGE_OPEN, AFC_TAG_END);
+
 	RETURN(dictionary);
 
 	EXCEPT
@@ -162,29 +195,32 @@ int _afc_dictionary_delete(struct afc_dictionary *dictionary)
 int afc_dictionary_clear(struct afc_dictionary *dictionary)
 {
 	DictionaryData *ddata;
-	HashData *hd;
 
 	if (dictionary == NULL)
 		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
 	if (dictionary->magic != AFC_DICTIONARY_MAGIC)
 		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
 
-	if (dictionary->hash)
+	// Entries in an Arena are not freed one by one: if there is no clear func, there is no need to visit them
+	if ((dictionary->hash) && ((dictionary->arena == NULL) || (dictionary->func_clear != NULL)))
 	{
-		afc_array_before_first(dictionary->hash->am); // Move through all Array items
-		while ((hd = afc_array_next(dictionary->hash->am)))
+		ddata = afc_hash_first(dictionary->hash); // Move through all Hash items
+		while (ddata)
 		{
-			ddata = hd->data; // Get the DictionaryData inside
-
 			if (dictionary->func_clear)
 				dictionary->func_clear(ddata->value);
 
-			afc_string_delete(ddata->key); // Dispose the Dictionary Item key
-			afc_free(ddata);			   // Free the dictionary Item
+			afc_dictionary_internal_entry_free(dictionary, ddata); // Free the dictionary Item and its key
+
+			ddata = afc_hash_next(dictionary->hash);
 		}
-		afc_hash_clear(dictionary->hash); // Clears the Hash
 	}
 
+	if (dictionary->hash)
+		afc_hash_clear(dictionary->hash); // Clears the Hash
+
+	afc_dictionary_internal_slabs_free(dictionary); // All entries are released at once
+
 	dictionary->curr_data = NULL; // Set no current data
 
 	return (AFC_ERR_NO_ERROR);
@@ -217,59 +253,56 @@ int afc_dictionary_clear(struct afc_dictionary *dictionary)
 */
 int afc_dictionary_set(Dictionary *dict, const char *key, void *data)
 {
-	DictionaryData *ddata = NULL;
-
 	if (dict == NULL)
 		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
 	if (dict->magic != AFC_DICTIONARY_MAGIC)
 		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
 
-	if (!dict->skip_find)
-		ddata = afc_dictionary_internal_find(dict, key); // First of all, we look for the key
+	return (afc_dictionary_set_prehashed(dict, key, afc_dictionary_hash_key(dict, key), data));
+}
+// }}}
+// {{{ afc_dictionary_set_prehashed ( dict, key, hash_value, data )
+/*
+@node afc_dictionary_set_prehashed
 
-	if (ddata == NULL)
-	{
-		if (data == NULL)
-			return (AFC_ERR_NO_ERROR); // If the key does not exists and data is NULL,
-									   // Simply exit without adding a NULL key
+			 NAME: afc_dictionary_set_prehashed ( dictionary, key, hash_value, data )  - Sets a key with a known hash value
 
-		ddata = (DictionaryData *)afc_malloc(sizeof(DictionaryData)); // If the key is not found, we create a new DictionaryData
+		 SYNOPSIS: int afc_dictionary_set_prehashed ( Dictionary * dictionary, const char * key, unsigned long int hash_value, void * data )
 
-		if (ddata == NULL)
-			return (AFC_LOG_FAST_INFO(AFC_ERR_NO_MEMORY, "DictionaryData"));
+			SINCE: 1.41
 
-		if ((ddata->key = afc_string_dup(key)) == NULL) // Duplicate the key
-		{
-			afc_free(ddata);
-			return (AFC_ERR_NO_MEMORY);
-		}
+	  DESCRIPTION: This function works just like afc_dictionary_set(), but the key is not hashed again: the hash_value
+				   you got from afc_dictionary_hash_key() is used instead.
 
-		if (afc_hash_add(dict->hash, afc_string_hash((unsigned char *)key, afc_string_len(ddata->key)), ddata) != AFC_ERR_NO_ERROR) // Add the new entry in the Dictionary
-		{
-			afc_string_delete(ddata->key);
-			afc_free(ddata);
-			return (AFC_LOG(AFC_LOG_ERROR, AFC_DICTIONARY_ERR_HASHING, "Error during Hashing of this key", key));
-		}
-	}
-	else
-	{
-		// If the ddata already exists, we have to call the func_clear (if set) before
-		// resetting its value.
+			INPUT: 	- dictionary    - Pointer to a valid afc_dictionary instance.
+					- key 			- The key of the item in the dictionary.
+					- hash_value	- The value returned by afc_dictionary_hash_key() for this key.
+					- data         	- Data to assign to this key.
 
-		if (dict->func_clear)
-			dict->func_clear(ddata->value);
-		ddata->value = NULL;
-	}
+		  RESULTS: should be AFC_ERR_NO_ERROR
 
-	if (data != NULL) // If there is a data value, then we add it
-	{
-		ddata->value = data;
-		dict->curr_data = ddata;
-	}
-	else
-		afc_dictionary_del(dict); // Else we delete the current item
+			NOTES: - Passing an hash_value that was not returned by afc_dictionary_hash_key() for the very same key
+					 and the very same dictionary corrupts the dictionary: every dictionary has its own seed.
+				   - With AFC_DICTIONARY_CHECK_HASH defined, a wrong hash_value returns AFC_DICTIONARY_ERR_BAD_HASH.
 
-	return (AFC_ERR_NO_ERROR);
+		 SEE ALSO: 	- afc_dictionary_set()
+					- afc_dictionary_hash_key()
+					- afc_dictionary_get_prehashed()
+@endnode
+*/
+int afc_dictionary_set_prehashed(Dictionary *dict, const char *key, unsigned long int hash_value, void *data)
+{
+	if (dict == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (dict->magic != AFC_DICTIONARY_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+#ifdef AFC_DICTIONARY_CHECK_HASH
+	if (afc_dictionary_internal_check_hash(dict, key, hash_value) != AFC_ERR_NO_ERROR)
+		return (AFC_DICTIONARY_ERR_BAD_HASH);
+#endif
+
+	return (afc_dictionary_internal_set(dict, key, strlen(key), hash_value, data));
 }
 // }}}
 // {{{ afc_dictionary_get ( dict, key )
@@ -294,6 +327,7 @@ int afc_dictionary_set(Dictionary *dict, const char *key, void *data)
 */
 void *afc_dictionary_get(Dictionary *dict, const char *key)
 {
+	unsigned long int len;
 	DictionaryData *ddata;
 
 	if (dict == NULL)
@@ -307,7 +341,8 @@ void *afc_dictionary_get(Dictionary *dict, const char *key)
 		return (NULL);
 	}
 
-	ddata = afc_dictionary_internal_find(dict, key);
+	len = strlen(key);
+	ddata = afc_dictionary_internal_find(dict, key, len, (unsigned long int)afc_string_hash64(key, len, dict->seed));
 
 	if (ddata == NULL)
 		return (NULL);
@@ -315,6 +350,168 @@ void *afc_dictionary_get(Dictionary *dict, const char *key)
 	return (ddata->value);
 }
 // }}}
+// {{{ afc_dictionary_get_prehashed ( dict, key, hash_value )
+/*
+@node afc_dictionary_get_prehashed
+
+			 NAME: afc_dictionary_get_prehashed ( dictionary, key, hash_value )  - Retrieves the data of a key with a known hash value
+
+		 SYNOPSIS: void * afc_dictionary_get_prehashed ( Dictionary * dictionary, const char * key, unsigned long int hash_value )
+
+			SINCE: 1.41
+
+	  DESCRIPTION: This function works just like afc_dictionary_get(), but the key is not hashed again: the hash_value
+				   you got from afc_dictionary_hash_key() is used instead. Use it when the same key is looked up
+				   many times.
+
+			INPUT: 	- dictionary    - Pointer to a valid afc_dictionary instance.
+					- key 			- The key of the item in the dictionary.
+					- hash_value	- The value returned by afc_dictionary_hash_key() for this key.
+
+		  RESULTS: the value binded to the key, or NULL if the key cannot be found.
+
+			NOTES: - The hash_value must come from this very dictionary: a value returned by another one
+					 (with a different seed) just misses the key.
+				   - With AFC_DICTIONARY_CHECK_HASH defined, a wrong hash_value is logged and NULL is returned.
+
+		 SEE ALSO: 	- afc_dictionary_get()
+					- afc_dictionary_hash_key()
+					- afc_dictionary_set_prehashed()
+@endnode
+*/
+void *afc_dictionary_get_prehashed(Dictionary *dict, const char *key, unsigned long int hash_value)
+{
+	DictionaryData *ddata;
+
+	if (dict == NULL)
+	{
+		AFC_LOG_FAST(AFC_ERR_NULL_POINTER);
+		return (NULL);
+	}
+	if (dict->magic != AFC_DICTIONARY_MAGIC)
+	{
+		AFC_LOG_FAST(AFC_ERR_INVALID_POINTER);
+		return (NULL);
+	}
+
+#ifdef AFC_DICTIONARY_CHECK_HASH
+	if (afc_dictionary_internal_check_hash(dict, key, hash_value) != AFC_ERR_NO_ERROR)
+		return (NULL);
+#endif
+
+	if ((ddata = afc_dictionary_internal_find(dict, key, strlen(key), hash_value)) == NULL)
+		return (NULL);
+
+	return (ddata->value);
+}
+// }}}
+// {{{ afc_dictionary_set_view ( dict, key, data )
+/*
+@node afc_dictionary_set_view
+
+			 NAME: afc_dictionary_set_view ( dictionary, key, data )  - Sets a key held in a string view
+
+		 SYNOPSIS: int afc_dictionary_set_view ( Dictionary * dictionary, afc_strview key, void * data )
+
+			SINCE: 1.44
+
+	  DESCRIPTION: This function works just like afc_dictionary_set(), but the key is an afc_strview: parsers can
+				   store a key found inside a bigger buffer without copying it in a string first.
+
+			INPUT: 	- dictionary    - Pointer to a valid afc_dictionary instance.
+					- key 			- View of the key chars.
+					- data         	- Data to assign to this key.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+		 SEE ALSO: 	- afc_dictionary_set()
+					- afc_dictionary_get_view()
+@endnode
+*/
+int afc_dictionary_set_view(Dictionary *dict, afc_strview key, void *data)
+{
+	if (dict == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (dict->magic != AFC_DICTIONARY_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	return (afc_dictionary_internal_set(dict, key.str, key.len, (unsigned long int)afc_string_hash64(key.str, key.len, dict->seed), data));
+}
+// }}}
+// {{{ afc_dictionary_get_view ( dict, key )
+/*
+@node afc_dictionary_get_view
+
+			 NAME: afc_dictionary_get_view ( dictionary, key )  - Retrieves the data of a key held in a string view
+
+		 SYNOPSIS: void * afc_dictionary_get_view ( Dictionary * dictionary, afc_strview key )
+
+			SINCE: 1.44
+
+	  DESCRIPTION: This function works just like afc_dictionary_get(), but the key is an afc_strview.
+
+			INPUT: 	- dictionary    - Pointer to a valid afc_dictionary instance.
+					- key 			- View of the key chars.
+
+		  RESULTS: the value binded to the key, or NULL if the key cannot be found.
+
+		 SEE ALSO: 	- afc_dictionary_get()
+					- afc_dictionary_set_view()
+@endnode
+*/
+void *afc_dictionary_get_view(Dictionary *dict, afc_strview key)
+{
+	DictionaryData *ddata;
+
+	if (dict == NULL)
+	{
+		AFC_LOG_FAST(AFC_ERR_NULL_POINTER);
+		return (NULL);
+	}
+	if (dict->magic != AFC_DICTIONARY_MAGIC)
+	{
+		AFC_LOG_FAST(AFC_ERR_INVALID_POINTER);
+		return (NULL);
+	}
+
+	if ((ddata = afc_dictionary_internal_find(dict, key.str, key.len, (unsigned long int)afc_string_hash64(key.str, key.len, dict->seed))) == NULL)
+		return (NULL);
+
+	return (ddata->value);
+}
+// }}}
+// {{{ afc_dictionary_hash_key ( dict, key )
+/*
+@node afc_dictionary_hash_key
+
+			 NAME: afc_dictionary_hash_key ( dictionary, key )  - Returns the hash value of a key
+
+		 SYNOPSIS: unsigned long int afc_dictionary_hash_key ( Dictionary * dictionary, const char * key )
+
+			SINCE: 1.41
+
+	  DESCRIPTION: This function returns the hash value the dictionary uses for the given key. Store it and pass it to
+				   afc_dictionary_get_prehashed() and afc_dictionary_set_prehashed() to avoid hashing the same key
+				   over and over.
+
+				   Every dictionary hashes keys with its own random seed: an hash value is valid only for the
+				   dictionary that returned it (or for dictionaries bound to the same StringPool). Never share it
+				   between instances of a class: compute it on the dictionary you are going to query.
+
+			INPUT: 	- dictionary    - Pointer to a valid afc_dictionary instance.
+					- key 			- The key to hash.
+
+		  RESULTS: the hash value of the key.
+
+		 SEE ALSO: 	- afc_dictionary_get_prehashed()
+					- afc_dictionary_set_prehashed()
+@endnode
+*/
+unsigned long int afc_dictionary_hash_key(Dictionary *dict, const char *key)
+{
+	return ((unsigned long int)afc_string_hash64(key, strlen(key), dict->seed));
+}
+// }}}
 // {{{ afc_dictionary_get_default ( dict, key, def_val )
 /*
 @node afc_dictionary_get_default
@@ -371,15 +568,12 @@ void *afc_dictionary_get_default(Dictionary *dict, const char *key, void *def_va
 */
 void *afc_dictionary_first(Dictionary *dict)
 {
-	HashData *hmdata = (HashData *)afc_array_first(dict->hash->am);
+	DictionaryData *ddata = afc_hash_first(dict->hash);
 
-	if (hmdata == NULL)
+	if (ddata == NULL)
 		return (NULL);
 
-	dict->curr_data = hmdata->data;
-
-	if (dict->curr_data == NULL)
-		return (NULL);
+	dict->curr_data = ddata;
 
 	return (dict->curr_data->value);
 }
@@ -406,15 +600,12 @@ void *afc_dictionary_first(Dictionary *dict)
 */
 void *afc_dictionary_next(Dictionary *dict)
 {
-	HashData *hmdata = (HashData *)afc_array_next(dict->hash->am);
+	DictionaryData *ddata = afc_hash_next(dict->hash);
 
-	if (hmdata == NULL)
+	if (ddata == NULL)
 		return (NULL);
 
-	dict->curr_data = hmdata->data;
-
-	if (dict->curr_data == NULL)
-		return (NULL);
+	dict->curr_data = ddata;
 
 	return (dict->curr_data->value);
 }
@@ -441,15 +632,12 @@ void *afc_dictionary_next(Dictionary *dict)
 */
 void *afc_dictionary_prev(Dictionary *dict)
 {
-	HashData *hmdata = (HashData *)afc_array_prev(dict->hash->am);
+	DictionaryData *ddata = afc_hash_prev(dict->hash);
 
-	if (hmdata == NULL)
+	if (ddata == NULL)
 		return (NULL);
 
-	dict->curr_data = hmdata->data;
-
-	if (dict->curr_data == NULL)
-		return (NULL);
+	dict->curr_data = ddata;
 
 	return (dict->curr_data->value);
 }
@@ -474,16 +662,17 @@ void *afc_dictionary_prev(Dictionary *dict)
 */
 void *afc_dictionary_del(Dictionary *dict)
 {
-	if (dict->curr_data == NULL)
+	DictionaryData *ddata = dict->curr_data;
+
+	if (ddata == NULL)
 		return (AFC_ERR_NO_ERROR); // If no item is set, simply exit
 
 	if (dict->func_clear)
-		dict->func_clear(dict->curr_data->value); // Clear the item from memory
+		dict->func_clear(ddata->value); // Clear the item from memory
 
-	afc_string_delete(dict->curr_data->key); // Free the Item KEY
-	afc_free(dict->curr_data);				 // Free current item data
+	dict->curr_data = afc_hash_del(dict->hash); // Remove from the Hash
 
-	dict->curr_data = afc_hash_del(dict->hash); // Remove from the Array Master
+	afc_dictionary_internal_entry_free(dict, ddata); // Free the item data and its key
 
 	if (dict->curr_data == NULL)
 		return (NULL); // Check against NULL
@@ -512,7 +701,7 @@ void *afc_dictionary_del(Dictionary *dict)
 */
 int afc_dictionary_del_item(Dictionary *dict, const char *key)
 {
-	DictionaryData *ddata = afc_dictionary_internal_find(dict, key);
+	DictionaryData *ddata = afc_dictionary_internal_find(dict, key, strlen(key), afc_dictionary_hash_key(dict, key));
 
 	if (ddata == NULL)
 		return (AFC_LOG(AFC_LOG_WARNING, AFC_DICTIONARY_ERR_NOT_FOUND, "Not found in dictionary", key));
@@ -572,7 +761,7 @@ DictionaryData * afc_dictionary_obj ( Dictionary * dict )
 /*
 unsigned long int afc_dictionary_len ( Dictionary * dict )
 {
-	return ( afc_array_len ( dict->hash->am ) );
+	return ( afc_hash_len ( dict->hash ) );
 }
 */
 // }}}
@@ -599,7 +788,7 @@ unsigned long int afc_dictionary_len ( Dictionary * dict )
 */
 BOOL afc_dictionary_has_key(Dictionary *dict, const char *key)
 {
-	if (afc_dictionary_internal_find(dict, key) != NULL)
+	if (afc_dictionary_internal_find(dict, key, strlen(key), afc_dictionary_hash_key(dict, key)) != NULL)
 		return (TRUE);
 
 	return (FALSE);
@@ -731,17 +920,15 @@ int afc_dictionary_for_each(Dictionary *dict, int (*func)(Dictionary *am, int po
 {
 	int t = 0;
 	int res;
-	HashData *hd;
 	DictionaryData *ddata;
 
-	hd = afc_hash_first(dict->hash);
-	while (hd)
+	ddata = afc_hash_first(dict->hash);
+	while (ddata)
 	{
-		ddata = hd->data;
 		if ((res = func(dict, t++, ddata->value, info)) != AFC_ERR_NO_ERROR)
 			return (res);
 
-		hd = afc_hash_next(dict->hash);
+		ddata = afc_hash_next(dict->hash);
 	}
 
 	return (AFC_ERR_NO_ERROR);
@@ -775,6 +962,110 @@ int afc_dictionary_set_custom_sort ( Dictionary * dict, void ( * func )  ( void
 }
 */
 // }}}
+// {{{ afc_dictionary_set_arena ( dict, arena )
+/*
+@node afc_dictionary_set_arena
+
+			 NAME: afc_dictionary_set_arena ( dictionary, arena )  - Binds the Dictionary to an Arena
+
+		 SYNOPSIS: int afc_dictionary_set_arena ( Dictionary * dictionary, Arena * arena )
+
+			SINCE: 1.43
+
+	  DESCRIPTION: Use this function to allocate the dictionary entries (and their keys) from an Arena instead of the
+				   system heap. afc_dictionary_clear() then does not need to visit the entries (unless a clear func
+				   is set).
+
+			INPUT: 	- dictionary    - Pointer to a valid afc_dictionary instance.
+					- arena			- Pointer to a valid Arena instance, or NULL to go back to the system heap.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_DICTIONARY_ERR_NOT_EMPTY if the Dictionary contains some keys.
+
+			NOTES: - The values stored in the dictionary are not touched: the Arena only holds the entries and the keys.
+				   - The index of the entries is still allocated from the system heap.
+				   - Clear (or delete) the Dictionary before resetting the Arena.
+
+		 SEE ALSO: - afc_arena_new()
+				   - afc_dictionary_clear()
+@endnode
+*/
+int afc_dictionary_set_arena(Dictionary *dict, Arena *arena)
+{
+	if (dict == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (dict->magic != AFC_DICTIONARY_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (arena == dict->arena)
+		return (AFC_ERR_NO_ERROR);
+
+	if (_afc_hash_len(dict->hash) != 0)
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_DICTIONARY_ERR_NOT_EMPTY, "Cannot change the Arena of a non empty Dictionary", NULL));
+
+	// Slabs of the old allocator are released before switching
+	afc_dictionary_internal_slabs_free(dict);
+	dict->arena = arena;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_dictionary_set_string_pool ( dict, pool )
+/*
+@node afc_dictionary_set_string_pool
+
+			 NAME: afc_dictionary_set_string_pool ( dictionary, pool )  - Binds the Dictionary to a StringPool
+
+		 SYNOPSIS: int afc_dictionary_set_string_pool ( Dictionary * dictionary, StringPool * pool )
+
+			SINCE: 1.45
+
+	  DESCRIPTION: Use this function to intern the dictionary keys in a StringPool, instead of copying every key in
+				   its entry. Dictionaries bound to the same pool share the memory of their keys, and
+				   afc_dictionary_get_key() returns the interned string.
+
+				   The dictionary also hashes its keys just like the pool does, so a key returned by
+				   afc_string_pool_intern() can be looked up with afc_dictionary_get_prehashed(), passing the hash
+				   value given by afc_string_pool_hash(), without hashing it again. Since a lookup accepts an
+				   entry holding the very same key pointer before comparing the chars, looking up interned keys
+				   does not touch their chars at all.
+
+			INPUT: 	- dictionary    - Pointer to a valid afc_dictionary instance.
+					- pool			- Pointer to a valid StringPool instance, or NULL to store keys in the entries again.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_DICTIONARY_ERR_NOT_EMPTY if the Dictionary contains some keys.
+
+			NOTES: - Strings are never removed from a StringPool: deleting keys from the Dictionary does not free them.
+				   - Clear (or delete) the Dictionary before clearing the StringPool.
+				   - afc_string_pool_hash() values can be passed to afc_dictionary_get_prehashed() only where
+					 an unsigned long is 64 bits wide.
+
+		 SEE ALSO: - afc_string_pool_new()
+				   - afc_dictionary_set_arena()
+@endnode
+*/
+int afc_dictionary_set_string_pool(Dictionary *dict, StringPool *pool)
+{
+	if (dict == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (dict->magic != AFC_DICTIONARY_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (pool == dict->pool)
+		return (AFC_ERR_NO_ERROR);
+
+	if (_afc_hash_len(dict->hash) != 0)
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_DICTIONARY_ERR_NOT_EMPTY, "Cannot change the StringPool of a non empty Dictionary", NULL));
+
+	// Entries have a different size with and without a pool: deleted ones cannot be recycled
+	afc_dictionary_internal_slabs_free(dict);
+	dict->pool = pool;
+	dict->seed = pool ? pool->seed : afc_string_hash_seed();
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
 // {{{ afc_dictionary_before_first ( d ) ************
 // int afc_dictionary_before_first ( Dictionary * d ) { return ( afc_hash_before_first ( d->hash ) ); }
 // }}}
@@ -782,17 +1073,209 @@ int afc_dictionary_set_custom_sort ( Dictionary * dict, void ( * func )  ( void
 /* ==================================================================================================================
 	INTERNAL FUNCTIONS
 ================================================================================================================== */
-// {{{ afc_dictionary_internal_find ( dict, key )
-static DictionaryData *afc_dictionary_internal_find(Dictionary *dict, const char *key)
+// {{{ afc_dictionary_internal_find ( dict, key, len, hash_value )
+static DictionaryData *afc_dictionary_internal_find(Dictionary *dict, const char *key, unsigned long int len, unsigned long int hash_value)
 {
 	DictionaryData *ddata;
 
-	ddata = (DictionaryData *)afc_hash_find(dict->hash, afc_string_hash((unsigned char *)key, strlen(key)));
+	// The Hash only matches the hash value: the key length (in the AFC String header) and then its chars
+	// are checked to tell apart different keys with the same hash value. The very same key pointer (an
+	// interned key) is accepted at once
+	ddata = (DictionaryData *)afc_hash_find(dict->hash, hash_value);
+	while ((ddata != NULL) && (ddata->key != key) && ((afc_string_len(ddata->key) != len) || (memcmp(ddata->key, key, len) != 0)))
+		ddata = (DictionaryData *)afc_hash_find_next(dict->hash);
+
 	dict->curr_data = ddata;
 
 	return ddata;
 }
 // }}}
+// {{{ afc_dictionary_internal_set ( dict, key, len, hash_value, data )
+static int afc_dictionary_internal_set(Dictionary *dict, const char *key, unsigned long int len, unsigned long int hash_value, void *data)
+{
+	DictionaryData *ddata = NULL;
+
+	if (!dict->skip_find)
+		ddata = afc_dictionary_internal_find(dict, key, len, hash_value); // First of all, we look for the key
+
+	if (ddata == NULL)
+	{
+		if (data == NULL)
+			return (AFC_ERR_NO_ERROR); // If the key does not exists and data is NULL,
+									   // Simply exit without adding a NULL key
+
+		// If the key is not found, we create a new DictionaryData with the key copied inside
+		if ((ddata = afc_dictionary_internal_entry_new(dict, key, len, hash_value)) == NULL)
+			return (AFC_LOG_FAST_INFO(AFC_ERR_NO_MEMORY, "DictionaryData"));
+
+		if (afc_hash_add(dict->hash, ddata->hash_value, ddata) != AFC_ERR_NO_ERROR) // Add the new entry in the Dictionary
+		{
+			AFC_LOG(AFC_LOG_ERROR, AFC_DICTIONARY_ERR_HASHING, "Error during Hashing of this key", ddata->key);
+			afc_dictionary_internal_entry_free(dict, ddata);
+			return (AFC_DICTIONARY_ERR_HASHING);
+		}
+	}
+	else
+	{
+		// If the ddata already exists, we have to call the func_clear (if set) before
+		// resetting its value.
+
+		if (dict->func_clear)
+			dict->func_clear(ddata->value);
+		ddata->value = NULL;
+	}
+
+	if (data != NULL) // If there is a data value, then we add it
+	{
+		ddata->value = data;
+		dict->curr_data = ddata;
+	}
+	else
+		afc_dictionary_del(dict); // Else we delete the current item
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_dictionary_internal_entry_size ( len )
+/* Size of an entry holding a key len chars long: the DictionaryData followed by the key, stored as an AFC String */
+#define afc_dictionary_internal_entry_size(len) \
+	((sizeof(DictionaryData) + (sizeof(unsigned long) * 2) + (len) + AFC_DICTIONARY_ENTRY_ALIGN) & ~(unsigned long)(AFC_DICTIONARY_ENTRY_ALIGN - 1))
+
+/* Size of an entry of the dictionary: the key is not stored in the entry if it is interned in a StringPool */
+#define afc_dictionary_internal_dict_entry_size(dict, len)                                                                         \
+	((dict)->pool ? ((sizeof(DictionaryData) + AFC_DICTIONARY_ENTRY_ALIGN - 1) & ~(unsigned long)(AFC_DICTIONARY_ENTRY_ALIGN - 1)) \
+				  : afc_dictionary_internal_entry_size(len))
+// }}}
+// {{{ afc_dictionary_internal_entry_new ( dict, key, len, hash_value )
+static DictionaryData *afc_dictionary_internal_entry_new(Dictionary *dict, const char *key, unsigned long int len, unsigned long int hash_value)
+{
+	unsigned long int size = afc_dictionary_internal_dict_entry_size(dict, len);
+	unsigned long int cls = size / AFC_DICTIONARY_ENTRY_ALIGN;
+	unsigned long int slab_size;
+	struct afc_dictionary_slab *slab;
+	DictionaryData *ddata;
+	unsigned long *location;
+	const char *interned = NULL;
+
+	// The key is interned first, so that a failure leaves no entry to release. The hash value can be reused
+	// only if it has not been truncated to an unsigned long
+	if (dict->pool)
+	{
+		if (sizeof(unsigned long int) == sizeof(unsigned long long))
+			interned = afc_string_pool_intern_prehashed(dict->pool, key, len, hash_value);
+		else
+			interned = afc_string_pool_intern_view(dict->pool, afc_strview_make(key, len));
+
+		if (interned == NULL)
+			return (NULL);
+	}
+
+	if (cls >= AFC_DICTIONARY_FREE_CLASSES)
+	{
+		// Huge keys get their own memory block
+		if ((ddata = (dict->arena ? afc_arena_alloc(dict->arena, size) : afc_malloc_uninit(size))) == NULL)
+			return (NULL);
+	}
+	else if (dict->free_entries[cls] != NULL)
+	{
+		// Reuse a deleted entry of the same size
+		ddata = dict->free_entries[cls];
+		dict->free_entries[cls] = ddata->value;
+	}
+	else
+	{
+		if ((dict->slab == NULL) || (dict->slab_used + size > dict->slab->size))
+		{
+			slab_size = (dict->slab == NULL) ? AFC_DICTIONARY_SLAB_MIN : dict->slab->size * 2;
+			if (slab_size > AFC_DICTIONARY_SLAB_MAX)
+				slab_size = AFC_DICTIONARY_SLAB_MAX;
+
+			if (dict->arena)
+				slab = afc_arena_alloc(dict->arena, sizeof(struct afc_dictionary_slab) + slab_size);
+			else
+				slab = afc_malloc_uninit(sizeof(struct afc_dictionary_slab) + slab_size);
+
+			if (slab == NULL)
+				return (NULL);
+
+			slab->size = slab_size;
+			slab->next = dict->slab;
+			dict->slab = slab;
+			dict->slab_used = 0;
+		}
+
+		ddata = (DictionaryData *)((char *)(dict->slab + 1) + dict->slab_used);
+		dict->slab_used += size;
+	}
+
+	if (interned)
+		ddata->key = (char *)interned;
+	else
+	{
+		// The key is an AFC String right after the DictionaryData: [ max ] [ len ] [ chars ... ]
+		location = (unsigned long *)(ddata + 1);
+		location[0] = len + 1;
+		location[1] = len;
+
+		ddata->key = (char *)(location + 2);
+		memcpy(ddata->key, key, len);
+		ddata->key[len] = '\0';
+	}
+
+	ddata->value = NULL;
+	ddata->hash_value = hash_value;
+
+	return (ddata);
+}
+// }}}
+// {{{ afc_dictionary_internal_entry_free ( dict, ddata )
+static void afc_dictionary_internal_entry_free(Dictionary *dict, DictionaryData *ddata)
+{
+	unsigned long int cls = afc_dictionary_internal_dict_entry_size(dict, afc_string_len(ddata->key)) / AFC_DICTIONARY_ENTRY_ALIGN;
+
+	if (cls >= AFC_DICTIONARY_FREE_CLASSES)
+	{
+		if (dict->arena == NULL)
+			afc_free(ddata);
+		return;
+	}
+
+	// Slab entries are not freed one by one: they are kept for reuse
+	ddata->value = dict->free_entries[cls];
+	dict->free_entries[cls] = ddata;
+}
+// }}}
+// {{{ afc_dictionary_internal_slabs_free ( dict )
+static void afc_dictionary_internal_slabs_free(Dictionary *dict)
+{
+	struct afc_dictionary_slab *slab;
+
+	// Arena slabs go away with the Arena
+	if (dict->arena)
+		dict->slab = NULL;
+
+	while ((slab = dict->slab) != NULL)
+	{
+		dict->slab = slab->next;
+		afc_free(slab);
+	}
+
+	dict->slab_used = 0;
+	memset(dict->free_entries, 0, sizeof(dict->free_entries));
+}
+// }}}
+#ifdef AFC_DICTIONARY_CHECK_HASH
+// {{{ afc_dictionary_internal_check_hash ( dict, key, hash_value )
+/* Catches hash values computed by another dictionary (with another seed) */
+static int afc_dictionary_internal_check_hash(Dictionary *dict, const char *key, unsigned long int hash_value)
+{
+	if (hash_value != afc_dictionary_hash_key(dict, key))
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_DICTIONARY_ERR_BAD_HASH, "Hash value not returned by this dictionary", key));
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+#endif
 
 #ifdef TEST_CLASS
 // {{{ TEST_CLASS
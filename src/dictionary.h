@@ -29,6 +29,8 @@
 #include "string.h"
 #include "array.h"
 #include "hash.h"
+#include "arena.h"
+#include "string_pool.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -45,13 +47,33 @@ extern "C"
 	enum
 	{
 		AFC_DICTIONARY_ERR_HASHING = AFC_DICTIONARY_BASE + 1, /* Ths Hash class reported an error  */
-		AFC_DICTIONARY_ERR_NOT_FOUND
-	}; /* Requesteq key cannot be found           */
+		AFC_DICTIONARY_ERR_NOT_FOUND, /* Requesteq key cannot be found           */
+		AFC_DICTIONARY_ERR_NOT_EMPTY, /* The Arena cannot be changed on a non empty Dictionary */
+		AFC_DICTIONARY_ERR_BAD_HASH	  /* The hash value was not returned by this dictionary (AFC_DICTIONARY_CHECK_HASH only) */
+	};
+
+/* Entries are allocated from slabs: the first one is AFC_DICTIONARY_SLAB_MIN bytes long, */
+/* every new slab doubles the size of the previous one up to AFC_DICTIONARY_SLAB_MAX bytes */
+#define AFC_DICTIONARY_SLAB_MIN 4096
+#define AFC_DICTIONARY_SLAB_MAX (1024 * 1024)
+
+/* Entry sizes are rounded to AFC_DICTIONARY_ENTRY_ALIGN bytes. Deleted entries are recycled */
+/* by size class; entries bigger than the last class are allocated on their own */
+#define AFC_DICTIONARY_ENTRY_ALIGN 16
+#define AFC_DICTIONARY_FREE_CLASSES 32
 
+	/* Each entry is followed by its key, stored as an AFC String in the same memory block (unless a StringPool holds it) */
 	struct afc_dictionary_internal_data
 	{
 		char *key;
 		void *value;
+		unsigned long int hash_value; // Hash value of the key
+	};
+
+	struct afc_dictionary_slab
+	{
+		struct afc_dictionary_slab *next;
+		unsigned long int size; // Usable bytes after this header
 	};
 
 	struct afc_dictionary
@@ -65,6 +87,16 @@ extern "C"
 		int (*func_clear)(void *);
 
 		BOOL skip_find;
+
+		unsigned long long seed; // Random seed for afc_string_hash64()
+
+		struct afc_dictionary_slab *slab;												// Current slab (older ones are chained after it)
+		unsigned long int slab_used;													// Bytes used in the current slab
+		struct afc_dictionary_internal_data *free_entries[AFC_DICTIONARY_FREE_CLASSES]; // Deleted entries, by size class
+
+		Arena *arena; // If set, slabs and big entries are allocated from this Arena
+
+		StringPool *pool; // If set, keys are interned in this StringPool instead of being stored in the entries
 	};
 
 	typedef struct afc_dictionary Dictionary;
@@ -84,6 +116,13 @@ extern "C"
 
 	int afc_dictionary_set(Dictionary *, const char *, void *);
 	void *afc_dictionary_get(Dictionary *, const char *);
+	int afc_dictionary_set_prehashed(Dictionary *, const char *, unsigned long int, void *);
+	void *afc_dictionary_get_prehashed(Dictionary *, const char *, unsigned long int);
+	unsigned long int afc_dictionary_hash_key(Dictionary *, const char *);
+	int afc_dictionary_set_view(Dictionary *, afc_strview, void *);
+	void *afc_dictionary_get_view(Dictionary *, afc_strview);
+	int afc_dictionary_set_arena(Dictionary *dict, Arena *arena);
+	int afc_dictionary_set_string_pool(Dictionary *dict, StringPool *pool);
 	void *afc_dictionary_get_default(Dictionary *, const char *, void *def_val);
 	void *afc_dictionary_first(Dictionary *);
 #define afc_dictionary_succ(d) afc_dictionary_next(d)
@@ -93,11 +132,11 @@ extern "C"
 	void *afc_dictionary_del(Dictionary *);
 	int afc_dictionary_del_item(Dictionary *dict, const char *key);
 	char *afc_dictionary_find_key(Dictionary *dict, void *data);
-#define afc_dictionary_num_items(d) (d ? afc_array_len(d->hash->am) : 0)
-#define afc_dictionary_len(d) (d ? afc_array_len(d->hash->am) : 0)
+#define afc_dictionary_num_items(d) (d ? _afc_hash_len(d->hash) : 0)
+#define afc_dictionary_len(d) (d ? _afc_hash_len(d->hash) : 0)
 	int afc_dictionary_for_each(Dictionary *dict, int (*func)(Dictionary *am, int pos, void *v, void *info), void *info);
 #define afc_dictionary_set_custom_sort(d, func) d->hash->am->custom_sort = func
-#define afc_dictionary_before_first(d) (d ? afc_array_before_first(d->hash->am) : AFC_ERR_NULL_POINTER)
+#define afc_dictionary_before_first(d) (d ? _afc_hash_before_first(d->hash) : AFC_ERR_NULL_POINTER)
 #define afc_dictionary_obj(d) (d ? d->curr_data->value : AFC_ERR_NULL_POINTER)
 #define afc_dictionary_get_key(d) (char *)(d ? d->curr_data->key : NULL)
 #define afc_dictionary_set_clear_func(d, func) \
@@ -30,10 +30,17 @@
 /*
 @config
 	TITLE:     DirMaster
-	VERSION:   2.00
+	VERSION:   2.02
 	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
 @endnode
 
+@node history
+	- 2.02	- File sizes are formatted with afc_string_format_uint () instead of snprintf ().
+			- afc_dirmaster_set_tags () stops at AFC_TAG_END, instead of reading past the last tag.
+	- 2.01	- Case insensitive sort and search use afc_string_casecomp (): the case insensitive order is no
+			  longer inverted compared to the case sensitive one.
+@endnode
+
 @node quote
 
 :Dark Helmet:
@@ -694,7 +701,7 @@ FileInfo *afc_dirmaster_search(DirMaster *dm, char *name, BOOL no_case)
 	{
 		if (no_case)
 		{
-			if (strcasecmp(fi->name, name) == 0)
+			if (afc_string_casecomp(fi->name, name, ALL) == 0)
 				return (fi);
 		}
 		else
@@ -1049,46 +1056,58 @@ static void afc_dirmaster_internal_size2string(DirMaster *dm, char *dest, unsign
 	unsigned long base = 0;
 	unsigned long rbase = 0;
 	int the_base = 1024;
-	char buf[20];
+	char buf[AFC_STRING_NUMBER_SIZE * 2];
+	char *p = buf;
+	int len;
 
 	if (dm->size_format == SIZEFORMAT_BYTES)
+		p += afc_string_format_uint(p, size);
+	else
 	{
-		snprintf(dest, 20, "%lu %s", size, afc_dirmaster_size_bases[0]);
-		return;
-	}
-
-	if (dm->size_format == SIZEFORMAT_HUMAN_1000)
-		the_base = 1000;
+		if (dm->size_format == SIZEFORMAT_HUMAN_1000)
+			the_base = 1000;
 
-	count = 0;
-	base = the_base;
+		count = 0;
+		base = the_base;
 
-	res = (size / base);
-
-	while (res > 0)
-	{
-		rbase = base;
-		rsize = res;
-		base = base * the_base;
 		res = (size / base);
-		count++;
-	}
 
-	if (count == 0)
-		snprintf(dest, 20, "%lu b", size);
-	else
-	{
-		if (dm->size_decimals)
+		while (res > 0)
 		{
-			snprintf(buf, 20, "%lu", size - (rbase * rsize));
-			if ((size_t)dm->size_decimals < sizeof(buf)) buf[dm->size_decimals] = 0;
-			snprintf(dest, 20, "%d.%.*s %s", rsize, dm->size_decimals, buf, afc_dirmaster_size_bases[count]);
+			rbase = base;
+			rsize = res;
+			base = base * the_base;
+			res = (size / base);
+			count++;
 		}
+
+		if (count == 0)
+			p += afc_string_format_uint(p, size);
 		else
 		{
-			snprintf(dest, 20, "%d %s", rsize, afc_dirmaster_size_bases[count]);
+			p += afc_string_format_int(p, rsize);
+
+			if (dm->size_decimals)
+			{
+				// The decimals are the first digits of the remainder
+				*p++ = '.';
+				len = afc_string_format_uint(p, size - (rbase * rsize));
+				if ((dm->size_decimals > 0) && (len > dm->size_decimals))
+					len = dm->size_decimals;
+				p += len;
+			}
 		}
 	}
+
+	*p++ = ' ';
+	strcpy(p, afc_dirmaster_size_bases[count]);
+
+	// csize holds 19 chars
+	len = strlen(buf);
+	if (len > 19)
+		len = 19;
+	memcpy(dest, buf, len);
+	dest[len] = '\0';
 }
 // }}}
 // {{{ afc_dirmaster_internal_readd ( dm, path, date_format )
@@ -1222,7 +1241,7 @@ static int afc_dirmaster_internal_sort_files(const void *a, const void *b)
 	if (str)
 	{
 		if (isi->case_insensitive)
-			res = -strcasecmp(ca, cb);
+			res = -afc_string_casecomp(ca, cb, ALL);
 		else
 			res = -afc_string_comp(ca, cb, ALL);
 	}
@@ -1248,7 +1267,7 @@ static int afc_dirmaster_internal_parse_tags(DirMaster *dm, int first_tag, va_li
 
 	tag = first_tag;
 
-	while (tag)
+	while ((unsigned int)tag != AFC_TAG_END)
 	{
 		val = va_arg(tags, void *);
 
@@ -23,7 +23,7 @@ static const char class_name[] = "DynamicClass";
 
 static int afc_dynamic_class_internal_parse_args(DynamicClass *dc, va_list args);
 static int afc_dynamic_class_internal_clear_vars(DynamicClass *dc, Dictionary *vars);
-static DynamicClassVar *afc_dynamic_class_internal_alloc(DynamicClass *dc, int kind, char *name, void *val);
+static DynamicClassVar *afc_dynamic_class_internal_alloc(DynamicClass *dc, int kind, char *name, unsigned long int hash_value, void *val);
 // static int afc_dynamic_class_internal_clear_methods ( DynamicClass * dc );
 
 static int afc_dynamic_class_internal_clear_method(void *m);
@@ -381,12 +381,16 @@ DynamicClassMethodData * afc_dynamic_class_find_method ( DynamicClass * dc, char
 int afc_dynamic_class_set_var(DynamicClass *dc, int kind, char *name, void *val)
 {
 	DynamicClassVar *var;
+	unsigned long int hash_value;
 
 	if (dc->vars == NULL)
 		if ((dc->vars = afc_dictionary_new()) == NULL)
 			return (AFC_LOG_FAST_INFO(AFC_ERR_NO_MEMORY, "vars"));
 
-	var = afc_dynamic_class_internal_alloc(dc, kind, name, val);
+	// The name is hashed once for both the lookup and the update
+	hash_value = afc_dictionary_hash_key(dc->vars, name);
+
+	var = afc_dynamic_class_internal_alloc(dc, kind, name, hash_value, val);
 
 	// If internal_alloc() returns a NULL var, it means that we have to
 	// do nothing.
@@ -408,7 +412,7 @@ int afc_dynamic_class_set_var(DynamicClass *dc, int kind, char *name, void *val)
 		break;
 	}
 
-	return (afc_dictionary_set(dc->vars, name, var));
+	return (afc_dictionary_set_prehashed(dc->vars, name, hash_value, var));
 }
 // }}}
 // {{{ afc_dynamic_class_get_var ( dc, name ) *****
@@ -467,13 +471,13 @@ static int afc_dynamic_class_internal_clear_vars(DynamicClass *dc, Dictionary *v
 	return (AFC_ERR_NO_ERROR);
 }
 // }}}
-// {{{ afc_dynamic_class_internal_alloc ( dc, kind, name, val )
-static DynamicClassVar *afc_dynamic_class_internal_alloc(DynamicClass *dc, int kind, char *name, void *val)
+// {{{ afc_dynamic_class_internal_alloc ( dc, kind, name, hash_value, val )
+static DynamicClassVar *afc_dynamic_class_internal_alloc(DynamicClass *dc, int kind, char *name, unsigned long int hash_value, void *val)
 {
 	DynamicClassVar *var;
 
 	// Try to see if the var is already present inside the dictionary
-	var = afc_dictionary_get(dc->vars, name);
+	var = afc_dictionary_get_prehashed(dc->vars, name, hash_value);
 
 	// If it is not present, we alloc a new instance and return
 	if (var == NULL)
@@ -499,7 +503,7 @@ static DynamicClassVar *afc_dynamic_class_internal_alloc(DynamicClass *dc, int k
 	if (val == NULL)
 	{
 		afc_free(var);
-		afc_dictionary_set(dc->vars, name, NULL);
+		afc_dictionary_set_prehashed(dc->vars, name, hash_value, NULL);
 
 		return (NULL);
 	}
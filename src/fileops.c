@@ -22,7 +22,7 @@
 /*
 @config
 	TITLE:     FileOperations
-	VERSION:   1.00
+	VERSION:   1.01
 	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
 @endnode
 
@@ -32,6 +32,11 @@
 	Snoopy
 @endnode
 
+@node history
+	- 1.01:		Scratch strings are taken from afc_tmp_string() (thread safe)
+	- 1.00:		Initial Release
+@endnode
+
 @node intro
 FileOperations is a very special class that ease you the heavy task of system file handling.
 
@@ -318,8 +323,8 @@ int afc_fileops_set_tag(FileOperations *fo, int attr, void *val)
 		break;
 
 	default:
-		afc_string_make(__internal_afc_base->tmp_string, "%x", attr);
-		return (AFC_LOG_FAST_INFO(AFC_ERR_UNSUPPORTED_TAG, __internal_afc_base->tmp_string));
+		afc_string_make(afc_tmp_string(), "%x", attr);
+		return (AFC_LOG_FAST_INFO(AFC_ERR_UNSUPPORTED_TAG, afc_tmp_string()));
 	}
 
 	return (AFC_ERR_NO_ERROR);
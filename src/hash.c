@@ -22,7 +22,7 @@
 /*
 @config
 	TITLE:     Hash
-	VERSION:   1.30
+	VERSION:   1.42
 	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
 @endnode
 
@@ -33,6 +33,9 @@
 @endnode
 
 @node history
+	- 1.42	- HashData items are allocated with afc_pool_alloc()
+	- 1.41	- Added afc_hash_find_next() to get all the elements sharing the same hash_value
+	- 1.40	- Added the AFC_HASH_STORAGE_OPEN storage mode
 	- 1.30	- Added afc_hash_before_first() function
 @endnode
 
@@ -43,6 +46,13 @@ find quickly the element in the table.
 
 Internally, elements are sorted by their /hash_value/ and accessed using a dicothomic search algo.
 
+Hash tables holding a great number of items should use the AFC_HASH_STORAGE_OPEN storage mode instead
+(see afc_hash_set_tag()). In this mode elements are stored in an open addressing table (linear probing) with
+inline slots: adding and finding an element is O(1) on average, the table doubles its size incrementally
+(a few slots are moved on each afc_hash_add() call, so no single insertion pays for the whole resize) and
+deleted slots are compacted immediately, so no tombstones are left behind. Traversal functions like
+afc_hash_first() and afc_hash_next() work in both modes, but in open mode elements are returned in no particular order.
+
 Main features of this class are:
 
 - High search speed.
@@ -50,6 +60,7 @@ Main features of this class are:
 
 To inizialize a new instance, simply call afc_hash_new(), and to destroy it, call the afc_hash_delete().
 To add a new value in the hash table, use the afc_hash_add() method. To get back a value use the afc_hash_find() method.
+Hash does not hash anything by itself: if your keys are strings, afc_string_hash64() is a good way to get their /hash_value/.
 @endnode
 */
 // }}}
@@ -58,6 +69,29 @@ To add a new value in the hash table, use the afc_hash_add() method. To get back
 
 static const char class_name[] = "Hash";
 
+/* Empty slots of an open addressing table point to this sentinel */
+static char afc_hash_internal_empty_slot;
+#define AFC_HASH_INTERNAL_EMPTY ((void *)&afc_hash_internal_empty_slot)
+#define AFC_HASH_INTERNAL_IS_FREE(hd) ((hd)->data == AFC_HASH_INTERNAL_EMPTY)
+
+static int afc_hash_internal_table_init(struct afc_hash_table *t, int bits);
+static void afc_hash_internal_table_free(struct afc_hash_table *t);
+static unsigned long int afc_hash_internal_table_insert(struct afc_hash_table *t, unsigned long int hash_value, void *data);
+static unsigned long int afc_hash_internal_table_find(struct afc_hash_table *t, unsigned long int hash_value);
+static unsigned long int afc_hash_internal_table_probe(struct afc_hash_table *t, unsigned long int hash_value, unsigned long int pos);
+static void afc_hash_internal_table_remove(struct afc_hash_table *t, unsigned long int pos);
+static void afc_hash_internal_fix_origin(struct afc_hash_table *t);
+static int afc_hash_internal_migrate(Hash *hm, int steps);
+static HashData *afc_hash_internal_open_slot(Hash *hm, unsigned long int pos, struct afc_hash_table **table);
+static HashData *afc_hash_internal_open_seek(Hash *hm, unsigned long int pos, int dir);
+static unsigned long int afc_hash_internal_open_span(Hash *hm);
+static int afc_hash_internal_open_add(Hash *hm, unsigned long int hash_value, void *data);
+static void *afc_hash_internal_open_find(Hash *hm, unsigned long int hash_value);
+static void *afc_hash_internal_open_find_next(Hash *hm);
+static void *afc_hash_internal_open_found(Hash *hm, struct afc_hash_table *t, unsigned long int pos);
+static void *afc_hash_internal_open_del(Hash *hm);
+static void afc_hash_internal_open_clear(Hash *hm);
+
 // {{{ struct afc_hash * afc_hash_new ()
 /*
 @node afc_hash_new
@@ -86,6 +120,7 @@ struct afc_hash *afc_hash_new()
 		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "hash", NULL);
 
 	hash->magic = AFC_HASH_MAGIC;
+	hash->storage = AFC_HASH_STORAGE_SORTED;
 
 	if ((hash->am = afc_array_new()) == NULL)
 		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "am", NULL);
@@ -134,6 +169,7 @@ int _afc_hash_delete(struct afc_hash *hash)
 		return afc_res;
 
 	afc_array_delete(hash->am);
+	afc_hash_internal_table_free(&hash->table);
 	afc_free(hash);
 
 	return AFC_ERR_NO_ERROR;
@@ -168,6 +204,14 @@ int afc_hash_clear(struct afc_hash *hash)
 	if (hash->magic != AFC_HASH_MAGIC)
 		return AFC_LOG_FAST(AFC_ERR_INVALID_POINTER);
 
+	hash->find_valid = FALSE;
+
+	if (hash->storage == AFC_HASH_STORAGE_OPEN)
+	{
+		afc_hash_internal_open_clear(hash);
+		return AFC_ERR_NO_ERROR;
+	}
+
 	if (hash->am)
 	{
 		hd = (HashData *)afc_array_first(hash->am);
@@ -177,7 +221,7 @@ int afc_hash_clear(struct afc_hash *hash)
 			if (hash->func_clear)
 				hash->func_clear(hash, hd->data);
 
-			afc_free(hd);
+			afc_pool_free(hd, sizeof(HashData));
 			hd = (HashData *)afc_array_next(hash->am);
 		}
 
@@ -209,7 +253,14 @@ int afc_hash_clear(struct afc_hash *hash)
 */
 int afc_hash_add(Hash *hm, unsigned long int hash_value, void *data)
 {
-	HashData *hd = (HashData *)afc_malloc(sizeof(HashData));
+	HashData *hd;
+
+	hm->find_valid = FALSE;
+
+	if (hm->storage == AFC_HASH_STORAGE_OPEN)
+		return (afc_hash_internal_open_add(hm, hash_value, data));
+
+	hd = (HashData *)afc_pool_alloc(sizeof(HashData));
 
 	if (hd == NULL)
 		return (AFC_LOG_FAST(AFC_ERR_NO_MEMORY));
@@ -293,9 +344,12 @@ int afc_hash_add(Hash *hm, unsigned long int hash_value, void *data)
 					 Hash table.
 
 		NOTES: - It is possible to have more than one single element associated to a given hash_value, and Hash
-					 will simply return the first it finds, and not particulary the very first.
+					 will simply return the first it finds, and not particulary the very first. Use afc_hash_find_next()
+					 to get the other ones.
+				   - The element found becomes the current one.
 
 		 SEE ALSO: - afc_hash_add()
+				   - afc_hash_find_next()
 @endnode
 */
 void *afc_hash_find(Hash *hm, unsigned long int hash_value)
@@ -305,6 +359,12 @@ void *afc_hash_find(Hash *hm, unsigned long int hash_value)
 	int iterations = 0;
 	int max_iterations;
 
+	hm->find_valid = FALSE;
+	hm->find_value = hash_value;
+
+	if (hm->storage == AFC_HASH_STORAGE_OPEN)
+		return (afc_hash_internal_open_find(hm, hash_value));
+
 	// if ( afc_array_is_empty ( hm->am ) ) return ( NULL );
 	if (hm->am->num_items == 0)
 		return (NULL);
@@ -327,7 +387,14 @@ void *afc_hash_find(Hash *hm, unsigned long int hash_value)
 			return (NULL);
 
 		if (hd->hash_value == hash_value)
-			return (hd->data);
+		{
+			// Elements with the same hash_value are adjacent: go back to the first one for afc_hash_find_next()
+			while ((pos > 0) && (((HashData *)hm->am->mem[pos - 1])->hash_value == hash_value))
+				pos--;
+
+			hm->find_valid = TRUE;
+			return (((HashData *)afc_array_item(hm->am, pos))->data);
+		}
 
 		if (hd->hash_value < hash_value)
 			min = pos + 1;
@@ -343,6 +410,50 @@ void *afc_hash_find(Hash *hm, unsigned long int hash_value)
 	return (NULL);
 }
 // }}}
+// {{{ void * afc_hash_find_next ( Hash * hm )
+/*
+@node afc_hash_find_next
+
+			 NAME: afc_hash_find_next ( hash )  - Returns the next element with the same hash_value
+
+		 SYNOPSIS: void * afc_hash_find_next ( Hash * hash )
+
+			SINCE: 1.41
+
+	  DESCRIPTION: This function returns the next element having the same hash_value used in the last afc_hash_find() call.
+				   Call it repeatedly to get all the elements sharing the same hash_value (for example, to resolve
+				   collisions of different keys hashed to the same value).
+
+			INPUT: - hash  - Pointer to a valid afc_hash class.
+
+		  RESULTS: - a pointer to the data of the next element with the same hash_value, or NULL if there are no more elements.
+
+			NOTES: - The element found becomes the current one, so it can be removed with afc_hash_del().
+				   - Any afc_hash_add(), afc_hash_del() or afc_hash_clear() call ends the search.
+
+		 SEE ALSO: - afc_hash_find()
+@endnode
+*/
+void *afc_hash_find_next(Hash *hm)
+{
+	unsigned long int pos;
+
+	if (!hm->find_valid)
+		return (NULL);
+
+	if (hm->storage == AFC_HASH_STORAGE_OPEN)
+		return (afc_hash_internal_open_find_next(hm));
+
+	pos = hm->am->current_pos + 1;
+
+	if ((pos < hm->am->num_items) && (((HashData *)hm->am->mem[pos])->hash_value == hm->find_value))
+		return (((HashData *)afc_array_item(hm->am, pos))->data);
+
+	hm->find_valid = FALSE;
+
+	return (NULL);
+}
+// }}}
 // {{{ HashData * afc_hash_del ( Hash * hm )
 /*
 @node afc_hash_del
@@ -364,13 +475,18 @@ void *afc_hash_del(Hash *hm)
 {
 	HashData *hd;
 
+	hm->find_valid = FALSE;
+
+	if (hm->storage == AFC_HASH_STORAGE_OPEN)
+		return (afc_hash_internal_open_del(hm));
+
 	if ((hd = afc_array_obj(hm->am)) == NULL)
 		return (NULL); // If there is no current object, return NULL
 
 	if (hm->func_clear)
 		hm->func_clear(hm, hd->data); // Free associated data (if clear func exists)
 
-	afc_free(hd); // Free the HashData added to the Array
+	afc_pool_free(hd, sizeof(HashData)); // Free the HashData added to the Array
 
 	hd = afc_array_del(hm->am);
 	return (hd ? hd->data : NULL);
@@ -432,7 +548,17 @@ void *afc_hash_first(Hash *hm)
 {
 	HashData *hd;
 
-	hd = afc_array_first(hm->am);
+	if (hm->storage == AFC_HASH_STORAGE_OPEN)
+	{
+		hm->before_first = FALSE;
+		afc_hash_internal_fix_origin(&hm->old);
+		afc_hash_internal_fix_origin(&hm->table);
+
+		hd = afc_hash_internal_open_seek(hm, 0, 1);
+	}
+	else
+		hd = afc_array_first(hm->am);
+
 	if (hd == NULL)
 		return (NULL);
 
@@ -468,7 +594,16 @@ void *afc_hash_next(Hash *hm)
 {
 	HashData *hd;
 
-	hd = afc_array_next(hm->am);
+	if (hm->storage == AFC_HASH_STORAGE_OPEN)
+	{
+		if (hm->before_first)
+			return (afc_hash_first(hm));
+
+		hd = afc_hash_internal_open_seek(hm, hm->curr_pos + 1, 1);
+	}
+	else
+		hd = afc_array_next(hm->am);
+
 	if (hd == NULL)
 		return (NULL);
 
@@ -503,7 +638,17 @@ void *afc_hash_last(Hash *hm)
 {
 	HashData *hd;
 
-	hd = afc_array_last(hm->am);
+	if (hm->storage == AFC_HASH_STORAGE_OPEN)
+	{
+		hm->before_first = FALSE;
+		afc_hash_internal_fix_origin(&hm->old);
+		afc_hash_internal_fix_origin(&hm->table);
+
+		hd = afc_hash_internal_open_seek(hm, afc_hash_internal_open_span(hm) - 1, -1);
+	}
+	else
+		hd = afc_array_last(hm->am);
+
 	if (hd == NULL)
 		return (NULL);
 
@@ -540,7 +685,11 @@ void *afc_hash_prev(Hash *hm)
 {
 	HashData *hd;
 
-	hd = afc_array_prev(hm->am);
+	if (hm->storage == AFC_HASH_STORAGE_OPEN)
+		hd = (hm->curr_pos > 0) ? afc_hash_internal_open_seek(hm, hm->curr_pos - 1, -1) : NULL;
+	else
+		hd = afc_array_prev(hm->am);
+
 	if (hd == NULL)
 		return (NULL);
 
@@ -609,6 +758,26 @@ int afc_hash_for_each(Hash *hm, int (*func)(Hash *am, int pos, void *v, void *in
 {
 	int res, t = 0;
 	HashData *hd;
+	unsigned long int pos, span;
+
+	if (hm->storage == AFC_HASH_STORAGE_OPEN)
+	{
+		afc_hash_internal_fix_origin(&hm->old);
+		afc_hash_internal_fix_origin(&hm->table);
+
+		span = afc_hash_internal_open_span(hm);
+		for (pos = 0; pos < span; pos++)
+		{
+			hd = afc_hash_internal_open_slot(hm, pos, NULL);
+			if (AFC_HASH_INTERNAL_IS_FREE(hd))
+				continue;
+
+			if ((res = func(hm, t++, hd->data, info)) != AFC_ERR_NO_ERROR)
+				return (res);
+		}
+
+		return (AFC_ERR_NO_ERROR);
+	}
 
 	hd = (HashData *)afc_array_first(hm->am);
 	while (hd)
@@ -650,17 +819,536 @@ int afc_hash_set_custom_sort ( Hash * hm, void ( * func )  ( void * base, size_t
 */
 // }}}
 // {{{ afc_hash_before_first ( hm ) ***************
+int _afc_hash_before_first(Hash *hm)
+{
+	if (hm->storage == AFC_HASH_STORAGE_OPEN)
+	{
+		hm->before_first = TRUE;
+		return (AFC_ERR_NO_ERROR);
+	}
+
+	return (afc_array_before_first(hm->am));
+}
+// }}}
+// {{{ afc_hash_len ( hm ) ***************
+unsigned long int _afc_hash_len(Hash *hm)
+{
+	if (hm->storage == AFC_HASH_STORAGE_OPEN)
+		return (hm->table.num_items + hm->old.num_items);
+
+	return (afc_array_len(hm->am));
+}
+// }}}
+// {{{ afc_hash_is_empty ( hm ) ***************
+short _afc_hash_is_empty(Hash *hm)
+{
+	return (_afc_hash_len(hm) == 0);
+}
+// }}}
+// {{{ afc_hash_is_first ( hm ) ***************
+short _afc_hash_is_first(Hash *hm)
+{
+	unsigned long int pos;
+
+	if (hm->storage != AFC_HASH_STORAGE_OPEN)
+		return (afc_array_is_first(hm->am));
+
+	for (pos = 0; pos < hm->curr_pos; pos++)
+		if (!AFC_HASH_INTERNAL_IS_FREE(afc_hash_internal_open_slot(hm, pos, NULL)))
+			return (FALSE);
+
+	return (TRUE);
+}
+// }}}
+// {{{ afc_hash_is_last ( hm ) ***************
+short _afc_hash_is_last(Hash *hm)
+{
+	if (hm->storage != AFC_HASH_STORAGE_OPEN)
+		return (afc_array_is_last(hm->am));
+
+	return (afc_hash_internal_open_seek(hm, hm->curr_pos + 1, 0) == NULL);
+}
+// }}}
+// {{{ afc_hash_set_tags ( hm, first_tag, ... )
 /*
-int afc_hash_before_first ( Hash * hm )
+@node afc_hash_set_tags
+
+			 NAME: afc_hash_set_tags ( hm, first_tag, ... )  - Sets Hash tags
+
+		 SYNOPSIS: int afc_hash_set_tags ( Hash * hm, int first_tag, ... )
+
+	  DESCRIPTION: This function sets a list of tags in the current Hash. For a list of valid tags, please
+				   see afc_hash_set_tag() function.
+
+			INPUT: - hm         - Pointer to a valid Hash instance.
+				   - first_tag  - First tag to be set
+				   - ...        - Tags and values to be set
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - An error code in case of error
+
+			NOTES: - Remember to end the tag list with AFC_TAG_END
+
+		 SEE ALSO: - afc_hash_set_tag()
+@endnode
+*/
+int _afc_hash_set_tags(Hash *hm, int first_tag, ...)
 {
-	return ( afc_array_before_first ( hm->am ) );
+	va_list args;
+	unsigned int tag;
+	void *val;
+	int res;
+
+	va_start(args, first_tag);
+
+	tag = first_tag;
+
+	while (tag != AFC_TAG_END)
+	{
+		val = va_arg(args, void *);
+
+		if ((res = afc_hash_set_tag(hm, tag, val)) != AFC_ERR_NO_ERROR)
+		{
+			va_end(args);
+			return (res);
+		}
+
+		tag = va_arg(args, int);
+	}
+
+	va_end(args);
+
+	return (AFC_ERR_NO_ERROR);
 }
+// }}}
+// {{{ afc_hash_set_tag ( hm, tag, val )
+/*
+@node afc_hash_set_tag
+
+			 NAME: afc_hash_set_tag ( hm, tag, val )  - Sets a Hash tag
+
+		 SYNOPSIS: int afc_hash_set_tag ( Hash * hm, int tag, void * val )
+
+	  DESCRIPTION: This function sets a tag in the current Hash.
+
+			INPUT: - hm     - Pointer to a valid Hash instance.
+				   - tag    - Tag to be set. Valid tags are:
+						+ AFC_HASH_TAG_STORAGE - The way items are stored. This tag can be set only when
+							the Hash is empty. Valid values are:
+
+							* AFC_HASH_STORAGE_SORTED - (default) Items are kept in an Array sorted by
+								their hash value. Items are looked up with a binary search and are
+								returned sorted by afc_hash_first() / afc_hash_next().
+
+							* AFC_HASH_STORAGE_OPEN - Items are stored in an open addressing table.
+								Adding, finding and deleting items is O(1) on average, but items are
+								returned in no particular order by afc_hash_first() / afc_hash_next().
+								Use this storage for big tables.
+
+				   - val    - Value to set to the tag
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_HASH_ERR_NOT_EMPTY if you try to change the storage of a non empty Hash.
+
+		 SEE ALSO: - afc_hash_set_tags()
+@endnode
 */
+int afc_hash_set_tag(Hash *hm, int tag, void *val)
+{
+	if (hm == NULL)
+		return AFC_LOG_FAST(AFC_ERR_NULL_POINTER);
+
+	if (hm->magic != AFC_HASH_MAGIC)
+		return AFC_LOG_FAST(AFC_ERR_INVALID_POINTER);
+
+	switch (tag)
+	{
+	case AFC_HASH_TAG_STORAGE:
+		if ((int)(long)val == hm->storage)
+			break;
+
+		if (_afc_hash_len(hm) != 0)
+			return AFC_LOG(AFC_LOG_ERROR, AFC_HASH_ERR_NOT_EMPTY, "Cannot change the storage of a non empty Hash", NULL);
+
+		afc_hash_internal_table_free(&hm->table);
+		afc_hash_internal_table_free(&hm->old);
+
+		hm->storage = ((int)(long)val == AFC_HASH_STORAGE_OPEN) ? AFC_HASH_STORAGE_OPEN : AFC_HASH_STORAGE_SORTED;
+		break;
+
+	default:
+		return AFC_LOG_FAST(AFC_ERR_UNSUPPORTED_TAG);
+	}
+
+	return (AFC_ERR_NO_ERROR);
+}
 // }}}
 
 /* =====================================================================================
 	 INTERNAL FUNCTIONS
 ===================================================================================== */
+// {{{ afc_hash_internal_table_init ( t, bits )
+static int afc_hash_internal_table_init(struct afc_hash_table *t, int bits)
+{
+	unsigned long int t1;
+
+	t->size = 1UL << bits;
+	if ((t->slots = afc_malloc(sizeof(HashData) * t->size)) == NULL)
+	{
+		t->size = 0;
+		return (AFC_ERR_NO_MEMORY);
+	}
+
+	for (t1 = 0; t1 < t->size; t1++)
+		t->slots[t1].data = AFC_HASH_INTERNAL_EMPTY;
+
+	t->bits = bits;
+	t->num_items = 0;
+	t->origin = 0;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_hash_internal_table_free ( t )
+static void afc_hash_internal_table_free(struct afc_hash_table *t)
+{
+	if (t->slots)
+		afc_free(t->slots);
+
+	memset(t, 0, sizeof(struct afc_hash_table));
+}
+// }}}
+// {{{ afc_hash_internal_home ( t, hash_value )
+/* Fibonacci hashing: sequential values and pointers (with their low bits always 0) get spread on the whole table */
+#define afc_hash_internal_home(t, hash_value) \
+	((unsigned long int)(((unsigned long long)(hash_value) * 0x9E3779B97F4A7C15ULL) >> (64 - (t)->bits)))
+// }}}
+// {{{ afc_hash_internal_table_insert ( t, hash_value, data )
+static unsigned long int afc_hash_internal_table_insert(struct afc_hash_table *t, unsigned long int hash_value, void *data)
+{
+	unsigned long int mask = t->size - 1;
+	unsigned long int pos = afc_hash_internal_home(t, hash_value);
+
+	while (!AFC_HASH_INTERNAL_IS_FREE(&t->slots[pos]))
+		pos = (pos + 1) & mask;
+
+	t->slots[pos].hash_value = hash_value;
+	t->slots[pos].data = data;
+	t->num_items++;
+
+	return (pos);
+}
+// }}}
+// {{{ afc_hash_internal_table_find ( t, hash_value )
+/* Returns t->size if the hash_value is not in the table */
+static unsigned long int afc_hash_internal_table_find(struct afc_hash_table *t, unsigned long int hash_value)
+{
+	if (t->num_items == 0)
+		return (t->size);
+
+	return (afc_hash_internal_table_probe(t, hash_value, afc_hash_internal_home(t, hash_value)));
+}
+// }}}
+// {{{ afc_hash_internal_table_probe ( t, hash_value, pos )
+/* Looks for hash_value from slot pos up to the end of its cluster. Returns t->size if it is not found */
+static unsigned long int afc_hash_internal_table_probe(struct afc_hash_table *t, unsigned long int hash_value, unsigned long int pos)
+{
+	unsigned long int mask = t->size - 1;
+
+	while (!AFC_HASH_INTERNAL_IS_FREE(&t->slots[pos]))
+	{
+		if (t->slots[pos].hash_value == hash_value)
+			return (pos);
+
+		pos = (pos + 1) & mask;
+	}
+
+	return (t->size);
+}
+// }}}
+// {{{ afc_hash_internal_table_remove ( t, pos )
+/* Backward shift deletion: the following items of the cluster are moved back to fill
+   the hole, so that no tombstone is needed and probe sequences stay short */
+static void afc_hash_internal_table_remove(struct afc_hash_table *t, unsigned long int pos)
+{
+	unsigned long int mask = t->size - 1;
+	unsigned long int next = pos;
+	unsigned long int home;
+
+	while (1)
+	{
+		next = (next + 1) & mask;
+
+		if (AFC_HASH_INTERNAL_IS_FREE(&t->slots[next]))
+			break;
+
+		home = afc_hash_internal_home(t, t->slots[next].hash_value);
+
+		// The item can be moved only if its home slot is not in the ( pos, next ] range
+		if (((next - home) & mask) >= ((next - pos) & mask))
+		{
+			t->slots[pos] = t->slots[next];
+			pos = next;
+		}
+	}
+
+	t->slots[pos].data = AFC_HASH_INTERNAL_EMPTY;
+	t->num_items--;
+}
+// }}}
+// {{{ afc_hash_internal_fix_origin ( t )
+/* Traversals start right after an empty slot: since deletions never fill an empty slot, items shifted
+   back by afc_hash_internal_table_remove() during a traversal are never skipped nor returned twice */
+static void afc_hash_internal_fix_origin(struct afc_hash_table *t)
+{
+	unsigned long int mask = t->size - 1;
+
+	if (t->slots == NULL)
+		return;
+
+	while (!AFC_HASH_INTERNAL_IS_FREE(&t->slots[t->origin]))
+		t->origin = (t->origin + 1) & mask;
+}
+// }}}
+// {{{ afc_hash_internal_migrate ( hm, steps )
+static int afc_hash_internal_migrate(Hash *hm, int steps)
+{
+	struct afc_hash_table *old = &hm->old;
+	HashData *hd;
+
+	while ((old->slots != NULL) && (steps-- > 0))
+	{
+		if ((old->num_items == 0) || (hm->migrate_pos >= old->size))
+		{
+			afc_hash_internal_table_free(old);
+			hm->migrate_pos = 0;
+			break;
+		}
+
+		hd = &old->slots[hm->migrate_pos];
+
+		if (AFC_HASH_INTERNAL_IS_FREE(hd))
+		{
+			hm->migrate_pos++;
+			continue;
+		}
+
+		// The slot is filled again by the backward shift, so migrate_pos is not incremented
+		afc_hash_internal_table_insert(&hm->table, hd->hash_value, hd->data);
+		afc_hash_internal_table_remove(old, hm->migrate_pos);
+	}
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_hash_internal_open_span ( hm )
+static unsigned long int afc_hash_internal_open_span(Hash *hm)
+{
+	return (hm->old.size + hm->table.size);
+}
+// }}}
+// {{{ afc_hash_internal_open_slot ( hm, pos, table )
+/* Maps a traversal position to its slot. Positions of the old table (if any) come first */
+static HashData *afc_hash_internal_open_slot(Hash *hm, unsigned long int pos, struct afc_hash_table **table)
+{
+	struct afc_hash_table *t = &hm->old;
+
+	if (pos >= t->size)
+	{
+		pos -= t->size;
+		t = &hm->table;
+
+		if (pos >= t->size)
+			return (NULL);
+	}
+
+	if (table)
+		*table = t;
+
+	return (&t->slots[(t->origin + 1 + pos) & (t->size - 1)]);
+}
+// }}}
+// {{{ afc_hash_internal_open_seek ( hm, pos, dir )
+/* Looks for the first used slot starting from pos and moving in dir direction.
+   If one is found, it becomes the current one. When dir is 0 the current slot is left untouched */
+static HashData *afc_hash_internal_open_seek(Hash *hm, unsigned long int pos, int dir)
+{
+	unsigned long int span = afc_hash_internal_open_span(hm);
+	HashData *hd;
+
+	while (pos < span)
+	{
+		hd = afc_hash_internal_open_slot(hm, pos, NULL);
+
+		if (!AFC_HASH_INTERNAL_IS_FREE(hd))
+		{
+			if (dir != 0)
+				hm->curr_pos = pos;
+			return (hd);
+		}
+
+		if (dir < 0)
+		{
+			if (pos == 0)
+				break;
+			pos--;
+		}
+		else
+			pos++;
+	}
+
+	return (NULL);
+}
+// }}}
+// {{{ afc_hash_internal_open_add ( hm, hash_value, data )
+static int afc_hash_internal_open_add(Hash *hm, unsigned long int hash_value, void *data)
+{
+	int res;
+
+	if (hm->table.slots == NULL)
+		if ((res = afc_hash_internal_table_init(&hm->table, AFC_HASH_OPEN_MIN_BITS)) != AFC_ERR_NO_ERROR)
+			return (AFC_LOG_FAST_INFO(res, "slots"));
+
+	afc_hash_internal_migrate(hm, AFC_HASH_OPEN_MIGRATE_STEP);
+
+	// Keep the load factor under 3/4
+	if ((hm->table.num_items + 1) * 4 > hm->table.size * 3)
+	{
+		// A previous resize still running (it should never happen): complete it first
+		while (hm->old.slots)
+			afc_hash_internal_migrate(hm, AFC_HASH_OPEN_MIGRATE_STEP);
+
+		hm->old = hm->table;
+		hm->migrate_pos = 0;
+
+		if ((res = afc_hash_internal_table_init(&hm->table, hm->old.bits + 1)) != AFC_ERR_NO_ERROR)
+		{
+			hm->table = hm->old;
+			memset(&hm->old, 0, sizeof(struct afc_hash_table));
+			return (AFC_LOG_FAST_INFO(res, "slots"));
+		}
+
+		afc_hash_internal_migrate(hm, AFC_HASH_OPEN_MIGRATE_STEP);
+	}
+
+	afc_hash_internal_table_insert(&hm->table, hash_value, data);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_hash_internal_open_find ( hm, hash_value )
+static void *afc_hash_internal_open_find(Hash *hm, unsigned long int hash_value)
+{
+	struct afc_hash_table *t = &hm->table;
+	unsigned long int pos;
+
+	if ((pos = afc_hash_internal_table_find(t, hash_value)) == t->size)
+	{
+		t = &hm->old;
+
+		if ((pos = afc_hash_internal_table_find(t, hash_value)) == t->size)
+			return (NULL);
+	}
+
+	return (afc_hash_internal_open_found(hm, t, pos));
+}
+// }}}
+// {{{ afc_hash_internal_open_find_next ( hm )
+static void *afc_hash_internal_open_find_next(Hash *hm)
+{
+	struct afc_hash_table *t = hm->find_table;
+	unsigned long int pos;
+
+	// Elements with the same hash_value are in the same cluster, after the last one found
+	if ((pos = afc_hash_internal_table_probe(t, hm->find_value, (hm->find_slot + 1) & (t->size - 1))) == t->size)
+	{
+		// The active table is searched first: go on with the old one (if any)
+		if (t == &hm->old)
+		{
+			hm->find_valid = FALSE;
+			return (NULL);
+		}
+
+		t = &hm->old;
+
+		if ((pos = afc_hash_internal_table_find(t, hm->find_value)) == t->size)
+		{
+			hm->find_valid = FALSE;
+			return (NULL);
+		}
+	}
+
+	return (afc_hash_internal_open_found(hm, t, pos));
+}
+// }}}
+// {{{ afc_hash_internal_open_found ( hm, t, pos )
+static void *afc_hash_internal_open_found(Hash *hm, struct afc_hash_table *t, unsigned long int pos)
+{
+	unsigned long int base = (t == &hm->table) ? hm->old.size : 0;
+
+	afc_hash_internal_fix_origin(t);
+
+	// Make the item the current one, so that afc_hash_del() can remove it
+	hm->before_first = FALSE;
+	hm->curr_pos = base + ((pos - t->origin - 1) & (t->size - 1));
+
+	hm->find_valid = TRUE;
+	hm->find_table = t;
+	hm->find_slot = pos;
+
+	return (t->slots[pos].data);
+}
+// }}}
+// {{{ afc_hash_internal_open_del ( hm )
+static void *afc_hash_internal_open_del(Hash *hm)
+{
+	struct afc_hash_table *t;
+	HashData *hd;
+
+	if ((hd = afc_hash_internal_open_slot(hm, hm->curr_pos, &t)) == NULL)
+		return (NULL);
+
+	if (AFC_HASH_INTERNAL_IS_FREE(hd))
+		return (NULL);
+
+	if (hm->func_clear)
+		hm->func_clear(hm, hd->data);
+
+	afc_hash_internal_table_remove(t, hd - t->slots);
+
+	// Like afc_array_del(), return the next item or the last one if there is no next item
+	if ((hd = afc_hash_internal_open_seek(hm, hm->curr_pos, 1)) == NULL)
+		if ((hm->curr_pos == 0) || ((hd = afc_hash_internal_open_seek(hm, hm->curr_pos - 1, -1)) == NULL))
+			return (NULL);
+
+	return (hd->data);
+}
+// }}}
+// {{{ afc_hash_internal_open_clear ( hm )
+static void afc_hash_internal_open_clear(Hash *hm)
+{
+	unsigned long int pos, span;
+	HashData *hd;
+
+	if (hm->func_clear)
+	{
+		span = afc_hash_internal_open_span(hm);
+		for (pos = 0; pos < span; pos++)
+		{
+			hd = afc_hash_internal_open_slot(hm, pos, NULL);
+			if (!AFC_HASH_INTERNAL_IS_FREE(hd))
+				hm->func_clear(hm, hd->data);
+		}
+	}
+
+	afc_hash_internal_table_free(&hm->old);
+	afc_hash_internal_table_free(&hm->table);
+
+	hm->migrate_pos = 0;
+	hm->curr_pos = 0;
+	hm->before_first = FALSE;
+}
+// }}}
 
 #ifdef TEST_HASH
 int main()
@@ -26,6 +26,7 @@
 
 #include "base.h"
 #include "array.h"
+#include "pool.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -38,6 +39,31 @@ extern "C"
 /* AFC afc_hash Base value for constants */
 #define AFC_HASH_BASE 0x7000
 
+/* An open addressing table starts with ( 1 << AFC_HASH_OPEN_MIN_BITS ) slots */
+#define AFC_HASH_OPEN_MIN_BITS 4
+
+/* Number of old slots moved to the new table on each afc_hash_add() during a resize */
+#define AFC_HASH_OPEN_MIGRATE_STEP 64
+
+	/* Errors for afc_hash */
+	enum
+	{
+		AFC_HASH_ERR_NOT_EMPTY = AFC_HASH_BASE + 1 /* Storage cannot be changed on a non empty Hash */
+	};
+
+	/* Tags for afc_hash */
+	enum
+	{
+		AFC_HASH_TAG_STORAGE = AFC_HASH_BASE + 1 /* Storage mode. See AFC_HASH_STORAGE_* */
+	};
+
+	/* Storage modes */
+	enum
+	{
+		AFC_HASH_STORAGE_SORTED = AFC_HASH_BASE + 0x10, /* Sorted Array with binary search (default) */
+		AFC_HASH_STORAGE_OPEN							/* Open addressing table with inline slots   */
+	};
+
 	struct hash_internal_data
 	{
 		unsigned long int hash_value;
@@ -46,6 +72,15 @@ extern "C"
 
 	typedef struct hash_internal_data HashData;
 
+	struct afc_hash_table
+	{
+		HashData *slots;			 // Inline slots (empty ones have data set to an internal sentinel)
+		unsigned long int size;		 // Number of slots (always a power of two)
+		unsigned long int num_items; // Number of used slots
+		unsigned long int origin;	 // An empty slot: traversals start right after it
+		int bits;					 // log2 ( size )
+	};
+
 	struct afc_hash
 	{
 		unsigned long magic;
@@ -55,6 +90,21 @@ extern "C"
 		int (*func_clear)(struct afc_hash *, void *);
 
 		void *info; // Generic Info pointer
+
+		int storage; // One of AFC_HASH_STORAGE_*
+
+		// AFC_HASH_STORAGE_OPEN only
+		struct afc_hash_table table;   // Active table
+		struct afc_hash_table old;	   // Table being migrated during an incremental resize
+		unsigned long int migrate_pos; // Next slot of the old table to migrate
+		unsigned long int curr_pos;	   // Traversal position (old table slots come first)
+		BOOL before_first;
+
+		// Last afc_hash_find() state, used by afc_hash_find_next()
+		BOOL find_valid;
+		unsigned long int find_value;
+		struct afc_hash_table *find_table; // AFC_HASH_STORAGE_OPEN only
+		unsigned long int find_slot;	   // AFC_HASH_STORAGE_OPEN only
 	};
 
 	typedef struct afc_hash Hash;
@@ -71,6 +121,7 @@ extern "C"
 	int afc_hash_clear(struct afc_hash *);
 	int afc_hash_add(Hash *, unsigned long int, void *);
 	void *afc_hash_find(Hash *, unsigned long int);
+	void *afc_hash_find_next(Hash *);
 	void *afc_hash_del(Hash *);
 	HashData *afc_hash_item(Hash *, int);
 	void *afc_hash_first(Hash *hm);
@@ -78,6 +129,14 @@ extern "C"
 	void *afc_hash_last(Hash *hm);
 	void *afc_hash_prev(Hash *hm);
 	int afc_hash_for_each(Hash *hm, int (*func)(Hash *hm, int pos, void *v, void *info), void *info);
+	unsigned long int _afc_hash_len(Hash *hm);
+	int _afc_hash_before_first(Hash *hm);
+	short _afc_hash_is_empty(Hash *hm);
+	short _afc_hash_is_first(Hash *hm);
+	short _afc_hash_is_last(Hash *hm);
+#define afc_hash_set_tags(hm, first, ...) _afc_hash_set_tags(hm, first, ##__VA_ARGS__, AFC_TAG_END)
+	int _afc_hash_set_tags(Hash *hm, int first_tag, ...);
+	int afc_hash_set_tag(Hash *hm, int tag, void *val);
 
 #define afc_hash_succ(hm) afc_hash_next(hm)
 #define afc_hash_set_clear_func(hm, func) \
@@ -90,11 +149,11 @@ extern "C"
 	{                                      \
 		hm->am->custom_sort = func;        \
 	}
-#define afc_hash_before_first(hm) (hm ? afc_array_before_first(hm->am) : AFC_ERR_NULL_POINTER)
-#define afc_hash_is_empty(hm) (hm ? afc_array_is_empty(hm->am) : TRUE)
-#define afc_hash_is_first(hm) (hm ? afc_array_is_first(hm->am) : FALSE)
-#define afc_hash_is_last(hm) (hm ? afc_array_is_last(hm->am) : FALSE)
-#define afc_hash_len(hm) (hm ? afc_array_len(hm->am) : -1)
+#define afc_hash_before_first(hm) (hm ? _afc_hash_before_first(hm) : AFC_ERR_NULL_POINTER)
+#define afc_hash_is_empty(hm) (hm ? _afc_hash_is_empty(hm) : TRUE)
+#define afc_hash_is_first(hm) (hm ? _afc_hash_is_first(hm) : FALSE)
+#define afc_hash_is_last(hm) (hm ? _afc_hash_is_last(hm) : FALSE)
+#define afc_hash_len(hm) (hm ? (long)_afc_hash_len(hm) : -1L)
 
 #ifdef __cplusplus
 }
@@ -70,6 +70,12 @@ HttpClient * afc_http_client_new(void)
 	if (!(hc->resp_headers = afc_dictionary_new()))
 		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "resp_headers", NULL);
 
+	// Servers send the same header names in every response: they are stored once
+	if (!(hc->keys = afc_string_pool_new()))
+		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "keys", NULL);
+
+	afc_dictionary_set_string_pool(hc->resp_headers, hc->keys);
+
 	if (!(hc->buf = afc_string_new(4096)))
 		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "buf", NULL);
 
@@ -133,6 +139,7 @@ int _afc_http_client_delete(HttpClient * hc)
 	afc_inet_client_delete(hc->inet);
 	afc_dictionary_delete(hc->req_headers);
 	afc_dictionary_delete(hc->resp_headers);
+	afc_string_pool_delete(hc->keys);
 	afc_string_delete(hc->buf);
 	afc_string_delete(hc->tmp);
 
@@ -179,6 +186,7 @@ int afc_http_client_clear(HttpClient * hc)
 
 	if (hc->req_headers) afc_dictionary_clear(hc->req_headers);
 	if (hc->resp_headers) afc_dictionary_clear(hc->resp_headers);
+	if (hc->keys) afc_string_pool_clear(hc->keys);
 
 	if (hc->status_message)
 	{
@@ -595,6 +603,8 @@ int afc_http_client_request(HttpClient * hc, const char * method, const char * u
 
 	// Clear previous response data
 	if (hc->resp_headers) afc_dictionary_clear(hc->resp_headers);
+	if (afc_string_pool_len(hc->keys) > AFC_HTTP_CLIENT_MAX_POOLED_KEYS)
+		afc_string_pool_clear(hc->keys);
 	if (hc->status_message)
 	{
 		afc_string_delete(hc->status_message);
@@ -903,53 +913,55 @@ static int _afc_http_client_send_request(HttpClient * hc, const char * method, c
 
 	char * key;
 	char * val;
-	char * request;
+	afc_string_builder request;
+	char num[AFC_STRING_NUMBER_SIZE];
 	int res;
 
 	if (!hc || hc->magic != AFC_HTTP_CLIENT_MAGIC)
 		RAISE_RC(AFC_LOG_ERROR, AFC_ERR_INVALID_POINTER, "Invalid HttpClient object", "", AFC_ERR_INVALID_POINTER);
 
-	/* Build the entire HTTP request (headers) into a single buffer */
-	request = afc_string_new(4096);
-	if (!request)
+	/* Build the entire HTTP request (headers) into a single buffer, that grows with the headers */
+	if (afc_string_builder_init(&request, 1024) != AFC_ERR_NO_ERROR)
 		RAISE_RC(AFC_LOG_ERROR, AFC_ERR_NO_MEMORY, "Cannot allocate request buffer", "", AFC_ERR_NO_MEMORY);
 
-	/* Request line */
-	afc_string_make(request, "%s /%s HTTP/1.1\r\n", method, path);
-
-	/* Host header (required for HTTP/1.1) */
-	afc_string_clear(hc->buf);
-	afc_string_make(hc->buf, "Host: %s\r\n", hc->host);
-	afc_string_add(request, hc->buf, ALL);
+	/* Request line and Host header (required for HTTP/1.1) */
+	res = afc_string_builder_append_fmt(&request, "%s /%s HTTP/1.1\r\nHost: %s\r\n", method, path, hc->host);
 
 	/* Content-Length if body is present */
-	if (body && body_len > 0)
+	if (body && body_len > 0 && res == AFC_ERR_NO_ERROR)
 	{
-		afc_string_clear(hc->buf);
-		afc_string_make(hc->buf, "Content-Length: %d\r\n", body_len);
-		afc_string_add(request, hc->buf, ALL);
+		res = afc_string_builder_append(&request, "Content-Length: ", ALL);
+		if (res == AFC_ERR_NO_ERROR)
+			res = afc_string_builder_append(&request, num, afc_string_format_int(num, body_len));
+		if (res == AFC_ERR_NO_ERROR)
+			res = afc_string_builder_append(&request, "\r\n", 2);
 	}
 
 	/* Custom headers */
-	if ((val = (char *)afc_dictionary_first(hc->req_headers)))
+	if ((res == AFC_ERR_NO_ERROR) && (val = (char *)afc_dictionary_first(hc->req_headers)))
 	{
 		do
 		{
 			key = afc_dictionary_get_key(hc->req_headers);
 
-			afc_string_clear(hc->buf);
-			afc_string_make(hc->buf, "%s: %s\r\n", key, val);
-			afc_string_add(request, hc->buf, ALL);
+			res = afc_string_builder_append_fmt(&request, "%s: %s\r\n", key, val);
 
-		} while ((val = (char *)afc_dictionary_succ(hc->req_headers)));
+		} while ((res == AFC_ERR_NO_ERROR) && (val = (char *)afc_dictionary_succ(hc->req_headers)));
 	}
 
 	/* Blank line to end headers */
-	afc_string_add(request, "\r\n", ALL);
+	if (res == AFC_ERR_NO_ERROR)
+		res = afc_string_builder_append(&request, "\r\n", 2);
+
+	if (res != AFC_ERR_NO_ERROR)
+	{
+		afc_string_builder_free(&request);
+		RAISE_RC(AFC_LOG_ERROR, AFC_ERR_NO_MEMORY, "Cannot allocate request buffer", "", AFC_ERR_NO_MEMORY);
+	}
 
 	/* Send entire header block in one write */
-	res = afc_inet_client_send(hc->inet, request, afc_string_len(request));
-	afc_string_delete(request);
+	res = afc_inet_client_send(hc->inet, request.str, afc_string_len(request.str));
+	afc_string_builder_free(&request);
 
 	if (res != AFC_ERR_NO_ERROR)
 		RAISE_RC(AFC_LOG_ERROR, AFC_HTTP_CLIENT_ERR_REQUEST, "Failed to send request headers", "", res);
@@ -1124,6 +1136,7 @@ static int _afc_http_client_read_body(HttpClient * hc, InetClient * inet)
 	int bytes_read;
 	char chunk_size_str[32];
 	int chunk_size;
+	afc_string_builder body;
 
 	if (!hc || hc->magic != AFC_HTTP_CLIENT_MAGIC)
 		return AFC_ERR_INVALID_POINTER;
@@ -1132,12 +1145,14 @@ static int _afc_http_client_read_body(HttpClient * hc, InetClient * inet)
 	content_length_str = (char *)afc_dictionary_get(hc->resp_headers, "content-length");
 	transfer_encoding = (char *)afc_dictionary_get(hc->resp_headers, "transfer-encoding");
 
-	// Initialize response body
+	// Initialize response body: it grows with the data read, so bodies of any size are kept whole
 	if (hc->resp_body)
 		afc_string_delete(hc->resp_body);
-	hc->resp_body = afc_string_new(4096);
 	hc->resp_body_len = 0;
 
+	if (afc_string_builder_init(&body, 4096) != AFC_ERR_NO_ERROR)
+		return AFC_ERR_NO_MEMORY;
+
 	// Handle chunked encoding
 	if (transfer_encoding && strstr(transfer_encoding, "chunked"))
 	{
@@ -1159,8 +1174,8 @@ static int _afc_http_client_read_body(HttpClient * hc, InetClient * inet)
 				if (bytes_read <= 0)
 					break;
 
-				hc->buf[bytes_read] = '\0';
-				afc_string_add(hc->resp_body, hc->buf, ALL);
+				if (afc_string_builder_append(&body, hc->buf, bytes_read) != AFC_ERR_NO_ERROR)
+					break;
 				hc->resp_body_len += bytes_read;
 				chunk_size -= bytes_read;
 			}
@@ -1181,8 +1196,8 @@ static int _afc_http_client_read_body(HttpClient * hc, InetClient * inet)
 			if (bytes_read <= 0)
 				break;
 
-			hc->buf[bytes_read] = '\0';
-			afc_string_add(hc->resp_body, hc->buf, ALL);
+			if (afc_string_builder_append(&body, hc->buf, bytes_read) != AFC_ERR_NO_ERROR)
+				break;
 			hc->resp_body_len += bytes_read;
 			content_length -= bytes_read;
 		}
@@ -1192,12 +1207,14 @@ static int _afc_http_client_read_body(HttpClient * hc, InetClient * inet)
 	{
 		while ((bytes_read = afc_inet_client_read_bytes(inet, hc->buf, afc_string_max(hc->buf))) > 0)
 		{
-			hc->buf[bytes_read] = '\0';
-			afc_string_add(hc->resp_body, hc->buf, ALL);
+			if (afc_string_builder_append(&body, hc->buf, bytes_read) != AFC_ERR_NO_ERROR)
+				break;
 			hc->resp_body_len += bytes_read;
 		}
 	}
 
+	hc->resp_body = afc_string_builder_finish(&body);
+
 	return AFC_ERR_NO_ERROR;
 }
 // }}}
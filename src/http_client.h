@@ -15,6 +15,9 @@
 /* Maximum redirects to follow */
 #define AFC_HTTP_CLIENT_MAX_REDIRECTS 10
 
+/* The pool of the response header names is emptied when it holds more than this number of strings */
+#define AFC_HTTP_CLIENT_MAX_POOLED_KEYS 256
+
 // HTTP Client tags for configuration
 enum {
 	AFC_HTTP_CLIENT_TAG_HOST = AFC_HTTP_CLIENT_BASE + 100,
@@ -55,6 +58,7 @@ struct afc_http_client
 	int status_code;           /* HTTP status code */
 	char * status_message;     /* HTTP status message */
 	Dictionary * resp_headers; /* Response headers */
+	StringPool * keys;         /* Names of the response headers, shared by all the responses */
 	char * resp_body;          /* Response body */
 	int resp_body_len;         /* Response body length */
 
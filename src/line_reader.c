@@ -0,0 +1,659 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "line_reader.h"
+
+// {{{ docs
+/*
+@config
+	TITLE:     LineReader
+	VERSION:   1.00
+	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
+@endnode
+
+@node quote
+	*I have made this longer than usual because I have not had time to make it shorter.*
+
+		Blaise Pascal
+@endnode
+
+@node history
+	- 1.00:		Initial Release
+@endnode
+
+@node intro
+LineReader reads text files one line at a time, like afc_string_fget() does, but it is meant for big files: logs,
+CSV exports and the like. Lines are returned as /afc_strview/ views, so no line is ever copied and there is no limit
+on the length of a line.
+
+Regular files are mapped in memory, so the views point directly inside the file. When a file cannot be mapped
+(pipes, devices, or when the AFC_LINE_READER_TAG_USE_MMAP tag is set to FALSE) it is read in large blocks, and the
+views point inside the block buffer.
+
+A file can also be split in N chunks with afc_line_reader_open_chunk(): chunk boundaries are moved to the start of
+a line, so that every line of the file is returned by exactly one chunk. Each chunk can be read by a different
+thread, with its own LineReader instance.
+
+To inizialize a new instance, simply call afc_line_reader_new(), and to destroy it, call the afc_line_reader_delete().
+Open a file with afc_line_reader_open(), then call afc_line_reader_next() until it returns FALSE.
+@endnode
+*/
+// }}}
+
+static const char class_name[] = "LineReader";
+
+static int afc_line_reader_internal_fill(LineReader *lr);
+static off_t afc_line_reader_internal_line_start(LineReader *lr, off_t offset);
+static ssize_t afc_line_reader_internal_pread(LineReader *lr, char *buf, size_t size, off_t offset);
+
+// {{{ afc_line_reader_new ()
+/*
+@node afc_line_reader_new
+
+			 NAME: afc_line_reader_new ()    - Initializes a new LineReader instance.
+
+		 SYNOPSIS: LineReader * afc_line_reader_new ()
+
+	  DESCRIPTION: This function initializes a new LineReader instance.
+
+			INPUT: NONE
+
+		  RESULTS: a valid inizialized LineReader structure. NULL in case of errors.
+
+		 SEE ALSO: - afc_line_reader_delete()
+				   - afc_line_reader_open()
+
+@endnode
+*/
+LineReader *afc_line_reader_new(void)
+{
+	TRY(LineReader *)
+
+	LineReader *lr = (LineReader *)afc_malloc(sizeof(LineReader));
+
+	if (lr == NULL)
+		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "line_reader", NULL);
+
+	lr->magic = AFC_LINE_READER_MAGIC;
+	lr->fd = -1;
+	lr->block_size = AFC_LINE_READER_DEFAULT_BLOCK_SIZE;
+	lr->use_mmap = TRUE;
+
+	RETURN(lr);
+
+	EXCEPT
+	afc_line_reader_delete(lr);
+
+	FINALLY
+
+	ENDTRY
+}
+// }}}
+// {{{ afc_line_reader_delete ( lr )
+/*
+@node afc_line_reader_delete
+
+			 NAME: afc_line_reader_delete ( lr )  - Disposes a valid LineReader instance.
+
+		 SYNOPSIS: int afc_line_reader_delete ( LineReader * lr )
+
+	  DESCRIPTION: This function closes the file being read (if any) and frees the LineReader instance.
+
+			INPUT: - lr  - Pointer to a valid LineReader instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+			NOTES: - this method calls: afc_line_reader_clear()
+
+		 SEE ALSO: - afc_line_reader_new()
+				   - afc_line_reader_clear()
+@endnode
+*/
+int _afc_line_reader_delete(LineReader *lr)
+{
+	int afc_res;
+
+	if ((afc_res = afc_line_reader_clear(lr)) != AFC_ERR_NO_ERROR)
+		return (afc_res);
+
+	afc_free(lr);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_line_reader_clear ( lr )
+/*
+@node afc_line_reader_clear
+
+			 NAME: afc_line_reader_clear ( lr )  - Closes the file and resets the instance
+
+		 SYNOPSIS: int afc_line_reader_clear ( LineReader * lr )
+
+	  DESCRIPTION: This function closes the file being read (if any) and frees all the memory used to read it.
+
+			INPUT: - lr  - Pointer to a valid LineReader instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+		 SEE ALSO: - afc_line_reader_close()
+@endnode
+*/
+int afc_line_reader_clear(LineReader *lr)
+{
+	if (lr == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (lr->magic != AFC_LINE_READER_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	afc_line_reader_close(lr);
+
+	if (lr->buf)
+		afc_free(lr->buf);
+
+	lr->buf = NULL;
+	lr->buf_size = 0;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_line_reader_open ( lr, file_name )
+/*
+@node afc_line_reader_open
+
+			 NAME: afc_line_reader_open ( lr, file_name )  - Opens a file to be read
+
+		 SYNOPSIS: int afc_line_reader_open ( LineReader * lr, const char * file_name )
+
+	  DESCRIPTION: This function opens a file to be read one line at a time with afc_line_reader_next().
+				   If another file was open, it is closed first.
+
+			INPUT: - lr          - Pointer to a valid LineReader instance.
+				   - file_name   - Name of the file to read. It does not need to be a regular file.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_LINE_READER_ERR_OPEN if the file cannot be opened.
+
+		 SEE ALSO: - afc_line_reader_open_chunk()
+				   - afc_line_reader_next()
+				   - afc_line_reader_close()
+@endnode
+*/
+int afc_line_reader_open(LineReader *lr, const char *file_name)
+{
+	return (afc_line_reader_open_chunk(lr, file_name, 0, 1));
+}
+// }}}
+// {{{ afc_line_reader_open_chunk ( lr, file_name, chunk, chunks )
+/*
+@node afc_line_reader_open_chunk
+
+			 NAME: afc_line_reader_open_chunk ( lr, file_name, chunk, chunks )  - Opens a part of a file to be read
+
+		 SYNOPSIS: int afc_line_reader_open_chunk ( LineReader * lr, const char * file_name, int chunk, int chunks )
+
+	  DESCRIPTION: This function splits the file in /chunks/ parts of about the same size and opens the part
+				   number /chunk/ to be read with afc_line_reader_next(). The parts start and end on line
+				   boundaries: a line belongs to the part where its first byte is, so reading all the parts
+				   returns every line of the file exactly once.
+
+				   This is the way to process a big file with many threads: every thread creates its own
+				   LineReader and opens a different chunk of the same file.
+
+			INPUT: - lr          - Pointer to a valid LineReader instance.
+				   - file_name   - Name of the file to read. It must be a regular file if /chunks/ is greater than 1.
+				   - chunk       - The part to read, from 0 to /chunks/ - 1.
+				   - chunks      - Number of parts the file is split in.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_LINE_READER_ERR_OPEN if the file cannot be opened.
+				   - AFC_LINE_READER_ERR_INVALID_CHUNK if /chunk/ is not valid, or if the file is not a regular file.
+
+			NOTES: - A part can be empty, if the file is small or it has very long lines.
+				   - afc_line_reader_line_num() counts the lines of the part, not of the whole file.
+
+		 SEE ALSO: - afc_line_reader_open()
+				   - afc_line_reader_next()
+@endnode
+*/
+int afc_line_reader_open_chunk(LineReader *lr, const char *file_name, int chunk, int chunks)
+{
+	struct stat st;
+	void *map;
+
+	if ((lr == NULL) || (file_name == NULL))
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (lr->magic != AFC_LINE_READER_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if ((chunks < 1) || (chunk < 0) || (chunk >= chunks))
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_LINE_READER_ERR_INVALID_CHUNK, "Invalid chunk", file_name));
+
+	afc_line_reader_close(lr);
+
+	if ((lr->fd = open(file_name, O_RDONLY)) < 0)
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_LINE_READER_ERR_OPEN, strerror(errno), file_name));
+
+	if (fstat(lr->fd, &st) != 0)
+	{
+		afc_line_reader_close(lr);
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_LINE_READER_ERR_OPEN, strerror(errno), file_name));
+	}
+
+	lr->is_regular = S_ISREG(st.st_mode);
+	lr->file_size = lr->is_regular ? st.st_size : 0;
+
+	if ((chunks > 1) && (!lr->is_regular))
+	{
+		afc_line_reader_close(lr);
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_LINE_READER_ERR_INVALID_CHUNK, "Only regular files can be split", file_name));
+	}
+
+	// Mapping fails on some file systems: the file is then read in blocks
+	if (lr->is_regular && lr->use_mmap && (lr->file_size > 0))
+	{
+		if ((map = mmap(NULL, (size_t)lr->file_size, PROT_READ, MAP_PRIVATE, lr->fd, 0)) != MAP_FAILED)
+		{
+			lr->map = (char *)map;
+			lr->map_size = (size_t)lr->file_size;
+			madvise(map, lr->map_size, MADV_SEQUENTIAL);
+		}
+	}
+
+	if ((lr->map == NULL) && (lr->buf_size != lr->block_size))
+	{
+		if (lr->buf)
+			afc_free(lr->buf);
+
+		if ((lr->buf = afc_malloc_uninit(lr->block_size)) == NULL)
+		{
+			lr->buf_size = 0;
+			afc_line_reader_close(lr);
+			return (AFC_LOG_FAST_INFO(AFC_ERR_NO_MEMORY, "buf"));
+		}
+		lr->buf_size = lr->block_size;
+	}
+
+	if (chunks > 1)
+	{
+		lr->start = afc_line_reader_internal_line_start(lr, lr->file_size / chunks * chunk);
+		lr->stop = afc_line_reader_internal_line_start(lr, (chunk == chunks - 1) ? lr->file_size : lr->file_size / chunks * (chunk + 1));
+	}
+	else
+	{
+		lr->start = 0;
+		lr->stop = -1;
+	}
+
+	if (lr->map)
+	{
+		lr->pos = lr->map + lr->start;
+		lr->end = lr->map + ((lr->stop < 0) ? lr->file_size : lr->stop);
+		lr->eof = TRUE;
+	}
+	else
+	{
+		lr->pos = lr->end = lr->buf;
+		lr->offset = lr->start;
+		lr->eof = FALSE;
+	}
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_line_reader_close ( lr )
+/*
+@node afc_line_reader_close
+
+			 NAME: afc_line_reader_close ( lr )  - Closes the file being read
+
+		 SYNOPSIS: int afc_line_reader_close ( LineReader * lr )
+
+	  DESCRIPTION: This function closes the file being read. All the views returned by afc_line_reader_next()
+				   are no longer valid after this call.
+
+			INPUT: - lr  - Pointer to a valid LineReader instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+			NOTES: - The block buffer is kept, to be used by the next file. afc_line_reader_clear() frees it.
+
+		 SEE ALSO: - afc_line_reader_open()
+				   - afc_line_reader_clear()
+@endnode
+*/
+int afc_line_reader_close(LineReader *lr)
+{
+	if (lr == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (lr->magic != AFC_LINE_READER_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (lr->map)
+		munmap(lr->map, lr->map_size);
+
+	if (lr->fd >= 0)
+		close(lr->fd);
+
+	lr->fd = -1;
+	lr->map = NULL;
+	lr->map_size = 0;
+	lr->file_size = 0;
+	lr->pos = lr->end = NULL;
+	lr->start = lr->offset = 0;
+	lr->stop = -1;
+	lr->line_num = 0;
+	lr->eof = TRUE;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_line_reader_next ( lr, line )
+/*
+@node afc_line_reader_next
+
+			 NAME: afc_line_reader_next ( lr, line )  - Reads the next line
+
+		 SYNOPSIS: int afc_line_reader_next ( LineReader * lr, afc_strview * line )
+
+	  DESCRIPTION: This function reads the next line of the file (or of the chunk) and sets /line/ to a view
+				   on it. The line terminator ("\n" or "\r\n") is not part of the view. The last line of the
+				   file is returned even if it does not end with a line terminator.
+
+				   Newlines are searched with memchr(), that scans many bytes at a time.
+
+			INPUT: - lr    - Pointer to a valid LineReader instance.
+				   - line  - Pointer to the view that will be set to the line read.
+
+		  RESULTS: - TRUE if a line has been read.
+				   - FALSE at the end of the file (or chunk), or in case of errors.
+
+			NOTES: - The view is not NUL terminated: use afc_string_copy_view() or afc_string_dup_view() to make
+					 an AFC String from it.
+				   - When the file is mapped in memory, views stay valid until the file is closed. When the file
+					 is read in blocks, a view is valid only until the next call to afc_line_reader_next().
+
+		 SEE ALSO: - afc_line_reader_open()
+				   - afc_line_reader_line_num()
+@endnode
+*/
+int afc_line_reader_next(LineReader *lr, afc_strview *line)
+{
+	const char *nl;
+	size_t len;
+
+	if ((lr == NULL) || (line == NULL) || (lr->magic != AFC_LINE_READER_MAGIC))
+		return (FALSE);
+
+	if (lr->fd < 0)
+		return (FALSE);
+
+	for (;;)
+	{
+		if ((nl = memchr(lr->pos, '\n', lr->end - lr->pos)) != NULL)
+		{
+			len = nl - lr->pos;
+			if (len && (nl[-1] == '\r'))
+				len--;
+
+			*line = afc_strview_make(lr->pos, len);
+			lr->pos = nl + 1;
+			lr->line_num++;
+
+			return (TRUE);
+		}
+
+		if (lr->eof)
+			break;
+
+		if (afc_line_reader_internal_fill(lr) != AFC_ERR_NO_ERROR)
+			return (FALSE);
+	}
+
+	// Last line, without line terminator
+	if (lr->pos < lr->end)
+	{
+		*line = afc_strview_make(lr->pos, lr->end - lr->pos);
+		lr->pos = lr->end;
+		lr->line_num++;
+
+		return (TRUE);
+	}
+
+	return (FALSE);
+}
+// }}}
+// {{{ afc_line_reader_set_tags ( lr, first_tag, ... )
+/*
+@node afc_line_reader_set_tags
+
+			 NAME: afc_line_reader_set_tags ( lr, first_tag, ... )  - Sets LineReader tags
+
+		 SYNOPSIS: int afc_line_reader_set_tags ( LineReader * lr, int first_tag, ... )
+
+	  DESCRIPTION: This function sets a list of tags in the current LineReader. For a list of valid tags, please
+				   see afc_line_reader_set_tag() function.
+
+			INPUT: - lr         - Pointer to a valid LineReader instance.
+				   - first_tag  - First tag to be set
+				   - ...        - Tags and values to be set
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - An error code in case of error
+
+			NOTES: - Remember to end the tag list with AFC_TAG_END
+
+		 SEE ALSO: - afc_line_reader_set_tag()
+@endnode
+*/
+int _afc_line_reader_set_tags(LineReader *lr, int first_tag, ...)
+{
+	va_list args;
+	unsigned int tag;
+	void *val;
+	int res;
+
+	va_start(args, first_tag);
+
+	tag = first_tag;
+
+	while (tag != AFC_TAG_END)
+	{
+		val = va_arg(args, void *);
+
+		if ((res = afc_line_reader_set_tag(lr, tag, val)) != AFC_ERR_NO_ERROR)
+		{
+			va_end(args);
+			return (res);
+		}
+
+		tag = va_arg(args, int);
+	}
+
+	va_end(args);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_line_reader_set_tag ( lr, tag, val )
+/*
+@node afc_line_reader_set_tag
+
+			 NAME: afc_line_reader_set_tag ( lr, tag, val )  - Sets a LineReader tag
+
+		 SYNOPSIS: int afc_line_reader_set_tag ( LineReader * lr, int tag, void * val )
+
+	  DESCRIPTION: This function sets a tag in the current LineReader. Tags are used by the next
+				   afc_line_reader_open() call.
+
+			INPUT: - lr     - Pointer to a valid LineReader instance.
+				   - tag    - Tag to be set. Valid tags are:
+						+ AFC_LINE_READER_TAG_BLOCK_SIZE - Size (in bytes) of the blocks read from files that are
+							not mapped in memory. Default is AFC_LINE_READER_DEFAULT_BLOCK_SIZE. The buffer grows
+							if a line does not fit in it.
+
+						+ AFC_LINE_READER_TAG_USE_MMAP - Defines whether regular files are mapped in memory.
+							Valid values are:
+
+							* TRUE - Regular files are mapped in memory (default)
+							* FALSE - Files are always read in blocks
+
+				   - val    - Value to set to the tag
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_ERR_UNSUPPORTED_TAG if the tag is not known.
+
+		 SEE ALSO: - afc_line_reader_set_tags()
+@endnode
+*/
+int afc_line_reader_set_tag(LineReader *lr, int tag, void *val)
+{
+	if (lr == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (lr->magic != AFC_LINE_READER_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	switch (tag)
+	{
+	case AFC_LINE_READER_TAG_BLOCK_SIZE:
+		lr->block_size = (size_t)(long)val;
+		if (lr->block_size < 16)
+			lr->block_size = 16;
+		break;
+
+	case AFC_LINE_READER_TAG_USE_MMAP:
+		lr->use_mmap = (BOOL)(long)val;
+		break;
+
+	default:
+		return (AFC_LOG_FAST(AFC_ERR_UNSUPPORTED_TAG));
+	}
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+
+/* =====================================================================================
+	 INTERNAL FUNCTIONS
+===================================================================================== */
+// {{{ afc_line_reader_internal_fill ( lr )
+/* Reads the next block of the file, keeping the part of line still to be returned at the start of the buffer */
+static int afc_line_reader_internal_fill(LineReader *lr)
+{
+	size_t rest = lr->end - lr->pos;
+	size_t want;
+	ssize_t got;
+	char *buf;
+
+	if (rest)
+		memmove(lr->buf, lr->pos, rest);
+
+	// The line does not fit in the buffer
+	if (rest == lr->buf_size)
+	{
+		if ((buf = afc_realloc(lr->buf, lr->buf_size * 2)) == NULL)
+			return (AFC_LOG_FAST_INFO(AFC_ERR_NO_MEMORY, "buf"));
+
+		lr->buf = buf;
+		lr->buf_size *= 2;
+	}
+
+	want = lr->buf_size - rest;
+	if ((lr->stop >= 0) && ((off_t)want > lr->stop - lr->offset))
+		want = (size_t)(lr->stop - lr->offset);
+
+	got = 0;
+	if (want)
+	{
+		if (lr->is_regular)
+			got = afc_line_reader_internal_pread(lr, lr->buf + rest, want, lr->offset);
+		else
+		{
+			do
+				got = read(lr->fd, lr->buf + rest, want);
+			while ((got < 0) && (errno == EINTR));
+		}
+
+		if (got < 0)
+		{
+			lr->eof = TRUE;
+			lr->pos = lr->end = lr->buf;
+			return (AFC_LOG(AFC_LOG_ERROR, AFC_LINE_READER_ERR_READ, strerror(errno), NULL));
+		}
+	}
+
+	lr->offset += got;
+	lr->pos = lr->buf;
+	lr->end = lr->buf + rest + got;
+
+	if ((got == 0) || ((lr->stop >= 0) && (lr->offset >= lr->stop)))
+		lr->eof = TRUE;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_line_reader_internal_line_start ( lr, offset )
+/* Returns the offset of the first line that starts at /offset/ or after it */
+static off_t afc_line_reader_internal_line_start(LineReader *lr, off_t offset)
+{
+	const char *nl;
+	ssize_t got;
+
+	if (offset <= 0)
+		return (0);
+	if (offset >= lr->file_size)
+		return (lr->file_size);
+
+	// A line starts at /offset/ if the char before it is a newline
+	offset--;
+
+	if (lr->map)
+	{
+		nl = memchr(lr->map + offset, '\n', lr->file_size - offset);
+		return (nl ? (nl - lr->map) + 1 : lr->file_size);
+	}
+
+	while ((got = afc_line_reader_internal_pread(lr, lr->buf, lr->buf_size, offset)) > 0)
+	{
+		if ((nl = memchr(lr->buf, '\n', got)) != NULL)
+			return (offset + (nl - lr->buf) + 1);
+
+		offset += got;
+	}
+
+	return (lr->file_size);
+}
+// }}}
+// {{{ afc_line_reader_internal_pread ( lr, buf, size, offset )
+static ssize_t afc_line_reader_internal_pread(LineReader *lr, char *buf, size_t size, off_t offset)
+{
+	ssize_t got;
+
+	do
+		got = pread(lr->fd, buf, size, offset);
+	while ((got < 0) && (errno == EINTR));
+
+	return (got);
+}
+// }}}
@@ -0,0 +1,114 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef AFC_LINE_READER_H
+#define AFC_LINE_READER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "base.h"
+#include "exceptions.h"
+#include "string.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* AFC LineReader Magic Number: 'LNRD' */
+#define AFC_LINE_READER_MAGIC ('L' << 24 | 'N' << 16 | 'R' << 8 | 'D')
+
+/* AFC LineReader Base value for constants */
+#define AFC_LINE_READER_BASE 0xE100
+
+/* Default size (in bytes) of the blocks read when the file is not mapped in memory */
+#define AFC_LINE_READER_DEFAULT_BLOCK_SIZE (256 * 1024)
+
+	enum
+	{
+		AFC_LINE_READER_ERR_OPEN = AFC_LINE_READER_BASE + 1, /* The file cannot be opened */
+		AFC_LINE_READER_ERR_READ,							 /* Error reading the file */
+		AFC_LINE_READER_ERR_INVALID_CHUNK,					 /* Invalid chunk number, or the file cannot be split */
+		AFC_LINE_READER_ERR_NOT_OPEN						 /* No file is open */
+	};
+
+	/* Tags for LineReader */
+	enum
+	{
+		AFC_LINE_READER_TAG_BLOCK_SIZE = AFC_LINE_READER_BASE + 1, /* Size (in bytes) of the blocks read from the file */
+		AFC_LINE_READER_TAG_USE_MMAP							   /* Flag T/F. If TRUE (default), regular files are mapped in memory */
+	};
+
+	struct afc_line_reader
+	{
+		unsigned long magic;
+
+		int fd;				// -1 if no file is open
+		off_t file_size;	// Size of the file (regular files only)
+		BOOL is_regular;	// TRUE if the file is a regular file (it can be mapped and split)
+
+		char *map;		 // The mapped file, or NULL if the file is read in blocks
+		size_t map_size; // Size of the mapping
+
+		char *buf;		 // Block buffer (not mapped files only)
+		size_t buf_size; // Size of /buf/
+		off_t offset;	 // File offset of the next byte to read in /buf/
+
+		const char *pos; // Next char to examine
+		const char *end; // End of the data available (in /map/ or /buf/)
+
+		off_t start; // File offset of the first byte of the chunk being read
+		off_t stop;	 // File offset of the end of the chunk (-1 up to the end of the file)
+
+		unsigned long line_num; // Number of lines read so far
+		BOOL eof;				// TRUE when all the data has been read into /buf/
+
+		size_t block_size; // Size of the blocks read from the file
+		BOOL use_mmap;	   // If TRUE, regular files are mapped in memory
+	};
+
+	typedef struct afc_line_reader LineReader;
+
+#define afc_line_reader_delete(lr)   \
+	if (lr)                          \
+	{                                \
+		_afc_line_reader_delete(lr); \
+		lr = NULL;                   \
+	}
+
+	LineReader *afc_line_reader_new(void);
+	int _afc_line_reader_delete(LineReader *lr);
+	int afc_line_reader_clear(LineReader *lr);
+	int afc_line_reader_open(LineReader *lr, const char *file_name);
+	int afc_line_reader_open_chunk(LineReader *lr, const char *file_name, int chunk, int chunks);
+	int afc_line_reader_close(LineReader *lr);
+	int afc_line_reader_next(LineReader *lr, afc_strview *line);
+#define afc_line_reader_set_tags(lr, first, ...) _afc_line_reader_set_tags(lr, first, ##__VA_ARGS__, AFC_TAG_END)
+	int _afc_line_reader_set_tags(LineReader *lr, int first_tag, ...);
+	int afc_line_reader_set_tag(LineReader *lr, int tag, void *val);
+
+#define afc_line_reader_line_num(lr) (lr ? (lr)->line_num : 0)
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
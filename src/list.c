@@ -23,7 +23,7 @@
 /*
 @config
 	TITLE:     List
-	VERSION:   4.20
+	VERSION:   4.36
 	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
 	AUTHOR:    Massimo Tantignone - tanti@intercom.it
 @endnode
@@ -35,6 +35,13 @@
 @endnode
 
 @node history
+	- 4.36	- struct Node and struct List are marked may_alias: IsListEmpty() is reliable at -O2.
+	- 4.35	- afc_list_del() returns NULL after deleting the last node of an Arena List.
+	- 4.34	- Added afc_list_set_index() function.
+	- 4.33	- Added afc_list_set_unrolled() function. afc_list_pop() restores the ordinal position too.
+	- 4.32	- Big lists are sorted with afc_parallel_sort_r()
+	- 4.31	- Nodes are allocated with afc_pool_alloc()
+	- 4.30	- Added afc_list_set_arena() function.
 	- 4.20	- Added afc_list_before_first() function.
 @endnode
 
@@ -45,6 +52,13 @@ Like all AFC classes, you can instance a new  List by calling afc_list_new (), a
 
 To add elements to the array, use afc_list_add (); to delete all elements call
 afc_list_clear(), and to delete just one of them there is afc_list_del() .
+
+By default every item is linked in its own node. Call afc_list_set_unrolled() on an empty List to store the items in
+chunks of AFC_LIST_CHUNK_ITEMS pointers instead: iterations touch far less memory and afc_list_item() skips whole
+chunks, while the cursor methods keep working the same way.
+
+afc_list_set_index() keeps an ordinal index of the items, updated by every afc_list_add() and afc_list_del(): with it,
+afc_list_item() takes O(log n) steps on lists of both kinds, even when items are added and deleted between the calls.
 @endnode
 */
 // }}}
@@ -54,10 +68,40 @@ afc_list_clear(), and to delete just one of them there is afc_list_del() .
 static const char class_name[] = "List";
 
 static void afc_list_internal_init_list(List *nm);
+static void afc_list_internal_node_free(List *nm, struct Node *node);
 static void afc_list_internal_split(List *nm, unsigned long inf, unsigned long sup, signed long *mid, signed long (*comp)(void *, void *, void *), void *info);
 static void afc_list_internal_fast_split(List *nm, unsigned long inf, unsigned long sup, signed long *mid, signed long (*comp)(void *, void *, void *), void *info);
 static void afc_list_internal_quick_sort(List *nm, unsigned long inf, unsigned long sup, signed long (*comp)(void *, void *, void *), void *info);
 static void afc_list_internal_fast_quick_sort(List *nm, unsigned long inf, unsigned long sup, signed long (*comp)(void *, void *, void *), void *info);
+static int afc_list_internal_parallel_sort(List *nm, signed long (*comp)(void *, void *, void *), void *info);
+static int afc_list_internal_parallel_comp(const void *a, const void *b, void *info);
+static char **afc_list_internal_get_items(List *nm);
+static void afc_list_internal_set_items(List *nm, char **mem);
+static struct afc_list_chunk *afc_list_internal_chunk_alloc(List *nm);
+static void afc_list_internal_chunk_link(List *nm, struct afc_list_chunk *c, struct afc_list_chunk *after);
+static void afc_list_internal_chunk_unlink(List *nm, struct afc_list_chunk *c);
+static void *afc_list_internal_chunk_add(List *nm, void *s, unsigned long mode);
+static void *afc_list_internal_chunk_insert(List *nm, struct afc_list_chunk *c, unsigned int idx, unsigned long at, void *s);
+static void *afc_list_internal_chunk_del(List *nm);
+static void *afc_list_internal_chunk_item(List *nm, unsigned long n);
+static void *afc_list_internal_chunk_seek(List *nm, struct afc_list_chunk *c, unsigned long start, unsigned long n);
+static void afc_list_internal_chunk_clear(List *nm);
+static void afc_list_internal_stack_shift(List *nm, unsigned long at, BOOL inserted);
+static void afc_list_internal_index_insert(List *nm, unsigned long r, void *unit, unsigned long weight);
+static void afc_list_internal_index_remove(List *nm, unsigned long r);
+static void afc_list_internal_index_add(List *nm, unsigned long r, long delta);
+static void *afc_list_internal_index_find(List *nm, unsigned long r, unsigned long *start);
+static void afc_list_internal_index_free(struct afc_list_index_node *t);
+static struct afc_list_index_node *afc_list_internal_index_merge(struct afc_list_index_node *a, struct afc_list_index_node *b);
+static void afc_list_internal_index_split(struct afc_list_index_node *t, unsigned long r, struct afc_list_index_node **a, struct afc_list_index_node **b);
+static struct afc_list_index_node *afc_list_internal_index_put(struct afc_list_index_node *t, unsigned long r, struct afc_list_index_node *n);
+static struct afc_list_index_node *afc_list_internal_index_erase(struct afc_list_index_node *t, unsigned long r, struct afc_list_index_node **removed);
+
+struct afc_list_internal_sort_info
+{
+	signed long (*comp)(void *, void *, void *);
+	void *info;
+};
 // static int afc_list_internal_ultra_comp ( List * nm, const void * s1, const void * s2 );
 
 // {{{ list handling functions
@@ -242,7 +286,16 @@ void *afc_list_add(List *nm, void *s, unsigned long mode)
 {
 	struct Node *nn;
 
-	nn = (struct Node *)afc_malloc(sizeof(struct Node));
+	if (nm->unrolled)
+		return (afc_list_internal_chunk_add(nm, s, mode));
+
+	if (nm->arena == NULL)
+		nn = (struct Node *)afc_pool_alloc(sizeof(struct Node));
+	else if ((nn = nm->free_nodes) != NULL)
+		nm->free_nodes = nn->ln_Succ;
+	else
+		nn = (struct Node *)afc_arena_alloc(nm->arena, sizeof(struct Node));
+
 	if (nn == NULL)
 		return (NULL);
 	nn->ln_Succ = nn->ln_Pred = NULL;
@@ -276,6 +329,9 @@ void *afc_list_add(List *nm, void *s, unsigned long mode)
 		break;
 	} /* End switch() */
 
+	afc_list_internal_stack_shift(nm, nm->npos, TRUE);
+	afc_list_internal_index_insert(nm, nm->npos, nn, 1);
+
 	nm->is_sorted = FALSE;
 	nm->is_array_valid = FALSE;
 
@@ -304,6 +360,9 @@ void *afc_list_add(List *nm, void *s, unsigned long mode)
 */
 short afc_list_is_empty(List *nm)
 {
+	if (nm->unrolled)
+		return (nm->num == 0);
+
 	return (IsListEmpty(nm->lst));
 }
 // }}}
@@ -328,6 +387,9 @@ void *afc_list_first(List *nm)
 {
 	nm->before_first = FALSE;
 
+	if (nm->unrolled)
+		return ((nm->num == 0) ? NULL : afc_list_internal_chunk_seek(nm, nm->first_chunk, 0, 0));
+
 	return (IsListEmpty(nm->lst) ? NULL : (nm->npos = 0, (nm->pos = nm->lst->lh_Head))->ln_Name);
 }
 // }}}
@@ -345,11 +407,16 @@ void *afc_list_first(List *nm)
 
 	RESULTS: the current list node, or NULL if the list is empty.
 
+		NOTES: - An unrolled List has no nodes: this method always returns NULL.
+
 			 SEE ALSO: - afc_list_addr()
 @endnode
 */
 struct Node *afc_list_get(List *nm)
 {
+	if (nm->unrolled)
+		return (NULL);
+
 	return (nm->pos);
 }
 // }}}
@@ -367,6 +434,8 @@ struct Node *afc_list_get(List *nm)
 
 	RESULTS: the List List address.
 
+		NOTES: - The items of an unrolled List are not linked to this list, which is always empty.
+
 			 SEE ALSO: - afc_list_get()
 @endnode
 */
@@ -399,9 +468,10 @@ short afc_list_push(List *nm)
 {
 	short result = FALSE;
 
-	if (nm->pos && (nm->sposcount < 8))
+	if (nm->unrolled ? (nm->num && (nm->sposcount < 8)) : (nm->pos && (nm->sposcount < 8)))
 	{
 		result = TRUE;
+		nm->sidx[nm->sposcount] = nm->npos;
 		nm->spos[nm->sposcount++] = nm->pos;
 	}
 
@@ -442,7 +512,11 @@ void *afc_list_pop(List *nm, short autopos)
 	{
 		if (autopos)
 		{
-			return ((nm->pos = nm->spos[--nm->sposcount])->ln_Name);
+			if (nm->unrolled)
+				return (afc_list_internal_chunk_item(nm, nm->sidx[--nm->sposcount]));
+
+			nm->npos = nm->sidx[--nm->sposcount];
+			return ((nm->pos = nm->spos[nm->sposcount])->ln_Name);
 		}
 		else
 		{
@@ -475,6 +549,9 @@ void *afc_list_pop(List *nm, short autopos)
 */
 void *afc_list_obj(List *nm)
 {
+	if (nm->unrolled)
+		return ((nm->num == 0) ? NULL : nm->chunk->items[nm->chunk_pos]);
+
 	return ((IsListEmpty(nm->lst) || !nm->pos) ? NULL : (nm->pos->ln_Name));
 }
 // }}}
@@ -507,6 +584,9 @@ void *afc_list_del(List *nm)
 	struct Node *n = NULL;
 	unsigned char t, i;
 
+	if (nm->unrolled)
+		return (afc_list_internal_chunk_del(nm));
+
 	if (IsListEmpty(nm->lst))
 		return (NULL);
 
@@ -520,13 +600,19 @@ void *afc_list_del(List *nm)
 			if (nm->spos[t] == nm->pos)
 			{
 				for (i = t; i < nm->sposcount - 1; i++)
+				{
 					nm->spos[i] = nm->spos[i + 1];
+					nm->sidx[i] = nm->sidx[i + 1];
+				}
 
 				nm->spos[--nm->sposcount] = NULL;
 				break;
 			}
 		}
 
+		afc_list_internal_stack_shift(nm, nm->npos, FALSE);
+		afc_list_internal_index_remove(nm, nm->npos);
+
 		if (nm->pos != nm->lst->lh_TailPred)
 			n = nm->pos->ln_Succ;
 		else
@@ -537,7 +623,7 @@ void *afc_list_del(List *nm)
 
 		Remove(nm->pos);
 
-		afc_free(nm->pos);
+		afc_list_internal_node_free(nm, nm->pos);
 		nm->pos = n;
 		nm->num--;
 	}
@@ -598,6 +684,9 @@ void afc_list_clear_stack(List *nm)
 */
 void *afc_list_last(List *nm)
 {
+	if (nm->unrolled)
+		return ((nm->num == 0) ? NULL : afc_list_internal_chunk_seek(nm, nm->last_chunk, nm->num - nm->last_chunk->count, nm->num - 1));
+
 	return (IsListEmpty(nm->lst) ? NULL : (nm->npos = nm->num - 1, (nm->pos = nm->lst->lh_TailPred)->ln_Name));
 }
 // }}}
@@ -623,6 +712,26 @@ void *afc_list_next(List *nm)
 {
 	if (nm->before_first)
 		return (afc_list_first(nm));
+
+	if (nm->unrolled)
+	{
+		if (nm->num == 0)
+			return (NULL);
+
+		if (nm->chunk_pos + 1 < nm->chunk->count)
+			nm->chunk_pos++;
+		else if (nm->chunk->next)
+		{
+			nm->chunk = nm->chunk->next;
+			nm->chunk_pos = 0;
+		}
+		else
+			return (NULL);
+
+		nm->npos++;
+		return (nm->chunk->items[nm->chunk_pos]);
+	}
+
 	if (IsListEmpty(nm->lst))
 		return (NULL);
 
@@ -650,6 +759,25 @@ void *afc_list_next(List *nm)
 */
 void *afc_list_prev(List *nm)
 {
+	if (nm->unrolled)
+	{
+		if (nm->num == 0)
+			return (NULL);
+
+		if (nm->chunk_pos > 0)
+			nm->chunk_pos--;
+		else if (nm->chunk->prev)
+		{
+			nm->chunk = nm->chunk->prev;
+			nm->chunk_pos = nm->chunk->count - 1;
+		}
+		else
+			return (NULL);
+
+		nm->npos--;
+		return (nm->chunk->items[nm->chunk_pos]);
+	}
+
 	if (IsListEmpty(nm->lst))
 		return (NULL);
 
@@ -711,18 +839,38 @@ int afc_list_clear(List *nm)
 
 	nm->is_sorted = FALSE;
 
+	// Nodes of the Arena are not reused after a clear: the Arena may be reset right after it
+	nm->free_nodes = NULL;
+	nm->free_chunks = NULL;
+
+	if (nm->unrolled)
+	{
+		afc_list_internal_chunk_clear(nm);
+		afc_list_internal_init_list(nm);
+		afc_list_free_array(nm);
+
+		return (AFC_ERR_NO_ERROR);
+	}
+
 	if (IsListEmpty(nm->lst))
 		return (AFC_ERR_NO_ERROR);
 
 	w = nm->lst->lh_Head;
 
-	while ((n = w->ln_Succ))
+	// Arena nodes do not need to be freed one by one
+	if ((nm->arena == NULL) || (nm->func_clear != NULL))
 	{
-		if (nm->func_clear)
-			nm->func_clear(w->ln_Name);
-		Remove(w);
-		afc_free(w);
-		w = n;
+		while ((n = w->ln_Succ))
+		{
+			if (nm->func_clear)
+				nm->func_clear(w->ln_Name);
+			if (nm->arena == NULL)
+			{
+				Remove(w);
+				afc_pool_free(w, sizeof(struct Node));
+			}
+			w = n;
+		}
 	}
 
 	afc_list_internal_init_list(nm);
@@ -769,6 +917,8 @@ int afc_list_clear(List *nm)
 		NOTES: From v4.00 it can take advantages of the array rappresentation of the
 		 list to speed up item positioning. Please, see afc_list_create_array()
 		 for more info.
+		 An unrolled List skips whole chunks, starting from the first, the current or the last item.
+		 An indexed List (see afc_list_set_index()) finds the item in O(log n) steps.
 
 			 SEE ALSO: - afc_list_len()
 		 - afc_list_create_array()
@@ -779,6 +929,9 @@ void *afc_list_item(List *nm, unsigned long n)
 	unsigned long t, s;
 	struct Node *node;
 
+	if (nm->unrolled)
+		return (afc_list_internal_chunk_item(nm, n));
+
 	if (IsListEmpty(nm->lst))
 		return (NULL);
 
@@ -793,6 +946,15 @@ void *afc_list_item(List *nm, unsigned long n)
 		return (node->ln_Name);
 	}
 
+	if (nm->index != NULL)
+	{
+		if (n >= nm->num)
+			n = nm->num - 1;
+		nm->pos = (struct Node *)afc_list_internal_index_find(nm, n, &s);
+		nm->npos = n;
+		return (nm->pos->ln_Name);
+	}
+
 	if (n != nm->npos)
 	{
 
@@ -849,6 +1011,9 @@ void *afc_list_change(List *nm, void *s)
 {
 	nm->is_sorted = FALSE;
 
+	if (nm->unrolled)
+		return ((nm->num == 0) ? NULL : (nm->chunk->items[nm->chunk_pos] = s));
+
 	return (nm->pos ? (nm->pos->ln_Name = (char *)s) : NULL);
 }
 // }}}
@@ -869,6 +1034,8 @@ void *afc_list_change(List *nm, void *s)
 		 node as parameter could get to instability.
 		 This command is designed only for "professional" user who
 		 intend build new object inheriting this one.
+		 An unrolled List has no nodes: this command does nothing and returns NULL.
+		 On an indexed List, the ordinal position of the node is counted too, in O(n) steps.
 
 	RESULTS: the new node data or NULL if an error occurred.
 
@@ -878,6 +1045,16 @@ void *afc_list_change(List *nm, void *s)
 */
 void *afc_list_change_pos(List *nm, struct Node *node)
 {
+	struct Node *n;
+
+	if (nm->unrolled)
+		return (NULL);
+
+	// The index needs the ordinal position of the new node: it is counted walking back to the first one
+	if (nm->indexed && nm->pos && node)
+		for (nm->npos = 0, n = node; n->ln_Pred->ln_Pred; n = n->ln_Pred)
+			nm->npos++;
+
 	return (nm->pos ? ((nm->pos = node) ? nm->pos->ln_Name : NULL) : NULL);
 }
 // }}}
@@ -925,6 +1102,8 @@ unsigned long afc_list_pos(List * nm)
 		 value as parameter could get to instability.
 		 This command is designed only for "professional" user who
 		 intend build new object inheriting this one.
+		 Unrolled and indexed lists need the right ordinal number: on them, this command
+		 moves to the item /newnum/ instead, just like afc_list_item().
 
 	RESULTS: The current node ordinal number will be changed.
 
@@ -933,6 +1112,13 @@ unsigned long afc_list_pos(List * nm)
 */
 void afc_list_change_numerical_pos(List *nm, unsigned long newnum)
 {
+	// Unrolled and indexed lists find their items by their ordinal position: it must always be the right one
+	if (nm->unrolled || nm->indexed)
+	{
+		afc_list_item(nm, newnum);
+		return;
+	}
+
 	nm->npos = newnum;
 }
 // }}}
@@ -976,17 +1162,29 @@ void afc_list_change_numerical_pos(List *nm, unsigned long newnum)
 			 + Stack will be cleared.
 			 + Current item will be the first one.
 
+		 - Lists big enough are sorted by many threads at once with afc_parallel_sort_r(), so the
+			 comparison routine must not change any shared data.
+		 - Unrolled lists are always sorted with afc_parallel_sort_r(): if there is not enough
+			 memory for a copy of the items, the list is not changed and NULL is returned.
+
 			 SEE ALSO: - afc_list_create_array()
 @endnode
 */
 void *afc_list_sort(List *nm, signed long (*comp)(void *, void *, void *), void *info)
 {
-	if (IsListEmpty(nm->lst))
+	if (afc_list_is_empty(nm))
 		return (NULL);
 	if (nm->is_sorted)
 		return (afc_list_first(nm));
 
-	afc_list_internal_quick_sort(nm, 0, (nm->num - 1), comp, info);
+	// An unrolled List is always sorted with a copy of its items, in the calling thread too
+	if (nm->unrolled)
+	{
+		if (afc_list_internal_parallel_sort(nm, comp, info) != AFC_ERR_NO_ERROR)
+			return (NULL);
+	}
+	else if ((afc_parallel_sort_threads(nm->num) < 2) || (afc_list_internal_parallel_sort(nm, comp, info) != AFC_ERR_NO_ERROR))
+		afc_list_internal_quick_sort(nm, 0, (nm->num - 1), comp, info);
 	afc_list_clear_stack(nm);
 
 	nm->is_sorted = TRUE;
@@ -1014,6 +1212,9 @@ void *afc_list_sort(List *nm, signed long (*comp)(void *, void *, void *), void
 */
 short afc_list_is_last(List *nm)
 {
+	if (nm->unrolled)
+		return ((short)(nm->num && (nm->npos == nm->num - 1)));
+
 	return ((short)(nm->pos == nm->lst->lh_TailPred));
 }
 //  }}}
@@ -1037,6 +1238,9 @@ short afc_list_is_last(List *nm)
 */
 short afc_list_is_first(List *nm)
 {
+	if (nm->unrolled)
+		return ((short)(nm->num && (nm->npos == 0)));
+
 	return ((short)(nm->pos == nm->lst->lh_Head));
 }
 // }}}
@@ -1064,6 +1268,7 @@ short afc_list_is_first(List *nm)
 		 - for performance reasons, the array will *not* be kept aligned
 			 with the list data automatically. So, if you add/del
 			 some elements, you'll have to regenerate the array by yourself.
+		 - An unrolled List has no nodes: NULL is always returned.
 
 			 SEE ALSO: - afc_list_free_array()
 		 - afc_list_clear()
@@ -1076,13 +1281,14 @@ struct Node **afc_list_create_array(List *nm)
 
 	// unsigned long t=0;
 
-	if (afc_list_is_empty(nm))
+	// An unrolled List has no nodes, and afc_list_item() does not need them
+	if (nm->unrolled || afc_list_is_empty(nm))
 		return (NULL);
 
 	if (nm->array)
 		afc_free(nm->array);
 
-	nm->array = (struct Node **)afc_malloc((sizeof(struct Node *) * (nm->num + 1)));
+	nm->array = (struct Node **)afc_malloc_uninit((sizeof(struct Node *) * (nm->num + 1)));
 
 	p = nm->array;
 
@@ -1157,6 +1363,15 @@ List *afc_list_clone(List *nm)
 	List *nm_new = afc_list_new();
 	void *v;
 
+	if (nm_new == NULL)
+		return (NULL);
+
+	if (nm->unrolled)
+		afc_list_set_unrolled(nm_new, TRUE);
+
+	if (nm->indexed)
+		afc_list_set_index(nm_new, TRUE);
+
 	afc_list_push(nm);
 	v = afc_list_first(nm);
 	while (v)
@@ -1172,6 +1387,9 @@ List *afc_list_clone(List *nm)
 // {{{ void * afc_list_fast_sort(List * nm, signed long (*comp)(void *, void *, void *), void * info)
 void *afc_list_fast_sort(List *nm, signed long (*comp)(void *, void *, void *), void *info)
 {
+	if (nm->unrolled)
+		return (afc_list_sort(nm, comp, info));
+
 	if (IsListEmpty(nm->lst))
 		return (NULL);
 	if (nm->is_sorted)
@@ -1179,7 +1397,8 @@ void *afc_list_fast_sort(List *nm, signed long (*comp)(void *, void *, void *),
 
 	afc_list_create_array(nm);
 
-	afc_list_internal_fast_quick_sort(nm, 0, (nm->num - 1), comp, info);
+	if ((afc_parallel_sort_threads(nm->num) < 2) || (afc_list_internal_parallel_sort(nm, comp, info) != AFC_ERR_NO_ERROR))
+		afc_list_internal_fast_quick_sort(nm, 0, (nm->num - 1), comp, info);
 	afc_list_clear_stack(nm);
 
 	// afc_list_free_array(nm);
@@ -1192,34 +1411,18 @@ void *afc_list_fast_sort(List *nm, signed long (*comp)(void *, void *, void *),
 // {{{ void * afc_list_ultra_sort(List * nm, int (*comp)( const void *, const void * ) )
 void *afc_list_ultra_sort(List *nm, int (*comp)(const void *, const void *))
 {
-	char **mem = (char **)afc_malloc((sizeof(char **)) * (nm->num + 5));
-	int c = 0;
-	struct Node *n;
+	char **mem;
 
-	if (IsListEmpty(nm->lst))
+	if (afc_list_is_empty(nm))
 		return (NULL);
 	if (nm->is_sorted)
 		return (afc_list_first(nm));
-	if (mem == NULL)
+	if ((mem = afc_list_internal_get_items(nm)) == NULL)
 		return (NULL);
 
-	c = 0;
-	n = nm->lst->lh_Head;
-	while (n)
-	{
-		mem[c++] = (char *)n->ln_Name;
-		n = n->ln_Succ;
-	}
-
-	qsort(mem, nm->num, sizeof(char **), comp);
+	afc_parallel_sort(mem, nm->num, sizeof(char **), comp);
 
-	c = 0;
-	n = nm->lst->lh_Head;
-	while (n)
-	{
-		n->ln_Name = mem[c++];
-		n = n->ln_Succ;
-	}
+	afc_list_internal_set_items(nm, mem);
 
 	afc_free(mem);
 
@@ -1236,7 +1439,7 @@ long afc_list_for_each(List *nm, long (*funct)(List *nm, void *, void *), void *
 	void *data;
 	long result;
 
-	if (IsListEmpty(nm->lst))
+	if (afc_list_is_empty(nm))
 		return (AFC_ERR_NO_ERROR);
 
 	data = afc_list_first(nm);
@@ -1290,10 +1493,182 @@ int afc_list_before_first(List *nm)
 	return (AFC_ERR_NO_ERROR);
 }
 // }}}
+// {{{ afc_list_set_arena ( nm, arena )
+/*
+@node afc_list_set_arena
+
+		 NAME: afc_list_set_arena(nm, arena) - Binds the List to an Arena
+
+			 SYNOPSIS: int afc_list_set_arena ( List * nm, Arena * arena )
+
+		SINCE: 4.30
+
+		DESCRIPTION: Use this command to allocate the list nodes from an Arena instead of the system heap.
+		 Deleted nodes are reused by the next afc_list_add() calls, and afc_list_clear() does not need to
+		 free the nodes one by one (if no clear func is set, it takes constant time).
+
+		INPUT: - nm	- Pointer to a valid List class.
+		 - arena	- Pointer to a valid Arena instance, or NULL to go back to the system heap.
+
+	RESULTS: - AFC_ERR_NO_ERROR on success.
+		 - AFC_LIST_ERR_NOT_EMPTY if the List contains some items.
+
+		NOTES: - Data stored in the list is not touched: the Arena only holds the list nodes.
+		 - Clear (or delete) the List before resetting the Arena.
+
+			 SEE ALSO: - afc_arena_new()
+		 - afc_list_clear()
+@endnode
+*/
+int afc_list_set_arena(List *nm, Arena *arena)
+{
+	if (nm == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (nm->magic != AFC_LIST_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (!afc_list_is_empty(nm))
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_LIST_ERR_NOT_EMPTY, "Cannot change the Arena of a non empty List", NULL));
+
+	nm->arena = arena;
+	nm->free_nodes = NULL;
+	nm->free_chunks = NULL;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_list_set_unrolled ( nm, unrolled )
+/*
+@node afc_list_set_unrolled
+
+		 NAME: afc_list_set_unrolled(nm, unrolled) - Stores the List items in chunks
+
+			 SYNOPSIS: int afc_list_set_unrolled ( List * nm, BOOL unrolled )
+
+		SINCE: 4.33
+
+		DESCRIPTION: Use this command to store the items of the list in chunks of AFC_LIST_CHUNK_ITEMS pointers,
+		 instead of one node per item. Going from an item to the next one seldom leaves the chunk, so iterations
+		 are much faster on big lists, and afc_list_item() skips a whole chunk at every step.
+		 A chunk that gets full is split in two, and chunks left almost empty by afc_list_del() are merged.
+
+		INPUT: - nm	- Pointer to a valid List class.
+		 - unrolled	- TRUE to store the items in chunks, FALSE to go back to one node per item.
+
+	RESULTS: - AFC_ERR_NO_ERROR on success.
+		 - AFC_LIST_ERR_NOT_EMPTY if the List contains some items.
+
+		NOTES: - All the cursor methods (afc_list_first(), afc_list_next(), afc_list_add(), afc_list_del(),
+			 afc_list_push(), afc_list_pop(), ...) and the sorts work in the same way.
+		 - There are no nodes: afc_list_get(), afc_list_change_pos() and afc_list_create_array() return NULL.
+		 - Pushed positions are ordinal positions, kept right by afc_list_add() and afc_list_del().
+		 - If the List is bound to an Arena, the chunks are allocated from the Arena.
+
+			 SEE ALSO: - afc_list_item()
+		 - afc_list_set_arena()
+@endnode
+*/
+int afc_list_set_unrolled(List *nm, BOOL unrolled)
+{
+	if (nm == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+
+	if (nm->magic != AFC_LIST_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (!afc_list_is_empty(nm))
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_LIST_ERR_NOT_EMPTY, "Cannot change the storage of a non empty List", NULL));
+
+	afc_list_free_array(nm);
+	afc_list_internal_init_list(nm);
+	nm->unrolled = unrolled;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_list_set_index ( nm, indexed )
+/*
+@node afc_list_set_index
+
+		 NAME: afc_list_set_index(nm, indexed) - Keeps an ordinal index of the List items
+
+			 SYNOPSIS: int afc_list_set_index ( List * nm, BOOL indexed )
+
+		SINCE: 4.34
+
+		DESCRIPTION: Use this command to keep a balanced index of the items of the list, ordered by their position
+		 and updated by every afc_list_add() and afc_list_del(). With it, afc_list_item() and
+		 afc_list_change_numerical_pos() find any item in O(log n) steps, while adds and deletes take O(log n)
+		 steps more. Without the index, afc_list_item() walks the list from the current item, unless the array
+		 of afc_list_create_array() is still valid: after every add or del it is not, and it takes O(n) steps
+		 to create it again.
+
+		INPUT: - nm	- Pointer to a valid List class.
+		 - indexed	- TRUE to create the index, FALSE to free it.
+
+	RESULTS: - AFC_ERR_NO_ERROR on success.
+		 - AFC_ERR_NO_MEMORY if there is not enough memory for the index of the items already in the List.
+
+		NOTES: - The index can be created at any time: the items already in the List are added to it.
+		 - It works on unrolled lists too (see afc_list_set_unrolled()): there it indexes the chunks.
+		 - Every item takes a node of the index, allocated with afc_pool_alloc(). If an add cannot get it,
+			 the index is freed and the List goes on without it.
+
+			 SEE ALSO: - afc_list_item()
+		 - afc_list_set_unrolled()
+@endnode
+*/
+int afc_list_set_index(List *nm, BOOL indexed)
+{
+	struct afc_list_chunk *c;
+	struct Node *n;
+	unsigned long r;
+
+	if (nm == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+
+	if (nm->magic != AFC_LIST_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	afc_list_internal_index_free(nm->index);
+	nm->index = NULL;
+	nm->indexed = indexed;
+
+	if (!indexed)
+		return (AFC_ERR_NO_ERROR);
+
+	// Every unit is added after the ones already in the index
+	if (nm->unrolled)
+	{
+		for (r = 0, c = nm->first_chunk; c && nm->indexed; r += c->count, c = c->next)
+			afc_list_internal_index_insert(nm, r, c, c->count);
+	}
+	else
+	{
+		for (r = 0, n = nm->lst->lh_Head; n->ln_Succ && nm->indexed; r++, n = n->ln_Succ)
+			afc_list_internal_index_insert(nm, r, n, 1);
+	}
+
+	return (nm->indexed ? AFC_ERR_NO_ERROR : AFC_LOG_FAST(AFC_ERR_NO_MEMORY));
+}
+// }}}
 
 /* ===========================================================================
 	INTERNAL FUNCTIONS
 =========================================================================== */
+// {{{ afc_list_internal_node_free ( nm, node )
+static void afc_list_internal_node_free(List *nm, struct Node *node)
+{
+	if (nm->arena == NULL)
+	{
+		afc_pool_free(node, sizeof(struct Node));
+		return;
+	}
+
+	node->ln_Succ = nm->free_nodes;
+	nm->free_nodes = node;
+}
+// }}}
 // {{{ afc_list_internal_init_list ( nm )
 static void afc_list_internal_init_list(List *nm)
 {
@@ -1308,6 +1683,12 @@ static void afc_list_internal_init_list(List *nm)
 
 	nm->sposcount = 0;
 	nm->npos = -1; /* No Items!! */
+
+	nm->first_chunk = nm->last_chunk = nm->chunk = NULL;
+	nm->chunk_pos = 0;
+
+	afc_list_internal_index_free(nm->index);
+	nm->index = NULL;
 }
 // }}}
 // {{{ afc_list_internal_split ( nm, inf, sup, mid, comp )
@@ -1465,6 +1846,655 @@ static void afc_list_internal_fast_quick_sort(List *nm, unsigned long inf, unsig
 	}
 }
 
+// {{{ afc_list_internal_parallel_sort ( nm, comp, info )
+/* Sorts the items of the list with afc_parallel_sort_r(): the nodes (or chunks) stay where they are, only their data is moved */
+static int afc_list_internal_parallel_sort(List *nm, signed long (*comp)(void *, void *, void *), void *info)
+{
+	struct afc_list_internal_sort_info si;
+	char **mem;
+	int afc_res;
+
+	if ((mem = afc_list_internal_get_items(nm)) == NULL)
+		return (AFC_ERR_NO_MEMORY);
+
+	si.comp = comp;
+	si.info = info;
+
+	if ((afc_res = afc_parallel_sort_r(mem, nm->num, sizeof(char *), afc_list_internal_parallel_comp, &si)) == AFC_ERR_NO_ERROR)
+		afc_list_internal_set_items(nm, mem);
+
+	afc_free(mem);
+
+	return (afc_res);
+}
+// }}}
+// {{{ afc_list_internal_get_items ( nm )
+/* Returns a new array with all the items of the list, NULL if there is not enough memory */
+static char **afc_list_internal_get_items(List *nm)
+{
+	struct afc_list_chunk *c;
+	struct Node *n;
+	char **mem, **p;
+
+	if ((mem = (char **)afc_malloc_uninit(sizeof(char *) * nm->num)) == NULL)
+		return (NULL);
+
+	p = mem;
+
+	if (nm->unrolled)
+	{
+		for (c = nm->first_chunk; c; c = c->next)
+		{
+			memcpy(p, c->items, sizeof(char *) * c->count);
+			p += c->count;
+		}
+	}
+	else
+	{
+		/* The last node is the tail of the list: it has no data */
+		for (n = nm->lst->lh_Head; n->ln_Succ; n = n->ln_Succ)
+			*(p++) = n->ln_Name;
+	}
+
+	return (mem);
+}
+// }}}
+// {{{ afc_list_internal_set_items ( nm, mem )
+/* Stores the items of mem in the list, in the same order */
+static void afc_list_internal_set_items(List *nm, char **mem)
+{
+	struct afc_list_chunk *c;
+	struct Node *n;
+	char **p = mem;
+
+	if (nm->unrolled)
+	{
+		for (c = nm->first_chunk; c; c = c->next)
+		{
+			memcpy(c->items, p, sizeof(char *) * c->count);
+			p += c->count;
+		}
+	}
+	else
+	{
+		for (n = nm->lst->lh_Head; n->ln_Succ; n = n->ln_Succ)
+			n->ln_Name = *(p++);
+	}
+}
+// }}}
+// {{{ afc_list_internal_parallel_comp ( a, b, info )
+static int afc_list_internal_parallel_comp(const void *a, const void *b, void *info)
+{
+	struct afc_list_internal_sort_info *si = (struct afc_list_internal_sort_info *)info;
+	signed long res = si->comp(*(char *const *)a, *(char *const *)b, si->info);
+
+	return ((res > 0) - (res < 0));
+}
+// }}}
+// {{{ afc_list_internal_stack_shift ( nm, at, inserted )
+/* Keeps the pushed ordinal positions right after an item has been inserted at (or deleted from) the position at */
+static void afc_list_internal_stack_shift(List *nm, unsigned long at, BOOL inserted)
+{
+	unsigned char t;
+
+	for (t = 0; t < nm->sposcount; t++)
+	{
+		if (inserted && (nm->sidx[t] >= at))
+			nm->sidx[t]++;
+		else if (!inserted && (nm->sidx[t] > at))
+			nm->sidx[t]--;
+	}
+}
+// }}}
+// {{{ afc_list_internal_index_insert ( nm, r, unit, weight )
+/* Adds to the index a unit of weight items, starting at the ordinal position r. If there is no memory for it, the index is dropped */
+static void afc_list_internal_index_insert(List *nm, unsigned long r, void *unit, unsigned long weight)
+{
+	struct afc_list_index_node *n;
+
+	if (!nm->indexed)
+		return;
+
+	if ((n = (struct afc_list_index_node *)afc_pool_alloc(sizeof(struct afc_list_index_node))) == NULL)
+	{
+		AFC_LOG(AFC_LOG_WARNING, AFC_ERR_NO_MEMORY, "Not enough memory for the List index: it has been dropped", NULL);
+		afc_list_internal_index_free(nm->index);
+		nm->index = NULL;
+		nm->indexed = FALSE;
+		return;
+	}
+
+	// xorshift32: the priorities only need to look random
+	if (nm->index_seed == 0)
+		nm->index_seed = 2463534242U;
+	nm->index_seed ^= nm->index_seed << 13;
+	nm->index_seed ^= nm->index_seed >> 17;
+	nm->index_seed ^= nm->index_seed << 5;
+
+	n->left = n->right = NULL;
+	n->unit = unit;
+	n->weight = n->sum = weight;
+	n->prio = nm->index_seed;
+
+	nm->index = afc_list_internal_index_put(nm->index, r, n);
+}
+// }}}
+// {{{ afc_list_internal_index_remove ( nm, r )
+/* Removes from the index the unit starting at the ordinal position r */
+static void afc_list_internal_index_remove(List *nm, unsigned long r)
+{
+	struct afc_list_index_node *removed = NULL;
+
+	if (nm->index == NULL)
+		return;
+
+	nm->index = afc_list_internal_index_erase(nm->index, r, &removed);
+
+	if (removed)
+		afc_pool_free(removed, sizeof(struct afc_list_index_node));
+}
+// }}}
+// {{{ afc_list_internal_index_add ( nm, r, delta )
+/* Adds delta to the weight of the unit holding the item at the ordinal position r */
+static void afc_list_internal_index_add(List *nm, unsigned long r, long delta)
+{
+	struct afc_list_index_node *t = nm->index;
+	unsigned long lsum;
+
+	while (t)
+	{
+		t->sum += delta;
+		lsum = t->left ? t->left->sum : 0;
+
+		if (r < lsum)
+			t = t->left;
+		else if (r < lsum + t->weight)
+		{
+			t->weight += delta;
+			return;
+		}
+		else
+		{
+			r -= lsum + t->weight;
+			t = t->right;
+		}
+	}
+}
+// }}}
+// {{{ afc_list_internal_index_find ( nm, r, start )
+/* Returns the unit holding the item at the ordinal position r, and stores the position of its first item in start */
+static void *afc_list_internal_index_find(List *nm, unsigned long r, unsigned long *start)
+{
+	struct afc_list_index_node *t = nm->index;
+	unsigned long lsum, base = 0;
+
+	while (t)
+	{
+		lsum = t->left ? t->left->sum : 0;
+
+		if (r < lsum)
+			t = t->left;
+		else if (r < lsum + t->weight)
+		{
+			*start = base + lsum;
+			return (t->unit);
+		}
+		else
+		{
+			r -= lsum + t->weight;
+			base += lsum + t->weight;
+			t = t->right;
+		}
+	}
+
+	return (NULL);
+}
+// }}}
+// {{{ afc_list_internal_index_free ( t )
+static void afc_list_internal_index_free(struct afc_list_index_node *t)
+{
+	struct afc_list_index_node *right;
+
+	// Recursion on the left subtrees only, the right ones are walked in the loop
+	while (t)
+	{
+		afc_list_internal_index_free(t->left);
+		right = t->right;
+		afc_pool_free(t, sizeof(struct afc_list_index_node));
+		t = right;
+	}
+}
+// }}}
+// {{{ afc_list_internal_index_merge ( a, b )
+/* Joins two treaps: all the items of a come before the ones of b */
+static struct afc_list_index_node *afc_list_internal_index_merge(struct afc_list_index_node *a, struct afc_list_index_node *b)
+{
+	if (a == NULL)
+		return (b);
+
+	if (b == NULL)
+		return (a);
+
+	if (a->prio > b->prio)
+	{
+		a->sum += b->sum;
+		a->right = afc_list_internal_index_merge(a->right, b);
+		return (a);
+	}
+
+	b->sum += a->sum;
+	b->left = afc_list_internal_index_merge(a, b->left);
+	return (b);
+}
+// }}}
+// {{{ afc_list_internal_index_split ( t, r, a, b )
+/* Splits a treap in the units before the ordinal position r (a) and the ones from r on (b) */
+static void afc_list_internal_index_split(struct afc_list_index_node *t, unsigned long r, struct afc_list_index_node **a, struct afc_list_index_node **b)
+{
+	unsigned long lsum;
+
+	if (t == NULL)
+	{
+		*a = *b = NULL;
+		return;
+	}
+
+	lsum = t->left ? t->left->sum : 0;
+
+	if (r <= lsum)
+	{
+		afc_list_internal_index_split(t->left, r, a, &t->left);
+		*b = t;
+	}
+	else
+	{
+		afc_list_internal_index_split(t->right, r - lsum - t->weight, &t->right, b);
+		*a = t;
+	}
+
+	t->sum = t->weight + (t->left ? t->left->sum : 0) + (t->right ? t->right->sum : 0);
+}
+// }}}
+// {{{ afc_list_internal_index_put ( t, r, n )
+/* Inserts the node n in the treap t, at the ordinal position r */
+static struct afc_list_index_node *afc_list_internal_index_put(struct afc_list_index_node *t, unsigned long r, struct afc_list_index_node *n)
+{
+	unsigned long lsum;
+
+	if (t == NULL)
+		return (n);
+
+	if (n->prio > t->prio)
+	{
+		afc_list_internal_index_split(t, r, &n->left, &n->right);
+		n->sum = n->weight + (n->left ? n->left->sum : 0) + (n->right ? n->right->sum : 0);
+		return (n);
+	}
+
+	lsum = t->left ? t->left->sum : 0;
+
+	if (r <= lsum)
+		t->left = afc_list_internal_index_put(t->left, r, n);
+	else
+		t->right = afc_list_internal_index_put(t->right, r - lsum - t->weight, n);
+
+	t->sum += n->weight;
+
+	return (t);
+}
+// }}}
+// {{{ afc_list_internal_index_erase ( t, r, removed )
+/* Removes from the treap t the unit starting at the ordinal position r, and stores its node in removed */
+static struct afc_list_index_node *afc_list_internal_index_erase(struct afc_list_index_node *t, unsigned long r, struct afc_list_index_node **removed)
+{
+	unsigned long lsum;
+
+	if (t == NULL)
+		return (NULL);
+
+	lsum = t->left ? t->left->sum : 0;
+
+	if (r == lsum)
+	{
+		*removed = t;
+		return (afc_list_internal_index_merge(t->left, t->right));
+	}
+
+	if (r < lsum)
+		t->left = afc_list_internal_index_erase(t->left, r, removed);
+	else
+		t->right = afc_list_internal_index_erase(t->right, r - lsum - t->weight, removed);
+
+	if (*removed)
+		t->sum -= (*removed)->weight;
+
+	return (t);
+}
+// }}}
+// {{{ afc_list_internal_chunk_alloc ( nm )
+static struct afc_list_chunk *afc_list_internal_chunk_alloc(List *nm)
+{
+	struct afc_list_chunk *c;
+
+	if (nm->arena == NULL)
+		c = (struct afc_list_chunk *)afc_malloc_uninit(sizeof(struct afc_list_chunk));
+	else if ((c = nm->free_chunks) != NULL)
+		nm->free_chunks = c->next;
+	else
+		c = (struct afc_list_chunk *)afc_arena_alloc(nm->arena, sizeof(struct afc_list_chunk));
+
+	if (c == NULL)
+		return (NULL);
+
+	c->next = c->prev = NULL;
+	c->count = 0;
+
+	return (c);
+}
+// }}}
+// {{{ afc_list_internal_chunk_link ( nm, c, after )
+/* Links the chunk c after the chunk after, or as the first one if after is NULL */
+static void afc_list_internal_chunk_link(List *nm, struct afc_list_chunk *c, struct afc_list_chunk *after)
+{
+	c->prev = after;
+	c->next = after ? after->next : nm->first_chunk;
+
+	if (c->next)
+		c->next->prev = c;
+	else
+		nm->last_chunk = c;
+
+	if (after)
+		after->next = c;
+	else
+		nm->first_chunk = c;
+}
+// }}}
+// {{{ afc_list_internal_chunk_unlink ( nm, c )
+/* Unlinks the chunk c and frees it */
+static void afc_list_internal_chunk_unlink(List *nm, struct afc_list_chunk *c)
+{
+	if (c->prev)
+		c->prev->next = c->next;
+	else
+		nm->first_chunk = c->next;
+
+	if (c->next)
+		c->next->prev = c->prev;
+	else
+		nm->last_chunk = c->prev;
+
+	if (nm->arena == NULL)
+	{
+		afc_free(c);
+		return;
+	}
+
+	c->next = nm->free_chunks;
+	nm->free_chunks = c;
+}
+// }}}
+// {{{ afc_list_internal_chunk_add ( nm, s, mode )
+static void *afc_list_internal_chunk_add(List *nm, void *s, unsigned long mode)
+{
+	struct afc_list_chunk *c;
+
+	if (nm->num == 0)
+	{
+		if ((c = afc_list_internal_chunk_alloc(nm)) == NULL)
+			return (NULL);
+
+		afc_list_internal_chunk_link(nm, c, NULL);
+
+		s = afc_list_internal_chunk_insert(nm, c, 0, 0, s);
+	}
+	else if (mode == AFC_LIST_ADD_HEAD)
+		s = afc_list_internal_chunk_insert(nm, nm->first_chunk, 0, 0, s);
+	else if (mode == AFC_LIST_ADD_HERE)
+		s = afc_list_internal_chunk_insert(nm, nm->chunk, nm->chunk_pos + 1, nm->npos + 1, s);
+	else
+		s = afc_list_internal_chunk_insert(nm, nm->last_chunk, nm->last_chunk->count, nm->num, s);
+
+	nm->is_sorted = FALSE;
+
+	return (s);
+}
+// }}}
+// {{{ afc_list_internal_chunk_insert ( nm, c, idx, at, s )
+/* Inserts s at the position idx of the chunk c, which is the ordinal position at of the list, and makes it the current item */
+static void *afc_list_internal_chunk_insert(List *nm, struct afc_list_chunk *c, unsigned int idx, unsigned long at, void *s)
+{
+	struct afc_list_chunk *nc;
+	unsigned int half = AFC_LIST_CHUNK_ITEMS / 2;
+	unsigned long start = at - idx; // Ordinal position of the first item of c
+
+	if (c->count == 0)
+		afc_list_internal_index_insert(nm, 0, c, 1);
+	else if (c->count < AFC_LIST_CHUNK_ITEMS)
+		afc_list_internal_index_add(nm, start, 1);
+	else
+	{
+		if ((nc = afc_list_internal_chunk_alloc(nm)) == NULL)
+			return (NULL);
+
+		// Items added at the ends of a full chunk start a new one, so lists built in order have full chunks
+		if (idx == 0)
+		{
+			afc_list_internal_chunk_link(nm, nc, c->prev);
+			afc_list_internal_index_insert(nm, start, nc, 1);
+		}
+		else
+		{
+			afc_list_internal_chunk_link(nm, nc, c);
+
+			if (idx == AFC_LIST_CHUNK_ITEMS)
+			{
+				idx = 0;
+				afc_list_internal_index_insert(nm, start + AFC_LIST_CHUNK_ITEMS, nc, 1);
+			}
+			else
+			{
+				memcpy(nc->items, c->items + half, sizeof(void *) * (AFC_LIST_CHUNK_ITEMS - half));
+				nc->count = AFC_LIST_CHUNK_ITEMS - half;
+				c->count = half;
+
+				afc_list_internal_index_add(nm, start, -(long)nc->count);
+				afc_list_internal_index_insert(nm, start + half, nc, nc->count);
+
+				if (idx <= half)
+				{
+					nc = c;
+					afc_list_internal_index_add(nm, start, 1);
+				}
+				else
+				{
+					idx -= half;
+					afc_list_internal_index_add(nm, start + half, 1);
+				}
+			}
+		}
+
+		c = nc;
+	}
+
+	memmove(c->items + idx + 1, c->items + idx, sizeof(void *) * (c->count - idx));
+	c->items[idx] = s;
+	c->count++;
+
+	nm->chunk = c;
+	nm->chunk_pos = idx;
+	nm->npos = at;
+	nm->num++;
+
+	afc_list_internal_stack_shift(nm, at, TRUE);
+
+	return (s);
+}
+// }}}
+// {{{ afc_list_internal_chunk_del ( nm )
+static void *afc_list_internal_chunk_del(List *nm)
+{
+	struct afc_list_chunk *c = nm->chunk, *nc;
+	unsigned long start;
+	unsigned char t, i;
+
+	if (nm->num == 0)
+		return (NULL);
+
+	if (nm->func_clear)
+		nm->func_clear(c->items[nm->chunk_pos]);
+
+	// The deleted position is removed from the stack, the ones after it move back
+	for (t = 0; t < nm->sposcount;)
+	{
+		if (nm->sidx[t] == nm->npos)
+		{
+			for (i = t; i < nm->sposcount - 1; i++)
+				nm->sidx[i] = nm->sidx[i + 1];
+			nm->sposcount--;
+		}
+		else
+			t++;
+	}
+
+	afc_list_internal_stack_shift(nm, nm->npos, FALSE);
+
+	nm->is_sorted = FALSE;
+	nm->is_array_valid = FALSE;
+
+	if (--nm->num == 0)
+	{
+		afc_list_internal_chunk_unlink(nm, c);
+		afc_list_internal_init_list(nm);
+		afc_list_free_array(nm);
+		return (NULL);
+	}
+
+	memmove(c->items + nm->chunk_pos, c->items + nm->chunk_pos + 1, sizeof(void *) * (c->count - nm->chunk_pos - 1));
+	c->count--;
+
+	// start is the ordinal position of the first item of c
+	start = nm->npos - nm->chunk_pos;
+
+	if (c->count == 0)
+	{
+		afc_list_internal_index_remove(nm, start);
+
+		nc = c->next ? c->next : c->prev;
+		if (nc == c->prev)
+			start -= nc->count;
+		afc_list_internal_chunk_unlink(nm, c);
+		c = nc;
+	}
+	else
+	{
+		afc_list_internal_index_add(nm, start, -1);
+
+		if (c->next && (c->count + c->next->count <= AFC_LIST_CHUNK_ITEMS / 2))
+		{
+			nc = c->next;
+			afc_list_internal_index_remove(nm, start + c->count);
+			afc_list_internal_index_add(nm, start, nc->count);
+
+			memcpy(c->items + c->count, nc->items, sizeof(void *) * nc->count);
+			c->count += nc->count;
+			afc_list_internal_chunk_unlink(nm, nc);
+		}
+		else if (c->prev && (c->prev->count + c->count <= AFC_LIST_CHUNK_ITEMS / 2))
+		{
+			nc = c->prev;
+			afc_list_internal_index_remove(nm, start);
+			afc_list_internal_index_add(nm, start - nc->count, c->count);
+
+			memcpy(nc->items + nc->count, c->items, sizeof(void *) * c->count);
+			start -= nc->count;
+			nc->count += c->count;
+			afc_list_internal_chunk_unlink(nm, c);
+			c = nc;
+		}
+	}
+
+	// The next item becomes the current one, or the previous one if the last item was deleted
+	return (afc_list_internal_chunk_seek(nm, c, start, (nm->npos < nm->num) ? nm->npos : nm->num - 1));
+}
+// }}}
+// {{{ afc_list_internal_chunk_item ( nm, n )
+static void *afc_list_internal_chunk_item(List *nm, unsigned long n)
+{
+	struct afc_list_chunk *c;
+	unsigned long from_cur, start = 0;
+
+	if (nm->num == 0)
+		return (NULL);
+
+	if (n >= nm->num)
+		n = nm->num - 1;
+
+	if (nm->index != NULL)
+	{
+		c = (struct afc_list_chunk *)afc_list_internal_index_find(nm, n, &start);
+		return (afc_list_internal_chunk_seek(nm, c, start, n));
+	}
+
+	from_cur = (n > nm->npos) ? n - nm->npos : nm->npos - n;
+
+	// The walk starts from the nearest of the first, the current and the last item
+	if ((n <= from_cur) && (n <= nm->num - 1 - n))
+		return (afc_list_internal_chunk_seek(nm, nm->first_chunk, 0, n));
+
+	if (nm->num - 1 - n < from_cur)
+		return (afc_list_internal_chunk_seek(nm, nm->last_chunk, nm->num - nm->last_chunk->count, n));
+
+	return (afc_list_internal_chunk_seek(nm, nm->chunk, nm->npos - nm->chunk_pos, n));
+}
+// }}}
+// {{{ afc_list_internal_chunk_seek ( nm, c, start, n )
+/* Makes the item n the current one, walking the chunks from c, whose first item has the ordinal position start */
+static void *afc_list_internal_chunk_seek(List *nm, struct afc_list_chunk *c, unsigned long start, unsigned long n)
+{
+	while (n < start)
+	{
+		c = c->prev;
+		start -= c->count;
+	}
+
+	while (n >= start + c->count)
+	{
+		start += c->count;
+		c = c->next;
+	}
+
+	nm->chunk = c;
+	nm->chunk_pos = (unsigned int)(n - start);
+	nm->npos = n;
+
+	return (c->items[nm->chunk_pos]);
+}
+// }}}
+// {{{ afc_list_internal_chunk_clear ( nm )
+/* Frees all the chunks, calling the clear func on their items */
+static void afc_list_internal_chunk_clear(List *nm)
+{
+	struct afc_list_chunk *c, *nc;
+	unsigned int t;
+
+	for (c = nm->first_chunk; c; c = nc)
+	{
+		nc = c->next;
+
+		if (nm->func_clear)
+			for (t = 0; t < c->count; t++)
+				nm->func_clear(c->items[t]);
+
+		// Arena chunks are released with the Arena
+		if (nm->arena == NULL)
+			afc_free(c);
+	}
+
+	nm->first_chunk = nm->last_chunk = nm->chunk = NULL;
+}
+// }}}
+
 /*
 static int afc_list_internal_ultra_comp ( List * nm, const void * s1, const void * s2 )
 {
@@ -27,6 +27,9 @@
 
 #include "base.h"
 #include "string.h"
+#include "arena.h"
+#include "pool.h"
+#include "parallel_sort.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -39,7 +42,14 @@ extern "C"
 /* AFC List Base                  */
 #define AFC_LIST_BASE 0x1000
 
-	struct Node
+/* Empty lists are detected reading the header as a Node (see IsListEmpty()): tell the compiler the two types alias */
+#ifdef __GNUC__
+#define AFC_LIST_MAY_ALIAS __attribute__((__may_alias__))
+#else
+#define AFC_LIST_MAY_ALIAS
+#endif
+
+	struct AFC_LIST_MAY_ALIAS Node
 	{
 		struct Node *ln_Succ,
 			*ln_Pred;
@@ -49,7 +59,7 @@ extern "C"
 		//  signed char   ln_Pri;
 	};
 
-	struct List
+	struct AFC_LIST_MAY_ALIAS List
 	{
 		struct Node *lh_Head,
 			*lh_Tail,
@@ -59,6 +69,36 @@ extern "C"
 #define IsListEmpty(l) \
 	((((struct List *)l)->lh_TailPred) == (struct Node *)(l))
 
+/* Items stored in every chunk of an unrolled List */
+#define AFC_LIST_CHUNK_ITEMS 64
+
+	struct afc_list_chunk
+	{
+		struct afc_list_chunk *next,
+			*prev;
+
+		unsigned int count; /* Items used in this chunk */
+		void *items[AFC_LIST_CHUNK_ITEMS];
+	};
+
+	/* Node of the ordinal index: a treap ordered by the position of the items, with the number of items of every subtree */
+	struct afc_list_index_node
+	{
+		struct afc_list_index_node *left,
+			*right;
+
+		void *unit;			  /* List node, or chunk of an unrolled List */
+		unsigned long weight; /* Items in the unit                        */
+		unsigned long sum;	  /* Items in the whole subtree              */
+		unsigned int prio;
+	};
+
+	/* Errors for List */
+	enum
+	{
+		AFC_LIST_ERR_NOT_EMPTY = AFC_LIST_BASE + 1 /* The Arena or the storage cannot be changed on a non empty List */
+	};
+
 	/* Insertion modes */
 
 	enum
@@ -88,6 +128,21 @@ extern "C"
 		BOOL before_first;
 
 		int (*func_clear)(void *);
+
+		Arena *arena;			 /* If set, nodes are allocated from this Arena     */
+		struct Node *free_nodes; /* Deleted nodes of the Arena, ready to be reused  */
+
+		BOOL unrolled;						 /* If TRUE, items are stored in chunks instead of nodes */
+		struct afc_list_chunk *first_chunk; /* First chunk (unrolled List only)               */
+		struct afc_list_chunk *last_chunk;	 /* Last chunk (unrolled List only)                */
+		struct afc_list_chunk *chunk;		 /* Chunk of the actual item (unrolled List only)  */
+		unsigned int chunk_pos;				 /* Actual item inside its chunk                   */
+		unsigned long sidx[8];				 /* Ordinal positions of the stacked items          */
+		struct afc_list_chunk *free_chunks; /* Deleted chunks of the Arena, ready to be reused */
+
+		BOOL indexed;					   /* If TRUE, items are found by position in O(log n) */
+		struct afc_list_index_node *index; /* Root of the ordinal index                     */
+		unsigned int index_seed;		   /* Seed of the priorities of the index nodes     */
 	};
 
 	typedef struct afc_list List;
@@ -136,11 +191,15 @@ extern "C"
 	short afc_list_is_first(List *);
 	struct Node **afc_list_create_array(List *);
 	void afc_list_free_array(List *);
+	List *afc_list_clone(List *);
 
 	void *afc_list_fast_sort(List *nm, long (*comp)(void *, void *, void *), void *);
 	void *afc_list_ultra_sort(List *nm, int (*comp)(const void *, const void *));
 	long afc_list_for_each(List *nm, long (*funct)(List *nm, void *, void *), void *);
 	int afc_list_before_first(List *nm);
+	int afc_list_set_arena(List *nm, Arena *arena);
+	int afc_list_set_unrolled(List *nm, BOOL unrolled);
+	int afc_list_set_index(List *nm, BOOL indexed);
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -2,171 +2,167 @@
 #include <stdint.h>
 #include "mem_tracker.h"
 
-static int _memtrack_realloc(MemTracker *mt);
-static int _memtrack_realloc_free(MemTracker *mt);
-static void _memtrack_add(MemTracker *mt, MemTrackData *hd);
-static int _memtrack_find(MemTracker *mt, void *mem);
-static void _memtrack_del(MemTracker *mt, int pos);
-static void _free_item(MemTracker *mt, MemTrackData *d);
-
-/* _memtrack_hash_index - compute hash bucket index from a pointer */
-static unsigned int _memtrack_hash_index(void *ptr)
-{
-	uintptr_t v = (uintptr_t)ptr;
-	v = (v >> 4) ^ (v >> 16);
-	return (unsigned int)(v & (AFC_MEMTRACK_HASH_SIZE - 1));
-}
-
-/* _memtrack_hash_insert - insert entry into the hash table */
-static void _memtrack_hash_insert(MemTracker *mt, MemTrackData *hd)
-{
-	unsigned int idx = _memtrack_hash_index(hd->mem);
-	hd->hash_next = mt->hash_table[idx];
-	mt->hash_table[idx] = hd;
-}
+static struct _mt_shard *_memtrack_shard(MemTracker *mt, void *mem, unsigned long long *hash);
+static void _memtrack_hash_insert(struct _mt_shard *sh, MemTrackData *hd, unsigned long long hash);
+static MemTrackData *_memtrack_hash_remove(struct _mt_shard *sh, void *mem, unsigned long long hash);
+static MemTrackData *_memtrack_hash_find(struct _mt_shard *sh, void *mem, unsigned long long hash);
+static void _memtrack_hash_grow(struct _mt_shard *sh);
+static void _memtrack_rehome(MemTracker *mt, void *mem, void *new_mem);
+static void _free_item(MemTrackData *d);
+static MemTrackSite *_memtrack_site(MemTracker *mt, const char *file, const char *func, unsigned int line);
+static void _memtrack_site_grow(MemTrackSite *site, size_t size);
+static int _memtrack_site_comp_live(const void *a, const void *b);
+static int _memtrack_site_comp_peak(const void *a, const void *b);
+static int _memtrack_site_comp_allocs(const void *a, const void *b);
+static int _memtrack_site_comp_total(const void *a, const void *b);
 
-/* _memtrack_hash_remove - remove entry from the hash table */
-static void _memtrack_hash_remove(MemTracker *mt, MemTrackData *hd)
-{
-	unsigned int idx = _memtrack_hash_index(hd->mem);
-	MemTrackData **pp = &mt->hash_table[idx];
-
-	while (*pp)
-	{
-		if (*pp == hd)
-		{
-			*pp = hd->hash_next;
-			hd->hash_next = NULL;
-			return;
-		}
-		pp = &(*pp)->hash_next;
-	}
-}
-
-/* _memtrack_hash_find - O(1) lookup by pointer in the hash table */
-static MemTrackData *_memtrack_hash_find(MemTracker *mt, void *mem)
-{
-	unsigned int idx = _memtrack_hash_index(mem);
-	MemTrackData *hd = mt->hash_table[idx];
+#ifndef MINGW
+#define _memtrack_lock(sh) pthread_mutex_lock(&(sh)->mutex)
+#define _memtrack_unlock(sh) pthread_mutex_unlock(&(sh)->mutex)
+#else
+#define _memtrack_lock(sh)
+#define _memtrack_unlock(sh)
+#endif
 
-	while (hd)
-	{
-		if (hd->mem == mem)
-			return hd;
-		hd = hd->hash_next;
-	}
+/* Site counters are shared by all the shards: they are updated without locks */
+#define _memtrack_atomic_add(ptr, val) __atomic_add_fetch(ptr, val, __ATOMIC_RELAXED)
+#define _memtrack_atomic_sub(ptr, val) __atomic_sub_fetch(ptr, val, __ATOMIC_RELAXED)
+#define _memtrack_atomic_load(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
 
-	return NULL;
-}
+/* Bucket of hash in a shard: the top bits choose the shard, so they are not used here */
+#define _memtrack_bucket(sh, hash) ((unsigned int)((hash) >> 16) & ((sh)->hash_size - 1))
 
 MemTracker *afc_mem_tracker_new()
 {
 	MemTracker *mt = malloc(sizeof(MemTracker));
+	struct _mt_shard *sh;
+	int t;
+
 	if (mt == NULL)
 		return NULL;
 
-	mt->data_max = 200;
-	mt->data_cur = 0;
-	mt->data = malloc(mt->data_max * sizeof(MemTrackData *));
-	if (mt->data == NULL)
-	{
-		free(mt);
-		return NULL;
-	}
-	memset(mt->data, 0, mt->data_max * sizeof(MemTrackData *));
+	memset(mt, 0, sizeof(MemTracker));
 
-	mt->free_cur = -1;
-	mt->free_max = 100;
-	mt->free = malloc(mt->free_max * sizeof(unsigned int));
-	if (mt->free == NULL)
+	for (t = 0; t < AFC_MEMTRACK_SHARDS; t++)
 	{
-		free(mt->data);
-		free(mt);
-		return NULL;
-	}
+		sh = &mt->shards[t];
 
-	mt->show_mallocs = FALSE;
-	mt->show_frees = FALSE;
-	mt->allocs = 0;
-	mt->frees = 0;
-	mt->alloc_bytes = 0;
+		if ((sh->hash_table = calloc(AFC_MEMTRACK_HASH_SIZE, sizeof(MemTrackData *))) == NULL)
+		{
+			while (t--)
+				free(mt->shards[t].hash_table);
+			free(mt);
+			return NULL;
+		}
+
+		sh->hash_size = AFC_MEMTRACK_HASH_SIZE;
 
-	memset(mt->hash_table, 0, sizeof(mt->hash_table));
+#ifndef MINGW
+		pthread_mutex_init(&sh->mutex, NULL);
+#endif
+	}
 
 #ifndef MINGW
-	pthread_mutex_init(&mt->mutex, NULL);
+	pthread_mutex_init(&mt->sites_mutex, NULL);
 #endif
+	mt->started = time(NULL);
+
+	mt->show_mallocs = FALSE;
+	mt->show_frees = FALSE;
+
+	mt->report_file = NULL;
+	mt->report_format = AFC_MEM_TRACKER_REPORT_TEXT;
 
 	return mt;
 }
 
 void _afc_mem_tracker_delete(MemTracker *mt)
 {
-	unsigned int t;
-	MemTrackData *hd;
+	struct _mt_shard *sh;
+	MemTrackData *hd, *next;
+	MemTrackSite *site, *next_site;
+	unsigned int t, b;
 
 	_afc_dprintf("%s::%s\n", __FILE__, __FUNCTION__);
 
-	for (t = 0; t < mt->data_cur; t++)
+	for (t = 0; t < AFC_MEMTRACK_SHARDS; t++)
 	{
-		hd = mt->data[t];
-		if (!hd)
-			continue;
-		printf("LEAK: file: %s - func: %s - line: %d - size: %d\n", hd->file, hd->func, hd->line, (int)hd->size);
+		sh = &mt->shards[t];
+
+		for (b = 0; b < sh->hash_size; b++)
+		{
+			for (hd = sh->hash_table[b]; hd; hd = next)
+			{
+				next = hd->hash_next;
+				printf("LEAK: file: %s - func: %s - line: %d - size: %d\n", hd->file, hd->func, hd->line, (int)hd->size);
+
+				_free_item(hd);
+			}
+		}
 
-		_free_item(mt, hd);
+		free(sh->hash_table);
+#ifndef MINGW
+		pthread_mutex_destroy(&sh->mutex);
+#endif
+	}
+
+	for (b = 0; b < AFC_MEMTRACK_SITES_SIZE; b++)
+	{
+		for (site = mt->sites[b]; site; site = next_site)
+		{
+			next_site = site->next;
+			free(site);
+		}
 	}
 
-	free(mt->data);
-	free(mt->free);
 #ifndef MINGW
-	pthread_mutex_destroy(&mt->mutex);
+	pthread_mutex_destroy(&mt->sites_mutex);
 #endif
 	free(mt);
 }
 
 void *afc_mem_tracker_malloc(MemTracker *mt, size_t size, const char *file, const char *func, const unsigned int line)
 {
+	struct _mt_shard *sh;
+	unsigned long long hash;
 	MemTrackData *hd;
 	void *mem;
 
 	if ((mem = malloc(size)) == NULL)
 		return NULL;
 
-#ifndef MINGW
-	pthread_mutex_lock(&mt->mutex);
-#endif
-
-	if ((__internal_afc_base->start_log_level >= AFC_LOG_NOTICE) && (mt->show_mallocs))
-		_afc_dprintf("NOTICE: MemTracker: alloc %p (%d)\n", mem, (int)size);
-
-	hd = (MemTrackData *)malloc(sizeof(MemTrackData));
-
-	if (hd == NULL)
+	if ((hd = (MemTrackData *)malloc(sizeof(MemTrackData))) == NULL)
 	{
 		free(mem);
-#ifndef MINGW
-		pthread_mutex_unlock(&mt->mutex);
-#endif
 		return NULL;
 	}
 
+	if ((__internal_afc_base->start_log_level >= AFC_LOG_NOTICE) && (mt->show_mallocs))
+		_afc_dprintf("NOTICE: MemTracker: alloc %p (%d)\n", mem, (int)size);
+
 	hd->mem = mem;
 	hd->size = size;
 	hd->file = file;  /* Store pointer directly — file/func are compile-time literals */
 	hd->func = func;
 	hd->line = line;
-	hd->hash_next = NULL;
 
-	mt->allocs++;
-	mt->alloc_bytes += size;
+	if ((hd->site = _memtrack_site(mt, file, func, line)) != NULL)
+	{
+		_memtrack_atomic_add(&hd->site->allocs, 1);
+		_memtrack_atomic_add(&hd->site->total_bytes, size);
+		_memtrack_site_grow(hd->site, size);
+	}
 
-	_memtrack_add(mt, hd);
-	_memtrack_hash_insert(mt, hd);
+	sh = _memtrack_shard(mt, mem, &hash);
 
-#ifndef MINGW
-	pthread_mutex_unlock(&mt->mutex);
-#endif
+	_memtrack_lock(sh);
+
+	sh->allocs++;
+	sh->alloc_bytes += size;
+
+	_memtrack_hash_insert(sh, hd, hash);
+
+	_memtrack_unlock(sh);
 
 	return mem;
 }
@@ -191,38 +187,41 @@ void *afc_mem_tracker_malloc(MemTracker *mt, size_t size, const char *file, cons
 */
 void _afc_mem_tracker_free(MemTracker *mt, void *mem, const char *file, const char *func, const unsigned int line)
 {
+	struct _mt_shard *sh;
+	unsigned long long hash;
 	MemTrackData *hd;
 
 	if (mem == NULL)
 		return;
 
-#ifndef MINGW
-	pthread_mutex_lock(&mt->mutex);
-#endif
-
 	if ((__internal_afc_base->start_log_level >= AFC_LOG_NOTICE) && (mt->show_frees))
 		_afc_dprintf("NOTICE: MemTracker: free %p\n", mem);
 
-	hd = _memtrack_hash_find(mt, mem);
+	sh = _memtrack_shard(mt, mem, &hash);
+
+	_memtrack_lock(sh);
+
+	if ((hd = _memtrack_hash_remove(sh, mem, hash)) != NULL)
+	{
+		sh->alloc_bytes -= hd->size;
+		sh->frees++;
+	}
+
+	_memtrack_unlock(sh);
+
+	// The memory goes back to the system outside the lock
 	if (hd)
 	{
-		int pos = _memtrack_find(mt, mem);
-		mt->alloc_bytes -= hd->size;
-		mt->frees++;
-
-		_memtrack_hash_remove(mt, hd);
-		_free_item(mt, hd);
-		if (pos != -1)
-			_memtrack_del(mt, pos);
+		if (hd->site)
+		{
+			_memtrack_atomic_add(&hd->site->frees, 1);
+			_memtrack_atomic_sub(&hd->site->live_bytes, hd->size);
+		}
+
+		_free_item(hd);
 	}
 	else
-	{
 		_afc_dprintf("%s::%s invalid memory pointer: %p at: %s::%s (%d)\n", __FILE__, __FUNCTION__, mem, file, func, line);
-	}
-
-#ifndef MINGW
-	pthread_mutex_unlock(&mt->mutex);
-#endif
 }
 // }}}
 
@@ -248,146 +247,407 @@ void _afc_mem_tracker_free(MemTracker *mt, void *mem, const char *file, const ch
 */
 void _afc_mem_tracker_update_size(MemTracker *mt, void *mem, void *new_mem, size_t size, const char *file, const char *func, const unsigned int line)
 {
+	struct _mt_shard *sh;
+	unsigned long long hash;
 	MemTrackData *hd;
 
 	if (mem == NULL)
 		return;
 
-#ifndef MINGW
-	pthread_mutex_lock(&mt->mutex);
-#endif
+	sh = _memtrack_shard(mt, mem, &hash);
 
-	hd = _memtrack_hash_find(mt, mem);
-	if (hd)
+	_memtrack_lock(sh);
+
+	if ((hd = _memtrack_hash_find(sh, mem, hash)) != NULL)
 	{
-		_memtrack_hash_remove(mt, hd);
-		mt->alloc_bytes -= hd->size;
+		sh->alloc_bytes -= hd->size;
 
-		hd->size = size;
-		if (new_mem != NULL)
-			hd->mem = new_mem;
+		if (hd->site)
+		{
+			_memtrack_atomic_sub(&hd->site->live_bytes, hd->size);
+			_memtrack_site_grow(hd->site, size);
+		}
 
-		mt->alloc_bytes += hd->size;
-		_memtrack_hash_insert(mt, hd);
+		hd->size = size;
+		sh->alloc_bytes += hd->size;
 	}
-	else
-	{
+
+	_memtrack_unlock(sh);
+
+	if (hd == NULL)
 		_afc_dprintf("%s::%s invalid memory pointer: %p at: %s::%s (%d)\n", __FILE__, __FUNCTION__, mem, file, func, line);
+	else if (new_mem != NULL)
+		_memtrack_rehome(mt, mem, new_mem);
+}
+// }}}
+
+// {{{ _afc_mem_tracker_update_pointer ( mt, old_mem, new_mem )
+void _afc_mem_tracker_update_pointer(MemTracker *mt, void *old_mem, void *new_mem)
+{
+	if (old_mem == NULL)
+		return;
+
+	_memtrack_rehome(mt, old_mem, new_mem);
+}
+// }}}
+// {{{ afc_mem_tracker_get_stats ( mt, stats )
+/*
+@node afc_mem_tracker_get_stats
+
+			 NAME: afc_mem_tracker_get_stats ( mem_tracker, stats )  - Returns the tracker counters
+
+		 SYNOPSIS: int afc_mem_tracker_get_stats ( MemTracker * mem_tracker, MemTrackerStats * stats )
+
+	  DESCRIPTION: This function sums the counters of all the tracker shards in /stats/:
+				   - allocs: blocks allocated since tracking started.
+				   - frees: blocks freed since tracking started.
+				   - blocks: blocks currently allocated.
+				   - alloc_bytes: bytes currently allocated.
+
+			INPUT: - mem_tracker  - Pointer to a valid afc_mem_tracker class.
+			- stats		- Pointer to the MemTrackerStats structure to fill.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+			NOTES: - Shards are locked one at a time, so with other threads running the values are
+					 a close snapshot, not an exact one.
+
+		 SEE ALSO: - afc_mem_tracker_malloc()
+				   - afc_mem_tracker_allocs()
+@endnode
+*/
+int afc_mem_tracker_get_stats(MemTracker *mt, MemTrackerStats *stats)
+{
+	struct _mt_shard *sh;
+	int t;
+
+	if ((mt == NULL) || (stats == NULL))
+		return (AFC_ERR_NULL_POINTER);
+
+	memset(stats, 0, sizeof(MemTrackerStats));
+
+	for (t = 0; t < AFC_MEMTRACK_SHARDS; t++)
+	{
+		sh = &mt->shards[t];
+
+		_memtrack_lock(sh);
+		stats->allocs += sh->allocs;
+		stats->frees += sh->frees;
+		stats->blocks += sh->count;
+		stats->alloc_bytes += sh->alloc_bytes;
+		_memtrack_unlock(sh);
 	}
 
-#ifndef MINGW
-	pthread_mutex_unlock(&mt->mutex);
-#endif
+	return (AFC_ERR_NO_ERROR);
 }
 // }}}
+// {{{ afc_mem_tracker_allocs ( mt ) / afc_mem_tracker_frees ( mt ) / afc_mem_tracker_alloc_bytes ( mt )
+/*
+@node afc_mem_tracker_allocs
+
+			 NAME: afc_mem_tracker_allocs ( mem_tracker ) - Read-only access to the old MemTracker counters
 
-// {{{ _memtrack_add ( mt, hd )
-static void _memtrack_add(MemTracker *mt, MemTrackData *hd)
+		 SYNOPSIS: unsigned long afc_mem_tracker_allocs ( MemTracker * mem_tracker )
+				   unsigned long afc_mem_tracker_frees ( MemTracker * mem_tracker )
+				   size_t afc_mem_tracker_alloc_bytes ( MemTracker * mem_tracker )
+
+	  DESCRIPTION: These functions return the values that were read from the /allocs/, /frees/ and /alloc_bytes/
+				   fields of MemTracker before it was split in shards: blocks allocated and freed since tracking
+				   started, and bytes currently allocated.
+
+			INPUT: - mem_tracker  - Pointer to a valid afc_mem_tracker class.
+
+		  RESULTS: the counter value, or 0 if /mem_tracker/ is NULL.
+
+			NOTES: - Every call sums all the shards: to read more counters at once, use afc_mem_tracker_get_stats().
+
+		 SEE ALSO: - afc_mem_tracker_get_stats()
+@endnode
+*/
+unsigned long afc_mem_tracker_allocs(MemTracker *mt)
 {
-	unsigned int pos;
+	MemTrackerStats stats;
 
-	if (mt->free_cur != -1)
-		pos = mt->free[mt->free_cur--];
-	else
-		pos = mt->data_cur++;
+	if (afc_mem_tracker_get_stats(mt, &stats) != AFC_ERR_NO_ERROR)
+		return (0);
+
+	return (stats.allocs);
+}
+
+unsigned long afc_mem_tracker_frees(MemTracker *mt)
+{
+	MemTrackerStats stats;
+
+	if (afc_mem_tracker_get_stats(mt, &stats) != AFC_ERR_NO_ERROR)
+		return (0);
+
+	return (stats.frees);
+}
+
+size_t afc_mem_tracker_alloc_bytes(MemTracker *mt)
+{
+	MemTrackerStats stats;
+
+	if (afc_mem_tracker_get_stats(mt, &stats) != AFC_ERR_NO_ERROR)
+		return (0);
+
+	return (stats.alloc_bytes);
+}
+// }}}
+
+// {{{ afc_mem_tracker_report ( mt, out, format, sort )
+/*
+@node afc_mem_tracker_report
 
-	if (pos >= mt->data_max)
+			 NAME: afc_mem_tracker_report ( mem_tracker, out, format, sort )  - Writes the allocation sites report
+
+		 SYNOPSIS: int afc_mem_tracker_report ( MemTracker * mem_tracker, FILE * out, int format, int sort )
+
+	  DESCRIPTION: This function writes to /out/ a line for every place (file, function and line) where memory
+				   has been allocated since tracking started, with:
+
+				   - live bytes: bytes allocated there and not freed yet.
+				   - peak bytes: the highest value live bytes reached.
+				   - allocs and frees: number of blocks allocated and freed.
+				   - total bytes: bytes allocated there since tracking started.
+				   - allocs/s: allocations per second since tracking started (the churn rate).
+
+				   The report can also be written automatically by afc_delete(): see the AFC_TAG_MEM_REPORT tag.
+
+			INPUT: - mem_tracker  - Pointer to a valid afc_mem_tracker class.
+			- out		- An already opened FILE pointer (like stderr).
+			- format	- One of these values:
+						+ AFC_MEM_TRACKER_REPORT_TEXT - A table for humans.
+						+ AFC_MEM_TRACKER_REPORT_CSV - Comma separated values, with a header line.
+			- sort		- Sites are sorted from the biggest value of:
+						+ AFC_MEM_TRACKER_SORT_LIVE - live bytes.
+						+ AFC_MEM_TRACKER_SORT_PEAK - peak bytes.
+						+ AFC_MEM_TRACKER_SORT_ALLOCS - number of allocations.
+						+ AFC_MEM_TRACKER_SORT_TOTAL - total bytes.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_ERR_NULL_POINTER if /mem_tracker/ or /out/ are NULL.
+				   - AFC_ERR_NO_MEMORY if there is no memory to sort the sites.
+
+			NOTES: - Sites are keyed on the __FILE__ and __LINE__ of the afc_malloc() (or afc_string_new()) call:
+					 to see which class is allocating, look at the /func/ column.
+
+		 SEE ALSO: - afc_mem_tracker_get_stats()
+				   - afc_set_tag()
+@endnode
+*/
+int afc_mem_tracker_report(MemTracker *mt, FILE *out, int format, int sort)
+{
+	int (*comp)(const void *, const void *);
+	MemTrackSite *sites, *site;
+	unsigned int num = 0, max = 0, t;
+	unsigned long elapsed;
+
+	if ((mt == NULL) || (out == NULL))
+		return (AFC_ERR_NULL_POINTER);
+
+	// Take a snapshot of the sites, so the counters do not change while sorting
+	for (t = 0; t < AFC_MEMTRACK_SITES_SIZE; t++)
+		for (site = __atomic_load_n(&mt->sites[t], __ATOMIC_ACQUIRE); site; site = site->next)
+			max++;
+
+	if ((sites = malloc((max + 1) * sizeof(MemTrackSite))) == NULL)
+		return (AFC_ERR_NO_MEMORY);
+
+	for (t = 0; t < AFC_MEMTRACK_SITES_SIZE; t++)
 	{
-		if (_memtrack_realloc(mt) != 0)
+		for (site = __atomic_load_n(&mt->sites[t], __ATOMIC_ACQUIRE); site && (num < max); site = site->next)
 		{
-			// Realloc failed - cannot track this allocation
-			_afc_dprintf("WARNING: MemTracker: realloc failed, allocation not tracked\n");
-			return;
+			sites[num].file = site->file;
+			sites[num].func = site->func;
+			sites[num].line = site->line;
+			sites[num].allocs = _memtrack_atomic_load(&site->allocs);
+			sites[num].frees = _memtrack_atomic_load(&site->frees);
+			sites[num].live_bytes = _memtrack_atomic_load(&site->live_bytes);
+			sites[num].peak_bytes = _memtrack_atomic_load(&site->peak_bytes);
+			sites[num].total_bytes = _memtrack_atomic_load(&site->total_bytes);
+			num++;
 		}
 	}
 
-	mt->data[pos] = hd;
+	switch (sort)
+	{
+	case AFC_MEM_TRACKER_SORT_PEAK:
+		comp = _memtrack_site_comp_peak;
+		break;
+	case AFC_MEM_TRACKER_SORT_ALLOCS:
+		comp = _memtrack_site_comp_allocs;
+		break;
+	case AFC_MEM_TRACKER_SORT_TOTAL:
+		comp = _memtrack_site_comp_total;
+		break;
+	default:
+		comp = _memtrack_site_comp_live;
+		break;
+	}
+
+	qsort(sites, num, sizeof(MemTrackSite), comp);
+
+	if ((elapsed = (unsigned long)(time(NULL) - mt->started)) == 0)
+		elapsed = 1;
+
+	if (format == AFC_MEM_TRACKER_REPORT_CSV)
+		fprintf(out, "file,func,line,live_bytes,peak_bytes,allocs,frees,total_bytes,allocs_per_sec\n");
+	else
+	{
+		fprintf(out, "MemTracker report: %u allocation sites in %lu seconds\n", num, elapsed);
+		fprintf(out, "%12s %12s %10s %10s %14s %10s  %s\n", "Live bytes", "Peak bytes", "Allocs", "Frees", "Total bytes", "Allocs/s", "Site");
+	}
+
+	for (t = 0; t < num; t++)
+	{
+		site = &sites[t];
+
+		if (format == AFC_MEM_TRACKER_REPORT_CSV)
+			fprintf(out, "\"%s\",\"%s\",%u,%lu,%lu,%lu,%lu,%lu,%lu\n", site->file, site->func, site->line,
+					(unsigned long)site->live_bytes, (unsigned long)site->peak_bytes, site->allocs, site->frees,
+					(unsigned long)site->total_bytes, site->allocs / elapsed);
+		else
+			fprintf(out, "%12lu %12lu %10lu %10lu %14lu %10lu  %s:%u (%s)\n",
+					(unsigned long)site->live_bytes, (unsigned long)site->peak_bytes, site->allocs, site->frees,
+					(unsigned long)site->total_bytes, site->allocs / elapsed, site->file, site->line, site->func);
+	}
+
+	free(sites);
+
+	return (AFC_ERR_NO_ERROR);
 }
 // }}}
-// {{{ _memtrack_find ( mt, mem )
-static int _memtrack_find(MemTracker *mt, void *mem)
+
+// {{{ _memtrack_shard ( mt, mem, hash )
+/* Hashes a pointer and returns its shard: the hash top bits choose the shard, the middle ones the bucket */
+static struct _mt_shard *_memtrack_shard(MemTracker *mt, void *mem, unsigned long long *hash)
 {
-	unsigned int t;
-	MemTrackData *hd;
+	*hash = ((unsigned long long)(uintptr_t)mem >> 4) * 0x9E3779B97F4A7C15ULL;
 
-	for (t = 0; t < mt->data_cur; t++)
-	{
-		hd = mt->data[t];
-		if (!hd)
-			continue;
+	return &mt->shards[(*hash >> 56) & (AFC_MEMTRACK_SHARDS - 1)];
+}
+// }}}
+// {{{ _memtrack_hash_insert ( sh, hd, hash )
+static void _memtrack_hash_insert(struct _mt_shard *sh, MemTrackData *hd, unsigned long long hash)
+{
+	unsigned int idx;
 
-		if (hd->mem == mem)
-			return t;
-	}
+	// Keep chains short: about two entries per bucket at most
+	if (sh->count >= sh->hash_size * 2)
+		_memtrack_hash_grow(sh);
 
-	return -1;
+	idx = _memtrack_bucket(sh, hash);
+	hd->hash_next = sh->hash_table[idx];
+	sh->hash_table[idx] = hd;
+	sh->count++;
 }
 // }}}
-// {{{ _memtrack_del ( mt, pos )
-static void _memtrack_del(MemTracker *mt, int pos)
+// {{{ _memtrack_hash_remove ( sh, mem, hash )
+static MemTrackData *_memtrack_hash_remove(struct _mt_shard *sh, void *mem, unsigned long long hash)
 {
-	int cur;
+	MemTrackData **pp = &sh->hash_table[_memtrack_bucket(sh, hash)];
+	MemTrackData *hd;
 
-	cur = ++mt->free_cur;
-	if (cur >= mt->free_max)
+	while ((hd = *pp) != NULL)
 	{
-		if (_memtrack_realloc_free(mt) != 0)
+		if (hd->mem == mem)
 		{
-			// Realloc failed - cannot track free slot
-			_afc_dprintf("WARNING: MemTracker: realloc failed for free list\n");
-			mt->free_cur--; // Undo increment
-			// Still clear the data slot
-			mt->data[pos] = NULL;
-			return;
+			*pp = hd->hash_next;
+			hd->hash_next = NULL;
+			sh->count--;
+			return hd;
 		}
+		pp = &hd->hash_next;
 	}
 
-	mt->data[pos] = NULL;
-
-	mt->free[cur] = pos;
+	return NULL;
 }
 // }}}
+// {{{ _memtrack_hash_find ( sh, mem, hash )
+static MemTrackData *_memtrack_hash_find(struct _mt_shard *sh, void *mem, unsigned long long hash)
+{
+	MemTrackData *hd = sh->hash_table[_memtrack_bucket(sh, hash)];
+
+	while (hd)
+	{
+		if (hd->mem == mem)
+			return hd;
+		hd = hd->hash_next;
+	}
 
-// {{{ _memtrack_realloc ( mt )
-static int _memtrack_realloc(MemTracker *mt)
+	return NULL;
+}
+// }}}
+// {{{ _memtrack_hash_grow ( sh )
+static void _memtrack_hash_grow(struct _mt_shard *sh)
 {
-	unsigned int new_max;
+	MemTrackData **table, *hd, *next;
+	unsigned long long hash;
+	unsigned int old_size = sh->hash_size;
+	unsigned int t, idx;
 
 	/* Check for integer overflow before doubling */
-	if (mt->data_max > UINT_MAX / 2)
-		return -1;
+	if (old_size > UINT_MAX / 4)
+		return;
+
+	// If there is no memory, just keep the longer chains
+	if ((table = calloc((size_t)old_size * 2, sizeof(MemTrackData *))) == NULL)
+		return;
+
+	sh->hash_size = old_size * 2;
 
-	new_max = mt->data_max * 2;
+	for (t = 0; t < old_size; t++)
+	{
+		for (hd = sh->hash_table[t]; hd; hd = next)
+		{
+			next = hd->hash_next;
+
+			hash = ((unsigned long long)(uintptr_t)hd->mem >> 4) * 0x9E3779B97F4A7C15ULL;
+			idx = _memtrack_bucket(sh, hash);
+
+			hd->hash_next = table[idx];
+			table[idx] = hd;
+		}
+	}
 
-	MemTrackData **new_data = realloc(mt->data, (size_t)new_max * sizeof(MemTrackData *));
-	if (new_data == NULL)
-		return -1; // Realloc failed, original pointer still valid
-	mt->data = new_data;
-	mt->data_max = new_max;
-	return 0;
+	free(sh->hash_table);
+	sh->hash_table = table;
 }
 // }}}
-// {{{ _memtrack_realloc_free ( mt )
-static int _memtrack_realloc_free(MemTracker *mt)
+// {{{ _memtrack_rehome ( mt, mem, new_mem )
+/* Moves the entry of mem to new_mem, that can belong to another shard */
+static void _memtrack_rehome(MemTracker *mt, void *mem, void *new_mem)
 {
-	int new_max;
+	struct _mt_shard *sh, *new_sh;
+	unsigned long long hash, new_hash;
+	MemTrackData *hd;
 
-	/* Check for integer overflow before doubling */
-	if (mt->free_max > INT_MAX / 2)
-		return -1;
+	if (mem == new_mem)
+		return;
+
+	sh = _memtrack_shard(mt, mem, &hash);
+	new_sh = _memtrack_shard(mt, new_mem, &new_hash);
+
+	_memtrack_lock(sh);
+	if ((hd = _memtrack_hash_remove(sh, mem, hash)) != NULL)
+		sh->alloc_bytes -= hd->size;
+	_memtrack_unlock(sh);
+
+	if (hd == NULL)
+		return;
 
-	new_max = mt->free_max * 2;
+	hd->mem = new_mem;
 
-	unsigned int *new_free = realloc(mt->free, (size_t)new_max * sizeof(unsigned int));
-	if (new_free == NULL)
-		return -1; // Realloc failed, original pointer still valid
-	mt->free = new_free;
-	mt->free_max = new_max;
-	return 0;
+	// allocs and frees are not touched: it is still the same block
+	_memtrack_lock(new_sh);
+	new_sh->alloc_bytes += hd->size;
+	_memtrack_hash_insert(new_sh, hd, new_hash);
+	_memtrack_unlock(new_sh);
 }
 // }}}
-// {{{ _free_item ( mt, d )
-static void _free_item(MemTracker *mt, MemTrackData *d)
+// {{{ _free_item ( d )
+static void _free_item(MemTrackData *d)
 {
 	if (!d)
 		return;
@@ -399,28 +659,76 @@ static void _free_item(MemTracker *mt, MemTrackData *d)
 	free(d);
 }
 // }}}
-
-// {{{ _afc_mem_tracker_update_pointer ( mt, old_mem, new_mem )
-void _afc_mem_tracker_update_pointer(MemTracker *mt, void *old_mem, void *new_mem)
+// {{{ _memtrack_site ( mt, file, func, line )
+/* Returns the counters of an allocation site, adding it the first time it is seen */
+static MemTrackSite *_memtrack_site(MemTracker *mt, const char *file, const char *func, unsigned int line)
 {
-	MemTrackData *hd;
-	int pos;
+	unsigned int idx = (unsigned int)((((uintptr_t)file >> 3) ^ line) * 2654435761U) & (AFC_MEMTRACK_SITES_SIZE - 1);
+	MemTrackSite *site;
 
-	if (old_mem == NULL)
-		return;
+	// file and func are compile-time literals: comparing the pointers is enough
+	for (site = __atomic_load_n(&mt->sites[idx], __ATOMIC_ACQUIRE); site; site = site->next)
+		if ((site->line == line) && (site->file == file) && (site->func == func))
+			return site;
 
 #ifndef MINGW
-	pthread_mutex_lock(&mt->mutex);
+	pthread_mutex_lock(&mt->sites_mutex);
 #endif
 
-	if ((pos = _memtrack_find(mt, old_mem)) != -1)
+	// Another thread may have added it in the meantime
+	for (site = mt->sites[idx]; site; site = site->next)
+		if ((site->line == line) && (site->file == file) && (site->func == func))
+			break;
+
+	if ((site == NULL) && ((site = calloc(1, sizeof(MemTrackSite))) != NULL))
 	{
-		hd = mt->data[pos];
-		hd->mem = new_mem;
+		site->file = file;
+		site->func = func;
+		site->line = line;
+		site->next = mt->sites[idx];
+
+		__atomic_store_n(&mt->sites[idx], site, __ATOMIC_RELEASE);
 	}
 
 #ifndef MINGW
-	pthread_mutex_unlock(&mt->mutex);
+	pthread_mutex_unlock(&mt->sites_mutex);
 #endif
+
+	return site;
+}
+// }}}
+// {{{ _memtrack_site_grow ( site, size )
+/* Adds size to the site live bytes, updating its peak */
+static void _memtrack_site_grow(MemTrackSite *site, size_t size)
+{
+	size_t live = _memtrack_atomic_add(&site->live_bytes, size);
+	size_t peak = _memtrack_atomic_load(&site->peak_bytes);
+
+	while ((live > peak) && !__atomic_compare_exchange_n(&site->peak_bytes, &peak, live, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+		;
+}
+// }}}
+// {{{ _memtrack_site_comp_* ( a, b )
+#define _memtrack_site_comp(field) \
+	(((const MemTrackSite *)b)->field > ((const MemTrackSite *)a)->field) - (((const MemTrackSite *)b)->field < ((const MemTrackSite *)a)->field)
+
+static int _memtrack_site_comp_live(const void *a, const void *b)
+{
+	return _memtrack_site_comp(live_bytes);
+}
+
+static int _memtrack_site_comp_peak(const void *a, const void *b)
+{
+	return _memtrack_site_comp(peak_bytes);
+}
+
+static int _memtrack_site_comp_allocs(const void *a, const void *b)
+{
+	return _memtrack_site_comp(allocs);
+}
+
+static int _memtrack_site_comp_total(const void *a, const void *b)
+{
+	return _memtrack_site_comp(total_bytes);
 }
 // }}}
@@ -17,6 +17,15 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
  */
+/*
+	- The tracker is split in AFC_MEMTRACK_SHARDS shards. This breaks code reading MemTracker fields:
+	  + allocs, frees and alloc_bytes are kept per shard: read them with afc_mem_tracker_allocs(),
+		afc_mem_tracker_frees() and afc_mem_tracker_alloc_bytes(), or all at once with afc_mem_tracker_get_stats().
+	  + data, free, data_max and free_max are gone, with no replacement: blocks are only kept in the shards
+		hash tables.
+
+	- Rework MemTracker to O(1) hash-based lookup
+*/
 #ifndef AFC_MEM_TRACKER_H
 #define AFC_MEM_TRACKER_H
 
@@ -24,6 +33,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <malloc.h>
+#include <time.h>
 
 #ifndef MINGW
 #include <pthread.h>
@@ -58,6 +68,43 @@ extern "C"
 		AFC_MEM_TRACKER_ADD_HEAD
 	};
 
+	/* Formats for afc_mem_tracker_report() */
+	enum
+	{
+		AFC_MEM_TRACKER_REPORT_TEXT = AFC_MEM_TRACKER_BASE + 0x10,
+		AFC_MEM_TRACKER_REPORT_CSV
+	};
+
+	/* Sort orders for afc_mem_tracker_report() (always from the biggest value) */
+	enum
+	{
+		AFC_MEM_TRACKER_SORT_LIVE = AFC_MEM_TRACKER_BASE + 0x20, /* Bytes currently allocated */
+		AFC_MEM_TRACKER_SORT_PEAK,								 /* Highest bytes allocated at the same time */
+		AFC_MEM_TRACKER_SORT_ALLOCS,							 /* Number of allocations */
+		AFC_MEM_TRACKER_SORT_TOTAL								 /* Bytes allocated since tracking started */
+	};
+
+	/* Allocation site: counters of all the blocks allocated at the same file and line */
+	struct _mt_site
+	{
+		const char *file;
+		const char *func;
+		unsigned int line;
+
+		unsigned long allocs;
+		unsigned long frees;
+		size_t live_bytes;
+		size_t peak_bytes;
+		size_t total_bytes;
+
+		struct _mt_site *next; /* Next site in the same bucket */
+	};
+
+	typedef struct _mt_site MemTrackSite;
+
+/* Buckets of the allocation sites table */
+#define AFC_MEMTRACK_SITES_SIZE 1024
+
 	struct _mt_data
 	{
 		void *mem;
@@ -65,35 +112,59 @@ extern "C"
 		const char *file;  /* Points to compile-time string literal, no strdup needed */
 		const char *func;  /* Points to compile-time string literal, no strdup needed */
 		unsigned int line;
+		MemTrackSite *site;			/* Allocation site counters */
 		struct _mt_data *hash_next; /* Next entry in hash bucket chain */
 	};
 
 	typedef struct _mt_data MemTrackData;
 
-#define AFC_MEMTRACK_HASH_SIZE 1024
+/* Allocations are spread among AFC_MEMTRACK_SHARDS shards, each one with its own lock */
+#define AFC_MEMTRACK_SHARDS 16
 
-	struct _memtrack
+/* Initial hash buckets of every shard: they double when a shard gets crowded */
+#define AFC_MEMTRACK_HASH_SIZE 64
+
+	struct _mt_shard
 	{
-		MemTrackData **data;
-		unsigned int data_cur;
-		unsigned int data_max;
+		MemTrackData **hash_table; /* Hash table for O(1) pointer lookup */
+		unsigned int hash_size;	   /* Buckets in hash_table (power of 2) */
+		unsigned int count;		   /* Blocks tracked by this shard */
 
-		unsigned int *free;
-		int free_cur;
-		int free_max;
+		unsigned long allocs;
+		unsigned long frees;
+		size_t alloc_bytes;
 
-		MemTrackData *hash_table[AFC_MEMTRACK_HASH_SIZE]; /* Hash table for O(1) pointer lookup */
+#ifndef MINGW
+		pthread_mutex_t mutex; /* Mutex for thread-safe access to this shard only */
+#endif
+	};
 
-		char show_mallocs;
-		char show_frees;
+	struct _mt_stats
+	{
+		unsigned long allocs; /* Blocks allocated since tracking started */
+		unsigned long frees;  /* Blocks freed since tracking started */
+		unsigned long blocks; /* Blocks currently allocated */
+		size_t alloc_bytes;	  /* Bytes currently allocated */
+	};
+
+	typedef struct _mt_stats MemTrackerStats;
 
-		unsigned int allocs;
-		unsigned int frees;
-		unsigned int alloc_bytes;
+	struct _memtrack
+	{
+		struct _mt_shard shards[AFC_MEMTRACK_SHARDS];
 
+		/* Sites are only added: lookups need no lock, site counters are updated atomically */
+		MemTrackSite *sites[AFC_MEMTRACK_SITES_SIZE];
 #ifndef MINGW
-		pthread_mutex_t mutex; /* Mutex for thread-safe access */
+		pthread_mutex_t sites_mutex; /* Taken only to add a new site */
 #endif
+		time_t started;
+
+		char show_mallocs;
+		char show_frees;
+
+		FILE *report_file; /* Where afc_delete() writes the report (NULL for none) */
+		int report_format;
 	};
 
 	typedef struct _memtrack MemTracker;
@@ -110,6 +181,11 @@ extern "C"
 	void _afc_mem_tracker_free(MemTracker *, void *mem, const char *file, const char *func, const unsigned int line);
 	void _afc_mem_tracker_update_size(MemTracker *mt, void *mem, void *new_mem, size_t size, const char *file, const char *func, const unsigned int line);
 	void _afc_mem_tracker_update_pointer(MemTracker *mt, void *old_mem, void *new_mem);
+	int afc_mem_tracker_get_stats(MemTracker *mt, MemTrackerStats *stats);
+	unsigned long afc_mem_tracker_allocs(MemTracker *mt);
+	unsigned long afc_mem_tracker_frees(MemTracker *mt);
+	size_t afc_mem_tracker_alloc_bytes(MemTracker *mt);
+	int afc_mem_tracker_report(MemTracker *mt, FILE *out, int format, int sort);
 	// int afc_mem_tracker_dump_stats ( MemTracker * mt, char detailed );
 
 #ifdef __cplusplus
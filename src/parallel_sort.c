@@ -0,0 +1,511 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <unistd.h>
+
+#include "parallel_sort.h"
+
+// {{{ docs
+/*
+@config
+	TITLE:     Parallel Sort
+	VERSION:   1.01
+	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
+@endnode
+
+@node quote
+	*Many hands make light work.*
+
+		John Heywood
+@endnode
+
+@node history
+	- 1.01:		ADD: afc_parallel_sort_slices() function
+	- 1.00:		Initial Release
+@endnode
+
+@node intro
+Parallel Sort is a merge sort that splits big sorts among many threads: every thread sorts a slice of the items, then
+the sorted slices are merged in rounds, with every round split again among all the threads. Sorts smaller than
+AFC_PARALLEL_SORT_MIN_ITEMS items per thread run in the calling thread.
+
+afc_parallel_sort() has the same arguments of qsort() and it is the default sort routine of Array (see afc_array_sort()).
+afc_parallel_sort_r() passes an extra argument to the compare function and it is used by afc_list_sort(),
+afc_list_fast_sort() and afc_list_ultra_sort().
+
+afc_parallel_sort_slices() lets the caller sort the slices with a routine of its own, specialized for its items:
+StringList uses it to sort every slice with a string sort that does not call any compare function.
+
+The sort is stable: items that compare equal keep their order. The compare function is called by many threads at
+the same time, so it must not change any shared data.
+
+By default, a sort uses as many threads as online CPUs. Use afc_parallel_sort_set_threads() to change it.
+@endnode
+*/
+// }}}
+
+static const char class_name[] = "Parallel Sort";
+
+struct afc_parallel_sort_internal_job
+{
+	int (*comp)(const void *, const void *, void *);
+	void (*slice_sort)(void *, size_t, void *);
+	void *info;
+	size_t size;
+
+	char *a; // Items to sort, or first run to merge
+	char *b; // Second run to merge, NULL for a sort
+	char *dst; // Merge destination, or scratch memory of a sort
+	size_t na;
+	size_t nb;
+
+	pthread_t thread;
+	BOOL started;
+};
+
+struct afc_parallel_sort_internal_qsort_info
+{
+	int (*comp)(const void *, const void *);
+};
+
+static int afc_parallel_sort_max_threads = 0;
+
+static void *afc_parallel_sort_internal_worker(void *data);
+static void afc_parallel_sort_internal_run(struct afc_parallel_sort_internal_job *jobs, int num_jobs);
+static void afc_parallel_sort_internal_merge_sort(struct afc_parallel_sort_internal_job *job);
+static void afc_parallel_sort_internal_merge(const char *a, size_t na, const char *b, size_t nb, char *dst, size_t size, int (*comp)(const void *, const void *, void *), void *info);
+static size_t afc_parallel_sort_internal_corank(size_t k, const char *a, size_t na, const char *b, size_t nb, size_t size, int (*comp)(const void *, const void *, void *), void *info);
+static int afc_parallel_sort_internal_qsort_comp(const void *a, const void *b, void *info);
+
+/* Items are almost always pointers: a constant size copy becomes a single move */
+#define afc_parallel_sort_internal_copy(dst, src, size) \
+	if ((size) == sizeof(void *))                       \
+		memcpy((dst), (src), sizeof(void *));           \
+	else                                                \
+		memcpy((dst), (src), (size))
+
+// {{{ afc_parallel_sort ( base, nmemb, size, comp )
+/*
+@node afc_parallel_sort
+
+			 NAME: afc_parallel_sort ( base, nmemb, size, comp )    - Sorts an array using many threads
+
+		 SYNOPSIS: void afc_parallel_sort ( void * base, size_t nmemb, size_t size, int ( * comp ) ( const void *, const void * ) )
+
+	  DESCRIPTION: This function sorts an array of /nmemb/ items, /size/ bytes each, just like qsort(). Arrays big
+				   enough to be split among many threads are sorted with afc_parallel_sort_r(), smaller ones with
+				   qsort() in the calling thread.
+
+			INPUT: - base	- Pointer to the first item of the array.
+				   - nmemb	- Number of items.
+				   - size	- Size of every item, in bytes.
+				   - comp	- Compare function, just like the one of qsort().
+
+		  RESULTS: None.
+
+			NOTES: - If there is not enough memory for the parallel sort, the array is sorted with qsort().
+
+		 SEE ALSO: - afc_parallel_sort_r()
+				   - afc_array_sort()
+@endnode
+*/
+void afc_parallel_sort(void *base, size_t nmemb, size_t size, int (*comp)(const void *, const void *))
+{
+	struct afc_parallel_sort_internal_qsort_info qi;
+
+	qi.comp = comp;
+
+	if ((afc_parallel_sort_threads(nmemb) < 2) || (afc_parallel_sort_r(base, nmemb, size, afc_parallel_sort_internal_qsort_comp, &qi) != AFC_ERR_NO_ERROR))
+		qsort(base, nmemb, size, comp);
+}
+// }}}
+// {{{ afc_parallel_sort_r ( base, nmemb, size, comp, info )
+/*
+@node afc_parallel_sort_r
+
+			 NAME: afc_parallel_sort_r ( base, nmemb, size, comp, info )    - Sorts an array using many threads
+
+		 SYNOPSIS: int afc_parallel_sort_r ( void * base, size_t nmemb, size_t size, int ( * comp ) ( const void *, const void *, void * ), void * info )
+
+	  DESCRIPTION: This function sorts an array of /nmemb/ items, /size/ bytes each, with a stable merge sort split
+				   among afc_parallel_sort_threads() threads. /info/ is passed to every call of the compare function.
+
+			INPUT: - base	- Pointer to the first item of the array.
+				   - nmemb	- Number of items.
+				   - size	- Size of every item, in bytes.
+				   - comp	- Compare function: it gets pointers to two items and /info/, and returns a value less
+							  than, equal to or greater than zero, like the one of qsort().
+				   - info	- Any value you like.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_ERR_NO_MEMORY if there is not enough memory: the array is not changed.
+
+			NOTES: - The sort needs a temporary copy of the array.
+
+		 SEE ALSO: - afc_parallel_sort()
+				   - afc_parallel_sort_set_threads()
+@endnode
+*/
+int afc_parallel_sort_r(void *base, size_t nmemb, size_t size, int (*comp)(const void *, const void *, void *), void *info)
+{
+	return (afc_parallel_sort_slices(base, nmemb, size, comp, NULL, info));
+}
+// }}}
+// {{{ afc_parallel_sort_slices ( base, nmemb, size, comp, slice_sort, info )
+/*
+@node afc_parallel_sort_slices
+
+			 NAME: afc_parallel_sort_slices ( base, nmemb, size, comp, slice_sort, info )    - Sorts an array using many threads
+
+		 SYNOPSIS: int afc_parallel_sort_slices ( void * base, size_t nmemb, size_t size, int ( * comp ) ( const void *, const void *, void * ), void ( * slice_sort ) ( void *, size_t, void * ), void * info )
+
+			SINCE: 1.01
+
+	  DESCRIPTION: This function works like afc_parallel_sort_r(), but every thread sorts its slice of the array calling
+				   /slice_sort/ with the first item of the slice, the number of items and /info/. /comp/ is used
+				   only to merge the sorted slices.
+
+			INPUT: - base		- Pointer to the first item of the array.
+				   - nmemb		- Number of items.
+				   - size		- Size of every item, in bytes.
+				   - comp		- Compare function, like the one of afc_parallel_sort_r().
+				   - slice_sort	- Sort routine for the slices, or NULL to use the merge sort of afc_parallel_sort_r().
+				   - info		- Any value you like.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_ERR_NO_MEMORY if there is not enough memory: the array is not changed.
+
+			NOTES: - /slice_sort/ must sort the slice in the same order of /comp/. If it is not stable, neither is
+					 the whole sort.
+
+		 SEE ALSO: - afc_parallel_sort_r()
+@endnode
+*/
+int afc_parallel_sort_slices(void *base, size_t nmemb, size_t size, int (*comp)(const void *, const void *, void *), void (*slice_sort)(void *, size_t, void *), void *info)
+{
+	struct afc_parallel_sort_internal_job jobs[AFC_PARALLEL_SORT_MAX_THREADS];
+	struct afc_parallel_sort_internal_job *job;
+	char *tmp, *src, *dst, *swap;
+	size_t chunk, width, lo, na, nb, k0, k1, i0, i1, total;
+	int threads, num_jobs, pairs, parts, p;
+
+	if ((base == NULL) || (comp == NULL))
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+
+	if ((nmemb < 2) || (size == 0))
+		return (AFC_ERR_NO_ERROR);
+
+	if (nmemb > ((size_t)~0) / size)
+		return (AFC_LOG_FAST(AFC_ERR_NO_MEMORY));
+
+	if ((tmp = afc_malloc_uninit(nmemb * size)) == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NO_MEMORY));
+
+	threads = afc_parallel_sort_threads(nmemb);
+	chunk = (nmemb + threads - 1) / threads;
+
+	/* Every thread sorts a slice of the array */
+	num_jobs = 0;
+	for (lo = 0; lo < nmemb; lo += chunk)
+	{
+		job = &jobs[num_jobs++];
+		job->comp = comp;
+		job->slice_sort = slice_sort;
+		job->info = info;
+		job->size = size;
+		job->a = (char *)base + lo * size;
+		job->b = NULL;
+		job->dst = tmp + lo * size;
+		job->na = (nmemb - lo < chunk) ? nmemb - lo : chunk;
+		job->nb = 0;
+	}
+
+	afc_parallel_sort_internal_run(jobs, num_jobs);
+
+	/* Pairs of sorted slices are merged until one is left, every merge split in parts of the same size */
+	src = base;
+	dst = tmp;
+
+	for (width = chunk; width < nmemb; width *= 2)
+	{
+		pairs = (int)((nmemb + 2 * width - 1) / (2 * width));
+		parts = (threads > pairs) ? threads / pairs : 1;
+		num_jobs = 0;
+
+		for (lo = 0; lo < nmemb; lo += 2 * width)
+		{
+			na = (nmemb - lo < width) ? nmemb - lo : width;
+			nb = (nmemb - lo - na < width) ? nmemb - lo - na : width;
+			total = na + nb;
+
+			for (p = 0; p < parts; p++)
+			{
+				k0 = total * p / parts;
+				k1 = total * (p + 1) / parts;
+				i0 = afc_parallel_sort_internal_corank(k0, src + lo * size, na, src + (lo + na) * size, nb, size, comp, info);
+				i1 = afc_parallel_sort_internal_corank(k1, src + lo * size, na, src + (lo + na) * size, nb, size, comp, info);
+
+				job = &jobs[num_jobs++];
+				job->comp = comp;
+				job->info = info;
+				job->size = size;
+				job->a = src + (lo + i0) * size;
+				job->na = i1 - i0;
+				job->b = src + (lo + na + k0 - i0) * size;
+				job->nb = (k1 - i1) - (k0 - i0);
+				job->dst = dst + (lo + k0) * size;
+			}
+		}
+
+		afc_parallel_sort_internal_run(jobs, num_jobs);
+
+		swap = src;
+		src = dst;
+		dst = swap;
+	}
+
+	if (src != base)
+		memcpy(base, src, nmemb * size);
+
+	afc_free(tmp);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_parallel_sort_threads ( nmemb )
+/*
+@node afc_parallel_sort_threads
+
+			 NAME: afc_parallel_sort_threads ( nmemb )    - Returns the number of threads of a sort
+
+		 SYNOPSIS: int afc_parallel_sort_threads ( size_t nmemb )
+
+	  DESCRIPTION: This function returns the number of threads used to sort /nmemb/ items: every thread gets at
+				   least AFC_PARALLEL_SORT_MIN_ITEMS items, up to the limit set by afc_parallel_sort_set_threads().
+
+			INPUT: - nmemb	- Number of items to sort.
+
+		  RESULTS: the number of threads, 1 if the sort runs in the calling thread.
+
+		 SEE ALSO: - afc_parallel_sort_set_threads()
+@endnode
+*/
+int afc_parallel_sort_threads(size_t nmemb)
+{
+	long threads = afc_parallel_sort_max_threads;
+
+	if (threads == 0)
+	{
+#ifdef _SC_NPROCESSORS_ONLN
+		threads = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+		threads = 1;
+#endif
+	}
+
+	if ((size_t)threads > nmemb / AFC_PARALLEL_SORT_MIN_ITEMS)
+		threads = (long)(nmemb / AFC_PARALLEL_SORT_MIN_ITEMS);
+
+	if (threads > AFC_PARALLEL_SORT_MAX_THREADS)
+		threads = AFC_PARALLEL_SORT_MAX_THREADS;
+
+	return ((threads < 1) ? 1 : (int)threads);
+}
+// }}}
+// {{{ afc_parallel_sort_set_threads ( threads )
+/*
+@node afc_parallel_sort_set_threads
+
+			 NAME: afc_parallel_sort_set_threads ( threads )    - Sets the maximum number of threads of a sort
+
+		 SYNOPSIS: int afc_parallel_sort_set_threads ( int threads )
+
+	  DESCRIPTION: This function sets the maximum number of threads used by every sort, for all the program.
+
+			INPUT: - threads	- Maximum number of threads. 0 means as many as online CPUs (the default), 1 means
+								  that sorts always run in the calling thread.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_ERR_INVALID_POINTER if /threads/ is negative.
+
+			NOTES: - Do not call this function while other threads are sorting.
+
+		 SEE ALSO: - afc_parallel_sort_threads()
+@endnode
+*/
+int afc_parallel_sort_set_threads(int threads)
+{
+	if (threads < 0)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	afc_parallel_sort_max_threads = threads;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+
+/* =====================================================================================
+	 INTERNAL FUNCTIONS
+===================================================================================== */
+// {{{ afc_parallel_sort_internal_worker ( data )
+static void *afc_parallel_sort_internal_worker(void *data)
+{
+	struct afc_parallel_sort_internal_job *job = (struct afc_parallel_sort_internal_job *)data;
+
+	if (job->b != NULL)
+		afc_parallel_sort_internal_merge(job->a, job->na, job->b, job->nb, job->dst, job->size, job->comp, job->info);
+	else if (job->slice_sort)
+		job->slice_sort(job->a, job->na, job->info);
+	else
+		afc_parallel_sort_internal_merge_sort(job);
+
+	return (NULL);
+}
+// }}}
+// {{{ afc_parallel_sort_internal_run ( jobs, num_jobs )
+/* Runs the first job in the calling thread and the others in new threads (or in the calling thread, if a thread cannot be created) */
+static void afc_parallel_sort_internal_run(struct afc_parallel_sort_internal_job *jobs, int num_jobs)
+{
+	int t;
+
+	for (t = 1; t < num_jobs; t++)
+		jobs[t].started = (pthread_create(&jobs[t].thread, NULL, afc_parallel_sort_internal_worker, &jobs[t]) == 0);
+
+	afc_parallel_sort_internal_worker(&jobs[0]);
+
+	for (t = 1; t < num_jobs; t++)
+	{
+		if (jobs[t].started)
+			pthread_join(jobs[t].thread, NULL);
+		else
+			afc_parallel_sort_internal_worker(&jobs[t]);
+	}
+}
+// }}}
+// {{{ afc_parallel_sort_internal_merge_sort ( job )
+/* Bottom up merge sort of job->a, using job->dst as scratch memory: runs of AFC_PARALLEL_SORT_RUN items are sorted in place first */
+static void afc_parallel_sort_internal_merge_sort(struct afc_parallel_sort_internal_job *job)
+{
+	size_t size = job->size, n = job->na, lo, na, nb, width, t;
+	char *src = job->a, *dst = job->dst, *p, *swap;
+	char *end = job->a + n * size, *run_end, c;
+	void *ptr;
+
+	for (lo = 0; lo < n; lo += AFC_PARALLEL_SORT_RUN)
+	{
+		run_end = job->a + ((n - lo < AFC_PARALLEL_SORT_RUN) ? n : lo + AFC_PARALLEL_SORT_RUN) * size;
+
+		for (p = job->a + (lo + 1) * size; p < run_end; p += size)
+		{
+			for (swap = p; (swap > job->a + lo * size) && (job->comp(swap - size, swap, job->info) > 0); swap -= size)
+			{
+				if (size == sizeof(void *))
+				{
+					memcpy(&ptr, swap, sizeof(void *));
+					memcpy(swap, swap - size, sizeof(void *));
+					memcpy(swap - size, &ptr, sizeof(void *));
+				}
+				else
+				{
+					for (t = 0; t < size; t++)
+					{
+						c = swap[t];
+						swap[t] = swap[t - size];
+						swap[t - size] = c;
+					}
+				}
+			}
+		}
+	}
+
+	for (width = AFC_PARALLEL_SORT_RUN; width < n; width *= 2)
+	{
+		for (lo = 0; lo < n; lo += 2 * width)
+		{
+			na = (n - lo < width) ? n - lo : width;
+			nb = (n - lo - na < width) ? n - lo - na : width;
+
+			afc_parallel_sort_internal_merge(src + lo * size, na, src + (lo + na) * size, nb, dst + lo * size, size, job->comp, job->info);
+		}
+
+		swap = src;
+		src = dst;
+		dst = swap;
+	}
+
+	if (src != job->a)
+		memcpy(job->a, src, end - job->a);
+}
+// }}}
+// {{{ afc_parallel_sort_internal_merge ( a, na, b, nb, dst, size, comp, info )
+/* Stable merge of two sorted runs: on equal items, the one in a comes first */
+static void afc_parallel_sort_internal_merge(const char *a, size_t na, const char *b, size_t nb, char *dst, size_t size, int (*comp)(const void *, const void *, void *), void *info)
+{
+	const char *a_end = a + na * size, *b_end = b + nb * size;
+
+	while ((a < a_end) && (b < b_end))
+	{
+		if (comp(b, a, info) < 0)
+		{
+			afc_parallel_sort_internal_copy(dst, b, size);
+			b += size;
+		}
+		else
+		{
+			afc_parallel_sort_internal_copy(dst, a, size);
+			a += size;
+		}
+
+		dst += size;
+	}
+
+	if (a < a_end)
+		memcpy(dst, a, a_end - a);
+	else if (b < b_end)
+		memcpy(dst, b, b_end - b);
+}
+// }}}
+// {{{ afc_parallel_sort_internal_corank ( k, a, na, b, nb, size, comp, info )
+/* Returns how many items of a are among the first k items of the merge of a and b */
+static size_t afc_parallel_sort_internal_corank(size_t k, const char *a, size_t na, const char *b, size_t nb, size_t size, int (*comp)(const void *, const void *, void *), void *info)
+{
+	size_t low = (k > nb) ? k - nb : 0;
+	size_t high = (k < na) ? k : na;
+	size_t i;
+
+	while (low < high)
+	{
+		i = low + (high - low) / 2;
+
+		/* a[i] goes before b[k-i-1]: it is among the first k items */
+		if (comp(b + (k - i - 1) * size, a + i * size, info) >= 0)
+			low = i + 1;
+		else
+			high = i;
+	}
+
+	return (low);
+}
+// }}}
+// {{{ afc_parallel_sort_internal_qsort_comp ( a, b, info )
+static int afc_parallel_sort_internal_qsort_comp(const void *a, const void *b, void *info)
+{
+	return (((struct afc_parallel_sort_internal_qsort_info *)info)->comp(a, b));
+}
+// }}}
@@ -0,0 +1,53 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef AFC_PARALLEL_SORT_H
+#define AFC_PARALLEL_SORT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "base.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* Minimum number of items sorted by every thread: smaller sorts run in the calling thread */
+#define AFC_PARALLEL_SORT_MIN_ITEMS 32768
+
+/* Maximum number of threads used by a single sort */
+#define AFC_PARALLEL_SORT_MAX_THREADS 64
+
+/* Items sorted with an insertion sort before merging */
+#define AFC_PARALLEL_SORT_RUN 16
+
+	void afc_parallel_sort(void *base, size_t nmemb, size_t size, int (*comp)(const void *, const void *));
+	int afc_parallel_sort_r(void *base, size_t nmemb, size_t size, int (*comp)(const void *, const void *, void *), void *info);
+	int afc_parallel_sort_slices(void *base, size_t nmemb, size_t size, int (*comp)(const void *, const void *, void *), void (*slice_sort)(void *, size_t, void *), void *info);
+	int afc_parallel_sort_threads(size_t nmemb);
+	int afc_parallel_sort_set_threads(int threads);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,515 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "pool.h"
+
+// {{{ docs
+/*
+@config
+	TITLE:     Pool
+	VERSION:   1.01
+	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
+@endnode
+
+@node quote
+	*Waste not, want not.*
+
+		Proverb
+@endnode
+
+@node history
+	- 1.01:		Blocks are taken from afc_malloc() when MemTracker is active. Added afc_pool_clear()
+	- 1.00:		Initial Release
+@endnode
+
+@node intro
+Pool is the small objects allocator used internally by List, StringList, CircularList, Hash and the tree classes
+for their nodes. Lists and trees allocate and free one small block for every item: the Pool keeps the freed
+blocks, grouped in size classes of AFC_POOL_ALIGN bytes, and gives them back on the next allocation of the same size.
+
+Every thread has its own cache of free objects, so afc_pool_alloc() and afc_pool_free() do not need any lock;
+only when a thread cache is empty (or too full) a batch of AFC_POOL_BATCH objects is moved from (or to) the pool
+shared by all the threads. New objects are carved from blocks of AFC_POOL_BLOCK_SIZE bytes.
+
+Objects bigger than AFC_POOL_MAX_SIZE bytes are not pooled: afc_pool_alloc() and afc_pool_free() just call
+afc_malloc() and afc_free() for them.
+
+afc_pool_get_stats() tells how well the Pool is doing. afc_pool_clear(), called by afc_delete(), gives the blocks
+back to the system.
+
+Please, remember that:
+
+  - memory returned by afc_pool_alloc() is *not* cleared.
+  - memory must be released with afc_pool_free(), passing the same size used for afc_pool_alloc().
+  - pooled objects are not seen one by one by MemTracker: when it is active, the blocks are taken from afc_malloc(),
+	so a block still holding an object after afc_pool_clear() shows up in the MemTracker report (and in leak checkers).
+  - if AFC is compiled with *AFC_POOL_DISABLE* defined (or for MINGW), the Pool just calls afc_malloc() and afc_free():
+	this is useful to find memory errors with tools like valgrind.
+@endnode
+*/
+// }}}
+
+static const char class_name[] = "Pool";
+
+#if !defined(MINGW) && !defined(AFC_POOL_DISABLE)
+
+struct afc_pool_cache
+{
+	void *free[AFC_POOL_CLASSES];
+	unsigned int count[AFC_POOL_CLASSES];
+
+	unsigned long hits;
+	unsigned long refills;
+
+	BOOL registered; // TRUE when the thread exit destructor has been set
+};
+
+/* Header of every block: it takes the first AFC_POOL_ALIGN bytes */
+struct afc_pool_block
+{
+	struct afc_pool_block *next;
+	unsigned int c;	  // Size class of the objects carved from the block
+	BOOL tracked; // TRUE when the block comes from afc_malloc()
+};
+
+static __thread struct afc_pool_cache afc_pool_cache;
+
+static pthread_mutex_t afc_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t afc_pool_once = PTHREAD_ONCE_INIT;
+static pthread_key_t afc_pool_key;
+
+/* Shared pool: protected by afc_pool_mutex */
+static void *afc_pool_shared[AFC_POOL_CLASSES];
+static struct afc_pool_block *afc_pool_blocks;
+static PoolStats afc_pool_totals; // Stats of the exited threads, blocks and bytes
+
+static int afc_pool_internal_refill(struct afc_pool_cache *cache, unsigned int c);
+static int afc_pool_internal_block_new(unsigned int c);
+static void afc_pool_internal_flush(struct afc_pool_cache *cache, unsigned int c, unsigned int num);
+static void afc_pool_internal_thread_exit(void *data);
+static void afc_pool_internal_key_create(void);
+static int afc_pool_internal_block_comp(const void *a, const void *b);
+
+/* Free objects are chained using their first word */
+#define afc_pool_internal_next(mem) (*(void **)(mem))
+#define afc_pool_internal_class(size) (((size) - 1) / AFC_POOL_ALIGN)
+#define afc_pool_internal_per_block(c) ((AFC_POOL_BLOCK_SIZE - AFC_POOL_ALIGN) / (((c) + 1) * AFC_POOL_ALIGN))
+
+#endif
+
+// {{{ afc_pool_alloc ( size )
+/*
+@node afc_pool_alloc
+
+			 NAME: afc_pool_alloc ( size ) - Allocates a small object
+
+		 SYNOPSIS: void * afc_pool_alloc ( size_t size )
+
+			SINCE: 1.00
+
+	  DESCRIPTION: This function returns a block of memory /size/ bytes long, taking it from the current thread
+				   cache when possible.
+
+			INPUT: - size	- Size of the memory block.
+
+		  RESULTS: a pointer to the memory block, or NULL in case of errors.
+
+			NOTES: - The memory is *not* cleared.
+				   - Memory must be released with afc_pool_free(), using the same /size/.
+
+		 SEE ALSO: - afc_pool_free()
+				   - afc_pool_get_stats()
+@endnode
+*/
+void *afc_pool_alloc(size_t size)
+{
+#if defined(MINGW) || defined(AFC_POOL_DISABLE)
+	return (afc_malloc(size));
+#else
+	struct afc_pool_cache *cache = &afc_pool_cache;
+	unsigned int c;
+	void *mem;
+
+	if ((size == 0) || (size > AFC_POOL_MAX_SIZE))
+		return (afc_malloc(size));
+
+	c = afc_pool_internal_class(size);
+
+	if ((mem = cache->free[c]) != NULL)
+		cache->hits++;
+	else
+	{
+		if (afc_pool_internal_refill(cache, c) != AFC_ERR_NO_ERROR)
+		{
+			AFC_LOG_FAST(AFC_ERR_NO_MEMORY);
+			return (NULL);
+		}
+
+		mem = cache->free[c];
+	}
+
+	cache->free[c] = afc_pool_internal_next(mem);
+	cache->count[c]--;
+
+	return (mem);
+#endif
+}
+// }}}
+// {{{ afc_pool_free ( mem, size )
+/*
+@node afc_pool_free
+
+			 NAME: afc_pool_free ( mem, size ) - Releases a small object
+
+		 SYNOPSIS: void afc_pool_free ( void * mem, size_t size )
+
+			SINCE: 1.00
+
+	  DESCRIPTION: This function gives back to the Pool memory returned by afc_pool_alloc().
+				   The memory goes in the current thread cache: if it grows too much, part of it is
+				   moved to the pool shared with the other threads.
+
+			INPUT: - mem	- Pointer to the memory to release. It can be NULL.
+				   - size	- The size passed to afc_pool_alloc().
+
+		  RESULTS: NONE
+
+		 SEE ALSO: - afc_pool_alloc()
+@endnode
+*/
+void afc_pool_free(void *mem, size_t size)
+{
+#if defined(MINGW) || defined(AFC_POOL_DISABLE)
+	if (mem)
+		afc_free(mem);
+#else
+	struct afc_pool_cache *cache = &afc_pool_cache;
+	unsigned int c;
+
+	if (mem == NULL)
+		return;
+
+	if ((size == 0) || (size > AFC_POOL_MAX_SIZE))
+	{
+		afc_free(mem);
+		return;
+	}
+
+	c = afc_pool_internal_class(size);
+
+	afc_pool_internal_next(mem) = cache->free[c];
+	cache->free[c] = mem;
+
+	if (++cache->count[c] > AFC_POOL_CACHE_MAX)
+		afc_pool_internal_flush(cache, c, AFC_POOL_BATCH);
+#endif
+}
+// }}}
+// {{{ afc_pool_get_stats ( stats )
+/*
+@node afc_pool_get_stats
+
+			 NAME: afc_pool_get_stats ( stats ) - Returns the Pool statistics
+
+		 SYNOPSIS: int afc_pool_get_stats ( PoolStats * stats )
+
+			SINCE: 1.00
+
+	  DESCRIPTION: This function fills /stats/ with the Pool statistics:
+
+				   - hits: allocations served by the thread cache, without any lock.
+				   - refills: times a thread cache had to take objects from the shared pool.
+				   - blocks: number of blocks asked to the system.
+				   - bytes_held: memory held by the Pool, both in use and free.
+
+			INPUT: - stats	- Pointer to the PoolStats structure to fill.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+
+			NOTES: - /hits/ and /refills/ count the calling thread and the threads already exited.
+				   - When the Pool is disabled, all the values are zero.
+
+		 SEE ALSO: - afc_pool_alloc()
+				   - afc_pool_clear()
+@endnode
+*/
+int afc_pool_get_stats(PoolStats *stats)
+{
+	if (stats == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+
+#if defined(MINGW) || defined(AFC_POOL_DISABLE)
+	memset(stats, 0, sizeof(PoolStats));
+#else
+	pthread_mutex_lock(&afc_pool_mutex);
+	*stats = afc_pool_totals;
+	pthread_mutex_unlock(&afc_pool_mutex);
+
+	stats->hits += afc_pool_cache.hits;
+	stats->refills += afc_pool_cache.refills;
+#endif
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+
+// {{{ afc_pool_clear ()
+/*
+@node afc_pool_clear
+
+			 NAME: afc_pool_clear () - Gives the Pool blocks back to the system
+
+		 SYNOPSIS: int afc_pool_clear ( void )
+
+			SINCE: 1.01
+
+	  DESCRIPTION: This function frees all the blocks of the Pool and resets its statistics.
+				   The objects cached by the calling thread are given back first; a block still holding
+				   objects in use is not freed, because they have been leaked by the caller: it is left
+				   out of the Pool, so MemTracker (when active) and leak checkers report it.
+
+			INPUT: NONE
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_ERR_NO_MEMORY if there is no memory to check the blocks: nothing is freed.
+
+			NOTES: - afc_delete() calls this function.
+				   - No other thread must be using the Pool: objects cached by running threads count as in use.
+				   - The Pool can be used again after this call.
+
+		 SEE ALSO: - afc_pool_get_stats()
+				   - afc_delete()
+@endnode
+*/
+int afc_pool_clear(void)
+{
+#if !defined(MINGW) && !defined(AFC_POOL_DISABLE)
+	struct afc_pool_cache *cache = &afc_pool_cache;
+	struct afc_pool_block **blocks, *block;
+	unsigned int *used;
+	unsigned long num = 0, lo, hi, mid, t;
+	unsigned int c;
+	void *mem;
+
+	for (c = 0; c < AFC_POOL_CLASSES; c++)
+		afc_pool_internal_flush(cache, c, cache->count[c]);
+
+	pthread_mutex_lock(&afc_pool_mutex);
+
+	for (block = afc_pool_blocks; block != NULL; block = block->next)
+		num++;
+
+	blocks = malloc((num + 1) * sizeof(struct afc_pool_block *));
+	used = malloc((num + 1) * sizeof(unsigned int));
+
+	if ((blocks == NULL) || (used == NULL))
+	{
+		pthread_mutex_unlock(&afc_pool_mutex);
+		free(blocks);
+		free(used);
+		return (AFC_LOG_FAST(AFC_ERR_NO_MEMORY));
+	}
+
+	for (t = 0, block = afc_pool_blocks; block != NULL; block = block->next, t++)
+		blocks[t] = block;
+
+	qsort(blocks, num, sizeof(struct afc_pool_block *), afc_pool_internal_block_comp);
+
+	for (t = 0; t < num; t++)
+		used[t] = afc_pool_internal_per_block(blocks[t]->c);
+
+	// Every free object makes its block less used: it lives in the last block starting before it
+	for (c = 0; c < AFC_POOL_CLASSES; c++)
+		for (mem = afc_pool_shared[c]; mem != NULL; mem = afc_pool_internal_next(mem))
+		{
+			lo = 0;
+			hi = num;
+			while (hi - lo > 1)
+			{
+				mid = (lo + hi) / 2;
+				if ((char *)blocks[mid] <= (char *)mem)
+					lo = mid;
+				else
+					hi = mid;
+			}
+
+			used[lo]--;
+		}
+
+	for (t = 0; t < num; t++)
+	{
+		if (used[t] != 0)
+			continue;
+
+		if (blocks[t]->tracked)
+			afc_free(blocks[t]);
+		else
+			free(blocks[t]);
+	}
+
+	free(blocks);
+	free(used);
+
+	memset(afc_pool_shared, 0, sizeof(afc_pool_shared));
+	memset(&afc_pool_totals, 0, sizeof(PoolStats));
+	afc_pool_blocks = NULL;
+
+	pthread_mutex_unlock(&afc_pool_mutex);
+
+	cache->hits = 0;
+	cache->refills = 0;
+#endif
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+
+/* ===============================================================================================================
+	INTERNAL FUNCTIONS
+=============================================================================================================== */
+#if !defined(MINGW) && !defined(AFC_POOL_DISABLE)
+// {{{ afc_pool_internal_refill ( cache, c )
+static int afc_pool_internal_refill(struct afc_pool_cache *cache, unsigned int c)
+{
+	unsigned int t;
+	void *mem;
+
+	if (cache->registered == FALSE)
+	{
+		// The destructor gives the cached objects back when the thread exits
+		pthread_once(&afc_pool_once, afc_pool_internal_key_create);
+		pthread_setspecific(afc_pool_key, cache);
+		cache->registered = TRUE;
+	}
+
+	pthread_mutex_lock(&afc_pool_mutex);
+
+	if ((afc_pool_shared[c] == NULL) && (afc_pool_internal_block_new(c) != AFC_ERR_NO_ERROR))
+	{
+		pthread_mutex_unlock(&afc_pool_mutex);
+		return (AFC_ERR_NO_MEMORY);
+	}
+
+	for (t = 0; (t < AFC_POOL_BATCH) && ((mem = afc_pool_shared[c]) != NULL); t++)
+	{
+		afc_pool_shared[c] = afc_pool_internal_next(mem);
+		afc_pool_internal_next(mem) = cache->free[c];
+		cache->free[c] = mem;
+	}
+
+	pthread_mutex_unlock(&afc_pool_mutex);
+
+	cache->count[c] += t;
+	cache->refills++;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_pool_internal_block_new ( c )
+/* Carves a new block in objects of class c. Must be called with afc_pool_mutex locked */
+static int afc_pool_internal_block_new(unsigned int c)
+{
+	size_t size = (c + 1) * AFC_POOL_ALIGN;
+	struct afc_pool_block *block;
+	BOOL tracked = ((__internal_afc_base != NULL) && (__internal_afc_base->tracker != NULL));
+	char *mem;
+
+	// With MemTracker active the block is tracked, so it is reported if it is still in use at afc_pool_clear()
+	if (tracked)
+		block = afc_malloc_uninit(AFC_POOL_BLOCK_SIZE);
+	else
+		block = malloc(AFC_POOL_BLOCK_SIZE);
+
+	if (block == NULL)
+		return (AFC_ERR_NO_MEMORY);
+
+	// The header chains the blocks, so they are always reachable
+	block->next = afc_pool_blocks;
+	block->c = c;
+	block->tracked = tracked;
+	afc_pool_blocks = block;
+
+	for (mem = (char *)block + AFC_POOL_ALIGN; mem + size <= (char *)block + AFC_POOL_BLOCK_SIZE; mem += size)
+	{
+		afc_pool_internal_next(mem) = afc_pool_shared[c];
+		afc_pool_shared[c] = mem;
+	}
+
+	afc_pool_totals.blocks++;
+	afc_pool_totals.bytes_held += AFC_POOL_BLOCK_SIZE;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_pool_internal_flush ( cache, c, num )
+/* Moves up to num objects of class c from the thread cache to the shared pool */
+static void afc_pool_internal_flush(struct afc_pool_cache *cache, unsigned int c, unsigned int num)
+{
+	unsigned int t;
+	void *mem;
+
+	pthread_mutex_lock(&afc_pool_mutex);
+
+	for (t = 0; (t < num) && ((mem = cache->free[c]) != NULL); t++)
+	{
+		cache->free[c] = afc_pool_internal_next(mem);
+		afc_pool_internal_next(mem) = afc_pool_shared[c];
+		afc_pool_shared[c] = mem;
+	}
+
+	pthread_mutex_unlock(&afc_pool_mutex);
+
+	cache->count[c] -= t;
+}
+// }}}
+// {{{ afc_pool_internal_thread_exit ( data )
+static void afc_pool_internal_thread_exit(void *data)
+{
+	struct afc_pool_cache *cache = (struct afc_pool_cache *)data;
+	unsigned int c;
+
+	for (c = 0; c < AFC_POOL_CLASSES; c++)
+		afc_pool_internal_flush(cache, c, cache->count[c]);
+
+	pthread_mutex_lock(&afc_pool_mutex);
+	afc_pool_totals.hits += cache->hits;
+	afc_pool_totals.refills += cache->refills;
+	pthread_mutex_unlock(&afc_pool_mutex);
+
+	cache->hits = 0;
+	cache->refills = 0;
+	cache->registered = FALSE;
+}
+// }}}
+// {{{ afc_pool_internal_key_create ()
+static void afc_pool_internal_key_create(void)
+{
+	pthread_key_create(&afc_pool_key, afc_pool_internal_thread_exit);
+}
+// }}}
+// {{{ afc_pool_internal_block_comp ( a, b )
+static int afc_pool_internal_block_comp(const void *a, const void *b)
+{
+	const char *ba = *(const char *const *)a;
+	const char *bb = *(const char *const *)b;
+
+	return ((ba > bb) - (ba < bb));
+}
+// }}}
+#endif
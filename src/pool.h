@@ -0,0 +1,74 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef AFC_POOL_H
+#define AFC_POOL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+
+#ifndef MINGW
+#include <pthread.h>
+#endif
+
+#include "base.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* Objects are grouped in size classes AFC_POOL_ALIGN bytes apart */
+#define AFC_POOL_ALIGN 16
+
+/* Bigger objects are not pooled: they go straight to afc_malloc() */
+#define AFC_POOL_MAX_SIZE 128
+
+#define AFC_POOL_CLASSES (AFC_POOL_MAX_SIZE / AFC_POOL_ALIGN)
+
+/* Objects moved at once between a thread cache and the shared pool */
+#define AFC_POOL_BATCH 32
+
+/* Objects a thread can keep for every size class before giving a batch back */
+#define AFC_POOL_CACHE_MAX 128
+
+/* Size of the blocks asked to the system */
+#define AFC_POOL_BLOCK_SIZE 8192
+
+	struct afc_pool_stats
+	{
+		unsigned long hits;	   // Allocations served by the thread cache
+		unsigned long refills; // Times a thread cache had to get objects from the shared pool
+		unsigned long blocks;  // Blocks asked to the system
+		size_t bytes_held;	   // Bytes held by the pool (objects in use and free ones)
+	};
+
+	typedef struct afc_pool_stats PoolStats;
+
+	void *afc_pool_alloc(size_t size);
+	void afc_pool_free(void *mem, size_t size);
+	int afc_pool_get_stats(PoolStats *stats);
+	int afc_pool_clear(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,888 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "rope.h"
+
+// {{{ docs
+/*
+@config
+	TITLE:     Rope
+	VERSION:   1.00
+	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
+@endnode
+
+@node quote
+	*Give me six hours to chop down a tree and I will spend the first four sharpening the axe.*
+
+		Abraham Lincoln
+@endnode
+
+@node history
+	- 1.00:		Initial Release
+@endnode
+
+@node intro
+Rope is a string meant for big texts that are built and edited a piece at a time: mail merges, templates, reports
+many megabytes long. An AFC string keeps all its chars in a single buffer, so inserting or removing chars in the
+middle of it (or growing it past its size) copies the whole buffer every time. A Rope keeps its chars in many small
+leaves of at most AFC_ROPE_LEAF_SIZE chars, held by a balanced (AVL) tree: insertions and removals anywhere in the
+text cost O(log n), and only touch the leaves involved.
+
+To inizialize a new instance, simply call afc_rope_new(), and to destroy it, call the afc_rope_delete().
+Add text with afc_rope_add() and afc_rope_insert(), remove it with afc_rope_remove(). When the text is complete,
+afc_rope_to_string() returns it as a single AFC string, while afc_rope_first_chunk() and afc_rope_next_chunk()
+let you write it out (to a file, a socket...) leaf by leaf, without copying it at all.
+
+Chars are counted in bytes, and a Rope can also hold binary data, since no function relies on NUL terminators.
+@endnode
+*/
+// }}}
+
+static const char class_name[] = "Rope";
+
+static struct afc_rope_node *afc_rope_internal_leaf_new(void);
+static struct afc_rope_node *afc_rope_internal_node_new(void);
+static void afc_rope_internal_node_free(struct afc_rope_node *node);
+static void afc_rope_internal_tree_free(struct afc_rope_node *node);
+static struct afc_rope_node *afc_rope_internal_build(const char *str, unsigned long len);
+static struct afc_rope_node *afc_rope_internal_join(struct afc_rope_node *left, struct afc_rope_node *right, struct afc_rope_node *node);
+static void afc_rope_internal_split(struct afc_rope_node *node, unsigned long pos, struct afc_rope_node **left, struct afc_rope_node **right, struct afc_rope_node **spare);
+static struct afc_rope_node *afc_rope_internal_rebalance(struct afc_rope_node *node);
+static void afc_rope_internal_collect(struct afc_rope_node *node, unsigned long pos, unsigned long len, char *dest);
+
+#define afc_rope_internal_height(node) ((node)->data ? 0 : (node)->height)
+
+// {{{ afc_rope_new ()
+/*
+@node afc_rope_new
+
+			 NAME: afc_rope_new ()    - Initializes a new Rope instance.
+
+		 SYNOPSIS: Rope * afc_rope_new ()
+
+	  DESCRIPTION: This function initializes a new, empty, Rope instance.
+
+			INPUT: NONE
+
+		  RESULTS: a valid inizialized Rope structure. NULL in case of errors.
+
+		 SEE ALSO: - afc_rope_delete()
+
+@endnode
+*/
+Rope *afc_rope_new(void)
+{
+	TRY(Rope *)
+
+	Rope *rope = (Rope *)afc_malloc(sizeof(Rope));
+
+	if (rope == NULL)
+		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "rope", NULL);
+
+	rope->magic = AFC_ROPE_MAGIC;
+
+	RETURN(rope);
+
+	EXCEPT
+	afc_rope_delete(rope);
+
+	FINALLY
+
+	ENDTRY
+}
+// }}}
+// {{{ afc_rope_delete ( rope )
+/*
+@node afc_rope_delete
+
+			 NAME: afc_rope_delete ( rope )  - Disposes a valid Rope instance.
+
+		 SYNOPSIS: int afc_rope_delete ( Rope * rope )
+
+	  DESCRIPTION: This function frees an already alloc'd Rope structure and all its text.
+
+			INPUT: - rope  - Pointer to a valid Rope instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+			NOTES: - this method calls: afc_rope_clear()
+
+		 SEE ALSO: - afc_rope_new()
+				   - afc_rope_clear()
+@endnode
+*/
+int _afc_rope_delete(Rope *rope)
+{
+	int afc_res;
+
+	if ((afc_res = afc_rope_clear(rope)) != AFC_ERR_NO_ERROR)
+		return (afc_res);
+
+	afc_free(rope);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_rope_clear ( rope )
+/*
+@node afc_rope_clear
+
+			 NAME: afc_rope_clear ( rope )  - Removes all the text from the Rope
+
+		 SYNOPSIS: int afc_rope_clear ( Rope * rope )
+
+	  DESCRIPTION: This function frees all the text of the Rope, that can then be used again.
+
+			INPUT: - rope  - Pointer to a valid Rope instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+		 SEE ALSO: - afc_rope_remove()
+@endnode
+*/
+int afc_rope_clear(Rope *rope)
+{
+	if (rope == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (rope->magic != AFC_ROPE_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	afc_rope_internal_tree_free(rope->root);
+
+	rope->root = NULL;
+	rope->stack_len = 0;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_rope_insert ( rope, pos, str, len )
+/*
+@node afc_rope_insert
+
+			 NAME: afc_rope_insert ( rope, pos, str, len )  - Inserts text in the Rope
+
+		 SYNOPSIS: int afc_rope_insert ( Rope * rope, unsigned long pos, const char * str, unsigned long len )
+
+	  DESCRIPTION: This function inserts the first /len/ chars of /str/ in the Rope, before the char at position /pos/.
+				   If the chars fit in the leaf holding /pos/ they are simply added to it, otherwise the tree is split at
+				   /pos/ and joined back with the new text in the middle: in both cases only O(log n) nodes are touched.
+
+			INPUT: - rope  - Pointer to a valid Rope instance.
+				   - pos   - Position of the new text (0 is the start of the Rope, afc_rope_len() its end)
+				   - str   - Text to insert.
+				   - len   - Number of chars to insert, or ALL to insert the whole /str/ (up to the NUL terminator).
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_ROPE_ERR_INVALID_POSITION if /pos/ is past the end of the Rope.
+				   - AFC_ERR_NO_MEMORY if there is not enough memory: the Rope is not changed.
+
+			NOTES: - /str/ must not point inside a chunk of the same Rope.
+				   - Any afc_rope_first_chunk() / afc_rope_next_chunk() scan in progress is invalidated.
+
+		 SEE ALSO: - afc_rope_add()
+				   - afc_rope_remove()
+@endnode
+*/
+int afc_rope_insert(Rope *rope, unsigned long pos, const char *str, unsigned long len)
+{
+	struct afc_rope_node *path[AFC_ROPE_MAX_HEIGHT];
+	struct afc_rope_node *node, *middle, *spare, *join1, *join2, *left, *right;
+	unsigned long p = pos;
+	int depth = 0;
+
+	if ((rope == NULL) || (str == NULL))
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (rope->magic != AFC_ROPE_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if ((long)len == ALL)
+		len = strlen(str);
+
+	if (pos > afc_rope_len(rope))
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_ROPE_ERR_INVALID_POSITION, "Position past the end of the Rope", NULL));
+
+	if (len == 0)
+		return (AFC_ERR_NO_ERROR);
+
+	rope->stack_len = 0;
+
+	// Fast path: the new chars fit in the leaf holding /pos/
+	if ((node = rope->root) != NULL)
+	{
+		while (node->data == NULL)
+		{
+			path[depth++] = node;
+
+			if (p <= node->left->len)
+				node = node->left;
+			else
+			{
+				p -= node->left->len;
+				node = node->right;
+			}
+		}
+
+		if (node->len + len <= AFC_ROPE_LEAF_SIZE)
+		{
+			memmove(node->data + p + len, node->data + p, node->len - p);
+			memcpy(node->data + p, str, len);
+			node->len += len;
+
+			while (depth)
+				path[--depth]->len += len;
+
+			return (AFC_ERR_NO_ERROR);
+		}
+	}
+
+	// Everything the split and joins below need is allocated here, so they cannot fail halfway
+	middle = afc_rope_internal_build(str, len);
+	spare = afc_rope_internal_leaf_new();
+	join1 = afc_rope_internal_node_new();
+	join2 = afc_rope_internal_node_new();
+
+	if ((middle == NULL) || (spare == NULL) || (join1 == NULL) || (join2 == NULL))
+	{
+		afc_rope_internal_tree_free(middle);
+		afc_rope_internal_node_free(spare);
+		afc_rope_internal_node_free(join1);
+		afc_rope_internal_node_free(join2);
+
+		return (AFC_LOG_FAST(AFC_ERR_NO_MEMORY));
+	}
+
+	afc_rope_internal_split(rope->root, pos, &left, &right, &spare);
+	rope->root = afc_rope_internal_join(afc_rope_internal_join(left, middle, join1), right, join2);
+
+	afc_rope_internal_node_free(spare);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_rope_add ( rope, str, len )
+/*
+@node afc_rope_add
+
+			 NAME: afc_rope_add ( rope, str, len )  - Appends text to the Rope
+
+		 SYNOPSIS: int afc_rope_add ( Rope * rope, const char * str, unsigned long len )
+
+	  DESCRIPTION: This function appends the first /len/ chars of /str/ at the end of the Rope.
+
+			INPUT: - rope  - Pointer to a valid Rope instance.
+				   - str   - Text to append.
+				   - len   - Number of chars to append, or ALL to append the whole /str/.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_ERR_NO_MEMORY if there is not enough memory: the Rope is not changed.
+
+			NOTES: - this is the same as afc_rope_insert ( rope, afc_rope_len ( rope ), str, len )
+
+		 SEE ALSO: - afc_rope_insert()
+@endnode
+*/
+int afc_rope_add(Rope *rope, const char *str, unsigned long len)
+{
+	return (afc_rope_insert(rope, afc_rope_len(rope), str, len));
+}
+// }}}
+// {{{ afc_rope_remove ( rope, pos, len )
+/*
+@node afc_rope_remove
+
+			 NAME: afc_rope_remove ( rope, pos, len )  - Removes text from the Rope
+
+		 SYNOPSIS: int afc_rope_remove ( Rope * rope, unsigned long pos, unsigned long len )
+
+	  DESCRIPTION: This function removes /len/ chars from the Rope, starting from the one at position /pos/.
+				   Removing chars inside a single leaf just moves the rest of the leaf, otherwise the tree is split
+				   around the removed text, which is freed, and the two remaining parts are joined back.
+
+			INPUT: - rope  - Pointer to a valid Rope instance.
+				   - pos   - Position of the first char to remove.
+				   - len   - Number of chars to remove, or ALL to remove everything up to the end of the Rope.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_ROPE_ERR_INVALID_POSITION if /pos/ is past the end of the Rope.
+				   - AFC_ERR_NO_MEMORY if there is not enough memory: the Rope is not changed.
+
+			NOTES: - If /pos/ + /len/ is past the end of the Rope, only the chars up to the end are removed.
+				   - Any afc_rope_first_chunk() / afc_rope_next_chunk() scan in progress is invalidated.
+
+		 SEE ALSO: - afc_rope_insert()
+				   - afc_rope_clear()
+@endnode
+*/
+int afc_rope_remove(Rope *rope, unsigned long pos, unsigned long len)
+{
+	struct afc_rope_node *path[AFC_ROPE_MAX_HEIGHT];
+	struct afc_rope_node *node, *spare1, *spare2, *join, *left, *middle, *right;
+	unsigned long total = afc_rope_len(rope), p = pos;
+	int depth = 0;
+
+	if (rope == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (rope->magic != AFC_ROPE_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (pos > total)
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_ROPE_ERR_INVALID_POSITION, "Position past the end of the Rope", NULL));
+
+	if (((long)len == ALL) || (len > total - pos))
+		len = total - pos;
+
+	if (len == 0)
+		return (AFC_ERR_NO_ERROR);
+
+	rope->stack_len = 0;
+
+	// Fast path: the chars are all in a single leaf, that does not become empty
+	node = rope->root;
+	while (node->data == NULL)
+	{
+		path[depth++] = node;
+
+		if (p < node->left->len)
+			node = node->left;
+		else
+		{
+			p -= node->left->len;
+			node = node->right;
+		}
+	}
+
+	if ((p + len <= node->len) && (len < node->len))
+	{
+		memmove(node->data + p, node->data + p + len, node->len - p - len);
+		node->len -= len;
+
+		while (depth)
+			path[--depth]->len -= len;
+
+		return (AFC_ERR_NO_ERROR);
+	}
+
+	spare1 = afc_rope_internal_leaf_new();
+	spare2 = afc_rope_internal_leaf_new();
+	join = afc_rope_internal_node_new();
+
+	if ((spare1 == NULL) || (spare2 == NULL) || (join == NULL))
+	{
+		afc_rope_internal_node_free(spare1);
+		afc_rope_internal_node_free(spare2);
+		afc_rope_internal_node_free(join);
+
+		return (AFC_LOG_FAST(AFC_ERR_NO_MEMORY));
+	}
+
+	afc_rope_internal_split(rope->root, pos, &left, &right, &spare1);
+	afc_rope_internal_split(right, len, &middle, &right, &spare2);
+
+	afc_rope_internal_tree_free(middle);
+
+	rope->root = afc_rope_internal_join(left, right, join);
+
+	afc_rope_internal_node_free(spare1);
+	afc_rope_internal_node_free(spare2);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_rope_char_at ( rope, pos )
+/*
+@node afc_rope_char_at
+
+			 NAME: afc_rope_char_at ( rope, pos )  - Returns a single char of the Rope
+
+		 SYNOPSIS: char afc_rope_char_at ( Rope * rope, unsigned long pos )
+
+	  DESCRIPTION: This function returns the char at position /pos/ of the Rope.
+
+			INPUT: - rope  - Pointer to a valid Rope instance.
+				   - pos   - Position of the char.
+
+		  RESULTS: the char at the given position, or '\0' if /pos/ is past the end of the Rope.
+
+		 SEE ALSO: - afc_rope_slice()
+@endnode
+*/
+char afc_rope_char_at(Rope *rope, unsigned long pos)
+{
+	struct afc_rope_node *node;
+
+	if ((rope == NULL) || (pos >= afc_rope_len(rope)))
+		return ('\0');
+
+	node = rope->root;
+	while (node->data == NULL)
+	{
+		if (pos < node->left->len)
+			node = node->left;
+		else
+		{
+			pos -= node->left->len;
+			node = node->right;
+		}
+	}
+
+	return (node->data[pos]);
+}
+// }}}
+// {{{ afc_rope_slice ( rope, pos, len )
+/*
+@node afc_rope_slice
+
+			 NAME: afc_rope_slice ( rope, pos, len )  - Copies a part of the Rope in a new string
+
+		 SYNOPSIS: char * afc_rope_slice ( Rope * rope, unsigned long pos, unsigned long len )
+
+	  DESCRIPTION: This function returns a new AFC string containing /len/ chars of the Rope, starting from the one at
+				   position /pos/.
+
+			INPUT: - rope  - Pointer to a valid Rope instance.
+				   - pos   - Position of the first char to copy.
+				   - len   - Number of chars to copy, or ALL to copy everything up to the end of the Rope.
+
+		  RESULTS: a new AFC string, that must be freed with afc_string_delete(), or NULL in case of errors.
+
+			NOTES: - If /pos/ + /len/ is past the end of the Rope, only the chars up to the end are copied.
+
+		 SEE ALSO: - afc_rope_to_string()
+				   - afc_rope_char_at()
+@endnode
+*/
+char *afc_rope_slice(Rope *rope, unsigned long pos, unsigned long len)
+{
+	unsigned long total = afc_rope_len(rope);
+	char *dest;
+
+	if (rope == NULL)
+	{
+		AFC_LOG_FAST(AFC_ERR_NULL_POINTER);
+		return (NULL);
+	}
+
+	if (pos > total)
+	{
+		AFC_LOG(AFC_LOG_ERROR, AFC_ROPE_ERR_INVALID_POSITION, "Position past the end of the Rope", NULL);
+		return (NULL);
+	}
+
+	if (((long)len == ALL) || (len > total - pos))
+		len = total - pos;
+
+	if ((dest = afc_string_new(len)) == NULL)
+		return (NULL);
+
+	if (len)
+		afc_rope_internal_collect(rope->root, pos, len, dest);
+
+	return (dest);
+}
+// }}}
+// {{{ afc_rope_to_string ( rope )
+/*
+@node afc_rope_to_string
+
+			 NAME: afc_rope_to_string ( rope )  - Copies the whole Rope in a new string
+
+		 SYNOPSIS: char * afc_rope_to_string ( Rope * rope )
+
+	  DESCRIPTION: This function returns a new AFC string containing all the text of the Rope.
+
+			INPUT: - rope  - Pointer to a valid Rope instance.
+
+		  RESULTS: a new AFC string, that must be freed with afc_string_delete(), or NULL in case of errors.
+
+			NOTES: - to write a big Rope to a file, afc_rope_first_chunk() and afc_rope_next_chunk() avoid the copy.
+
+		 SEE ALSO: - afc_rope_slice()
+@endnode
+*/
+char *afc_rope_to_string(Rope *rope)
+{
+	return (afc_rope_slice(rope, 0, ALL));
+}
+// }}}
+// {{{ afc_rope_first_chunk ( rope, chunk )
+/*
+@node afc_rope_first_chunk
+
+			 NAME: afc_rope_first_chunk ( rope, chunk )  - Starts a scan of the Rope chunks
+
+		 SYNOPSIS: int afc_rope_first_chunk ( Rope * rope, afc_strview * chunk )
+
+	  DESCRIPTION: This function returns the first chunk of text of the Rope, as a view inside the Rope leaf holding it.
+				   The following chunks are returned by afc_rope_next_chunk(): joined together, in order, they are
+				   the whole text of the Rope.
+
+			INPUT: - rope  - Pointer to a valid Rope instance.
+				   - chunk - Pointer to the view that will be set to the chunk.
+
+		  RESULTS: TRUE if a chunk is returned, FALSE if the Rope is empty.
+
+			NOTES: - Views are valid until the Rope is changed: any change also ends the scan.
+
+		 SEE ALSO: - afc_rope_next_chunk()
+@endnode
+*/
+int afc_rope_first_chunk(Rope *rope, afc_strview *chunk)
+{
+	if ((rope == NULL) || (chunk == NULL))
+		return (FALSE);
+
+	rope->stack_len = 0;
+
+	if (rope->root)
+		rope->stack[rope->stack_len++] = rope->root;
+
+	return (afc_rope_next_chunk(rope, chunk));
+}
+// }}}
+// {{{ afc_rope_next_chunk ( rope, chunk )
+/*
+@node afc_rope_next_chunk
+
+			 NAME: afc_rope_next_chunk ( rope, chunk )  - Returns the next chunk of the Rope
+
+		 SYNOPSIS: int afc_rope_next_chunk ( Rope * rope, afc_strview * chunk )
+
+	  DESCRIPTION: This function returns the next chunk of text of a scan started by afc_rope_first_chunk().
+
+			INPUT: - rope  - Pointer to a valid Rope instance.
+				   - chunk - Pointer to the view that will be set to the chunk.
+
+		  RESULTS: TRUE if a chunk is returned, FALSE when there are no more chunks.
+
+		 SEE ALSO: - afc_rope_first_chunk()
+@endnode
+*/
+int afc_rope_next_chunk(Rope *rope, afc_strview *chunk)
+{
+	struct afc_rope_node *node;
+
+	if ((rope == NULL) || (chunk == NULL))
+		return (FALSE);
+
+	while (rope->stack_len)
+	{
+		node = rope->stack[--rope->stack_len];
+
+		if (node->data)
+		{
+			chunk->str = node->data;
+			chunk->len = node->len;
+
+			return (TRUE);
+		}
+
+		// The stack holds at most one right sibling for each level of the tree
+		rope->stack[rope->stack_len++] = node->right;
+		rope->stack[rope->stack_len++] = node->left;
+	}
+
+	chunk->str = NULL;
+	chunk->len = 0;
+
+	return (FALSE);
+}
+// }}}
+
+/* =====================================================================================
+	 INTERNAL FUNCTIONS
+===================================================================================== */
+// {{{ afc_rope_internal_leaf_new ()
+static struct afc_rope_node *afc_rope_internal_leaf_new(void)
+{
+	struct afc_rope_node *node;
+
+	// Leaf chars are allocated together with the node
+	if ((node = afc_malloc_uninit(sizeof(struct afc_rope_node) + AFC_ROPE_LEAF_SIZE)) == NULL)
+		return (NULL);
+
+	node->left = node->right = NULL;
+	node->len = 0;
+	node->height = 0;
+	node->data = (char *)(node + 1);
+
+	return (node);
+}
+// }}}
+// {{{ afc_rope_internal_node_new ()
+static struct afc_rope_node *afc_rope_internal_node_new(void)
+{
+	struct afc_rope_node *node;
+
+	if ((node = afc_malloc_uninit(sizeof(struct afc_rope_node))) == NULL)
+		return (NULL);
+
+	node->data = NULL;
+
+	return (node);
+}
+// }}}
+// {{{ afc_rope_internal_node_free ( node )
+static void afc_rope_internal_node_free(struct afc_rope_node *node)
+{
+	if (node)
+		afc_free(node);
+}
+// }}}
+// {{{ afc_rope_internal_tree_free ( node )
+static void afc_rope_internal_tree_free(struct afc_rope_node *node)
+{
+	if (node == NULL)
+		return;
+
+	if (node->data == NULL)
+	{
+		afc_rope_internal_tree_free(node->left);
+		afc_rope_internal_tree_free(node->right);
+	}
+
+	afc_free(node);
+}
+// }}}
+// {{{ afc_rope_internal_build ( str, len )
+/* Builds a perfectly balanced tree of full leaves (only the last one can be shorter) holding /len/ chars of /str/ */
+static struct afc_rope_node *afc_rope_internal_build(const char *str, unsigned long len)
+{
+	struct afc_rope_node *node, *left, *right;
+	unsigned long leaves = (len + AFC_ROPE_LEAF_SIZE - 1) / AFC_ROPE_LEAF_SIZE, half;
+
+	if (leaves == 1)
+	{
+		if ((node = afc_rope_internal_leaf_new()) == NULL)
+			return (NULL);
+
+		memcpy(node->data, str, len);
+		node->len = len;
+
+		return (node);
+	}
+
+	half = (leaves / 2) * AFC_ROPE_LEAF_SIZE;
+
+	left = afc_rope_internal_build(str, half);
+	right = afc_rope_internal_build(str + half, len - half);
+	node = afc_rope_internal_node_new();
+
+	if ((left == NULL) || (right == NULL) || (node == NULL))
+	{
+		afc_rope_internal_tree_free(left);
+		afc_rope_internal_tree_free(right);
+		afc_rope_internal_node_free(node);
+
+		return (NULL);
+	}
+
+	node->left = left;
+	node->right = right;
+
+	return (afc_rope_internal_rebalance(node));
+}
+// }}}
+// {{{ afc_rope_internal_rebalance ( node )
+/* Updates len and height of /node/ and restores the AVL property, if its subtrees heights differ by 2 */
+static struct afc_rope_node *afc_rope_internal_rotate(struct afc_rope_node *node, int to_right)
+{
+	struct afc_rope_node *pivot;
+
+	if (to_right)
+	{
+		pivot = node->left;
+		node->left = pivot->right;
+		pivot->right = node;
+	}
+	else
+	{
+		pivot = node->right;
+		node->right = pivot->left;
+		pivot->left = node;
+	}
+
+	afc_rope_internal_rebalance(node);
+
+	return (afc_rope_internal_rebalance(pivot));
+}
+
+static struct afc_rope_node *afc_rope_internal_rebalance(struct afc_rope_node *node)
+{
+	int hl = afc_rope_internal_height(node->left), hr = afc_rope_internal_height(node->right);
+
+	if (hl > hr + 1)
+	{
+		if (afc_rope_internal_height(node->left->right) > afc_rope_internal_height(node->left->left))
+			node->left = afc_rope_internal_rotate(node->left, FALSE);
+
+		return (afc_rope_internal_rotate(node, TRUE));
+	}
+
+	if (hr > hl + 1)
+	{
+		if (afc_rope_internal_height(node->right->left) > afc_rope_internal_height(node->right->right))
+			node->right = afc_rope_internal_rotate(node->right, TRUE);
+
+		return (afc_rope_internal_rotate(node, FALSE));
+	}
+
+	node->len = node->left->len + node->right->len;
+	node->height = 1 + (hl > hr ? hl : hr);
+
+	return (node);
+}
+// }}}
+// {{{ afc_rope_internal_join ( left, right, node )
+/*
+ * Joins two trees, all chars of /left/ coming before those of /right/, and returns the new tree.
+ * /node/ is a free inner node, used to join the two trees or freed if it is not needed: a join never allocates.
+ * The shorter tree is hung on the side of the taller one, at the level where heights match, and the path back
+ * to the root is rebalanced, so the cost is O(height difference).
+ */
+static struct afc_rope_node *afc_rope_internal_join(struct afc_rope_node *left, struct afc_rope_node *right, struct afc_rope_node *node)
+{
+	int hl, hr;
+
+	if ((left == NULL) || (right == NULL))
+	{
+		afc_rope_internal_node_free(node);
+		return (left ? left : right);
+	}
+
+	// Two small leaves become a single one
+	if (left->data && right->data && (left->len + right->len <= AFC_ROPE_LEAF_SIZE))
+	{
+		memcpy(left->data + left->len, right->data, right->len);
+		left->len += right->len;
+
+		afc_free(right);
+		afc_rope_internal_node_free(node);
+
+		return (left);
+	}
+
+	hl = afc_rope_internal_height(left);
+	hr = afc_rope_internal_height(right);
+
+	if (hl > hr + 1)
+	{
+		left->right = afc_rope_internal_join(left->right, right, node);
+		return (afc_rope_internal_rebalance(left));
+	}
+
+	if (hr > hl + 1)
+	{
+		right->left = afc_rope_internal_join(left, right->left, node);
+		return (afc_rope_internal_rebalance(right));
+	}
+
+	node->left = left;
+	node->right = right;
+	node->data = NULL;
+
+	return (afc_rope_internal_rebalance(node));
+}
+// }}}
+// {{{ afc_rope_internal_split ( node, pos, left, right, spare )
+/*
+ * Splits the tree in /left/ (chars before /pos/) and /right/ (the others). Inner nodes on the path to /pos/ are
+ * reused to join the pieces back, and the leaf holding /pos/, if it must be cut in two, gives its second half to
+ * the /spare/ leaf (set to NULL when it is used).
+ */
+static void afc_rope_internal_split(struct afc_rope_node *node, unsigned long pos, struct afc_rope_node **left, struct afc_rope_node **right, struct afc_rope_node **spare)
+{
+	struct afc_rope_node *l, *r, *a, *b;
+
+	if ((node == NULL) || (pos == 0))
+	{
+		*left = NULL;
+		*right = node;
+		return;
+	}
+
+	if (pos >= node->len)
+	{
+		*left = node;
+		*right = NULL;
+		return;
+	}
+
+	if (node->data)
+	{
+		b = *spare;
+		*spare = NULL;
+
+		b->len = node->len - pos;
+		memcpy(b->data, node->data + pos, b->len);
+		node->len = pos;
+
+		*left = node;
+		*right = b;
+		return;
+	}
+
+	l = node->left;
+	r = node->right;
+
+	if (pos <= l->len)
+	{
+		afc_rope_internal_split(l, pos, &a, &b, spare);
+		*left = a;
+		*right = afc_rope_internal_join(b, r, node);
+	}
+	else
+	{
+		afc_rope_internal_split(r, pos - l->len, &a, &b, spare);
+		*left = afc_rope_internal_join(l, a, node);
+		*right = b;
+	}
+}
+// }}}
+// {{{ afc_rope_internal_collect ( node, pos, len, dest )
+/* Appends /len/ chars of the tree, starting from /pos/, to the AFC string /dest/ */
+static void afc_rope_internal_collect(struct afc_rope_node *node, unsigned long pos, unsigned long len, char *dest)
+{
+	unsigned long n;
+
+	while (node->data == NULL)
+	{
+		if (pos < node->left->len)
+		{
+			n = node->left->len - pos;
+
+			if (len <= n)
+			{
+				node = node->left;
+				continue;
+			}
+
+			afc_rope_internal_collect(node->left, pos, n, dest);
+
+			len -= n;
+			pos = 0;
+		}
+		else
+			pos -= node->left->len;
+
+		node = node->right;
+	}
+
+	afc_string_add_view(dest, afc_strview_make(node->data + pos, len));
+}
+// }}}
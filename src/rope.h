@@ -0,0 +1,98 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef AFC_ROPE_H
+#define AFC_ROPE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base.h"
+#include "exceptions.h"
+#include "string.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* AFC Rope Magic Number: 'ROPE' */
+#define AFC_ROPE_MAGIC ('R' << 24 | 'O' << 16 | 'P' << 8 | 'E')
+
+/* AFC Rope Base value for constants */
+#define AFC_ROPE_BASE 0xE200
+
+/* Max number of chars stored in a single leaf of the tree */
+#define AFC_ROPE_LEAF_SIZE 4096
+
+/* Max height of the tree: an AVL tree this high would need more than 2^64 leaves */
+#define AFC_ROPE_MAX_HEIGHT 96
+
+	enum
+	{
+		AFC_ROPE_ERR_INVALID_POSITION = AFC_ROPE_BASE + 1 /* The position is past the end of the Rope */
+	};
+
+	struct afc_rope_node
+	{
+		struct afc_rope_node *left;	 // NULL for leaves
+		struct afc_rope_node *right; // NULL for leaves
+		unsigned long len;			 // Number of chars in this subtree
+		int height;					 // 0 for leaves
+		char *data;					 // Leaf chars (AFC_ROPE_LEAF_SIZE bytes), NULL for inner nodes
+	};
+
+	struct afc_rope
+	{
+		unsigned long magic;
+
+		struct afc_rope_node *root; // NULL if the Rope is empty
+
+		struct afc_rope_node *stack[AFC_ROPE_MAX_HEIGHT + 1]; // Nodes still to visit by afc_rope_next_chunk()
+		int stack_len;
+	};
+
+	typedef struct afc_rope Rope;
+
+#define afc_rope_delete(rope)   \
+	if (rope)                   \
+	{                           \
+		_afc_rope_delete(rope); \
+		rope = NULL;            \
+	}
+
+	Rope *afc_rope_new(void);
+	int _afc_rope_delete(Rope *rope);
+	int afc_rope_clear(Rope *rope);
+	int afc_rope_insert(Rope *rope, unsigned long pos, const char *str, unsigned long len);
+	int afc_rope_add(Rope *rope, const char *str, unsigned long len);
+	int afc_rope_remove(Rope *rope, unsigned long pos, unsigned long len);
+	char afc_rope_char_at(Rope *rope, unsigned long pos);
+	char *afc_rope_slice(Rope *rope, unsigned long pos, unsigned long len);
+	char *afc_rope_to_string(Rope *rope);
+	int afc_rope_first_chunk(Rope *rope, afc_strview *chunk);
+	int afc_rope_next_chunk(Rope *rope, afc_strview *chunk);
+
+#define afc_rope_len(rope) ((rope) && (rope)->root ? (rope)->root->len : 0)
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
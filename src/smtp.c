@@ -25,9 +25,14 @@
 /*
 @config
 	TITLE:     SMTP
-	VERSION:   1.00
+	VERSION:   1.02
 	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
 @endnode
+
+@node history
+	- 1.01	- afc_smtp_send_simple () builds the message with an afc_string_builder, so long bodies are no longer truncated
+	- 1.02	- AUTH PLAIN and AUTH LOGIN set the len of the base64 encoded credentials, so no garbage is sent after them
+@endnode
 */
 
 static const char class_name[] = "SMTP";
@@ -550,6 +555,9 @@ int _afc_smtp_auth_plain(SMTP *smtp)
 	explicit_bzero(auth_str, auth_len);
 	afc_string_delete(auth_str);
 
+	// The encoder writes raw memory: the string len must be set before using it
+	afc_string_reset_len(encoded);
+
 	// Remove trailing CRLF added by base64 encoder
 	afc_string_trim(encoded);
 
@@ -631,6 +639,9 @@ int _afc_smtp_auth_login(SMTP *smtp)
 					  AFC_TAG_END);
 	afc_base64_delete(b64);
 
+	// The encoder writes raw memory: the string len must be set before using it
+	afc_string_reset_len(encoded_user);
+
 	// Remove trailing CRLF added by base64 encoder
 	afc_string_trim(encoded_user);
 
@@ -675,6 +686,9 @@ int _afc_smtp_auth_login(SMTP *smtp)
 					  AFC_TAG_END);
 	afc_base64_delete(b64);
 
+	// The encoder writes raw memory: the string len must be set before using it
+	afc_string_reset_len(encoded_pass);
+
 	// Remove trailing CRLF added by base64 encoder
 	afc_string_trim(encoded_pass);
 
@@ -867,7 +881,7 @@ int afc_smtp_send(SMTP *smtp, const char *message)
 */
 int afc_smtp_send_simple(SMTP *smtp, const char *from, const char *to, const char *subject, const char *body)
 {
-	char *message;
+	afc_string_builder message;
 	int res;
 
 	if (!smtp)
@@ -887,22 +901,22 @@ int afc_smtp_send_simple(SMTP *smtp, const char *from, const char *to, const cha
 					  AFC_SMTP_TAG_TO, to,
 					  AFC_SMTP_TAG_SUBJECT, subject);
 
-	// Build message with headers
-	message = afc_string_new(4096);
-	afc_string_make(message, "From: %s\r\n", from);
-	afc_string_add(message, "To: ", ALL);
-	afc_string_add(message, to, ALL);
-	afc_string_add(message, "\r\n", ALL);
-	afc_string_add(message, "Subject: ", ALL);
-	afc_string_add(message, subject, ALL);
-	afc_string_add(message, "\r\n", ALL);
-	afc_string_add(message, "Content-Type: text/plain; charset=UTF-8\r\n", ALL);
-	afc_string_add(message, "\r\n", ALL);
-	afc_string_add(message, body, ALL);
-
-	res = afc_smtp_send(smtp, message);
-
-	afc_string_delete(message);
+	// Build message with headers: the buffer grows with the body, that is never truncated
+	if (afc_string_builder_init(&message, strlen(body ? body : "") + 512) != AFC_ERR_NO_ERROR)
+		return AFC_LOG_FAST(AFC_ERR_NO_MEMORY);
+
+	res = afc_string_builder_append_fmt(&message, "From: %s\r\nTo: %s\r\nSubject: %s\r\n", from, to, subject);
+	if (res == AFC_ERR_NO_ERROR)
+		res = afc_string_builder_append(&message, "Content-Type: text/plain; charset=UTF-8\r\n\r\n", ALL);
+	if ((res == AFC_ERR_NO_ERROR) && body)
+		res = afc_string_builder_append(&message, body, ALL);
+
+	if (res == AFC_ERR_NO_ERROR)
+		res = afc_smtp_send(smtp, message.str);
+	else
+		res = AFC_LOG_FAST(res);
+
+	afc_string_builder_free(&message);
 
 	return res;
 }
@@ -20,12 +20,21 @@
 /*
 @config
 	TITLE:     AFC String
-	VERSION:   1.01
+	VERSION:   1.10
 	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
 	AUTHOR:	   Massimo Tantignone - tanti@intercon.it
 @endnode
 
 @node history
+	1.10	- FIX:	`afc_string_builder_append`_ can append a part of the builder text; `afc_string_builder_reserve`_ checks for size overflows.
+	1.09	- FIX:	`afc_string_hash_seed`_ is thread safe.
+	1.08	- ADD:	`afc_string_append_int`_, `afc_string_format_double`_, `afc_string_parse_int`_ and the other number functions: digit pairs and Grisu2, no printf(). `afc_string_radix`_ no longer allocates.
+	1.07	- ADD:	`afc_utf8_validate`_, `afc_utf8_count`_ and the UTF-8 / Latin-1 / UTF-16 converters, validating 16 bytes at a time.
+	1.06	- ADD:	afc_string_builder: `afc_string_builder_append`_ and friends build long strings with amortized O(1) appends.
+	1.05	- ADD:	`afc_string_casecomp`_. `afc_string_upper`_ and `afc_string_lower`_ convert 16 chars at a time, `afc_string_comp`_ no longer looks past /numchars/.
+	1.04	- ADD:	SSE2/AVX2 substring search for `afc_string_instr`_, `afc_string_index_of`_ and `afc_string_last_index_of`_; two pass `afc_string_replace_all`_ and `afc_string_replace_multi`_.
+	1.03	- ADD:	afc_strview: `afc_string_view`_, `afc_strview_token`_ and the other view functions slice strings without copying them.
+	1.02	- ADD:	`afc_string_hash64`_ and `afc_string_hash_seed`_: fast length aware 64 bit hash with a seed.
 	1.01	- FIX:	small bug in `afc_string_temp`_ when a non AFC string were passed as parameter.
 @endnode
 */
@@ -34,6 +43,25 @@
 #include "string.h"
 
 #include <unistd.h>
+#include <time.h>
+#include <float.h>
+
+/* SSE2 kernels for search and case conversion (SSE2 is always available on x86_64) */
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))) && !defined(AFC_STRING_NO_SIMD)
+#define AFC_STRING_INTERNAL_SIMD 1
+#include <immintrin.h>
+#endif
+
+/* Base of the seeds returned by afc_string_hash_seed(), and the number of seeds returned */
+static unsigned long long afc_string_internal_seed_base = 0;
+static unsigned long long afc_string_internal_seed_counter = 0;
+#ifndef MINGW
+static pthread_once_t afc_string_internal_seed_once = PTHREAD_ONCE_INIT;
+#endif
+static void afc_string_internal_seed_init(void);
+
+/* Largest number of chars a string builder can hold: its size, with the terminator and the header, fits in an unsigned long */
+#define AFC_STRING_INTERNAL_BUILDER_LIMIT (ULONG_MAX - 1 - (sizeof(unsigned long) * 2))
 
 #define STRING_MAX(str) (str ? ((unsigned long)(*((unsigned long *)(str - sizeof(unsigned long) * 2)) - 1)) : 0L)
 
@@ -91,6 +119,16 @@ see if the pattern is ok.
 To create a new /AFC/ /String/ you use afc_string_new(), then you can manipulate it with standard AFC functions like
 afc_string_copy(), afc_string_left(), afc_string_right() or afc_string_make(). When you have finished with a string,
 remember to call afc_string_delete() to free the memory associated with it.
+
+When you just need to look at a part of a string (a token, a key, a trimmed field) you do not have to copy it: an
+/afc_strview/ is a pointer and a length, and afc_strview_mid(), afc_strview_trim() and afc_strview_token() return
+new views without allocating any memory. Create a real /AFC/ /String/ from a view only when you have to keep it,
+with afc_string_dup_view() or afc_string_copy_view().
+
+When a string is built piece by piece and its final size is not known (an HTTP request, a mail message, a
+rendered template), use an /afc_string_builder/: afc_string_builder_append(), afc_string_builder_append_char()
+and afc_string_builder_append_fmt() grow its buffer as needed, and afc_string_builder_finish() returns the result
+as an /AFC/ /String/.
 @endnode
 */
 // }}}
@@ -138,7 +176,8 @@ char *_afc_string_new(unsigned long numchars, const char *file, const char *func
 	if (numchars == 0)
 		numchars = 1;
 
-	if ((str = _afc_malloc(numchars + 1 + (sizeof(unsigned long) * 2), file, func, line)) == NULL)
+	// No need to clear the whole buffer: the string is empty and always terminated by AFC String functions
+	if ((str = _afc_malloc_uninit(numchars + 1 + (sizeof(unsigned long) * 2), file, func, line)) == NULL)
 		return NULL;
 
 	// if ( ( str = afc_malloc ( numchars + 1 + ( sizeof ( unsigned long ) * 2 ) ) ) == NULL ) return ( NULL );
@@ -150,7 +189,11 @@ char *_afc_string_new(unsigned long numchars, const char *file, const char *func
 	location[0] = numchars + 1;
 	location[1] = 0L;
 
-	return (str + (sizeof(unsigned long) * 2));
+	str += sizeof(unsigned long) * 2;
+	str[0] = '\0';
+	str[numchars] = '\0';
+
+	return (str);
 }
 // }}}
 // {{{ afc_string_delete ( str )
@@ -402,6 +445,66 @@ char *afc_string_mid(char *dest, const char *src, unsigned long fromchar, unsign
 	return (afc_string_copy(dest, src + fromchar, numchars));
 }
 // }}}
+// {{{ case kernels
+/*
+   ASCII case conversion and case insensitive compare, 16 chars at a time with SSE2.
+   Bytes >= 0x80 are signed negative for the compares below, so only 'A'-'Z' / 'a'-'z' are ever changed.
+*/
+#define afc_string_internal_lower(c) ((((c) >= 'A') && ((c) <= 'Z')) ? ((c) | 0x20) : (c))
+
+/* Flips the case of all the chars between /from/ and /to/ in the first /len/ chars of /s/ */
+static void afc_string_internal_case(char *s, size_t len, char from, char to)
+{
+	size_t i = 0;
+#ifdef AFC_STRING_INTERNAL_SIMD
+	const __m128i lo = _mm_set1_epi8(from - 1);
+	const __m128i hi = _mm_set1_epi8(to + 1);
+	const __m128i bit = _mm_set1_epi8(0x20);
+	__m128i c, mask;
+
+	for (; i + 16 <= len; i += 16)
+	{
+		c = _mm_loadu_si128((const __m128i *)(s + i));
+		mask = _mm_and_si128(_mm_cmpgt_epi8(c, lo), _mm_cmplt_epi8(c, hi));
+		_mm_storeu_si128((__m128i *)(s + i), _mm_xor_si128(c, _mm_and_si128(mask, bit)));
+	}
+#endif
+
+	for (; i < len; i++)
+		if ((s[i] >= from) && (s[i] <= to))
+			s[i] ^= 0x20;
+}
+
+/* Returns the position of the first char that differs (ignoring the case) in the first /len/ chars, or /len/ */
+static size_t afc_string_internal_casediff(const char *a, const char *b, size_t len)
+{
+	size_t i = 0;
+#ifdef AFC_STRING_INTERNAL_SIMD
+	const __m128i lo = _mm_set1_epi8('A' - 1);
+	const __m128i hi = _mm_set1_epi8('Z' + 1);
+	const __m128i bit = _mm_set1_epi8(0x20);
+	__m128i ca, cb;
+	unsigned int mask;
+
+	for (; i + 16 <= len; i += 16)
+	{
+		ca = _mm_loadu_si128((const __m128i *)(a + i));
+		cb = _mm_loadu_si128((const __m128i *)(b + i));
+		ca = _mm_or_si128(ca, _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi8(ca, lo), _mm_cmplt_epi8(ca, hi)), bit));
+		cb = _mm_or_si128(cb, _mm_and_si128(_mm_and_si128(_mm_cmpgt_epi8(cb, lo), _mm_cmplt_epi8(cb, hi)), bit));
+
+		if ((mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(ca, cb))) != 0xFFFF)
+			return (i + __builtin_ctz(~mask));
+	}
+#endif
+
+	for (; i < len; i++)
+		if (afc_string_internal_lower((unsigned char)a[i]) != afc_string_internal_lower((unsigned char)b[i]))
+			break;
+
+	return (i);
+}
+// }}}
 // {{{ afc_string_comp ( str1, str2, chars )
 /*
 @node afc_string_comp
@@ -422,36 +525,19 @@ char *afc_string_mid(char *dest, const char *src, unsigned long fromchar, unsign
 		  -  a value > 0	 means	str2>str1
 			-  a value == 0	 means	str1==str2
 
-	SEE ALSO:
+	SEE ALSO: - afc_string_casecomp()
 @endnode
 */
 signed long afc_string_comp(const char *s1, const char *s2, long chars)
 {
-	const unsigned char *p1;
-	const unsigned char *p2;
-	unsigned long n;
-
 	if (s1 == NULL || s2 == NULL)
 		return (s1 == s2) ? 0 : (s1 ? 1 : -1);
 
-	p1 = (const unsigned char *)s1;
-	p2 = (const unsigned char *)s2;
-
+	// The C library versions are vectorized and stop at the first difference
 	if (chars == ALL)
-	{
-		/* Compare until null terminator */
-		while (*p1 == *p2 && *p1 != '\0')
-			p1++, p2++;
-	}
-	else
-	{
-		/* Compare up to chars characters */
-		n = (unsigned long)chars;
-		while (n > 0 && *p1 == *p2 && *p1 != '\0')
-			p1++, p2++, n--;
-	}
+		return -(signed long)strcmp(s1, s2);
 
-	return -(signed long)(*p1 - *p2);
+	return -(signed long)strncmp(s1, s2, (unsigned long)chars);
 }
 // }}}
 // {{{ afc_string_upper ( str )
@@ -471,6 +557,7 @@ signed long afc_string_comp(const char *s1, const char *s2, long chars)
 		RESULT: - a pointer to the all uppercase chars string.
 
 			NOTE: - This function can handle NULL pointers.
+			  - Only ASCII letters are converted: the current locale is not used.
 
 	SEE ALSO: - afc_string_lower()
 
@@ -483,8 +570,7 @@ char *afc_string_upper(char *s)
 	if ((x = s) == NULL)
 		return (NULL);
 
-	for (; *s; s++)
-		*s = toupper(*s);
+	afc_string_internal_case(s, strlen(s), 'a', 'z');
 
 	return (x);
 }
@@ -503,9 +589,10 @@ char *afc_string_upper(char *s)
 
 		 INPUT: - string				- AFC string to convert.
 
-		RESULT: - a pointer to the all uppercase chars string.
+		RESULT: - a pointer to the all lowercase chars string.
 
 			NOTE: - This function can handle NULL pointers.
+			  - Only ASCII letters are converted: the current locale is not used.
 
 	SEE ALSO: - afc_string_upper()
 
@@ -518,12 +605,60 @@ char *afc_string_lower(char *s)
 	if ((x = s) == NULL)
 		return (NULL);
 
-	for (; *s; s++)
-		*s = tolower(*s);
+	afc_string_internal_case(s, strlen(s), 'A', 'Z');
 
 	return (x);
 }
 // }}}
+// {{{ afc_string_casecomp ( str1, str2, chars )
+/*
+@node afc_string_casecomp
+
+			NAME: afc_string_casecomp(str1, str2, numchars ) - Compares two strings ignoring the case
+
+	SYNOPSIS: signed long afc_string_casecomp( const char * str1, const char * str2, long numchars)
+	   SINCE: 1.05
+
+		 DESCRIPTION: This function works like afc_string_comp(), but ASCII letters are compared
+			without looking at their case. No memory is allocated and the strings are not modified,
+			so it can be used in sort and search callbacks.
+
+		 INPUT: - str1              - First string to compare
+			- str2              - Second string to compare
+			- numchars		- How many chars to compare before quitting.
+					If you pass *ALL*, that means that the whole
+									strings will be compared
+
+		RESULT: -  a value < 0	 means	str1>str2
+		  -  a value > 0	 means	str2>str1
+			-  a value == 0	 means	str1==str2
+
+			NOTE: - This function can handle NULL pointers.
+			  - Chars are compared as lowercase, like strcasecmp() does in the "C" locale.
+
+	SEE ALSO: - afc_string_comp()
+@endnode
+*/
+signed long afc_string_casecomp(const char *s1, const char *s2, long chars)
+{
+	size_t max, len1, len2, len, pos;
+
+	if (s1 == NULL || s2 == NULL)
+		return (s1 == s2) ? 0 : (s1 ? 1 : -1);
+
+	max = (chars == ALL) ? (size_t)-1 : (size_t)chars;
+
+	len1 = strnlen(s1, max);
+	len2 = strnlen(s2, max);
+	len = (len1 < len2) ? len1 : len2;
+
+	if ((pos = afc_string_internal_casediff(s1, s2, len)) == max)
+		return 0;
+
+	// When /pos/ is /len/, one of the strings is over and its '\0' makes the difference
+	return -(signed long)(afc_string_internal_lower((unsigned char)s1[pos]) - afc_string_internal_lower((unsigned char)s2[pos]));
+}
+// }}}
 // {{{ afc_string_trim ( str )
 /*
 @node afc_string_trim
@@ -571,6 +706,339 @@ char *afc_string_trim(char *s)
 	return (s);
 }
 // }}}
+// {{{ search kernels
+/*
+   Substring search used by afc_string_instr(), afc_string_index_of(), afc_string_last_index_of() and the
+   replace functions. Blocks of 16 (SSE2) or 32 (AVX2) candidate positions are filtered comparing both the
+   first and the last char of the needle, and only the surviving candidates are checked with memcmp().
+   The best kernel for the running CPU is chosen the first time a search is done.
+*/
+typedef const char *(*afc_string_internal_find_fn)(const char *hay, size_t hay_len, const char *needle, size_t needle_len);
+
+static afc_string_internal_find_fn afc_string_internal_find_kernel = NULL;
+
+/* Chars between the first and the last one, that the block filters do not check */
+#define afc_string_internal_mid_len(len) ((len) > 2 ? (len) - 2 : 0)
+
+static const char *afc_string_internal_find_scalar(const char *hay, size_t hay_len, const char *needle, size_t needle_len)
+{
+	const char *p = hay;
+	const char *end = hay + hay_len - needle_len + 1;
+
+	while ((p < end) && ((p = memchr(p, needle[0], end - p)) != NULL))
+	{
+		if (memcmp(p + 1, needle + 1, needle_len - 1) == 0)
+			return (p);
+		p++;
+	}
+
+	return (NULL);
+}
+
+#ifdef AFC_STRING_INTERNAL_SIMD
+static const char *afc_string_internal_find_sse2(const char *hay, size_t hay_len, const char *needle, size_t needle_len)
+{
+	const __m128i first = _mm_set1_epi8(needle[0]);
+	const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+	size_t starts = hay_len - needle_len + 1;
+	size_t mid = afc_string_internal_mid_len(needle_len);
+	unsigned int mask;
+	size_t i;
+	int bit;
+
+	for (i = 0; i + 16 <= starts; i += 16)
+	{
+		__m128i b_first = _mm_loadu_si128((const __m128i *)(hay + i));
+		__m128i b_last = _mm_loadu_si128((const __m128i *)(hay + i + needle_len - 1));
+
+		mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(b_first, first), _mm_cmpeq_epi8(b_last, last)));
+
+		while (mask)
+		{
+			bit = __builtin_ctz(mask);
+			if (memcmp(hay + i + bit + 1, needle + 1, mid) == 0)
+				return (hay + i + bit);
+			mask &= mask - 1;
+		}
+	}
+
+	if (i < starts)
+		return (afc_string_internal_find_scalar(hay + i, hay_len - i, needle, needle_len));
+
+	return (NULL);
+}
+
+__attribute__((target("avx2"))) static const char *afc_string_internal_find_avx2(const char *hay, size_t hay_len, const char *needle, size_t needle_len)
+{
+	const __m256i first = _mm256_set1_epi8(needle[0]);
+	const __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+	size_t starts = hay_len - needle_len + 1;
+	size_t mid = afc_string_internal_mid_len(needle_len);
+	unsigned int mask;
+	size_t i;
+	int bit;
+
+	for (i = 0; i + 32 <= starts; i += 32)
+	{
+		__m256i b_first = _mm256_loadu_si256((const __m256i *)(hay + i));
+		__m256i b_last = _mm256_loadu_si256((const __m256i *)(hay + i + needle_len - 1));
+
+		mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(b_first, first), _mm256_cmpeq_epi8(b_last, last)));
+
+		while (mask)
+		{
+			bit = __builtin_ctz(mask);
+			if (memcmp(hay + i + bit + 1, needle + 1, mid) == 0)
+				return (hay + i + bit);
+			mask &= mask - 1;
+		}
+	}
+
+	if (i < starts)
+		return (afc_string_internal_find_sse2(hay + i, hay_len - i, needle, needle_len));
+
+	return (NULL);
+}
+#endif
+
+static afc_string_internal_find_fn afc_string_internal_find_select(void)
+{
+#ifdef AFC_STRING_INTERNAL_SIMD
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2"))
+		return (afc_string_internal_find_avx2);
+
+	return (afc_string_internal_find_sse2);
+#else
+	return (afc_string_internal_find_scalar);
+#endif
+}
+
+/* Returns the first occurrence of /needle/ in the first /hay_len/ chars of /hay/, or NULL */
+static const char *afc_string_internal_find(const char *hay, size_t hay_len, const char *needle, size_t needle_len)
+{
+	afc_string_internal_find_fn kernel;
+
+	if (needle_len == 0)
+		return (hay);
+	if (needle_len > hay_len)
+		return (NULL);
+	if (needle_len == 1)
+		return (memchr(hay, needle[0], hay_len));
+
+	// Every thread selects the same kernel, so a race here is harmless
+	if ((kernel = __atomic_load_n(&afc_string_internal_find_kernel, __ATOMIC_RELAXED)) == NULL)
+	{
+		kernel = afc_string_internal_find_select();
+		__atomic_store_n(&afc_string_internal_find_kernel, kernel, __ATOMIC_RELAXED);
+	}
+
+	return (kernel(hay, hay_len, needle, needle_len));
+}
+
+/* Returns the last occurrence of /needle/ starting at or before /hay/ + /last_start/, or NULL.
+   The caller grants that /last_start/ + /needle_len/ does not go past the end of /hay/. */
+static const char *afc_string_internal_rfind(const char *hay, size_t last_start, const char *needle, size_t needle_len)
+{
+	size_t starts = last_start + 1;
+#ifdef AFC_STRING_INTERNAL_SIMD
+	const __m128i first = _mm_set1_epi8(needle[0]);
+	const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+	size_t mid = afc_string_internal_mid_len(needle_len);
+	unsigned int mask;
+	int bit;
+
+	// SSE2 is always there on the targets where SIMD is enabled, so no dispatch is needed here
+	while (starts >= 16)
+	{
+		const char *block = hay + starts - 16;
+		__m128i b_first = _mm_loadu_si128((const __m128i *)block);
+		__m128i b_last = _mm_loadu_si128((const __m128i *)(block + needle_len - 1));
+
+		mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(b_first, first), _mm_cmpeq_epi8(b_last, last)));
+
+		while (mask)
+		{
+			bit = 31 - __builtin_clz(mask);
+			if (memcmp(block + bit + 1, needle + 1, mid) == 0)
+				return (block + bit);
+			mask &= ~(1u << bit);
+		}
+
+		starts -= 16;
+	}
+#endif
+
+	while (starts > 0)
+	{
+		starts--;
+		if ((hay[starts] == needle[0]) && (memcmp(hay + starts + 1, needle + 1, needle_len - 1) == 0))
+			return (hay + starts);
+	}
+
+	return (NULL);
+}
+// }}}
+// {{{ replace engine
+struct afc_string_internal_pattern
+{
+	const char *str;
+	const char *repl;
+	size_t len;
+	size_t repl_len;
+	const char *next; // Next occurrence in the source string (NULL when there are no more)
+};
+
+struct afc_string_internal_match
+{
+	size_t pos;
+	int pattern;
+};
+
+#define AFC_STRING_INTERNAL_PATTERNS 16
+#define AFC_STRING_INTERNAL_MATCHES 64
+
+/* Appends /len/ chars of /src/ to /out/, stopping at /max/ */
+static size_t afc_string_internal_put(char *out, size_t pos, size_t max, const char *src, size_t len)
+{
+	if (pos + len > max)
+		len = max - pos;
+
+	memcpy(out + pos, src, len);
+
+	return (pos + len);
+}
+
+/*
+   Replaces all the occurrences of /patterns/ in /str/ with the matching /replacements/, writing the result in the string pointed by /dest/.
+   The first pass finds the matches (at every position the first listed pattern wins) and computes the size of the
+   result, the second one copies the pieces. With /resize/ set, that string is replaced by a new AFC String when it is
+   too small; otherwise the result is truncated to its max size.
+*/
+static char *afc_string_internal_replace(char **dest, int resize, const char *str, const char **patterns, const char **replacements, int count)
+{
+	struct afc_string_internal_pattern pats_buf[AFC_STRING_INTERNAL_PATTERNS];
+	struct afc_string_internal_match matches_buf[AFC_STRING_INTERNAL_MATCHES];
+	struct afc_string_internal_pattern *pats = pats_buf;
+	struct afc_string_internal_match *matches = matches_buf, *m;
+	size_t matches_max = AFC_STRING_INTERNAL_MATCHES;
+	size_t num_matches = 0, num_pats = 0;
+	size_t str_len, pos, out_len, max, o, t;
+	char *out = *dest, *res = NULL;
+	int k, best;
+
+	str_len = strlen(str);
+
+	if ((count > AFC_STRING_INTERNAL_PATTERNS) && ((pats = afc_malloc(sizeof(struct afc_string_internal_pattern) * count)) == NULL))
+		return (NULL);
+
+	for (k = 0; k < count; k++)
+	{
+		if ((patterns[k] == NULL) || (patterns[k][0] == '\0') || (replacements[k] == NULL))
+			continue;
+
+		pats[num_pats].str = patterns[k];
+		pats[num_pats].repl = replacements[k];
+		pats[num_pats].len = strlen(patterns[k]);
+		pats[num_pats].repl_len = strlen(replacements[k]);
+		pats[num_pats].next = afc_string_internal_find(str, str_len, patterns[k], pats[num_pats].len);
+		num_pats++;
+	}
+
+	// First pass: find all the matches and the size of the result
+	pos = 0;
+	out_len = 0;
+
+	for (;;)
+	{
+		best = -1;
+
+		for (t = 0; t < num_pats; t++)
+		{
+			// This occurrence overlaps the last replaced one: look for the next one
+			if ((pats[t].next != NULL) && (pats[t].next < str + pos))
+				pats[t].next = afc_string_internal_find(str + pos, str_len - pos, pats[t].str, pats[t].len);
+
+			if ((pats[t].next != NULL) && ((best == -1) || (pats[t].next < pats[best].next)))
+				best = t;
+		}
+
+		if (best == -1)
+			break;
+
+		if (num_matches == matches_max)
+		{
+			matches_max *= 2;
+
+			if (matches == matches_buf)
+			{
+				if ((m = afc_malloc(sizeof(struct afc_string_internal_match) * matches_max)) != NULL)
+					memcpy(m, matches_buf, sizeof(matches_buf));
+			}
+			else
+				m = afc_realloc(matches, sizeof(struct afc_string_internal_match) * matches_max);
+
+			if (m == NULL)
+				goto done;
+
+			matches = m;
+		}
+
+		matches[num_matches].pos = pats[best].next - str;
+		matches[num_matches].pattern = best;
+		num_matches++;
+
+		out_len += (pats[best].next - str) - pos + pats[best].repl_len;
+		pos = (pats[best].next - str) + pats[best].len;
+	}
+
+	out_len += str_len - pos;
+
+	max = afc_string_max(out);
+
+	// With /str/ inside the destination the result goes in a new string too, or the copy would overwrite the source
+	if (resize && ((out_len > max) || ((str >= out) && (str <= out + max))))
+	{
+		if ((out = afc_string_new(out_len)) == NULL)
+			goto done;
+
+		max = out_len;
+	}
+
+	// Second pass: copy the pieces
+	pos = 0;
+	o = 0;
+
+	for (t = 0; (t < num_matches) && (o < max); t++)
+	{
+		o = afc_string_internal_put(out, o, max, str + pos, matches[t].pos - pos);
+		o = afc_string_internal_put(out, o, max, pats[matches[t].pattern].repl, pats[matches[t].pattern].repl_len);
+		pos = matches[t].pos + pats[matches[t].pattern].len;
+	}
+
+	o = afc_string_internal_put(out, o, max, str + pos, str_len - pos);
+
+	out[o] = '\0';
+	*((unsigned long *)(out - sizeof(unsigned long))) = o;
+
+	if (out != *dest)
+	{
+		afc_string_delete(*dest);
+		*dest = out;
+	}
+
+	res = out;
+
+done:
+	if (matches != matches_buf)
+		afc_free(matches);
+	if (pats != pats_buf)
+		afc_free(pats);
+
+	return (res);
+}
+// }}}
 // {{{ afc_string_instr ( str, match, start_pos )
 /*
 @node afc_string_instr
@@ -606,7 +1074,7 @@ char *afc_string_instr(const char *str, const char *match, unsigned long startpo
 	if (startpos > afc_string_len(str))
 		return NULL;
 
-	return ((char *)(strstr(str + startpos, match)));
+	return ((char *)afc_string_internal_find(str + startpos, strlen(str + startpos), match, strlen(match)));
 }
 // }}}
 // {{{ afc_string_left ( dest, src, len )
@@ -742,11 +1210,10 @@ unsigned long afc_string_reset_len(const char *str)
 */
 int afc_string_radix(char *dest, long n, int radix)
 {
-	char hexn[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_@";
-	long q = labs(n);
-	int r = 0;
-	int buf_size = 128;
-	char *buf;
+	static const char hexn[] = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_@";
+	unsigned long q = (n < 0) ? 0UL - (unsigned long)n : (unsigned long)n;
+	char buf[sizeof(long) * CHAR_BIT + 2];
+	char *p = buf + sizeof(buf);
 
 	if (dest == NULL)
 		return (-1);
@@ -754,1428 +1221,3792 @@ int afc_string_radix(char *dest, long n, int radix)
 	if (radix < 2 || radix > 64)
 		return (-1);
 
-	buf = afc_malloc(buf_size);
-	if (buf == NULL)
-		return (-1);
-
-	afc_string_copy(dest, "", ALL);
-
-	while (1)
+	if (radix == 10)
 	{
-		r = q % radix;
-
-		if (snprintf(buf, buf_size, "%c%s", hexn[r], dest) >= buf_size)
-		{
-			afc_free(buf);
-			return (-1);
-		}
-		afc_string_copy(dest, buf, ALL);
-
-		q = (q - r) / radix;
-
-		if (q == 0)
-			break;
+		afc_string_copy(dest, "", ALL);
+		afc_string_append_int(dest, n);
+		return (0);
 	}
 
-	if (n < 0)
+	// Digits are written backwards, from the end of the buffer
+	*--p = '\0';
+	do
 	{
-		if (snprintf(buf, buf_size, "-%s", dest) >= buf_size)
-		{
-			afc_free(buf);
-			return (-1);
-		}
-		afc_string_copy(dest, buf, ALL);
-	}
+		*--p = hexn[q % radix];
+		q /= radix;
+	} while (q);
+
+	if (n < 0)
+		*--p = '-';
 
-	afc_free(buf);
+	afc_string_copy(dest, p, ALL);
 
 	return (0);
 }
 // }}}
-// {{{ afc_string_hash ( string, turbolence )
+// {{{ number formatting internals
 /*
-@node afc_string_hash
+   Integers are written two digits at a time from a table of the 100 digit pairs, after counting the digits,
+   so that no division by 10 is done per digit and the number is written in place, left to right.
 
-			NAME: afc_string_hash ( string, turbolence ) - Creates an hash value for the string
+   Doubles use Grisu2 (Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers"):
+   the value and the boundaries of its rounding interval are scaled by a cached power of ten, and the digits are
+   generated with 64 bit integer arithmetic. The result always reads back as the same double, and it is the
+   shortest such string for about 99.5% of values.
+*/
+static const char afc_string_internal_digit_pairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
 
-	SYNOPSIS: unsigned long int afc_string_hash ( register unsigned char * string, unsigned long int turbolence )
+static const unsigned long long afc_string_internal_pow10[] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+	10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+	1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+	10000000000000000000ULL};
 
-		 DESCRIPTION: This function generates and hash value for the given /string/. An hash value is a (very long)
-					  number that tries to generate unique id (values) for one string. The /turbolence/ value is used
-					  to add some randomness to the given number. Please, remember that changing the /turbolence/ causes
-					  a different hash value to be generated. If you want always the same hash value for a specific /string/,
-					  you should always use the same /turbolence/
+typedef struct
+{
+	unsigned long long f;
+	int e;
+} afc_string_internal_diyfp;
+
+/* 10^-348, 10^-340, ..., 10^340 normalized to a 64 bit significand */
+static const afc_string_internal_diyfp afc_string_internal_cached_powers[] = {
+	{0xfa8fd5a0081c0288ULL, -1220}, {0xbaaee17fa23ebf76ULL, -1193}, {0x8b16fb203055ac76ULL, -1166},
+	{0xcf42894a5dce35eaULL, -1140}, {0x9a6bb0aa55653b2dULL, -1113}, {0xe61acf033d1a45dfULL, -1087},
+	{0xab70fe17c79ac6caULL, -1060}, {0xff77b1fcbebcdc4fULL, -1034}, {0xbe5691ef416bd60cULL, -1007},
+	{0x8dd01fad907ffc3cULL, -980}, {0xd3515c2831559a83ULL, -954}, {0x9d71ac8fada6c9b5ULL, -927},
+	{0xea9c227723ee8bcbULL, -901}, {0xaecc49914078536dULL, -874}, {0x823c12795db6ce57ULL, -847},
+	{0xc21094364dfb5637ULL, -821}, {0x9096ea6f3848984fULL, -794}, {0xd77485cb25823ac7ULL, -768},
+	{0xa086cfcd97bf97f4ULL, -741}, {0xef340a98172aace5ULL, -715}, {0xb23867fb2a35b28eULL, -688},
+	{0x84c8d4dfd2c63f3bULL, -661}, {0xc5dd44271ad3cdbaULL, -635}, {0x936b9fcebb25c996ULL, -608},
+	{0xdbac6c247d62a584ULL, -582}, {0xa3ab66580d5fdaf6ULL, -555}, {0xf3e2f893dec3f126ULL, -529},
+	{0xb5b5ada8aaff80b8ULL, -502}, {0x87625f056c7c4a8bULL, -475}, {0xc9bcff6034c13053ULL, -449},
+	{0x964e858c91ba2655ULL, -422}, {0xdff9772470297ebdULL, -396}, {0xa6dfbd9fb8e5b88fULL, -369},
+	{0xf8a95fcf88747d94ULL, -343}, {0xb94470938fa89bcfULL, -316}, {0x8a08f0f8bf0f156bULL, -289},
+	{0xcdb02555653131b6ULL, -263}, {0x993fe2c6d07b7facULL, -236}, {0xe45c10c42a2b3b06ULL, -210},
+	{0xaa242499697392d3ULL, -183}, {0xfd87b5f28300ca0eULL, -157}, {0xbce5086492111aebULL, -130},
+	{0x8cbccc096f5088ccULL, -103}, {0xd1b71758e219652cULL, -77}, {0x9c40000000000000ULL, -50},
+	{0xe8d4a51000000000ULL, -24}, {0xad78ebc5ac620000ULL, 3}, {0x813f3978f8940984ULL, 30},
+	{0xc097ce7bc90715b3ULL, 56}, {0x8f7e32ce7bea5c70ULL, 83}, {0xd5d238a4abe98068ULL, 109},
+	{0x9f4f2726179a2245ULL, 136}, {0xed63a231d4c4fb27ULL, 162}, {0xb0de65388cc8ada8ULL, 189},
+	{0x83c7088e1aab65dbULL, 216}, {0xc45d1df942711d9aULL, 242}, {0x924d692ca61be758ULL, 269},
+	{0xda01ee641a708deaULL, 295}, {0xa26da3999aef774aULL, 322}, {0xf209787bb47d6b85ULL, 348},
+	{0xb454e4a179dd1877ULL, 375}, {0x865b86925b9bc5c2ULL, 402}, {0xc83553c5c8965d3dULL, 428},
+	{0x952ab45cfa97a0b3ULL, 455}, {0xde469fbd99a05fe3ULL, 481}, {0xa59bc234db398c25ULL, 508},
+	{0xf6c69a72a3989f5cULL, 534}, {0xb7dcbf5354e9beceULL, 561}, {0x88fcf317f22241e2ULL, 588},
+	{0xcc20ce9bd35c78a5ULL, 614}, {0x98165af37b2153dfULL, 641}, {0xe2a0b5dc971f303aULL, 667},
+	{0xa8d9d1535ce3b396ULL, 694}, {0xfb9b7cd9a4a7443cULL, 720}, {0xbb764c4ca7a44410ULL, 747},
+	{0x8bab8eefb6409c1aULL, 774}, {0xd01fef10a657842cULL, 800}, {0x9b10a4e5e9913129ULL, 827},
+	{0xe7109bfba19c0c9dULL, 853}, {0xac2820d9623bf429ULL, 880}, {0x80444b5e7aa7cf85ULL, 907},
+	{0xbf21e44003acdd2dULL, 933}, {0x8e679c2f5e44ff8fULL, 960}, {0xd433179d9c8cb841ULL, 986},
+	{0x9e19db92b4e31ba9ULL, 1013}, {0xeb96bf6ebadf77d9ULL, 1039}, {0xaf87023b9bf0ee6bULL, 1066},
+};
+
+static int afc_string_internal_count_digits(unsigned long long n)
+{
+	int digits = 1;
 
-		 INPUT: - string				- String to be hashed.
-			- turbolence		- The starting value randomness
+	for (;;)
+	{
+		if (n < 10)
+			return (digits);
+		if (n < 100)
+			return (digits + 1);
+		if (n < 1000)
+			return (digits + 2);
+		if (n < 10000)
+			return (digits + 3);
+
+		n /= 10000;
+		digits += 4;
+	}
+}
 
-		RESULT: - 0 - The convertion worked properely
-			- non zero - Something went wrong.
+/* Writes /n/ in /buf/ (not NUL terminated) and returns the number of digits */
+static int afc_string_internal_utoa(char *buf, unsigned long long n)
+{
+	int len = afc_string_internal_count_digits(n);
+	int pos = len;
+	unsigned int i;
 
-			NOTE: - This function can handle NULL pointers.
+	while (n >= 100)
+	{
+		i = (unsigned int)(n % 100) * 2;
+		n /= 100;
+		buf[--pos] = afc_string_internal_digit_pairs[i + 1];
+		buf[--pos] = afc_string_internal_digit_pairs[i];
+	}
 
-	SEE ALSO:
+	if (n >= 10)
+	{
+		buf[1] = afc_string_internal_digit_pairs[n * 2 + 1];
+		buf[0] = afc_string_internal_digit_pairs[n * 2];
+	}
+	else
+		buf[0] = (char)('0' + n);
 
-	 CREDITS: Original code by Bob Jenkins
+	return (len);
+}
 
-@endnode
-*/
-unsigned long int afc_string_hash(const unsigned char *k, unsigned long int turbolence)
+/* Rounded high 64 bits of the 128 bit product */
+static afc_string_internal_diyfp afc_string_internal_diyfp_mul(afc_string_internal_diyfp x, afc_string_internal_diyfp y)
 {
-	unsigned long int a, b, c, len, length;
+	const unsigned long long m32 = 0xFFFFFFFFULL;
+	unsigned long long a = x.f >> 32, b = x.f & m32, c = y.f >> 32, d = y.f & m32;
+	unsigned long long ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+	unsigned long long tmp = (bd >> 32) + (ad & m32) + (bc & m32) + (1ULL << 31);
+	afc_string_internal_diyfp r;
 
-	if (k == NULL)
-		return (0);
+	r.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+	r.e = x.e + y.e + 64;
 
-	length = strlen((char *)k);
+	return (r);
+}
 
-	/* Set up the internal state */
-	len = length;
-	a = b = 0x9e3779b9; /* the golden ratio; an arbitrary value */
-	c = turbolence;		/* An init turbolence value */
+static void afc_string_internal_grisu_round(char *buf, int len, unsigned long long delta, unsigned long long rest, unsigned long long ten_kappa, unsigned long long wp_w)
+{
+	// Move the last digit towards the real value, while staying inside the rounding interval
+	while ((rest < wp_w) && (delta - rest >= ten_kappa) && ((rest + ten_kappa < wp_w) || (wp_w - rest > rest + ten_kappa - wp_w)))
+	{
+		buf[len - 1]--;
+		rest += ten_kappa;
+	}
+}
 
-	/*---------------------------------------- handle most of the key */
-	while (len >= 12)
+static int afc_string_internal_digit_gen(afc_string_internal_diyfp w, afc_string_internal_diyfp mp, unsigned long long delta, char *buf, int *k)
+{
+	const int shift = -mp.e;
+	const unsigned long long one = 1ULL << shift;
+	const unsigned long long wp_w = mp.f - w.f;
+	unsigned int p1 = (unsigned int)(mp.f >> shift);
+	unsigned long long p2 = mp.f & (one - 1), rest;
+	int kappa = afc_string_internal_count_digits(p1);
+	int len = 0;
+	unsigned int d;
+
+	// Integer part of the scaled upper boundary
+	while (kappa > 0)
 	{
-		a += (k[0] + ((unsigned long int)k[1] << 8) + ((unsigned long int)k[2] << 16) + ((unsigned long int)k[3] << 24));
-		b += (k[4] + ((unsigned long int)k[5] << 8) + ((unsigned long int)k[6] << 16) + ((unsigned long int)k[7] << 24));
-		c += (k[8] + ((unsigned long int)k[9] << 8) + ((unsigned long int)k[10] << 16) + ((unsigned long int)k[11] << 24));
-		afc_tools_internal_mix(a, b, c);
-		k += 12;
-		len -= 12;
+		d = p1 / (unsigned int)afc_string_internal_pow10[kappa - 1];
+		p1 %= (unsigned int)afc_string_internal_pow10[kappa - 1];
+		if (d || len)
+			buf[len++] = (char)('0' + d);
+		kappa--;
+
+		rest = ((unsigned long long)p1 << shift) + p2;
+		if (rest <= delta)
+		{
+			*k += kappa;
+			afc_string_internal_grisu_round(buf, len, delta, rest, afc_string_internal_pow10[kappa] << shift, wp_w);
+			return (len);
+		}
 	}
 
-	/*------------------------------------- handle the last 11 bytes */
-	c += length;
-	switch (len) /* all the case statements fall through */
+	// Fractional part
+	for (;;)
 	{
-	case 11:
-		c += ((unsigned long int)k[10] << 24);
-		// fall through
-	case 10:
-		c += ((unsigned long int)k[9] << 16);
-		// fall through
-	case 9:
-		c += ((unsigned long int)k[8] << 8);
-		/* the first byte of c is reserved for the length */
-		// fall through
-	case 8:
-		b += ((unsigned long int)k[7] << 24);
-		// fall through
-	case 7:
-		b += ((unsigned long int)k[6] << 16);
-		// fall through
-	case 6:
-		b += ((unsigned long int)k[5] << 8);
-		// fall through
-	case 5:
-		b += k[4];
-		// fall through
-	case 4:
-		a += ((unsigned long int)k[3] << 24);
-		// fall through
-	case 3:
-		a += ((unsigned long int)k[2] << 16);
-		// fall through
-	case 2:
-		a += ((unsigned long int)k[1] << 8);
-		// fall through
-	case 1:
-		a += k[0];
-		/* case 0: nothing left to add */
+		p2 *= 10;
+		delta *= 10;
+		d = (unsigned int)(p2 >> shift);
+		if (d || len)
+			buf[len++] = (char)('0' + d);
+		p2 &= one - 1;
+		kappa--;
+
+		if (p2 < delta)
+		{
+			*k += kappa;
+			afc_string_internal_grisu_round(buf, len, delta, p2, one, (-kappa < 20) ? wp_w * afc_string_internal_pow10[-kappa] : 0);
+			return (len);
+		}
 	}
-	afc_tools_internal_mix(a, b, c);
-	/*-------------------------------------------- report the result */
+}
 
-	return c;
+/* Writes digits of /value/ (finite and > 0) that round-trip, usually the shortest ones, in /buf/: value = digits * 10^k */
+static int afc_string_internal_grisu2(double value, char *buf, int *k)
+{
+	union
+	{
+		double d;
+		unsigned long long u;
+	} bits;
+	const unsigned long long hidden = 0x0010000000000000ULL;
+	afc_string_internal_diyfp v, w, mp, mm, c;
+	int be, shift;
+	unsigned int index;
+	double dk;
+
+	bits.d = value;
+	be = (int)((bits.u >> 52) & 0x7FF);
+	v.f = bits.u & (hidden - 1);
+
+	if (be)
+	{
+		v.f += hidden;
+		v.e = be - 1075;
+	}
+	else
+		v.e = -1074;
+
+	// Upper (mp) and lower (mm) boundaries of the values that round to /value/
+	mp.f = (v.f << 1) + 1;
+	mp.e = v.e - 1;
+	shift = __builtin_clzll(mp.f);
+	mp.f <<= shift;
+	mp.e -= shift;
+
+	if (v.f == hidden)
+	{
+		mm.f = (v.f << 2) - 1;
+		mm.e = v.e - 2;
+	}
+	else
+	{
+		mm.f = (v.f << 1) - 1;
+		mm.e = v.e - 1;
+	}
+	mm.f <<= mm.e - mp.e;
+	mm.e = mp.e;
+
+	shift = __builtin_clzll(v.f);
+	w.f = v.f << shift;
+	w.e = v.e - shift;
+
+	// The cached power that brings the exponent in [-60, -32]
+	dk = (-61 - mp.e) * 0.30102999566398114 + 347;
+	*k = (int)dk;
+	if (dk - *k > 0.0)
+		(*k)++;
+	index = (unsigned int)((*k >> 3) + 1);
+	*k = -(-348 + (int)(index << 3));
+	c = afc_string_internal_cached_powers[index];
+
+	w = afc_string_internal_diyfp_mul(w, c);
+	mp = afc_string_internal_diyfp_mul(mp, c);
+	mm = afc_string_internal_diyfp_mul(mm, c);
+	mm.f++;
+	mp.f--;
+
+	return (afc_string_internal_digit_gen(w, mp, mp.f - mm.f, buf, k));
+}
+
+/* Lays out /len/ digits with exponent /k/ (value = digits * 10^k) the way JavaScript does */
+static int afc_string_internal_prettify(char *buf, int len, int k)
+{
+	int kk = len + k; // 10^(kk - 1) <= value < 10^kk
+	int i;
+
+	if ((k >= 0) && (kk <= 21))
+	{
+		// 1234e7 -> 12340000000
+		memset(buf + len, '0', k);
+		return (kk);
+	}
+
+	if ((kk > 0) && (kk <= 21))
+	{
+		// 1234e-2 -> 12.34
+		memmove(buf + kk + 1, buf + kk, len - kk);
+		buf[kk] = '.';
+		return (len + 1);
+	}
+
+	if ((kk > -6) && (kk <= 0))
+	{
+		// 1234e-6 -> 0.001234
+		memmove(buf + 2 - kk, buf, len);
+		buf[0] = '0';
+		buf[1] = '.';
+		for (i = 2; i < 2 - kk; i++)
+			buf[i] = '0';
+		return (len + 2 - kk);
+	}
+
+	// 1234e30 -> 1.234e+33
+	if (len > 1)
+	{
+		memmove(buf + 2, buf + 1, len - 1);
+		buf[1] = '.';
+		len++;
+	}
+
+	buf[len++] = 'e';
+	kk--;
+	if (kk < 0)
+	{
+		buf[len++] = '-';
+		kk = -kk;
+	}
+	else
+		buf[len++] = '+';
+
+	return (len + afc_string_internal_utoa(buf + len, (unsigned long long)kk));
 }
 // }}}
-// {{{ afc_string_dup ( str )
+// {{{ afc_string_format_int ( buf, n )
 /*
-@node afc_string_dup
-
-			NAME: afc_string_dup ( string ) - Creates a new string with the same contents of the given one
+@node afc_string_format_int
 
-	SYNOPSIS: char * afc_string_dup ( const char * string )
+			NAME: afc_string_format_int ( buf, n ) - Writes an integer in a C buffer
 
-		 DESCRIPTION: This function allocates a new AFC string and copies the contents of the provided /string/ into it,
-					  It is a shorthand for afc_string_new() and afc_string_copy().
+	SYNOPSIS: int afc_string_format_int ( char * buf, long long n )
+	   SINCE: 1.08
 
-		 INPUT: - string				- String to be copied. It doesn't necessarily be an AFC string.
+		 DESCRIPTION: This function writes the decimal representation of /n/ in /buf/, followed by a NUL char.
+				It gives the same result as sprintf ( buf, "%lld", n ), but it is several times faster.
 
-		RESULT: - a new AFC string or NULL in case of errors (usually: no memory).
+		 INPUT: - buf				- The destination buffer. It must be at least AFC_STRING_NUMBER_SIZE chars long.
+			- n				- The number to write.
 
-			NOTE: - This function can handle NULL pointers.
-			- This is a new AFC string, like the ones usually created using afc_string_new(), so you have to
-				  explicitely deallocate it when you have finished, using the standard afc_string_delete() function.
+		RESULT: - the number of chars written, not counting the final NUL.
 
-	SEE ALSO: - afc_string_new ()
-				- afc_string_copy()
+	SEE ALSO: - afc_string_format_uint()
+		  - afc_string_format_double()
+		  - afc_string_append_int()
+		  - afc_string_parse_int()
 
 @endnode
 */
-char *_afc_string_dup(const char *str, const char *file, const char *func, const unsigned int line)
+int afc_string_format_int(char *buf, long long n)
 {
-	char *s;
-	unsigned long l;
+	int len = 0;
 
-	if (str == NULL)
-		return (NULL);
+	if (n < 0)
+	{
+		buf[len++] = '-';
+		len += afc_string_internal_utoa(buf + 1, 0ULL - (unsigned long long)n);
+	}
+	else
+		len = afc_string_internal_utoa(buf, (unsigned long long)n);
 
-	l = strlen(str);
+	buf[len] = '\0';
 
-	if (l == 0)
-		return (NULL);
+	return (len);
+}
+// }}}
+// {{{ afc_string_format_uint ( buf, n )
+/*
+@node afc_string_format_uint
 
-	if ((s = _afc_string_new(l, file, func, line)) == NULL)
-		return (NULL);
+			NAME: afc_string_format_uint ( buf, n ) - Writes an unsigned integer in a C buffer
 
-	afc_string_copy(s, str, ALL);
+	SYNOPSIS: int afc_string_format_uint ( char * buf, unsigned long long n )
+	   SINCE: 1.08
 
-	return (s);
+		 DESCRIPTION: This function writes the decimal representation of /n/ in /buf/, followed by a NUL char.
+				It gives the same result as sprintf ( buf, "%llu", n ).
+
+		 INPUT: - buf				- The destination buffer. It must be at least AFC_STRING_NUMBER_SIZE chars long.
+			- n				- The number to write.
+
+		RESULT: - the number of chars written, not counting the final NUL.
+
+	SEE ALSO: - afc_string_format_int()
+		  - afc_string_append_uint()
+
+@endnode
+*/
+int afc_string_format_uint(char *buf, unsigned long long n)
+{
+	int len = afc_string_internal_utoa(buf, n);
+
+	buf[len] = '\0';
+
+	return (len);
 }
 // }}}
-// {{{ afc_string_make ( str, fmt, ... )
+// {{{ afc_string_format_double ( buf, n )
 /*
-@node afc_string_make
+@node afc_string_format_double
 
-			NAME: afc_string_make ( string, fmt, ... ) - Copies data into string using the given fmt and args
+			NAME: afc_string_format_double ( buf, n ) - Writes a double in a C buffer
 
-	SYNOPSIS: char * afc_string_make ( char * string, const char * fmt, ... )
+	SYNOPSIS: int afc_string_format_double ( char * buf, double n )
+	   SINCE: 1.08
 
-		 DESCRIPTION: This function is a safe version of the standard sprintf. It does just the same things,
-					  but with bound checking, so you are pretty sure that the passed args will not be too big.
+		 DESCRIPTION: This function writes /n/ in /buf/, followed by a NUL char, using a string that reads back
+				exactly as the same double (with afc_string_parse_double() or strtod()). It is usually
+				the shortest such string: for about 0.5% of values, Grisu2 writes one digit more.
+				The layout is the one of JavaScript: integer values have no decimal part ("42"), very
+				small or very big values use the exponent ("1e+21", "1.5e-7").
 
-		 INPUT: - string				- Destination AFC string.
-			- fmt                 - Format string. It uses the same syntax of printf or sprintf.
-			- ...                 - All the params needed.
+		 INPUT: - buf				- The destination buffer. It must be at least AFC_STRING_NUMBER_SIZE chars long.
+			- n				- The number to write.
 
-		RESULT: - the string just produced.
+		RESULT: - the number of chars written, not counting the final NUL.
 
-			NOTE: - This function can handle NULL pointers.
+			NOTE: - Infinite values are written as "inf" and "-inf", NaN as "nan".
 
-	SEE ALSO: - afc_string_new ()
-				- afc_string_copy()
+	SEE ALSO: - afc_string_format_int()
+		  - afc_string_append_double()
+		  - afc_string_parse_double()
 
 @endnode
 */
-char *afc_string_make(char *dest, const char *fmt, ...)
+int afc_string_format_double(char *buf, double n)
 {
-	va_list ap;
+	int len = 0, digits, k;
 
-	if ((dest == NULL) || (fmt == NULL))
-		return (NULL);
+	if (isnan(n))
+	{
+		memcpy(buf, "nan", 4);
+		return (3);
+	}
 
-	va_start(ap, fmt);
+	if (signbit(n))
+	{
+		buf[len++] = '-';
+		n = -n;
+	}
 
-	vsnprintf(dest, afc_string_max(dest) + 1, fmt, ap); // Flawfinder: ignore
+	if (isinf(n))
+	{
+		memcpy(buf + len, "inf", 4);
+		return (len + 3);
+	}
 
-	va_end(ap);
+	if (n == 0.0)
+	{
+		buf[len++] = '0';
+		buf[len] = '\0';
+		return (len);
+	}
 
-	afc_string_reset_len(dest);
+	digits = afc_string_internal_grisu2(n, buf + len, &k);
+	len += afc_string_internal_prettify(buf + len, digits, k);
+	buf[len] = '\0';
 
-	return (dest);
+	return (len);
 }
 // }}}
-// {{{ afc_string_fget ( dest, file )
+// {{{ afc_string_append_int ( dest, n )
 /*
-@node afc_string_fget
-
-			NAME: afc_string_fget ( deststring, file ) - Get a line of text from a file
-
-	SYNOPSIS: char * afc_string_fget ( char * deststring, FILE * file )
+@node afc_string_append_int
 
-		 DESCRIPTION: Use this function to read a line of text from a file.
-			This function is advanced considering the usual C /fgets/
-			command: it does bound checking so you don't have to do any
-			control before reading from the file.
+			NAME: afc_string_append_int ( dest, n ) - Appends an integer to an AFC string
 
-		 INPUT: - deststring		- Destination string. This string MUST be an AFC string
-					created using afc_string_new ()
+	SYNOPSIS: char * afc_string_append_int ( char * dest, long long n )
+	   SINCE: 1.08
 
-			- file		- A valid file handler where to get the string from.
+		 DESCRIPTION: This function appends the decimal representation of /n/ to /dest/, without going
+				through a format string. Like afc_string_add(), the result is truncated if /dest/ is full.
 
-		RESULT: - The resulting string or NULL if end of file has been encountered.
+		 INPUT: - dest				- The AFC string to append the number to.
+			- n				- The number to append.
 
-			NOTE: - this function can handle NULL pointers
+		RESULT: - /dest/, or NULL if /dest/ is NULL.
 
-	SEE ALSO:
+	SEE ALSO: - afc_string_append_uint()
+		  - afc_string_append_double()
+		  - afc_string_format_int()
 
 @endnode
 */
-char *afc_string_fget(char *dest, FILE *fh)
+char *afc_string_append_int(char *dest, long long n)
 {
-	if ((dest == NULL) || (fh == NULL))
-		return (NULL);
-
-	afc_string_clear(dest);
+	char buf[AFC_STRING_NUMBER_SIZE];
 
-	if (fgets(dest, afc_string_max(dest), fh) == NULL)
-		return (NULL);
-
-	afc_string_reset_len(dest);
-
-	return (dest);
+	return (afc_string_add(dest, buf, afc_string_format_int(buf, n)));
 }
 // }}}
-// {{{ afc_string_add ( dest, source, len )
+// {{{ afc_string_append_uint ( dest, n )
 /*
-@node afc_string_add
+@node afc_string_append_uint
 
-			NAME: afc_string_add (deststring, sourcestring, len ) - Add a string to the current one
-
-	SYNOPSIS: char * afc_string_add ( char * deststring, const char * sourcestring, unsigned long len)
-
-		 DESCRIPTION: Use this function to append a string at the end of another.
-			This function is advanced considering the usual C strcat
-			command: it does bound checking so you don't have to do any
-			control before appending.
+			NAME: afc_string_append_uint ( dest, n ) - Appends an unsigned integer to an AFC string
 
-		 INPUT: - deststring		- Destination string. This string MUST be an AFC string
-					created using afc_string_new ()
-
-			- sourcestring	- Source string. This string can be anything, a static
-					string, an AFC string , a memory area...
+	SYNOPSIS: char * afc_string_append_uint ( char * dest, unsigned long long n )
+	   SINCE: 1.08
 
-			- len		 - Here you can specify how many chars to copy. Pass the value /ALL/ to copy the whole string.
+		 DESCRIPTION: This function appends the decimal representation of /n/ to /dest/.
+				Like afc_string_add(), the result is truncated if /dest/ is full.
 
-		RESULT: - The resulting string.
+		 INPUT: - dest				- The AFC string to append the number to.
+			- n				- The number to append.
 
-			NOTE: - this function can handle NULL pointers
+		RESULT: - /dest/, or NULL if /dest/ is NULL.
 
-	SEE ALSO: - afc_string_copy()
+	SEE ALSO: - afc_string_append_int()
+		  - afc_string_format_uint()
 
 @endnode
 */
-char *afc_string_add(char *dest, const char *source, unsigned long len)
+char *afc_string_append_uint(char *dest, unsigned long long n)
 {
-	unsigned long m, srclen, clen;
+	char buf[AFC_STRING_NUMBER_SIZE];
 
-	if (!(dest && source))
-		return (NULL);
+	return (afc_string_add(dest, buf, afc_string_format_uint(buf, n)));
+}
+// }}}
+// {{{ afc_string_append_double ( dest, n )
+/*
+@node afc_string_append_double
 
-	srclen = strlen(source);
+			NAME: afc_string_append_double ( dest, n ) - Appends a double to an AFC string
 
-	clen = afc_string_len(dest);
-	m = afc_string_max(dest) - clen;
+	SYNOPSIS: char * afc_string_append_double ( char * dest, double n )
+	   SINCE: 1.08
 
-	if ((long)len == ALL)
-		len = srclen;
+		 DESCRIPTION: This function appends /n/ to /dest/, using a string that reads back exactly as the
+				same double, usually the shortest one. See afc_string_format_double() for the format used.
+				Like afc_string_add(), the result is truncated if /dest/ is full.
 
-	if (len > m)
-		len = m;
-	if (len > srclen)
-		len = srclen;
+		 INPUT: - dest				- The AFC string to append the number to.
+			- n				- The number to append.
 
-	*((unsigned long *)(dest - sizeof(unsigned long))) = clen + len;
+		RESULT: - /dest/, or NULL if /dest/ is NULL.
 
-	memmove(dest + clen, source, len);
-	dest[clen + len] = '\0';
+	SEE ALSO: - afc_string_append_int()
+		  - afc_string_format_double()
 
-	return (dest);
+@endnode
+*/
+char *afc_string_append_double(char *dest, double n)
+{
+	char buf[AFC_STRING_NUMBER_SIZE];
+
+	return (afc_string_add(dest, buf, afc_string_format_double(buf, n)));
 }
 // }}}
-// {{{ afc_string_temp ( path )
+// {{{ afc_string_parse_int ( str, len, value )
 /*
-@node afc_string_temp
+@node afc_string_parse_int
 
-		NAME: afc_string_temp ( path ) - Creates a temporary file name
+			NAME: afc_string_parse_int ( str, len, value ) - Reads an integer from a string
 
-	SYNOPSIS: char * afc_string_temp ( const char * path )
+	SYNOPSIS: unsigned long afc_string_parse_int ( const char * str, unsigned long len, long long * value )
+	   SINCE: 1.08
 
-	 DESCRIPTION: This function creates a new string containing an unique name, not avaible
-		  in the given path when checking. This is useful when you want to create,
-		  for example, some temporary files and want to be sure an unique name is used.
-		  In the /path/ you should also specify a /prefix/ for the temporary file being
-		  created. If for example, you want to create a temp file in "/tmp" with the prefix
-		  "temp", you should write "/tmp/temp" and the temp file name you'll get back will
-		  be something like "/tmp/tempVt6Akr".
+		 DESCRIPTION: This function reads a decimal integer, with an optional '+' or '-' sign, from the first
+				/len/ chars of /str/. Parsing stops at the first char that is not a digit.
+				Unlike strtol(), leading spaces are not skipped and the string does not need to be
+				NUL terminated, so it can be used on views and on buffers read from the network.
 
+		 INPUT: - str				- The string to read the number from.
+			- len				- Max number of chars to read. Use ALL to read up to the end of /str/.
+			- value				- Pointer to the variable that will hold the number.
 
-	   INPUT: - path		- The path in the filesystem to check against unique name.
+		RESULT: - the number of chars used by the number.
+			- 0 if /str/ does not start with a number, or if the number does not fit in a long long.
+			  In this case /value/ is not changed.
 
-	  RESULT: - A *new* AFC string, that you'll need to free with afc_string_delete() when you're done.
-		  - A NULL value means an error occurred.
+	SEE ALSO: - afc_string_parse_double()
+		  - afc_string_format_int()
 
-		NOTE: - To avoid race conditions, this function actually creates the file in the specified path.
-			This should not be a problem, since you are going to create that file anyway and you have the
-			permissions to do that.
-		  - this function can handle NULL pointers
-			  - remember to free the string using afc_string_delete() when you have finished with it.
+@endnode
+*/
+unsigned long afc_string_parse_int(const char *str, unsigned long len, long long *value)
+{
+	unsigned long long n = 0, limit = LLONG_MAX;
+	unsigned long i = 0, start;
+	unsigned int d;
+	int neg = FALSE;
 
-	SEE ALSO: - afc_string_delete()
-		  - stdio.h/tempnam call.
-		  - stdlib.h/mkstemp call.
+	if ((str == NULL) || (value == NULL))
+		return (0);
+
+	if ((long)len == ALL)
+		len = strlen(str);
+
+	if ((len > 0) && ((str[0] == '-') || (str[0] == '+')))
+	{
+		neg = (str[0] == '-');
+		limit += neg;
+		i++;
+	}
+
+	for (start = i; (i < len) && ((d = (unsigned int)(str[i] - '0')) < 10); i++)
+	{
+		if (n > (limit - d) / 10)
+			return (0);
+		n = n * 10 + d;
+	}
+
+	if (i == start)
+		return (0);
+
+	*value = neg ? (long long)(0ULL - n) : (long long)n;
+
+	return (i);
+}
+// }}}
+// {{{ afc_string_parse_double ( str, len, value )
+/*
+@node afc_string_parse_double
+
+			NAME: afc_string_parse_double ( str, len, value ) - Reads a double from a string
+
+	SYNOPSIS: unsigned long afc_string_parse_double ( const char * str, unsigned long len, double * value )
+	   SINCE: 1.08
+
+		 DESCRIPTION: This function reads a decimal number, like "-12", "3.25" or "1.5e-7", from the first
+				/len/ chars of /str/. The result is always the double nearest to the number.
+				Numbers with up to 15 significant digits and a small exponent (the vast majority of the
+				numbers written by people and by programs) are converted exactly with one multiplication
+				or division; the others, like most doubles written with 17 digits, are converted by strtod().
+
+		 INPUT: - str				- The string to read the number from.
+			- len				- Max number of chars to read. Use ALL to read up to the end of /str/.
+			- value				- Pointer to the variable that will hold the number.
+
+		RESULT: - the number of chars used by the number.
+			- 0 if /str/ does not start with a number. In this case /value/ is not changed.
+
+			NOTE: - Leading spaces are not skipped. "inf", "nan" and hexadecimal numbers are not accepted.
+
+	SEE ALSO: - afc_string_parse_int()
+		  - afc_string_format_double()
 
 @endnode
 */
-char *afc_string_temp(const char *path)
+unsigned long afc_string_parse_double(const char *str, unsigned long len, double *value)
 {
-	char *tmp;
-	int fd;
-#ifdef MINGW
-	char *name;
-#endif
-	char *p;
+	static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+								   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	unsigned long long mantissa = 0;
+	unsigned long i = 0, j;
+	int digits = 0, exp10 = 0, exp = 0, exp_neg = FALSE, neg = FALSE, any = FALSE;
+	char sbuf[64], *buf;
+	double res;
+
+	if ((str == NULL) || (value == NULL))
+		return (0);
 
-	if (path == NULL)
-		path = "/tmp/afc";
+	if ((long)len == ALL)
+		len = strlen(str);
 
-#ifdef MINGW
-	p = afc_string_dirname(path);
+	if ((len > 0) && ((str[0] == '-') || (str[0] == '+')))
+	{
+		neg = (str[0] == '-');
+		i++;
+	}
 
-	/* tempnam adds "file" prefix to the file name */
-	tmp = afc_string_new(afc_string_len(p) + 11);
-#else
-	p = (char *)path;
-	tmp = afc_string_new(strlen(p) + 7);
+	// Significant digits: leading zeros do not count, the ones after the 19th only change the exponent
+	for (; (i < len) && (str[i] >= '0') && (str[i] <= '9'); i++, any = TRUE)
+	{
+		if ((mantissa == 0) && (str[i] == '0'))
+			continue;
+		if (digits++ < 19)
+			mantissa = mantissa * 10 + (str[i] - '0');
+		else
+			exp10++;
+	}
+
+	if ((i < len) && (str[i] == '.'))
+	{
+		for (i++; (i < len) && (str[i] >= '0') && (str[i] <= '9'); i++, any = TRUE)
+		{
+			if ((mantissa == 0) && (str[i] == '0'))
+			{
+				exp10--;
+				continue;
+			}
+			if (digits++ < 19)
+			{
+				mantissa = mantissa * 10 + (str[i] - '0');
+				exp10--;
+			}
+		}
+	}
+
+	if (!any)
+		return (0);
+
+	// The exponent is used only if it has at least one digit
+	if ((i < len) && ((str[i] == 'e') || (str[i] == 'E')))
+	{
+		j = i + 1;
+		if ((j < len) && ((str[j] == '-') || (str[j] == '+')))
+			exp_neg = (str[j++] == '-');
+
+		if ((j < len) && (str[j] >= '0') && (str[j] <= '9'))
+		{
+			for (; (j < len) && (str[j] >= '0') && (str[j] <= '9'); j++)
+				if (exp < 100000)
+					exp = exp * 10 + (str[j] - '0');
+			i = j;
+		}
+	}
+
+	exp10 += exp_neg ? -exp : exp;
+
+#if FLT_EVAL_METHOD == 0
+	// Both the mantissa and 10^exp10 are exact doubles: a single rounding gives the nearest double
+	if ((digits <= 19) && (mantissa <= (1ULL << 53)) && (exp10 >= -22) && (exp10 <= 22))
+	{
+		res = (double)mantissa;
+		res = (exp10 < 0) ? res / pow10[-exp10] : res * pow10[exp10];
+		*value = neg ? -res : res;
+		return (i);
+	}
 #endif
 
-	if (tmp == NULL)
-		return (NULL);
+	if (mantissa == 0)
+	{
+		*value = neg ? -0.0 : 0.0;
+		return (i);
+	}
 
-	afc_string_make(tmp, "%sXXXXXX", path);
+	// The hard cases are left to strtod(), on a NUL terminated copy of the number
+	if (i < sizeof(sbuf))
+		buf = sbuf;
+	else if ((buf = afc_malloc(i + 1)) == NULL)
+		return (0);
 
-#ifdef MINGW
-	if ((name = tempnam(p, NULL)) == NULL)
+	memcpy(buf, str, i);
+	buf[i] = '\0';
+	res = strtod(buf, NULL);
+
+	if (buf != sbuf)
+		afc_free(buf);
+
+	*value = res;
+
+	return (i);
+}
+// }}}
+// {{{ afc_string_hash ( string, turbolence )
+/*
+@node afc_string_hash
+
+			NAME: afc_string_hash ( string, turbolence ) - Creates an hash value for the string
+
+	SYNOPSIS: unsigned long int afc_string_hash ( register unsigned char * string, unsigned long int turbolence )
+
+		 DESCRIPTION: This function generates and hash value for the given /string/. An hash value is a (very long)
+					  number that tries to generate unique id (values) for one string. The /turbolence/ value is used
+					  to add some randomness to the given number. Please, remember that changing the /turbolence/ causes
+					  a different hash value to be generated. If you want always the same hash value for a specific /string/,
+					  you should always use the same /turbolence/
+
+		 INPUT: - string				- String to be hashed.
+			- turbolence		- The starting value randomness
+
+		RESULT: - 0 - The convertion worked properely
+			- non zero - Something went wrong.
+
+			NOTE: - This function can handle NULL pointers.
+			  - New code should use afc_string_hash64(), that is faster and does not need to scan the string
+				to know its length.
+
+	SEE ALSO: - afc_string_hash64()
+
+	 CREDITS: Original code by Bob Jenkins
+
+@endnode
+*/
+unsigned long int afc_string_hash(const unsigned char *k, unsigned long int turbolence)
+{
+	unsigned long int a, b, c, len, length;
+
+	if (k == NULL)
+		return (0);
+
+	length = strlen((char *)k);
+
+	/* Set up the internal state */
+	len = length;
+	a = b = 0x9e3779b9; /* the golden ratio; an arbitrary value */
+	c = turbolence;		/* An init turbolence value */
+
+	/*---------------------------------------- handle most of the key */
+	while (len >= 12)
 	{
-		afc_string_delete(p);
-		afc_string_delete(tmp);
-		return (NULL);
+		a += (k[0] + ((unsigned long int)k[1] << 8) + ((unsigned long int)k[2] << 16) + ((unsigned long int)k[3] << 24));
+		b += (k[4] + ((unsigned long int)k[5] << 8) + ((unsigned long int)k[6] << 16) + ((unsigned long int)k[7] << 24));
+		c += (k[8] + ((unsigned long int)k[9] << 8) + ((unsigned long int)k[10] << 16) + ((unsigned long int)k[11] << 24));
+		afc_tools_internal_mix(a, b, c);
+		k += 12;
+		len -= 12;
 	}
 
-	afc_string_copy(tmp, name, ALL);
+	/*------------------------------------- handle the last 11 bytes */
+	c += length;
+	switch (len) /* all the case statements fall through */
+	{
+	case 11:
+		c += ((unsigned long int)k[10] << 24);
+		// fall through
+	case 10:
+		c += ((unsigned long int)k[9] << 16);
+		// fall through
+	case 9:
+		c += ((unsigned long int)k[8] << 8);
+		/* the first byte of c is reserved for the length */
+		// fall through
+	case 8:
+		b += ((unsigned long int)k[7] << 24);
+		// fall through
+	case 7:
+		b += ((unsigned long int)k[6] << 16);
+		// fall through
+	case 6:
+		b += ((unsigned long int)k[5] << 8);
+		// fall through
+	case 5:
+		b += k[4];
+		// fall through
+	case 4:
+		a += ((unsigned long int)k[3] << 24);
+		// fall through
+	case 3:
+		a += ((unsigned long int)k[2] << 16);
+		// fall through
+	case 2:
+		a += ((unsigned long int)k[1] << 8);
+		// fall through
+	case 1:
+		a += k[0];
+		/* case 0: nothing left to add */
+	}
+	afc_tools_internal_mix(a, b, c);
+	/*-------------------------------------------- report the result */
 
-	afc_string_delete(p);
-	free(name);
-	name = NULL;
+	return c;
+}
+// }}}
+// {{{ afc_string_hash64 ( data, len, seed )
+/* 64x64 -> 128 bit multiplication: *a gets the low 64 bits, *b the high ones */
+static void afc_string_internal_mul128(unsigned long long *a, unsigned long long *b)
+{
+#ifdef __SIZEOF_INT128__
+	__uint128_t r = (__uint128_t)*a * *b;
 
-	if ((fd = open(tmp, O_CREAT | O_EXCL)) == -1)
+	*a = (unsigned long long)r;
+	*b = (unsigned long long)(r >> 64);
 #else
-	if ((fd = mkstemp(tmp)) == -1)
+	unsigned long long ha = *a >> 32, hb = *b >> 32, la = (unsigned int)*a, lb = (unsigned int)*b;
+	unsigned long long rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32), lo, hi;
+
+	hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl);
+	lo = t + (rm1 << 32);
+	hi += (lo < t);
+
+	*a = lo;
+	*b = hi;
 #endif
+}
+
+/* 128 bit product folded back to 64 bits */
+static unsigned long long afc_string_internal_mum(unsigned long long a, unsigned long long b)
+{
+	afc_string_internal_mul128(&a, &b);
+
+	return (a ^ b);
+}
+
+/* Unaligned little endian loads (on big endian machines the hash values are different, but still good) */
+static unsigned long long afc_string_internal_read64(const unsigned char *p)
+{
+	unsigned long long v;
+
+	memcpy(&v, p, 8);
+	return (v);
+}
+
+static unsigned long long afc_string_internal_read32(const unsigned char *p)
+{
+	unsigned int v;
+
+	memcpy(&v, p, 4);
+	return (v);
+}
+
+/*
+@node afc_string_hash64
+
+			NAME: afc_string_hash64 ( data, len, seed ) - Creates a 64 bit hash value for a block of memory
+
+	SYNOPSIS: unsigned long long afc_string_hash64 ( const void * data, unsigned long len, unsigned long long seed )
+
+	   SINCE: 1.02
+
+		 DESCRIPTION: This function generates a 64 bit hash value for the first /len/ bytes of /data/. Unlike afc_string_hash(),
+					  the length is given, so /data/ does not need to be zero terminated and can contain zeros, and the
+					  memory is read 8 bytes at a time.
+
+					  Different /seed/ values generate completely different hash values: if the data to hash comes from
+					  the outside world (for example, CGI form fields), use a seed returned by afc_string_hash_seed(),
+					  so that nobody can guess keys that all get the same hash value.
+
+		 INPUT: - data				- Memory to be hashed.
+			- len				- Number of bytes to hash.
+			- seed				- The starting value.
+
+		RESULT: - The hash value.
+
+			NOTE: - This function can handle NULL pointers.
+
+	SEE ALSO: - afc_string_hash_seed()
+			  - afc_string_hash()
+
+	 CREDITS: Based on wyhash (final version 4) by Wang Yi, released in the public domain.
+
+@endnode
+*/
+unsigned long long afc_string_hash64(const void *data, unsigned long len, unsigned long long seed)
+{
+	static const unsigned long long secret[4] = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+	const unsigned char *p = (const unsigned char *)data;
+	unsigned long long a, b, see1, see2;
+	unsigned long i = len;
+
+	if (p == NULL)
+		i = len = 0;
+
+	seed ^= afc_string_internal_mum(seed ^ secret[0], secret[1]);
+
+	if (len <= 16)
 	{
-		fprintf(stderr, "afc_string_temp() error: %s\n", strerror(errno));
-		afc_string_delete(tmp);
-		return (NULL);
+		if (len >= 4)
+		{
+			// Two overlapping 32 bit loads from each end cover 4 up to 16 bytes
+			a = (afc_string_internal_read32(p) << 32) | afc_string_internal_read32(p + ((len >> 3) << 2));
+			b = (afc_string_internal_read32(p + len - 4) << 32) | afc_string_internal_read32(p + len - 4 - ((len >> 3) << 2));
+		}
+		else if (len > 0)
+		{
+			a = ((unsigned long long)p[0] << 16) | ((unsigned long long)p[len >> 1] << 8) | p[len - 1];
+			b = 0;
+		}
+		else
+			a = b = 0;
 	}
+	else
+	{
+		if (i > 48)
+		{
+			see1 = seed;
+			see2 = seed;
 
-	close(fd); // Close the file descriptor
+			// Three independent lanes, 48 bytes per round
+			do
+			{
+				seed = afc_string_internal_mum(afc_string_internal_read64(p) ^ secret[1], afc_string_internal_read64(p + 8) ^ seed);
+				see1 = afc_string_internal_mum(afc_string_internal_read64(p + 16) ^ secret[2], afc_string_internal_read64(p + 24) ^ see1);
+				see2 = afc_string_internal_mum(afc_string_internal_read64(p + 32) ^ secret[3], afc_string_internal_read64(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+
+			seed ^= see1 ^ see2;
+		}
 
-	return (tmp);
+		while (i > 16)
+		{
+			seed = afc_string_internal_mum(afc_string_internal_read64(p) ^ secret[1], afc_string_internal_read64(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+
+		// The last 16 bytes (they may overlap with the ones already hashed)
+		a = afc_string_internal_read64(p + i - 16);
+		b = afc_string_internal_read64(p + i - 8);
+	}
+
+	a ^= secret[1];
+	b ^= seed;
+	afc_string_internal_mul128(&a, &b);
+
+	return (afc_string_internal_mum(a ^ secret[0] ^ len, b ^ secret[1]));
+}
+// }}}
+// {{{ afc_string_hash_seed ()
+/*
+@node afc_string_hash_seed
+
+			NAME: afc_string_hash_seed () - Returns a random seed for afc_string_hash64()
+
+	SYNOPSIS: unsigned long long afc_string_hash_seed ( void )
+
+	   SINCE: 1.02
+
+		 DESCRIPTION: This function returns a new random value to be used as the /seed/ of afc_string_hash64().
+					  Every call returns a different value, so every hash table can have its own seed.
+
+		 INPUT: NONE
+
+		RESULT: - A random seed.
+
+			NOTE: - Random bytes are read from /dev/urandom once per process. If it is not available, the time
+					and the process id are used instead.
+			- It can be called by many threads at the same time: they all get different seeds.
+
+	SEE ALSO: - afc_string_hash64()
+
+@endnode
+*/
+unsigned long long afc_string_hash_seed(void)
+{
+	unsigned long long counter;
+
+#ifndef MINGW
+	pthread_once(&afc_string_internal_seed_once, afc_string_internal_seed_init);
+#else
+	if (afc_string_internal_seed_base == 0)
+		afc_string_internal_seed_init();
+#endif
+
+	// Every seed is the hash of a different counter value, even when Dictionaries are created by many threads
+	counter = __atomic_add_fetch(&afc_string_internal_seed_counter, 1, __ATOMIC_RELAXED);
+
+	return (afc_string_hash64(&counter, sizeof(counter), afc_string_internal_seed_base));
+}
+// }}}
+// {{{ afc_string_internal_seed_init ()
+/* Reads the base of the seeds: it is done just once, by the first thread asking for a seed */
+static void afc_string_internal_seed_init(void)
+{
+	unsigned long long base = 0;
+	FILE *fh;
+
+	if ((fh = fopen("/dev/urandom", "rb")) != NULL)
+	{
+		if (fread(&base, sizeof(base), 1, fh) != 1)
+			base = 0;
+		fclose(fh);
+	}
+
+	base ^= ((unsigned long long)time(NULL) << 20) ^ (unsigned long long)getpid() ^ (unsigned long long)(unsigned long)&base;
+
+	afc_string_internal_seed_base = base | 1;
+}
+// }}}
+// {{{ afc_string_dup ( str )
+/*
+@node afc_string_dup
+
+			NAME: afc_string_dup ( string ) - Creates a new string with the same contents of the given one
+
+	SYNOPSIS: char * afc_string_dup ( const char * string )
+
+		 DESCRIPTION: This function allocates a new AFC string and copies the contents of the provided /string/ into it,
+					  It is a shorthand for afc_string_new() and afc_string_copy().
+
+		 INPUT: - string				- String to be copied. It doesn't necessarily be an AFC string.
+
+		RESULT: - a new AFC string or NULL in case of errors (usually: no memory).
+
+			NOTE: - This function can handle NULL pointers.
+			- This is a new AFC string, like the ones usually created using afc_string_new(), so you have to
+				  explicitely deallocate it when you have finished, using the standard afc_string_delete() function.
+
+	SEE ALSO: - afc_string_new ()
+				- afc_string_copy()
+
+@endnode
+*/
+char *_afc_string_dup(const char *str, const char *file, const char *func, const unsigned int line)
+{
+	char *s;
+	unsigned long l;
+
+	if (str == NULL)
+		return (NULL);
+
+	l = strlen(str);
+
+	if (l == 0)
+		return (NULL);
+
+	if ((s = _afc_string_new(l, file, func, line)) == NULL)
+		return (NULL);
+
+	afc_string_copy(s, str, ALL);
+
+	return (s);
+}
+// }}}
+// {{{ afc_string_make ( str, fmt, ... )
+/*
+@node afc_string_make
+
+			NAME: afc_string_make ( string, fmt, ... ) - Copies data into string using the given fmt and args
+
+	SYNOPSIS: char * afc_string_make ( char * string, const char * fmt, ... )
+
+		 DESCRIPTION: This function is a safe version of the standard sprintf. It does just the same things,
+					  but with bound checking, so you are pretty sure that the passed args will not be too big.
+
+		 INPUT: - string				- Destination AFC string.
+			- fmt                 - Format string. It uses the same syntax of printf or sprintf.
+			- ...                 - All the params needed.
+
+		RESULT: - the string just produced.
+
+			NOTE: - This function can handle NULL pointers.
+
+	SEE ALSO: - afc_string_new ()
+				- afc_string_copy()
+
+@endnode
+*/
+char *afc_string_make(char *dest, const char *fmt, ...)
+{
+	va_list ap;
+
+	if ((dest == NULL) || (fmt == NULL))
+		return (NULL);
+
+	va_start(ap, fmt);
+
+	vsnprintf(dest, afc_string_max(dest) + 1, fmt, ap); // Flawfinder: ignore
+
+	va_end(ap);
+
+	afc_string_reset_len(dest);
+
+	return (dest);
+}
+// }}}
+// {{{ afc_string_fget ( dest, file )
+/*
+@node afc_string_fget
+
+			NAME: afc_string_fget ( deststring, file ) - Get a line of text from a file
+
+	SYNOPSIS: char * afc_string_fget ( char * deststring, FILE * file )
+
+		 DESCRIPTION: Use this function to read a line of text from a file.
+			This function is advanced considering the usual C /fgets/
+			command: it does bound checking so you don't have to do any
+			control before reading from the file.
+
+		 INPUT: - deststring		- Destination string. This string MUST be an AFC string
+					created using afc_string_new ()
+
+			- file		- A valid file handler where to get the string from.
+
+		RESULT: - The resulting string or NULL if end of file has been encountered.
+
+			NOTE: - this function can handle NULL pointers
+				- to read big files, use a LineReader: it does not copy the lines and it has no limit on their length
+
+	SEE ALSO: - afc_line_reader_next()
+
+@endnode
+*/
+char *afc_string_fget(char *dest, FILE *fh)
+{
+	if ((dest == NULL) || (fh == NULL))
+		return (NULL);
+
+	afc_string_clear(dest);
+
+	if (fgets(dest, afc_string_max(dest), fh) == NULL)
+		return (NULL);
+
+	afc_string_reset_len(dest);
+
+	return (dest);
+}
+// }}}
+// {{{ afc_string_add ( dest, source, len )
+/*
+@node afc_string_add
+
+			NAME: afc_string_add (deststring, sourcestring, len ) - Add a string to the current one
+
+	SYNOPSIS: char * afc_string_add ( char * deststring, const char * sourcestring, unsigned long len)
+
+		 DESCRIPTION: Use this function to append a string at the end of another.
+			This function is advanced considering the usual C strcat
+			command: it does bound checking so you don't have to do any
+			control before appending.
+
+		 INPUT: - deststring		- Destination string. This string MUST be an AFC string
+					created using afc_string_new ()
+
+			- sourcestring	- Source string. This string can be anything, a static
+					string, an AFC string , a memory area...
+
+			- len		 - Here you can specify how many chars to copy. Pass the value /ALL/ to copy the whole string.
+
+		RESULT: - The resulting string.
+
+			NOTE: - this function can handle NULL pointers
+
+	SEE ALSO: - afc_string_copy()
+
+@endnode
+*/
+char *afc_string_add(char *dest, const char *source, unsigned long len)
+{
+	unsigned long m, srclen, clen;
+
+	if (!(dest && source))
+		return (NULL);
+
+	srclen = strlen(source);
+
+	clen = afc_string_len(dest);
+	m = afc_string_max(dest) - clen;
+
+	if ((long)len == ALL)
+		len = srclen;
+
+	if (len > m)
+		len = m;
+	if (len > srclen)
+		len = srclen;
+
+	*((unsigned long *)(dest - sizeof(unsigned long))) = clen + len;
+
+	memmove(dest + clen, source, len);
+	dest[clen + len] = '\0';
+
+	return (dest);
+}
+// }}}
+// {{{ afc_string_temp ( path )
+/*
+@node afc_string_temp
+
+		NAME: afc_string_temp ( path ) - Creates a temporary file name
+
+	SYNOPSIS: char * afc_string_temp ( const char * path )
+
+	 DESCRIPTION: This function creates a new string containing an unique name, not avaible
+		  in the given path when checking. This is useful when you want to create,
+		  for example, some temporary files and want to be sure an unique name is used.
+		  In the /path/ you should also specify a /prefix/ for the temporary file being
+		  created. If for example, you want to create a temp file in "/tmp" with the prefix
+		  "temp", you should write "/tmp/temp" and the temp file name you'll get back will
+		  be something like "/tmp/tempVt6Akr".
+
+
+	   INPUT: - path		- The path in the filesystem to check against unique name.
+
+	  RESULT: - A *new* AFC string, that you'll need to free with afc_string_delete() when you're done.
+		  - A NULL value means an error occurred.
+
+		NOTE: - To avoid race conditions, this function actually creates the file in the specified path.
+			This should not be a problem, since you are going to create that file anyway and you have the
+			permissions to do that.
+		  - this function can handle NULL pointers
+			  - remember to free the string using afc_string_delete() when you have finished with it.
+
+	SEE ALSO: - afc_string_delete()
+		  - stdio.h/tempnam call.
+		  - stdlib.h/mkstemp call.
+
+@endnode
+*/
+char *afc_string_temp(const char *path)
+{
+	char *tmp;
+	int fd;
+#ifdef MINGW
+	char *name;
+#endif
+	char *p;
+
+	if (path == NULL)
+		path = "/tmp/afc";
+
+#ifdef MINGW
+	p = afc_string_dirname(path);
+
+	/* tempnam adds "file" prefix to the file name */
+	tmp = afc_string_new(afc_string_len(p) + 11);
+#else
+	p = (char *)path;
+	tmp = afc_string_new(strlen(p) + 7);
+#endif
+
+	if (tmp == NULL)
+		return (NULL);
+
+	afc_string_make(tmp, "%sXXXXXX", path);
+
+#ifdef MINGW
+	if ((name = tempnam(p, NULL)) == NULL)
+	{
+		afc_string_delete(p);
+		afc_string_delete(tmp);
+		return (NULL);
+	}
+
+	afc_string_copy(tmp, name, ALL);
+
+	afc_string_delete(p);
+	free(name);
+	name = NULL;
+
+	if ((fd = open(tmp, O_CREAT | O_EXCL)) == -1)
+#else
+	if ((fd = mkstemp(tmp)) == -1)
+#endif
+	{
+		fprintf(stderr, "afc_string_temp() error: %s\n", strerror(errno));
+		afc_string_delete(tmp);
+		return (NULL);
+	}
+
+	close(fd); // Close the file descriptor
+
+	return (tmp);
+}
+// }}}
+// {{{ afc_string_resize_copy ( dest, str )
+/*
+@node afc_string_resize_copy
+
+		NAME: afc_string_resize_copy ( dest, str ) - Copies a string resizing the dest buffer
+
+	SYNOPSIS: char * afc_string_resize_copy ( char * * dest, char * str )
+
+	 DESCRIPTION: This function copies the full content of string /str/ inside the /dest/ AFC String.
+		  If the memory alloc'd for the /dest/ string is not enough, a new string is allocated in place
+		  of the original /dest/ AFC String and the /str/ is copied.
+
+	   INPUT: - dest		- The destination string where to copy the /str/ data.
+		  - str			- The string to be copied into /dest/.
+
+	  RESULT: - The /str/ will be copied inside /dest/.
+
+		NOTE: - /dest/ is a pointer of pointer. You have to call this function by referencing the /dest/ string
+		   with the "&" operator. Eg. afc_string_resize_copy ( &dest, "hello world" );
+
+	SEE ALSO: - afc_string_copy()
+
+@endnode
+*/
+char *afc_string_resize_copy(char **dest, const char *str)
+{
+	char *str_new;
+	unsigned int max;
+	unsigned int new_max;
+
+	max = afc_string_max(*dest);
+
+	if ((strlen(str) + afc_string_len(*dest)) > (max - 3))
+	{
+		new_max = max * 2;
+		if (new_max > AFC_MAX_BUFFER_SIZE)
+			new_max = AFC_MAX_BUFFER_SIZE;
+		if (new_max <= max) return NULL;
+		str_new = afc_string_new(new_max);
+		afc_string_copy(str_new, *dest, ALL);
+
+		afc_string_delete(*dest);
+		*dest = str_new;
+	}
+	else
+		afc_string_copy(*dest, str, ALL);
+
+	return (*dest);
+}
+// }}}
+// {{{ afc_string_resize_add ( dest, str )
+char *afc_string_resize_add(char **dest, const char *str)
+{
+	char *str_new;
+	unsigned int max;
+	unsigned int needed;
+	unsigned int new_max;
+
+	max = afc_string_max(*dest);
+
+	if ((strlen(str) + afc_string_len(*dest)) > (max - 3))
+	{
+		needed = (strlen(str) + afc_string_len(*dest)) * 2;
+		new_max = (needed > AFC_MAX_BUFFER_SIZE) ? AFC_MAX_BUFFER_SIZE : needed;
+		if (new_max <= max) return (NULL);
+		if ((str_new = afc_string_new(new_max)) == NULL)
+			return (NULL);
+
+		afc_string_copy(str_new, *dest, ALL);
+
+		afc_string_delete(*dest);
+		*dest = str_new;
+	}
+
+	afc_string_add(*dest, str, ALL);
+
+	return (*dest);
+}
+// }}}
+
+// {{{ afc_string_dirname ( path )
+char *afc_string_dirname(const char *path)
+{
+	char *dest = NULL;
+	char *x;
+
+	// If path is not defined, do nothing.
+	if (path == NULL)
+		return (NULL);
+
+	// Search for the last directory separator in the file_name
+	x = _afc_string_find_last_sep(path);
+
+	// if we don't find it, simply copy all the path
+	if (x == NULL)
+		dest = afc_string_dup(path);
+	else
+	{
+		// ... else we have to create a new string and
+		// copy the chars we are interested in
+		size_t len = x - path;
+		if (len == 0)
+		{
+			// Path starts with separator (e.g., "/file.txt")
+			dest = afc_string_new(1);
+		}
+		else
+		{
+			dest = afc_string_new(len);
+			afc_string_copy(dest, path, len);
+		}
+	}
+
+	return (dest);
+}
+// }}}
+// {{{ afc_string_basename ( path )
+char *afc_string_basename(const char *path)
+{
+	char *dest = NULL;
+	char *x;
+
+	// If path is not defined, do nothing.
+	if (path == NULL)
+		return (NULL);
+
+	// Search for the last directory separator in the file_name
+	x = _afc_string_find_last_sep(path);
+
+	// if we don't find it, simply copy all the path
+	if (x == NULL)
+		dest = afc_string_dup(path);
+	else
+	{
+		// ... else we have to create a new string and
+		// copy the chars we are interested in
+		dest = afc_string_dup(x + 1);
+	}
+
+	return (dest);
+}
+// }}}
+
+// {{{ utf8 kernels
+/*
+   UTF-8 validation and transcoding. Blocks of 16 ASCII chars are detected with a single movemask and copied
+   (or widened) at once; only the non ASCII parts are decoded one char at a time. Input is always validated
+   before being decoded, so the decoders below do not check it again.
+
+   The SSSE3 validator is the "lookup" algorithm by Keiser and Lemire: three 16 entries tables, indexed by the
+   nibbles of each byte and of the byte before it, flag every invalid two bytes combination, and the expected
+   continuation bytes after 3 and 4 bytes leads are checked with saturated subtractions.
+*/
+typedef int (*afc_string_internal_utf8_valid_fn)(const unsigned char *s, size_t len);
+
+static afc_string_internal_utf8_valid_fn afc_string_internal_utf8_valid_kernel = NULL;
+
+/* Returns the position of the first byte of the first invalid sequence, or /len/ if /s/ is valid UTF-8 */
+static size_t afc_string_internal_utf8_check(const unsigned char *s, size_t len)
+{
+	size_t i = 0, need;
+	unsigned char c, lo, hi;
+
+	while (i < len)
+	{
+		c = s[i];
+
+		if (c < 0x80)
+		{
+			i++;
+			continue;
+		}
+
+		// The allowed range of the second byte depends on the first one (no overlongs, surrogates or > U+10FFFF)
+		lo = 0x80;
+		hi = 0xBF;
+
+		if (c < 0xC2)
+			return (i);
+		else if (c < 0xE0)
+			need = 1;
+		else if (c < 0xF0)
+		{
+			need = 2;
+			if (c == 0xE0)
+				lo = 0xA0;
+			else if (c == 0xED)
+				hi = 0x9F;
+		}
+		else if (c < 0xF5)
+		{
+			need = 3;
+			if (c == 0xF0)
+				lo = 0x90;
+			else if (c == 0xF4)
+				hi = 0x8F;
+		}
+		else
+			return (i);
+
+		if ((i + need >= len) || (s[i + 1] < lo) || (s[i + 1] > hi))
+			return (i);
+		if ((need > 1) && ((s[i + 2] & 0xC0) != 0x80))
+			return (i);
+		if ((need > 2) && ((s[i + 3] & 0xC0) != 0x80))
+			return (i);
+
+		i += need + 1;
+	}
+
+	return (len);
+}
+
+static int afc_string_internal_utf8_valid_scalar(const unsigned char *s, size_t len)
+{
+	return (afc_string_internal_utf8_check(s, len) == len);
+}
+
+#ifdef AFC_STRING_INTERNAL_SIMD
+#define AFC_UTF8_TOO_SHORT (1 << 0)		 // 11______ 0_______ or 11______ 11______
+#define AFC_UTF8_TOO_LONG (1 << 1)		 // 0_______ 10______
+#define AFC_UTF8_OVERLONG_3 (1 << 2)	 // 11100000 100_____
+#define AFC_UTF8_TOO_LARGE (1 << 3)		 // 11110100 1001____ or 11110100 101_____ or 11110101+ 10______
+#define AFC_UTF8_SURROGATE (1 << 4)		 // 11101101 101_____
+#define AFC_UTF8_OVERLONG_2 (1 << 5)	 // 1100000_ 10______
+#define AFC_UTF8_TOO_LARGE_1000 (1 << 6) // 11110101+ 1000____
+#define AFC_UTF8_OVERLONG_4 (1 << 6)	 // 11110000 1000____
+#define AFC_UTF8_TWO_CONTS (1 << 7)		 // 10______ 10______
+#define AFC_UTF8_CARRY (AFC_UTF8_TOO_SHORT | AFC_UTF8_TOO_LONG | AFC_UTF8_TWO_CONTS)
+#define AFC_UTF8_LARGE (AFC_UTF8_CARRY | AFC_UTF8_TOO_LARGE | AFC_UTF8_TOO_LARGE_1000)
+#define AFC_UTF8_CONT_8 (AFC_UTF8_TOO_LONG | AFC_UTF8_OVERLONG_2 | AFC_UTF8_TWO_CONTS)
+
+#define afc_string_internal_b(x) ((char)(x))
+
+__attribute__((target("ssse3"))) static int afc_string_internal_utf8_valid_ssse3(const unsigned char *s, size_t len)
+{
+	const __m128i byte_1_high = _mm_setr_epi8(
+		AFC_UTF8_TOO_LONG, AFC_UTF8_TOO_LONG, AFC_UTF8_TOO_LONG, AFC_UTF8_TOO_LONG,
+		AFC_UTF8_TOO_LONG, AFC_UTF8_TOO_LONG, AFC_UTF8_TOO_LONG, AFC_UTF8_TOO_LONG,
+		afc_string_internal_b(AFC_UTF8_TWO_CONTS), afc_string_internal_b(AFC_UTF8_TWO_CONTS),
+		afc_string_internal_b(AFC_UTF8_TWO_CONTS), afc_string_internal_b(AFC_UTF8_TWO_CONTS),
+		AFC_UTF8_TOO_SHORT | AFC_UTF8_OVERLONG_2,
+		AFC_UTF8_TOO_SHORT,
+		AFC_UTF8_TOO_SHORT | AFC_UTF8_OVERLONG_3 | AFC_UTF8_SURROGATE,
+		AFC_UTF8_TOO_SHORT | AFC_UTF8_TOO_LARGE | AFC_UTF8_TOO_LARGE_1000 | AFC_UTF8_OVERLONG_4);
+	const __m128i byte_1_low = _mm_setr_epi8(
+		afc_string_internal_b(AFC_UTF8_CARRY | AFC_UTF8_OVERLONG_3 | AFC_UTF8_OVERLONG_2 | AFC_UTF8_OVERLONG_4),
+		afc_string_internal_b(AFC_UTF8_CARRY | AFC_UTF8_OVERLONG_2),
+		afc_string_internal_b(AFC_UTF8_CARRY), afc_string_internal_b(AFC_UTF8_CARRY),
+		afc_string_internal_b(AFC_UTF8_CARRY | AFC_UTF8_TOO_LARGE),
+		afc_string_internal_b(AFC_UTF8_LARGE), afc_string_internal_b(AFC_UTF8_LARGE), afc_string_internal_b(AFC_UTF8_LARGE),
+		afc_string_internal_b(AFC_UTF8_LARGE), afc_string_internal_b(AFC_UTF8_LARGE), afc_string_internal_b(AFC_UTF8_LARGE),
+		afc_string_internal_b(AFC_UTF8_LARGE), afc_string_internal_b(AFC_UTF8_LARGE),
+		afc_string_internal_b(AFC_UTF8_LARGE | AFC_UTF8_SURROGATE),
+		afc_string_internal_b(AFC_UTF8_LARGE), afc_string_internal_b(AFC_UTF8_LARGE));
+	const __m128i byte_2_high = _mm_setr_epi8(
+		AFC_UTF8_TOO_SHORT, AFC_UTF8_TOO_SHORT, AFC_UTF8_TOO_SHORT, AFC_UTF8_TOO_SHORT,
+		AFC_UTF8_TOO_SHORT, AFC_UTF8_TOO_SHORT, AFC_UTF8_TOO_SHORT, AFC_UTF8_TOO_SHORT,
+		afc_string_internal_b(AFC_UTF8_CONT_8 | AFC_UTF8_OVERLONG_3 | AFC_UTF8_TOO_LARGE_1000 | AFC_UTF8_OVERLONG_4),
+		afc_string_internal_b(AFC_UTF8_CONT_8 | AFC_UTF8_OVERLONG_3 | AFC_UTF8_TOO_LARGE),
+		afc_string_internal_b(AFC_UTF8_CONT_8 | AFC_UTF8_SURROGATE | AFC_UTF8_TOO_LARGE),
+		afc_string_internal_b(AFC_UTF8_CONT_8 | AFC_UTF8_SURROGATE | AFC_UTF8_TOO_LARGE),
+		AFC_UTF8_TOO_SHORT, AFC_UTF8_TOO_SHORT, AFC_UTF8_TOO_SHORT, AFC_UTF8_TOO_SHORT);
+	// A lead byte in the last three positions needs bytes from the next block
+	const __m128i max_complete = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+											   afc_string_internal_b(0xEF), afc_string_internal_b(0xDF), afc_string_internal_b(0xBF));
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i input, prev = zero, prev1, prev2, prev3, special, must_23, incomplete = zero, error = zero;
+	unsigned char tail[16];
+	size_t i;
+
+	for (i = 0; i < len; i += 16)
+	{
+		if (len - i >= 16)
+			input = _mm_loadu_si128((const __m128i *)(s + i));
+		else
+		{
+			// The zeros after the end make any truncated sequence TOO_SHORT
+			memset(tail, 0, sizeof(tail));
+			memcpy(tail, s + i, len - i);
+			input = _mm_loadu_si128((const __m128i *)tail);
+		}
+
+		if (_mm_movemask_epi8(input) == 0)
+		{
+			error = _mm_or_si128(error, incomplete);
+			incomplete = zero;
+		}
+		else
+		{
+			prev1 = _mm_alignr_epi8(input, prev, 15);
+			special = _mm_and_si128(_mm_and_si128(
+										_mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+										_mm_shuffle_epi8(byte_1_low, _mm_and_si128(prev1, nibble))),
+									_mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+
+			prev2 = _mm_alignr_epi8(input, prev, 14);
+			prev3 = _mm_alignr_epi8(input, prev, 13);
+			must_23 = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80)), _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80)));
+
+			error = _mm_or_si128(error, _mm_xor_si128(_mm_and_si128(must_23, _mm_set1_epi8(afc_string_internal_b(0x80))), special));
+			incomplete = _mm_subs_epu8(input, max_complete);
+		}
+
+		prev = input;
+	}
+
+	error = _mm_or_si128(error, incomplete);
+
+	return (_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) == 0xFFFF);
+}
+#endif
+
+static int afc_string_internal_utf8_valid(const unsigned char *s, size_t len)
+{
+	afc_string_internal_utf8_valid_fn kernel;
+
+	// Every thread selects the same kernel, so a race here is harmless
+	if ((kernel = __atomic_load_n(&afc_string_internal_utf8_valid_kernel, __ATOMIC_RELAXED)) == NULL)
+	{
+		kernel = afc_string_internal_utf8_valid_scalar;
+#ifdef AFC_STRING_INTERNAL_SIMD
+		__builtin_cpu_init();
+
+		if (__builtin_cpu_supports("ssse3"))
+			kernel = afc_string_internal_utf8_valid_ssse3;
+#endif
+		__atomic_store_n(&afc_string_internal_utf8_valid_kernel, kernel, __ATOMIC_RELAXED);
+	}
+
+	return (kernel(s, len));
+}
+
+/* Returns TRUE if the 16 bytes at /s/ are all ASCII */
+#ifdef AFC_STRING_INTERNAL_SIMD
+#define afc_string_internal_ascii16(s) (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(s))) == 0)
+#else
+#define afc_string_internal_ascii16(s) (0)
+#endif
+
+/* Decodes valid UTF-8 into Latin-1. Chars above U+00FF become /replace/ */
+static size_t afc_string_internal_utf8_to_latin1(unsigned char *dest, const unsigned char *s, size_t len, unsigned char replace)
+{
+	size_t i = 0, o = 0;
+	unsigned char c;
+
+	while (i < len)
+	{
+		if ((i + 16 <= len) && afc_string_internal_ascii16(s + i))
+		{
+			memcpy(dest + o, s + i, 16);
+			i += 16;
+			o += 16;
+			continue;
+		}
+
+		c = s[i];
+
+		if (c < 0x80)
+		{
+			dest[o++] = c;
+			i++;
+		}
+		else if (c < 0xE0)
+		{
+			dest[o++] = (c < 0xC4) ? (unsigned char)(((c & 0x1F) << 6) | (s[i + 1] & 0x3F)) : replace;
+			i += 2;
+		}
+		else
+		{
+			dest[o++] = replace;
+			i += (c < 0xF0) ? 3 : 4;
+		}
+	}
+
+	return (o);
+}
+// }}}
+// {{{ afc_utf8_validate ( str, len, error_pos )
+/*
+@node afc_utf8_validate
+
+			NAME: afc_utf8_validate ( str, len, error_pos ) - Checks if a buffer contains valid UTF-8
+
+	SYNOPSIS: int afc_utf8_validate ( const char * str, unsigned long len, unsigned long * error_pos )
+	   SINCE: 1.07
+
+		 DESCRIPTION: This function checks that the first /len/ bytes of /str/ are valid UTF-8 text, as defined
+				by RFC 3629: overlong sequences, UTF-16 surrogates, code points above U+10FFFF and truncated
+				sequences are all errors. On CPUs with SSSE3 the check is done 16 bytes at a time.
+
+		 INPUT: - str				- The buffer to check. It does not need to be NUL terminated.
+			- len				- Number of bytes to check.
+			- error_pos			- Pointer to a variable that will get the position of the first invalid
+							  byte. It can be NULL.
+
+		RESULT: - TRUE if the buffer is valid UTF-8, FALSE otherwise.
+
+			NOTE: - Pure ASCII text is always valid UTF-8.
+
+	SEE ALSO: - afc_utf8_count()
+		  - afc_utf8_to_latin1()
+		  - afc_utf8_to_utf16()
+
+@endnode
+*/
+int afc_utf8_validate(const char *str, unsigned long len, unsigned long *error_pos)
+{
+	size_t pos;
+
+	if (str == NULL)
+		return (FALSE);
+
+	if (afc_string_internal_utf8_valid((const unsigned char *)str, len))
+	{
+		if (error_pos)
+			*error_pos = len;
+		return (TRUE);
+	}
+
+	// The fast check does not tell where the error is: find it only when asked
+	if (error_pos)
+	{
+		pos = afc_string_internal_utf8_check((const unsigned char *)str, len);
+		*error_pos = pos;
+	}
+
+	return (FALSE);
+}
+// }}}
+// {{{ afc_utf8_count ( str, len )
+/*
+@node afc_utf8_count
+
+			NAME: afc_utf8_count ( str, len ) - Counts the chars in a UTF-8 buffer
+
+	SYNOPSIS: unsigned long afc_utf8_count ( const char * str, unsigned long len )
+	   SINCE: 1.07
+
+		 DESCRIPTION: This function returns the number of code points in the first /len/ bytes of /str/,
+				that is the number of bytes that are not UTF-8 continuation bytes.
+
+		 INPUT: - str				- The UTF-8 buffer.
+			- len				- Number of bytes in /str/.
+
+		RESULT: - the number of code points.
+
+			NOTE: - The buffer is not validated: use afc_utf8_validate() first if it comes from an untrusted source.
+
+	SEE ALSO: - afc_utf8_validate()
+
+@endnode
+*/
+unsigned long afc_utf8_count(const char *str, unsigned long len)
+{
+	unsigned long conts = 0, i = 0;
+
+	if (str == NULL)
+		return (0);
+
+#ifdef AFC_STRING_INTERNAL_SIMD
+	// Continuation bytes (0x80 - 0xBF) are the signed values below -64
+	const __m128i limit = _mm_set1_epi8(-64);
+
+	for (; i + 16 <= len; i += 16)
+		conts += __builtin_popcount(_mm_movemask_epi8(_mm_cmplt_epi8(_mm_loadu_si128((const __m128i *)(str + i)), limit)));
+#endif
+
+	for (; i < len; i++)
+		if ((str[i] & 0xC0) == 0x80)
+			conts++;
+
+	return (len - conts);
+}
+// }}}
+// {{{ afc_utf8_to_latin1 ( dest, str, len )
+/*
+@node afc_utf8_to_latin1
+
+			NAME: afc_utf8_to_latin1 ( dest, str, len ) - Converts UTF-8 text to Latin-1
+
+	SYNOPSIS: long afc_utf8_to_latin1 ( char * dest, const char * str, unsigned long len )
+	   SINCE: 1.07
+
+		 DESCRIPTION: This function validates the first /len/ bytes of /str/ and converts them from UTF-8
+				to Latin-1 (ISO-8859-1) into /dest/. Code points that do not exist in Latin-1 are
+				replaced by '?'.
+
+		 INPUT: - dest				- The destination buffer. It must be at least /len/ bytes long.
+			- str				- The UTF-8 buffer.
+			- len				- Number of bytes in /str/.
+
+		RESULT: - the number of bytes written in /dest/
+			- -1 if /str/ is not valid UTF-8 (nothing is written)
+
+			NOTE: - /dest/ is not NUL terminated.
+
+	SEE ALSO: - afc_latin1_to_utf8()
+		  - afc_string_utf8_to_latin1()
+
+@endnode
+*/
+long afc_utf8_to_latin1(char *dest, const char *str, unsigned long len)
+{
+	if ((dest == NULL) || (str == NULL))
+		return (-1);
+
+	if (!afc_string_internal_utf8_valid((const unsigned char *)str, len))
+		return (-1);
+
+	return ((long)afc_string_internal_utf8_to_latin1((unsigned char *)dest, (const unsigned char *)str, len, '?'));
+}
+// }}}
+// {{{ afc_latin1_to_utf8 ( dest, str, len )
+/*
+@node afc_latin1_to_utf8
+
+			NAME: afc_latin1_to_utf8 ( dest, str, len ) - Converts Latin-1 text to UTF-8
+
+	SYNOPSIS: long afc_latin1_to_utf8 ( char * dest, const char * str, unsigned long len )
+	   SINCE: 1.07
+
+		 DESCRIPTION: This function converts the first /len/ bytes of /str/ from Latin-1 (ISO-8859-1) to UTF-8
+				into /dest/. Any byte sequence is valid Latin-1, so this function never fails.
+
+		 INPUT: - dest				- The destination buffer. It must be at least /len/ * 2 bytes long.
+			- str				- The Latin-1 buffer.
+			- len				- Number of bytes in /str/.
+
+		RESULT: - the number of bytes written in /dest/, or -1 if NULL pointers are passed.
+
+			NOTE: - /dest/ is not NUL terminated.
+
+	SEE ALSO: - afc_utf8_to_latin1()
+		  - afc_string_latin1_to_utf8()
+
+@endnode
+*/
+long afc_latin1_to_utf8(char *dest, const char *str, unsigned long len)
+{
+	const unsigned char *s = (const unsigned char *)str;
+	unsigned char *d = (unsigned char *)dest;
+	unsigned long i = 0, o = 0;
+
+	if ((dest == NULL) || (str == NULL))
+		return (-1);
+
+	while (i < len)
+	{
+		if ((i + 16 <= len) && afc_string_internal_ascii16(s + i))
+		{
+			memcpy(d + o, s + i, 16);
+			i += 16;
+			o += 16;
+			continue;
+		}
+
+		if (s[i] < 0x80)
+			d[o++] = s[i];
+		else
+		{
+			d[o++] = 0xC0 | (s[i] >> 6);
+			d[o++] = 0x80 | (s[i] & 0x3F);
+		}
+		i++;
+	}
+
+	return ((long)o);
+}
+// }}}
+// {{{ afc_utf8_to_utf16 ( dest, str, len )
+/*
+@node afc_utf8_to_utf16
+
+			NAME: afc_utf8_to_utf16 ( dest, str, len ) - Converts UTF-8 text to UTF-16
+
+	SYNOPSIS: long afc_utf8_to_utf16 ( unsigned short * dest, const char * str, unsigned long len )
+	   SINCE: 1.07
+
+		 DESCRIPTION: This function validates the first /len/ bytes of /str/ and converts them from UTF-8
+				to UTF-16 (in the CPU byte order) into /dest/. Code points above U+FFFF are stored as
+				surrogate pairs.
+
+		 INPUT: - dest				- The destination buffer. It must have room for at least /len/ units.
+			- str				- The UTF-8 buffer.
+			- len				- Number of bytes in /str/.
+
+		RESULT: - the number of 16 bit units written in /dest/
+			- -1 if /str/ is not valid UTF-8 (nothing is written)
+
+	SEE ALSO: - afc_utf16_to_utf8()
+
+@endnode
+*/
+long afc_utf8_to_utf16(unsigned short *dest, const char *str, unsigned long len)
+{
+	const unsigned char *s = (const unsigned char *)str;
+	unsigned long i = 0, o = 0;
+	unsigned long cp;
+	unsigned char c;
+
+	if ((dest == NULL) || (str == NULL))
+		return (-1);
+
+	if (!afc_string_internal_utf8_valid(s, len))
+		return (-1);
+
+	while (i < len)
+	{
+#ifdef AFC_STRING_INTERNAL_SIMD
+		if (i + 16 <= len)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+
+			if (_mm_movemask_epi8(v) == 0)
+			{
+				_mm_storeu_si128((__m128i *)(dest + o), _mm_unpacklo_epi8(v, _mm_setzero_si128()));
+				_mm_storeu_si128((__m128i *)(dest + o + 8), _mm_unpackhi_epi8(v, _mm_setzero_si128()));
+				i += 16;
+				o += 16;
+				continue;
+			}
+		}
+#endif
+		c = s[i];
+
+		if (c < 0x80)
+		{
+			dest[o++] = c;
+			i++;
+		}
+		else if (c < 0xE0)
+		{
+			dest[o++] = (unsigned short)(((c & 0x1F) << 6) | (s[i + 1] & 0x3F));
+			i += 2;
+		}
+		else if (c < 0xF0)
+		{
+			dest[o++] = (unsigned short)(((c & 0x0F) << 12) | ((s[i + 1] & 0x3F) << 6) | (s[i + 2] & 0x3F));
+			i += 3;
+		}
+		else
+		{
+			cp = (((unsigned long)(c & 0x07) << 18) | ((s[i + 1] & 0x3F) << 12) | ((s[i + 2] & 0x3F) << 6) | (s[i + 3] & 0x3F)) - 0x10000;
+			dest[o++] = (unsigned short)(0xD800 | (cp >> 10));
+			dest[o++] = (unsigned short)(0xDC00 | (cp & 0x3FF));
+			i += 4;
+		}
+	}
+
+	return ((long)o);
+}
+// }}}
+// {{{ afc_utf16_to_utf8 ( dest, str, len )
+/*
+@node afc_utf16_to_utf8
+
+			NAME: afc_utf16_to_utf8 ( dest, str, len ) - Converts UTF-16 text to UTF-8
+
+	SYNOPSIS: long afc_utf16_to_utf8 ( char * dest, const unsigned short * str, unsigned long len )
+	   SINCE: 1.07
+
+		 DESCRIPTION: This function converts the first /len/ units of /str/ from UTF-16 (in the CPU byte order)
+				to UTF-8 into /dest/.
+
+		 INPUT: - dest				- The destination buffer. It must be at least /len/ * 3 bytes long.
+			- str				- The UTF-16 buffer.
+			- len				- Number of 16 bit units in /str/.
+
+		RESULT: - the number of bytes written in /dest/
+			- -1 if /str/ contains an unpaired surrogate. /dest/ may have been partially written.
+
+			NOTE: - /dest/ is not NUL terminated.
+
+	SEE ALSO: - afc_utf8_to_utf16()
+
+@endnode
+*/
+long afc_utf16_to_utf8(char *dest, const unsigned short *str, unsigned long len)
+{
+	unsigned char *d = (unsigned char *)dest;
+	unsigned long i = 0, o = 0;
+	unsigned long cp;
+
+	if ((dest == NULL) || (str == NULL))
+		return (-1);
+
+	while (i < len)
+	{
+#ifdef AFC_STRING_INTERNAL_SIMD
+		if (i + 8 <= len)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i *)(str + i));
+
+			// Eight ASCII units are narrowed to bytes at once
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, _mm_set1_epi16((short)0xFF80)), _mm_setzero_si128())) == 0xFFFF)
+			{
+				_mm_storel_epi64((__m128i *)(d + o), _mm_packus_epi16(v, v));
+				i += 8;
+				o += 8;
+				continue;
+			}
+		}
+#endif
+		cp = str[i++];
+
+		if ((cp >= 0xD800) && (cp <= 0xDFFF))
+		{
+			if ((cp > 0xDBFF) || (i >= len) || (str[i] < 0xDC00) || (str[i] > 0xDFFF))
+				return (-1);
+
+			cp = 0x10000 + ((cp - 0xD800) << 10) + (str[i++] - 0xDC00);
+		}
+
+		if (cp < 0x80)
+			d[o++] = (unsigned char)cp;
+		else if (cp < 0x800)
+		{
+			d[o++] = 0xC0 | (cp >> 6);
+			d[o++] = 0x80 | (cp & 0x3F);
+		}
+		else if (cp < 0x10000)
+		{
+			d[o++] = 0xE0 | (cp >> 12);
+			d[o++] = 0x80 | ((cp >> 6) & 0x3F);
+			d[o++] = 0x80 | (cp & 0x3F);
+		}
+		else
+		{
+			d[o++] = 0xF0 | (cp >> 18);
+			d[o++] = 0x80 | ((cp >> 12) & 0x3F);
+			d[o++] = 0x80 | ((cp >> 6) & 0x3F);
+			d[o++] = 0x80 | (cp & 0x3F);
+		}
+	}
+
+	return ((long)o);
+}
+// }}}
+// {{{ afc_string_utf8_to_latin1 ( utf8 )
+/*
+@node afc_string_utf8_to_latin1
+
+			NAME: afc_string_utf8_to_latin1 ( utf8 ) - Creates a Latin-1 copy of a UTF-8 string
+
+	SYNOPSIS: char * afc_string_utf8_to_latin1 ( const char * utf8 )
+
+		 DESCRIPTION: This function returns a new AFC string with the contents of /utf8/ converted to Latin-1.
+				Chars that do not exist in Latin-1 are replaced by '?'. If /utf8/ is not valid UTF-8,
+				it is supposed to be Latin-1 already, and it is just copied.
+
+		 INPUT: - utf8				- The string to convert.
+
+		RESULT: - a new AFC String, that must be freed with afc_string_delete(), or NULL in case of errors.
+
+	SEE ALSO: - afc_utf8_to_latin1()
+		  - afc_string_latin1_to_utf8()
+
+@endnode
+*/
+char *afc_string_utf8_to_latin1(const char *utf8)
+{
+	unsigned long len;
+	char *res;
+
+	if ((utf8 == NULL) || ((len = strlen(utf8)) == 0))
+		return afc_string_new(1);
+
+	if (!afc_string_internal_utf8_valid((const unsigned char *)utf8, len))
+		return afc_string_dup(utf8);
+
+	if ((res = afc_string_new(len)) == NULL)
+		return NULL;
+
+	len = afc_string_internal_utf8_to_latin1((unsigned char *)res, (const unsigned char *)utf8, len, '?');
+	res[len] = '\0';
+	*((unsigned long *)(res - sizeof(unsigned long))) = len;
+
+	return res;
+}
+// }}}
+// {{{ afc_string_latin1_to_utf8 ( latin1 )
+/*
+@node afc_string_latin1_to_utf8
+
+			NAME: afc_string_latin1_to_utf8 ( latin1 ) - Creates a UTF-8 copy of a Latin-1 string
+
+	SYNOPSIS: char * afc_string_latin1_to_utf8 ( const char * latin1 )
+	   SINCE: 1.07
+
+		 DESCRIPTION: This function returns a new AFC string with the contents of /latin1/ converted to UTF-8.
+
+		 INPUT: - latin1			- The string to convert.
+
+		RESULT: - a new AFC String, that must be freed with afc_string_delete(), or NULL in case of errors.
+
+	SEE ALSO: - afc_latin1_to_utf8()
+		  - afc_string_utf8_to_latin1()
+
+@endnode
+*/
+char *afc_string_latin1_to_utf8(const char *latin1)
+{
+	unsigned long len;
+	char *res;
+
+	if ((latin1 == NULL) || ((len = strlen(latin1)) == 0))
+		return afc_string_new(1);
+
+	if ((res = afc_string_new(len * 2)) == NULL)
+		return NULL;
+
+	len = afc_latin1_to_utf8(res, latin1, len);
+	res[len] = '\0';
+	*((unsigned long *)(res - sizeof(unsigned long))) = len;
+
+	return res;
+}
+// }}}
+
+#ifndef MINGW
+// {{{ afc_string_pattern_match ( str, pattern, no_case )
+/*
+@node afc_string_pattern_match
+
+			NAME: afc_string_pattern_match ( string, pattern, no_case ) - Use pattern matching against this string
+
+	SYNOPSIS: int afc_string_pattern_match ( const char * string, const char * pattern, short no_case )
+
+		 DESCRIPTION: This function tests if the given /string/ correctly matches the provided /pattern/ using
+					  the standard system pattern matching algo. It can be made case insensitive by passing TRUE
+					  as /no_case/ value.
+
+		 INPUT: - string				- AFC string to convert.
+			- pattern 			- The pattern string. It doesn't necessarily need to be an AFC string.
+			- no_case  			- Flag T/F. If TRUE, the pattern matching is done case insensitive.
+
+		RESULT: - 0 - The /string/ matches /pattern/.
+			- non zero - The /string/ does /not/ match /pattern/ or NULL pointers passed.
+
+			NOTE: - This function can handle NULL pointers.
+
+	SEE ALSO:
+
+@endnode
+*/
+int afc_string_pattern_match(const char *str, const char *pattern, short nocase)
+{
+	int res;
+	char *s, *patt;
+
+	if ((str == NULL) || (pattern == NULL))
+		return (-1);
+
+#ifdef FNM_CASEFOLD
+	// No need to copy and uppercase the strings
+	if (nocase)
+		return (fnmatch(pattern, str, FNM_CASEFOLD));
+#endif
+
+	if (nocase)
+	{
+		if ((s = afc_string_dup(str)) == NULL)
+			return (-1);
+		afc_string_upper(s);
+
+		if ((patt = afc_string_dup(pattern)) == NULL)
+		{
+			afc_string_delete(s);
+			return (-1);
+		}
+
+		afc_string_upper(patt);
+
+		res = fnmatch(patt, s, 0);
+
+		afc_string_delete(patt);
+		afc_string_delete(s);
+	}
+	else
+		res = fnmatch(pattern, str, 0);
+
+	return (res);
+}
+// }}}
+#endif
+
+// {{{ afc_string_char_at ( str, index )
+/*
+@node afc_string_char_at
+
+			NAME: afc_string_char_at ( str, index ) - Returns the character at the specified index
+
+	SYNOPSIS: char afc_string_char_at ( const char * str, long index )
+
+		 DESCRIPTION: Returns the character at the specified index. Accepts negative integers to count back from the last string character.
+
+		 INPUT: - str				- The string.
+			- index 			- The index of the character to return.
+
+		RESULT: - The character at the specified index, or '\0' if out of range.
+
+	SEE ALSO:
+
+@endnode
+*/
+char afc_string_char_at(const char *str, long index)
+{
+	unsigned long len;
+
+	if (str == NULL)
+		return '\0';
+
+	len = afc_string_len(str);
+
+	if (index < 0)
+		index = len + index;
+
+	if (index < 0 || index >= (long)len)
+		return '\0';
+
+	return str[index];
+}
+// }}}
+
+// {{{ afc_string_starts_with ( str, search, position )
+/*
+@node afc_string_starts_with
+
+			NAME: afc_string_starts_with ( str, search, position ) - Checks if string starts with search string
+
+	SYNOPSIS: int afc_string_starts_with ( const char * str, const char * search, unsigned long position )
+
+		 DESCRIPTION: Determines whether a string begins with the characters of a specified string.
+
+		 INPUT: - str				- The string to check.
+			- search 			- The characters to be searched for at the start of this string.
+			- position 			- The position in this string at which to begin searching for searchString. Defaults to 0.
+
+		RESULT: - 1 if the string begins with the characters of the search string, 0 otherwise.
+
+	SEE ALSO: - afc_string_ends_with()
+
+@endnode
+*/
+int afc_string_starts_with(const char *str, const char *search, unsigned long position)
+{
+	unsigned long len, search_len;
+
+	if (str == NULL || search == NULL)
+		return 0;
+
+	len = afc_string_len(str);
+	search_len = strlen(search);
+
+	if (position > len)
+		return 0;
+
+	if (search_len > len - position)
+		return 0;
+
+	return (strncmp(str + position, search, search_len) == 0);
+}
+// }}}
+
+// {{{ afc_string_ends_with ( str, search, length )
+/*
+@node afc_string_ends_with
+
+			NAME: afc_string_ends_with ( str, search, length ) - Checks if string ends with search string
+
+	SYNOPSIS: int afc_string_ends_with ( const char * str, const char * search, unsigned long length )
+
+		 DESCRIPTION: Determines whether a string ends with the characters of a specified string.
+
+		 INPUT: - str				- The string to check.
+			- search 			- The characters to be searched for at the end of this string.
+			- length 			- If provided, it is used as the length of str. Defaults to str.length.
+
+		RESULT: - 1 if the string ends with the characters of the search string, 0 otherwise.
+
+	SEE ALSO: - afc_string_starts_with()
+
+@endnode
+*/
+int afc_string_ends_with(const char *str, const char *search, unsigned long length)
+{
+	unsigned long len, search_len;
+
+	if (str == NULL || search == NULL)
+		return 0;
+
+	len = afc_string_len(str);
+	search_len = strlen(search);
+
+	if ((long)length == ALL || length > len)
+		length = len;
+
+	if (search_len > length)
+		return 0;
+
+	return (strncmp(str + length - search_len, search, search_len) == 0);
+}
+// }}}
+
+// {{{ afc_string_repeat ( dest, str, count )
+/*
+@node afc_string_repeat
+
+			NAME: afc_string_repeat ( dest, str, count ) - Returns a new string containing the specified number of copies of the given string
+
+	SYNOPSIS: char * afc_string_repeat ( char * dest, const char * str, unsigned long count )
+
+		 DESCRIPTION: Returns a new string containing the specified number of copies of the given string.
+
+		 INPUT: - dest				- The destination string.
+			- str 				- The string to repeat.
+			- count 			- The number of times to repeat the string.
+
+		RESULT: - The destination string.
+
+	SEE ALSO:
+
+@endnode
+*/
+char *afc_string_repeat(char *dest, const char *str, unsigned long count)
+{
+	unsigned long i;
+
+	if (dest == NULL)
+		return NULL;
+
+	afc_string_clear(dest);
+
+	if (str == NULL || count == 0)
+		return dest;
+
+	for (i = 0; i < count; i++)
+	{
+		afc_string_add(dest, str, ALL);
+	}
+
+	return dest;
+}
+// }}}
+
+// {{{ afc_string_replace ( dest, str, pattern, replacement )
+/*
+@node afc_string_replace
+
+			NAME: afc_string_replace ( dest, str, pattern, replacement ) - Replaces the first occurrence of pattern with replacement
+
+	SYNOPSIS: char * afc_string_replace ( char * dest, const char * str, const char * pattern, const char * replacement )
+
+		 DESCRIPTION: Returns a new string with the first match of a pattern replaced by a replacement.
+
+		 INPUT: - dest				- The destination string.
+			- str 				- The source string.
+			- pattern 			- The string pattern to replace.
+			- replacement 			- The replacement string.
+
+		RESULT: - The destination string.
+
+	SEE ALSO: - afc_string_replace_all()
+
+@endnode
+*/
+char *afc_string_replace(char *dest, const char *str, const char *pattern, const char *replacement)
+{
+	char *pos;
+	unsigned long offset;
+
+	if (dest == NULL)
+		return NULL;
+
+	if (str == NULL)
+	{
+		afc_string_clear(dest);
+		return dest;
+	}
+
+	if (pattern == NULL || replacement == NULL)
+	{
+		afc_string_copy(dest, str, ALL);
+		return dest;
+	}
+
+	pos = (char *)afc_string_internal_find(str, strlen(str), pattern, strlen(pattern));
+
+	if (pos == NULL)
+	{
+		afc_string_copy(dest, str, ALL);
+		return dest;
+	}
+
+	offset = pos - str;
+
+	afc_string_copy(dest, str, offset);
+	afc_string_add(dest, replacement, ALL);
+	afc_string_add(dest, pos + strlen(pattern), ALL);
+
+	return dest;
+}
+// }}}
+
+// {{{ afc_string_replace_all ( dest, str, pattern, replacement )
+/*
+@node afc_string_replace_all
+
+			NAME: afc_string_replace_all ( dest, str, pattern, replacement ) - Replaces all occurrences of pattern with replacement
+
+	SYNOPSIS: char * afc_string_replace_all ( char * dest, const char * str, const char * pattern, const char * replacement )
+
+		 DESCRIPTION: Returns a new string with all matches of a pattern replaced by a replacement.
+
+		 INPUT: - dest				- The destination string.
+			- str 				- The source string.
+			- pattern 			- The string pattern to replace.
+			- replacement 			- The replacement string.
+
+		RESULT: - The destination string.
+
+	SEE ALSO: - afc_string_replace()
+
+@endnode
+*/
+char *afc_string_replace_all(char *dest, const char *str, const char *pattern, const char *replacement)
+{
+	if (dest == NULL)
+		return NULL;
+
+	if (str == NULL)
+	{
+		afc_string_clear(dest);
+		return dest;
+	}
+
+	if (pattern == NULL || replacement == NULL || *pattern == '\0')
+	{
+		afc_string_copy(dest, str, ALL);
+		return dest;
+	}
+
+	return (afc_string_internal_replace(&dest, FALSE, str, &pattern, &replacement, 1));
+}
+// }}}
+
+// {{{ afc_string_replace_multi ( dest, str, patterns, replacements, count )
+/*
+@node afc_string_replace_multi
+
+			NAME: afc_string_replace_multi ( dest, str, patterns, replacements, count ) - Replaces many patterns at once
+
+	SYNOPSIS: char * afc_string_replace_multi ( char * dest, const char * str, const char ** patterns, const char ** replacements, int count )
+	   SINCE: 1.04
+
+		 DESCRIPTION: Copies /str/ inside /dest/ replacing every occurrence of /patterns[i]/ with /replacements[i]/.
+				The string is scanned only once: when more patterns match at the same position, the first one in
+				the /patterns/ array wins, and replaced text is never scanned again.
+
+		 INPUT: - dest				- The destination AFC string.
+			- str 				- The source string.
+			- patterns 			- Array of /count/ strings to replace.
+			- replacements 			- Array of /count/ replacement strings.
+			- count 			- Number of patterns.
+
+		RESULT: - The destination string, or NULL in case of errors.
+
+			NOTE: - NULL or empty patterns (and patterns with a NULL replacement) are ignored.
+			  - If /dest/ is too small, the result is truncated. Use afc_string_resize_replace_multi() to get a bigger
+			    string instead.
+			  - /dest/ and /str/ must not be the same string.
+
+	SEE ALSO: - afc_string_replace_all()
+		  - afc_string_resize_replace_multi()
+
+@endnode
+*/
+char *afc_string_replace_multi(char *dest, const char *str, const char **patterns, const char **replacements, int count)
+{
+	if (dest == NULL)
+		return NULL;
+
+	if (str == NULL)
+	{
+		afc_string_clear(dest);
+		return dest;
+	}
+
+	if (patterns == NULL || replacements == NULL || count <= 0)
+	{
+		afc_string_copy(dest, str, ALL);
+		return dest;
+	}
+
+	return (afc_string_internal_replace(&dest, FALSE, str, patterns, replacements, count));
+}
+// }}}
+
+// {{{ afc_string_resize_replace_all ( dest, str, pattern, replacement )
+/*
+@node afc_string_resize_replace_all
+
+			NAME: afc_string_resize_replace_all ( dest, str, pattern, replacement ) - Replaces all occurrences resizing the dest buffer
+
+	SYNOPSIS: char * afc_string_resize_replace_all ( char ** dest, const char * str, const char * pattern, const char * replacement )
+	   SINCE: 1.04
+
+		 DESCRIPTION: Works like afc_string_replace_all(), but if the result does not fit inside /dest/, a new AFC string
+				of the right size is allocated in place of the original /dest/.
+
+		 INPUT: - dest				- Pointer to the destination AFC string.
+			- str 				- The source string. It can also be the destination string.
+			- pattern 			- The string pattern to replace.
+			- replacement 			- The replacement string.
+
+		RESULT: - The destination string, or NULL in case of errors (/dest/ is left untouched).
+
+	SEE ALSO: - afc_string_replace_all()
+		  - afc_string_resize_replace_multi()
+
+@endnode
+*/
+char *afc_string_resize_replace_all(char **dest, const char *str, const char *pattern, const char *replacement)
+{
+	return (afc_string_resize_replace_multi(dest, str, &pattern, &replacement, 1));
+}
+// }}}
+
+// {{{ afc_string_resize_replace_multi ( dest, str, patterns, replacements, count )
+/*
+@node afc_string_resize_replace_multi
+
+			NAME: afc_string_resize_replace_multi ( dest, str, patterns, replacements, count ) - Replaces many patterns resizing the dest buffer
+
+	SYNOPSIS: char * afc_string_resize_replace_multi ( char ** dest, const char * str, const char ** patterns, const char ** replacements, int count )
+	   SINCE: 1.04
+
+		 DESCRIPTION: Works like afc_string_replace_multi(), but if the result does not fit inside /dest/, a new AFC string
+				of the right size is allocated in place of the original /dest/.
+
+		 INPUT: - dest				- Pointer to the destination AFC string.
+			- str 				- The source string. It can also be the destination string.
+			- patterns 			- Array of /count/ strings to replace.
+			- replacements 			- Array of /count/ replacement strings.
+			- count 			- Number of patterns.
+
+		RESULT: - The destination string, or NULL in case of errors (/dest/ is left untouched).
+
+	SEE ALSO: - afc_string_replace_multi()
+
+@endnode
+*/
+char *afc_string_resize_replace_multi(char **dest, const char *str, const char **patterns, const char **replacements, int count)
+{
+	if (dest == NULL || *dest == NULL)
+		return NULL;
+
+	if (str == NULL)
+	{
+		afc_string_clear(*dest);
+		return *dest;
+	}
+
+	if (patterns == NULL || replacements == NULL || count < 0)
+		count = 0;
+
+	return (afc_string_internal_replace(dest, TRUE, str, patterns, replacements, count));
+}
+// }}}
+
+// {{{ afc_string_pad_start ( dest, str, targetLength, padString )
+/*
+@node afc_string_pad_start
+
+			NAME: afc_string_pad_start ( dest, str, targetLength, padString ) - Pads the current string with a given string from the start
+
+	SYNOPSIS: char * afc_string_pad_start ( char * dest, const char * str, unsigned long targetLength, const char * padString )
+
+		 DESCRIPTION: Pads the current string with a given string (repeated, if needed) so that the resulting string reaches a given length. Padding is applied from the start.
+
+		 INPUT: - dest				- The destination string.
+			- str 				- The source string.
+			- targetLength 			- The length of the resulting string once the current string has been padded.
+			- padString 			- The string to pad the current string with. Defaults to " ".
+
+		RESULT: - The destination string.
+
+	SEE ALSO: - afc_string_pad_end()
+
+@endnode
+*/
+char *afc_string_pad_start(char *dest, const char *str, unsigned long targetLength, const char *padString)
+{
+	unsigned long str_len, pad_len, padding_needed, i;
+	const char *pad = (padString != NULL) ? padString : " ";
+
+	if (dest == NULL)
+		return NULL;
+
+	if (str == NULL)
+		str = "";
+
+	str_len = afc_string_len(str);
+
+	if (str_len >= targetLength)
+	{
+		afc_string_copy(dest, str, ALL);
+		return dest;
+	}
+
+	padding_needed = targetLength - str_len;
+	pad_len = strlen(pad);
+
+	afc_string_clear(dest);
+
+	for (i = 0; i < padding_needed; i++)
+	{
+		// Add one char at a time from pad string
+		char c[2] = {pad[i % pad_len], '\0'};
+		afc_string_add(dest, c, ALL);
+	}
+
+	afc_string_add(dest, str, ALL);
+
+	return dest;
+}
+// }}}
+
+// {{{ afc_string_pad_end ( dest, str, targetLength, padString )
+/*
+@node afc_string_pad_end
+
+			NAME: afc_string_pad_end ( dest, str, targetLength, padString ) - Pads the current string with a given string from the end
+
+	SYNOPSIS: char * afc_string_pad_end ( char * dest, const char * str, unsigned long targetLength, const char * padString )
+
+		 DESCRIPTION: Pads the current string with a given string (repeated, if needed) so that the resulting string reaches a given length. Padding is applied from the end.
+
+		 INPUT: - dest				- The destination string.
+			- str 				- The source string.
+			- targetLength 			- The length of the resulting string once the current string has been padded.
+			- padString 			- The string to pad the current string with. Defaults to " ".
+
+		RESULT: - The destination string.
+
+	SEE ALSO: - afc_string_pad_start()
+
+@endnode
+*/
+char *afc_string_pad_end(char *dest, const char *str, unsigned long targetLength, const char *padString)
+{
+	unsigned long str_len, pad_len, padding_needed, i;
+	const char *pad = (padString != NULL) ? padString : " ";
+
+	if (dest == NULL)
+		return NULL;
+
+	if (str == NULL)
+		str = "";
+
+	str_len = afc_string_len(str);
+
+	afc_string_copy(dest, str, ALL);
+
+	if (str_len >= targetLength)
+		return dest;
+
+	padding_needed = targetLength - str_len;
+	pad_len = strlen(pad);
+
+	for (i = 0; i < padding_needed; i++)
+	{
+		// Add one char at a time from pad string
+		char c[2] = {pad[i % pad_len], '\0'};
+		afc_string_add(dest, c, ALL);
+	}
+
+	return dest;
+}
+// }}}
+
+// {{{ afc_string_slice ( dest, str, beginIndex, endIndex )
+/*
+@node afc_string_slice
+
+			NAME: afc_string_slice ( dest, str, beginIndex, endIndex ) - Extracts a section of a string
+
+	SYNOPSIS: char * afc_string_slice ( char * dest, const char * str, long beginIndex, long endIndex )
+
+		 DESCRIPTION: Extracts a section of a string and returns it as a new string (in dest), without modifying the original string.
+
+		 INPUT: - dest				- The destination string.
+			- str 				- The source string.
+			- beginIndex 			- The zero-based index at which to begin extraction. If negative, it is treated as strLength + beginIndex.
+			- endIndex 			- The zero-based index before which to end extraction. The character at this index will not be included. If negative, it is treated as strLength + endIndex. To extract to the end of the string, pass a value >= string length (e.g. LONG_MAX).
+
+		RESULT: - The destination string.
+
+	SEE ALSO: - afc_string_mid()
+
+@endnode
+*/
+char *afc_string_slice(char *dest, const char *str, long beginIndex, long endIndex)
+{
+	unsigned long len;
+	long start, end;
+
+	if (dest == NULL)
+		return NULL;
+
+	afc_string_clear(dest);
+
+	if (str == NULL)
+		return dest;
+
+	len = strlen(str);
+	start = beginIndex;
+	end = endIndex;
+
+	// Handle negative start
+	if (start < 0)
+	{
+		start = len + start;
+	}
+
+	// Clamp start
+	if (start < 0)
+		start = 0;
+	if (start >= (long)len)
+		return dest; // Empty
+
+	// Handle negative end
+	if (end < 0)
+	{
+		end = len + end;
+	}
+
+	// Clamp end
+	if (end > (long)len)
+		end = len;
+	if (end < 0)
+		end = 0;
+
+	if (end <= start)
+		return dest; // Empty
+
+	return afc_string_copy(dest, str + start, end - start);
+}
+// }}}
+
+// {{{ afc_string_index_of ( str, search, fromIndex )
+/*
+@node afc_string_index_of
+
+			NAME: afc_string_index_of ( str, search, fromIndex ) - Returns the index of the first occurrence of the specified value
+
+	SYNOPSIS: long afc_string_index_of ( const char * str, const char * search, long fromIndex )
+
+		 DESCRIPTION: Returns the index of the first occurrence of the specified value, or -1 if not found.
+
+		 INPUT: - str				- The string to search in.
+			- search 			- The string to search for.
+			- fromIndex 			- The index to start the search from.
+
+		RESULT: - The index of the first occurrence, or -1 if not found.
+
+	SEE ALSO: - afc_string_last_index_of()
+
+@endnode
+*/
+long afc_string_index_of(const char *str, const char *search, long fromIndex)
+{
+	long len;
+	char *p;
+
+	if (str == NULL || search == NULL)
+		return -1;
+
+	len = afc_string_len(str);
+
+	if (fromIndex < 0)
+		fromIndex = 0;
+
+	if (fromIndex >= len)
+		return -1;
+
+	p = (char *)afc_string_internal_find(str + fromIndex, strlen(str + fromIndex), search, strlen(search));
+
+	if (p)
+		return (long)(p - str);
+
+	return -1;
+}
+// }}}
+
+// {{{ afc_string_last_index_of ( str, search, fromIndex )
+/*
+@node afc_string_last_index_of
+
+			NAME: afc_string_last_index_of ( str, search, fromIndex ) - Returns the index of the last occurrence of the specified value
+
+	SYNOPSIS: long afc_string_last_index_of ( const char * str, const char * search, long fromIndex )
+
+		 DESCRIPTION: Returns the index of the last occurrence of the specified value, searching backwards from fromIndex.
+
+		 INPUT: - str				- The string to search in.
+			- search 			- The string to search for.
+			- fromIndex 			- The index to start the search backwards from.
+
+		RESULT: - The index of the last occurrence, or -1 if not found.
+
+	SEE ALSO: - afc_string_index_of()
+
+@endnode
+*/
+long afc_string_last_index_of(const char *str, const char *search, long fromIndex)
+{
+	long len, search_len, i;
+	const char *p;
+
+	if (str == NULL || search == NULL)
+		return -1;
+
+	len = afc_string_len(str);
+	search_len = strlen(search);
+
+	if (search_len == 0)
+		return (fromIndex >= len) ? len : fromIndex;
+
+	if (fromIndex < 0)
+		return -1; // JS behavior: if fromIndex < 0, treated as 0, but since we search backwards from 0, only match at 0 is possible if searchLen is 0, else -1. Actually JS treats negative as 0.
+
+	if (fromIndex >= len)
+		fromIndex = len;
+
+	// Start searching from min(fromIndex, len - searchLen)
+	i = fromIndex;
+	if (i > len - (long)search_len)
+		i = len - (long)search_len;
+
+	if (i < 0)
+		return -1;
+
+	p = afc_string_internal_rfind(str, i, search, search_len);
+
+	if (p)
+		return (long)(p - str);
+
+	return -1;
 }
 // }}}
-// {{{ afc_string_resize_copy ( dest, str )
-/*
-@node afc_string_resize_copy
 
-		NAME: afc_string_resize_copy ( dest, str ) - Copies a string resizing the dest buffer
+// {{{ afc_string_trim_start ( str )
+/*
+@node afc_string_trim_start
 
-	SYNOPSIS: char * afc_string_resize_copy ( char * * dest, char * str )
+			NAME: afc_string_trim_start ( str ) - Removes whitespace from the beginning of a string
 
-	 DESCRIPTION: This function copies the full content of string /str/ inside the /dest/ AFC String.
-		  If the memory alloc'd for the /dest/ string is not enough, a new string is allocated in place
-		  of the original /dest/ AFC String and the /str/ is copied.
+	SYNOPSIS: char * afc_string_trim_start ( char * str )
 
-	   INPUT: - dest		- The destination string where to copy the /str/ data.
-		  - str			- The string to be copied into /dest/.
+		 DESCRIPTION: Removes whitespace from the beginning of a string. Modifies the string in place.
 
-	  RESULT: - The /str/ will be copied inside /dest/.
+		 INPUT: - str				- The string to trim.
 
-		NOTE: - /dest/ is a pointer of pointer. You have to call this function by referencing the /dest/ string
-		   with the "&" operator. Eg. afc_string_resize_copy ( &dest, "hello world" );
+		RESULT: - The trimmed string.
 
-	SEE ALSO: - afc_string_copy()
+	SEE ALSO: - afc_string_trim_end()
 
 @endnode
 */
-char *afc_string_resize_copy(char **dest, const char *str)
+char *afc_string_trim_start(char *str)
 {
-	char *str_new;
-	unsigned int max;
-	unsigned int new_max;
+	char *p;
 
-	max = afc_string_max(*dest);
+	if (str == NULL)
+		return NULL;
 
-	if ((strlen(str) + afc_string_len(*dest)) > (max - 3))
-	{
-		new_max = max * 2;
-		if (new_max > AFC_MAX_BUFFER_SIZE)
-			new_max = AFC_MAX_BUFFER_SIZE;
-		if (new_max <= max) return NULL;
-		str_new = afc_string_new(new_max);
-		afc_string_copy(str_new, *dest, ALL);
+	p = str;
+	while (isspace((unsigned char)*p))
+		p++;
 
-		afc_string_delete(*dest);
-		*dest = str_new;
+	if (p != str)
+	{
+		afc_string_copy(str, p, ALL);
 	}
-	else
-		afc_string_copy(*dest, str, ALL);
 
-	return (*dest);
+	return str;
 }
 // }}}
-// {{{ afc_string_resize_add ( dest, str )
-char *afc_string_resize_add(char **dest, const char *str)
-{
-	char *str_new;
-	unsigned int max;
-	unsigned int needed;
-	unsigned int new_max;
 
-	max = afc_string_max(*dest);
+// {{{ afc_string_trim_end ( str )
+/*
+@node afc_string_trim_end
 
-	if ((strlen(str) + afc_string_len(*dest)) > (max - 3))
-	{
-		needed = (strlen(str) + afc_string_len(*dest)) * 2;
-		new_max = (needed > AFC_MAX_BUFFER_SIZE) ? AFC_MAX_BUFFER_SIZE : needed;
-		if (new_max <= max) return (NULL);
-		if ((str_new = afc_string_new(new_max)) == NULL)
-			return (NULL);
+			NAME: afc_string_trim_end ( str ) - Removes whitespace from the end of a string
 
-		afc_string_copy(str_new, *dest, ALL);
+	SYNOPSIS: char * afc_string_trim_end ( char * str )
 
-		afc_string_delete(*dest);
-		*dest = str_new;
-	}
+		 DESCRIPTION: Removes whitespace from the end of a string. Modifies the string in place.
 
-	afc_string_add(*dest, str, ALL);
+		 INPUT: - str				- The string to trim.
 
-	return (*dest);
-}
-// }}}
+		RESULT: - The trimmed string.
 
-// {{{ afc_string_dirname ( path )
-char *afc_string_dirname(const char *path)
+	SEE ALSO: - afc_string_trim_start()
+
+@endnode
+*/
+char *afc_string_trim_end(char *str)
 {
-	char *dest = NULL;
-	char *x;
+	long len;
+	char *p;
 
-	// If path is not defined, do nothing.
-	if (path == NULL)
-		return (NULL);
+	if (str == NULL)
+		return NULL;
 
-	// Search for the last directory separator in the file_name
-	x = _afc_string_find_last_sep(path);
+	len = afc_string_len(str);
+	if (len == 0)
+		return str;
 
-	// if we don't find it, simply copy all the path
-	if (x == NULL)
-		dest = afc_string_dup(path);
-	else
-	{
-		// ... else we have to create a new string and
-		// copy the chars we are interested in
-		size_t len = x - path;
-		if (len == 0)
-		{
-			// Path starts with separator (e.g., "/file.txt")
-			dest = afc_string_new(1);
-		}
-		else
-		{
-			dest = afc_string_new(len);
-			afc_string_copy(dest, path, len);
-		}
-	}
+	p = str + len - 1;
+	while (p >= str && isspace((unsigned char)*p))
+		p--;
 
-	return (dest);
+	*(p + 1) = '\0';
+	afc_string_reset_len(str);
+
+	return str;
 }
 // }}}
-// {{{ afc_string_basename ( path )
-char *afc_string_basename(const char *path)
-{
-	char *dest = NULL;
-	char *x;
 
-	// If path is not defined, do nothing.
-	if (path == NULL)
-		return (NULL);
+// {{{ afc_string_from_char_code ( code )
+/*
+@node afc_string_from_char_code
 
-	// Search for the last directory separator in the file_name
-	x = _afc_string_find_last_sep(path);
+			NAME: afc_string_from_char_code ( code ) - Returns a string created from the specified UTF-16 code unit
 
-	// if we don't find it, simply copy all the path
-	if (x == NULL)
-		dest = afc_string_dup(path);
-	else
+	SYNOPSIS: char * afc_string_from_char_code ( int code )
+
+		 DESCRIPTION: Returns a string created from the specified char code.
+
+		 INPUT: - code				- The char code.
+
+		RESULT: - A new AFC string containing the character.
+
+	SEE ALSO:
+
+@endnode
+*/
+char *afc_string_from_char_code(int code)
+{
+	char *s = afc_string_new(1);
+	if (s)
 	{
-		// ... else we have to create a new string and
-		// copy the chars we are interested in
-		dest = afc_string_dup(x + 1);
+		s[0] = (char)code;
+		s[1] = '\0';
+		afc_string_reset_len(s);
 	}
-
-	return (dest);
+	return s;
 }
 // }}}
 
-int _afc_string_seems_utf8(const char *str)
-{
-	const unsigned char *p = (const unsigned char *)str;
-	int remaining = 0; /* expected continuation bytes */
+// {{{ afc_string_view ( str )
+/*
+@node afc_string_view
 
-	while (*p)
-	{
-		if (remaining > 0)
-		{
-			/* Expecting a continuation byte 10xxxxxx */
-			if ((*p & 0xC0) != 0x80)
-				return FALSE;
-			remaining--;
-		}
-		else if (*p < 0x80)
-		{
-			/* ASCII */
-			remaining = 0;
-		}
-		else if ((*p & 0xE0) == 0xC0)
-		{
-			remaining = 1;
-		}
-		else if ((*p & 0xF0) == 0xE0)
-		{
-			remaining = 2;
-		}
-		else if ((*p & 0xF8) == 0xF0)
-		{
-			remaining = 3;
-		}
-		else
-		{
-			return FALSE;
-		}
-		p++;
-	}
+			NAME: afc_string_view ( str ) - Returns a view of the whole string
 
-	return (remaining == 0) ? TRUE : FALSE;
-}
+	SYNOPSIS: afc_strview afc_string_view ( const char * str )
 
-char *afc_string_utf8_to_latin1(const char *utf8)
+	   SINCE: 1.03
+
+		 DESCRIPTION: This function returns an afc_strview (a pointer and a length) covering the whole /str/.
+					  A view does not own any memory: it is just a way to point to a part of a string without
+					  copying it. Use afc_strview_mid(), afc_strview_trim() and afc_strview_token() to get
+					  smaller views, and afc_string_dup_view() or afc_string_copy_view() when you need a real string.
+
+		 INPUT: - str				- The string. If it is an AFC string, its length is read in constant time,
+									  otherwise use afc_strview_make().
+
+		RESULT: - A view of /str/. NULL strings give an empty view.
+
+			NOTE: - The view is valid as long as /str/ is not changed or freed.
+				  - Chars in a view are *not* NUL terminated.
+
+	SEE ALSO: - afc_strview_make()
+			  - afc_string_dup_view()
+
+@endnode
+*/
+afc_strview afc_string_view(const char *str)
 {
-	if (!utf8 || !strlen(utf8))
-		return afc_string_new(1);
+	afc_strview v;
 
-	if (!_afc_string_seems_utf8(utf8))
-	{
-		return afc_string_dup(utf8);
-	}
+	v.str = str;
+	v.len = str ? afc_string_len(str) : 0;
 
-	unsigned int buf_size = strlen(utf8) + 20;
-	unsigned char *s = afc_malloc(buf_size);
-	unsigned int pos = 0;
-	unsigned int len = strlen(utf8);
-	unsigned char c1, c2, c3, c4, iso;
-	unsigned int xpos = 0;
-	char *res;
+	return (v);
+}
+// }}}
+// {{{ afc_strview_make ( str, len )
+/*
+@node afc_strview_make
 
-	while (pos < len)
-	{
-		c1 = utf8[pos++];
+			NAME: afc_strview_make ( str, len ) - Returns a view of a C string or memory area
 
-		if (c1 <= 0x7F)
-		{
-			if (xpos >= buf_size - 1) break;
-			s[xpos++] = c1;
-		}
-		else if (c1 >= 0xC0 && c1 <= 0xDF)
-		{
-			if (pos >= len)
-			{
-				_afc_dprintf("%s::%s - ERROR: truncated UTF-8 sequence", __FILE__, __FUNCTION__);
-				afc_free(s);
-				return NULL;
-			}
+	SYNOPSIS: afc_strview afc_strview_make ( const char * str, unsigned long len )
 
-			c2 = utf8[pos++];
-			iso = ((c1 & 0x1F) << 6) | (c2 & 0x3F);
+	   SINCE: 1.03
 
-			if (xpos >= buf_size - 1) break;
-			s[xpos++] = iso;
-		}
-		else if (c1 >= 0xE0 && c1 <= 0xEF)
-		{
-			if (pos + 1 >= len)
-			{
-				_afc_dprintf("%s::%s - ERROR: truncated UTF-8 sequence", __FILE__, __FUNCTION__);
-				afc_free(s);
-				return NULL;
-			}
+		 DESCRIPTION: This function returns a view of the first /len/ chars of /str/.
 
-			c2 = utf8[pos++];
-			c3 = utf8[pos++];
-			unsigned int codepoint = ((c1 & 0x0F) << 12) | ((c2 & 0x3F) << 6) | (c3 & 0x3F);
+		 INPUT: - str				- Any string or memory area.
+				- len				- Number of chars in the view. Pass /ALL/ to use strlen().
 
-			if (codepoint > 0xFF)
-			{
-				if (xpos >= buf_size - 1) break;
-				s[xpos++] = '?';
-			}
-			else
-			{
-				if (xpos >= buf_size - 1) break;
-				s[xpos++] = (unsigned char)codepoint;
-			}
-		}
-		else if (c1 >= 0xF0 && c1 <= 0xF7)
-		{
-			if (pos + 2 >= len)
-			{
-				_afc_dprintf("%s::%s - ERROR: truncated UTF-8 sequence", __FILE__, __FUNCTION__);
-				afc_free(s);
-				return NULL;
-			}
+		RESULT: - A view of /str/. NULL strings give an empty view.
 
-			c2 = utf8[pos++];
-			c3 = utf8[pos++];
-			c4 = utf8[pos++];
-			unsigned int codepoint = ((c1 & 0x07) << 18) | ((c2 & 0x3F) << 12) | ((c3 & 0x3F) << 6) | (c4 & 0x3F);
+	SEE ALSO: - afc_string_view()
 
-			if (codepoint > 0xFF)
-			{
-				if (xpos >= buf_size - 1) break;
-				s[xpos++] = '?';
-			}
-			else
-			{
-				if (xpos >= buf_size - 1) break;
-				s[xpos++] = (unsigned char)codepoint;
-			}
-		}
-		else
-		{
-			if (xpos >= buf_size - 1) break;
-			s[xpos++] = '?';
-		}
-	}
+@endnode
+*/
+afc_strview afc_strview_make(const char *str, unsigned long len)
+{
+	afc_strview v;
 
-	s[xpos] = '\0';
+	v.str = str;
 
-	res = afc_string_dup((char *)s);
-	afc_free(s);
+	if (str == NULL)
+		v.len = 0;
+	else if ((long)len == ALL)
+		v.len = strlen(str);
+	else
+		v.len = len;
 
-	return res;
+	return (v);
 }
-
-#ifndef MINGW
-// {{{ afc_string_pattern_match ( str, pattern, no_case )
+// }}}
+// {{{ afc_strview_mid ( view, from, num_chars )
 /*
-@node afc_string_pattern_match
+@node afc_strview_mid
 
-			NAME: afc_string_pattern_match ( string, pattern, no_case ) - Use pattern matching against this string
+			NAME: afc_strview_mid ( view, from, num_chars ) - Returns a part of a view
 
-	SYNOPSIS: int afc_string_pattern_match ( const char * string, const char * pattern, short no_case )
+	SYNOPSIS: afc_strview afc_strview_mid ( afc_strview view, unsigned long from, unsigned long num_chars )
 
-		 DESCRIPTION: This function tests if the given /string/ correctly matches the provided /pattern/ using
-					  the standard system pattern matching algo. It can be made case insensitive by passing TRUE
-					  as /no_case/ value.
+	   SINCE: 1.03
 
-		 INPUT: - string				- AFC string to convert.
-			- pattern 			- The pattern string. It doesn't necessarily need to be an AFC string.
-			- no_case  			- Flag T/F. If TRUE, the pattern matching is done case insensitive.
+		 DESCRIPTION: This function works like afc_string_mid(), but nothing is copied: the result is a view of the
+					  same chars. Use afc_strview_mid ( view, 0, n ) for the leftmost /n/ chars and
+					  afc_strview_mid ( view, view.len - n, n ) for the rightmost ones.
 
-		RESULT: - 0 - The /string/ matches /pattern/.
-			- non zero - The /string/ does /not/ match /pattern/ or NULL pointers passed.
+		 INPUT: - view				- The source view.
+				- from				- First char of the result (0 based).
+				- num_chars			- Number of chars. Pass /ALL/ to get everything after /from/.
 
-			NOTE: - This function can handle NULL pointers.
+		RESULT: - The new view. It is empty if /from/ is past the end of /view/.
 
-	SEE ALSO:
+	SEE ALSO: - afc_string_mid()
+			  - afc_strview_trim()
 
 @endnode
 */
-int afc_string_pattern_match(const char *str, const char *pattern, short nocase)
+afc_strview afc_strview_mid(afc_strview view, unsigned long from, unsigned long num_chars)
 {
-	int res;
-	char *s, *patt;
+	if (from > view.len)
+		from = view.len;
 
-	if ((str == NULL) || (pattern == NULL))
-		return (-1);
+	view.str = view.str ? view.str + from : NULL;
+	view.len -= from;
 
-	if (nocase)
-	{
-		if ((s = afc_string_dup(str)) == NULL)
-			return (-1);
-		afc_string_upper(s);
+	if (num_chars < view.len)
+		view.len = num_chars;
 
-		if ((patt = afc_string_dup(pattern)) == NULL)
-		{
-			afc_string_delete(s);
-			return (-1);
-		}
+	return (view);
+}
+// }}}
+// {{{ afc_strview_trim ( view )
+/*
+@node afc_strview_trim
 
-		afc_string_upper(patt);
+			NAME: afc_strview_trim ( view ) - Removes blank chars from both ends of a view
 
-		res = fnmatch(patt, s, 0);
+	SYNOPSIS: afc_strview afc_strview_trim ( afc_strview view )
 
-		afc_string_delete(patt);
-		afc_string_delete(s);
+	   SINCE: 1.03
+
+		 DESCRIPTION: This function returns /view/ without the blank chars (space, tab, new line and carriage return)
+					  at its start and at its end. Unlike afc_string_trim(), the string itself is not changed.
+
+		 INPUT: - view				- The view to trim.
+
+		RESULT: - The trimmed view.
+
+	SEE ALSO: - afc_string_trim()
+
+@endnode
+*/
+afc_strview afc_strview_trim(afc_strview view)
+{
+	while ((view.len) && ((view.str[0] == ' ') || (view.str[0] == '\t') || (view.str[0] == '\n') || (view.str[0] == '\r')))
+	{
+		view.str++;
+		view.len--;
 	}
-	else
-		res = fnmatch(pattern, str, 0);
 
-	return (res);
+	while ((view.len) && ((view.str[view.len - 1] == ' ') || (view.str[view.len - 1] == '\t') || (view.str[view.len - 1] == '\n') || (view.str[view.len - 1] == '\r')))
+		view.len--;
+
+	return (view);
 }
 // }}}
-#endif
-
-// {{{ afc_string_char_at ( str, index )
+// {{{ afc_strview_index_of ( view, ch )
 /*
-@node afc_string_char_at
+@node afc_strview_index_of
 
-			NAME: afc_string_char_at ( str, index ) - Returns the character at the specified index
+			NAME: afc_strview_index_of ( view, ch ) - Finds a char in a view
 
-	SYNOPSIS: char afc_string_char_at ( const char * str, long index )
+	SYNOPSIS: long afc_strview_index_of ( afc_strview view, char ch )
 
-		 DESCRIPTION: Returns the character at the specified index. Accepts negative integers to count back from the last string character.
+	   SINCE: 1.03
 
-		 INPUT: - str				- The string.
-			- index 			- The index of the character to return.
+		 DESCRIPTION: This function returns the position of the first /ch/ in /view/.
 
-		RESULT: - The character at the specified index, or '\0' if out of range.
+		 INPUT: - view				- The view to search.
+				- ch				- The char to look for.
 
-	SEE ALSO:
+		RESULT: - The position of the char (0 based), or -1 if it is not in the view.
+
+	SEE ALSO: - afc_string_index_of()
 
 @endnode
 */
-char afc_string_char_at(const char *str, long index)
+long afc_strview_index_of(afc_strview view, char ch)
 {
-	unsigned long len;
-
-	if (str == NULL)
-		return '\0';
-
-	len = afc_string_len(str);
-
-	if (index < 0)
-		index = len + index;
+	const char *p;
 
-	if (index < 0 || index >= (long)len)
-		return '\0';
+	if ((view.len == 0) || ((p = memchr(view.str, ch, view.len)) == NULL))
+		return (-1);
 
-	return str[index];
+	return (p - view.str);
 }
 // }}}
-
-// {{{ afc_string_starts_with ( str, search, position )
+// {{{ afc_strview_comp ( view1, view2 )
 /*
-@node afc_string_starts_with
+@node afc_strview_comp
 
-			NAME: afc_string_starts_with ( str, search, position ) - Checks if string starts with search string
+			NAME: afc_strview_comp ( view1, view2 ) - Compares two views
 
-	SYNOPSIS: int afc_string_starts_with ( const char * str, const char * search, unsigned long position )
+	SYNOPSIS: signed long afc_strview_comp ( afc_strview view1, afc_strview view2 )
 
-		 DESCRIPTION: Determines whether a string begins with the characters of a specified string.
+	   SINCE: 1.03
 
-		 INPUT: - str				- The string to check.
-			- search 			- The characters to be searched for at the start of this string.
-			- position 			- The position in this string at which to begin searching for searchString. Defaults to 0.
+		 DESCRIPTION: This function compares the chars of two views, like afc_string_comp() does with strings.
+					  When a view is the beginning of the other one, the shorter view comes first.
 
-		RESULT: - 1 if the string begins with the characters of the search string, 0 otherwise.
+		 INPUT: - view1				- First view.
+				- view2				- Second view.
 
-	SEE ALSO: - afc_string_ends_with()
+		RESULT: - 0 if the views are equal, a negative value if /view1/ comes before /view2/, a positive
+				  value otherwise.
+
+	SEE ALSO: - afc_strview_equals()
+			  - afc_string_comp()
 
 @endnode
 */
-int afc_string_starts_with(const char *str, const char *search, unsigned long position)
+signed long afc_strview_comp(afc_strview view1, afc_strview view2)
 {
-	unsigned long len, search_len;
-
-	if (str == NULL || search == NULL)
-		return 0;
-
-	len = afc_string_len(str);
-	search_len = strlen(search);
+	int res;
 
-	if (position > len)
-		return 0;
+	if ((view1.len) && (view2.len))
+		if ((res = memcmp(view1.str, view2.str, (view1.len < view2.len) ? view1.len : view2.len)) != 0)
+			return (res);
 
-	if (search_len > len - position)
-		return 0;
+	if (view1.len == view2.len)
+		return (0);
 
-	return (strncmp(str + position, search, search_len) == 0);
+	return ((view1.len < view2.len) ? -1 : 1);
 }
 // }}}
-
-// {{{ afc_string_ends_with ( str, search, length )
+// {{{ afc_strview_equals ( view, str )
 /*
-@node afc_string_ends_with
+@node afc_strview_equals
 
-			NAME: afc_string_ends_with ( str, search, length ) - Checks if string ends with search string
+			NAME: afc_strview_equals ( view, str ) - Checks whether a view holds the given string
 
-	SYNOPSIS: int afc_string_ends_with ( const char * str, const char * search, unsigned long length )
+	SYNOPSIS: int afc_strview_equals ( afc_strview view, const char * str )
 
-		 DESCRIPTION: Determines whether a string ends with the characters of a specified string.
+	   SINCE: 1.03
 
-		 INPUT: - str				- The string to check.
-			- search 			- The characters to be searched for at the end of this string.
-			- length 			- If provided, it is used as the length of str. Defaults to str.length.
+		 DESCRIPTION: This function checks whether the chars of /view/ are exactly the ones of /str/.
 
-		RESULT: - 1 if the string ends with the characters of the search string, 0 otherwise.
+		 INPUT: - view				- The view.
+				- str				- A C string or an AFC string.
 
-	SEE ALSO: - afc_string_starts_with()
+		RESULT: - TRUE if they are equal, FALSE otherwise.
+
+	SEE ALSO: - afc_strview_comp()
 
 @endnode
 */
-int afc_string_ends_with(const char *str, const char *search, unsigned long length)
+int afc_strview_equals(afc_strview view, const char *str)
 {
-	unsigned long len, search_len;
+	if (str == NULL)
+		return (view.len == 0);
 
-	if (str == NULL || search == NULL)
-		return 0;
+	if ((view.len) && (memcmp(view.str, str, view.len) != 0))
+		return (FALSE);
 
-	len = afc_string_len(str);
-	search_len = strlen(search);
+	return (str[view.len] == '\0');
+}
+// }}}
+// {{{ afc_strview_token ( rest, delimiters, escape_char, token )
+/*
+@node afc_strview_token
 
-	if ((long)length == ALL || length > len)
-		length = len;
+			NAME: afc_strview_token ( rest, delimiters, escape_char, token ) - Gets the next token of a view
 
-	if (search_len > length)
-		return 0;
+	SYNOPSIS: int afc_strview_token ( afc_strview * rest, const char * delimiters, char escape_char, afc_strview * token )
 
-	return (strncmp(str + length - search_len, search, search_len) == 0);
-}
-// }}}
+	   SINCE: 1.03
 
-// {{{ afc_string_repeat ( dest, str, count )
-/*
-@node afc_string_repeat
+		 DESCRIPTION: This function splits a view in tokens without allocating any memory. /token/ gets the chars of
+					  /rest/ up to the first char contained in /delimiters/, and /rest/ moves past the delimiter.
+					  Call it until it returns FALSE to get all the tokens:
 
-			NAME: afc_string_repeat ( dest, str, count ) - Returns a new string containing the specified number of copies of the given string
+					  afc_strview rest = afc_string_view ( line ), tok;
 
-	SYNOPSIS: char * afc_string_repeat ( char * dest, const char * str, unsigned long count )
+					  while ( afc_strview_token ( &rest, ",;", 0, &tok ) )
+						  do_something ( tok );
 
-		 DESCRIPTION: Returns a new string containing the specified number of copies of the given string.
+					  Tokens are the same afc_string_list_split() creates: two delimiters in a row give an empty token,
+					  and a delimiter at the very end does not.
 
-		 INPUT: - dest				- The destination string.
-			- str 				- The string to repeat.
-			- count 			- The number of times to repeat the string.
+		 INPUT: - rest				- The view to split. It is updated to the chars after the token.
+				- delimiters		- All the chars separating tokens.
+				- escape_char		- A delimiter preceded by this char does not separate tokens (and the
+									  escape char is kept in the token). Pass 0 if you do not need it.
+				- token				- Where the token is returned.
 
-		RESULT: - The destination string.
+		RESULT: - TRUE if a token has been returned, FALSE when /rest/ is empty.
 
-	SEE ALSO:
+	SEE ALSO: - afc_string_list_split()
 
 @endnode
 */
-char *afc_string_repeat(char *dest, const char *str, unsigned long count)
+int afc_strview_token(afc_strview *rest, const char *delimiters, char escape_char, afc_strview *token)
 {
-	unsigned long i;
+	unsigned char is_delim[256];
+	const unsigned char *d;
+	unsigned long t;
 
-	if (dest == NULL)
-		return NULL;
+	if (rest->len == 0)
+		return (FALSE);
 
-	afc_string_clear(dest);
+	memset(is_delim, 0, sizeof(is_delim));
+	for (d = (const unsigned char *)delimiters; *d; d++)
+		is_delim[*d] = 1;
 
-	if (str == NULL || count == 0)
-		return dest;
+	for (t = 0; t < rest->len; t++)
+		if ((is_delim[(unsigned char)rest->str[t]]) && ((escape_char == 0) || (t == 0) || (rest->str[t - 1] != escape_char)))
+			break;
 
-	for (i = 0; i < count; i++)
-	{
-		afc_string_add(dest, str, ALL);
-	}
+	token->str = rest->str;
+	token->len = t;
 
-	return dest;
+	if (t < rest->len)
+		t++; // Skip the delimiter
+
+	rest->str += t;
+	rest->len -= t;
+
+	return (TRUE);
 }
 // }}}
-
-// {{{ afc_string_replace ( dest, str, pattern, replacement )
+// {{{ afc_string_copy_view ( dest, view )
 /*
-@node afc_string_replace
+@node afc_string_copy_view
 
-			NAME: afc_string_replace ( dest, str, pattern, replacement ) - Replaces the first occurrence of pattern with replacement
+			NAME: afc_string_copy_view ( dest, view ) - Copies a view inside an AFC string
 
-	SYNOPSIS: char * afc_string_replace ( char * dest, const char * str, const char * pattern, const char * replacement )
+	SYNOPSIS: char * afc_string_copy_view ( char * dest, afc_strview view )
 
-		 DESCRIPTION: Returns a new string with the first match of a pattern replaced by a replacement.
+	   SINCE: 1.03
 
-		 INPUT: - dest				- The destination string.
-			- str 				- The source string.
-			- pattern 			- The string pattern to replace.
-			- replacement 			- The replacement string.
+		 DESCRIPTION: This function works like afc_string_copy(), but the source is a view. Since the view length is
+					  known, the source is never scanned looking for its end.
 
-		RESULT: - The destination string.
+		 INPUT: - dest				- Destination string. This string MUST be an AFC string.
+				- view				- The chars to copy.
 
-	SEE ALSO: - afc_string_replace_all()
+		RESULT: - The resulting string. Chars not fitting in /dest/ are not copied.
+
+	SEE ALSO: - afc_string_copy()
+			  - afc_string_add_view()
 
 @endnode
 */
-char *afc_string_replace(char *dest, const char *str, const char *pattern, const char *replacement)
+char *afc_string_copy_view(char *dest, afc_strview view)
 {
-	char *pos;
-	unsigned long offset;
+	unsigned long len = view.len;
 
 	if (dest == NULL)
-		return NULL;
-
-	if (str == NULL)
-	{
-		afc_string_clear(dest);
-		return dest;
-	}
-
-	if (pattern == NULL || replacement == NULL)
-	{
-		afc_string_copy(dest, str, ALL);
-		return dest;
-	}
-
-	pos = strstr(str, pattern);
+		return (NULL);
 
-	if (pos == NULL)
-	{
-		afc_string_copy(dest, str, ALL);
-		return dest;
-	}
+	if (len > afc_string_max(dest))
+		len = afc_string_max(dest);
 
-	offset = pos - str;
+	if (len)
+		memmove(dest, view.str, len);
 
-	afc_string_copy(dest, str, offset);
-	afc_string_add(dest, replacement, ALL);
-	afc_string_add(dest, pos + strlen(pattern), ALL);
+	dest[len] = '\0';
+	*((unsigned long *)(dest - sizeof(unsigned long))) = len;
 
-	return dest;
+	return (dest);
 }
 // }}}
-
-// {{{ afc_string_replace_all ( dest, str, pattern, replacement )
+// {{{ afc_string_add_view ( dest, view )
 /*
-@node afc_string_replace_all
+@node afc_string_add_view
 
-			NAME: afc_string_replace_all ( dest, str, pattern, replacement ) - Replaces all occurrences of pattern with replacement
+			NAME: afc_string_add_view ( dest, view ) - Appends a view to an AFC string
 
-	SYNOPSIS: char * afc_string_replace_all ( char * dest, const char * str, const char * pattern, const char * replacement )
+	SYNOPSIS: char * afc_string_add_view ( char * dest, afc_strview view )
 
-		 DESCRIPTION: Returns a new string with all matches of a pattern replaced by a replacement.
+	   SINCE: 1.03
 
-		 INPUT: - dest				- The destination string.
-			- str 				- The source string.
-			- pattern 			- The string pattern to replace.
-			- replacement 			- The replacement string.
+		 DESCRIPTION: This function works like afc_string_add(), but the source is a view.
 
-		RESULT: - The destination string.
+		 INPUT: - dest				- Destination string. This string MUST be an AFC string.
+				- view				- The chars to append.
 
-	SEE ALSO: - afc_string_replace()
+		RESULT: - The resulting string. Chars not fitting in /dest/ are not copied.
+
+	SEE ALSO: - afc_string_add()
+			  - afc_string_copy_view()
 
 @endnode
 */
-char *afc_string_replace_all(char *dest, const char *str, const char *pattern, const char *replacement)
+char *afc_string_add_view(char *dest, afc_strview view)
 {
-	const char *current_pos = str;
-	char *next_pos;
-	unsigned long pattern_len;
+	unsigned long len = view.len, clen;
 
 	if (dest == NULL)
-		return NULL;
-
-	afc_string_clear(dest);
-
-	if (str == NULL)
-		return dest;
+		return (NULL);
 
-	if (pattern == NULL || replacement == NULL || *pattern == '\0')
-	{
-		afc_string_copy(dest, str, ALL);
-		return dest;
-	}
+	clen = afc_string_len(dest);
 
-	pattern_len = strlen(pattern);
+	if (len > afc_string_max(dest) - clen)
+		len = afc_string_max(dest) - clen;
 
-	while ((next_pos = strstr(current_pos, pattern)) != NULL)
-	{
-		afc_string_add(dest, current_pos, next_pos - current_pos);
-		afc_string_add(dest, replacement, ALL);
-		current_pos = next_pos + pattern_len;
-	}
+	if (len)
+		memmove(dest + clen, view.str, len);
 
-	afc_string_add(dest, current_pos, ALL);
+	dest[clen + len] = '\0';
+	*((unsigned long *)(dest - sizeof(unsigned long))) = clen + len;
 
-	return dest;
+	return (dest);
 }
 // }}}
-
-// {{{ afc_string_pad_start ( dest, str, targetLength, padString )
+// {{{ afc_string_dup_view ( view )
 /*
-@node afc_string_pad_start
+@node afc_string_dup_view
 
-			NAME: afc_string_pad_start ( dest, str, targetLength, padString ) - Pads the current string with a given string from the start
+			NAME: afc_string_dup_view ( view ) - Creates a new AFC string with the chars of a view
 
-	SYNOPSIS: char * afc_string_pad_start ( char * dest, const char * str, unsigned long targetLength, const char * padString )
+	SYNOPSIS: char * afc_string_dup_view ( afc_strview view )
 
-		 DESCRIPTION: Pads the current string with a given string (repeated, if needed) so that the resulting string reaches a given length. Padding is applied from the start.
+	   SINCE: 1.03
 
-		 INPUT: - dest				- The destination string.
-			- str 				- The source string.
-			- targetLength 			- The length of the resulting string once the current string has been padded.
-			- padString 			- The string to pad the current string with. Defaults to " ".
+		 DESCRIPTION: This function works like afc_string_dup(): the new string is just long enough to hold the
+					  chars of the view.
 
-		RESULT: - The destination string.
+		 INPUT: - view				- The chars to copy.
+
+		RESULT: - a new AFC string, or NULL if the view is empty or in case of errors (usually: no memory).
+
+			NOTE: - Free the string with afc_string_delete().
+
+	SEE ALSO: - afc_string_dup()
+
+@endnode
+*/
+char *_afc_string_dup_view(afc_strview view, const char *file, const char *func, const unsigned int line)
+{
+	char *s;
+
+	if (view.len == 0)
+		return (NULL);
+
+	if ((s = _afc_string_new(view.len, file, func, line)) == NULL)
+		return (NULL);
+
+	return (afc_string_copy_view(s, view));
+}
+// }}}
 
-	SEE ALSO: - afc_string_pad_end()
+// {{{ afc_string_builder_init ( sb, size )
+/*
+@node afc_string_builder_init
 
-@endnode
-*/
-char *afc_string_pad_start(char *dest, const char *str, unsigned long targetLength, const char *padString)
-{
-	unsigned long str_len, pad_len, padding_needed, i;
-	const char *pad = (padString != NULL) ? padString : " ";
+			NAME: afc_string_builder_init ( sb, size ) - Prepares a string builder
 
-	if (dest == NULL)
-		return NULL;
+	SYNOPSIS: int afc_string_builder_init ( afc_string_builder * sb, unsigned long size )
+	   SINCE: 1.06
 
-	if (str == NULL)
-		str = "";
+		 DESCRIPTION: A string builder collects text with afc_string_builder_append() and the other append
+				functions, and grows its buffer when needed (doubling it each time, so every append costs
+				O(1) on average). When the text is complete, afc_string_builder_finish() gives it back as a
+				standard AFC String, without copying it.
 
-	str_len = afc_string_len(str);
+				This function allocates the first buffer, able to hold /size/ chars. Calling it is not
+				mandatory: a builder cleared with zeros is valid too, and allocates its buffer on the first append.
 
-	if (str_len >= targetLength)
-	{
-		afc_string_copy(dest, str, ALL);
-		return dest;
-	}
+		 INPUT: - sb				- Pointer to the builder to initialize.
+			- size				- Initial number of chars. Pass 0 to use the default size.
 
-	padding_needed = targetLength - str_len;
-	pad_len = strlen(pad);
+		RESULT: - AFC_ERR_NO_ERROR on success
+			- AFC_ERR_NO_MEMORY if the buffer cannot be allocated
 
-	afc_string_clear(dest);
+	SEE ALSO: - afc_string_builder_append()
+		  - afc_string_builder_finish()
+		  - afc_string_builder_free()
 
-	for (i = 0; i < padding_needed; i++)
-	{
-		// Add one char at a time from pad string
-		char c[2] = {pad[i % pad_len], '\0'};
-		afc_string_add(dest, c, ALL);
-	}
+@endnode
+*/
+int afc_string_builder_init(afc_string_builder *sb, unsigned long size)
+{
+	if (sb == NULL)
+		return (AFC_ERR_NULL_POINTER);
 
-	afc_string_add(dest, str, ALL);
+	if ((sb->str = afc_string_new(size ? size : AFC_STRING_BUILDER_DEFAULT_SIZE)) == NULL)
+		return (AFC_ERR_NO_MEMORY);
 
-	return dest;
+	return (AFC_ERR_NO_ERROR);
 }
 // }}}
-
-// {{{ afc_string_pad_end ( dest, str, targetLength, padString )
+// {{{ afc_string_builder_reserve ( sb, chars )
 /*
-@node afc_string_pad_end
+@node afc_string_builder_reserve
 
-			NAME: afc_string_pad_end ( dest, str, targetLength, padString ) - Pads the current string with a given string from the end
+			NAME: afc_string_builder_reserve ( sb, chars ) - Makes room for more chars
 
-	SYNOPSIS: char * afc_string_pad_end ( char * dest, const char * str, unsigned long targetLength, const char * padString )
+	SYNOPSIS: int afc_string_builder_reserve ( afc_string_builder * sb, unsigned long chars )
+	   SINCE: 1.06
 
-		 DESCRIPTION: Pads the current string with a given string (repeated, if needed) so that the resulting string reaches a given length. Padding is applied from the end.
+		 DESCRIPTION: Grows the builder buffer, if needed, so that /chars/ more chars can be appended
+				without any other allocation. Use it when you know in advance how much text will be added.
 
-		 INPUT: - dest				- The destination string.
-			- str 				- The source string.
-			- targetLength 			- The length of the resulting string once the current string has been padded.
-			- padString 			- The string to pad the current string with. Defaults to " ".
+		 INPUT: - sb				- Pointer to a string builder.
+			- chars				- Number of chars to make room for.
 
-		RESULT: - The destination string.
+		RESULT: - AFC_ERR_NO_ERROR on success
+			- AFC_ERR_NO_MEMORY if the buffer cannot be grown, or if its size would not fit in an
+			  unsigned long. The text already in the builder is kept.
 
-	SEE ALSO: - afc_string_pad_start()
+	SEE ALSO: - afc_string_builder_init()
 
 @endnode
 */
-char *afc_string_pad_end(char *dest, const char *str, unsigned long targetLength, const char *padString)
+int afc_string_builder_reserve(afc_string_builder *sb, unsigned long chars)
 {
-	unsigned long str_len, pad_len, padding_needed, i;
-	const char *pad = (padString != NULL) ? padString : " ";
+	unsigned long len, max, new_max;
+	unsigned long *location;
 
-	if (dest == NULL)
-		return NULL;
+	if (sb == NULL)
+		return (AFC_ERR_NULL_POINTER);
 
-	if (str == NULL)
-		str = "";
+	len = (sb->str == NULL) ? 0 : afc_string_len(sb->str);
 
-	str_len = afc_string_len(str);
+	// The new size, with the terminator and the string header, must not wrap around
+	if (chars > AFC_STRING_INTERNAL_BUILDER_LIMIT - len)
+		return (AFC_ERR_NO_MEMORY);
 
-	afc_string_copy(dest, str, ALL);
+	if (sb->str == NULL)
+		return (afc_string_builder_init(sb, (chars > AFC_STRING_BUILDER_DEFAULT_SIZE) ? chars : 0));
 
-	if (str_len >= targetLength)
-		return dest;
+	max = afc_string_max(sb->str);
 
-	padding_needed = targetLength - str_len;
-	pad_len = strlen(pad);
+	if (len + chars <= max)
+		return (AFC_ERR_NO_ERROR);
 
-	for (i = 0; i < padding_needed; i++)
-	{
-		// Add one char at a time from pad string
-		char c[2] = {pad[i % pad_len], '\0'};
-		afc_string_add(dest, c, ALL);
-	}
+	new_max = (max <= AFC_STRING_INTERNAL_BUILDER_LIMIT / 2) ? max * 2 : AFC_STRING_INTERNAL_BUILDER_LIMIT;
+	if (new_max < len + chars)
+		new_max = len + chars;
 
-	return dest;
+	if ((location = afc_realloc(sb->str - (sizeof(unsigned long) * 2), new_max + 1 + (sizeof(unsigned long) * 2))) == NULL)
+		return (AFC_ERR_NO_MEMORY);
+
+	location[0] = new_max + 1;
+	sb->str = (char *)(location + 2);
+
+	return (AFC_ERR_NO_ERROR);
 }
 // }}}
-
-// {{{ afc_string_slice ( dest, str, beginIndex, endIndex )
+// {{{ afc_string_builder_append ( sb, str, len )
 /*
-@node afc_string_slice
+@node afc_string_builder_append
 
-			NAME: afc_string_slice ( dest, str, beginIndex, endIndex ) - Extracts a section of a string
+			NAME: afc_string_builder_append ( sb, str, len ) - Appends a string to the builder
 
-	SYNOPSIS: char * afc_string_slice ( char * dest, const char * str, long beginIndex, long endIndex )
+	SYNOPSIS: int afc_string_builder_append ( afc_string_builder * sb, const char * str, unsigned long len )
+	   SINCE: 1.06
 
-		 DESCRIPTION: Extracts a section of a string and returns it as a new string (in dest), without modifying the original string.
+		 DESCRIPTION: Appends the first /len/ chars of /str/ to the builder text.
 
-		 INPUT: - dest				- The destination string.
-			- str 				- The source string.
-			- beginIndex 			- The zero-based index at which to begin extraction. If negative, it is treated as strLength + beginIndex.
-			- endIndex 			- The zero-based index before which to end extraction. The character at this index will not be included. If negative, it is treated as strLength + endIndex. To extract to the end of the string, pass a value >= string length (e.g. LONG_MAX).
+		 INPUT: - sb				- Pointer to a string builder.
+			- str				- The string to append. It does not need to be an AFC String.
+			- len				- Number of chars to append. Pass *ALL* to append the whole string.
 
-		RESULT: - The destination string.
+		RESULT: - AFC_ERR_NO_ERROR on success
+			- AFC_ERR_NO_MEMORY if the buffer cannot be grown. Nothing is appended.
 
-	SEE ALSO: - afc_string_mid()
+			NOTE: - With an explicit /len/, /str/ can contain '\0' chars: they are copied like the others.
+			- /str/ can point inside the builder text, to append a part of it again.
+
+	SEE ALSO: - afc_string_builder_append_char()
+		  - afc_string_builder_append_fmt()
 
 @endnode
 */
-char *afc_string_slice(char *dest, const char *str, long beginIndex, long endIndex)
+int afc_string_builder_append(afc_string_builder *sb, const char *str, unsigned long len)
 {
-	unsigned long len;
-	long start, end;
-
-	if (dest == NULL)
-		return NULL;
-
-	afc_string_clear(dest);
+	unsigned long old_len, offset;
+	BOOL inside;
+	int res;
 
-	if (str == NULL)
-		return dest;
+	if ((sb == NULL) || (str == NULL))
+		return (AFC_ERR_NULL_POINTER);
 
-	len = strlen(str);
-	start = beginIndex;
-	end = endIndex;
+	if ((long)len == ALL)
+		len = strlen(str);
 
-	// Handle negative start
-	if (start < 0)
-	{
-		start = len + start;
-	}
+	// str may be a part of the builder text: growing the buffer can move it
+	inside = (sb->str != NULL) && ((unsigned long)str >= (unsigned long)sb->str) && ((unsigned long)str <= (unsigned long)(sb->str + afc_string_max(sb->str)));
+	offset = inside ? (unsigned long)(str - sb->str) : 0;
 
-	// Clamp start
-	if (start < 0)
-		start = 0;
-	if (start >= (long)len)
-		return dest; // Empty
+	if ((res = afc_string_builder_reserve(sb, len)) != AFC_ERR_NO_ERROR)
+		return (res);
 
-	// Handle negative end
-	if (end < 0)
-	{
-		end = len + end;
-	}
+	old_len = afc_string_len(sb->str);
 
-	// Clamp end
-	if (end > (long)len)
-		end = len;
-	if (end < 0)
-		end = 0;
+	if (inside)
+		str = sb->str + offset;
 
-	if (end <= start)
-		return dest; // Empty
+	memmove(sb->str + old_len, str, len);
+	sb->str[old_len + len] = '\0';
+	*((unsigned long *)(sb->str - sizeof(unsigned long))) = old_len + len;
 
-	return afc_string_copy(dest, str + start, end - start);
+	return (AFC_ERR_NO_ERROR);
 }
 // }}}
-
-// {{{ afc_string_index_of ( str, search, fromIndex )
+// {{{ afc_string_builder_append_char ( sb, ch )
 /*
-@node afc_string_index_of
+@node afc_string_builder_append_char
 
-			NAME: afc_string_index_of ( str, search, fromIndex ) - Returns the index of the first occurrence of the specified value
+			NAME: afc_string_builder_append_char ( sb, ch ) - Appends a single char to the builder
 
-	SYNOPSIS: long afc_string_index_of ( const char * str, const char * search, long fromIndex )
+	SYNOPSIS: int afc_string_builder_append_char ( afc_string_builder * sb, char ch )
+	   SINCE: 1.06
 
-		 DESCRIPTION: Returns the index of the first occurrence of the specified value, or -1 if not found.
+		 DESCRIPTION: Appends the char /ch/ to the builder text.
 
-		 INPUT: - str				- The string to search in.
-			- search 			- The string to search for.
-			- fromIndex 			- The index to start the search from.
+		 INPUT: - sb				- Pointer to a string builder.
+			- ch				- The char to append.
 
-		RESULT: - The index of the first occurrence, or -1 if not found.
+		RESULT: - AFC_ERR_NO_ERROR on success
+			- AFC_ERR_NO_MEMORY if the buffer cannot be grown.
 
-	SEE ALSO: - afc_string_last_index_of()
+	SEE ALSO: - afc_string_builder_append()
 
 @endnode
 */
-long afc_string_index_of(const char *str, const char *search, long fromIndex)
+int afc_string_builder_append_char(afc_string_builder *sb, char ch)
 {
-	long len;
-	char *p;
-
-	if (str == NULL || search == NULL)
-		return -1;
-
-	len = afc_string_len(str);
+	unsigned long len;
+	int res;
 
-	if (fromIndex < 0)
-		fromIndex = 0;
+	if (sb == NULL)
+		return (AFC_ERR_NULL_POINTER);
 
-	if (fromIndex >= len)
-		return -1;
+	if ((res = afc_string_builder_reserve(sb, 1)) != AFC_ERR_NO_ERROR)
+		return (res);
 
-	p = strstr(str + fromIndex, search);
+	len = afc_string_len(sb->str);
 
-	if (p)
-		return (long)(p - str);
+	sb->str[len] = ch;
+	sb->str[len + 1] = '\0';
+	*((unsigned long *)(sb->str - sizeof(unsigned long))) = len + 1;
 
-	return -1;
+	return (AFC_ERR_NO_ERROR);
 }
 // }}}
-
-// {{{ afc_string_last_index_of ( str, search, fromIndex )
+// {{{ afc_string_builder_append_fmt ( sb, fmt, ... )
 /*
-@node afc_string_last_index_of
+@node afc_string_builder_append_fmt
 
-			NAME: afc_string_last_index_of ( str, search, fromIndex ) - Returns the index of the last occurrence of the specified value
+			NAME: afc_string_builder_append_fmt ( sb, fmt, ... ) - Appends formatted text to the builder
 
-	SYNOPSIS: long afc_string_last_index_of ( const char * str, const char * search, long fromIndex )
+	SYNOPSIS: int afc_string_builder_append_fmt ( afc_string_builder * sb, const char * fmt, ... )
+	   SINCE: 1.06
 
-		 DESCRIPTION: Returns the index of the last occurrence of the specified value, searching backwards from fromIndex.
+		 DESCRIPTION: Appends to the builder text the string created by /fmt/ and the following
+				arguments, with the same syntax as printf(). The text is written directly in the
+				builder buffer: no temporary string is needed.
 
-		 INPUT: - str				- The string to search in.
-			- search 			- The string to search for.
-			- fromIndex 			- The index to start the search backwards from.
+		 INPUT: - sb				- Pointer to a string builder.
+			- fmt				- The printf() like format string.
+			- ...				- The values for /fmt/.
 
-		RESULT: - The index of the last occurrence, or -1 if not found.
+		RESULT: - AFC_ERR_NO_ERROR on success
+			- AFC_ERR_NO_MEMORY if the buffer cannot be grown. Nothing is appended.
 
-	SEE ALSO: - afc_string_index_of()
+			NOTE: - The values must not point inside the builder text: use afc_string_builder_append() for that.
+
+	SEE ALSO: - afc_string_builder_append()
+		  - afc_string_make()
 
 @endnode
 */
-long afc_string_last_index_of(const char *str, const char *search, long fromIndex)
+int afc_string_builder_append_fmt(afc_string_builder *sb, const char *fmt, ...)
 {
-	long len, search_len, i;
+	unsigned long len, room;
+	va_list ap;
+	int res, n;
 
-	if (str == NULL || search == NULL)
-		return -1;
+	if ((sb == NULL) || (fmt == NULL))
+		return (AFC_ERR_NULL_POINTER);
 
-	len = afc_string_len(str);
-	search_len = strlen(search);
+	if ((res = afc_string_builder_reserve(sb, 1)) != AFC_ERR_NO_ERROR)
+		return (res);
 
-	if (search_len == 0)
-		return (fromIndex >= len) ? len : fromIndex;
+	len = afc_string_len(sb->str);
+	room = afc_string_max(sb->str) - len;
 
-	if (fromIndex < 0)
-		return -1; // JS behavior: if fromIndex < 0, treated as 0, but since we search backwards from 0, only match at 0 is possible if searchLen is 0, else -1. Actually JS treats negative as 0.
+	va_start(ap, fmt);
+	n = vsnprintf(sb->str + len, room + 1, fmt, ap); // Flawfinder: ignore
+	va_end(ap);
 
-	if (fromIndex >= len)
-		fromIndex = len;
+	if ((n >= 0) && ((unsigned long)n > room))
+	{
+		// The text did not fit: grow the buffer and write it again
+		if ((res = afc_string_builder_reserve(sb, n)) != AFC_ERR_NO_ERROR)
+		{
+			sb->str[len] = '\0';
+			return (res);
+		}
 
-	// Start searching from min(fromIndex, len - searchLen)
-	i = fromIndex;
-	if (i > len - (long)search_len)
-		i = len - (long)search_len;
+		va_start(ap, fmt);
+		n = vsnprintf(sb->str + len, n + 1, fmt, ap); // Flawfinder: ignore
+		va_end(ap);
+	}
 
-	for (; i >= 0; i--)
+	if (n < 0)
 	{
-		if (strncmp(str + i, search, search_len) == 0)
-			return i;
+		sb->str[len] = '\0';
+		return (AFC_ERR_NO_MEMORY);
 	}
 
-	return -1;
+	*((unsigned long *)(sb->str - sizeof(unsigned long))) = len + n;
+
+	return (AFC_ERR_NO_ERROR);
 }
 // }}}
-
-// {{{ afc_string_trim_start ( str )
+// {{{ afc_string_builder_clear ( sb )
 /*
-@node afc_string_trim_start
+@node afc_string_builder_clear
 
-			NAME: afc_string_trim_start ( str ) - Removes whitespace from the beginning of a string
+			NAME: afc_string_builder_clear ( sb ) - Empties the builder
 
-	SYNOPSIS: char * afc_string_trim_start ( char * str )
+	SYNOPSIS: void afc_string_builder_clear ( afc_string_builder * sb )
+	   SINCE: 1.06
 
-		 DESCRIPTION: Removes whitespace from the beginning of a string. Modifies the string in place.
+		 DESCRIPTION: Removes all the text from the builder, keeping its buffer, so that it can be used
+				again to build a new string.
 
-		 INPUT: - str				- The string to trim.
+		 INPUT: - sb				- Pointer to a string builder.
 
-		RESULT: - The trimmed string.
+		RESULT: NONE
 
-	SEE ALSO: - afc_string_trim_end()
+	SEE ALSO: - afc_string_builder_free()
 
 @endnode
 */
-char *afc_string_trim_start(char *str)
+void afc_string_builder_clear(afc_string_builder *sb)
 {
-	char *p;
-
-	if (str == NULL)
-		return NULL;
-
-	p = str;
-	while (isspace((unsigned char)*p))
-		p++;
-
-	if (p != str)
-	{
-		afc_string_copy(str, p, ALL);
-	}
+	if ((sb == NULL) || (sb->str == NULL))
+		return;
 
-	return str;
+	afc_string_clear(sb->str);
 }
 // }}}
-
-// {{{ afc_string_trim_end ( str )
+// {{{ afc_string_builder_finish ( sb )
 /*
-@node afc_string_trim_end
+@node afc_string_builder_finish
 
-			NAME: afc_string_trim_end ( str ) - Removes whitespace from the end of a string
+			NAME: afc_string_builder_finish ( sb ) - Returns the text built as an AFC String
 
-	SYNOPSIS: char * afc_string_trim_end ( char * str )
+	SYNOPSIS: char * afc_string_builder_finish ( afc_string_builder * sb )
+	   SINCE: 1.06
 
-		 DESCRIPTION: Removes whitespace from the end of a string. Modifies the string in place.
+		 DESCRIPTION: Returns the text collected by the builder as an AFC String. The buffer is handed
+				over to the caller, and not copied: the builder is left empty, and must be initialized
+				again before using it.
 
-		 INPUT: - str				- The string to trim.
+		 INPUT: - sb				- Pointer to a string builder.
 
-		RESULT: - The trimmed string.
+		RESULT: - an AFC String that must be freed with afc_string_delete().
+			- NULL in case of errors.
 
-	SEE ALSO: - afc_string_trim_start()
+			NOTE: - The string max size may be bigger than its length.
+
+	SEE ALSO: - afc_string_builder_init()
 
 @endnode
 */
-char *afc_string_trim_end(char *str)
+char *afc_string_builder_finish(afc_string_builder *sb)
 {
-	long len;
-	char *p;
-
-	if (str == NULL)
-		return NULL;
+	char *str;
 
-	len = afc_string_len(str);
-	if (len == 0)
-		return str;
+	if (sb == NULL)
+		return (NULL);
 
-	p = str + len - 1;
-	while (p >= str && isspace((unsigned char)*p))
-		p--;
+	if ((sb->str == NULL) && (afc_string_builder_init(sb, 0) != AFC_ERR_NO_ERROR))
+		return (NULL);
 
-	*(p + 1) = '\0';
-	afc_string_reset_len(str);
+	str = sb->str;
+	sb->str = NULL;
 
-	return str;
+	return (str);
 }
 // }}}
-
-// {{{ afc_string_from_char_code ( code )
+// {{{ afc_string_builder_free ( sb )
 /*
-@node afc_string_from_char_code
+@node afc_string_builder_free
 
-			NAME: afc_string_from_char_code ( code ) - Returns a string created from the specified UTF-16 code unit
+			NAME: afc_string_builder_free ( sb ) - Frees the builder buffer
 
-	SYNOPSIS: char * afc_string_from_char_code ( int code )
+	SYNOPSIS: void afc_string_builder_free ( afc_string_builder * sb )
+	   SINCE: 1.06
 
-		 DESCRIPTION: Returns a string created from the specified char code.
+		 DESCRIPTION: Frees the text collected by the builder. Use it when the text is not needed
+				anymore, instead of afc_string_builder_finish().
 
-		 INPUT: - code				- The char code.
+		 INPUT: - sb				- Pointer to a string builder.
 
-		RESULT: - A new AFC string containing the character.
+		RESULT: NONE
 
-	SEE ALSO:
+	SEE ALSO: - afc_string_builder_finish()
 
 @endnode
 */
-char *afc_string_from_char_code(int code)
+void afc_string_builder_free(afc_string_builder *sb)
 {
-	char *s = afc_string_new(1);
-	if (s)
-	{
-		s[0] = (char)code;
-		s[1] = '\0';
-		afc_string_reset_len(s);
-	}
-	return s;
+	if (sb == NULL)
+		return;
+
+	afc_string_delete(sb->str);
 }
 // }}}
 
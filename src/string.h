@@ -49,6 +49,24 @@ extern "C"
 
 #define ALL (~0L)
 
+  /* A part of a string: it does not own the chars, that are not NUL terminated */
+  typedef struct afc_strview
+  {
+    const char *str;
+    unsigned long len;
+  } afc_strview;
+
+#define AFC_STRING_BUILDER_DEFAULT_SIZE 256
+
+/* Size of the buffers passed to afc_string_format_int() and friends */
+#define AFC_STRING_NUMBER_SIZE 32
+
+  /* Collects text in an AFC String that grows as needed */
+  typedef struct afc_string_builder
+  {
+    char *str;
+  } afc_string_builder;
+
 /* Defined for afc_string_hash() */
 #define afc_tools_internal_mix(a, b, c) \
   {                                     \
@@ -89,6 +107,7 @@ extern "C"
   }
 #define afc_string_new(size) _afc_string_new(size, __FILE__, __FUNCTION__, __LINE__)
 #define afc_string_dup(str) _afc_string_dup(str, __FILE__, __FUNCTION__, __LINE__)
+#define afc_string_dup_view(view) _afc_string_dup_view(view, __FILE__, __FUNCTION__, __LINE__)
 
 /* JS-like String API macros */
 #define afc_string_includes(str, match, pos) (afc_string_instr(str, match, pos) != NULL)
@@ -104,6 +123,7 @@ extern "C"
   char *afc_string_mid(char *dest, const char *src, unsigned long fromchar, unsigned long numchars);
   // #define afc_string_comp(s1,s2,chars)  strncmp ( s1, s2, chars )
   signed long afc_string_comp(const char *s1, const char *s2, long chars);
+  signed long afc_string_casecomp(const char *s1, const char *s2, long chars);
   char *afc_string_upper(char *str);
   char *afc_string_lower(char *s);
   char *afc_string_trim(char *s);
@@ -113,7 +133,17 @@ extern "C"
   unsigned long afc_string_reset_len(const char *str);
   int afc_string_pattern_match(const char *str, const char *pattern, short nocase);
   int afc_string_radix(char *dest, long n, int radix);
+  int afc_string_format_int(char *buf, long long n);
+  int afc_string_format_uint(char *buf, unsigned long long n);
+  int afc_string_format_double(char *buf, double n);
+  char *afc_string_append_int(char *dest, long long n);
+  char *afc_string_append_uint(char *dest, unsigned long long n);
+  char *afc_string_append_double(char *dest, double n);
+  unsigned long afc_string_parse_int(const char *str, unsigned long len, long long *value);
+  unsigned long afc_string_parse_double(const char *str, unsigned long len, double *value);
   unsigned long int afc_string_hash(register const unsigned char *k, register unsigned long int turbolence);
+  unsigned long long afc_string_hash64(const void *data, unsigned long len, unsigned long long seed);
+  unsigned long long afc_string_hash_seed(void);
   char *_afc_string_dup(const char *str, const char *file, const char *func, const unsigned int line);
   char *afc_string_make(char *dest, const char *fmt, ...);
   char *afc_string_fget(char *dest, FILE *fh);
@@ -125,6 +155,13 @@ extern "C"
   char *afc_string_dirname(const char *path);
   char *afc_string_basename(const char *path);
   char *afc_string_utf8_to_latin1(const char *utf8);
+  char *afc_string_latin1_to_utf8(const char *latin1);
+  int afc_utf8_validate(const char *str, unsigned long len, unsigned long *error_pos);
+  unsigned long afc_utf8_count(const char *str, unsigned long len);
+  long afc_utf8_to_latin1(char *dest, const char *str, unsigned long len);
+  long afc_latin1_to_utf8(char *dest, const char *str, unsigned long len);
+  long afc_utf8_to_utf16(unsigned short *dest, const char *str, unsigned long len);
+  long afc_utf16_to_utf8(char *dest, const unsigned short *str, unsigned long len);
 
   /* New JS-like String API functions */
   char afc_string_char_at(const char *str, long index);
@@ -133,6 +170,9 @@ extern "C"
   char *afc_string_repeat(char *dest, const char *str, unsigned long count);
   char *afc_string_replace(char *dest, const char *str, const char *pattern, const char *replacement);
   char *afc_string_replace_all(char *dest, const char *str, const char *pattern, const char *replacement);
+  char *afc_string_replace_multi(char *dest, const char *str, const char **patterns, const char **replacements, int count);
+  char *afc_string_resize_replace_all(char **dest, const char *str, const char *pattern, const char *replacement);
+  char *afc_string_resize_replace_multi(char **dest, const char *str, const char **patterns, const char **replacements, int count);
   char *afc_string_pad_start(char *dest, const char *str, unsigned long targetLength, const char *padString);
   char *afc_string_pad_end(char *dest, const char *str, unsigned long targetLength, const char *padString);
   char *afc_string_slice(char *dest, const char *str, long beginIndex, long endIndex);
@@ -142,6 +182,28 @@ extern "C"
   char *afc_string_trim_end(char *str);
   char *afc_string_from_char_code(int code);
 
+  /* String views */
+  afc_strview afc_string_view(const char *str);
+  afc_strview afc_strview_make(const char *str, unsigned long len);
+  afc_strview afc_strview_mid(afc_strview view, unsigned long from, unsigned long num_chars);
+  afc_strview afc_strview_trim(afc_strview view);
+  long afc_strview_index_of(afc_strview view, char ch);
+  signed long afc_strview_comp(afc_strview view1, afc_strview view2);
+  int afc_strview_equals(afc_strview view, const char *str);
+  int afc_strview_token(afc_strview *rest, const char *delimiters, char escape_char, afc_strview *token);
+  char *afc_string_copy_view(char *dest, afc_strview view);
+  char *afc_string_add_view(char *dest, afc_strview view);
+  char *_afc_string_dup_view(afc_strview view, const char *file, const char *func, const unsigned int line);
+
+  int afc_string_builder_init(afc_string_builder *sb, unsigned long size);
+  int afc_string_builder_reserve(afc_string_builder *sb, unsigned long chars);
+  int afc_string_builder_append(afc_string_builder *sb, const char *str, unsigned long len);
+  int afc_string_builder_append_char(afc_string_builder *sb, char ch);
+  int afc_string_builder_append_fmt(afc_string_builder *sb, const char *fmt, ...);
+  void afc_string_builder_clear(afc_string_builder *sb);
+  char *afc_string_builder_finish(afc_string_builder *sb);
+  void afc_string_builder_free(afc_string_builder *sb);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
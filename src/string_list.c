@@ -21,7 +21,7 @@
 /*
 @config
 	TITLE:     StringList
-	VERSION:   1.10
+	VERSION:   1.41
 	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
 	AUTHOR:    Massimo Tantignone - tanti@intercon.it
 @endnode
@@ -36,6 +36,32 @@ static long afc_string_list_internal_sort_nocase_noinv(void *a, void *b, void *i
 static long afc_string_list_internal_sort_case_noinv(void *a, void *b, void *info);
 static long afc_string_list_internal_sort_nocase_inv(void *a, void *b, void *info);
 static long afc_string_list_internal_sort_case_inv(void *a, void *b, void *info);
+static void afc_string_list_internal_radix_sort(char **strs, unsigned long long *keys, size_t num, size_t depth, const unsigned char *fold);
+static void afc_string_list_internal_radix_load(char **strs, unsigned long long *keys, size_t num, size_t depth, const unsigned char *fold);
+static void afc_string_list_internal_radix_slice(void *base, size_t num, void *info);
+static int afc_string_list_internal_radix_comp(const void *a, const void *b, void *info);
+
+/* Lists of at most this many strings are sorted with an insertion sort by the multikey quicksort */
+#define AFC_STRING_LIST_INTERNAL_RADIX_RUN 16
+
+/* Swaps two strings, and their keys, in the multikey quicksort */
+#define afc_string_list_internal_radix_swap(strs, keys, i, j) \
+	{                                                         \
+		char *_s = (strs)[i];                                 \
+		unsigned long long _k = (keys)[i];                    \
+		(strs)[i] = (strs)[j];                                \
+		(keys)[i] = (keys)[j];                                \
+		(strs)[j] = _s;                                       \
+		(keys)[j] = _k;                                       \
+	}
+
+struct afc_string_list_internal_radix_info
+{
+	unsigned char fold[256];  // Every char is sorted as fold [ char ]
+	char **strs;			  // Strings to sort
+	unsigned long long *keys; // Keys of the strings, see afc_string_list_internal_radix_sort()
+};
+static char *afc_string_list_internal_add(StringList *sn, afc_strview view, unsigned long mode);
 
 // {{{ docs
 /*
@@ -55,6 +81,14 @@ afc_string_new() for more info about AFC Strings.
 @endnode
 
 @node history
+	- 1.41	- afc_string_list_sort () and afc_string_list_clone () work on unrolled lists (see afc_list_set_unrolled ())
+	- 1.40	- afc_string_list_sort () uses a multikey quicksort on the chars of the strings, split among many threads
+			  for big lists, and sorts the list even if it was already sorted.
+	- 1.31	- Case insensitive sorts and afc_string_list_search () use afc_string_casecomp () and do not allocate memory.
+			  Fixed the case sensitive and insensitive sorts, that were swapped.
+	- 1.30	- Added afc_string_list_add_view () and afc_string_list_find_view () functions.
+			  afc_string_list_split () no longer copies the source string
+	- 1.20	- Added afc_string_list_set_arena () function
 	- 1.10	- Added afc_string_list_before_first () function
 @endnode
 */
@@ -169,25 +203,45 @@ int _afc_string_list_delete(StringList *sn)
 */
 char *afc_string_list_add(StringList *sn, const char *s, unsigned long mode)
 {
-	char *g;
-
-	if ((s != NULL) && (strlen(s) == 0) && (sn->discard_zero_len))
+	if ((s != NULL) && (s[0] == '\0') && (sn->discard_zero_len))
 		return (NULL);
 
 	// printf ( "Add: %s - Len: %d\n", s, strlen ( s ) );
 
-	if ((s != NULL) && (strlen(s)))
-		g = afc_string_dup(s);
-	else
-		g = afc_string_new(1);
+	return (afc_string_list_internal_add(sn, afc_strview_make(s, ALL), mode));
+}
+// }}}
+// {{{ afc_string_list_add_view ( sn, view, mode )
+/*
+@node afc_string_list_add_view
 
-	if (g == NULL)
-	{
-		AFC_LOG_FAST(AFC_ERR_NO_MEMORY);
+		 NAME: afc_string_list_add_view (sn, view, mode) - Adds the chars of a string view to the StringList
+
+			 SYNOPSIS: char * afc_string_list_add_view ( StringList * sn, afc_strview view, unsigned long mode )
+
+			SINCE: 1.30
+
+		DESCRIPTION: this function works like afc_string_list_add(), but the string is given as an afc_strview, so
+				   a part of a bigger buffer can be added without copying it in a temporary string first.
+
+		INPUT: - sn		 - an handler to an already allocated StringList structure.
+		 - view		- the chars you wish to add.
+		 - mode	 - Where the new string will be added to the list. See afc_string_list_add().
+
+	RESULTS: - a pointer to the real string if everything went fine.
+		 - NULL if there was no memory to add the string, or if the view is empty and
+		   AFC_STRING_LIST_TAG_DISCARD_ZERO_LEN is set.
+
+			 SEE ALSO: - afc_string_list_add()
+		 - afc_string_list_split()
+@endnode
+*/
+char *afc_string_list_add_view(StringList *sn, afc_strview view, unsigned long mode)
+{
+	if ((view.len == 0) && (sn->discard_zero_len))
 		return (NULL);
-	}
 
-	return ((char *)afc_list_add(sn->nm, g, mode));
+	return (afc_string_list_internal_add(sn, view, mode));
 }
 // }}}
 // {{{ afc_string_list_insert ( sn, str )
@@ -484,7 +538,8 @@ char *afc_string_list_del(StringList *sn)
 	{
 		if ((s = afc_list_obj(sn->nm)))
 		{
-			afc_string_delete(s);
+			if (sn->arena == NULL)
+				afc_string_delete(s);
 			s = (char *)afc_list_del(sn->nm);
 		}
 	}
@@ -574,12 +629,16 @@ int afc_string_list_clear(StringList *sn)
 	if (sn->magic != AFC_STRING_LIST_MAGIC)
 		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
 
-	s = (char *)afc_list_first(sn->nm);
-	while (s)
+	// Arena strings are not freed one by one
+	if (sn->arena == NULL)
 	{
-		afc_string_delete(s);
+		s = (char *)afc_list_first(sn->nm);
+		while (s)
+		{
+			afc_string_delete(s);
 
-		s = (char *)afc_list_next(sn->nm);
+			s = (char *)afc_list_next(sn->nm);
+		}
 	}
 
 	return (afc_list_clear(sn->nm));
@@ -672,11 +731,17 @@ int afc_string_list_change(StringList *sn, char *s)
 
 	if ((g = afc_list_obj(sn->nm)))
 	{
-		afc_string_delete(g);
+		if (sn->arena == NULL)
+			afc_string_delete(g);
 
 		len = strlen(s);
 
-		if ((g = afc_string_dup(s)) == NULL)
+		if (sn->arena)
+			g = afc_arena_string_dup(sn->arena, s);
+		else
+			g = afc_string_dup(s);
+
+		if (g == NULL)
 			return (AFC_LOG_FAST(AFC_ERR_NO_MEMORY));
 
 		if (afc_list_change(sn->nm, g) == NULL)
@@ -732,6 +797,8 @@ unsigned long afc_string_list_pos (StringList * sn)
 	RESULTS: - AFC_ERR_NO_ERROR if everything went fine.
 
 			NOTES: - This function may not be portable (it relies upon afc_string_pattern_match() )
+				   - If /str/ does not contain any pattern char, the strings are compared with afc_string_comp()
+					 or afc_string_casecomp(), that do not allocate any memory.
 
 			 SEE ALSO: - afc_list_sort()
 @endnode
@@ -739,6 +806,7 @@ unsigned long afc_string_list_pos (StringList * sn)
 char *afc_string_list_search(StringList *sn, char *str, short from_here, short nocase)
 {
 	char *s;
+	short pattern;
 
 	if (afc_list_is_empty(sn->nm))
 		return (NULL);
@@ -750,9 +818,12 @@ char *afc_string_list_search(StringList *sn, char *str, short from_here, short n
 	else
 		s = (char *)afc_list_obj(sn->nm);
 
+	// Plain strings are compared directly, without going through the pattern matcher
+	pattern = (strpbrk(str, "*?[\\") != NULL);
+
 	while (s)
 	{
-		if (afc_string_pattern_match(s, str, nocase) == 0)
+		if (pattern ? (afc_string_pattern_match(s, str, nocase) == 0) : ((nocase ? afc_string_casecomp(s, str, ALL) : afc_string_comp(s, str, ALL)) == 0))
 		{
 			afc_list_pop(sn->nm, FALSE);
 			return (s);
@@ -766,33 +837,142 @@ char *afc_string_list_search(StringList *sn, char *str, short from_here, short n
 // }}}
 #endif
 
+// {{{ afc_string_list_find_view ( sn, view, from_here )
+/*
+@node afc_string_list_find_view
+
+		 NAME: afc_string_list_find_view (sn, view, from_here) - Searches the list for a string equal to a view
+
+			 SYNOPSIS: char * afc_string_list_find_view (StringList * sn, afc_strview view, short from_here )
+
+			SINCE: 1.30
+
+		DESCRIPTION: this function searches the whole list (or part of it) for a string made exactly of the chars
+				   of /view/. Unlike afc_string_list_search(), no pattern matching is done: strings with a different
+				   length are skipped without looking at their chars.
+
+		INPUT: - sn			   - an handler to an already allocated StringList structure.
+		 - view      - the chars to look for.
+				   - from_here - Set it to TRUE if you want to start searching from the current position
+								 and not from the beginning of the list.
+
+	RESULTS: - the string found (that becomes the current item), or NULL if there is no such string.
+
+			 SEE ALSO: - afc_string_list_search()
+@endnode
+*/
+char *afc_string_list_find_view(StringList *sn, afc_strview view, short from_here)
+{
+	char *s;
+
+	if (afc_list_is_empty(sn->nm))
+		return (NULL);
+
+	afc_list_push(sn->nm);
+
+	if (from_here == FALSE)
+		s = (char *)afc_list_first(sn->nm);
+	else
+		s = (char *)afc_list_obj(sn->nm);
+
+	while (s)
+	{
+		if ((afc_string_len(s) == view.len) && ((view.len == 0) || (memcmp(s, view.str, view.len) == 0)))
+		{
+			afc_list_pop(sn->nm, FALSE);
+			return (s);
+		}
+		s = (char *)afc_list_next(sn->nm);
+	}
+
+	afc_list_pop(sn->nm, TRUE);
+	return (NULL);
+}
+// }}}
+
 // {{{ afc_string_list_sort ( sn, nocase, inverted )
 /*
 @node afc_string_list_sort
 
-		 NAME: afc_string_list_sort (sn, nocase, inverted) - Sorts the strings in the list
+		 NAME: afc_string_list_sort (sn, nocase, inverted, fast) - Sorts the strings in the list
 
-			 SYNOPSIS: int afc_string_list_sort (StringList * sn, short	nocase, short	inverted)
+			 SYNOPSIS: int afc_string_list_sort (StringList * sn, short	nocase, short	inverted, short fast)
 
 		DESCRIPTION: this function sorts the strings in the list. You can specify some sorting methods,
 		 such like if you want the sort being case insensitive (nocase) or if you want the
 		 order from Z-A instead of A-Z (inverted).
 
+		 Strings are sorted with a multikey quicksort on 8 chars at a time: it looks at every char
+		 of the strings only a few times and it does not call any compare function. Big lists are split among
+		 many threads, see afc_parallel_sort_slices().
+
 		INPUT: - sn			 - an handler to an already allocated StringList structure.
 		 - nocase	 - If set to TRUE, the sort will be case insensitive.
 		 - inverted - If set to TRUE, the sort will be inverted: from Z to A and not A-Z.
-		 - fast		 - If set to TRUE, the fast sort routine in List will be used.
+		 - fast		 - If set to TRUE, the array rappresentation of the list is created too
+						 (see afc_list_create_array()).
 
 	RESULTS: - AFC_ERR_NO_ERROR if everything went fine.
 
+		NOTES: - Strings are sorted by the values of their bytes, like strcmp() does. With /nocase/,
+					 ASCII letters are sorted as lowercase, like afc_string_casecomp() does.
+
+		 - After a sort the current string is the first one.
+
 			 SEE ALSO: - afc_list_sort()
 @endnode
 */
 int afc_string_list_sort(StringList *sn, short nocase, short inverted, short fast)
 {
+	struct afc_string_list_internal_radix_info ri;
+	unsigned long long *keys;
+	char **mem, *s;
+	unsigned long t, num;
+	int c;
+
+	if (afc_list_is_empty(sn->nm))
+		return (AFC_ERR_NO_ERROR);
+
+	num = sn->nm->num;
+
+	// The strings follow their keys in the same memory block
+	if ((keys = (unsigned long long *)afc_malloc_uninit((sizeof(unsigned long long) + sizeof(char *)) * num)) != NULL)
+	{
+		mem = (char **)(keys + num);
+		ri.strs = mem;
+		ri.keys = keys;
+
+		// The cursor methods work on both List storages (nodes or chunks)
+		for (t = 0, s = afc_list_first(sn->nm); t < num; t++, s = afc_list_next(sn->nm))
+			mem[t] = s;
+
+		for (c = 0; c < 256; c++)
+			ri.fold[c] = (nocase && (c >= 'A') && (c <= 'Z')) ? (c | 0x20) : c;
+
+		if ((afc_parallel_sort_threads(num) < 2) || (afc_parallel_sort_slices(mem, num, sizeof(char *), afc_string_list_internal_radix_comp, afc_string_list_internal_radix_slice, &ri) != AFC_ERR_NO_ERROR))
+		{
+			afc_string_list_internal_radix_load(mem, keys, num, 0, ri.fold);
+			afc_string_list_internal_radix_sort(mem, keys, num, 0, ri.fold);
+		}
+
+		// Inverted sorts just write the strings back starting from the last one
+		for (t = 0, afc_list_first(sn->nm); t < num; t++, afc_list_next(sn->nm))
+			afc_list_change(sn->nm, mem[inverted ? num - 1 - t : t]);
 
-	// afc_list_free_array(nm);
+		afc_free(keys);
 
+		afc_list_clear_stack(sn->nm);
+		sn->nm->is_sorted = TRUE;
+
+		if (fast)
+			afc_list_create_array(sn->nm);
+
+		afc_list_first(sn->nm);
+
+		return (AFC_ERR_NO_ERROR);
+	}
+
+	// Not enough memory for the string pointers: List sorts the strings in place
 	if (nocase)
 	{
 		if (inverted)
@@ -867,6 +1047,9 @@ StringList *afc_string_list_clone(StringList *sn)
 	if (sn2 == NULL)
 		return (NULL);
 
+	if (sn->nm->unrolled)
+		afc_list_set_unrolled(sn2->nm, TRUE);
+
 	s = afc_string_list_first(sn);
 	while (s)
 	{
@@ -914,10 +1097,7 @@ StringList *afc_string_list_clone(StringList *sn)
 */
 int afc_string_list_split(StringList *sn, const char *string, const char *delimiters)
 {
-	char *base_string, *separators;
-	char *start_pos, *end_pos, *end_string;
-	char *x, *y, escape_char;
-	int t, num_delimiters;
+	afc_strview rest, token;
 
 	if (string == NULL)
 		return (AFC_LOG(AFC_LOG_WARNING, AFC_STRING_LIST_ERR_NULL_STRING, "Null string is invalid", NULL));
@@ -926,55 +1106,11 @@ int afc_string_list_split(StringList *sn, const char *string, const char *delimi
 
 	afc_string_list_clear(sn);
 
-	base_string = afc_string_dup(string);
-	separators = afc_string_dup(delimiters);
-
-	num_delimiters = afc_string_len(separators);
-
-	end_string = base_string + afc_string_len(base_string);
-	end_pos = base_string;
-
-	escape_char = sn->escape_char;
-
-	while (end_pos != end_string)
-	{
-		y = NULL;
-
-		start_pos = end_pos;
-
-		// Cycle all char delimiters defined
-		for (t = 0; t < num_delimiters; t++)
-		{
-			x = index(start_pos, separators[t]);
-
-			while (x != NULL)
-			{
-				if ((escape_char) && (x != base_string) && (x[-1] == escape_char))
-				{
-					x = index(x + 1, separators[t]);
-				}
-				else
-				{
-					if ((x < y) || (y == NULL))
-						y = x;
-					x = NULL;
-				}
-			}
-		}
+	// Tokens are views of /string/: only the strings stored in the list are allocated
+	rest = afc_strview_make(string, ALL);
 
-		if (y)
-		{
-			*y = 0;
-			end_pos = y + 1;
-		}
-		else
-			end_pos = end_string;
-
-		afc_string_list_add(sn, start_pos, AFC_STRING_LIST_ADD_TAIL);
-	}
-
-	afc_string_delete(base_string);
-	afc_string_delete(separators);
+	while (afc_strview_token(&rest, delimiters, sn->escape_char, &token))
+		afc_string_list_add_view(sn, token, AFC_STRING_LIST_ADD_TAIL);
 
 	return (AFC_ERR_NO_ERROR);
 }
@@ -1039,6 +1175,52 @@ int _afc_string_list_set_tags(StringList *sn, int first_tag, ...)
 // {{{ afc_string_list_before_first ( sn ) ************
 // int afc_string_list_before_first ( StringList * sn ) { return ( afc_list_before_first ( sn->nm ) ); }
 // }}}
+// {{{ afc_string_list_set_arena ( sn, arena )
+/*
+@node afc_string_list_set_arena
+
+		 NAME: afc_string_list_set_arena ( sn, arena ) - Binds the StringList to an Arena
+
+			 SYNOPSIS: int afc_string_list_set_arena ( StringList * sn, Arena * arena )
+
+		SINCE: 1.20
+
+		DESCRIPTION: Use this function to allocate the strings (and the list nodes) of the StringList from an Arena
+		 instead of the system heap. afc_string_list_clear() then does not need to free the strings one by one.
+
+		INPUT: - sn		 - an handler to an already allocated StringList structure.
+		 - arena	- Pointer to a valid Arena instance, or NULL to go back to the system heap.
+
+	RESULTS: - AFC_ERR_NO_ERROR on success.
+		 - AFC_STRING_LIST_ERR_NOT_EMPTY if the StringList contains some strings.
+
+		NOTES: - Clear (or delete) the StringList before resetting the Arena.
+		 - Strings of the StringList must never be freed by you (as usual).
+
+			 SEE ALSO: - afc_arena_new()
+		 - afc_list_set_arena()
+@endnode
+*/
+int afc_string_list_set_arena(StringList *sn, Arena *arena)
+{
+	int res;
+
+	if (sn == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (sn->magic != AFC_STRING_LIST_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (!afc_list_is_empty(sn->nm))
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_STRING_LIST_ERR_NOT_EMPTY, "Cannot change the Arena of a non empty StringList", NULL));
+
+	if ((res = afc_list_set_arena(sn->nm, arena)) != AFC_ERR_NO_ERROR)
+		return (res);
+
+	sn->arena = arena;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
 
 /* -------------------------------------------------------------------------------------------
 	 INTERNAL FUNCTIONS
@@ -1063,22 +1245,45 @@ static int afc_string_list_internal_set_tag(StringList *sn, int tag, void *val)
 	return (AFC_ERR_NO_ERROR);
 }
 // }}}
+// {{{ afc_string_list_internal_add ( sn, view, mode )
+static char *afc_string_list_internal_add(StringList *sn, afc_strview view, unsigned long mode)
+{
+	unsigned long len = view.len ? view.len : 1;
+	char *g;
+
+	// The new string is just long enough for the view chars
+	if (sn->arena)
+		g = afc_arena_string_new(sn->arena, len);
+	else
+		g = afc_string_new(len);
+
+	if (g == NULL)
+	{
+		AFC_LOG_FAST(AFC_ERR_NO_MEMORY);
+		return (NULL);
+	}
+
+	afc_string_copy_view(g, view);
+
+	return ((char *)afc_list_add(sn->nm, g, mode));
+}
+// }}}
 // {{{ afc_string_list_internal_sort_nocase_noinv ( a, b, info )
 static long afc_string_list_internal_sort_nocase_noinv(void *a, void *b, void *info)
 {
-	return (-afc_string_comp((char *)a, (char *)b, ALL));
+	return (-afc_string_casecomp((char *)a, (char *)b, ALL));
 }
 // }}}
 // {{{ afc_string_list_internal_sort_case_noinv ( a, b, info )
 static long afc_string_list_internal_sort_case_noinv(void *a, void *b, void *info)
 {
-	return (-strcasecmp((const char *)a, (const char *)b));
+	return (-afc_string_comp((char *)a, (char *)b, ALL));
 }
 // }}}
 // {{{ afc_string_list_internal_sort_nocase_inv ( a, b, info )
 static long afc_string_list_internal_sort_nocase_inv(void *a, void *b, void *info)
 {
-	return (afc_string_comp((char *)a, (char *)b, ALL));
+	return (afc_string_casecomp((char *)a, (char *)b, ALL));
 }
 // }}}
 // {{{ afc_string_list_internal_sort_case_inv ( a, b, info )
@@ -1088,6 +1293,203 @@ static long afc_string_list_internal_sort_case_inv(void *a, void *b, void *info)
 }
 // }}}
 
+// {{{ afc_string_list_internal_radix_sort ( strs, keys, num, depth, fold )
+/*
+   Multikey quicksort (Bentley and Sedgewick) on 8 chars at a time: keys [ n ] holds the chars of strs [ n ] from
+   /depth/, folded and packed in a number, so partitions read the keys array and not the strings. The strings are
+   split in three groups, lower, equal and higher than a pivot key, and the equal ones are sorted by their next 8
+   chars. All the strings share their first /depth/ chars. The biggest group is sorted by the loop, so the recursion
+   stays O(log num) deep.
+*/
+static void afc_string_list_internal_radix_sort(char **strs, unsigned long long *keys, size_t num, size_t depth, const unsigned char *fold)
+{
+	size_t lt, eq, gt, pa, pb, pc, pd, r, t, pivot;
+	unsigned long long v, k0, k1, k2;
+	const unsigned char *s1, *s2;
+
+	while (num > AFC_STRING_LIST_INTERNAL_RADIX_RUN)
+	{
+		// Median of three pivot, moved to the first place
+		k0 = keys[0];
+		k1 = keys[num / 2];
+		k2 = keys[num - 1];
+
+		if (k0 < k1)
+			pivot = (k1 < k2) ? num / 2 : ((k0 < k2) ? num - 1 : 0);
+		else
+			pivot = (k1 > k2) ? num / 2 : ((k0 < k2) ? 0 : num - 1);
+
+		afc_string_list_internal_radix_swap(strs, keys, 0, pivot);
+
+		v = keys[0];
+
+		// Equal strings are kept at both ends: [0, pa) and (pd, num)
+		pa = pb = 1;
+		pc = pd = num - 1;
+
+		for (;;)
+		{
+			while ((pb <= pc) && (keys[pb] <= v))
+			{
+				if (keys[pb] == v)
+				{
+					afc_string_list_internal_radix_swap(strs, keys, pa, pb);
+					pa++;
+				}
+				pb++;
+			}
+
+			while ((pb <= pc) && (keys[pc] >= v))
+			{
+				if (keys[pc] == v)
+				{
+					afc_string_list_internal_radix_swap(strs, keys, pc, pd);
+					pd--;
+				}
+				pc--;
+			}
+
+			if (pb > pc)
+				break;
+
+			afc_string_list_internal_radix_swap(strs, keys, pb, pc);
+			pb++;
+			pc--;
+		}
+
+		// Moves the equal strings from the ends to the middle
+		r = (pa < pb - pa) ? pa : pb - pa;
+		for (t = 0; t < r; t++)
+			afc_string_list_internal_radix_swap(strs, keys, t, pb - r + t);
+
+		r = (pd - pc < num - pd - 1) ? pd - pc : num - pd - 1;
+		for (t = 0; t < r; t++)
+			afc_string_list_internal_radix_swap(strs, keys, pb + t, num - r + t);
+
+		lt = pb - pa;
+		gt = pd - pc;
+
+		// If the strings end within the pivot key, the equal ones are all the same
+		eq = (v & 0xFF) ? num - lt - gt : 0;
+
+		if (eq > 1)
+			afc_string_list_internal_radix_load(strs + lt, keys + lt, eq, depth + 8, fold);
+
+		if ((lt >= eq) && (lt >= gt))
+		{
+			if (eq > 1)
+				afc_string_list_internal_radix_sort(strs + lt, keys + lt, eq, depth + 8, fold);
+			if (gt > 1)
+				afc_string_list_internal_radix_sort(strs + num - gt, keys + num - gt, gt, depth, fold);
+			num = lt;
+		}
+		else if (gt >= eq)
+		{
+			if (lt > 1)
+				afc_string_list_internal_radix_sort(strs, keys, lt, depth, fold);
+			if (eq > 1)
+				afc_string_list_internal_radix_sort(strs + lt, keys + lt, eq, depth + 8, fold);
+			strs += num - gt;
+			keys += num - gt;
+			num = gt;
+		}
+		else
+		{
+			if (lt > 1)
+				afc_string_list_internal_radix_sort(strs, keys, lt, depth, fold);
+			if (gt > 1)
+				afc_string_list_internal_radix_sort(strs + num - gt, keys + num - gt, gt, depth, fold);
+			strs += lt;
+			keys += lt;
+			num = eq;
+			depth += 8;
+		}
+	}
+
+	// Insertion sort of the few strings left: by their keys first, then by their chars after the keys
+	for (pa = 1; pa < num; pa++)
+	{
+		for (pb = pa; pb > 0; pb--)
+		{
+			if (keys[pb - 1] < keys[pb])
+				break;
+
+			if ((keys[pb - 1] == keys[pb]) && (keys[pb] & 0xFF))
+			{
+				s1 = (const unsigned char *)strs[pb - 1] + depth + 8;
+				s2 = (const unsigned char *)strs[pb] + depth + 8;
+
+				while ((fold[*s1] == fold[*s2]) && *s1)
+				{
+					s1++;
+					s2++;
+				}
+
+				if (fold[*s1] <= fold[*s2])
+					break;
+			}
+			else if (keys[pb - 1] == keys[pb])
+				break;
+
+			afc_string_list_internal_radix_swap(strs, keys, pb - 1, pb);
+		}
+	}
+}
+// }}}
+// {{{ afc_string_list_internal_radix_load ( strs, keys, num, depth, fold )
+/* Packs the 8 folded chars of every string from /depth/ in its key: chars after the end of the string are 0 */
+static void afc_string_list_internal_radix_load(char **strs, unsigned long long *keys, size_t num, size_t depth, const unsigned char *fold)
+{
+	const unsigned char *s;
+	unsigned long long key;
+	size_t t;
+	int c, i;
+
+	for (t = 0; t < num; t++)
+	{
+		s = (const unsigned char *)strs[t] + depth;
+		key = 0;
+
+		for (i = 0; i < 8; i++)
+		{
+			c = fold[*s];
+			key = (key << 8) | c;
+			if (c)
+				s++;
+		}
+
+		keys[t] = key;
+	}
+}
+// }}}
+// {{{ afc_string_list_internal_radix_slice ( base, num, info )
+static void afc_string_list_internal_radix_slice(void *base, size_t num, void *info)
+{
+	struct afc_string_list_internal_radix_info *ri = (struct afc_string_list_internal_radix_info *)info;
+	unsigned long long *keys = ri->keys + ((char **)base - ri->strs);
+
+	afc_string_list_internal_radix_load((char **)base, keys, num, 0, ri->fold);
+	afc_string_list_internal_radix_sort((char **)base, keys, num, 0, ri->fold);
+}
+// }}}
+// {{{ afc_string_list_internal_radix_comp ( a, b, info )
+/* Used by afc_parallel_sort_slices() to merge the sorted slices */
+static int afc_string_list_internal_radix_comp(const void *a, const void *b, void *info)
+{
+	const unsigned char *fold = ((struct afc_string_list_internal_radix_info *)info)->fold;
+	const unsigned char *s1 = *(const unsigned char *const *)a;
+	const unsigned char *s2 = *(const unsigned char *const *)b;
+
+	while ((fold[*s1] == fold[*s2]) && *s1)
+	{
+		s1++;
+		s2++;
+	}
+
+	return ((int)fold[*s1] - (int)fold[*s2]);
+}
+// }}}
+
 #ifdef TEST_CLASS
 // {{{ TEST_CLASS
 void dosort(struct afc_string_list *n)
@@ -64,7 +64,8 @@ extern "C"
 	{
 		AFC_STRING_LIST_ERR_CHANGE = AFC_STRING_LIST_BASE + 1,
 		AFC_STRING_LIST_ERR_NULL_STRING,
-		AFC_STRING_LIST_ERR_NULL_DELIMITERS
+		AFC_STRING_LIST_ERR_NULL_DELIMITERS,
+		AFC_STRING_LIST_ERR_NOT_EMPTY
 	};
 
 	enum
@@ -86,6 +87,7 @@ extern "C"
 
 		short discard_zero_len; // Flag T/F. If T StringList will not accept (using _add()) zero lenght strings
 		char escape_char;		// Escape character (used for the _split() method)
+		Arena *arena;			// If set, strings (and list nodes) are allocated from this Arena
 	};
 
 	typedef struct afc_string_list StringList;
@@ -101,6 +103,7 @@ extern "C"
 	StringList *_afc_string_list_new(const char *file, const char *func, const unsigned int line);
 	int _afc_string_list_delete(StringList *);
 	char *afc_string_list_add(StringList *, const char *, unsigned long);
+	char *afc_string_list_add_view(StringList *, afc_strview, unsigned long);
 #define afc_string_list_insert(sn, txt) afc_string_list_add(sn, txt, AFC_STRING_LIST_ADD_HERE)
 #define afc_string_list_obj(sn) (char *)(sn ? afc_list_obj(sn->nm) : NULL)
 #define afc_string_list_is_empty(sn) (BOOL) afc_list_is_empty(sn->nm)
@@ -129,10 +132,12 @@ extern "C"
 #ifndef MINGW
 	char *afc_string_list_search(StringList *, char *, short, short);
 #endif
+	char *afc_string_list_find_view(StringList *, afc_strview, short);
 	StringList *afc_string_list_clone(StringList *);
 	int afc_string_list_split(StringList *sn, const char *string, const char *delimiters);
 #define afc_string_list_set_tags(sn, first, ...) _afc_string_list_set_tags(sn, first, ##__VA_ARGS__, AFC_TAG_END)
 	int _afc_string_list_set_tags(StringList *sn, int first_tag, ...);
+	int afc_string_list_set_arena(StringList *sn, Arena *arena);
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,468 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "string_pool.h"
+
+// {{{ docs
+/*
+@config
+	TITLE:     StringPool
+	VERSION:   1.00
+	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
+@endnode
+
+@node quote
+	*There are only two hard things in Computer Science: cache invalidation and naming things.*
+
+		Phil Karlton
+@endnode
+
+@node history
+	- 1.00:		Initial Release
+@endnode
+
+@node intro
+StringPool keeps a single copy of every string it is given: interning the same chars twice returns the very same
+pointer, so interned strings can be compared just comparing their pointers, and many containers can share them
+without each one storing its own copy.
+
+Dictionaries can be bound to a StringPool with afc_dictionary_set_string_pool(): their keys are then interned in the
+pool instead of being copied in every entry. CGIManager and HttpClient use a pool for the keys of the dictionaries
+they fill on every request.
+
+Interned strings are AFC strings, so afc_string_len() works on them, but they belong to the pool: never change or
+free them. They are all released at once by afc_string_pool_clear() or afc_string_pool_delete(), and there is no
+way to remove a single string from the pool.
+
+To inizialize a new instance, simply call afc_string_pool_new(), and to destroy it, call the afc_string_pool_delete().
+@endnode
+*/
+// }}}
+
+static const char class_name[] = "StringPool";
+
+static int afc_string_pool_internal_grow(StringPool *pool);
+static char *afc_string_pool_internal_store(StringPool *pool, const char *str, unsigned long len, unsigned long long hash_value);
+static void afc_string_pool_internal_slabs_free(StringPool *pool);
+
+/* Size of the memory holding an interned string len chars long (with its header and NUL terminator) */
+#define afc_string_pool_internal_size(len) \
+	((sizeof(unsigned long long) + 2 * sizeof(unsigned long) + (len) + 1 + 7) & ~(unsigned long)7)
+
+// {{{ afc_string_pool_new ()
+/*
+@node afc_string_pool_new
+
+			 NAME: afc_string_pool_new ()    - Initializes a new StringPool instance.
+
+		 SYNOPSIS: StringPool * afc_string_pool_new ()
+
+	  DESCRIPTION: This function initializes a new, empty, StringPool instance.
+
+			INPUT: NONE
+
+		  RESULTS: a valid inizialized StringPool structure. NULL in case of errors.
+
+		 SEE ALSO: - afc_string_pool_delete()
+
+@endnode
+*/
+StringPool *afc_string_pool_new(void)
+{
+	TRY(StringPool *)
+
+	StringPool *pool = (StringPool *)afc_malloc(sizeof(StringPool));
+
+	if (pool == NULL)
+		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "pool", NULL);
+
+	pool->magic = AFC_STRING_POOL_MAGIC;
+	pool->seed = afc_string_hash_seed();
+
+	RETURN(pool);
+
+	EXCEPT
+	afc_string_pool_delete(pool);
+
+	FINALLY
+
+	ENDTRY
+}
+// }}}
+// {{{ afc_string_pool_delete ( pool )
+/*
+@node afc_string_pool_delete
+
+			 NAME: afc_string_pool_delete ( pool )  - Disposes a valid StringPool instance.
+
+		 SYNOPSIS: int afc_string_pool_delete ( StringPool * pool )
+
+	  DESCRIPTION: This function frees an already alloc'd StringPool structure and all the strings it holds.
+
+			INPUT: - pool  - Pointer to a valid StringPool instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+			NOTES: - this method calls: afc_string_pool_clear()
+				   - Dictionaries bound to this StringPool must be deleted before.
+
+		 SEE ALSO: - afc_string_pool_new()
+				   - afc_string_pool_clear()
+@endnode
+*/
+int _afc_string_pool_delete(StringPool *pool)
+{
+	int afc_res;
+
+	if ((afc_res = afc_string_pool_clear(pool)) != AFC_ERR_NO_ERROR)
+		return (afc_res);
+
+	if (pool->slots)
+		afc_free(pool->slots);
+
+	afc_free(pool);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_string_pool_clear ( pool )
+/*
+@node afc_string_pool_clear
+
+			 NAME: afc_string_pool_clear ( pool )  - Frees all the interned strings
+
+		 SYNOPSIS: int afc_string_pool_clear ( StringPool * pool )
+
+	  DESCRIPTION: This function frees all the strings of the pool at once. The index of the strings is kept, so
+				   that the pool can be filled again without growing it.
+
+			INPUT: - pool  - Pointer to a valid StringPool instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+			NOTES: - Dictionaries bound to this StringPool must be cleared before.
+
+		 SEE ALSO: - afc_string_pool_delete()
+@endnode
+*/
+int afc_string_pool_clear(StringPool *pool)
+{
+	if (pool == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (pool->magic != AFC_STRING_POOL_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	afc_string_pool_internal_slabs_free(pool);
+
+	if (pool->slots)
+		memset(pool->slots, 0, pool->num_slots * sizeof(struct afc_string_pool_slot));
+
+	pool->num_items = 0;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_string_pool_intern ( pool, str )
+/*
+@node afc_string_pool_intern
+
+			 NAME: afc_string_pool_intern ( pool, str )  - Returns the unique copy of a string
+
+		 SYNOPSIS: const char * afc_string_pool_intern ( StringPool * pool, const char * str )
+
+	  DESCRIPTION: This function returns the copy of /str/ held by the pool, adding it to the pool if it is not
+				   there yet. Interning two strings with the same chars always returns the same pointer.
+
+			INPUT: - pool  - Pointer to a valid StringPool instance.
+				   - str   - String to intern. It can be any C string.
+
+		  RESULTS: the interned string (an AFC String owned by the pool), or NULL in case of errors.
+
+			NOTES: - The hash value of the string is kept in the pool: afc_string_pool_hash() returns it at no cost.
+
+		 SEE ALSO: - afc_string_pool_intern_view()
+				   - afc_string_pool_find()
+@endnode
+*/
+const char *afc_string_pool_intern(StringPool *pool, const char *str)
+{
+	unsigned long len;
+
+	if ((pool == NULL) || (str == NULL))
+	{
+		AFC_LOG_FAST(AFC_ERR_NULL_POINTER);
+		return (NULL);
+	}
+
+	len = strlen(str);
+
+	return (afc_string_pool_intern_prehashed(pool, str, len, afc_string_hash64(str, len, pool->seed)));
+}
+// }}}
+// {{{ afc_string_pool_intern_view ( pool, view )
+/*
+@node afc_string_pool_intern_view
+
+			 NAME: afc_string_pool_intern_view ( pool, view )  - Returns the unique copy of a string view
+
+		 SYNOPSIS: const char * afc_string_pool_intern_view ( StringPool * pool, afc_strview view )
+
+	  DESCRIPTION: This function works just like afc_string_pool_intern(), but the chars are held in a string view:
+				   parsers can intern a word found in a bigger buffer without copying it first.
+
+			INPUT: - pool  - Pointer to a valid StringPool instance.
+				   - view  - View of the chars to intern.
+
+		  RESULTS: the interned string (an AFC String owned by the pool), or NULL in case of errors.
+
+		 SEE ALSO: - afc_string_pool_intern()
+@endnode
+*/
+const char *afc_string_pool_intern_view(StringPool *pool, afc_strview view)
+{
+	if ((pool == NULL) || ((view.str == NULL) && view.len))
+	{
+		AFC_LOG_FAST(AFC_ERR_NULL_POINTER);
+		return (NULL);
+	}
+
+	if (view.str == NULL)
+		view.str = "";
+
+	return (afc_string_pool_intern_prehashed(pool, view.str, view.len, afc_string_hash64(view.str, view.len, pool->seed)));
+}
+// }}}
+// {{{ afc_string_pool_intern_prehashed ( pool, str, len, hash_value )
+/*
+@node afc_string_pool_intern_prehashed
+
+			 NAME: afc_string_pool_intern_prehashed ( pool, str, len, hash_value )  - Interns a string with a known hash
+
+		 SYNOPSIS: const char * afc_string_pool_intern_prehashed ( StringPool * pool, const char * str, unsigned long len, unsigned long long hash_value )
+
+	  DESCRIPTION: This function works just like afc_string_pool_intern(), but the string is not hashed again: the
+				   hash_value you got from afc_string_pool_hash_key() is used instead.
+
+			INPUT: - pool  		- Pointer to a valid StringPool instance.
+				   - str   		- Chars to intern (they do not need to be NUL terminated).
+				   - len   		- Number of chars.
+				   - hash_value	- The value returned by afc_string_pool_hash_key ( pool, str, len ).
+
+		  RESULTS: the interned string (an AFC String owned by the pool), or NULL in case of errors.
+
+			NOTES: - Passing an hash_value that was not returned by afc_string_pool_hash_key() for the very same
+					 chars breaks the pool: the same string could be interned twice.
+
+		 SEE ALSO: - afc_string_pool_intern()
+@endnode
+*/
+const char *afc_string_pool_intern_prehashed(StringPool *pool, const char *str, unsigned long len, unsigned long long hash_value)
+{
+	struct afc_string_pool_slot *slot;
+	unsigned long mask, t;
+
+	if ((pool == NULL) || (str == NULL))
+	{
+		AFC_LOG_FAST(AFC_ERR_NULL_POINTER);
+		return (NULL);
+	}
+
+	// The table is kept at most 3/4 full, so a free slot always ends the probe sequence
+	if ((pool->num_items + 1) * 4 > pool->num_slots * 3)
+		if (afc_string_pool_internal_grow(pool) != AFC_ERR_NO_ERROR)
+			return (NULL);
+
+	mask = pool->num_slots - 1;
+
+	for (t = hash_value & mask;; t = (t + 1) & mask)
+	{
+		slot = &pool->slots[t];
+
+		if (slot->str == NULL)
+			break;
+
+		if ((slot->hash_value == hash_value) && (afc_string_len(slot->str) == len) && (memcmp(slot->str, str, len) == 0))
+			return (slot->str);
+	}
+
+	if ((slot->str = afc_string_pool_internal_store(pool, str, len, hash_value)) == NULL)
+		return (NULL);
+
+	slot->hash_value = hash_value;
+	pool->num_items++;
+
+	return (slot->str);
+}
+// }}}
+// {{{ afc_string_pool_find ( pool, str )
+/*
+@node afc_string_pool_find
+
+			 NAME: afc_string_pool_find ( pool, str )  - Looks for a string in the pool
+
+		 SYNOPSIS: const char * afc_string_pool_find ( StringPool * pool, const char * str )
+
+	  DESCRIPTION: This function returns the interned copy of /str/, without adding it to the pool.
+
+			INPUT: - pool  - Pointer to a valid StringPool instance.
+				   - str   - String to look for.
+
+		  RESULTS: the interned string, or NULL if /str/ has never been interned.
+
+		 SEE ALSO: - afc_string_pool_intern()
+@endnode
+*/
+const char *afc_string_pool_find(StringPool *pool, const char *str)
+{
+	struct afc_string_pool_slot *slot;
+	unsigned long long hash_value;
+	unsigned long len, mask, t;
+
+	if ((pool == NULL) || (str == NULL) || (pool->num_items == 0))
+		return (NULL);
+
+	len = strlen(str);
+	hash_value = afc_string_hash64(str, len, pool->seed);
+	mask = pool->num_slots - 1;
+
+	for (t = hash_value & mask; (slot = &pool->slots[t])->str != NULL; t = (t + 1) & mask)
+		if ((slot->hash_value == hash_value) && (afc_string_len(slot->str) == len) && (memcmp(slot->str, str, len) == 0))
+			return (slot->str);
+
+	return (NULL);
+}
+// }}}
+
+/* =====================================================================================
+	 INTERNAL FUNCTIONS
+===================================================================================== */
+// {{{ afc_string_pool_internal_grow ( pool )
+static int afc_string_pool_internal_grow(StringPool *pool)
+{
+	struct afc_string_pool_slot *slots, *old = pool->slots;
+	unsigned long num_slots = pool->num_slots ? pool->num_slots * 2 : 64, mask = num_slots - 1, t, h;
+
+	if ((slots = afc_malloc(num_slots * sizeof(struct afc_string_pool_slot))) == NULL)
+		return (AFC_LOG_FAST_INFO(AFC_ERR_NO_MEMORY, "slots"));
+
+	// Hash values are stored in the slots: strings are moved without hashing them again
+	for (t = 0; t < pool->num_slots; t++)
+	{
+		if (old[t].str == NULL)
+			continue;
+
+		for (h = old[t].hash_value & mask; slots[h].str != NULL; h = (h + 1) & mask)
+			;
+
+		slots[h] = old[t];
+	}
+
+	if (old)
+		afc_free(old);
+
+	pool->slots = slots;
+	pool->num_slots = num_slots;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_string_pool_internal_store ( pool, str, len, hash_value )
+static char *afc_string_pool_internal_store(StringPool *pool, const char *str, unsigned long len, unsigned long long hash_value)
+{
+	unsigned long size = afc_string_pool_internal_size(len), slab_size;
+	struct afc_string_pool_slab *slab;
+	unsigned long *location;
+	char *mem;
+
+	if (size > AFC_STRING_POOL_SLAB_MAX / 4)
+	{
+		// Big strings get a slab of their own, chained after the current one so that it stays in use
+		if ((slab = afc_malloc_uninit(sizeof(struct afc_string_pool_slab) + size)) == NULL)
+		{
+			AFC_LOG_FAST_INFO(AFC_ERR_NO_MEMORY, "string");
+			return (NULL);
+		}
+
+		slab->size = size;
+
+		if (pool->slab)
+		{
+			slab->next = pool->slab->next;
+			pool->slab->next = slab;
+		}
+		else
+		{
+			slab->next = NULL;
+			pool->slab = slab;
+			pool->slab_used = size;
+		}
+
+		mem = (char *)(slab + 1);
+	}
+	else
+	{
+		if ((pool->slab == NULL) || (pool->slab_used + size > pool->slab->size))
+		{
+			slab_size = (pool->slab == NULL) ? AFC_STRING_POOL_SLAB_MIN : pool->slab->size * 2;
+			if (slab_size > AFC_STRING_POOL_SLAB_MAX)
+				slab_size = AFC_STRING_POOL_SLAB_MAX;
+
+			if ((slab = afc_malloc_uninit(sizeof(struct afc_string_pool_slab) + slab_size)) == NULL)
+			{
+				AFC_LOG_FAST_INFO(AFC_ERR_NO_MEMORY, "slab");
+				return (NULL);
+			}
+
+			slab->size = slab_size;
+			slab->next = pool->slab;
+			pool->slab = slab;
+			pool->slab_used = 0;
+		}
+
+		mem = (char *)(pool->slab + 1) + pool->slab_used;
+		pool->slab_used += size;
+	}
+
+	// [ hash ] [ max ] [ len ] [ chars ... ]
+	*(unsigned long long *)mem = hash_value;
+	location = (unsigned long *)(mem + sizeof(unsigned long long));
+	location[0] = len + 1;
+	location[1] = len;
+
+	mem = (char *)(location + 2);
+	memcpy(mem, str, len);
+	mem[len] = '\0';
+
+	return (mem);
+}
+// }}}
+// {{{ afc_string_pool_internal_slabs_free ( pool )
+static void afc_string_pool_internal_slabs_free(StringPool *pool)
+{
+	struct afc_string_pool_slab *slab;
+
+	while ((slab = pool->slab) != NULL)
+	{
+		pool->slab = slab->next;
+		afc_free(slab);
+	}
+
+	pool->slab_used = 0;
+}
+// }}}
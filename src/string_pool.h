@@ -0,0 +1,100 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef AFC_STRING_POOL_H
+#define AFC_STRING_POOL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base.h"
+#include "exceptions.h"
+#include "string.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* AFC StringPool Magic Number: 'SPOL' */
+#define AFC_STRING_POOL_MAGIC ('S' << 24 | 'P' << 16 | 'O' << 8 | 'L')
+
+/* AFC StringPool Base value for constants */
+#define AFC_STRING_POOL_BASE 0xE300
+
+/* Strings are stored in slabs: the first one is AFC_STRING_POOL_SLAB_MIN bytes long, */
+/* every new slab doubles the size of the previous one up to AFC_STRING_POOL_SLAB_MAX bytes */
+#define AFC_STRING_POOL_SLAB_MIN 4096
+#define AFC_STRING_POOL_SLAB_MAX (256 * 1024)
+
+	/* Every interned string is an AFC String preceded by its hash value: [ hash ] [ max ] [ len ] [ chars ... ] */
+	struct afc_string_pool_slot
+	{
+		unsigned long long hash_value;
+		char *str; // NULL if the slot is free
+	};
+
+	struct afc_string_pool_slab
+	{
+		struct afc_string_pool_slab *next;
+		unsigned long size; // Usable bytes after this header
+	};
+
+	struct afc_string_pool
+	{
+		unsigned long magic;
+
+		unsigned long long seed; // Random seed for afc_string_hash64()
+
+		struct afc_string_pool_slot *slots; // Open addressing table of the interned strings
+		unsigned long num_slots;			// Always a power of 2
+		unsigned long num_items;			// Number of interned strings
+
+		struct afc_string_pool_slab *slab; // Current slab (older ones are chained after it)
+		unsigned long slab_used;		   // Bytes used in the current slab
+	};
+
+	typedef struct afc_string_pool StringPool;
+
+#define afc_string_pool_delete(pool)   \
+	if (pool)                          \
+	{                                  \
+		_afc_string_pool_delete(pool); \
+		pool = NULL;                   \
+	}
+
+	StringPool *afc_string_pool_new(void);
+	int _afc_string_pool_delete(StringPool *pool);
+	int afc_string_pool_clear(StringPool *pool);
+	const char *afc_string_pool_intern(StringPool *pool, const char *str);
+	const char *afc_string_pool_intern_view(StringPool *pool, afc_strview view);
+	const char *afc_string_pool_intern_prehashed(StringPool *pool, const char *str, unsigned long len, unsigned long long hash_value);
+	const char *afc_string_pool_find(StringPool *pool, const char *str);
+
+#define afc_string_pool_len(pool) ((pool) ? (pool)->num_items : 0)
+#define afc_string_pool_hash_key(pool, str, len) afc_string_hash64(str, len, (pool)->seed)
+
+/* Hash value of a string returned by afc_string_pool_intern(): it is read from the string header */
+#define afc_string_pool_hash(str) (*(const unsigned long long *)((str) - 2 * sizeof(unsigned long) - sizeof(unsigned long long)))
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -24,7 +24,7 @@
 /*
 @config
 	TITLE:     Threader
-	VERSION:   1.00
+	VERSION:   1.01
 	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
 @endnode
 
@@ -34,6 +34,11 @@
 		Groucho Marx
 @endnode
 
+@node history
+	- 1.01:		Scratch strings are taken from afc_tmp_string() (thread safe)
+	- 1.00:		Initial Release
+@endnode
+
 @node intro
 Threader is a class based upon <classname>pthread</classname> aimed to ease the creation of
 multi threaded applications under Linux. It is not to be considered a full replacement or interface
@@ -245,8 +250,8 @@ int afc_threader_add(Threader *th, const char *name, ThreaderFunc func, void *in
 	// Create the thread
 	if ((ret = pthread_create(&td->thread, NULL, func, td)) != 0)
 	{
-		afc_string_make(__internal_afc_base->tmp_string, "%d", ret);
-		return (AFC_LOG(AFC_LOG_ERROR, AFC_THREADER_ERR_CREATE_THREAD, "pthread_create failed", __internal_afc_base->tmp_string));
+		afc_string_make(afc_tmp_string(), "%d", ret);
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_THREADER_ERR_CREATE_THREAD, "pthread_create failed", afc_tmp_string()));
 	}
 
 	// Add the thread to the internal Dictionary
@@ -81,14 +81,19 @@ static TreeNode *afc_tree_int_node_delete(TreeNode *n)
 
 	if (tree->freenode)
 		tree->freenode(n->val);
-	afc_free(n);
+	afc_pool_free(n, sizeof(TreeNode));
 
 	return (next);
 }
 
 static TreeNode *afc_tree_int_node_new(Tree *tree, void *val)
 {
-	TreeNode *n = afc_malloc(sizeof(TreeNode));
+	TreeNode *n = afc_pool_alloc(sizeof(TreeNode));
+
+	if (n == NULL)
+		return (NULL);
+
+	memset(n, 0, sizeof(TreeNode));
 	n->tree = tree;
 	n->val = val;
 	return n;
@@ -150,15 +155,21 @@ int _afc_tree_delete(Tree *t)
 
 int afc_tree_clear(Tree *tree)
 {
-	TreeNode *current_node;
+	TreeNode *current_node, *next;
 
 	if (tree == NULL)
 		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
 	if (tree->magic != AFC_TREE_MAGIC)
 		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
 
-	for (current_node = tree->first; current_node != NULL; current_node = afc_tree_int_node_delete(current_node))
-		;
+	// All the nodes go away: no need to unlink them (their parents may be already freed)
+	for (current_node = tree->first; current_node != NULL; current_node = next)
+	{
+		next = current_node->list_next;
+		if (tree->freenode)
+			tree->freenode(current_node->val);
+		afc_pool_free(current_node, sizeof(TreeNode));
+	}
 
 	tree->first = NULL;
 	tree->last = NULL;
@@ -255,13 +266,17 @@ int afc_tree_node_preorder_visit(TreeNode *parent, int (*visitor)(TreeNode *))
 
 int afc_tree_node_postorder_visit(TreeNode *parent, int (*visitor)(TreeNode *))
 {
-	TreeNode *curr_node;
+	TreeNode *curr_node, *next;
 
 	if (!parent)
 		return AFC_ERR_INVALID_POINTER;
 
-	for (curr_node = parent->child; curr_node != NULL; curr_node = curr_node->r_sibling)
+	// The visitor may free the node (see _afc_subtree_delete()): get the sibling first
+	for (curr_node = parent->child; curr_node != NULL; curr_node = next)
+	{
+		next = curr_node->r_sibling;
 		afc_tree_node_postorder_visit(curr_node, visitor);
+	}
 
 	visitor(parent);
 
@@ -23,6 +23,7 @@
 
 #include "base.h"
 #include "exceptions.h"
+#include "pool.h"
 
 /* AFC Tree Magic Number */
 #define AFC_TREE_MAGIC ('T' << 24 | 'R' << 16 | 'E' << 8 | 'E')
@@ -0,0 +1,659 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "vec.h"
+
+// {{{ docs
+/*
+@config
+	TITLE:     Vec
+	VERSION:   1.01
+	AUTHOR:    Fabio Rotondo - fabio@rotondo.it
+@endnode
+
+@node quote
+	*Data dominates. If you've chosen the right data structures and organized things well, the algorithms will almost*
+	*always be self-evident.*
+
+		Rob Pike
+@endnode
+
+@node history
+	- 1.01:		afc_vec_push() and afc_vec_insert() accept items of the same Vec
+	- 1.00:		Initial Release
+@endnode
+
+@node intro
+Vec is an array of values, all of the same size, stored one after the other in a single memory block: ints,
+doubles or small structs. An Array only stores pointers, so each value needs its own allocation and reading it
+means following a pointer; a Vec stores the values themselves, which is much faster to fill and to scan.
+
+To inizialize a new instance, call afc_vec_new() with the size of the items (for example, sizeof ( double )), and to
+destroy it, call the afc_vec_delete(). Items are added with afc_vec_push() and afc_vec_insert(), removed with
+afc_vec_pop() and afc_vec_erase(). afc_vec_item() returns a pointer to an item, while the afc_vec_at() and
+afc_vec_data() macros give typed access to them:
+
+	Vec * v = afc_vec_new ( sizeof ( double ) );
+	double d = 1.5;
+
+	afc_vec_push ( v, &d );
+	afc_vec_at ( v, double, 0 ) *= 2;
+
+Items are copied in and out of the Vec byte by byte, and pointers to them are valid only until the Vec grows: any
+function adding items may move them to a bigger memory block. afc_vec_push() and afc_vec_insert() take care of
+items of the Vec itself passed to them.
+@endnode
+*/
+// }}}
+
+static const char class_name[] = "Vec";
+
+static int afc_vec_internal_grow(Vec *vec, unsigned long num_items);
+
+#define afc_vec_internal_item(vec, pos) ((vec)->mem + (size_t)(pos) * (vec)->item_size)
+
+/* TRUE if ptr points to one of the items of the Vec */
+#define afc_vec_internal_inside(vec, ptr) (((ptr) != NULL) && ((vec)->mem != NULL) && ((size_t)(ptr) >= (size_t)(vec)->mem) && ((size_t)(ptr) < (size_t)afc_vec_internal_item(vec, (vec)->num_items)))
+
+// {{{ afc_vec_new ( item_size )
+/*
+@node afc_vec_new
+
+			 NAME: afc_vec_new ( item_size )    - Initializes a new Vec instance.
+
+		 SYNOPSIS: Vec * afc_vec_new ( size_t item_size )
+
+	  DESCRIPTION: This function initializes a new, empty, Vec instance, holding items /item_size/ bytes long.
+				   No memory is allocated for the items until the first one is added.
+
+			INPUT: - item_size	- Size (in bytes) of every item.
+
+		  RESULTS: a valid inizialized Vec structure. NULL in case of errors.
+
+		 SEE ALSO: - afc_vec_delete()
+
+@endnode
+*/
+Vec *afc_vec_new(size_t item_size)
+{
+	TRY(Vec *)
+
+	Vec *vec = NULL;
+
+	if (item_size == 0)
+		RAISE_FAST_RC(AFC_VEC_ERR_INVALID_SIZE, "item_size", NULL);
+
+	if ((vec = (Vec *)afc_malloc(sizeof(Vec))) == NULL)
+		RAISE_FAST_RC(AFC_ERR_NO_MEMORY, "vec", NULL);
+
+	vec->magic = AFC_VEC_MAGIC;
+	vec->item_size = item_size;
+
+	RETURN(vec);
+
+	EXCEPT
+	afc_vec_delete(vec);
+
+	FINALLY
+
+	ENDTRY
+}
+// }}}
+// {{{ afc_vec_delete ( vec )
+/*
+@node afc_vec_delete
+
+			 NAME: afc_vec_delete ( vec )  - Disposes a valid Vec instance.
+
+		 SYNOPSIS: int afc_vec_delete ( Vec * vec )
+
+	  DESCRIPTION: This function frees an already alloc'd Vec structure and all its items.
+
+			INPUT: - vec  - Pointer to a valid Vec instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+			NOTES: - this method calls: afc_vec_clear()
+
+		 SEE ALSO: - afc_vec_new()
+				   - afc_vec_clear()
+@endnode
+*/
+int _afc_vec_delete(Vec *vec)
+{
+	int afc_res;
+
+	if ((afc_res = afc_vec_clear(vec)) != AFC_ERR_NO_ERROR)
+		return (afc_res);
+
+	afc_free(vec);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_vec_clear ( vec )
+/*
+@node afc_vec_clear
+
+			 NAME: afc_vec_clear ( vec )  - Removes all the items
+
+		 SYNOPSIS: int afc_vec_clear ( Vec * vec )
+
+	  DESCRIPTION: This function removes all the items of the Vec and frees their memory.
+
+			INPUT: - vec  - Pointer to a valid Vec instance.
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+			NOTES: - To remove all the items but keep the memory for new ones, use afc_vec_resize ( vec, 0 ).
+
+		 SEE ALSO: - afc_vec_resize()
+@endnode
+*/
+int afc_vec_clear(Vec *vec)
+{
+	if (vec == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (vec->magic != AFC_VEC_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (vec->mem)
+		afc_free(vec->mem);
+
+	vec->mem = NULL;
+	vec->num_items = 0;
+	vec->max_items = 0;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_vec_reserve ( vec, num_items )
+/*
+@node afc_vec_reserve
+
+			 NAME: afc_vec_reserve ( vec, num_items )  - Makes room for some items
+
+		 SYNOPSIS: int afc_vec_reserve ( Vec * vec, unsigned long num_items )
+
+	  DESCRIPTION: This function makes sure the Vec can hold /num_items/ items without allocating memory again.
+				   Use it before adding many items, when you know how many they will be.
+
+			INPUT: - vec  		- Pointer to a valid Vec instance.
+				   - num_items	- Number of items the Vec must be able to hold.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_ERR_NO_MEMORY if there is not enough memory.
+				   - AFC_VEC_ERR_INVALID_SIZE if /num_items/ items do not fit in the address space.
+
+		 SEE ALSO: - afc_vec_resize()
+@endnode
+*/
+int afc_vec_reserve(Vec *vec, unsigned long num_items)
+{
+	if (vec == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (vec->magic != AFC_VEC_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (num_items <= vec->max_items)
+		return (AFC_ERR_NO_ERROR);
+
+	return (afc_vec_internal_grow(vec, num_items));
+}
+// }}}
+// {{{ afc_vec_resize ( vec, num_items )
+/*
+@node afc_vec_resize
+
+			 NAME: afc_vec_resize ( vec, num_items )  - Changes the number of items
+
+		 SYNOPSIS: int afc_vec_resize ( Vec * vec, unsigned long num_items )
+
+	  DESCRIPTION: This function sets the number of items of the Vec. Items past /num_items/ are dropped, while
+				   new items are set to zero bytes. The memory of the dropped items is kept for new ones.
+
+			INPUT: - vec  		- Pointer to a valid Vec instance.
+				   - num_items	- New number of items.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_ERR_NO_MEMORY if there is not enough memory.
+
+		 SEE ALSO: - afc_vec_reserve()
+				   - afc_vec_clear()
+@endnode
+*/
+int afc_vec_resize(Vec *vec, unsigned long num_items)
+{
+	int afc_res;
+
+	if ((afc_res = afc_vec_reserve(vec, num_items)) != AFC_ERR_NO_ERROR)
+		return (afc_res);
+
+	if (num_items > vec->num_items)
+		memset(afc_vec_internal_item(vec, vec->num_items), 0, (num_items - vec->num_items) * vec->item_size);
+
+	vec->num_items = num_items;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_vec_push ( vec, item )
+/*
+@node afc_vec_push
+
+			 NAME: afc_vec_push ( vec, item )  - Adds an item at the end of the Vec
+
+		 SYNOPSIS: void * afc_vec_push ( Vec * vec, const void * item )
+
+	  DESCRIPTION: This function copies the item pointed by /item/ at the end of the Vec. The memory of the Vec
+				   doubles every time it is full, so adding items costs O(1) on average.
+
+			INPUT: - vec  - Pointer to a valid Vec instance.
+				   - item - Pointer to the item to copy, or NULL to add an item set to zero bytes.
+
+		  RESULTS: a pointer to the new item inside the Vec, or NULL in case of errors.
+
+			NOTES: - /item/ can be an item of the same Vec, even when the Vec has to grow.
+
+		 SEE ALSO: - afc_vec_pop()
+				   - afc_vec_insert()
+@endnode
+*/
+void *afc_vec_push(Vec *vec, const void *item)
+{
+	size_t offset;
+	BOOL inside;
+	char *dest;
+
+	if (vec == NULL)
+	{
+		AFC_LOG_FAST(AFC_ERR_NULL_POINTER);
+		return (NULL);
+	}
+	if (vec->magic != AFC_VEC_MAGIC)
+	{
+		AFC_LOG_FAST(AFC_ERR_INVALID_POINTER);
+		return (NULL);
+	}
+
+	if (vec->num_items == vec->max_items)
+	{
+		// item may be one of the Vec items: they move when the Vec grows
+		inside = afc_vec_internal_inside(vec, item);
+		offset = inside ? (size_t)((const char *)item - vec->mem) : 0;
+
+		if (afc_vec_internal_grow(vec, vec->num_items + 1) != AFC_ERR_NO_ERROR)
+			return (NULL);
+
+		if (inside)
+			item = vec->mem + offset;
+	}
+
+	dest = afc_vec_internal_item(vec, vec->num_items++);
+
+	if (item)
+		memcpy(dest, item, vec->item_size);
+	else
+		memset(dest, 0, vec->item_size);
+
+	return (dest);
+}
+// }}}
+// {{{ afc_vec_pop ( vec, item )
+/*
+@node afc_vec_pop
+
+			 NAME: afc_vec_pop ( vec, item )  - Removes the last item of the Vec
+
+		 SYNOPSIS: int afc_vec_pop ( Vec * vec, void * item )
+
+	  DESCRIPTION: This function removes the last item of the Vec, copying it in /item/.
+
+			INPUT: - vec  - Pointer to a valid Vec instance.
+				   - item - Pointer to the memory where the item is copied, or NULL to just drop it.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_VEC_ERR_EMPTY if the Vec is empty.
+
+		 SEE ALSO: - afc_vec_push()
+@endnode
+*/
+int afc_vec_pop(Vec *vec, void *item)
+{
+	if (vec == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (vec->magic != AFC_VEC_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (vec->num_items == 0)
+		return (AFC_VEC_ERR_EMPTY);
+
+	vec->num_items--;
+
+	if (item)
+		memcpy(item, afc_vec_internal_item(vec, vec->num_items), vec->item_size);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_vec_insert ( vec, pos, items, num_items )
+/*
+@node afc_vec_insert
+
+			 NAME: afc_vec_insert ( vec, pos, items, num_items )  - Inserts items in the Vec
+
+		 SYNOPSIS: void * afc_vec_insert ( Vec * vec, unsigned long pos, const void * items, unsigned long num_items )
+
+	  DESCRIPTION: This function copies /num_items/ consecutive items, starting from /items/, in the Vec at position
+				   /pos/. Items from /pos/ on are moved after the new ones.
+
+			INPUT: - vec  		- Pointer to a valid Vec instance.
+				   - pos		- Position of the first new item (afc_vec_len() adds the items at the end).
+				   - items		- Pointer to the items to copy, or NULL to insert items set to zero bytes.
+				   - num_items	- Number of items to insert.
+
+		  RESULTS: a pointer to the first new item inside the Vec, or NULL in case of errors.
+
+			NOTES: - /items/ can point inside the Vec itself: those items are copied before the Vec changes.
+
+		 SEE ALSO: - afc_vec_erase()
+				   - afc_vec_lower_bound()
+@endnode
+*/
+void *afc_vec_insert(Vec *vec, unsigned long pos, const void *items, unsigned long num_items)
+{
+	char *dest, *copy = NULL;
+
+	if (vec == NULL)
+	{
+		AFC_LOG_FAST(AFC_ERR_NULL_POINTER);
+		return (NULL);
+	}
+	if (vec->magic != AFC_VEC_MAGIC)
+	{
+		AFC_LOG_FAST(AFC_ERR_INVALID_POINTER);
+		return (NULL);
+	}
+
+	if (pos > vec->num_items)
+	{
+		AFC_LOG(AFC_LOG_ERROR, AFC_VEC_ERR_INVALID_POSITION, "Position past the end of the Vec", NULL);
+		return (NULL);
+	}
+
+	if (num_items > ~0UL - vec->num_items)
+	{
+		AFC_LOG(AFC_LOG_ERROR, AFC_VEC_ERR_INVALID_SIZE, "Too many items", NULL);
+		return (NULL);
+	}
+
+	// Items of the Vec itself may move, growing the Vec or making room for the new ones: they are copied first
+	if (afc_vec_internal_inside(vec, items) && (num_items > 0))
+	{
+		if (num_items > (size_t)(afc_vec_internal_item(vec, vec->num_items) - (const char *)items) / vec->item_size)
+		{
+			AFC_LOG(AFC_LOG_ERROR, AFC_VEC_ERR_INVALID_SIZE, "Items past the end of the Vec", NULL);
+			return (NULL);
+		}
+
+		if ((copy = afc_malloc_uninit(num_items * vec->item_size)) == NULL)
+		{
+			AFC_LOG_FAST(AFC_ERR_NO_MEMORY);
+			return (NULL);
+		}
+
+		memcpy(copy, items, num_items * vec->item_size);
+		items = copy;
+	}
+
+	if ((num_items > vec->max_items - vec->num_items) && (afc_vec_internal_grow(vec, vec->num_items + num_items) != AFC_ERR_NO_ERROR))
+	{
+		if (copy)
+			afc_free(copy);
+		return (NULL);
+	}
+
+	dest = afc_vec_internal_item(vec, pos);
+
+	if (pos < vec->num_items)
+		memmove(dest + num_items * vec->item_size, dest, (vec->num_items - pos) * vec->item_size);
+
+	if (items)
+		memcpy(dest, items, num_items * vec->item_size);
+	else
+		memset(dest, 0, num_items * vec->item_size);
+
+	if (copy)
+		afc_free(copy);
+
+	vec->num_items += num_items;
+
+	return (dest);
+}
+// }}}
+// {{{ afc_vec_erase ( vec, pos, num_items )
+/*
+@node afc_vec_erase
+
+			 NAME: afc_vec_erase ( vec, pos, num_items )  - Removes items from the Vec
+
+		 SYNOPSIS: int afc_vec_erase ( Vec * vec, unsigned long pos, unsigned long num_items )
+
+	  DESCRIPTION: This function removes /num_items/ items from the Vec, starting from the one at position /pos/.
+				   The items after them are moved back.
+
+			INPUT: - vec  		- Pointer to a valid Vec instance.
+				   - pos		- Position of the first item to remove.
+				   - num_items	- Number of items to remove, or ALL to remove everything up to the end of the Vec.
+
+		  RESULTS: - AFC_ERR_NO_ERROR on success.
+				   - AFC_VEC_ERR_INVALID_POSITION if /pos/ is past the end of the Vec.
+
+			NOTES: - If /pos/ + /num_items/ is past the end of the Vec, only the items up to the end are removed.
+
+		 SEE ALSO: - afc_vec_insert()
+@endnode
+*/
+int afc_vec_erase(Vec *vec, unsigned long pos, unsigned long num_items)
+{
+	if (vec == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (vec->magic != AFC_VEC_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (pos > vec->num_items)
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_VEC_ERR_INVALID_POSITION, "Position past the end of the Vec", NULL));
+
+	if (num_items > vec->num_items - pos)
+		num_items = vec->num_items - pos;
+
+	if (num_items == 0)
+		return (AFC_ERR_NO_ERROR);
+
+	memmove(afc_vec_internal_item(vec, pos), afc_vec_internal_item(vec, pos + num_items), (vec->num_items - pos - num_items) * vec->item_size);
+	vec->num_items -= num_items;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_vec_item ( vec, pos )
+/*
+@node afc_vec_item
+
+			 NAME: afc_vec_item ( vec, pos )  - Returns an item of the Vec
+
+		 SYNOPSIS: void * afc_vec_item ( Vec * vec, unsigned long pos )
+
+	  DESCRIPTION: This function returns a pointer to the item at position /pos/, that can be read or changed in place.
+
+			INPUT: - vec  - Pointer to a valid Vec instance.
+				   - pos  - Position of the item.
+
+		  RESULTS: a pointer to the item, or NULL if /pos/ is past the end of the Vec.
+
+			NOTES: - The afc_vec_at() macro gives typed access to the items, without checking the position.
+
+		 SEE ALSO: - afc_vec_len()
+@endnode
+*/
+void *afc_vec_item(Vec *vec, unsigned long pos)
+{
+	if ((vec == NULL) || (pos >= vec->num_items))
+		return (NULL);
+
+	return (afc_vec_internal_item(vec, pos));
+}
+// }}}
+// {{{ afc_vec_sort ( vec, comp )
+/*
+@node afc_vec_sort
+
+			 NAME: afc_vec_sort ( vec, comp )  - Sorts the items
+
+		 SYNOPSIS: int afc_vec_sort ( Vec * vec, int ( * comp ) ( const void *, const void * ) )
+
+	  DESCRIPTION: This function sorts the items of the Vec with qsort(). Unlike afc_array_sort(), the compare function
+				   gets pointers to the items themselves, not pointers to pointers.
+
+			INPUT: - vec  - Pointer to a valid Vec instance.
+				   - comp - Compare function, just like the one of qsort().
+
+		  RESULTS: should be AFC_ERR_NO_ERROR
+
+		 SEE ALSO: - afc_vec_bsearch()
+				   - afc_vec_lower_bound()
+@endnode
+*/
+int afc_vec_sort(Vec *vec, int (*comp)(const void *, const void *))
+{
+	if ((vec == NULL) || (comp == NULL))
+		return (AFC_LOG_FAST(AFC_ERR_NULL_POINTER));
+	if (vec->magic != AFC_VEC_MAGIC)
+		return (AFC_LOG_FAST(AFC_ERR_INVALID_POINTER));
+
+	if (vec->num_items > 1)
+		qsort(vec->mem, vec->num_items, vec->item_size, comp);
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
+// {{{ afc_vec_lower_bound ( vec, key, comp )
+/*
+@node afc_vec_lower_bound
+
+			 NAME: afc_vec_lower_bound ( vec, key, comp )  - Finds where a key goes in a sorted Vec
+
+		 SYNOPSIS: unsigned long afc_vec_lower_bound ( Vec * vec, const void * key, int ( * comp ) ( const void *, const void * ) )
+
+	  DESCRIPTION: This function does a binary search of /key/ in a Vec sorted by /comp/, and returns the position of
+				   the first item that is not less than /key/. Inserting /key/ there keeps the Vec sorted.
+
+			INPUT: - vec  - Pointer to a valid Vec instance, sorted with /comp/.
+				   - key  - Pointer to the key to look for. It is always passed as the first argument of /comp/.
+				   - comp - Compare function.
+
+		  RESULTS: the position of the first item not less than /key/, or afc_vec_len() if all items are less than /key/.
+
+		 SEE ALSO: - afc_vec_bsearch()
+				   - afc_vec_insert()
+@endnode
+*/
+unsigned long afc_vec_lower_bound(Vec *vec, const void *key, int (*comp)(const void *, const void *))
+{
+	unsigned long low = 0, high, mid;
+
+	if ((vec == NULL) || (key == NULL) || (comp == NULL))
+		return (0);
+
+	high = vec->num_items;
+
+	while (low < high)
+	{
+		mid = low + (high - low) / 2;
+
+		if (comp(key, afc_vec_internal_item(vec, mid)) > 0)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return (low);
+}
+// }}}
+// {{{ afc_vec_bsearch ( vec, key, comp )
+/*
+@node afc_vec_bsearch
+
+			 NAME: afc_vec_bsearch ( vec, key, comp )  - Looks for a key in a sorted Vec
+
+		 SYNOPSIS: long afc_vec_bsearch ( Vec * vec, const void * key, int ( * comp ) ( const void *, const void * ) )
+
+	  DESCRIPTION: This function does a binary search of /key/ in a Vec sorted by /comp/.
+
+			INPUT: - vec  - Pointer to a valid Vec instance, sorted with /comp/.
+				   - key  - Pointer to the key to look for.
+				   - comp - Compare function.
+
+		  RESULTS: the position of the first item equal to /key/, or -1 if there is no such item.
+
+		 SEE ALSO: - afc_vec_lower_bound()
+				   - afc_vec_sort()
+@endnode
+*/
+long afc_vec_bsearch(Vec *vec, const void *key, int (*comp)(const void *, const void *))
+{
+	unsigned long pos = afc_vec_lower_bound(vec, key, comp);
+
+	if ((pos < afc_vec_len(vec)) && (comp(key, afc_vec_internal_item(vec, pos)) == 0))
+		return ((long)pos);
+
+	return (-1);
+}
+// }}}
+
+/* =====================================================================================
+	 INTERNAL FUNCTIONS
+===================================================================================== */
+// {{{ afc_vec_internal_grow ( vec, num_items )
+/* Makes room for at least num_items items, at least doubling the memory so that adding items costs O(1) on average */
+static int afc_vec_internal_grow(Vec *vec, unsigned long num_items)
+{
+	unsigned long max_items = vec->max_items ? vec->max_items : AFC_VEC_MIN_ITEMS;
+	char *mem;
+
+	while (max_items < num_items)
+		max_items = (max_items > (~0UL >> 1)) ? num_items : max_items * 2;
+
+	if (max_items > ((size_t)~0) / vec->item_size)
+		return (AFC_LOG(AFC_LOG_ERROR, AFC_VEC_ERR_INVALID_SIZE, "Too many items", NULL));
+
+	if (vec->mem == NULL)
+		mem = afc_malloc_uninit(max_items * vec->item_size);
+	else
+		mem = afc_realloc(vec->mem, max_items * vec->item_size);
+
+	if (mem == NULL)
+		return (AFC_LOG_FAST(AFC_ERR_NO_MEMORY));
+
+	vec->mem = mem;
+	vec->max_items = max_items;
+
+	return (AFC_ERR_NO_ERROR);
+}
+// }}}
@@ -0,0 +1,94 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef AFC_VEC_H
+#define AFC_VEC_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base.h"
+#include "exceptions.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif /* __cplusplus */
+
+/* AFC Vec Magic Number: 'AVEC' */
+#define AFC_VEC_MAGIC ('A' << 24 | 'V' << 16 | 'E' << 8 | 'C')
+
+/* AFC Vec Base value for constants */
+#define AFC_VEC_BASE 0xE400
+
+/* Number of items allocated by the first growth of an empty Vec */
+#define AFC_VEC_MIN_ITEMS 16
+
+	enum
+	{
+		AFC_VEC_ERR_INVALID_SIZE = AFC_VEC_BASE + 1, /* The item size is 0, or the size of the items is too big */
+		AFC_VEC_ERR_INVALID_POSITION,				 /* The position is past the end of the Vec */
+		AFC_VEC_ERR_EMPTY							 /* The Vec is empty */
+	};
+
+	struct afc_vec
+	{
+		unsigned long magic;
+
+		char *mem; // Items, one after the other (NULL until the first item is added)
+
+		size_t item_size;		 // Size of every item, in bytes
+		unsigned long num_items; // Number of items in the Vec
+		unsigned long max_items; // Number of items mem can hold
+	};
+
+	typedef struct afc_vec Vec;
+
+#define afc_vec_delete(vec)   \
+	if (vec)                  \
+	{                         \
+		_afc_vec_delete(vec); \
+		vec = NULL;           \
+	}
+
+	Vec *afc_vec_new(size_t item_size);
+	int _afc_vec_delete(Vec *vec);
+	int afc_vec_clear(Vec *vec);
+	int afc_vec_reserve(Vec *vec, unsigned long num_items);
+	int afc_vec_resize(Vec *vec, unsigned long num_items);
+	void *afc_vec_push(Vec *vec, const void *item);
+	int afc_vec_pop(Vec *vec, void *item);
+	void *afc_vec_insert(Vec *vec, unsigned long pos, const void *items, unsigned long num_items);
+	int afc_vec_erase(Vec *vec, unsigned long pos, unsigned long num_items);
+	void *afc_vec_item(Vec *vec, unsigned long pos);
+	int afc_vec_sort(Vec *vec, int (*comp)(const void *, const void *));
+	unsigned long afc_vec_lower_bound(Vec *vec, const void *key, int (*comp)(const void *, const void *));
+	long afc_vec_bsearch(Vec *vec, const void *key, int (*comp)(const void *, const void *));
+
+#define afc_vec_len(vec) ((vec) ? (vec)->num_items : 0)
+
+/* Typed access to the items, with no checks: afc_vec_at ( v, double, 3 ) = 1.5; */
+#define afc_vec_data(vec, type) ((type *)(vec)->mem)
+#define afc_vec_at(vec, type, pos) (((type *)(vec)->mem)[pos])
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * bench_string_numbers.c - Compares the AFC number formatting and parsing
+ * functions with snprintf(), strtoll() and strtod().
+ *
+ * Run it with "make bench". Times are in nanoseconds per number.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../src/string.h"
+
+#define COUNT 1000000
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1e9 + ts.tv_nsec);
+}
+
+static void report(const char *what, double afc_ns, double libc_ns)
+{
+	printf("| %-24s | afc %7.1f ns | libc %7.1f ns | x %5.2f |\n", what, afc_ns / COUNT, libc_ns / COUNT, libc_ns / afc_ns);
+}
+
+int main(void)
+{
+	long long *ints = malloc(COUNT * sizeof(long long));
+	double *doubles = malloc(COUNT * sizeof(double));
+	char *texts = malloc(COUNT * AFC_STRING_NUMBER_SIZE);
+	char buf[AFC_STRING_NUMBER_SIZE];
+	unsigned long sink = 0;
+	long long v;
+	double d, t0, t1, t2;
+	int i;
+
+	if ((ints == NULL) || (doubles == NULL) || (texts == NULL))
+		return (1);
+
+	srand(1);
+	for (i = 0; i < COUNT; i++)
+	{
+		ints[i] = ((long long)rand() << 16 ^ rand()) >> (rand() % 40);
+		doubles[i] = (double)rand() / (rand() + 1) * ((i & 1) ? 1e-3 : 1e5);
+	}
+
+	t0 = now();
+	for (i = 0; i < COUNT; i++)
+		sink += afc_string_format_int(buf, ints[i]);
+	t1 = now();
+	for (i = 0; i < COUNT; i++)
+		sink += snprintf(buf, sizeof(buf), "%lld", ints[i]);
+	t2 = now();
+	report("format_int / %lld", t1 - t0, t2 - t1);
+
+	t0 = now();
+	for (i = 0; i < COUNT; i++)
+		sink += afc_string_format_double(buf, doubles[i]);
+	t1 = now();
+	for (i = 0; i < COUNT; i++)
+		sink += snprintf(buf, sizeof(buf), "%.17g", doubles[i]);
+	t2 = now();
+	report("format_double / %.17g", t1 - t0, t2 - t1);
+
+	for (i = 0; i < COUNT; i++)
+		afc_string_format_int(texts + i * AFC_STRING_NUMBER_SIZE, ints[i]);
+
+	t0 = now();
+	for (i = 0; i < COUNT; i++)
+		sink += afc_string_parse_int(texts + i * AFC_STRING_NUMBER_SIZE, ALL, &v) + v;
+	t1 = now();
+	for (i = 0; i < COUNT; i++)
+		sink += strtoll(texts + i * AFC_STRING_NUMBER_SIZE, NULL, 10);
+	t2 = now();
+	report("parse_int / strtoll", t1 - t0, t2 - t1);
+
+	for (i = 0; i < COUNT; i++)
+		afc_string_format_double(texts + i * AFC_STRING_NUMBER_SIZE, doubles[i]);
+
+	t0 = now();
+	for (i = 0; i < COUNT; i++)
+		sink += afc_string_parse_double(texts + i * AFC_STRING_NUMBER_SIZE, ALL, &d) + (d > 1.0);
+	t1 = now();
+	for (i = 0; i < COUNT; i++)
+		sink += (strtod(texts + i * AFC_STRING_NUMBER_SIZE, NULL) > 1.0);
+	t2 = now();
+	report("parse_double 17 digits", t1 - t0, t2 - t1);
+
+	// Prices, measures and the like: few significant digits
+	for (i = 0; i < COUNT; i++)
+		afc_string_format_double(texts + i * AFC_STRING_NUMBER_SIZE, (rand() % 10000000) / 100.0);
+
+	t0 = now();
+	for (i = 0; i < COUNT; i++)
+		sink += afc_string_parse_double(texts + i * AFC_STRING_NUMBER_SIZE, ALL, &d) + (d > 1.0);
+	t1 = now();
+	for (i = 0; i < COUNT; i++)
+		sink += (strtod(texts + i * AFC_STRING_NUMBER_SIZE, NULL) > 1.0);
+	t2 = now();
+	report("parse_double short", t1 - t0, t2 - t1);
+
+	printf("(%lu)\n", sink & 1);
+
+	free(ints);
+	free(doubles);
+	free(texts);
+
+	return (0);
+}
@@ -0,0 +1,192 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+/**
+ * test_arena.c - Tests for the Arena allocator class.
+ *
+ * Tests cover:
+ *   - Object creation and deletion
+ *   - afc_arena_alloc() alignment and big allocations
+ *   - afc_arena_realloc() in place and with copy
+ *   - afc_arena_reset() / afc_arena_clear()
+ *   - Arena strings
+ *   - List, Array, Dictionary and StringList bound to an Arena
+ */
+
+#include "test_utils.h"
+#include "../src/arena.h"
+
+int main(void)
+{
+	AFC *afc = afc_new();
+	test_header();
+
+	char *s, *p, *q;
+	int t, ok;
+
+	/* ---- Test 1: Object creation ---- */
+	Arena *arena = afc_arena_new();
+	print_res("arena_new() not NULL", (void *)(long)1, (void *)(long)(arena != NULL), 0);
+	print_res("used after new", (void *)(long)0, (void *)(long)afc_arena_used(arena), 0);
+
+	print_row();
+
+	/* ---- Test 2: Allocations ---- */
+	p = afc_arena_alloc(arena, 10);
+	q = afc_arena_alloc(arena, 1);
+	print_res("alloc not NULL", (void *)(long)1, (void *)(long)((p != NULL) && (q != NULL)), 0);
+	print_res("alloc aligned", (void *)(long)0, (void *)(long)(((unsigned long)q) % AFC_ARENA_ALIGN), 0);
+	print_res("allocs are contiguous", (void *)(long)AFC_ARENA_ALIGN, (void *)(long)(q - p), 0);
+	print_res("used after 2 allocs", (void *)(long)(AFC_ARENA_ALIGN * 2), (void *)(long)afc_arena_used(arena), 0);
+
+	/* Many small allocations span several chunks and never overlap */
+	ok = 1;
+	for (t = 0; t < 5000; t++)
+	{
+		p = afc_arena_alloc(arena, 24);
+		memset(p, t & 0xFF, 24);
+		if ((q != NULL) && (q[0] != (char)((t - 1) & 0xFF)) && (t > 0))
+			ok = 0;
+		q = p;
+	}
+	print_res("5000 allocs", (void *)(long)1, (void *)(long)ok, 0);
+
+	/* Big allocations get their own chunk */
+	p = afc_arena_alloc(arena, AFC_ARENA_DEFAULT_CHUNK_SIZE * 2);
+	memset(p, 'x', AFC_ARENA_DEFAULT_CHUNK_SIZE * 2);
+	print_res("big alloc", (void *)(long)1, (void *)(long)((p != NULL) && (p[AFC_ARENA_DEFAULT_CHUNK_SIZE * 2 - 1] == 'x')), 0);
+
+	print_row();
+
+	/* ---- Test 3: Realloc ---- */
+	p = afc_arena_alloc(arena, 16);
+	strcpy(p, "in place");
+	q = afc_arena_realloc(arena, p, 16, 64);
+	print_res("realloc last in place", (void *)(long)1, (void *)(long)(p == q), 0);
+	print_res("realloc keeps data", "in place", q, 1);
+
+	afc_arena_alloc(arena, 16);
+	p = afc_arena_realloc(arena, q, 64, 128);
+	print_res("realloc not last moves", (void *)(long)1, (void *)(long)(p != q), 0);
+	print_res("realloc copies data", "in place", p, 1);
+
+	print_row();
+
+	/* ---- Test 4: Strings ---- */
+	s = afc_arena_string_dup(arena, "hello arena");
+	print_res("string_dup", "hello arena", s, 1);
+	print_res("string_dup len", (void *)(long)11, (void *)(long)afc_string_len(s), 0);
+	print_res("string_dup max", (void *)(long)11, (void *)(long)afc_string_max(s), 0);
+
+	s = afc_arena_string_new(arena, 20);
+	afc_string_copy(s, "12345", ALL);
+	print_res("string_new + copy", "12345", s, 1);
+	print_res("string_new max", (void *)(long)20, (void *)(long)afc_string_max(s), 0);
+
+	print_row();
+
+	/* ---- Test 5: Reset ---- */
+	afc_arena_reset(arena);
+	print_res("used after reset", (void *)(long)0, (void *)(long)afc_arena_used(arena), 0);
+	print_res("chunk kept after reset", (void *)(long)1, (void *)(long)(arena->chunk != NULL), 0);
+	print_res("big chunks freed", (void *)(long)1, (void *)(long)(arena->big == NULL), 0);
+
+	p = afc_arena_alloc(arena, 8);
+	print_res("alloc after reset", (void *)(long)1, (void *)(long)(p != NULL), 0);
+
+	afc_arena_clear(arena);
+	print_res("no chunks after clear", (void *)(long)1, (void *)(long)(arena->chunk == NULL), 0);
+
+	print_row();
+
+	/* ---- Test 6: Containers bound to the Arena ---- */
+	List *list = afc_list_new();
+	Array *array = afc_array_new();
+	Dictionary *dict = afc_dictionary_new();
+	StringList *sl = afc_string_list_new();
+
+	print_res("list set_arena", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_list_set_arena(list, arena), 0);
+	print_res("array set_arena", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_array_set_arena(array, arena), 0);
+	print_res("dictionary set_arena", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_dictionary_set_arena(dict, arena), 0);
+	print_res("string_list set_arena", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_string_list_set_arena(sl, arena), 0);
+
+	/* The same work is done twice, resetting the Arena in between (like two requests) */
+	int round;
+	for (round = 0; round < 2; round++)
+	{
+		char buf[32];
+
+		for (t = 0; t < 1000; t++)
+		{
+			sprintf(buf, "item-%d", t);
+			afc_list_add(list, (void *)(long)t, AFC_LIST_ADD_TAIL);
+			afc_array_add(array, (void *)(long)t, AFC_ARRAY_ADD_TAIL);
+			afc_dictionary_set(dict, buf, (void *)(long)(t + 1));
+			afc_string_list_add(sl, buf, AFC_STRING_LIST_ADD_TAIL);
+		}
+
+		/* Deleted list nodes are reused */
+		afc_list_first(list);
+		afc_list_del(list);
+		afc_list_add(list, (void *)(long)1000, AFC_LIST_ADD_TAIL);
+
+		print_res("list len", (void *)(long)1000, (void *)(long)afc_list_len(list), 0);
+		print_res("array len", (void *)(long)1000, (void *)(long)afc_array_len(array), 0);
+		print_res("array item 999", (void *)(long)999, afc_array_item(array, 999), 0);
+		print_res("dictionary len", (void *)(long)1000, (void *)(long)afc_dictionary_len(dict), 0);
+		print_res("dictionary get", (void *)(long)501, afc_dictionary_get(dict, "item-500"), 0);
+		print_res("string_list len", (void *)(long)1000, (void *)(long)afc_string_list_len(sl), 0);
+		print_res("string_list item", "item-999", afc_string_list_item(sl, 999), 1);
+		print_res("list set_arena not empty", (void *)(long)AFC_LIST_ERR_NOT_EMPTY, (void *)(long)afc_list_set_arena(list, NULL), 0);
+
+		/* Deleting the last node returns NULL, not the List header */
+		int dels = 0;
+		afc_list_first(list);
+		while (afc_list_del(list) && (dels < 2000))
+			dels++;
+		print_res("list del all", (void *)(long)999, (void *)(long)dels, 0);
+		print_res("list empty after del", (void *)(long)1, (void *)(long)(afc_list_is_empty(list) && (afc_list_first(list) == NULL)), 0);
+
+		afc_list_clear(list);
+		afc_array_clear(array);
+		afc_dictionary_clear(dict);
+		afc_string_list_clear(sl);
+		afc_arena_reset(arena);
+	}
+
+	/* Going back to the system heap */
+	print_res("list unbind", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_list_set_arena(list, NULL), 0);
+	print_res("array unbind", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_array_set_arena(array, NULL), 0);
+	afc_array_add(array, "heap", AFC_ARRAY_ADD_TAIL);
+	print_res("array after unbind", "heap", afc_array_first(array), 1);
+
+	afc_list_delete(list);
+	afc_array_delete(array);
+	afc_dictionary_delete(dict);
+	afc_string_list_delete(sl);
+
+	print_summary();
+
+	afc_arena_delete(arena);
+	afc_delete(afc);
+
+	return get_test_failures() > 0 ? 1 : 0;
+}
@@ -26,14 +26,69 @@
  *   - AFC magic number verification
  *   - afc_set_tag() with various tags and log levels
  *   - Error code constants existence and distinctness
+ *   - Per-thread last error and scratch strings
+ *   - Log formats, async logging and rate limiting
  */
 
+#include <pthread.h>
+
 #include "test_utils.h"
 #include "../src/base.h"
 
 /* Expected magic number computed from the 'BASE' string. */
 #define EXPECTED_MAGIC ('B' << 24 | 'A' << 16 | 'S' << 8 | 'E')
 
+static const char class_name[] = "TestBase";
+
+/* Results of the worker thread, checked by the main thread */
+struct worker_res
+{
+	int own_error;
+	int own_tmp;
+	int error_ok;
+};
+
+static void *worker(void *data)
+{
+	struct worker_res *res = (struct worker_res *)data;
+
+	AFC_LOG(AFC_LOG_MESSAGE, AFC_ERR_NO_ERROR, "worker error", NULL);
+
+	res->own_error = (afc_last_error() != NULL) && (afc_last_error() != __internal_afc_base->last_error);
+	res->own_tmp = (afc_tmp_string() != NULL) && (afc_tmp_string() != __internal_afc_base->tmp_string);
+	res->error_ok = (strcmp(AFC_STR_ERROR(), "worker error") == 0);
+
+	return (NULL);
+}
+
+/* Counts the lines of the log file containing /match/ (all lines if NULL) */
+static int log_lines(FILE *f, const char *match)
+{
+	char line[1024];
+	int count = 0;
+
+	fflush(f);
+	rewind(f);
+
+	while (fgets(line, sizeof(line), f))
+		if ((match == NULL) || (strstr(line, match) != NULL))
+			count++;
+
+	return (count);
+}
+
+static void *log_worker(void *data)
+{
+	int t;
+
+	(void)data;
+
+	for (t = 0; t < 200; t++)
+		AFC_LOG(AFC_LOG_WARNING, 0x42, "async record", NULL);
+
+	return (NULL);
+}
+
 int main(void)
 {
 	AFC *afc = afc_new();
@@ -274,6 +329,107 @@ int main(void)
 		(void *)(long)AFC_TAG_LOG_LEVEL,
 		0);
 
+	print_row();
+
+	/* ===== afc_malloc() / afc_malloc_uninit() ===== */
+	{
+		unsigned char *mem;
+		char *str;
+		int t, zero = 1;
+
+		/* Big enough to come straight from the system: it must be cleared anyway */
+		mem = afc_malloc(256 * 1024);
+		for (t = 0; t < 256 * 1024; t++)
+			if (mem[t] != 0)
+				zero = 0;
+		print_res("afc_malloc() cleared", (void *)(long)1, (void *)(long)zero, 0);
+		afc_free(mem);
+
+		mem = afc_malloc_uninit(100);
+		print_res("afc_malloc_uninit() not NULL", (void *)(long)1, (void *)(long)(mem != NULL), 0);
+		memset(mem, 'x', 100);
+		afc_free(mem);
+
+		/* afc_string_new() no longer clears the buffer, but the string is empty */
+		str = afc_string_new(16384);
+		print_res("string_new() is empty", "", str, 1);
+		print_res("string_new() len", (void *)(long)0, (void *)(long)afc_string_len(str), 0);
+		afc_string_delete(str);
+	}
+
+	print_row();
+
+	/* ===== Per-thread error state ===== */
+	{
+		struct worker_res res = {0, 0, 0};
+		pthread_t th;
+
+		AFC_LOG(AFC_LOG_MESSAGE, AFC_ERR_NO_ERROR, "main error", NULL);
+		print_res("main last_error", "main error", AFC_STR_ERROR(), 1);
+		print_res("main uses afc->last_error", afc->last_error, afc_last_error(), 0);
+		print_res("main uses afc->tmp_string", afc->tmp_string, afc_tmp_string(), 0);
+
+		pthread_create(&th, NULL, worker, &res);
+		pthread_join(th, NULL);
+
+		print_res("thread has own last_error", (void *)(long)1, (void *)(long)res.own_error, 0);
+		print_res("thread has own tmp_string", (void *)(long)1, (void *)(long)res.own_tmp, 0);
+		print_res("thread last_error", (void *)(long)1, (void *)(long)res.error_ok, 0);
+		print_res("main last_error untouched", "main error", AFC_STR_ERROR(), 1);
+	}
+
+	print_row();
+
+	/* ===== Log formats, async mode and rate limit ===== */
+	{
+		FILE *f = tmpfile();
+		pthread_t th[4];
+		int t, n;
+
+		afc_set_tags(afc, AFC_TAG_OUTPUT_FILE, f, AFC_TAG_LOG_LEVEL, AFC_LOG_MESSAGE, AFC_TAG_LOG_FORMAT, AFC_LOG_FORMAT_LINE);
+
+		AFC_LOG(AFC_LOG_WARNING, 0x10, "line record", "extra");
+		print_res("line format: one line", (void *)(long)1, (void *)(long)log_lines(f, NULL), 0);
+		print_res("line format: fields", (void *)(long)1, (void *)(long)log_lines(f, "WARNING [TestBase] main: line record (extra) code=0x10"), 0);
+
+		afc_set_tag(afc, AFC_TAG_LOG_FORMAT, (void *)AFC_LOG_FORMAT_JSON);
+		AFC_LOG(AFC_LOG_ERROR, 16, "say \"hi\"", NULL);
+		print_res("json format: escaped", (void *)(long)1, (void *)(long)log_lines(f, "\"descr\":\"say \\\"hi\\\"\",\"info\":null,\"code\":\"0x10\"}"), 0);
+		print_res("json format: level", (void *)(long)1, (void *)(long)log_lines(f, "\"level\":\"ERROR\",\"class\":\"TestBase\""), 0);
+
+		/* Async: 4 threads x 200 records fit in the queue */
+		afc_set_tags(afc, AFC_TAG_LOG_FORMAT, AFC_LOG_FORMAT_LINE, AFC_TAG_LOG_MODE, AFC_LOG_MODE_ASYNC);
+		print_res("async queue created", (void *)(long)1, (void *)(long)(afc->log_queue != NULL), 0);
+
+		for (t = 0; t < 4; t++)
+			pthread_create(&th[t], NULL, log_worker, NULL);
+		for (t = 0; t < 4; t++)
+			pthread_join(th[t], NULL);
+
+		afc_log_flush(afc);
+		print_res("async records written", (void *)(long)800, (void *)(long)log_lines(f, "async record"), 0);
+		print_res("workers keep own last_error", "say \"hi\"", AFC_STR_ERROR(), 1);
+
+		AFC_LOG(AFC_LOG_WARNING, 0x43, "last async", NULL);
+		afc_set_tag(afc, AFC_TAG_LOG_MODE, (void *)AFC_LOG_MODE_SYNC);
+		print_res("sync mode writes queue", (void *)(long)1, (void *)(long)log_lines(f, "last async"), 0);
+		print_res("async queue removed", NULL, afc->log_queue, 0);
+
+		/* Rate limit: 5 records per second (10 if the second changes meanwhile) */
+		afc_set_tag(afc, AFC_TAG_LOG_RATE_LIMIT, (void *)5);
+		for (t = 0; t < 50; t++)
+			AFC_LOG(AFC_LOG_WARNING, 0x77, "limited", NULL);
+		n = log_lines(f, "limited code=0x77");
+		print_res("rate limit", (void *)(long)1, (void *)(long)((n >= 5) && (n <= 10)), 0);
+
+		AFC_LOG(AFC_LOG_WARNING, 0x78, "other code", NULL);
+		print_res("rate limit per code", (void *)(long)1, (void *)(long)log_lines(f, "other code"), 0);
+		afc_set_tag(afc, AFC_TAG_LOG_RATE_LIMIT, (void *)0);
+
+		afc_set_tags(afc, AFC_TAG_OUTPUT_FILE, stderr, AFC_TAG_LOG_FORMAT, AFC_LOG_FORMAT_CLASSIC);
+		fclose(f);
+	}
+
 	print_summary();
 
 	/* Cleanup: afc_delete should return AFC_ERR_NO_ERROR. */
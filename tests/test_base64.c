@@ -27,6 +27,7 @@
  *   - Memory-to-memory decoding of known encoded strings
  *   - Round-trip encode then decode verification
  *   - Edge cases: empty input, single character, padding variations
+ *   - Memory output terminated when the buffer is not cleared
  */
 
 #include "test_utils.h"
@@ -253,6 +254,37 @@ int main(void)
 			0);
 	}
 
+	print_row();
+
+	/* ---- Memory output is terminated, even if not cleared ---- */
+	afc_base64_delete(b64);
+	b64 = afc_base64_new();
+	memset(encoded, 'Z', OUTPUT_BUF_SIZE);
+	afc_base64_encode(b64,
+		AFC_BASE64_TAG_MEM_IN, INPUT_ABC,
+		AFC_BASE64_TAG_MEM_IN_SIZE, (void *)(long)strlen(INPUT_ABC),
+		AFC_BASE64_TAG_MEM_OUT, encoded,
+		AFC_BASE64_TAG_MEM_OUT_SIZE, (void *)(long)OUTPUT_BUF_SIZE,
+		AFC_TAG_END);
+	print_res("encode output terminated",
+		(void *)(long)(b64->mem_out_pos - b64->mem_out),
+		(void *)(long)strlen(encoded),
+		0);
+
+	afc_base64_delete(b64);
+	b64 = afc_base64_new();
+	memset(decoded, 'Z', OUTPUT_BUF_SIZE);
+	afc_base64_decode(b64,
+		AFC_BASE64_TAG_MEM_IN, EXPECTED_ABC,
+		AFC_BASE64_TAG_MEM_IN_SIZE, (void *)(long)strlen(EXPECTED_ABC),
+		AFC_BASE64_TAG_MEM_OUT, decoded,
+		AFC_BASE64_TAG_MEM_OUT_SIZE, (void *)(long)OUTPUT_BUF_SIZE,
+		AFC_TAG_END);
+	print_res("decode output terminated",
+		INPUT_ABC,
+		decoded,
+		1);
+
 	print_summary();
 
 	/* Cleanup */
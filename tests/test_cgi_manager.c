@@ -267,6 +267,104 @@ int main(void)
 
 	afc_string_delete(header_buf);
 
+	/* ----------------------------------------------------------------
+	 * 15. Form fields and cookies parsing
+	 * ---------------------------------------------------------------- */
+	{
+		CGIManager *cgi2;
+
+		setenv("REQUEST_METHOD", "GET", 1);
+		setenv("QUERY_STRING", "name=Fabio+R& city=Rome%21 &&empty=&=bad&noeq&a%3Db=1", 1);
+		setenv("HTTP_COOKIE", "sid=abc123; theme=dark", 1);
+
+		cgi2 = afc_cgi_manager_new();
+		cgi2->handle_cookies = TRUE;
+		afc_cgi_manager_get_data(cgi2);
+
+		print_res("form field", "Fabio R", afc_cgi_manager_get_val(cgi2, "name"), 1);
+		print_res("form field trimmed", "Rome!", afc_cgi_manager_get_val(cgi2, "city"), 1);
+		print_res("form empty value skipped", NULL, afc_cgi_manager_get_val(cgi2, "empty"), 0);
+		print_res("form key unescaped", "1", afc_cgi_manager_get_val(cgi2, "A=B"), 1);
+		print_res("form fields count", (void *)(long)3, (void *)(long)afc_dictionary_len(cgi2->fields), 0);
+		print_res("cookie sid", "abc123", afc_cgi_manager_get_cookie(cgi2, "sid"), 1);
+		print_res("cookie theme", "dark", afc_cgi_manager_get_cookie(cgi2, "theme"), 1);
+
+		afc_cgi_manager_delete(cgi2);
+
+		unsetenv("REQUEST_METHOD");
+		unsetenv("QUERY_STRING");
+		unsetenv("HTTP_COOKIE");
+	}
+
+	/* ----------------------------------------------------------------
+	 * 16. AFC_CGI_MANAGER_TAG_UTF8
+	 * ---------------------------------------------------------------- */
+	{
+		CGIManager *cgi2;
+
+		setenv("REQUEST_METHOD", "GET", 1);
+		setenv("CONTENT_TYPE", "application/x-www-form-urlencoded; charset=ISO-8859-1", 1);
+		setenv("QUERY_STRING", "city=Citt%E0&plain=abc", 1);
+
+		cgi2 = afc_cgi_manager_new();
+		afc_cgi_manager_set_tag(cgi2, AFC_CGI_MANAGER_TAG_UTF8, (void *)TRUE);
+		afc_cgi_manager_get_data(cgi2);
+		print_res("latin1 field to utf8", "Citt\xc3\xa0", afc_cgi_manager_get_val(cgi2, "city"), 1);
+		print_res("ascii field untouched", "abc", afc_cgi_manager_get_val(cgi2, "plain"), 1);
+		afc_cgi_manager_delete(cgi2);
+
+		/* No charset: valid UTF-8 is kept, anything else is taken as Latin-1 */
+		unsetenv("CONTENT_TYPE");
+		setenv("QUERY_STRING", "a=Citt%C3%A0&b=Citt%E0", 1);
+
+		cgi2 = afc_cgi_manager_new();
+		afc_cgi_manager_set_tag(cgi2, AFC_CGI_MANAGER_TAG_UTF8, (void *)TRUE);
+		afc_cgi_manager_get_data(cgi2);
+		print_res("utf8 field kept", "Citt\xc3\xa0", afc_cgi_manager_get_val(cgi2, "a"), 1);
+		print_res("invalid utf8 field converted", "Citt\xc3\xa0", afc_cgi_manager_get_val(cgi2, "b"), 1);
+		afc_cgi_manager_delete(cgi2);
+
+		/* Tag not set: fields are stored as sent */
+		cgi2 = afc_cgi_manager_new();
+		afc_cgi_manager_get_data(cgi2);
+		print_res("no tag: field as sent", "Citt\xe0", afc_cgi_manager_get_val(cgi2, "b"), 1);
+		afc_cgi_manager_delete(cgi2);
+
+		unsetenv("REQUEST_METHOD");
+		unsetenv("QUERY_STRING");
+	}
+
+	/* ----------------------------------------------------------------
+	 * 17. Field names are interned once for all the requests
+	 * ---------------------------------------------------------------- */
+	{
+		CGIManager *cgi2;
+		const char *key1, *key2;
+		unsigned long pooled;
+
+		setenv("REQUEST_METHOD", "GET", 1);
+		setenv("QUERY_STRING", "user=one&page=1", 1);
+
+		cgi2 = afc_cgi_manager_new();
+		afc_cgi_manager_get_data(cgi2);
+		key1 = afc_string_pool_find(cgi2->keys, "USER");
+		pooled = afc_string_pool_len(cgi2->keys);
+
+		afc_cgi_manager_clear(cgi2);
+		setenv("QUERY_STRING", "user=two&page=2", 1);
+		afc_cgi_manager_get_data(cgi2);
+		afc_dictionary_get(cgi2->fields, "USER");
+		key2 = afc_dictionary_get_key(cgi2->fields);
+
+		print_res("second request value", "two", afc_cgi_manager_get_val(cgi2, "user"), 1);
+		print_res("same key pointer", (void *)(long)1, (void *)(long)((key1 != NULL) && (key1 == key2)), 0);
+		print_res("no new keys", (void *)(long)pooled, (void *)(long)afc_string_pool_len(cgi2->keys), 0);
+		afc_cgi_manager_delete(cgi2);
+
+		unsetenv("REQUEST_METHOD");
+		unsetenv("QUERY_STRING");
+	}
+
 	/* ----------------------------------------------------------------
 	 * Cleanup and summary
 	 * ---------------------------------------------------------------- */
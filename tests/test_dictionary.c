@@ -218,6 +218,134 @@ int main(void)
 	s = (char *)afc_dictionary_get(dict, "dd");
 	print_res("get 'dd'", "val_dd", s, 1);
 
+	print_row();
+
+	/* ----------------------------------------------------------------
+	 * 15. Many keys: slab allocation, key layout and entry reuse
+	 * ---------------------------------------------------------------- */
+	{
+		char buf[64];
+		int t, ok = 1, found = 0;
+
+		afc_dictionary_clear(dict);
+
+		for (t = 0; t < 20000; t++)
+		{
+			sprintf(buf, "key-%d%s", t, (t % 97) ? "" : "-with-a-much-longer-suffix-to-change-size");
+			afc_dictionary_set(dict, buf, (void *)(long)(t + 1));
+		}
+		print_res("len after 20000 sets", (void *)(long)20000, (void *)(long)afc_dictionary_len(dict), 0);
+
+		for (t = 0; t < 20000; t++)
+		{
+			sprintf(buf, "key-%d%s", t, (t % 97) ? "" : "-with-a-much-longer-suffix-to-change-size");
+			if (afc_dictionary_get(dict, buf) != (void *)(long)(t + 1))
+				ok = 0;
+		}
+		print_res("get all 20000 keys", (void *)(long)1, (void *)(long)ok, 0);
+
+		afc_dictionary_get(dict, "key-194-with-a-much-longer-suffix-to-change-size");
+		s = afc_dictionary_get_key(dict);
+		print_res("key is an AFC string", (void *)(long)strlen(s), (void *)(long)afc_string_len(s), 0);
+
+		for (t = 0; t < 20000; t += 2)
+		{
+			sprintf(buf, "key-%d%s", t, (t % 97) ? "" : "-with-a-much-longer-suffix-to-change-size");
+			afc_dictionary_del_item(dict, buf);
+		}
+		print_res("len after deleting half", (void *)(long)10000, (void *)(long)afc_dictionary_len(dict), 0);
+
+		/* Deleted entries are reused by new keys of the same size */
+		for (t = 0; t < 20000; t += 2)
+		{
+			sprintf(buf, "KEY-%d%s", t, (t % 97) ? "" : "-with-a-much-longer-suffix-to-change-size");
+			afc_dictionary_set(dict, buf, (void *)(long)(t + 1));
+		}
+
+		ok = 1;
+		for (t = 0; t < 20000; t++)
+		{
+			sprintf(buf, "%s-%d%s", (t & 1) ? "key" : "KEY", t, (t % 97) ? "" : "-with-a-much-longer-suffix-to-change-size");
+			if (afc_dictionary_get(dict, buf) != (void *)(long)(t + 1))
+				ok = 0;
+		}
+		print_res("get after reuse", (void *)(long)1, (void *)(long)ok, 0);
+
+		s = afc_dictionary_first(dict);
+		while (s)
+		{
+			found++;
+			s = afc_dictionary_next(dict);
+		}
+		print_res("traversal count", (void *)(long)20000, (void *)(long)found, 0);
+
+		afc_dictionary_clear(dict);
+		print_res("len after big clear", (void *)(long)0, (void *)(long)afc_dictionary_len(dict), 0);
+	}
+
+	print_row();
+
+	/* ----------------------------------------------------------------
+	 * 16. Prehashed API and keys colliding on the same hash value
+	 * ---------------------------------------------------------------- */
+	{
+		unsigned long int h = afc_dictionary_hash_key(dict, "prehashed");
+
+		afc_dictionary_set_prehashed(dict, "prehashed", h, "value_p");
+		print_res("get after set_prehashed", "value_p", (char *)afc_dictionary_get(dict, "prehashed"), 1);
+		print_res("get_prehashed", "value_p", (char *)afc_dictionary_get_prehashed(dict, "prehashed", h), 1);
+
+		/* Every dictionary has its own seed: an hash value does not work on another one */
+		{
+			Dictionary *other = afc_dictionary_new();
+
+			print_res("other dict hash misses", (void *)(long)1, (void *)(long)(afc_dictionary_get_prehashed(dict, "prehashed", afc_dictionary_hash_key(other, "prehashed")) == NULL), 0);
+			afc_dictionary_delete(other);
+		}
+
+		/* Force different keys on the same hash value */
+		afc_dictionary_set_prehashed(dict, "one", 42, "val_one");
+		afc_dictionary_set_prehashed(dict, "two", 42, "val_two");
+		afc_dictionary_set_prehashed(dict, "three", 42, "val_three");
+		print_res("len with collisions", (void *)(long)4, (void *)(long)afc_dictionary_len(dict), 0);
+		print_res("collision get 'one'", "val_one", (char *)afc_dictionary_get_prehashed(dict, "one", 42), 1);
+		print_res("collision get 'two'", "val_two", (char *)afc_dictionary_get_prehashed(dict, "two", 42), 1);
+		print_res("collision get 'three'", "val_three", (char *)afc_dictionary_get_prehashed(dict, "three", 42), 1);
+		print_res("collision missing == NULL", (void *)(long)1, (void *)(long)(afc_dictionary_get_prehashed(dict, "four", 42) == NULL), 0);
+
+		afc_dictionary_set_prehashed(dict, "two", 42, "val_two_b");
+		print_res("collision overwrite", "val_two_b", (char *)afc_dictionary_get_prehashed(dict, "two", 42), 1);
+		print_res("len after overwrite", (void *)(long)4, (void *)(long)afc_dictionary_len(dict), 0);
+
+		afc_dictionary_set_prehashed(dict, "one", 42, NULL);
+		print_res("collision del 'one'", (void *)(long)1, (void *)(long)(afc_dictionary_get_prehashed(dict, "one", 42) == NULL), 0);
+		print_res("collision 'three' kept", "val_three", (char *)afc_dictionary_get_prehashed(dict, "three", 42), 1);
+		print_res("len after collision del", (void *)(long)3, (void *)(long)afc_dictionary_len(dict), 0);
+
+		afc_dictionary_clear(dict);
+	}
+
+	/* ----------------------------------------------------------------
+	 * 17. Keys given as string views
+	 * ---------------------------------------------------------------- */
+	{
+		const char *query = "name=fabio&city=rome";
+
+		afc_dictionary_set_view(dict, afc_strview_make(query, 4), "v_name");
+		afc_dictionary_set_view(dict, afc_strview_make(query + 11, 4), "v_city");
+		print_res("set_view key length", (void *)(long)4, (void *)(long)afc_string_len(afc_dictionary_get_key(dict)), 0);
+
+		print_res("set_view key", "v_name", (char *)afc_dictionary_get(dict, "name"), 1);
+		print_res("get_view", "v_city", (char *)afc_dictionary_get_view(dict, afc_strview_make(query + 11, 4)), 1);
+		print_res("get_view prefix", NULL, afc_dictionary_get_view(dict, afc_strview_make(query, 3)), 0);
+
+		afc_dictionary_set_view(dict, afc_strview_make("name", ALL), "v_name2");
+		print_res("set_view overwrite", "v_name2", (char *)afc_dictionary_get(dict, "name"), 1);
+		print_res("set_view len", (void *)(long)2, (void *)(long)afc_dictionary_len(dict), 0);
+
+		afc_dictionary_clear(dict);
+	}
+
 	/* ----------------------------------------------------------------
 	 * Cleanup
 	 * ---------------------------------------------------------------- */
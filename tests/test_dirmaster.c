@@ -272,6 +272,41 @@ int main(void)
 	print_res("clear(NULL) returns err",
 		(void *)(long)1, (void *)(long)(res != AFC_ERR_NO_ERROR), 0);
 
+	/* ----------------------------------------------------------------
+	 * 14. File size strings (csize)
+	 * ---------------------------------------------------------------- */
+	{
+		FILE *fh;
+		FileInfo *fi2;
+		char buf[1536];
+
+		mkdir("/tmp/afc_test_dirmaster_sizes", 0755);
+		memset(buf, 'x', sizeof(buf));
+		if ((fh = fopen("/tmp/afc_test_dirmaster_sizes/file.bin", "w")) != NULL)
+		{
+			fwrite(buf, 1, sizeof(buf), fh);
+			fclose(fh);
+		}
+
+		afc_dirmaster_set_tags(dm, AFC_DIRMASTER_TAG_SIZE_FORMAT, (void *)(long)SIZEFORMAT_BYTES, AFC_DIRMASTER_TAG_SIZE_DECIMALS, (void *)(long)2);
+		afc_dirmaster_scan_dir(dm, "/tmp/afc_test_dirmaster_sizes");
+		fi2 = afc_dirmaster_search(dm, "file.bin", FALSE);
+		print_res("csize bytes", "1536 b", fi2 ? fi2->csize : NULL, 1);
+
+		afc_dirmaster_set_tag(dm, AFC_DIRMASTER_TAG_SIZE_FORMAT, (void *)(long)SIZEFORMAT_HUMAN);
+		afc_dirmaster_scan_dir(dm, "/tmp/afc_test_dirmaster_sizes");
+		fi2 = afc_dirmaster_search(dm, "file.bin", FALSE);
+		print_res("csize human", "1.51 K", fi2 ? fi2->csize : NULL, 1);
+
+		afc_dirmaster_set_tag(dm, AFC_DIRMASTER_TAG_SIZE_FORMAT, (void *)(long)SIZEFORMAT_HUMAN_1000);
+		afc_dirmaster_scan_dir(dm, "/tmp/afc_test_dirmaster_sizes");
+		fi2 = afc_dirmaster_search(dm, "file.bin", FALSE);
+		print_res("csize human 1000", "1.53 K", fi2 ? fi2->csize : NULL, 1);
+
+		unlink("/tmp/afc_test_dirmaster_sizes/file.bin");
+		rmdir("/tmp/afc_test_dirmaster_sizes");
+	}
+
 	/* ----------------------------------------------------------------
 	 * Cleanup and summary
 	 * ---------------------------------------------------------------- */
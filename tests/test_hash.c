@@ -224,6 +224,150 @@ int main(void)
 	}
 	print_res("all 10 keys found", (void *)(long)1, (void *)(long)all_found, 0);
 
+	print_row();
+
+	/* ----------------------------------------------------------------
+	 * 12. Storage cannot be changed on a non empty hash
+	 * ---------------------------------------------------------------- */
+	res = afc_hash_set_tags(hm, AFC_HASH_TAG_STORAGE, (void *)(long)AFC_HASH_STORAGE_OPEN, AFC_TAG_END);
+	print_res("set storage on non empty", (void *)(long)AFC_HASH_ERR_NOT_EMPTY, (void *)(long)res, 0);
+
+	print_row();
+
+	/* ----------------------------------------------------------------
+	 * 13. Open addressing storage
+	 * ---------------------------------------------------------------- */
+	Hash *ho = afc_hash_new();
+	res = afc_hash_set_tags(ho, AFC_HASH_TAG_STORAGE, (void *)(long)AFC_HASH_STORAGE_OPEN, AFC_TAG_END);
+	print_res("open: set storage", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)res, 0);
+
+	afc_hash_add(ho, HASH_KEY_ALPHA, "alpha");
+	afc_hash_add(ho, HASH_KEY_BETA, "beta");
+	afc_hash_add(ho, HASH_KEY_GAMMA, "gamma");
+	print_res("open: len after 3 adds", (void *)(long)3, (void *)(long)afc_hash_len(ho), 0);
+	print_res("open: find beta", "beta", (char *)afc_hash_find(ho, HASH_KEY_BETA), 1);
+	print_res("open: find missing == NULL", (void *)(long)1, (void *)(long)(afc_hash_find(ho, HASH_KEY_MISSING) == NULL), 0);
+
+	/* find() makes the item the current one, so del() removes it */
+	afc_hash_find(ho, HASH_KEY_BETA);
+	afc_hash_del(ho);
+	print_res("open: len after del", (void *)(long)2, (void *)(long)afc_hash_len(ho), 0);
+	print_res("open: beta deleted", (void *)(long)1, (void *)(long)(afc_hash_find(ho, HASH_KEY_BETA) == NULL), 0);
+	print_res("open: gamma still there", "gamma", (char *)afc_hash_find(ho, HASH_KEY_GAMMA), 1);
+
+	afc_hash_clear(ho);
+	print_res("open: is_empty after clear", (void *)(long)1, (void *)(long)afc_hash_is_empty(ho), 0);
+	print_res("open: first on empty == NULL", (void *)(long)1, (void *)(long)(afc_hash_first(ho) == NULL), 0);
+
+	/* Many items: the table is resized several times, incrementally */
+#define OPEN_ITEMS 100000
+	for (i = 1; i <= OPEN_ITEMS; i++)
+		afc_hash_add(ho, i * 8, (void *)(long)i);
+	print_res("open: len after many adds", (void *)(long)OPEN_ITEMS, (void *)(long)afc_hash_len(ho), 0);
+
+	all_found = 1;
+	for (i = 1; i <= OPEN_ITEMS; i++)
+		if ((long)afc_hash_find(ho, i * 8) != (long)i)
+		{
+			all_found = 0;
+			break;
+		}
+	print_res("open: all keys found", (void *)(long)1, (void *)(long)all_found, 0);
+
+	/* Delete all even items */
+	for (i = 2; i <= OPEN_ITEMS; i += 2)
+		if (afc_hash_find(ho, i * 8) != NULL)
+			afc_hash_del(ho);
+	print_res("open: len after deleting half", (void *)(long)(OPEN_ITEMS / 2), (void *)(long)afc_hash_len(ho), 0);
+
+	all_found = 1;
+	for (i = 1; i <= OPEN_ITEMS; i++)
+	{
+		void *v = afc_hash_find(ho, i * 8);
+		if ((i % 2) ? ((long)v != (long)i) : (v != NULL))
+		{
+			all_found = 0;
+			break;
+		}
+	}
+	print_res("open: odd found, even gone", (void *)(long)1, (void *)(long)all_found, 0);
+
+	/* Traversal returns every item exactly once */
+	long sum = 0, count = 0;
+	void *v;
+	for (v = afc_hash_first(ho); v != NULL; v = afc_hash_next(ho))
+	{
+		sum += (long)v;
+		count++;
+	}
+	print_res("open: traversal count", (void *)(long)(OPEN_ITEMS / 2), (void *)count, 0);
+	print_res("open: traversal sum", (void *)(long)1, (void *)(long)(sum == (long)(OPEN_ITEMS / 2) * (OPEN_ITEMS / 2)), 0);
+
+	/* Deleting while traversing visits every item exactly once */
+	sum = 0;
+	count = 0;
+	v = afc_hash_first(ho);
+	while (v != NULL)
+	{
+		sum += (long)v;
+		count++;
+		v = afc_hash_del(ho);
+	}
+	print_res("open: del traversal count", (void *)(long)(OPEN_ITEMS / 2), (void *)count, 0);
+	print_res("open: del traversal sum", (void *)(long)1, (void *)(long)(sum == (long)(OPEN_ITEMS / 2) * (OPEN_ITEMS / 2)), 0);
+	print_res("open: empty after del all", (void *)(long)1, (void *)(long)afc_hash_is_empty(ho), 0);
+
+	afc_hash_delete(ho);
+
+	print_row();
+
+	/* ----------------------------------------------------------------
+	 * 14. afc_hash_find_next() - all items sharing an hash_value
+	 * ---------------------------------------------------------------- */
+	int mode;
+	for (mode = 0; mode < 2; mode++)
+	{
+		Hash *hf = afc_hash_new();
+		if (mode)
+			afc_hash_set_tags(hf, AFC_HASH_TAG_STORAGE, (void *)(long)AFC_HASH_STORAGE_OPEN, AFC_TAG_END);
+
+		/* Duplicates are added between many other items, so in open mode they end up in both tables of a resize */
+		for (i = 1; i <= 3000; i++)
+		{
+			afc_hash_add(hf, i * 2 + 1, (void *)(long)i);
+			if ((i % 600) == 0)
+				afc_hash_add(hf, 1000000, (void *)(long)(i / 600));
+		}
+
+		sum = 0;
+		count = 0;
+		for (v = afc_hash_find(hf, 1000000); v != NULL; v = afc_hash_find_next(hf))
+		{
+			sum += (long)v;
+			count++;
+		}
+		print_res(mode ? "open: find_next count" : "sorted: find_next count", (void *)(long)5, (void *)count, 0);
+		print_res(mode ? "open: find_next sum" : "sorted: find_next sum", (void *)(long)15, (void *)sum, 0);
+		print_res(mode ? "open: find_next at end" : "sorted: find_next at end", (void *)(long)1, (void *)(long)(afc_hash_find_next(hf) == NULL), 0);
+
+		/* The item returned by find_next() is the current one */
+		afc_hash_find(hf, 1000000);
+		afc_hash_find_next(hf);
+		afc_hash_del(hf);
+		count = 0;
+		for (v = afc_hash_find(hf, 1000000); v != NULL; v = afc_hash_find_next(hf))
+			count++;
+		print_res(mode ? "open: del after find_next" : "sorted: del after find_next", (void *)(long)4, (void *)count, 0);
+
+		/* A single item has no next one, and a missing one starts no search */
+		afc_hash_find(hf, 7);
+		print_res(mode ? "open: find_next on unique" : "sorted: find_next on unique", (void *)(long)1, (void *)(long)(afc_hash_find_next(hf) == NULL), 0);
+		afc_hash_find(hf, 8);
+		print_res(mode ? "open: find_next on missing" : "sorted: find_next on missing", (void *)(long)1, (void *)(long)(afc_hash_find_next(hf) == NULL), 0);
+
+		afc_hash_delete(hf);
+	}
+
 	/* ----------------------------------------------------------------
 	 * Cleanup
 	 * ---------------------------------------------------------------- */
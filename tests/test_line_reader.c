@@ -0,0 +1,177 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/**
+ * test_line_reader.c - Tests for the LineReader class.
+ *
+ * Tests cover:
+ *   - Object creation and deletion
+ *   - Reading a file mapped in memory and in blocks
+ *   - "\r\n" terminators, empty lines, last line without terminator
+ *   - Lines longer than the block buffer
+ *   - Chunks: every line is returned by exactly one chunk
+ *   - Empty files, devices and errors
+ */
+
+#include "test_utils.h"
+#include "../src/line_reader.h"
+
+#define TEST_FILE "/tmp/afc_test_line_reader.txt"
+#define EMPTY_FILE "/tmp/afc_test_line_reader_empty.txt"
+
+/* Reads all the lines of /chunks/ chunks and joins them with "|" */
+static char *read_all(LineReader *lr, int chunks)
+{
+	static char out[200000];
+	afc_strview line;
+	int chunk;
+
+	out[0] = '\0';
+
+	for (chunk = 0; chunk < chunks; chunk++)
+	{
+		if (afc_line_reader_open_chunk(lr, TEST_FILE, chunk, chunks) != AFC_ERR_NO_ERROR)
+			return (NULL);
+
+		while (afc_line_reader_next(lr, &line))
+		{
+			strncat(out, line.str, line.len);
+			strcat(out, "|");
+		}
+	}
+
+	afc_line_reader_close(lr);
+
+	return (out);
+}
+
+int main(void)
+{
+	AFC *afc = afc_new();
+	test_header();
+
+	static char expected[200000], content[200000];
+	afc_strview line;
+	char *res;
+	FILE *fh;
+	int t, chunks, errors;
+
+	/* ---- Test 1: Object creation ---- */
+	LineReader *lr = afc_line_reader_new();
+	print_res("line_reader_new() not NULL", (void *)(long)1, (void *)(long)(lr != NULL), 0);
+	print_res("next without file", (void *)(long)FALSE, (void *)(long)afc_line_reader_next(lr, &line), 0);
+
+	print_row();
+
+	/* ---- Test 2: Reading a small file ---- */
+	fh = fopen(TEST_FILE, "w");
+	fputs("first\nsecond\r\n\nfourth line\nlast", fh);
+	fclose(fh);
+
+	print_res("open", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_line_reader_open(lr, TEST_FILE), 0);
+	print_res("file is mapped", (void *)(long)1, (void *)(long)(lr->map != NULL), 0);
+	afc_line_reader_next(lr, &line);
+	print_res("line 1", (void *)(long)1, (void *)(long)afc_strview_equals(line, "first"), 0);
+	afc_line_reader_next(lr, &line);
+	print_res("line 2 without \\r", (void *)(long)1, (void *)(long)afc_strview_equals(line, "second"), 0);
+	afc_line_reader_next(lr, &line);
+	print_res("empty line", (void *)(long)0, (void *)(long)line.len, 0);
+	afc_line_reader_next(lr, &line);
+	print_res("line 4", (void *)(long)1, (void *)(long)afc_strview_equals(line, "fourth line"), 0);
+	print_res("last line without \\n", (void *)(long)TRUE, (void *)(long)afc_line_reader_next(lr, &line), 0);
+	print_res("last line", (void *)(long)1, (void *)(long)afc_strview_equals(line, "last"), 0);
+	print_res("end of file", (void *)(long)FALSE, (void *)(long)afc_line_reader_next(lr, &line), 0);
+	print_res("line_num", (void *)(long)5, (void *)(long)afc_line_reader_line_num(lr), 0);
+
+	afc_line_reader_set_tags(lr, AFC_LINE_READER_TAG_USE_MMAP, (void *)FALSE, AFC_LINE_READER_TAG_BLOCK_SIZE, (void *)16);
+	res = read_all(lr, 1);
+	print_res("block reads", "first|second||fourth line|last|", res, 1);
+
+	print_row();
+
+	/* ---- Test 3: Big file, long lines, chunks ---- */
+	content[0] = expected[0] = '\0';
+	srand(7);
+	for (t = 0; t < 3000; t++)
+	{
+		char buf[200];
+		int len = (t % 500 == 0) ? 150 : rand() % 40;
+
+		memset(buf, 'a' + t % 26, len);
+		buf[len] = '\0';
+		strcat(content, buf);
+		strcat(content, (t % 3) ? "\n" : "\r\n");
+		strcat(expected, buf);
+		strcat(expected, "|");
+	}
+
+	fh = fopen(TEST_FILE, "w");
+	fputs(content, fh);
+	fclose(fh);
+
+	/* Block size smaller than the longest lines: the buffer must grow */
+	errors = 0;
+	for (t = 0; t < 2; t++)
+	{
+		afc_line_reader_set_tag(lr, AFC_LINE_READER_TAG_USE_MMAP, (void *)(long)t);
+		for (chunks = 1; chunks <= 9; chunks++)
+			if (((res = read_all(lr, chunks)) == NULL) || (strcmp(res, expected) != 0))
+				errors++;
+	}
+	print_res("all chunks give all lines", (void *)(long)0, (void *)(long)errors, 0);
+
+	afc_line_reader_open_chunk(lr, TEST_FILE, 1, 4);
+	print_res("chunk starts on a line", (void *)(long)1, (void *)(long)((lr->start > 0) && (content[lr->start - 1] == '\n')), 0);
+	afc_line_reader_close(lr);
+
+	/* More chunks than lines: some chunks are empty */
+	fh = fopen(TEST_FILE, "w");
+	fputs("one\ntwo\n", fh);
+	fclose(fh);
+	res = read_all(lr, 7);
+	print_res("more chunks than lines", "one|two|", res, 1);
+
+	print_row();
+
+	/* ---- Test 4: Special files and errors ---- */
+	fh = fopen(EMPTY_FILE, "w");
+	fclose(fh);
+	afc_line_reader_open(lr, EMPTY_FILE);
+	print_res("empty file", (void *)(long)FALSE, (void *)(long)afc_line_reader_next(lr, &line), 0);
+
+	print_res("open missing file", (void *)(long)AFC_LINE_READER_ERR_OPEN, (void *)(long)afc_line_reader_open(lr, "/tmp/__afc_no_such_file__"), 0);
+	print_res("invalid chunk", (void *)(long)AFC_LINE_READER_ERR_INVALID_CHUNK, (void *)(long)afc_line_reader_open_chunk(lr, TEST_FILE, 3, 3), 0);
+	print_res("chunks of a device", (void *)(long)AFC_LINE_READER_ERR_INVALID_CHUNK, (void *)(long)afc_line_reader_open_chunk(lr, "/dev/null", 0, 2), 0);
+
+	/* A device cannot be mapped: it is read in blocks */
+	print_res("open device", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_line_reader_open(lr, "/dev/null"), 0);
+	print_res("device not mapped", NULL, lr->map, 0);
+	print_res("device is empty", (void *)(long)FALSE, (void *)(long)afc_line_reader_next(lr, &line), 0);
+
+	unlink(TEST_FILE);
+	unlink(EMPTY_FILE);
+
+	print_summary();
+
+	afc_line_reader_delete(lr);
+	afc_delete(afc);
+
+	return get_test_failures() > 0 ? 1 : 0;
+}
@@ -24,11 +24,38 @@
  * Tests cover creation, insertion at HEAD/TAIL/HERE, traversal
  * (first/next/prev/last), obj(), is_empty(), del(), item() by position,
  * push()/pop() stack, and clear().
+ * The unrolled storage is checked against the node storage with the same
+ * random operations, then on its own (sorts, Arena, clone, errors).
+ * The ordinal index is checked the same way, on both storages.
  */
 
 #include "test_utils.h"
 #include "../src/list.h"
 
+static signed long comp_long(void *a, void *b, void *info)
+{
+	return ((long)a > (long)b) - ((long)a < (long)b);
+}
+
+/* Returns the number of broken chunks: empty ones, or counts that do not add up to the list length */
+static int check_chunks(List *nm)
+{
+	struct afc_list_chunk *c;
+	unsigned long num = 0;
+	int errors = 0;
+
+	for (c = nm->first_chunk; c; c = c->next)
+	{
+		if ((c->count == 0) || (c->count > AFC_LIST_CHUNK_ITEMS))
+			errors++;
+		if ((c->next == NULL) && (c != nm->last_chunk))
+			errors++;
+		num += c->count;
+	}
+
+	return errors + (num != nm->num);
+}
+
 int main(void)
 {
 	AFC *afc = afc_new();
@@ -240,6 +267,294 @@ int main(void)
 	s = (char *)afc_list_obj(nm);
 	print_res("pos unchanged after pop(F)", "two", s, 1);
 
+	print_row();
+
+	/* ----------------------------------------------------------------
+	 * 14. Unrolled storage against node storage
+	 * ---------------------------------------------------------------- */
+	{
+		List *a = afc_list_new(), *b = afc_list_new();
+		long t, v, va, vb, next_val = 1;
+		int errors = 0, op, k, pushed;
+		unsigned long n;
+
+		print_res("set_unrolled on non empty", (void *)(long)AFC_LIST_ERR_NOT_EMPTY, (void *)(long)afc_list_set_unrolled(nm, TRUE), 0);
+		print_res("set_unrolled", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_list_set_unrolled(b, TRUE), 0);
+		print_res("unrolled is empty", (void *)(long)1, (void *)(long)afc_list_is_empty(b), 0);
+		print_res("unrolled first on empty", NULL, afc_list_first(b), 0);
+		print_res("unrolled del on empty", NULL, afc_list_del(b), 0);
+
+		srand(42);
+		for (t = 0; t < 50000; t++)
+		{
+			op = rand() % 12;
+			va = vb = 0;
+
+			switch (op)
+			{
+			case 0:
+			case 1:
+				va = (long)afc_list_add(a, (void *)next_val, AFC_LIST_ADD_TAIL);
+				vb = (long)afc_list_add(b, (void *)next_val++, AFC_LIST_ADD_TAIL);
+				break;
+			case 2:
+				va = (long)afc_list_add(a, (void *)next_val, AFC_LIST_ADD_HEAD);
+				vb = (long)afc_list_add(b, (void *)next_val++, AFC_LIST_ADD_HEAD);
+				break;
+			case 3:
+			case 4:
+				va = (long)afc_list_insert(a, (void *)next_val);
+				vb = (long)afc_list_insert(b, (void *)next_val++);
+				break;
+			case 5:
+			case 6:
+				va = (long)afc_list_del(a);
+				vb = (long)afc_list_del(b);
+				break;
+			case 7:
+				va = (long)afc_list_next(a);
+				vb = (long)afc_list_next(b);
+				break;
+			case 8:
+				va = (long)afc_list_prev(a);
+				vb = (long)afc_list_prev(b);
+				break;
+			case 9:
+				n = rand() % (afc_list_len(a) + 2);
+				va = (long)afc_list_item(a, n);
+				vb = (long)afc_list_item(b, n);
+				break;
+			case 10:
+				/* A node pushed twice and then deleted would stay in the node stack */
+				for (pushed = FALSE, k = 0; k < a->sposcount; k++)
+					if (a->spos[k] == a->pos)
+						pushed = TRUE;
+				if (!pushed && !afc_list_is_empty(a))
+				{
+					va = afc_list_push(a);
+					vb = afc_list_push(b);
+				}
+				break;
+			case 11:
+				va = (long)afc_list_pop(a, TRUE);
+				vb = (long)afc_list_pop(b, TRUE);
+				break;
+			}
+
+			if ((va != vb) || (afc_list_len(a) != afc_list_len(b)) || (afc_list_obj(a) != afc_list_obj(b)))
+				errors++;
+			else if (!afc_list_is_empty(a) && ((afc_list_pos(a) != afc_list_pos(b)) || (afc_list_is_first(a) != afc_list_is_first(b)) || (afc_list_is_last(a) != afc_list_is_last(b))))
+				errors++;
+		}
+		print_res("same results as nodes", (void *)(long)0, (void *)(long)errors, 0);
+		print_res("same length", (void *)(long)afc_list_len(a), (void *)(long)afc_list_len(b), 0);
+		print_res("chunks are sound", (void *)(long)0, (void *)(long)check_chunks(b), 0);
+
+		errors = 0;
+		for (va = (long)afc_list_first(a), vb = (long)afc_list_first(b); va; va = (long)afc_list_next(a), vb = (long)afc_list_next(b))
+			if (va != vb)
+				errors++;
+		print_res("same items", (void *)(long)0, (void *)(long)(errors + (vb != 0)), 0);
+
+		errors = 0;
+		for (va = (long)afc_list_last(a), vb = (long)afc_list_last(b); va; va = (long)afc_list_prev(a), vb = (long)afc_list_prev(b))
+			if (va != vb)
+				errors++;
+		print_res("same items backwards", (void *)(long)0, (void *)(long)(errors + (vb != 0)), 0);
+
+		print_res("no nodes to get", NULL, (void *)afc_list_get(b), 0);
+		print_res("no array", NULL, (void *)afc_list_create_array(b), 0);
+
+		afc_list_sort(a, comp_long, NULL);
+		afc_list_item(b, 100);
+		afc_list_sort(b, comp_long, NULL);
+		print_res("sort goes to first", (void *)(long)0, (void *)(long)afc_list_pos(b), 0);
+		errors = 0;
+		for (va = (long)afc_list_first(a), vb = (long)afc_list_first(b); va; va = (long)afc_list_next(a), vb = (long)afc_list_next(b))
+			if (va != vb)
+				errors++;
+		print_res("same sort", (void *)(long)0, (void *)(long)errors, 0);
+
+		afc_list_delete(a);
+
+		/* ----------------------------------------------------------------
+		 * 15. Unrolled storage: indexed access, deletes and clear
+		 * ---------------------------------------------------------------- */
+		afc_list_clear(b);
+		for (t = 0; t < 10000; t++)
+			afc_list_add_tail(b, (void *)(t + 1));
+		print_res("unrolled len", (void *)(long)10000, (void *)(long)afc_list_len(b), 0);
+		print_res("full chunks", (void *)(long)((10000 + AFC_LIST_CHUNK_ITEMS - 1) / AFC_LIST_CHUNK_ITEMS), (void *)(long)((10000 - b->last_chunk->count) / AFC_LIST_CHUNK_ITEMS + 1), 0);
+
+		errors = 0;
+		for (t = 0; t < 10000; t += 7)
+			if ((long)afc_list_item(b, (t * 7919) % 10000) != (t * 7919) % 10000 + 1)
+				errors++;
+		print_res("item()", (void *)(long)0, (void *)(long)errors, 0);
+		print_res("item() past the end", (void *)(long)10000, afc_list_item(b, 20000), 0);
+
+		afc_list_item(b, 100);
+		afc_list_push(b);
+		afc_list_first(b);
+		afc_list_insert(b, (void *)-1L);
+		afc_list_first(b);
+		afc_list_del(b);
+		afc_list_del(b);
+		print_res("pop after insert and del", (void *)(long)101, afc_list_pop(b, TRUE), 0);
+		print_res("pop position", (void *)(long)99, (void *)(long)afc_list_pos(b), 0);
+
+		/* Deleting every other item merges the chunks */
+		for (v = (long)afc_list_first(b); v; v = (long)afc_list_next(b))
+			afc_list_del(b);
+		print_res("len after deletes", (void *)(long)4999, (void *)(long)afc_list_len(b), 0);
+		print_res("chunks after deletes", (void *)(long)0, (void *)(long)check_chunks(b), 0);
+		print_res("items after deletes", (void *)(long)5, afc_list_item(b, 1), 0);
+
+		afc_list_clear(b);
+		print_res("unrolled clear", (void *)(long)1, (void *)(long)(afc_list_is_empty(b) && (b->first_chunk == NULL)), 0);
+		afc_list_add_head(b, (void *)7L);
+		print_res("add after clear", (void *)(long)7, afc_list_first(b), 0);
+
+		a = afc_list_clone(b);
+		print_res("clone is unrolled", (void *)(long)1, (void *)(long)(a->unrolled && (afc_list_len(a) == 1)), 0);
+		afc_list_delete(a);
+
+		/* ----------------------------------------------------------------
+		 * 16. Unrolled storage bound to an Arena
+		 * ---------------------------------------------------------------- */
+		{
+			Arena *arena = afc_arena_new();
+
+			afc_list_clear(b);
+			print_res("set_arena on unrolled", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_list_set_arena(b, arena), 0);
+			for (t = 0; t < 1000; t++)
+				afc_list_add_head(b, (void *)(t + 1));
+			for (afc_list_first(b), t = 0; t < 500; t++)
+				afc_list_del(b);
+			for (t = 0; t < 500; t++)
+				afc_list_add_tail(b, (void *)(t + 1));
+			print_res("arena len", (void *)(long)1000, (void *)(long)afc_list_len(b), 0);
+			print_res("arena chunks", (void *)(long)0, (void *)(long)check_chunks(b), 0);
+			print_res("arena items", (void *)(long)500, afc_list_first(b), 0);
+
+			afc_list_clear(b);
+			afc_arena_reset(arena);
+			afc_list_add_tail(b, (void *)9L);
+			print_res("add after arena reset", (void *)(long)9, afc_list_last(b), 0);
+
+			afc_list_delete(b);
+			afc_arena_delete(arena);
+		}
+	}
+
+	/* ----------------------------------------------------------------
+	 * 17. Ordinal index, on nodes and on unrolled storage
+	 * ---------------------------------------------------------------- */
+	{
+		List *a = afc_list_new(), *b = afc_list_new(), *c = afc_list_new();
+		long va, vb, vc, next_val = 1;
+		unsigned long n;
+		int t, errors = 0;
+
+		print_res("set_index(NULL)", (void *)(long)AFC_ERR_NULL_POINTER, (void *)(long)afc_list_set_index(NULL, TRUE), 0);
+		afc_list_set_unrolled(c, TRUE);
+		print_res("set_index on nodes", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_list_set_index(b, TRUE), 0);
+		print_res("set_index on unrolled", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_list_set_index(c, TRUE), 0);
+
+		srand(25);
+		for (t = 0; t < 50000; t++)
+		{
+			va = vb = vc = 0;
+
+			switch (rand() % 8)
+			{
+			case 0:
+			case 1:
+				va = (long)afc_list_add(a, (void *)next_val, AFC_LIST_ADD_HERE);
+				vb = (long)afc_list_add(b, (void *)next_val, AFC_LIST_ADD_HERE);
+				vc = (long)afc_list_add(c, (void *)next_val++, AFC_LIST_ADD_HERE);
+				break;
+			case 2:
+				va = (long)afc_list_add(a, (void *)next_val, AFC_LIST_ADD_HEAD);
+				vb = (long)afc_list_add(b, (void *)next_val, AFC_LIST_ADD_HEAD);
+				vc = (long)afc_list_add(c, (void *)next_val++, AFC_LIST_ADD_HEAD);
+				break;
+			case 3:
+				va = (long)afc_list_del(a);
+				vb = (long)afc_list_del(b);
+				vc = (long)afc_list_del(c);
+				break;
+			case 4:
+			case 5:
+				n = rand() % (afc_list_len(a) + 2);
+				va = (long)afc_list_item(a, n);
+				vb = (long)afc_list_item(b, n);
+				vc = (long)afc_list_item(c, n);
+				break;
+			case 6:
+				if (!afc_list_is_empty(a))
+				{
+					n = rand() % afc_list_len(a);
+					afc_list_item(a, n);
+					afc_list_change_numerical_pos(b, n);
+					afc_list_change_numerical_pos(c, n);
+					va = (long)afc_list_obj(a);
+					vb = (long)afc_list_obj(b);
+					vc = (long)afc_list_obj(c);
+				}
+				break;
+			case 7:
+				va = (long)afc_list_next(a);
+				vb = (long)afc_list_next(b);
+				vc = (long)afc_list_next(c);
+				break;
+			}
+
+			if ((va != vb) || (va != vc) || (afc_list_len(a) != afc_list_len(c)) || (afc_list_pos(a) != afc_list_pos(b)) || (afc_list_pos(a) != afc_list_pos(c)))
+				errors++;
+		}
+		print_res("indexed same results", (void *)(long)0, (void *)(long)errors, 0);
+		print_res("indexed nodes index", (void *)(long)afc_list_len(a), (void *)(long)(b->index ? b->index->sum : 0), 0);
+		print_res("indexed unrolled index", (void *)(long)afc_list_len(a), (void *)(long)(c->index ? c->index->sum : 0), 0);
+		print_res("indexed chunks", (void *)(long)0, (void *)(long)check_chunks(c), 0);
+
+		/* The index of a filled List is built on the items it already has */
+		afc_list_set_index(b, FALSE);
+		afc_list_set_index(c, FALSE);
+		print_res("index freed", NULL, (void *)(b->index ? b->index : c->index), 0);
+		for (t = 0; t < 1000; t++)
+		{
+			afc_list_add_tail(b, (void *)(long)t);
+			afc_list_add_tail(c, (void *)(long)t);
+		}
+		afc_list_set_index(b, TRUE);
+		afc_list_set_index(c, TRUE);
+
+		errors = 0;
+		for (n = 0; n < afc_list_len(a); n += 37)
+		{
+			va = (long)afc_list_item(a, n);
+			if ((va != (long)afc_list_item(b, n)) || (va != (long)afc_list_item(c, n)))
+				errors++;
+		}
+		print_res("index of filled lists", (void *)(long)0, (void *)(long)errors, 0);
+		print_res("item() past the end", (void *)(long)999, afc_list_item(c, afc_list_len(c) + 5), 0);
+
+		afc_list_sort(b, comp_long, NULL);
+		afc_list_sort(c, comp_long, NULL);
+		print_res("indexed sort", (void *)(long)1, afc_list_item(b, 1), 0);
+		print_res("indexed unrolled sort", (void *)(long)1, afc_list_item(c, 1), 0);
+
+		afc_list_clear(c);
+		print_res("index after clear", NULL, (void *)c->index, 0);
+		afc_list_add_tail(c, (void *)5L);
+		print_res("add after clear", (void *)(long)5, afc_list_item(c, 0), 0);
+
+		afc_list_delete(a);
+		afc_list_delete(b);
+		afc_list_delete(c);
+	}
+
 	/* ----------------------------------------------------------------
 	 * Cleanup
 	 * ---------------------------------------------------------------- */
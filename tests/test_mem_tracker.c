@@ -28,11 +28,43 @@
  *   - Basic allocation/deallocation cycles
  *   - Tracker statistics (allocs, frees, alloc_bytes)
  *   - Multiple allocations and selective freeing
+ *   - Shard tables growth and tracking from several threads
+ *   - Allocation sites report
  */
 
 #include "test_utils.h"
 #include "../src/mem_tracker.h"
 
+#include <pthread.h>
+
+/* Allocates, reallocates and frees 1000 blocks */
+static void *thread_worker(void *data)
+{
+	void *mem[1000];
+	int t;
+
+	for (t = 0; t < 1000; t++)
+		mem[t] = afc_malloc(16 + (t % 64));
+
+	for (t = 0; t < 1000; t += 2)
+		mem[t] = afc_realloc(mem[t], 256);
+
+	for (t = 0; t < 1000; t++)
+		afc_free(mem[t]);
+
+	return (NULL);
+}
+
+/* Sums the counters of all the tracker shards */
+static MemTrackerStats tracker_stats(MemTracker *mt)
+{
+	MemTrackerStats stats;
+
+	afc_mem_tracker_get_stats(mt, &stats);
+
+	return stats;
+}
+
 int main(void)
 {
 	AFC *afc = afc_new();
@@ -95,28 +127,25 @@ int main(void)
 		(void *)(long)tracker->show_frees,
 		0);
 
-	/* data array should be allocated (non-NULL). */
-	print_res("data array allocated",
-		(void *)(long)1,
-		(void *)(long)(tracker->data != NULL),
-		0);
+	/* The data and free arrays (and data_max, free_max) are gone:
+	 * every shard has its hash table, with the initial number of buckets. */
+	{
+		int t, ok = 1;
 
-	/* free list should be allocated (non-NULL). */
-	print_res("free list allocated",
-		(void *)(long)1,
-		(void *)(long)(tracker->free != NULL),
-		0);
+		for (t = 0; t < AFC_MEMTRACK_SHARDS; t++)
+			if ((tracker->shards[t].hash_table == NULL) || (tracker->shards[t].hash_size < AFC_MEMTRACK_HASH_SIZE))
+				ok = 0;
 
-	/* data_max should be 200 (initial capacity). */
-	print_res("data_max == 200",
-		(void *)(long)200,
-		(void *)(long)tracker->data_max,
-		0);
+		print_res("shards allocated",
+			(void *)(long)1,
+			(void *)(long)ok,
+			0);
+	}
 
-	/* free_max should be 100 (initial capacity). */
-	print_res("free_max == 100",
-		(void *)(long)100,
-		(void *)(long)tracker->free_max,
+	/* get_stats() checks its arguments. */
+	print_res("get_stats NULL",
+		(void *)(long)AFC_ERR_NULL_POINTER,
+		(void *)(long)afc_mem_tracker_get_stats(tracker, NULL),
 		0);
 
 	print_row();
@@ -126,9 +155,9 @@ int main(void)
 	 * =================================================================== */
 
 	/* Record baseline stats before our test allocations. */
-	initial_allocs = tracker->allocs;
-	initial_frees = tracker->frees;
-	initial_bytes = tracker->alloc_bytes;
+	initial_allocs = tracker_stats(tracker).allocs;
+	initial_frees = tracker_stats(tracker).frees;
+	initial_bytes = tracker_stats(tracker).alloc_bytes;
 
 	/* Allocate a 64-byte block. */
 	mem1 = afc_malloc(64);
@@ -140,13 +169,23 @@ int main(void)
 	/* After one allocation, allocs counter should increase by 1. */
 	print_res("allocs +1",
 		(void *)(long)(initial_allocs + 1),
-		(void *)(long)tracker->allocs,
+		(void *)(long)tracker_stats(tracker).allocs,
+		0);
+
+	print_res("allocs +1 (compat)",
+		(void *)(long)(initial_allocs + 1),
+		(void *)(long)afc_mem_tracker_allocs(tracker),
 		0);
 
 	/* Allocated bytes should increase by 64. */
 	print_res("alloc_bytes +64",
 		(void *)(long)(initial_bytes + 64),
-		(void *)(long)tracker->alloc_bytes,
+		(void *)(long)tracker_stats(tracker).alloc_bytes,
+		0);
+
+	print_res("alloc_bytes +64 (compat)",
+		(void *)(long)(initial_bytes + 64),
+		(void *)(long)afc_mem_tracker_alloc_bytes(tracker),
 		0);
 
 	/* Free the block. */
@@ -155,13 +194,23 @@ int main(void)
 	/* Frees counter should increase by 1. */
 	print_res("frees +1",
 		(void *)(long)(initial_frees + 1),
-		(void *)(long)tracker->frees,
+		(void *)(long)tracker_stats(tracker).frees,
+		0);
+
+	print_res("frees +1 (compat)",
+		(void *)(long)(initial_frees + 1),
+		(void *)(long)afc_mem_tracker_frees(tracker),
 		0);
 
 	/* Allocated bytes should return to baseline. */
 	print_res("alloc_bytes restored",
 		(void *)(long)initial_bytes,
-		(void *)(long)tracker->alloc_bytes,
+		(void *)(long)tracker_stats(tracker).alloc_bytes,
+		0);
+
+	print_res("alloc_bytes restored (compat)",
+		(void *)(long)initial_bytes,
+		(void *)(long)afc_mem_tracker_alloc_bytes(tracker),
 		0);
 
 	print_row();
@@ -171,9 +220,9 @@ int main(void)
 	 * =================================================================== */
 
 	/* Record baseline again. */
-	initial_allocs = tracker->allocs;
-	initial_frees = tracker->frees;
-	initial_bytes = tracker->alloc_bytes;
+	initial_allocs = tracker_stats(tracker).allocs;
+	initial_frees = tracker_stats(tracker).frees;
+	initial_bytes = tracker_stats(tracker).alloc_bytes;
 
 	/* Allocate three blocks. */
 	mem1 = afc_malloc(32);
@@ -199,13 +248,23 @@ int main(void)
 	/* Allocs counter should have increased by 3. */
 	print_res("allocs +3",
 		(void *)(long)(initial_allocs + 3),
-		(void *)(long)tracker->allocs,
+		(void *)(long)tracker_stats(tracker).allocs,
+		0);
+
+	print_res("allocs +3 (compat)",
+		(void *)(long)(initial_allocs + 3),
+		(void *)(long)afc_mem_tracker_allocs(tracker),
 		0);
 
 	/* Total allocated bytes: +32 + 64 + 128 = +224. */
 	print_res("alloc_bytes +224",
 		(void *)(long)(initial_bytes + 224),
-		(void *)(long)tracker->alloc_bytes,
+		(void *)(long)tracker_stats(tracker).alloc_bytes,
+		0);
+
+	print_res("alloc_bytes +224 (compat)",
+		(void *)(long)(initial_bytes + 224),
+		(void *)(long)afc_mem_tracker_alloc_bytes(tracker),
 		0);
 
 	/* Free the middle block. */
@@ -214,13 +273,23 @@ int main(void)
 	/* Frees counter should increase by 1. */
 	print_res("free middle frees +1",
 		(void *)(long)(initial_frees + 1),
-		(void *)(long)tracker->frees,
+		(void *)(long)tracker_stats(tracker).frees,
+		0);
+
+	print_res("free middle frees +1 (compat)",
+		(void *)(long)(initial_frees + 1),
+		(void *)(long)afc_mem_tracker_frees(tracker),
 		0);
 
 	/* Allocated bytes should decrease by 64. */
 	print_res("alloc_bytes after mid free",
 		(void *)(long)(initial_bytes + 160),
-		(void *)(long)tracker->alloc_bytes,
+		(void *)(long)tracker_stats(tracker).alloc_bytes,
+		0);
+
+	print_res("alloc_bytes after mid free (compat)",
+		(void *)(long)(initial_bytes + 160),
+		(void *)(long)afc_mem_tracker_alloc_bytes(tracker),
 		0);
 
 	/* Free the remaining blocks. */
@@ -230,13 +299,23 @@ int main(void)
 	/* Frees counter should have increased by 3 total. */
 	print_res("frees +3 total",
 		(void *)(long)(initial_frees + 3),
-		(void *)(long)tracker->frees,
+		(void *)(long)tracker_stats(tracker).frees,
+		0);
+
+	print_res("frees +3 total (compat)",
+		(void *)(long)(initial_frees + 3),
+		(void *)(long)afc_mem_tracker_frees(tracker),
 		0);
 
 	/* Allocated bytes should be back to baseline. */
 	print_res("alloc_bytes baseline",
 		(void *)(long)initial_bytes,
-		(void *)(long)tracker->alloc_bytes,
+		(void *)(long)tracker_stats(tracker).alloc_bytes,
+		0);
+
+	print_res("alloc_bytes baseline (compat)",
+		(void *)(long)initial_bytes,
+		(void *)(long)afc_mem_tracker_alloc_bytes(tracker),
 		0);
 
 	print_row();
@@ -302,7 +381,7 @@ int main(void)
 	 * SECTION 7: Allocation-then-reallocation tracking
 	 * =================================================================== */
 
-	initial_bytes = tracker->alloc_bytes;
+	initial_bytes = tracker_stats(tracker).alloc_bytes;
 
 	/* Allocate a small block. */
 	mem1 = afc_malloc(32);
@@ -313,7 +392,12 @@ int main(void)
 
 	print_res("realloc: bytes +32",
 		(void *)(long)(initial_bytes + 32),
-		(void *)(long)tracker->alloc_bytes,
+		(void *)(long)tracker_stats(tracker).alloc_bytes,
+		0);
+
+	print_res("realloc: bytes +32 (compat)",
+		(void *)(long)(initial_bytes + 32),
+		(void *)(long)afc_mem_tracker_alloc_bytes(tracker),
 		0);
 
 	/* Realloc to a larger size. The tracker should update the tracked size. */
@@ -326,7 +410,12 @@ int main(void)
 	/* After realloc, bytes should reflect the new size (128) instead of old (32). */
 	print_res("realloc: bytes updated",
 		(void *)(long)(initial_bytes + 128),
-		(void *)(long)tracker->alloc_bytes,
+		(void *)(long)tracker_stats(tracker).alloc_bytes,
+		0);
+
+	print_res("realloc: bytes updated (compat)",
+		(void *)(long)(initial_bytes + 128),
+		(void *)(long)afc_mem_tracker_alloc_bytes(tracker),
 		0);
 
 	/* Free the reallocated block. */
@@ -335,7 +424,12 @@ int main(void)
 	/* After free, bytes should return to baseline. */
 	print_res("realloc: bytes restored",
 		(void *)(long)initial_bytes,
-		(void *)(long)tracker->alloc_bytes,
+		(void *)(long)tracker_stats(tracker).alloc_bytes,
+		0);
+
+	print_res("realloc: bytes restored (compat)",
+		(void *)(long)initial_bytes,
+		(void *)(long)afc_mem_tracker_alloc_bytes(tracker),
 		0);
 
 	print_row();
@@ -344,7 +438,7 @@ int main(void)
 	 * SECTION 8: String allocations are also tracked
 	 * =================================================================== */
 
-	initial_allocs = tracker->allocs;
+	initial_allocs = tracker_stats(tracker).allocs;
 
 	/* AFC strings use afc_malloc internally, so they should be tracked. */
 	{
@@ -353,7 +447,12 @@ int main(void)
 		/* String allocation should increase alloc count. */
 		print_res("str alloc tracked",
 			(void *)(long)1,
-			(void *)(long)(tracker->allocs > initial_allocs),
+			(void *)(long)(tracker_stats(tracker).allocs > initial_allocs),
+			0);
+
+		print_res("str alloc tracked (compat)",
+			(void *)(long)1,
+			(void *)(long)(afc_mem_tracker_allocs(tracker) > initial_allocs),
 			0);
 
 		/* Verify string works correctly while tracked. */
@@ -364,14 +463,160 @@ int main(void)
 			1);
 
 		/* Free the string. */
-		initial_frees = tracker->frees;
+		initial_frees = tracker_stats(tracker).frees;
 		afc_string_delete(str);
 
 		/* String deallocation should increase free count. */
 		print_res("str free tracked",
 			(void *)(long)1,
-			(void *)(long)(tracker->frees > initial_frees),
+			(void *)(long)(tracker_stats(tracker).frees > initial_frees),
+			0);
+
+		print_res("str free tracked (compat)",
+			(void *)(long)1,
+			(void *)(long)(afc_mem_tracker_frees(tracker) > initial_frees),
+			0);
+	}
+
+	print_row();
+
+	/* ===================================================================
+	 * SECTION 9: Many blocks and many threads
+	 * =================================================================== */
+
+	{
+		MemTrackerStats before = tracker_stats(tracker);
+		pthread_t threads[4];
+		void *mem[5000];
+		int t, grown = 0;
+
+		/* Shards tables grow instead of making long chains. */
+		for (t = 0; t < 5000; t++)
+			mem[t] = afc_malloc(8);
+
+		for (t = 0; t < AFC_MEMTRACK_SHARDS; t++)
+			if (tracker->shards[t].hash_size > AFC_MEMTRACK_HASH_SIZE)
+				grown = 1;
+
+		print_res("shards grown",
+			(void *)(long)1,
+			(void *)(long)grown,
+			0);
+
+		print_res("5000 blocks tracked",
+			(void *)(long)(before.blocks + 5000),
+			(void *)(long)tracker_stats(tracker).blocks,
+			0);
+
+		for (t = 0; t < 5000; t++)
+			afc_free(mem[t]);
+
+		/* Threads allocating at the same time are all tracked. */
+		for (t = 0; t < 4; t++)
+			pthread_create(&threads[t], NULL, thread_worker, NULL);
+		for (t = 0; t < 4; t++)
+			pthread_join(threads[t], NULL);
+
+		print_res("threads allocs",
+			(void *)(long)(before.allocs + 5000 + 4 * 1000),
+			(void *)(long)tracker_stats(tracker).allocs,
+			0);
+
+		print_res("threads bytes restored",
+			(void *)(long)before.alloc_bytes,
+			(void *)(long)tracker_stats(tracker).alloc_bytes,
+			0);
+
+		print_res("threads blocks restored",
+			(void *)(long)before.blocks,
+			(void *)(long)tracker_stats(tracker).blocks,
+			0);
+	}
+
+	print_row();
+
+	/* ===================================================================
+	 * SECTION 10: Allocation sites report
+	 * =================================================================== */
+
+	{
+		char line[1024], *big[3], *small;
+		FILE *f;
+		int t, found = 0, first_big = 0, lines = 0;
+
+		/* One site holding 3 * 4000 bytes, another one 10 bytes. */
+		for (t = 0; t < 3; t++)
+			big[t] = afc_malloc(4000);
+		small = afc_malloc(10);
+
+		f = tmpfile();
+		print_res("report CSV",
+			(void *)(long)AFC_ERR_NO_ERROR,
+			(void *)(long)afc_mem_tracker_report(tracker, f, AFC_MEM_TRACKER_REPORT_CSV, AFC_MEM_TRACKER_SORT_LIVE),
+			0);
+
+		rewind(f);
+		while (fgets(line, sizeof(line), f))
+		{
+			lines++;
+			if ((lines == 2) && strstr(line, "test_mem_tracker.c") && strstr(line, ",12000,12000,3,0,12000,"))
+				first_big = 1;
+			if (strstr(line, "test_mem_tracker.c") && strstr(line, ",10,10,1,0,10,"))
+				found = 1;
+		}
+		fclose(f);
+
+		print_res("CSV biggest site first",
+			(void *)(long)1,
+			(void *)(long)first_big,
+			0);
+
+		print_res("CSV small site listed",
+			(void *)(long)1,
+			(void *)(long)found,
+			0);
+
+		/* Live bytes go down on free, peak stays. */
+		for (t = 0; t < 3; t++)
+			afc_free(big[t]);
+		afc_free(small);
+
+		f = tmpfile();
+		afc_mem_tracker_report(tracker, f, AFC_MEM_TRACKER_REPORT_CSV, AFC_MEM_TRACKER_SORT_PEAK);
+		rewind(f);
+		found = 0;
+		while (fgets(line, sizeof(line), f))
+			if (strstr(line, "test_mem_tracker.c") && strstr(line, ",0,12000,3,3,12000,"))
+				found = 1;
+		fclose(f);
+
+		print_res("peak kept after free",
+			(void *)(long)1,
+			(void *)(long)found,
+			0);
+
+		f = tmpfile();
+		afc_mem_tracker_report(tracker, f, AFC_MEM_TRACKER_REPORT_TEXT, AFC_MEM_TRACKER_SORT_ALLOCS);
+		rewind(f);
+		found = (fgets(line, sizeof(line), f) != NULL) && (strncmp(line, "MemTracker report", 17) == 0);
+		fclose(f);
+
+		print_res("text report header",
+			(void *)(long)1,
+			(void *)(long)found,
+			0);
+
+		print_res("report NULL file",
+			(void *)(long)AFC_ERR_NULL_POINTER,
+			(void *)(long)afc_mem_tracker_report(tracker, NULL, AFC_MEM_TRACKER_REPORT_TEXT, AFC_MEM_TRACKER_SORT_LIVE),
+			0);
+
+		afc_set_tag(afc, AFC_TAG_MEM_REPORT, stderr);
+		print_res("AFC_TAG_MEM_REPORT",
+			(void *)(long)stderr,
+			(void *)(long)tracker->report_file,
 			0);
+		afc_set_tag(afc, AFC_TAG_MEM_REPORT, NULL);
 	}
 
 	print_summary();
@@ -0,0 +1,272 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/**
+ * test_parallel_sort.c - Tests for the parallel sort.
+ *
+ * Tests cover:
+ *   - Number of threads used by a sort
+ *   - afc_parallel_sort_r() on ints, on items that are not pointer sized, and its stability
+ *   - afc_parallel_sort() against qsort()
+ *   - Array, List and StringList sorts of big containers
+ *
+ * The number of threads is forced to 4, so the parallel code runs on single CPU machines too.
+ */
+
+#include "test_utils.h"
+#include "../src/parallel_sort.h"
+#include "../src/array.h"
+#include "../src/list.h"
+#include "../src/string_list.h"
+
+#define BIG (AFC_PARALLEL_SORT_MIN_ITEMS * 4 + 13)
+
+struct item
+{
+	int key;
+	int seq;
+	char pad[4];
+};
+
+static int comp_int_r(const void *a, const void *b, void *info)
+{
+	int ia = *(const int *)a, ib = *(const int *)b;
+
+	/* Without the right info, nothing gets sorted */
+	if (*(const long *)info != 42)
+		return 0;
+
+	return (ia > ib) - (ia < ib);
+}
+
+static int comp_item_r(const void *a, const void *b, void *info)
+{
+	return ((const struct item *)a)->key - ((const struct item *)b)->key;
+}
+
+static int comp_int(const void *a, const void *b)
+{
+	int ia = *(const int *)a, ib = *(const int *)b;
+
+	return (ia > ib) - (ia < ib);
+}
+
+static int comp_str(const void *a, const void *b)
+{
+	return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static signed long comp_list(void *a, void *b, void *info)
+{
+	return strcmp((char *)a, (char *)b);
+}
+
+static int check_sorted(char **strs, unsigned long n)
+{
+	unsigned long t;
+	int errors = 0;
+
+	for (t = 1; t < n; t++)
+		if (strcmp(strs[t - 1], strs[t]) > 0)
+			errors++;
+
+	return errors;
+}
+
+int main(void)
+{
+	AFC *afc = afc_new();
+	test_header();
+
+	static int ints[BIG], ref[BIG];
+	static struct item items[BIG];
+	static char strs[BIG][12];
+	static char *ptrs[BIG];
+	int t, errors, n;
+	long calls;
+	Array *am;
+	List *nm;
+	StringList *sn;
+	char *s, *prev;
+
+	/* ---- Test 1: Number of threads ---- */
+	print_res("set_threads(-1)", (void *)(long)AFC_ERR_INVALID_POINTER, (void *)(long)afc_parallel_sort_set_threads(-1), 0);
+	print_res("set_threads(4)", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_parallel_sort_set_threads(4), 0);
+	print_res("threads for small sort", (void *)(long)1, (void *)(long)afc_parallel_sort_threads(100), 0);
+	print_res("threads for 2 slices", (void *)(long)2, (void *)(long)afc_parallel_sort_threads(AFC_PARALLEL_SORT_MIN_ITEMS * 2), 0);
+	print_res("threads for big sort", (void *)(long)4, (void *)(long)afc_parallel_sort_threads(BIG * 10), 0);
+
+	print_row();
+
+	/* ---- Test 2: afc_parallel_sort_r() ---- */
+	srand(42);
+	for (t = 0; t < BIG; t++)
+		ints[t] = ref[t] = rand() % 100000;
+
+	calls = 42;
+	print_res("sort_r", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_parallel_sort_r(ints, BIG, sizeof(int), comp_int_r, &calls), 0);
+	qsort(ref, BIG, sizeof(int), comp_int);
+	print_res("same as qsort", (void *)(long)0, (void *)(long)memcmp(ints, ref, sizeof(ints)), 0);
+
+	afc_parallel_sort_r(ints, BIG, sizeof(int), comp_int_r, &calls);
+	print_res("sort of sorted", (void *)(long)0, (void *)(long)memcmp(ints, ref, sizeof(ints)), 0);
+
+	for (t = 0; t < BIG; t++)
+		ints[t] = BIG - t;
+	afc_parallel_sort_r(ints, BIG, sizeof(int), comp_int_r, &calls);
+	errors = 0;
+	for (t = 0; t < BIG; t++)
+		if (ints[t] != t + 1)
+			errors++;
+	print_res("reversed", (void *)(long)0, (void *)(long)errors, 0);
+
+	ints[0] = 2;
+	ints[1] = 1;
+	afc_parallel_sort_r(ints, 1, sizeof(int), comp_int_r, &calls);
+	print_res("one item", (void *)(long)2, (void *)(long)ints[0], 0);
+	afc_parallel_sort_r(ints, 2, sizeof(int), comp_int_r, &calls);
+	print_res("two items", (void *)(long)1, (void *)(long)ints[0], 0);
+	print_res("NULL base", (void *)(long)AFC_ERR_NULL_POINTER, (void *)(long)afc_parallel_sort_r(NULL, 2, sizeof(int), comp_int_r, &calls), 0);
+
+	print_row();
+
+	/* ---- Test 3: Stability, items of 12 bytes ---- */
+	for (t = 0; t < BIG; t++)
+	{
+		items[t].key = rand() % 50;
+		items[t].seq = t;
+	}
+	afc_parallel_sort_r(items, BIG, sizeof(struct item), comp_item_r, NULL);
+
+	errors = 0;
+	for (t = 1; t < BIG; t++)
+		if ((items[t - 1].key > items[t].key) || ((items[t - 1].key == items[t].key) && (items[t - 1].seq > items[t].seq)))
+			errors++;
+	print_res("stable sort", (void *)(long)0, (void *)(long)errors, 0);
+
+	print_row();
+
+	/* ---- Test 4: afc_parallel_sort() ---- */
+	for (t = 0; t < BIG; t++)
+	{
+		sprintf(strs[t], "%08d", rand() % 1000000);
+		ptrs[t] = strs[t];
+	}
+	afc_parallel_sort(ptrs, BIG, sizeof(char *), comp_str);
+	print_res("strings sorted", (void *)(long)0, (void *)(long)check_sorted(ptrs, BIG), 0);
+
+	afc_parallel_sort_set_threads(1);
+	for (t = 0; t < BIG; t++)
+		ptrs[t] = strs[BIG - t - 1];
+	afc_parallel_sort(ptrs, BIG, sizeof(char *), comp_str);
+	print_res("strings sorted, 1 thread", (void *)(long)0, (void *)(long)check_sorted(ptrs, BIG), 0);
+	afc_parallel_sort_set_threads(4);
+
+	print_row();
+
+	/* ---- Test 5: Array ---- */
+	am = afc_array_new();
+	afc_array_init(am, BIG);
+	for (t = 0; t < BIG; t++)
+		afc_array_add(am, strs[t], AFC_ARRAY_ADD_TAIL);
+	afc_array_sort(am, comp_str);
+
+	errors = 0;
+	for (t = 0; t < BIG; t++)
+		if (strcmp(afc_array_item(am, t), ptrs[t]) != 0)
+			errors++;
+	print_res("array sort", (void *)(long)0, (void *)(long)errors, 0);
+	print_res("array len", (void *)(long)BIG, (void *)(long)afc_array_len(am), 0);
+	afc_array_delete(am);
+
+	print_row();
+
+	/* ---- Test 6: List ---- */
+	nm = afc_list_new();
+	for (t = 0; t < BIG; t++)
+		afc_list_add(nm, strs[t], AFC_LIST_ADD_TAIL);
+
+	afc_list_sort(nm, comp_list, NULL);
+	errors = n = 0;
+	prev = NULL;
+	for (s = afc_list_first(nm); s; s = afc_list_next(nm), n++)
+	{
+		if (prev && (strcmp(prev, s) > 0))
+			errors++;
+		prev = s;
+	}
+	print_res("list sort", (void *)(long)0, (void *)(long)errors, 0);
+	print_res("list len", (void *)(long)BIG, (void *)(long)n, 0);
+
+	afc_list_clear(nm);
+	for (t = BIG - 1; t >= 0; t--)
+		afc_list_add(nm, strs[t], AFC_LIST_ADD_TAIL);
+	afc_list_fast_sort(nm, comp_list, NULL);
+	errors = 0;
+	prev = NULL;
+	for (s = afc_list_first(nm); s; s = afc_list_next(nm))
+	{
+		if (prev && (strcmp(prev, s) > 0))
+			errors++;
+		prev = s;
+	}
+	print_res("list fast sort", (void *)(long)0, (void *)(long)errors, 0);
+
+	afc_list_clear(nm);
+	for (t = 0; t < BIG; t++)
+		afc_list_add(nm, strs[t], AFC_LIST_ADD_TAIL);
+	afc_list_ultra_sort(nm, comp_str);
+	errors = 0;
+	prev = NULL;
+	for (s = afc_list_first(nm); s; s = afc_list_next(nm))
+	{
+		if (prev && (strcmp(prev, s) > 0))
+			errors++;
+		prev = s;
+	}
+	print_res("list ultra sort", (void *)(long)0, (void *)(long)errors, 0);
+	afc_list_delete(nm);
+
+	print_row();
+
+	/* ---- Test 7: StringList ---- */
+	sn = afc_string_list_new();
+	for (t = 0; t < BIG; t++)
+		afc_string_list_add(sn, strs[t], AFC_STRING_LIST_ADD_TAIL);
+
+	afc_string_list_sort(sn, FALSE, TRUE, TRUE);
+	errors = n = 0;
+	prev = NULL;
+	for (s = afc_string_list_first(sn); s; s = afc_string_list_next(sn), n++)
+	{
+		if (prev && (strcmp(prev, s) < 0))
+			errors++;
+		prev = s;
+	}
+	print_res("string list inverted sort", (void *)(long)0, (void *)(long)errors, 0);
+	print_res("string list len", (void *)(long)BIG, (void *)(long)n, 0);
+	afc_string_list_delete(sn);
+
+	print_summary();
+
+	afc_delete(afc);
+
+	return get_test_failures() > 0 ? 1 : 0;
+}
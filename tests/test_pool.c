@@ -0,0 +1,218 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+
+/**
+ * test_pool.c - Tests for the Pool small objects allocator.
+ *
+ * Tests cover:
+ *   - afc_pool_alloc() / afc_pool_free() and object reuse
+ *   - Objects bigger than AFC_POOL_MAX_SIZE
+ *   - afc_pool_get_stats()
+ *   - Threads returning their cache on exit
+ *   - List, Hash and trees using the Pool for their nodes
+ *   - afc_pool_clear() and blocks taken from afc_malloc() under MemTracker
+ */
+
+#include <pthread.h>
+
+#include "test_utils.h"
+#include "../src/pool.h"
+#include "../src/avl_tree.h"
+
+static void *thread_worker(void *data)
+{
+	void *mem[500];
+	int t;
+
+	for (t = 0; t < 500; t++)
+		mem[t] = afc_pool_alloc(40);
+
+	for (t = 0; t < 500; t++)
+		afc_pool_free(mem[t], 40);
+
+	return (NULL);
+}
+
+int main(void)
+{
+	AFC *afc = afc_new();
+	test_header();
+
+	PoolStats before, after;
+	char *p, *q;
+	void *mem[1000];
+	int t, ok;
+
+	/* ---- Test 1: Alloc and free ---- */
+	afc_pool_get_stats(&before);
+
+	p = afc_pool_alloc(24);
+	print_res("alloc not NULL", (void *)(long)1, (void *)(long)(p != NULL), 0);
+	memset(p, 'a', 24);
+	afc_pool_free(p, 24);
+
+	q = afc_pool_alloc(24);
+	print_res("freed object reused", (void *)(long)1, (void *)(long)(p == q), 0);
+
+	/* Sizes in the same class share the objects */
+	afc_pool_free(q, 24);
+	q = afc_pool_alloc(32);
+	print_res("same size class", (void *)(long)1, (void *)(long)(p == q), 0);
+	afc_pool_free(q, 32);
+
+	/* Objects never overlap */
+	ok = 1;
+	for (t = 0; t < 1000; t++)
+	{
+		mem[t] = afc_pool_alloc(16);
+		memset(mem[t], t & 0xFF, 16);
+	}
+	for (t = 0; t < 1000; t++)
+		if (((unsigned char *)mem[t])[15] != (t & 0xFF))
+			ok = 0;
+	print_res("1000 objects", (void *)(long)1, (void *)(long)ok, 0);
+	print_res("objects aligned", (void *)(long)0, (void *)(long)(((unsigned long)mem[999]) % AFC_POOL_ALIGN), 0);
+
+	for (t = 0; t < 1000; t++)
+		afc_pool_free(mem[t], 16);
+
+	/* Big objects go to afc_malloc() */
+	p = afc_pool_alloc(AFC_POOL_MAX_SIZE + 1);
+	memset(p, 'b', AFC_POOL_MAX_SIZE + 1);
+	print_res("big object", (void *)(long)1, (void *)(long)(p != NULL), 0);
+	afc_pool_free(p, AFC_POOL_MAX_SIZE + 1);
+
+	afc_pool_free(NULL, 16);
+
+	print_row();
+
+	/* ---- Test 2: Stats ---- */
+	afc_pool_get_stats(&after);
+	print_res("hits counted", (void *)(long)1, (void *)(long)(after.hits > before.hits), 0);
+	print_res("refills counted", (void *)(long)1, (void *)(long)(after.refills > before.refills), 0);
+	print_res("bytes held", (void *)(long)(after.blocks * AFC_POOL_BLOCK_SIZE), (void *)(long)after.bytes_held, 0);
+	print_res("get_stats NULL", (void *)(long)AFC_ERR_NULL_POINTER, (void *)(long)afc_pool_get_stats(NULL), 0);
+
+	/* A warm cache needs no new blocks */
+	afc_pool_get_stats(&before);
+	for (t = 0; t < 100; t++)
+		afc_pool_free(afc_pool_alloc(16), 16);
+	afc_pool_get_stats(&after);
+	print_res("no new blocks when warm", (void *)(long)before.blocks, (void *)(long)after.blocks, 0);
+	print_res("warm allocs are hits", (void *)(long)(before.hits + 100), (void *)(long)after.hits, 0);
+
+	print_row();
+
+	/* ---- Test 3: Threads ---- */
+	pthread_t threads[4];
+
+	afc_pool_get_stats(&before);
+	for (t = 0; t < 4; t++)
+		pthread_create(&threads[t], NULL, thread_worker, NULL);
+	for (t = 0; t < 4; t++)
+		pthread_join(threads[t], NULL);
+	afc_pool_get_stats(&after);
+
+	print_res("exited threads stats", (void *)(long)1, (void *)(long)(after.hits >= before.hits + 4 * 400), 0);
+
+	/* Objects left by the threads are reused, no new block needed */
+	afc_pool_get_stats(&before);
+	for (t = 0; t < 500; t++)
+		mem[t] = afc_pool_alloc(40);
+	for (t = 0; t < 500; t++)
+		afc_pool_free(mem[t], 40);
+	afc_pool_get_stats(&after);
+	print_res("thread objects reused", (void *)(long)before.blocks, (void *)(long)after.blocks, 0);
+
+	print_row();
+
+	/* ---- Test 4: Containers ---- */
+	List *list = afc_list_new();
+	Hash *hash = afc_hash_new();
+	AVLTree *avl = afc_avl_tree_new();
+
+	afc_pool_get_stats(&before);
+	for (t = 0; t < 1000; t++)
+	{
+		afc_list_add(list, (void *)(long)t, AFC_LIST_ADD_TAIL);
+		afc_hash_add(hash, t, (void *)(long)(t + 1));
+		afc_avl_tree_insert(avl, (void *)(long)t, (void *)(long)t);
+	}
+	print_res("list len", (void *)(long)1000, (void *)(long)afc_list_len(list), 0);
+	print_res("hash find", (void *)(long)501, afc_hash_find(hash, 500), 0);
+	print_res("avl find", (void *)(long)500, afc_avl_tree_get(avl, (void *)(long)500), 0);
+
+	afc_list_clear(list);
+	afc_hash_clear(hash);
+	afc_avl_tree_clear(avl);
+
+	/* The second round only uses pooled nodes */
+	afc_pool_get_stats(&before);
+	for (t = 0; t < 1000; t++)
+	{
+		afc_list_add(list, (void *)(long)t, AFC_LIST_ADD_TAIL);
+		afc_hash_add(hash, t, (void *)(long)(t + 1));
+		afc_avl_tree_insert(avl, (void *)(long)t, (void *)(long)t);
+	}
+	afc_pool_get_stats(&after);
+	print_res("nodes reused", (void *)(long)before.blocks, (void *)(long)after.blocks, 0);
+	print_res("list item 999", (void *)(long)999, afc_list_item(list, 999), 0);
+
+	afc_list_first(list);
+	afc_list_del(list);
+	print_res("list del", (void *)(long)1, afc_list_first(list), 0);
+
+	afc_list_delete(list);
+	afc_hash_delete(hash);
+	afc_avl_tree_delete(avl);
+
+	print_row();
+
+	/* ---- Test 5: Clear ---- */
+	print_res("clear", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_pool_clear(), 0);
+	afc_pool_get_stats(&after);
+	print_res("clear frees blocks", (void *)(long)0, (void *)(long)after.blocks, 0);
+	print_res("clear bytes held", (void *)(long)0, (void *)(long)after.bytes_held, 0);
+
+	p = afc_pool_alloc(24);
+	print_res("alloc after clear", (void *)(long)1, (void *)(long)(p != NULL), 0);
+	afc_pool_free(p, 24);
+
+	/* With MemTracker active the blocks are tracked */
+	MemTracker *mt = afc_track_mallocs(afc);
+	MemTrackerStats mts;
+
+	afc_pool_clear();
+	p = afc_pool_alloc(24);
+	afc_mem_tracker_get_stats(mt, &mts);
+	print_res("tracked block", (void *)(long)AFC_POOL_BLOCK_SIZE, (void *)(long)mts.alloc_bytes, 0);
+
+	afc_pool_free(p, 24);
+	afc_pool_clear();
+	afc_mem_tracker_get_stats(mt, &mts);
+	print_res("tracked block freed", (void *)(long)0, (void *)(long)mts.blocks, 0);
+
+	print_summary();
+
+	afc_delete(afc);
+
+	return get_test_failures() > 0 ? 1 : 0;
+}
@@ -0,0 +1,212 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/**
+ * test_rope.c - Tests for the Rope class.
+ *
+ * Tests cover:
+ *   - Object creation and deletion
+ *   - Insertions, removals, slices and chunks on small texts
+ *   - Big texts spanning many leaves
+ *   - Random edits compared with a plain buffer, checking the tree stays balanced
+ *   - Errors
+ */
+
+#include "test_utils.h"
+#include "../src/rope.h"
+
+#define REF_SIZE (2 * 1024 * 1024)
+
+/* Returns the height of the subtree, or -1 if lengths or heights are wrong or it is not balanced */
+static int check_tree(struct afc_rope_node *node)
+{
+	int hl, hr;
+
+	if (node->data)
+		return (((node->len > 0) && (node->len <= AFC_ROPE_LEAF_SIZE)) ? 0 : -1);
+
+	hl = check_tree(node->left);
+	hr = check_tree(node->right);
+
+	if ((hl < 0) || (hr < 0) || (hl - hr > 1) || (hr - hl > 1))
+		return (-1);
+	if ((node->len != node->left->len + node->right->len) || (node->height != 1 + (hl > hr ? hl : hr)))
+		return (-1);
+
+	return (node->height);
+}
+
+/* TRUE if the text of the Rope is /len/ chars of /ref/ and its tree is valid */
+static int same_text(Rope *rope, const char *ref, unsigned long len)
+{
+	char *s = afc_rope_to_string(rope);
+	int res;
+
+	res = (s != NULL) && (afc_string_len(s) == len) && (memcmp(s, ref, len) == 0);
+	res = res && ((rope->root == NULL) || (check_tree(rope->root) >= 0));
+
+	afc_string_delete(s);
+
+	return (res);
+}
+
+int main(void)
+{
+	AFC *afc = afc_new();
+	test_header();
+
+	static char ref[REF_SIZE], text[20000];
+	afc_strview chunk;
+	unsigned long ref_len, pos, len, total;
+	char *s;
+	int t, errors, chunks;
+
+	/* ---- Test 1: Object creation ---- */
+	Rope *rope = afc_rope_new();
+	print_res("rope_new() not NULL", (void *)(long)1, (void *)(long)(rope != NULL), 0);
+	print_res("len of empty rope", (void *)(long)0, (void *)(long)afc_rope_len(rope), 0);
+	print_res("no chunks", (void *)(long)FALSE, (void *)(long)afc_rope_first_chunk(rope, &chunk), 0);
+	s = afc_rope_to_string(rope);
+	print_res("empty to_string", "", s, 1);
+	afc_string_delete(s);
+
+	print_row();
+
+	/* ---- Test 2: Small texts ---- */
+	afc_rope_add(rope, "Hello", ALL);
+	afc_rope_add(rope, "World", ALL);
+	afc_rope_insert(rope, 5, ", ", ALL);
+	afc_rope_insert(rope, 0, ">> ", ALL);
+	afc_rope_add(rope, "!!!", 1);
+	s = afc_rope_to_string(rope);
+	print_res("insert and add", ">> Hello, World!", s, 1);
+	afc_string_delete(s);
+
+	s = afc_rope_slice(rope, 3, 5);
+	print_res("slice", "Hello", s, 1);
+	afc_string_delete(s);
+	s = afc_rope_slice(rope, 10, ALL);
+	print_res("slice to the end", "World!", s, 1);
+	afc_string_delete(s);
+
+	print_res("char_at", (void *)(long)'W', (void *)(long)afc_rope_char_at(rope, 10), 0);
+	print_res("char_at past the end", (void *)(long)'\0', (void *)(long)afc_rope_char_at(rope, 100), 0);
+
+	afc_rope_remove(rope, 0, 3);
+	afc_rope_remove(rope, 5, 2);
+	afc_rope_remove(rope, 10, ALL);
+	s = afc_rope_to_string(rope);
+	print_res("remove", "HelloWorld", s, 1);
+	afc_string_delete(s);
+
+	afc_rope_clear(rope);
+	print_res("clear", (void *)(long)0, (void *)(long)afc_rope_len(rope), 0);
+
+	print_row();
+
+	/* ---- Test 3: Big texts ---- */
+	for (t = 0; t < (int)sizeof(text); t++)
+		text[t] = 'a' + t % 26;
+
+	for (t = 0; t < 50; t++)
+		afc_rope_add(rope, text, sizeof(text));
+	print_res("1 MB appended", (void *)(long)(50 * sizeof(text)), (void *)(long)afc_rope_len(rope), 0);
+	print_res("tree is balanced", (void *)(long)1, (void *)(long)(check_tree(rope->root) >= 0), 0);
+
+	total = chunks = errors = 0;
+	for (t = afc_rope_first_chunk(rope, &chunk); t; t = afc_rope_next_chunk(rope, &chunk))
+	{
+		if ((chunk.len == 0) || (memcmp(chunk.str, text + total % sizeof(text), 1) != 0))
+			errors++;
+		total += chunk.len;
+		chunks++;
+	}
+	print_res("chunks cover the text", (void *)(long)afc_rope_len(rope), (void *)(long)total, 0);
+	print_res("chunks are leaves", (void *)(long)1, (void *)(long)((chunks >= 50 * (int)sizeof(text) / AFC_ROPE_LEAF_SIZE) && (errors == 0)), 0);
+
+	/* A removal spanning many leaves */
+	afc_rope_remove(rope, 100, 900000);
+	s = afc_rope_to_string(rope);
+	print_res("big remove", (void *)(long)1, (void *)(long)((afc_string_len(s) == 100000) && (s[99] == text[99]) && (s[100] == text[900100 % sizeof(text)])), 0);
+	afc_string_delete(s);
+
+	afc_rope_clear(rope);
+
+	print_row();
+
+	/* ---- Test 4: Random edits ---- */
+	srand(19);
+	ref_len = 0;
+	errors = 0;
+	for (t = 0; t < 20000; t++)
+	{
+		int op = rand() % 10;
+
+		if ((op < 6) && (ref_len < REF_SIZE - sizeof(text)))
+		{
+			len = (rand() % 4) ? rand() % 50 : rand() % (int)(sizeof(text) - 26);
+			pos = rand() % (ref_len + 1);
+			memmove(ref + pos + len, ref + pos, ref_len - pos);
+			memcpy(ref + pos, text + (t % 26), len);
+			ref_len += len;
+
+			if (afc_rope_insert(rope, pos, text + (t % 26), len) != AFC_ERR_NO_ERROR)
+				errors++;
+		}
+		else if (ref_len)
+		{
+			pos = rand() % ref_len;
+			len = (rand() % 4) ? rand() % 50 : rand() % 30000;
+			if (len > ref_len - pos)
+				len = ref_len - pos;
+			memmove(ref + pos, ref + pos + len, ref_len - pos - len);
+			ref_len -= len;
+
+			if (afc_rope_remove(rope, pos, len) != AFC_ERR_NO_ERROR)
+				errors++;
+		}
+
+		if ((t % 1000 == 0) && (!same_text(rope, ref, ref_len)))
+			errors++;
+	}
+	print_res("20000 random edits", (void *)(long)0, (void *)(long)errors, 0);
+	print_res("same text", (void *)(long)1, (void *)(long)same_text(rope, ref, ref_len), 0);
+
+	pos = ref_len / 3;
+	s = afc_rope_slice(rope, pos, 10000);
+	print_res("random slice", (void *)(long)1, (void *)(long)((s != NULL) && (memcmp(s, ref + pos, afc_string_len(s)) == 0)), 0);
+	afc_string_delete(s);
+
+	print_row();
+
+	/* ---- Test 5: Errors ---- */
+	print_res("insert past the end", (void *)(long)AFC_ROPE_ERR_INVALID_POSITION, (void *)(long)afc_rope_insert(rope, ref_len + 1, "x", ALL), 0);
+	print_res("remove past the end", (void *)(long)AFC_ROPE_ERR_INVALID_POSITION, (void *)(long)afc_rope_remove(rope, ref_len + 1, 1), 0);
+	print_res("slice past the end", NULL, afc_rope_slice(rope, ref_len + 1, 1), 0);
+	print_res("insert NULL", (void *)(long)AFC_ERR_NULL_POINTER, (void *)(long)afc_rope_insert(rope, 0, NULL, 1), 0);
+	print_res("text unchanged", (void *)(long)1, (void *)(long)same_text(rope, ref, ref_len), 0);
+
+	print_summary();
+
+	afc_rope_delete(rope);
+	afc_delete(afc);
+
+	return get_test_failures() > 0 ? 1 : 0;
+}
@@ -30,19 +30,121 @@
  *   - afc_smtp_set_tags() macro with multiple tags
  *   - afc_smtp_clear()
  *   - Multiple create/delete cycles for stability
+ *   - AUTH PLAIN and AUTH LOGIN commands sent to a local fake server, with fresh memory
+ *     filled with garbage
  *
- * NOTE: No actual SMTP connections are made in these tests.
+ * NOTE: No connections are made outside of the local host.
  */
 
 #include "test_utils.h"
 #include "../src/smtp.h"
 
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 /* Expected magic number computed from the 'SMTP' character sequence. */
 #define EXPECTED_MAGIC ('S' << 24 | 'M' << 16 | 'T' << 8 | 'P')
 
 /* Number of create/delete cycles for stability testing. */
 #define CYCLE_COUNT 100
 
+/*
+ * _fake_server - Accepts a connection on 'sock' and answers like an SMTP server
+ * that takes any credentials. Every line the client sends is written to 'out'.
+ */
+static void _fake_server(int sock, int out)
+{
+	char line[1024];
+	FILE *f;
+	int fd, login = 0;
+
+	if (((fd = accept(sock, NULL, NULL)) < 0) || ((f = fdopen(fd, "r+")) == NULL))
+		return;
+
+	fputs("220 ready\r\n", f);
+	fflush(f);
+
+	while (fgets(line, sizeof(line), f))
+	{
+		if (write(out, line, strlen(line)) < 0)
+			break;
+
+		if (strncmp(line, "EHLO", 4) == 0)
+			fputs("250 ok\r\n", f);
+		else if (strncmp(line, "AUTH LOGIN", 10) == 0)
+			fputs("334 VXNlcm5hbWU6\r\n", f), login = 1;
+		else if (strncmp(line, "QUIT", 4) == 0)
+			fputs("221 bye\r\n", f);
+		else if (login == 1)
+			fputs("334 UGFzc3dvcmQ6\r\n", f), login = 0;
+		else
+			fputs("235 ok\r\n", f);
+		fflush(f);
+	}
+
+	fclose(f);
+}
+
+/*
+ * _auth_on_wire - Authenticates with 'method' against the fake server on 'port'
+ * and returns the number of the lines sent by the client equal to 'expected'.
+ */
+static int _auth_on_wire(int sock, int port, int method, const char *expected[], int lines)
+{
+	char buf[4096], portstr[16], *p, *line;
+	int pfd[2], found = 0, i, res;
+	ssize_t n, got = 0;
+	pid_t pid;
+	SMTP *s;
+
+	if (pipe(pfd) != 0)
+		return -1;
+
+	if ((pid = fork()) == 0)
+	{
+		close(pfd[0]);
+		_fake_server(sock, pfd[1]);
+		_exit(0);
+	}
+	close(pfd[1]);
+
+	snprintf(portstr, sizeof(portstr), "%d", port);
+	s = afc_smtp_new();
+	afc_smtp_set_tags(s,
+		AFC_SMTP_TAG_HOST, (void *)"127.0.0.1",
+		AFC_SMTP_TAG_PORT, (void *)portstr,
+		AFC_SMTP_TAG_USERNAME, (void *)"user",
+		AFC_SMTP_TAG_PASSWORD, (void *)"s3cret-pw",
+		AFC_SMTP_TAG_AUTH_METHOD, (void *)(long)method);
+
+	res = afc_smtp_connect(s);
+	if (res == AFC_ERR_NO_ERROR)
+		res = afc_smtp_authenticate(s);
+	afc_smtp_quit(s);
+	afc_smtp_delete(s);
+
+	while ((got < (ssize_t)sizeof(buf) - 1) && ((n = read(pfd[0], buf + got, sizeof(buf) - 1 - got)) > 0))
+		got += n;
+	buf[got] = '\0';
+	close(pfd[0]);
+	waitpid(pid, NULL, 0);
+
+	if (res != AFC_ERR_NO_ERROR)
+		return -1;
+
+	/* Every expected line must have been sent exactly, with nothing after it */
+	for (line = strtok_r(buf, "\n", &p); line; line = strtok_r(NULL, "\n", &p))
+		for (i = 0; i < lines; i++)
+			if ((strncmp(line, expected[i], strlen(expected[i])) == 0) && (strcmp(line + strlen(expected[i]), "\r") == 0))
+				found++;
+
+	return found;
+}
+
 int main(void)
 {
 	AFC *afc = afc_new();
@@ -400,6 +502,43 @@ int main(void)
 		(void *)(long)(smtp2 == NULL),
 		0);
 
+	/* ===== AUTH on the wire, against a local fake server ===== */
+
+	/* Fresh memory is filled with garbage, so unterminated buffers show up on the wire. */
+#ifdef __GLIBC__
+	mallopt(M_PERTURB, 0xa5);
+#endif
+	{
+		const char *plain[] = { "AUTH PLAIN AHVzZXIAczNjcmV0LXB3" };
+		const char *login[] = { "AUTH LOGIN", "dXNlcg==", "czNjcmV0LXB3" };
+		struct sockaddr_in addr;
+		socklen_t addr_len = sizeof(addr);
+		int sock = socket(AF_INET, SOCK_STREAM, 0);
+
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		if ((sock >= 0) && (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0) && (listen(sock, 1) == 0) && (getsockname(sock, (struct sockaddr *)&addr, &addr_len) == 0))
+		{
+			print_res("AUTH PLAIN on the wire",
+				(void *)(long)1,
+				(void *)(long)_auth_on_wire(sock, ntohs(addr.sin_port), AFC_SMTP_AUTH_PLAIN, plain, 1),
+				0);
+
+			print_res("AUTH LOGIN on the wire",
+				(void *)(long)3,
+				(void *)(long)_auth_on_wire(sock, ntohs(addr.sin_port), AFC_SMTP_AUTH_LOGIN, login, 3),
+				0);
+		}
+
+		if (sock >= 0)
+			close(sock);
+	}
+#ifdef __GLIBC__
+	mallopt(M_PERTURB, 0);
+#endif
+
 	print_summary();
 
 	/* Cleanup the AFC base object. */
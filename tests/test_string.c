@@ -25,20 +25,45 @@
  *   - Lifecycle: afc_string_new, afc_string_delete, afc_string_dup
  *   - Copy/Add/Clear: afc_string_copy, afc_string_add, afc_string_clear
  *   - Length/Max: afc_string_len, afc_string_max
- *   - Case: afc_string_upper, afc_string_lower
+ *   - Case: afc_string_upper, afc_string_lower, afc_string_casecomp
  *   - Trim: afc_string_trim, afc_string_trim_start, afc_string_trim_end
  *   - Extraction: afc_string_left, afc_string_right, afc_string_mid
  *   - Comparison/Search: afc_string_comp, afc_string_instr, afc_string_pattern_match
- *   - Formatting: afc_string_make
+ *   - Formatting: afc_string_make, afc_string_builder
  *   - Path: afc_string_dirname, afc_string_basename
  *   - JS-like API: starts_with, ends_with, replace, replace_all,
  *     pad_start, pad_end, slice, index_of, last_index_of,
- *     char_at, repeat
+ *     char_at, repeat, replace_multi, resize_replace_all
  *   - Edge cases: empty strings, NULL handling, boundary lengths
+ *   - Hashing: afc_string_hash64, afc_string_hash_seed from many threads
  */
 
 #include "test_utils.h"
 #include "../src/string.h"
+#include <pthread.h>
+
+#define SEED_THREADS 8
+#define SEEDS_PER_THREAD 2000
+
+static unsigned long long seeds[SEED_THREADS * SEEDS_PER_THREAD];
+
+static void *seed_thread(void *arg)
+{
+	unsigned long long *out = (unsigned long long *)arg;
+	int t;
+
+	for (t = 0; t < SEEDS_PER_THREAD; t++)
+		out[t] = afc_string_hash_seed();
+
+	return NULL;
+}
+
+static int comp_seed(const void *a, const void *b)
+{
+	unsigned long long sa = *(const unsigned long long *)a, sb = *(const unsigned long long *)b;
+
+	return (sa > sb) - (sa < sb);
+}
 
 int main(void)
 {
@@ -1285,6 +1310,517 @@ int main(void)
 
 	afc_string_delete(s);
 
+	print_row();
+
+	/* ===================================================================
+	 * SECTION 24: afc_string_hash64() / afc_string_hash_seed()
+	 * =================================================================== */
+
+	/* Reference values of wyhash (final version 4) */
+	print_res("hash64 empty",
+		(void *)(long)1,
+		(void *)(long)(afc_string_hash64("", 0, 0) == 0x93228a4de0eec5a2ULL),
+		0);
+	print_res("hash64 'a' seed 1",
+		(void *)(long)1,
+		(void *)(long)(afc_string_hash64("a", 1, 1) == 0xc5bac3db178713c4ULL),
+		0);
+	print_res("hash64 'abc' seed 2",
+		(void *)(long)1,
+		(void *)(long)(afc_string_hash64("abc", 3, 2) == 0xa97f2f7b1d9b3314ULL),
+		0);
+	print_res("hash64 14 bytes seed 3",
+		(void *)(long)1,
+		(void *)(long)(afc_string_hash64("message digest", 14, 3) == 0x786d1f1df3801df4ULL),
+		0);
+	print_res("hash64 80 bytes seed 6",
+		(void *)(long)1,
+		(void *)(long)(afc_string_hash64("12345678901234567890123456789012345678901234567890123456789012345678901234567890", 80, 6) == 0x6cc5eab49a92d617ULL),
+		0);
+
+	/* The length is used, not the terminator */
+	print_res("hash64 embedded zero",
+		(void *)(long)1,
+		(void *)(long)(afc_string_hash64("ab\0cd", 5, 0) != afc_string_hash64("ab", 2, 0)),
+		0);
+	print_res("hash64 seed changes value",
+		(void *)(long)1,
+		(void *)(long)(afc_string_hash64("hello", 5, 1) != afc_string_hash64("hello", 5, 2)),
+		0);
+	print_res("hash64 NULL",
+		(void *)(long)1,
+		(void *)(long)(afc_string_hash64(NULL, 10, 0) == afc_string_hash64("", 0, 0)),
+		0);
+	print_res("hash_seed differs",
+		(void *)(long)1,
+		(void *)(long)(afc_string_hash_seed() != afc_string_hash_seed()),
+		0);
+
+	/* Seeds asked by many threads at the same time are all different */
+	{
+		pthread_t th[SEED_THREADS];
+		int i, dups = 0;
+
+		for (i = 0; i < SEED_THREADS; i++)
+			pthread_create(&th[i], NULL, seed_thread, seeds + i * SEEDS_PER_THREAD);
+		for (i = 0; i < SEED_THREADS; i++)
+			pthread_join(th[i], NULL);
+
+		qsort(seeds, SEED_THREADS * SEEDS_PER_THREAD, sizeof(seeds[0]), comp_seed);
+		for (i = 1; i < SEED_THREADS * SEEDS_PER_THREAD; i++)
+			if (seeds[i] == seeds[i - 1])
+				dups++;
+
+		print_res("hash_seed threads differ",
+			(void *)(long)0,
+			(void *)(long)dups,
+			0);
+	}
+
+	print_row();
+
+	/* ===================================================================
+	 * SECTION 25: afc_strview
+	 * =================================================================== */
+	{
+		afc_strview v, rest, tok;
+		char *d;
+		int n;
+
+		s = afc_string_dup("  key = value \r\n");
+		v = afc_string_view(s);
+		print_res("view len", (void *)(long)afc_string_len(s), (void *)(long)v.len, 0);
+		print_res("view points to string", s, (void *)v.str, 0);
+
+		v = afc_strview_trim(v);
+		print_res("trim equals", (void *)(long)1, (void *)(long)afc_strview_equals(v, "key = value"), 0);
+		print_res("trim does not change string", (void *)(long)16, (void *)(long)afc_string_len(s), 0);
+
+		print_res("index_of '='", (void *)(long)4, (void *)(long)afc_strview_index_of(v, '='), 0);
+		print_res("index_of missing", (void *)(long)-1, (void *)(long)afc_strview_index_of(v, '#'), 0);
+		print_res("mid", (void *)(long)1, (void *)(long)afc_strview_equals(afc_strview_mid(v, 6, 5), "value"), 0);
+		print_res("mid ALL", (void *)(long)1, (void *)(long)afc_strview_equals(afc_strview_mid(v, 6, ALL), "value"), 0);
+		print_res("mid past end", (void *)(long)0, (void *)(long)afc_strview_mid(v, 100, 5).len, 0);
+		print_res("equals prefix only", (void *)(long)0, (void *)(long)afc_strview_equals(afc_strview_mid(v, 0, 3), "key ="), 0);
+
+		print_res("comp equal", (void *)(long)0, (void *)(long)afc_strview_comp(afc_strview_make("abc", ALL), afc_strview_make("abcdef", 3)), 0);
+		print_res("comp shorter first", (void *)(long)1, (void *)(long)(afc_strview_comp(afc_strview_make("ab", ALL), afc_strview_make("abc", ALL)) < 0), 0);
+		print_res("comp chars", (void *)(long)1, (void *)(long)(afc_strview_comp(afc_strview_make("b", ALL), afc_strview_make("abc", ALL)) > 0), 0);
+
+		d = afc_string_new(5);
+		afc_string_copy_view(d, afc_strview_mid(v, 6, 5));
+		print_res("copy_view", "value", d, 1);
+		print_res("copy_view len", (void *)(long)5, (void *)(long)afc_string_len(d), 0);
+		afc_string_copy_view(d, v);
+		print_res("copy_view bound", "key =", d, 1);
+		afc_string_copy_view(d, afc_strview_make("ab", ALL));
+		afc_string_add_view(d, afc_strview_make("cdefgh", 2));
+		print_res("add_view", "abcd", d, 1);
+		afc_string_add_view(d, afc_strview_make("xyz", ALL));
+		print_res("add_view bound", "abcdx", d, 1);
+		afc_string_delete(d);
+
+		d = afc_string_dup_view(afc_strview_mid(v, 0, 3));
+		print_res("dup_view", "key", d, 1);
+		print_res("dup_view max", (void *)(long)3, (void *)(long)afc_string_max(d), 0);
+		afc_string_delete(d);
+		print_res("dup_view empty", NULL, afc_string_dup_view(afc_strview_make("", ALL)), 0);
+		afc_string_delete(s);
+
+		/* Tokens are the same afc_string_list_split() creates */
+		rest = afc_strview_make("a,b;;c\\,d,", ALL);
+		n = 0;
+		while (afc_strview_token(&rest, ",;", '\\', &tok))
+		{
+			if ((n == 0) && (!afc_strview_equals(tok, "a")))
+				break;
+			if ((n == 2) && (tok.len != 0))
+				break;
+			if ((n == 3) && (!afc_strview_equals(tok, "c\\,d")))
+				break;
+			n++;
+		}
+		print_res("token count", (void *)(long)4, (void *)(long)n, 0);
+		rest = afc_strview_make("", ALL);
+		print_res("token on empty", (void *)(long)0, (void *)(long)afc_strview_token(&rest, ",", 0, &tok), 0);
+	}
+
+	/* ===================================================================
+	 * SECTION 26: SIMD search kernels and multi-pattern replace
+	 * =================================================================== */
+	{
+		const char *pats[] = { "{{name}}", "{{", "&", "", NULL };
+		const char *reps[] = { "Fabio", "<", "&amp;", "empty", "null" };
+		char *hay, *d;
+		char needle[48];
+		long expected, got, i, j;
+		int round, hay_len, needle_len, errors = 0, rerrors = 0;
+
+		/* Compare against a naive search on many lengths, so every block boundary and tail is crossed */
+		srand(1234);
+		hay = afc_string_new(300);
+		for (round = 0; round < 3000; round++)
+		{
+			hay_len = rand() % 300;
+			afc_string_clear(hay);
+			for (i = 0; i < hay_len; i++)
+				hay[i] = "ab"[rand() % 2];
+			hay[hay_len] = '\0';
+			afc_string_reset_len(hay);
+
+			needle_len = 1 + rand() % 40;
+			for (i = 0; i < needle_len; i++)
+				needle[i] = "ab"[rand() % 2];
+			needle[needle_len] = '\0';
+
+			expected = -1;
+			for (i = 0; (expected == -1) && (i + needle_len <= hay_len); i++)
+				if (memcmp(hay + i, needle, needle_len) == 0)
+					expected = i;
+			got = afc_string_index_of(hay, needle, 0);
+			if (got != expected)
+				errors++;
+
+			expected = -1;
+			for (j = hay_len - needle_len; (expected == -1) && (j >= 0); j--)
+				if (memcmp(hay + j, needle, needle_len) == 0)
+					expected = j;
+			got = afc_string_last_index_of(hay, needle, hay_len);
+			if (got != expected)
+				rerrors++;
+		}
+		print_res("index_of vs naive", (void *)(long)0, (void *)(long)errors, 0);
+		print_res("last_index_of vs naive", (void *)(long)0, (void *)(long)rerrors, 0);
+
+		/* Match at the very end of a long string */
+		afc_string_clear(hay);
+		for (i = 0; i < 290; i++)
+			hay[i] = 'x';
+		memcpy(hay + 290, "needle", 7);
+		afc_string_reset_len(hay);
+		print_res("instr at end", hay + 290, afc_string_instr(hay, "needle", 0), 0);
+		print_res("instr start past match", NULL, afc_string_instr(hay, "needle", 291), 0);
+		print_res("index_of from index", (void *)(long)290, (void *)(long)afc_string_index_of(hay, "needle", 100), 0);
+		print_res("last_index_of before match", (void *)(long)-1, (void *)(long)afc_string_last_index_of(hay, "needle", 289), 0);
+		print_res("last_index_of single char", (void *)(long)289, (void *)(long)afc_string_last_index_of(hay, "x", 1000), 0);
+		afc_string_delete(hay);
+
+		d = afc_string_new(64);
+		afc_string_replace_all(d, "a-b-c--d", "-", "+");
+		print_res("replace_all", "a+b+c++d", d, 1);
+		print_res("replace_all len", (void *)(long)8, (void *)(long)afc_string_len(d), 0);
+		afc_string_replace_all(d, "aaaa", "aa", "a");
+		print_res("replace_all no rescan", "aa", d, 1);
+		afc_string_delete(d);
+
+		d = afc_string_new(10);
+		afc_string_replace_all(d, "x-x-x-x-x", "x", "yyy");
+		print_res("replace_all truncated", "yyy-yyy-yy", d, 1);
+		print_res("replace_all truncated len", (void *)(long)10, (void *)(long)afc_string_len(d), 0);
+
+		afc_string_replace_multi(d, "{{name}} & {{x", pats, reps, 5);
+		print_res("replace_multi truncated", "Fabio &amp", d, 1);
+
+		afc_string_resize_replace_multi(&d, "Hi {{name}} & {{x", pats, reps, 5);
+		print_res("resize_replace_multi", "Hi Fabio &amp; <x", d, 1);
+		print_res("resize_replace_multi len", (void *)(long)17, (void *)(long)afc_string_len(d), 0);
+
+		afc_string_copy(d, "a.b.c", ALL);
+		afc_string_resize_replace_all(&d, d, ".", "...");
+		print_res("resize_replace_all on itself", "a...b...c", d, 1);
+
+		afc_string_resize_replace_all(&d, "no match", "zz", "y");
+		print_res("resize_replace_all no match", "no match", d, 1);
+
+		/* More matches than the engine keeps on the stack */
+		afc_string_clear(d);
+		for (i = 0; i < 200; i++)
+			afc_string_resize_add(&d, "a,");
+		afc_string_resize_replace_all(&d, d, ",", ", ");
+		print_res("resize_replace_all many matches", (void *)(long)600, (void *)(long)afc_string_len(d), 0);
+		print_res("resize_replace_all many matches text", (void *)(long)1, (void *)(long)(strncmp(d, "a, a, a, ", 9) == 0), 0);
+		afc_string_delete(d);
+	}
+
+	/* ===================================================================
+	 * SECTION 27: case conversion and afc_string_casecomp()
+	 * =================================================================== */
+	{
+		char *u;
+
+		u = afc_string_dup("Hello World, 123 [AbC_xYz] \xe0\xc8 longer than sixteen chars");
+		afc_string_upper(u);
+		print_res("upper", "HELLO WORLD, 123 [ABC_XYZ] \xe0\xc8 LONGER THAN SIXTEEN CHARS", u, 1);
+		afc_string_lower(u);
+		print_res("lower", "hello world, 123 [abc_xyz] \xe0\xc8 longer than sixteen chars", u, 1);
+		afc_string_delete(u);
+
+		print_res("casecomp equal", (void *)(long)0, (void *)(long)afc_string_casecomp("Hello World", "hELLO wORLD", ALL), 0);
+		print_res("casecomp long equal", (void *)(long)0, (void *)(long)afc_string_casecomp("The Quick Brown Fox Jumps Over", "the quick brown fox jumps over", ALL), 0);
+		print_res("casecomp long differ", (void *)(long)1, (void *)(long)(afc_string_casecomp("the quick brown fox jumps over A", "THE QUICK BROWN FOX JUMPS OVER b", ALL) > 0), 0);
+		print_res("casecomp greater", (void *)(long)1, (void *)(long)(afc_string_casecomp("b", "A", ALL) < 0), 0);
+		print_res("casecomp shorter", (void *)(long)1, (void *)(long)(afc_string_casecomp("abc", "ABCD", ALL) > 0), 0);
+		print_res("casecomp longer", (void *)(long)1, (void *)(long)(afc_string_casecomp("abcd", "ABC", ALL) < 0), 0);
+		print_res("casecomp chars", (void *)(long)0, (void *)(long)afc_string_casecomp("Subject: hi", "SUBJECT:", 8), 0);
+		print_res("casecomp chars differ", (void *)(long)1, (void *)(long)(afc_string_casecomp("abX", "ABY", 3) != 0), 0);
+		print_res("casecomp like strcasecmp", (void *)(long)1, (void *)(long)(afc_string_casecomp("_", "A", ALL) > 0), 0);
+		print_res("casecomp NULL", (void *)(long)0, (void *)(long)afc_string_casecomp(NULL, NULL, ALL), 0);
+		print_res("comp chars past end", (void *)(long)1, (void *)(long)(afc_string_comp("ab", "abc", 5) > 0), 0);
+	}
+
+	/* ===================================================================
+	 * SECTION 28: afc_string_builder
+	 * =================================================================== */
+	{
+		afc_string_builder sb;
+		afc_string_builder lazy = { NULL };
+		char *built;
+		long i;
+		int res = AFC_ERR_NO_ERROR;
+
+		print_res("builder init", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_string_builder_init(&sb, 4), 0);
+		afc_string_builder_append(&sb, "Hello", ALL);
+		afc_string_builder_append_char(&sb, ',');
+		afc_string_builder_append(&sb, " World!!!", 6);
+		print_res("builder append", "Hello, World", sb.str, 1);
+		print_res("builder len", (void *)(long)12, (void *)(long)afc_string_len(sb.str), 0);
+
+		afc_string_builder_append_fmt(&sb, " %d-%s-%05.1f", 42, "x", 3.14159);
+		print_res("builder append_fmt", "Hello, World 42-x-003.1", sb.str, 1);
+
+		afc_string_builder_clear(&sb);
+		print_res("builder clear", "", sb.str, 1);
+
+		/* Many appends: the buffer doubles, so the max stays within twice the length */
+		for (i = 0; (i < 10000) && (res == AFC_ERR_NO_ERROR); i++)
+			res = afc_string_builder_append_fmt(&sb, "%ld,", i % 10);
+		print_res("builder many appends", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)res, 0);
+		print_res("builder many len", (void *)(long)20000, (void *)(long)afc_string_len(sb.str), 0);
+		print_res("builder geometric max", (void *)(long)1, (void *)(long)(afc_string_max(sb.str) < 40000), 0);
+		print_res("builder many text", (void *)(long)1, (void *)(long)(strncmp(sb.str + 19990, "5,6,7,8,9,", 10) == 0), 0);
+
+		afc_string_builder_reserve(&sb, 100000);
+		print_res("builder reserve", (void *)(long)1, (void *)(long)(afc_string_max(sb.str) >= 120000), 0);
+		print_res("builder reserve keeps text", (void *)(long)20000, (void *)(long)afc_string_len(sb.str), 0);
+
+		built = afc_string_builder_finish(&sb);
+		print_res("builder finish gives string", (void *)(long)20000, (void *)(long)afc_string_len(built), 0);
+		print_res("builder finish empties", NULL, sb.str, 0);
+		afc_string_add(built, "!", ALL);
+		print_res("finished string usable", (void *)(long)20001, (void *)(long)afc_string_len(built), 0);
+		afc_string_delete(built);
+
+		afc_string_builder_append_fmt(&lazy, "%s", "no init needed");
+		print_res("builder zero init", "no init needed", lazy.str, 1);
+		afc_string_builder_append(&lazy, "a\0b", 3);
+		print_res("builder binary len", (void *)(long)17, (void *)(long)afc_string_len(lazy.str), 0);
+		afc_string_builder_free(&lazy);
+		print_res("builder free", NULL, lazy.str, 0);
+
+		built = afc_string_builder_finish(&lazy);
+		print_res("builder finish empty", "", built, 1);
+
+		/* Appending a part of the builder text to itself, while the buffer grows */
+		afc_string_builder_init(&sb, 4);
+		afc_string_builder_append(&sb, "abcd", ALL);
+		for (i = 0; i < 12; i++)
+			afc_string_builder_append(&sb, sb.str, afc_string_len(sb.str));
+		afc_string_builder_append(&sb, sb.str + 1, 2);
+		print_res("builder self append len", (void *)(long)(4 * 4096 + 2), (void *)(long)afc_string_len(sb.str), 0);
+		print_res("builder self append text", (void *)(long)1, (void *)(long)((strncmp(sb.str + 4 * 4095, "abcdbc", 7) == 0) && (sb.str[4 * 4096 + 2] == '\0')), 0);
+
+		print_res("builder reserve overflow", (void *)(long)AFC_ERR_NO_MEMORY, (void *)(long)afc_string_builder_reserve(&sb, ULONG_MAX), 0);
+		print_res("builder append overflow", (void *)(long)AFC_ERR_NO_MEMORY, (void *)(long)afc_string_builder_append(&sb, "x", ULONG_MAX - 8), 0);
+		print_res("builder overflow keeps text", (void *)(long)(4 * 4096 + 2), (void *)(long)afc_string_len(sb.str), 0);
+		afc_string_builder_free(&sb);
+		afc_string_delete(built);
+	}
+
+	/* ===================================================================
+	 * SECTION 29: UTF-8 validation and transcoding
+	 * =================================================================== */
+	{
+		static const char *valid[] = {
+			"", "plain ascii", "\xc3\xa0\xc3\xa8", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xef\xbf\xbf", "\xf4\x8f\xbf\xbf",
+			"\xed\x9f\xbf", "\xc2\x80", "\xe0\xa0\x80", "\xf0\x90\x80\x80", NULL};
+		static const char *invalid[] = {
+			"\x80", "\xbf", "\xc0\xaf", "\xc1\xbf", "\xe0\x80\xaf", "\xed\xa0\x80", "\xed\xbf\xbf", "\xf0\x8f\xbf\xbf",
+			"\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\xff", "\xc3", "\xe2\x82", "\xf0\x9f\x98", "\xc3\xa0\xa0", "\xe2\x28\xa1", NULL};
+		char buf[256], out[768];
+		unsigned short u16[256];
+		unsigned long pos, i, j;
+		int errors = 0;
+		long len;
+		char *s;
+
+		for (i = 0; valid[i]; i++)
+		{
+			// Also check every sequence across a 16 bytes block boundary
+			for (j = 0; j < 20; j++)
+			{
+				memset(buf, 'a', j);
+				strcpy(buf + j, valid[i]);
+				if (!afc_utf8_validate(buf, strlen(buf), NULL))
+					errors++;
+			}
+		}
+		print_res("utf8 valid sequences", (void *)(long)0, (void *)(long)errors, 0);
+
+		errors = 0;
+		for (i = 0; invalid[i]; i++)
+		{
+			for (j = 0; j < 20; j++)
+			{
+				memset(buf, 'a', j);
+				strcpy(buf + j, invalid[i]);
+				if (afc_utf8_validate(buf, strlen(buf), &pos) || (pos < j))
+					errors++;
+				strcat(buf, "tail after error, long enough");
+				if (afc_utf8_validate(buf, strlen(buf), NULL))
+					errors++;
+			}
+		}
+		print_res("utf8 invalid sequences", (void *)(long)0, (void *)(long)errors, 0);
+
+		print_res("utf8 error pos", (void *)(long)1, (void *)(long)(afc_utf8_validate("abcdefghijklmnopqrstuvwxyz\xc3\xa0\x80", 29, &pos) == FALSE), 0);
+		print_res("utf8 error pos value", (void *)(long)28, (void *)(long)pos, 0);
+		print_res("utf8 not NUL terminated", (void *)(long)TRUE, (void *)(long)afc_utf8_validate("\xc3\xa0\xc3", 2, NULL), 0);
+
+		print_res("utf8 count", (void *)(long)5, (void *)(long)afc_utf8_count("a\xc3\xa0\xe2\x82\xac\xf0\x9f\x98\x80z", 11), 0);
+		print_res("utf8 count long", (void *)(long)33, (void *)(long)afc_utf8_count("\xc3\xa0\xc3\xa0\xc3\xa0\xc3\xa0 abcdefghijklmnopqrstuvwxyz \xe2\x82\xac", 39), 0);
+
+		len = afc_utf8_to_latin1(out, "Citt\xc3\xa0 da visitare: \xc3\xa8 bello \xe2\x82\xac", 32);
+		print_res("utf8 to latin1 len", (void *)(long)28, (void *)(long)len, 0);
+		print_res("utf8 to latin1", (void *)(long)0, (void *)(long)memcmp(out, "Citt\xe0 da visitare: \xe8 bello ?", 28), 0);
+		print_res("utf8 to latin1 invalid", (void *)(long)-1, (void *)(long)afc_utf8_to_latin1(out, "\xe0", 1), 0);
+
+		len = afc_latin1_to_utf8(out, "Citt\xe0 da visitare: \xe8 bello \xff", 28);
+		print_res("latin1 to utf8 len", (void *)(long)31, (void *)(long)len, 0);
+		print_res("latin1 to utf8", (void *)(long)0, (void *)(long)memcmp(out, "Citt\xc3\xa0 da visitare: \xc3\xa8 bello \xc3\xbf", 31), 0);
+
+		/* UTF-16 round trip, with ASCII runs long enough for the block paths */
+		strcpy(buf, "ASCII run that is longer than 16 chars \xc3\xa0\xe2\x82\xac\xf0\x9f\x98\x80 and more ASCII after it");
+		len = afc_utf8_to_utf16(u16, buf, strlen(buf));
+		print_res("utf8 to utf16 len", (void *)(long)(afc_utf8_count(buf, strlen(buf)) + 1), (void *)(long)len, 0);
+		print_res("utf8 to utf16 bmp", (void *)(long)0x20AC, (void *)(long)u16[40], 0);
+		print_res("utf8 to utf16 surrogates", (void *)(long)1, (void *)(long)((u16[41] == 0xD83D) && (u16[42] == 0xDE00)), 0);
+		len = afc_utf16_to_utf8(out, u16, len);
+		print_res("utf16 to utf8 round trip", (void *)(long)1, (void *)(long)((len == (long)strlen(buf)) && (memcmp(out, buf, len) == 0)), 0);
+
+		u16[0] = 'a';
+		u16[1] = 0xDC00;
+		print_res("utf16 unpaired surrogate", (void *)(long)-1, (void *)(long)afc_utf16_to_utf8(out, u16, 2), 0);
+		print_res("utf8 to utf16 invalid", (void *)(long)-1, (void *)(long)afc_utf8_to_utf16(u16, "\xed\xa0\x80", 3), 0);
+
+		s = afc_string_latin1_to_utf8("perch\xe9");
+		print_res("string latin1 to utf8", "perch\xc3\xa9", s, 1);
+		print_res("string latin1 to utf8 len", (void *)(long)7, (void *)(long)afc_string_len(s), 0);
+		afc_string_delete(s);
+
+		s = afc_string_utf8_to_latin1("perch\xc3\xa9");
+		print_res("string utf8 to latin1", "perch\xe9", s, 1);
+		print_res("string utf8 to latin1 len", (void *)(long)6, (void *)(long)afc_string_len(s), 0);
+		afc_string_delete(s);
+
+		s = afc_string_utf8_to_latin1("perch\xe9");
+		print_res("string utf8 to latin1 not utf8", "perch\xe9", s, 1);
+		afc_string_delete(s);
+	}
+
+	/* ===================================================================
+	 * SECTION 30: number formatting and parsing
+	 * =================================================================== */
+	{
+		char buf[AFC_STRING_NUMBER_SIZE], ref[64];
+		char *s;
+		long long v;
+		double d, x;
+		int i, errors = 0;
+
+		print_res("format_int", (void *)(long)4, (void *)(long)afc_string_format_int(buf, -123), 0);
+		print_res("format_int text", "-123", buf, 1);
+		afc_string_format_int(buf, LLONG_MIN);
+		print_res("format_int min", "-9223372036854775808", buf, 1);
+		afc_string_format_uint(buf, ULLONG_MAX);
+		print_res("format_uint max", "18446744073709551615", buf, 1);
+		afc_string_format_int(buf, 0);
+		print_res("format_int zero", "0", buf, 1);
+
+		afc_string_format_double(buf, 0.1);
+		print_res("format_double 0.1", "0.1", buf, 1);
+		afc_string_format_double(buf, 42.0);
+		print_res("format_double integer", "42", buf, 1);
+		afc_string_format_double(buf, -2.5e-7);
+		print_res("format_double small", "-2.5e-7", buf, 1);
+		afc_string_format_double(buf, 1e21);
+		print_res("format_double big", "1e+21", buf, 1);
+		afc_string_format_double(buf, 0.000123);
+		print_res("format_double fixed", "0.000123", buf, 1);
+		afc_string_format_double(buf, 1.7976931348623157e308);
+		print_res("format_double max", "1.7976931348623157e+308", buf, 1);
+		afc_string_format_double(buf, 5e-324);
+		print_res("format_double denormal", "5e-324", buf, 1);
+		afc_string_format_double(buf, -HUGE_VAL);
+		print_res("format_double -inf", "-inf", buf, 1);
+
+		/* Every formatted double reads back as the same value */
+		srand(42);
+		for (i = 0; i < 100000; i++)
+		{
+			x = ((double)rand() / RAND_MAX - 0.5) * pow(10, rand() % 600 - 300);
+			afc_string_format_double(buf, x);
+			if (strtod(buf, NULL) != x)
+				errors++;
+			if ((afc_string_parse_double(buf, ALL, &d) != strlen(buf)) || (d != x))
+				errors++;
+			snprintf(ref, sizeof(ref), "%.*g", rand() % 18 + 1, x);
+			if ((afc_string_parse_double(ref, ALL, &d) != strlen(ref)) || (d != strtod(ref, NULL)))
+				errors++;
+		}
+		print_res("format/parse double round trip", (void *)(long)0, (void *)(long)errors, 0);
+
+		s = afc_string_new(20);
+		afc_string_copy(s, "len=", ALL);
+		afc_string_append_int(s, -42);
+		afc_string_append_uint(s, 7);
+		afc_string_append_double(s, 0.5);
+		print_res("append numbers", "len=-4270.5", s, 1);
+		print_res("append numbers len", (void *)(long)11, (void *)(long)afc_string_len(s), 0);
+		afc_string_append_uint(s, 1234567890123ULL);
+		print_res("append truncated", "len=-4270.5123456789", s, 1);
+		afc_string_delete(s);
+
+		print_res("parse_int", (void *)(long)4, (void *)(long)afc_string_parse_int("-123abc", ALL, &v), 0);
+		print_res("parse_int value", (void *)(long)-123, (void *)(long)v, 0);
+		print_res("parse_int len", (void *)(long)2, (void *)(long)afc_string_parse_int("98765", 2, &v), 0);
+		print_res("parse_int len value", (void *)(long)98, (void *)(long)v, 0);
+		print_res("parse_int max", (void *)(long)19, (void *)(long)afc_string_parse_int("9223372036854775807", ALL, &v), 0);
+		print_res("parse_int min", (void *)(long)20, (void *)(long)afc_string_parse_int("-9223372036854775808", ALL, &v), 0);
+		print_res("parse_int min value", (void *)(long)1, (void *)(long)(v == LLONG_MIN), 0);
+		print_res("parse_int overflow", (void *)(long)0, (void *)(long)afc_string_parse_int("9223372036854775808", ALL, &v), 0);
+		print_res("parse_int no digits", (void *)(long)0, (void *)(long)afc_string_parse_int("-x", ALL, &v), 0);
+		print_res("parse_int space", (void *)(long)0, (void *)(long)afc_string_parse_int(" 1", ALL, &v), 0);
+
+		print_res("parse_double", (void *)(long)8, (void *)(long)afc_string_parse_double("-1.25e+2x", ALL, &d), 0);
+		print_res("parse_double value", (void *)(long)1, (void *)(long)(d == -125.0), 0);
+		print_res("parse_double no exp digits", (void *)(long)2, (void *)(long)afc_string_parse_double("3.e", ALL, &d), 0);
+		print_res("parse_double leading dot", (void *)(long)1, (void *)(long)((afc_string_parse_double(".5", ALL, &d) == 2) && (d == 0.5)), 0);
+		print_res("parse_double long mantissa", (void *)(long)1, (void *)(long)((afc_string_parse_double("3.14159265358979323846264338327950288", ALL, &d) == 37) && (d == 3.141592653589793)), 0);
+		print_res("parse_double len", (void *)(long)1, (void *)(long)((afc_string_parse_double("1.2345", 3, &d) == 3) && (d == 1.2)), 0);
+		print_res("parse_double nothing", (void *)(long)0, (void *)(long)afc_string_parse_double("-.e1", ALL, &d), 0);
+
+		s = afc_string_new(70);
+		afc_string_radix(s, -255, 16);
+		print_res("radix hex", "-ff", s, 1);
+		afc_string_radix(s, LONG_MIN, 2);
+		print_res("radix min len", (void *)(long)(sizeof(long) * 8 + 1), (void *)(long)afc_string_len(s), 0);
+		afc_string_radix(s, -1234567, 10);
+		print_res("radix 10", "-1234567", s, 1);
+		afc_string_radix(s, 4095, 64);
+		print_res("radix 64", "@@", s, 1);
+		afc_string_delete(s);
+	}
+
 	print_summary();
 
 	/* Cleanup */
@@ -32,6 +32,25 @@
 #include "test_utils.h"
 #include "../src/string_list.h"
 
+static int check_order(StringList *sn, int nocase, int inverted)
+{
+	char *s, *prev = NULL;
+	long res;
+	int errors = 0;
+
+	for (s = afc_string_list_first(sn); s; prev = s, s = afc_string_list_next(sn))
+	{
+		if (prev == NULL)
+			continue;
+
+		res = nocase ? strcasecmp(prev, s) : strcmp(prev, s);
+		if (inverted ? (res < 0) : (res > 0))
+			errors++;
+	}
+
+	return errors;
+}
+
 int main(void)
 {
 	AFC *afc = afc_new();
@@ -298,6 +317,155 @@ int main(void)
 	print_res("del single -> NULL", (void *)(long)1, (void *)(long)(s == NULL), 0);
 	print_res("is_empty after del all", (void *)(long)1, (void *)(long)afc_string_list_is_empty(sn), 0);
 
+	/* ----------------------------------------------------------------
+	 * 17. String views: add_view, find_view and split
+	 * ---------------------------------------------------------------- */
+	{
+		const char *line = "alpha,beta,gamma";
+
+		afc_string_list_clear(sn);
+		s = afc_string_list_add_view(sn, afc_strview_make(line + 6, 4), AFC_STRING_LIST_ADD_TAIL);
+		print_res("add_view", "beta", s, 1);
+		print_res("add_view exact size", (void *)(long)4, (void *)(long)afc_string_max(s), 0);
+		s = afc_string_list_add_view(sn, afc_strview_make(line, 0), AFC_STRING_LIST_ADD_TAIL);
+		print_res("add_view empty", "", s, 1);
+
+		afc_string_list_set_tags(sn, AFC_STRING_LIST_TAG_DISCARD_ZERO_LEN, (void *)TRUE);
+		print_res("add_view discard empty", NULL, afc_string_list_add_view(sn, afc_strview_make(line, 0), AFC_STRING_LIST_ADD_TAIL), 0);
+		afc_string_list_set_tags(sn, AFC_STRING_LIST_TAG_DISCARD_ZERO_LEN, (void *)FALSE);
+
+		afc_string_list_add_tail(sn, "betamax");
+		print_res("find_view", "betamax", afc_string_list_find_view(sn, afc_strview_make("betamax", ALL), FALSE), 1);
+		print_res("find_view exact length", "beta", afc_string_list_find_view(sn, afc_strview_make(line + 6, 4), FALSE), 1);
+		print_res("find_view missing", NULL, afc_string_list_find_view(sn, afc_strview_make("bet", ALL), FALSE), 0);
+
+		afc_string_list_split(sn, "a||b|", "|");
+		print_res("split tokens", (void *)(long)3, (void *)(long)afc_string_list_len(sn), 0);
+		print_res("split empty token", "", afc_string_list_item(sn, 1), 1);
+		print_res("split last token", "b", afc_string_list_item(sn, 2), 1);
+
+		afc_string_list_set_tags(sn, AFC_STRING_LIST_TAG_ESCAPE_CHAR, (void *)'\\');
+		afc_string_list_split(sn, "x\\|y|z", "|");
+		print_res("split escape", "x\\|y", afc_string_list_item(sn, 0), 1);
+		print_res("split escape count", (void *)(long)2, (void *)(long)afc_string_list_len(sn), 0);
+		afc_string_list_set_tags(sn, AFC_STRING_LIST_TAG_ESCAPE_CHAR, (void *)0);
+	}
+
+	/* ----------------------------------------------------------------
+	 * 18. Case insensitive sort and search
+	 * ---------------------------------------------------------------- */
+	afc_string_list_clear(sn);
+	afc_string_list_add_tail(sn, "beta");
+	afc_string_list_add_tail(sn, "Alpha");
+	afc_string_list_add_tail(sn, "gamma");
+	afc_string_list_add_tail(sn, "Delta");
+
+	afc_string_list_sort(sn, TRUE, FALSE, FALSE);
+	print_res("nocase sort [0]", "Alpha", afc_string_list_item(sn, 0), 1);
+	print_res("nocase sort [1]", "beta", afc_string_list_item(sn, 1), 1);
+	print_res("nocase sort [2]", "Delta", afc_string_list_item(sn, 2), 1);
+	print_res("nocase sort [3]", "gamma", afc_string_list_item(sn, 3), 1);
+
+	afc_string_list_sort(sn, FALSE, TRUE, FALSE);
+	print_res("sorted list sorted again [0]", "gamma", afc_string_list_item(sn, 0), 1);
+
+	afc_string_list_clear(sn);
+	afc_string_list_add_tail(sn, "beta");
+	afc_string_list_add_tail(sn, "Alpha");
+	afc_string_list_add_tail(sn, "gamma");
+	afc_string_list_add_tail(sn, "Delta");
+	afc_string_list_sort(sn, TRUE, TRUE, TRUE);
+	print_res("nocase fast sort inverted [0]", "gamma", afc_string_list_item(sn, 0), 1);
+	print_res("nocase fast sort inverted [3]", "Alpha", afc_string_list_item(sn, 3), 1);
+
+	afc_string_list_clear(sn);
+	afc_string_list_add_tail(sn, "beta");
+	afc_string_list_add_tail(sn, "Alpha");
+	afc_string_list_add_tail(sn, "gamma");
+	afc_string_list_add_tail(sn, "Delta");
+	afc_string_list_sort(sn, FALSE, FALSE, FALSE);
+	print_res("case sort uppercase first", "Alpha", afc_string_list_item(sn, 0), 1);
+	print_res("case sort [1]", "Delta", afc_string_list_item(sn, 1), 1);
+
+	print_res("search nocase", "Delta", afc_string_list_search(sn, "DELTA", FALSE, TRUE), 1);
+	print_res("search case", NULL, afc_string_list_search(sn, "DELTA", FALSE, FALSE), 0);
+	print_res("search exact", "beta", afc_string_list_search(sn, "beta", FALSE, FALSE), 1);
+	print_res("search nocase pattern", "gamma", afc_string_list_search(sn, "G*A", FALSE, TRUE), 1);
+
+	print_row();
+
+	/* ----------------------------------------------------------------
+	 * 19. Big sorts: shared prefixes, duplicates, empty strings and
+	 *     chars past 127, in one thread and split among 4 threads
+	 * ---------------------------------------------------------------- */
+	{
+		char buf[32], *cur;
+		int t, len, i, threads;
+		static const char chars[] = "aAbBzZ09-\xe9\xff";
+
+		srand(7);
+		for (threads = 1; threads <= 4; threads += 3)
+		{
+			afc_parallel_sort_set_threads(threads);
+
+			afc_string_list_clear(sn);
+			for (t = 0; t < AFC_PARALLEL_SORT_MIN_ITEMS * 3 + 5; t++)
+			{
+				len = rand() % 12;
+				strcpy(buf, "prefix");
+				for (i = 6; i < 6 + len; i++)
+					buf[i] = chars[rand() % (sizeof(chars) - 1)];
+				buf[(t % 100) ? i : 0] = 0;
+				afc_string_list_add_tail(sn, buf);
+			}
+
+			afc_string_list_sort(sn, FALSE, FALSE, FALSE);
+			print_res("big sort", (void *)(long)0, (void *)(long)check_order(sn, FALSE, FALSE), 0);
+			print_res("big sort len", (void *)(long)(AFC_PARALLEL_SORT_MIN_ITEMS * 3 + 5), (void *)(long)afc_string_list_len(sn), 0);
+			afc_string_list_sort(sn, FALSE, TRUE, TRUE);
+			print_res("big sort inverted", (void *)(long)0, (void *)(long)check_order(sn, FALSE, TRUE), 0);
+			afc_string_list_sort(sn, TRUE, FALSE, FALSE);
+			print_res("big sort nocase", (void *)(long)0, (void *)(long)check_order(sn, TRUE, FALSE), 0);
+			afc_string_list_sort(sn, TRUE, TRUE, FALSE);
+			cur = afc_string_list_obj(sn);
+			print_res("big sort nocase inverted", (void *)(long)0, (void *)(long)check_order(sn, TRUE, TRUE), 0);
+			print_res("big sort first is current", afc_string_list_item(sn, 0), cur, 0);
+		}
+
+		afc_parallel_sort_set_threads(0);
+	}
+
+	print_row();
+
+	/* ----------------------------------------------------------------
+	 * 20. Sorts of an unrolled list
+	 * ---------------------------------------------------------------- */
+	{
+		StringList *un = afc_string_list_new(), *cl;
+		char buf[16];
+		int t;
+
+		print_res("set_unrolled", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_list_set_unrolled(un->nm, TRUE), 0);
+		for (t = 0; t < 5000; t++)
+		{
+			sprintf(buf, "%c%d", (t % 3) ? 'k' : 'K', rand() % 100000);
+			afc_string_list_add_tail(un, buf);
+		}
+
+		afc_string_list_sort(un, FALSE, FALSE, FALSE);
+		print_res("unrolled sort", (void *)(long)0, (void *)(long)check_order(un, FALSE, FALSE), 0);
+		afc_string_list_sort(un, TRUE, TRUE, FALSE);
+		print_res("unrolled sort nocase inverted", (void *)(long)0, (void *)(long)check_order(un, TRUE, TRUE), 0);
+		print_res("unrolled sort len", (void *)(long)5000, (void *)(long)afc_string_list_len(un), 0);
+
+		cl = afc_string_list_clone(un);
+		print_res("unrolled clone", (void *)(long)1, (void *)(long)(cl->nm->unrolled && (afc_string_list_len(cl) == 5000)), 0);
+		print_res("unrolled clone items", afc_string_list_item(un, 4321), afc_string_list_item(cl, 4321), 1);
+
+		afc_string_list_delete(cl);
+		afc_string_list_delete(un);
+	}
+
 	/* ----------------------------------------------------------------
 	 * Cleanup
 	 * ---------------------------------------------------------------- */
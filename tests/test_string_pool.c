@@ -0,0 +1,154 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/**
+ * test_string_pool.c - Tests for the StringPool class.
+ *
+ * Tests cover:
+ *   - Object creation and deletion
+ *   - Interning C strings and string views, hash values stored in the pool
+ *   - Many strings (the index grows) and big strings
+ *   - afc_string_pool_clear()
+ *   - Dictionaries sharing their keys through a StringPool
+ */
+
+#include "test_utils.h"
+#include "../src/string_pool.h"
+#include "../src/dictionary.h"
+
+int main(void)
+{
+	AFC *afc = afc_new();
+	test_header();
+
+	const char *a, *b, *c;
+	char buf[64], *big;
+	static const char *ptrs[10000];
+	Dictionary *d1, *d2;
+	int t, errors;
+
+	/* ---- Test 1: Object creation ---- */
+	StringPool *pool = afc_string_pool_new();
+	print_res("string_pool_new() not NULL", (void *)(long)1, (void *)(long)(pool != NULL), 0);
+	print_res("empty pool", (void *)(long)0, (void *)(long)afc_string_pool_len(pool), 0);
+	print_res("find in empty pool", NULL, (void *)afc_string_pool_find(pool, "hello"), 0);
+
+	print_row();
+
+	/* ---- Test 2: Interning ---- */
+	strcpy(buf, "Content-Type");
+	a = afc_string_pool_intern(pool, buf);
+	b = afc_string_pool_intern(pool, "Content-Type");
+	c = afc_string_pool_intern(pool, "Content-Length");
+	print_res("interned string", "Content-Type", (void *)a, 1);
+	print_res("not the original", (void *)(long)1, (void *)(long)(a != buf), 0);
+	print_res("same chars, same pointer", (void *)(long)1, (void *)(long)(a == b), 0);
+	print_res("other chars, other pointer", (void *)(long)1, (void *)(long)(a != c), 0);
+	print_res("afc_string_len", (void *)(long)12, (void *)(long)afc_string_len(a), 0);
+	print_res("len", (void *)(long)2, (void *)(long)afc_string_pool_len(pool), 0);
+	print_res("stored hash", (void *)(long)1, (void *)(long)(afc_string_pool_hash(a) == afc_string_pool_hash_key(pool, "Content-Type", 12)), 0);
+	print_res("view", (void *)(long)1, (void *)(long)(afc_string_pool_intern_view(pool, afc_strview_make("Content-Type: text/html", 12)) == a), 0);
+	print_res("find", (void *)(long)1, (void *)(long)(afc_string_pool_find(pool, "Content-Length") == c), 0);
+	print_res("find missing", NULL, (void *)afc_string_pool_find(pool, "Content"), 0);
+	print_res("empty string", "", (void *)afc_string_pool_intern_view(pool, afc_strview_make(NULL, 0)), 1);
+
+	print_row();
+
+	/* ---- Test 3: Many strings ---- */
+	errors = 0;
+	for (t = 0; t < 10000; t++)
+	{
+		sprintf(buf, "key-%d", t);
+		ptrs[t] = afc_string_pool_intern(pool, buf);
+	}
+	for (t = 0; t < 10000; t++)
+	{
+		sprintf(buf, "key-%d", t);
+		if ((afc_string_pool_intern(pool, buf) != ptrs[t]) || (strcmp(ptrs[t], buf) != 0))
+			errors++;
+	}
+	print_res("10000 strings", (void *)(long)0, (void *)(long)errors, 0);
+	print_res("len after 10000 strings", (void *)(long)10003, (void *)(long)afc_string_pool_len(pool), 0);
+	print_res("old strings still there", (void *)(long)1, (void *)(long)(afc_string_pool_intern(pool, "Content-Type") == a), 0);
+
+	big = afc_string_new(AFC_STRING_POOL_SLAB_MAX);
+	memset(big, 'x', AFC_STRING_POOL_SLAB_MAX);
+	afc_string_reset_len(big);
+	a = afc_string_pool_intern(pool, big);
+	print_res("big string", (void *)(long)1, (void *)(long)((a != NULL) && (strcmp(a, big) == 0) && (afc_string_pool_intern(pool, big) == a)), 0);
+	b = afc_string_pool_intern(pool, "small after big");
+	print_res("small string after big", "small after big", (void *)b, 1);
+	afc_string_delete(big);
+
+	afc_string_pool_clear(pool);
+	print_res("clear", (void *)(long)0, (void *)(long)afc_string_pool_len(pool), 0);
+	print_res("find after clear", NULL, (void *)afc_string_pool_find(pool, "key-1"), 0);
+	a = afc_string_pool_intern(pool, "key-1");
+	print_res("intern after clear", "key-1", (void *)a, 1);
+
+	print_row();
+
+	/* ---- Test 4: Dictionaries ---- */
+	d1 = afc_dictionary_new();
+	d2 = afc_dictionary_new();
+	afc_dictionary_set_string_pool(d1, pool);
+	afc_dictionary_set_string_pool(d2, pool);
+
+	afc_dictionary_set(d1, "host", "one");
+	afc_dictionary_set(d2, "host", "two");
+	afc_dictionary_set(d1, "accept", "three");
+
+	print_res("get d1", "one", afc_dictionary_get(d1, "host"), 1);
+	print_res("get d2", "two", afc_dictionary_get(d2, "host"), 1);
+	print_res("get missing", NULL, afc_dictionary_get(d2, "accept"), 0);
+
+	a = afc_string_pool_find(pool, "host");
+	afc_dictionary_get(d1, "host");
+	b = afc_dictionary_get_key(d1);
+	afc_dictionary_get(d2, "host");
+	c = afc_dictionary_get_key(d2);
+	print_res("keys are shared", (void *)(long)1, (void *)(long)((a != NULL) && (a == b) && (b == c)), 0);
+	print_res("prehashed interned key", "one", afc_dictionary_get_prehashed(d1, a, (unsigned long)afc_string_pool_hash(a)), 1);
+
+	afc_dictionary_set(d1, "host", NULL);
+	print_res("key deleted", NULL, afc_dictionary_get(d1, "host"), 0);
+	print_res("key still in pool", (void *)(long)1, (void *)(long)(afc_string_pool_find(pool, "host") == a), 0);
+	afc_dictionary_set(d1, "host", "four");
+	print_res("key set again", "four", afc_dictionary_get(d1, "host"), 1);
+
+	print_res("set pool on non empty dict", (void *)(long)AFC_DICTIONARY_ERR_NOT_EMPTY, (void *)(long)afc_dictionary_set_string_pool(d1, NULL), 0);
+
+	afc_dictionary_clear(d1);
+	print_res("unbind pool", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_dictionary_set_string_pool(d1, NULL), 0);
+	afc_dictionary_set(d1, "host", "five");
+	afc_dictionary_get(d1, "host");
+	print_res("key not interned", (void *)(long)1, (void *)(long)(afc_dictionary_get_key(d1) != a), 0);
+	print_res("get without pool", "five", afc_dictionary_get(d1, "host"), 1);
+
+	afc_dictionary_delete(d1);
+	afc_dictionary_delete(d2);
+
+	print_summary();
+
+	afc_string_pool_delete(pool);
+	afc_delete(afc);
+
+	return get_test_failures() > 0 ? 1 : 0;
+}
@@ -0,0 +1,272 @@
+/*
+ * Advanced Foundation Classes
+ * Copyright (C) 2000/2025  Fabio Rotondo
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/**
+ * test_vec.c - Tests for the Vec class.
+ *
+ * Tests cover:
+ *   - Object creation and deletion
+ *   - push / pop / item with ints and structs
+ *   - insert / erase in the middle and at the ends
+ *   - reserve / resize / clear
+ *   - sort, bsearch and lower_bound
+ *   - push / insert of items of the same Vec
+ *   - Error handling
+ */
+
+#include "test_utils.h"
+#include "../src/vec.h"
+
+struct point
+{
+	double x;
+	double y;
+	int id;
+};
+
+static int comp_int(const void *a, const void *b)
+{
+	int ia = *(const int *)a, ib = *(const int *)b;
+
+	return (ia > ib) - (ia < ib);
+}
+
+static int comp_point(const void *a, const void *b)
+{
+	return ((const struct point *)a)->id - ((const struct point *)b)->id;
+}
+
+int main(void)
+{
+	AFC *afc = afc_new();
+	test_header();
+
+	Vec *v, *p;
+	int t, n, errors, *ip;
+	int ins[3] = {100, 101, 102};
+	struct point pt, *pp;
+	unsigned long max;
+
+	/* ---- Test 1: Object creation ---- */
+	v = afc_vec_new(sizeof(int));
+	print_res("vec_new() not NULL", (void *)(long)1, (void *)(long)(v != NULL), 0);
+	print_res("empty vec", (void *)(long)0, (void *)(long)afc_vec_len(v), 0);
+	print_res("no memory yet", NULL, (void *)v->mem, 0);
+	print_res("item on empty vec", NULL, afc_vec_item(v, 0), 0);
+	print_res("pop on empty vec", (void *)(long)AFC_VEC_ERR_EMPTY, (void *)(long)afc_vec_pop(v, &n), 0);
+	print_res("vec_new(0)", NULL, (void *)afc_vec_new(0), 0);
+
+	print_row();
+
+	/* ---- Test 2: push / pop ---- */
+	for (t = 0; t < 1000; t++)
+		afc_vec_push(v, &t);
+	print_res("len after 1000 push", (void *)(long)1000, (void *)(long)afc_vec_len(v), 0);
+
+	errors = 0;
+	for (t = 0; t < 1000; t++)
+		if ((afc_vec_at(v, int, t) != t) || (*(int *)afc_vec_item(v, t) != t))
+			errors++;
+	print_res("items in order", (void *)(long)0, (void *)(long)errors, 0);
+	print_res("item past the end", NULL, afc_vec_item(v, 1000), 0);
+
+	ip = afc_vec_push(v, NULL);
+	print_res("push NULL is zero", (void *)(long)0, (void *)(long)*ip, 0);
+	*ip = 1000;
+	print_res("push returns the item", (void *)(long)1000, (void *)(long)afc_vec_at(v, int, 1000), 0);
+
+	n = -1;
+	print_res("pop", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_vec_pop(v, &n), 0);
+	print_res("popped item", (void *)(long)1000, (void *)(long)n, 0);
+	afc_vec_pop(v, NULL);
+	print_res("pop NULL", (void *)(long)999, (void *)(long)afc_vec_len(v), 0);
+	print_res("data", (void *)(long)998, (void *)(long)afc_vec_data(v, int)[998], 0);
+
+	print_row();
+
+	/* ---- Test 3: insert / erase ---- */
+	afc_vec_resize(v, 10);
+	print_res("resize down", (void *)(long)10, (void *)(long)afc_vec_len(v), 0);
+
+	ip = afc_vec_insert(v, 2, ins, 3);
+	print_res("insert returns first item", (void *)(long)100, (void *)(long)*ip, 0);
+	print_res("len after insert", (void *)(long)13, (void *)(long)afc_vec_len(v), 0);
+	print_res("item before", (void *)(long)1, (void *)(long)afc_vec_at(v, int, 1), 0);
+	print_res("inserted items", (void *)(long)1, (void *)(long)((afc_vec_at(v, int, 2) == 100) && (afc_vec_at(v, int, 4) == 102)), 0);
+	print_res("items moved", (void *)(long)2, (void *)(long)afc_vec_at(v, int, 5), 0);
+
+	afc_vec_insert(v, 0, ins, 1);
+	print_res("insert at start", (void *)(long)100, (void *)(long)afc_vec_at(v, int, 0), 0);
+	afc_vec_insert(v, afc_vec_len(v), ins + 2, 1);
+	print_res("insert at end", (void *)(long)102, (void *)(long)afc_vec_at(v, int, 14), 0);
+	afc_vec_insert(v, 1, NULL, 2);
+	print_res("insert NULL is zero", (void *)(long)1, (void *)(long)((afc_vec_at(v, int, 1) == 0) && (afc_vec_at(v, int, 2) == 0) && (afc_vec_at(v, int, 3) == 0)), 0);
+	print_res("insert past the end", NULL, afc_vec_insert(v, afc_vec_len(v) + 1, ins, 1), 0);
+
+	afc_vec_erase(v, 0, 3);
+	print_res("erase at start", (void *)(long)0, (void *)(long)afc_vec_at(v, int, 0), 0);
+	afc_vec_erase(v, 2, 3);
+	print_res("erase in the middle", (void *)(long)1, (void *)(long)((afc_vec_at(v, int, 1) == 1) && (afc_vec_at(v, int, 2) == 2)), 0);
+	print_res("len after erase", (void *)(long)11, (void *)(long)afc_vec_len(v), 0);
+	afc_vec_erase(v, 9, ALL);
+	print_res("erase up to the end", (void *)(long)9, (void *)(long)afc_vec_len(v), 0);
+	print_res("erase past the end", (void *)(long)AFC_VEC_ERR_INVALID_POSITION, (void *)(long)afc_vec_erase(v, 10, 1), 0);
+	print_res("erase nothing", (void *)(long)AFC_ERR_NO_ERROR, (void *)(long)afc_vec_erase(v, 9, 5), 0);
+
+	print_row();
+
+	/* ---- Test 4: reserve / resize / clear ---- */
+	afc_vec_reserve(v, 100000);
+	max = v->max_items;
+	print_res("reserve", (void *)(long)1, (void *)(long)(max >= 100000), 0);
+	print_res("reserve keeps items", (void *)(long)1, (void *)(long)((afc_vec_len(v) == 9) && (afc_vec_at(v, int, 1) == 1)), 0);
+	for (t = 0; t < 90000; t++)
+		afc_vec_push(v, &t);
+	print_res("no growth after reserve", (void *)(long)1, (void *)(long)(v->max_items == max), 0);
+
+	afc_vec_resize(v, 5);
+	afc_vec_resize(v, 8);
+	print_res("resize up is zero", (void *)(long)1, (void *)(long)((afc_vec_at(v, int, 5) == 0) && (afc_vec_at(v, int, 7) == 0)), 0);
+	afc_vec_resize(v, 0);
+	print_res("resize to 0 keeps memory", (void *)(long)1, (void *)(long)((afc_vec_len(v) == 0) && (v->max_items == max)), 0);
+
+	afc_vec_clear(v);
+	print_res("clear", (void *)(long)1, (void *)(long)((afc_vec_len(v) == 0) && (v->mem == NULL)), 0);
+	afc_vec_push(v, &ins[0]);
+	print_res("push after clear", (void *)(long)100, (void *)(long)afc_vec_at(v, int, 0), 0);
+
+	print_row();
+
+	/* ---- Test 5: sort / bsearch / lower_bound ---- */
+	afc_vec_clear(v);
+	srand(42);
+	for (t = 0; t < 5000; t++)
+	{
+		n = rand() % 1000;
+		afc_vec_push(v, &n);
+	}
+	afc_vec_sort(v, comp_int);
+
+	errors = 0;
+	for (t = 1; t < 5000; t++)
+		if (afc_vec_at(v, int, t - 1) > afc_vec_at(v, int, t))
+			errors++;
+	print_res("sorted", (void *)(long)0, (void *)(long)errors, 0);
+
+	errors = 0;
+	for (n = -1; n <= 1000; n++)
+	{
+		unsigned long pos = afc_vec_lower_bound(v, &n, comp_int);
+		long found = afc_vec_bsearch(v, &n, comp_int);
+
+		if ((pos > 0) && (afc_vec_at(v, int, pos - 1) >= n))
+			errors++;
+		if ((pos < 5000) && (afc_vec_at(v, int, pos) < n))
+			errors++;
+		if ((found >= 0) != ((pos < 5000) && (afc_vec_at(v, int, pos) == n)))
+			errors++;
+		if ((found >= 0) && ((unsigned long)found != pos))
+			errors++;
+	}
+	print_res("lower_bound and bsearch", (void *)(long)0, (void *)(long)errors, 0);
+
+	n = 1000;
+	print_res("bsearch missing", (void *)(long)-1, (void *)(long)afc_vec_bsearch(v, &n, comp_int), 0);
+	print_res("lower_bound past all", (void *)(long)5000, (void *)(long)afc_vec_lower_bound(v, &n, comp_int), 0);
+
+	afc_vec_clear(v);
+	n = 7;
+	print_res("bsearch on empty vec", (void *)(long)-1, (void *)(long)afc_vec_bsearch(v, &n, comp_int), 0);
+
+	print_row();
+
+	/* ---- Test 6: structs ---- */
+	p = afc_vec_new(sizeof(struct point));
+	for (t = 0; t < 100; t++)
+	{
+		pt.x = t * 0.5;
+		pt.y = -t;
+		pt.id = (t * 37) % 100;
+		afc_vec_push(p, &pt);
+	}
+	afc_vec_sort(p, comp_point);
+
+	errors = 0;
+	for (t = 0; t < 100; t++)
+	{
+		pp = afc_vec_item(p, t);
+		if ((pp->id != t) || (pp->x * 2 != -pp->y) || (afc_vec_at(p, struct point, t).id != t))
+			errors++;
+	}
+	print_res("struct items sorted", (void *)(long)0, (void *)(long)errors, 0);
+
+	pt.id = 42;
+	pp = afc_vec_item(p, afc_vec_bsearch(p, &pt, comp_point));
+	print_res("struct bsearch", (void *)(long)42, (void *)(long)pp->id, 0);
+
+	afc_vec_pop(p, &pt);
+	print_res("struct pop", (void *)(long)99, (void *)(long)pt.id, 0);
+
+	afc_vec_delete(p);
+	print_res("delete sets NULL", NULL, (void *)p, 0);
+
+	print_row();
+
+	/* ---- Test 7: items of the same Vec ---- */
+	p = afc_vec_new(sizeof(int));
+	t = 7;
+	afc_vec_push(p, &t);
+	while (afc_vec_len(p) < 1000)
+		afc_vec_push(p, afc_vec_item(p, 0));
+
+	errors = 0;
+	for (t = 0; t < 1000; t++)
+		if (afc_vec_at(p, int, t) != 7)
+			errors++;
+	print_res("push own item while growing", (void *)(long)0, (void *)(long)errors, 0);
+
+	afc_vec_resize(p, 0);
+	for (t = 1; t <= 2; t++)
+		afc_vec_push(p, &t);
+	while (afc_vec_len(p) < 1024)
+		afc_vec_insert(p, 0, afc_vec_item(p, 0), afc_vec_len(p));
+
+	errors = 0;
+	for (t = 0; t < 1024; t++)
+		if (afc_vec_at(p, int, t) != t % 2 + 1)
+			errors++;
+	print_res("insert own items while growing", (void *)(long)0, (void *)(long)errors, 0);
+
+	afc_vec_resize(p, 0);
+	for (t = 0; t < 5; t++)
+		afc_vec_push(p, &t);
+	afc_vec_insert(p, 1, afc_vec_item(p, 2), 3);
+	print_res("insert own moved items", (void *)(long)1, (void *)(long)((afc_vec_at(p, int, 1) == 2) && (afc_vec_at(p, int, 3) == 4) && (afc_vec_at(p, int, 4) == 1) && (afc_vec_at(p, int, 7) == 4)), 0);
+	print_res("insert own items past the end", NULL, afc_vec_insert(p, 0, afc_vec_item(p, 7), 2), 0);
+
+	afc_vec_delete(p);
+
+	print_summary();
+
+	afc_vec_delete(v);
+	afc_delete(afc);
+
+	return get_test_failures() > 0 ? 1 : 0;
+}